@@ -0,0 +1,112 @@
+/**
+ * @file   cpubudget.cpp
+ * @date   2026-10-19
+ * @brief  Implementation for CpuBudget.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "cpubudget.h"
+// STL headers
+// std headers
+// external library headers
+// other Linden headers
+
+namespace
+{
+    // the budget whose token the calling thread's innermost Token holds,
+    // while it holds it
+    thread_local LL::CpuBudget* sHeldBudget = nullptr;
+}
+
+LL::CpuBudget::CpuBudget(size_t width):
+    // a zero-width budget would block every worker forever
+    mWidth(llmax(width, size_t(1)))
+{
+}
+
+void LL::CpuBudget::acquire()
+{
+    LLCoros::LockType lock(mMutex);
+    while (mBusy >= mWidth)
+    {
+        mCond.wait(lock);
+    }
+    ++mBusy;
+}
+
+bool LL::CpuBudget::tryAcquire()
+{
+    LLCoros::LockType lock(mMutex);
+    if (mBusy >= mWidth)
+    {
+        return false;
+    }
+    ++mBusy;
+    return true;
+}
+
+void LL::CpuBudget::release()
+{
+    LLCoros::LockType lock(mMutex);
+    llassert(mBusy > 0);
+    --mBusy;
+    mCond.notify_one();
+}
+
+size_t LL::CpuBudget::getWidth()
+{
+    LLCoros::LockType lock(mMutex);
+    return mWidth;
+}
+
+void LL::CpuBudget::setWidth(size_t width)
+{
+    LLCoros::LockType lock(mMutex);
+    mWidth = llmax(width, size_t(1));
+    mCond.notify_all();
+}
+
+size_t LL::CpuBudget::getBusy()
+{
+    LLCoros::LockType lock(mMutex);
+    return mBusy;
+}
+
+LL::CpuBudget::Token::Token(CpuBudget& budget):
+    mBudget(budget),
+    mOuter(sHeldBudget)
+{
+    mBudget.acquire();
+    sHeldBudget = &mBudget;
+}
+
+LL::CpuBudget::Token::~Token()
+{
+    sHeldBudget = mOuter;
+    mBudget.release();
+}
+
+LL::CpuBudget::Blocking::Blocking():
+    mBudget(sHeldBudget)
+{
+    if (mBudget)
+    {
+        sHeldBudget = nullptr;
+        mBudget->release();
+    }
+}
+
+LL::CpuBudget::Blocking::~Blocking()
+{
+    if (mBudget)
+    {
+        mBudget->acquire();
+        sHeldBudget = mBudget;
+    }
+}
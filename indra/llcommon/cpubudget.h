@@ -0,0 +1,101 @@
+/**
+ * @file   cpubudget.h
+ * @date   2026-10-19
+ * @brief  CpuBudget caps how many work items several ThreadPools may run at
+ *         once.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_CPUBUDGET_H)
+#define LL_CPUBUDGET_H
+
+#include "llcoros.h"
+#include LLCOROS_MUTEX_HEADER
+#include LLCOROS_CONDVAR_HEADER
+
+namespace LL
+{
+    /**
+     * Each ThreadPool is sized on its own, so together they can start more
+     * threads than there are cores, and a burst of image decodes then
+     * competes with mesh decodes and geometry jobs for the same cores.
+     * CpuBudget is a counting semaphore that pools share: a worker holds a
+     * Token while it runs each work item, so no more than getWidth() items
+     * run at once across all of them, however many threads are waiting.
+     *
+     * The budget counts running threads, one per work item, not cores used
+     * inside an item. Work that starts threads of its own must take a token
+     * for each with tryAcquire() and release() it when they stop, as
+     * LLImageDecodeThread does for OpenJPEG's decode threads. parallelFor()
+     * and TaskGraph helpers are work items on their pool, so they are
+     * counted when that pool shares the budget; the calling thread counts
+     * only if it is itself running a budgeted work item.
+     *
+     * Work run under a budget must not wait on other work run under the same
+     * budget, or a full budget deadlocks. Work that blocks for its own
+     * reasons, launching a process or writing a file, should hold a Blocking
+     * while it does, so that its token goes to work that can use the core.
+     */
+    class LL_COMMON_API CpuBudget
+    {
+    public:
+        CpuBudget(size_t width);
+
+        CpuBudget(const CpuBudget&) = delete;
+        CpuBudget& operator=(const CpuBudget&) = delete;
+
+        /// block until a token is free, then take it
+        void acquire();
+        /// take a token only if one is free
+        bool tryAcquire();
+        void release();
+
+        size_t getWidth();
+        /// Shrinking takes effect as running items release their tokens.
+        void setWidth(size_t width);
+        /// tokens currently held
+        size_t getBusy();
+
+        /// holds a token for its lifetime
+        class LL_COMMON_API Token
+        {
+        public:
+            Token(CpuBudget& budget);
+            ~Token();
+
+            Token(const Token&) = delete;
+            Token& operator=(const Token&) = delete;
+
+        private:
+            CpuBudget& mBudget;
+            CpuBudget* mOuter;
+        };
+
+        /// Gives back the token the calling thread's Token holds, if any,
+        /// for its lifetime, and waits for one again on destruction.
+        class LL_COMMON_API Blocking
+        {
+        public:
+            Blocking();
+            ~Blocking();
+
+            Blocking(const Blocking&) = delete;
+            Blocking& operator=(const Blocking&) = delete;
+
+        private:
+            CpuBudget* mBudget;
+        };
+
+    private:
+        LLCoros::Mutex mMutex;
+        LLCoros::ConditionVariable mCond;
+        size_t mWidth;
+        size_t mBusy{ 0 };
+    };
+
+} // namespace LL
+
+#endif /* ! defined(LL_CPUBUDGET_H) */
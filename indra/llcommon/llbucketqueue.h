@@ -0,0 +1,209 @@
+/**
+ * @file llbucketqueue.h
+ * @brief Indexed priority queue with a fixed number of priority buckets
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#ifndef LL_LLBUCKETQUEUE_H
+#define LL_LLBUCKETQUEUE_H
+
+#include <deque>
+#include <unordered_map>
+
+//
+// Priority queue for items whose priority is coarse (a small integer, such
+// as a log2 of some size) and changes often.  Each bucket is a FIFO, so items
+// of equal priority are served oldest first, and a bit mask of non-empty
+// buckets finds the highest one without scanning.
+//
+// Every item is queued at most once: pushing an item that is already queued
+// only moves it to a higher bucket, keeping the stamp it was first queued
+// with.  Moving or removing an item leaves a dead entry behind in its old
+// bucket that is skipped when popped, and the buckets are compacted once
+// dead entries outnumber live ones.
+//
+// Not thread safe.
+//
+
+template <class DATA_TYPE, U32 NUM_BUCKETS = 32>
+class LLBucketQueue
+{
+    static_assert(NUM_BUCKETS > 0 && NUM_BUCKETS <= 64, "bucket mask is a U64");
+
+public:
+    LLBucketQueue() : mNonEmpty(0), mDead(0), mGeneration(0) {}
+
+    // Queues data in bucket (clamped to NUM_BUCKETS - 1), or raises it to
+    // bucket if it is already queued lower.  stamp is returned by pop() and
+    // typically records when the item was first queued.
+    void push(const DATA_TYPE& data, U32 bucket, U64 stamp = 0)
+    {
+        bucket = llmin(bucket, NUM_BUCKETS - 1);
+        auto result = mSlots.emplace(data, Slot());
+        Slot& slot = result.first->second;
+        if (!result.second)
+        {
+            if (bucket <= slot.mBucket)
+            {
+                return;
+            }
+            // old entry stays behind until popped or compacted
+            ++mDead;
+        }
+        else
+        {
+            slot.mStamp = stamp;
+        }
+        slot.mBucket = bucket;
+        slot.mGeneration = ++mGeneration;
+        mBuckets[bucket].push_back(Entry{ data, slot.mGeneration });
+        mNonEmpty |= (U64)1 << bucket;
+        compactIfNeeded();
+    }
+
+    // Removes data from the queue if it is queued; returns true if it was
+    bool remove(const DATA_TYPE& data)
+    {
+        auto iter = mSlots.find(data);
+        if (iter == mSlots.end())
+        {
+            return false;
+        }
+        mSlots.erase(iter);
+        ++mDead;
+        compactIfNeeded();
+        return true;
+    }
+
+    // Takes the oldest item of the highest non-empty bucket
+    bool pop(DATA_TYPE& data, U32* bucket = nullptr, U64* stamp = nullptr)
+    {
+        while (mNonEmpty)
+        {
+            U32 top = highestBucket();
+            std::deque<Entry>& entries = mBuckets[top];
+            while (!entries.empty())
+            {
+                Entry entry = entries.front();
+                entries.pop_front();
+                auto iter = mSlots.find(entry.mData);
+                if (iter == mSlots.end() || iter->second.mGeneration != entry.mGeneration)
+                {
+                    // removed, or moved to another bucket since
+                    --mDead;
+                    continue;
+                }
+                if (bucket)
+                {
+                    *bucket = top;
+                }
+                if (stamp)
+                {
+                    *stamp = iter->second.mStamp;
+                }
+                data = entry.mData;
+                mSlots.erase(iter);
+                if (entries.empty())
+                {
+                    mNonEmpty &= ~((U64)1 << top);
+                }
+                return true;
+            }
+            mNonEmpty &= ~((U64)1 << top);
+        }
+        return false;
+    }
+
+    bool contains(const DATA_TYPE& data) const { return mSlots.find(data) != mSlots.end(); }
+    size_t size() const { return mSlots.size(); }
+    bool empty() const { return mSlots.empty(); }
+
+    void clear()
+    {
+        for (U32 i = 0; i < NUM_BUCKETS; ++i)
+        {
+            mBuckets[i].clear();
+        }
+        mSlots.clear();
+        mNonEmpty = 0;
+        mDead = 0;
+    }
+
+private:
+    struct Entry
+    {
+        DATA_TYPE mData;
+        U64 mGeneration;
+    };
+
+    struct Slot
+    {
+        U32 mBucket = 0;
+        U64 mGeneration = 0;
+        U64 mStamp = 0;
+    };
+
+    U32 highestBucket() const
+    {
+        U32 top = NUM_BUCKETS - 1;
+        while (!(mNonEmpty & ((U64)1 << top)))
+        {
+            --top;
+        }
+        return top;
+    }
+
+    void compactIfNeeded()
+    {
+        if (mDead < 64 || mDead < mSlots.size())
+        {
+            return;
+        }
+        for (U32 i = 0; i < NUM_BUCKETS; ++i)
+        {
+            std::deque<Entry>& entries = mBuckets[i];
+            std::deque<Entry> live;
+            for (const Entry& entry : entries)
+            {
+                auto iter = mSlots.find(entry.mData);
+                if (iter != mSlots.end() && iter->second.mGeneration == entry.mGeneration)
+                {
+                    live.push_back(entry);
+                }
+            }
+            entries.swap(live);
+            if (entries.empty())
+            {
+                mNonEmpty &= ~((U64)1 << i);
+            }
+        }
+        mDead = 0;
+    }
+
+    std::deque<Entry> mBuckets[NUM_BUCKETS];
+    std::unordered_map<DATA_TYPE, Slot> mSlots;
+    U64 mNonEmpty;
+    size_t mDead;
+    U64 mGeneration;
+};
+
+#endif // LL_LLBUCKETQUEUE_H
@@ -0,0 +1,25 @@
+/**
+ * @file   lleventchannel.cpp
+ * @date   2026-10-19
+ * @brief  Implementation for LLEventChannels.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lleventchannel.h"
+// STL headers
+// std headers
+// external library headers
+// other Linden headers
+
+LLEventChannel<U32>& LLEventChannels::mainloop()
+{
+    // function-local static: safe to listen on from other statics' constructors
+    static LLEventChannel<U32> sMainloop("mainloop");
+    return sMainloop;
+}
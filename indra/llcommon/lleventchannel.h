@@ -0,0 +1,377 @@
+/**
+ * @file   lleventchannel.h
+ * @date   2026-10-19
+ * @brief  LLEventChannel is a typed, lock-free alternative to LLEventPump
+ *         for hot internal events.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_LLEVENTCHANNEL_H)
+#define LL_LLEVENTCHANNEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "llevents.h"               // LLEventPump::DupListenerName
+
+/**
+ * LLEventChannel<PAYLOAD> delivers a PAYLOAD to each of its listeners in
+ * turn, like LLEventStream delivers an LLSD. It is meant for internal events
+ * posted often enough that LLEventPump's overhead shows up in profiles: every
+ * LLEventPump::post() locks the boost::signals2 mutex, walks the signal's
+ * combiner and passes an LLSD that listeners must unpack.
+ *
+ * LLEventChannel::post() takes no lock and allocates nothing. The listener
+ * list is copied on write: listen() and disconnect() lock a mutex, build a
+ * new list and publish it, while post() just walks whichever list was
+ * current when it started. Lists replaced while a post() is still walking
+ * them are freed once no post() is running.
+ *
+ * What it does not do, compared with LLEventPump:
+ * * There is no LLEventPumps registry: a channel is an object the poster
+ *   owns and exposes, such as LLEventChannels::mainloop().
+ * * Listeners are called in the order they were added; there are no
+ *   after/before constraints.
+ * * The payload is fixed at compile time, so there is no LLEventAPI or
+ *   LLLeap access. Code that needs those keeps using an LLEventPump, and a
+ *   poster may post to both.
+ *
+ * As with LLEventPump, a listener returns true to stop the event reaching
+ * later listeners, and listener names must be unique on a channel. Once
+ * disconnect() returns, its listener is not called again, by any thread:
+ * if another thread is calling it, disconnect() waits for that call to
+ * finish. A listener may disconnect itself, but must not wait for another
+ * thread that is disconnecting it, nor suspend its coroutine.
+ */
+template <typename PAYLOAD>
+class LLEventChannel
+{
+public:
+    typedef PAYLOAD payload_type;
+    typedef std::function<bool(const PAYLOAD&)> Listener;
+
+private:
+    struct Slot
+    {
+        Slot(const std::string& name, const Listener& listener):
+            mName(name),
+            mListener(listener)
+        {}
+
+        const std::string mName;
+        const Listener mListener;
+        std::atomic<bool> mConnected{ true };
+        // calls to mListener in progress, on any thread
+        std::atomic<size_t> mCalls{ 0 };
+    };
+    typedef std::vector<std::shared_ptr<Slot>> SlotList;
+
+    // One call to a listener, counted in its Slot for its lifetime. The
+    // calls in progress on a thread are chained, innermost first, so that
+    // disconnect() from within a listener does not wait for itself.
+    struct Calling
+    {
+        Calling(Slot& slot):
+            mSlot(slot),
+            mOuter(sCalling)
+        {
+            ++mSlot.mCalls;
+            sCalling = this;
+        }
+        ~Calling()
+        {
+            sCalling = mOuter;
+            --mSlot.mCalls;
+        }
+
+        Calling(const Calling&) = delete;
+        Calling& operator=(const Calling&) = delete;
+
+        Slot& mSlot;
+        Calling* const mOuter;
+    };
+    static thread_local Calling* sCalling;
+
+    // Wait until no other thread is calling slot's listener. Call after
+    // clearing mConnected: post() counts a call in before it checks.
+    static void waitForCalls(const Slot& slot)
+    {
+        size_t own = 0;
+        for (const Calling* calling = sCalling; calling; calling = calling->mOuter)
+        {
+            if (&calling->mSlot == &slot)
+            {
+                ++own;
+            }
+        }
+        while (slot.mCalls.load() > own)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Held by shared_ptr so a Connection can outlive its channel
+    struct State
+    {
+        State(const std::string& name): mName(name) {}
+
+        ~State()
+        {
+            delete mSlots.load();
+        }
+
+        // With mMutex locked: publish next in place of the current list
+        void replace(SlotList* next)
+        {
+            const SlotList* previous = mSlots.exchange(next);
+            if (previous)
+            {
+                mRetired.emplace_back(previous);
+                mRetiring = true;
+            }
+            // A reader that had not yet counted itself in mPosting can only
+            // see the list we just published, so if none is counted now,
+            // nobody is walking a retired list.
+            reclaim();
+        }
+
+        // With mMutex locked: free retired lists if no reader is running
+        void reclaim()
+        {
+            if (mRetiring.load() && ! mPosting.load())
+            {
+                mRetired.clear();
+                mRetiring = false;
+            }
+        }
+
+        void remove(const Slot* slot)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const SlotList* current = mSlots.load();
+            if (! current)
+            {
+                return;
+            }
+            auto found = std::find_if(current->begin(), current->end(),
+                                      [slot](const std::shared_ptr<Slot>& s){ return s.get() == slot; });
+            if (found == current->end())
+            {
+                return;
+            }
+            SlotList* next = new SlotList;
+            next->reserve(current->size() - 1);
+            next->insert(next->end(), current->begin(), found);
+            next->insert(next->end(), found + 1, current->end());
+            replace(next);
+        }
+
+        const std::string mName;
+        std::atomic<const SlotList*> mSlots{ nullptr };
+        // readers of mSlots in progress, on any thread
+        std::atomic<size_t> mPosting{ 0 };
+        std::atomic<bool> mRetiring{ false };
+
+        // writers only
+        std::mutex mMutex;
+        std::vector<std::unique_ptr<const SlotList>> mRetired;
+    };
+
+    // Counts a reader of mSlots in for its lifetime.  Construct before
+    // loading mSlots, so that a writer retiring the list either sees the
+    // reader or the reader sees its replacement.
+    struct Reading
+    {
+        Reading(State& state): mState(state) { ++mState.mPosting; }
+        ~Reading()
+        {
+            if (! --mState.mPosting && mState.mRetiring.load())
+            {
+                // last one out frees replaced lists; if a writer holds
+                // the lock, the next reader or writer will
+                std::unique_lock<std::mutex> lock(mState.mMutex, std::try_to_lock);
+                if (lock)
+                {
+                    mState.reclaim();
+                }
+            }
+        }
+        Reading(const Reading&) = delete;
+        Reading& operator=(const Reading&) = delete;
+
+        State& mState;
+    };
+
+public:
+    /**
+     * Handle on one listener, like LLBoundListener: copyable, and harmless
+     * to disconnect() more than once or after the channel is gone.
+     */
+    class Connection
+    {
+    public:
+        Connection() {}
+
+        void disconnect()
+        {
+            std::shared_ptr<Slot> slot{ mSlot.lock() };
+            if (slot)
+            {
+                if (slot->mConnected.exchange(false))
+                {
+                    if (std::shared_ptr<State> state{ mState.lock() })
+                    {
+                        state->remove(slot.get());
+                    }
+                }
+                // even if another copy disconnected it first
+                waitForCalls(*slot);
+            }
+            mSlot.reset();
+        }
+
+        bool connected() const
+        {
+            std::shared_ptr<Slot> slot{ mSlot.lock() };
+            return slot && slot->mConnected.load();
+        }
+
+    private:
+        friend class LLEventChannel;
+        Connection(const std::weak_ptr<State>& state, const std::weak_ptr<Slot>& slot):
+            mState(state),
+            mSlot(slot)
+        {}
+
+        std::weak_ptr<State> mState;
+        std::weak_ptr<Slot> mSlot;
+    };
+
+    /**
+     * Disconnects its listener when destroyed, like LLTempBoundListener.
+     */
+    class TempConnection: public Connection
+    {
+    public:
+        TempConnection() {}
+        TempConnection(const Connection& connection): Connection(connection) {}
+        TempConnection& operator=(const Connection& connection)
+        {
+            if (static_cast<Connection*>(this) != &connection)
+            {
+                this->disconnect();
+                Connection::operator=(connection);
+            }
+            return *this;
+        }
+        ~TempConnection() { this->disconnect(); }
+
+        TempConnection(const TempConnection&) = delete;
+        TempConnection& operator=(const TempConnection&) = delete;
+    };
+
+    LLEventChannel(const std::string& name):
+        mState(std::make_shared<State>(name))
+    {}
+
+    LLEventChannel(const LLEventChannel&) = delete;
+    LLEventChannel& operator=(const LLEventChannel&) = delete;
+
+    std::string getName() const { return mState->mName; }
+
+    /**
+     * Add a listener after those already registered. Throws
+     * LLEventPump::DupListenerName if name is already listening here; pass
+     * LLEventPump::inventName() if you don't care to invent one.
+     */
+    Connection listen(const std::string& name, const Listener& listener)
+    {
+        auto slot = std::make_shared<Slot>(name, listener);
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+        const SlotList* current = mState->mSlots.load();
+        SlotList* next = new SlotList;
+        if (current)
+        {
+            for (const auto& existing : *current)
+            {
+                if (existing->mName == name)
+                {
+                    delete next;
+                    LLTHROW(LLEventPump::DupListenerName("Attempt to register duplicate listener name '" +
+                                                         name + "' on LLEventChannel '" +
+                                                         mState->mName + "'"));
+                }
+            }
+            next->reserve(current->size() + 1);
+            *next = *current;
+        }
+        next->push_back(slot);
+        mState->replace(next);
+        return Connection(mState, slot);
+    }
+
+    /**
+     * Deliver payload to each connected listener in turn, on this thread.
+     * Returns true if a listener returned true to stop delivery.
+     */
+    bool post(const PAYLOAD& payload) const
+    {
+        State& state = *mState;
+        Reading reading(state);
+        const SlotList* slots = state.mSlots.load();
+        if (! slots)
+        {
+            return false;
+        }
+        for (const auto& slot : *slots)
+        {
+            // Count the call in before checking mConnected, so that a
+            // disconnect() on another thread either sees it and waits or
+            // is seen here
+            Calling calling(*slot);
+            if (slot->mConnected.load() && slot->mListener(payload))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// number of connected listeners
+    size_t size() const
+    {
+        Reading reading(*mState);
+        const SlotList* slots = mState->mSlots.load();
+        return slots ? slots->size() : 0;
+    }
+
+    bool empty() const { return ! size(); }
+
+private:
+    std::shared_ptr<State> mState;
+};
+
+template <typename PAYLOAD>
+thread_local typename LLEventChannel<PAYLOAD>::Calling* LLEventChannel<PAYLOAD>::sCalling = nullptr;
+
+/**
+ * Channels posted by the viewer itself, for listeners in libraries that
+ * cannot reach into newview.
+ */
+class LL_COMMON_API LLEventChannels
+{
+public:
+    /// Posted once per frame, alongside the "mainloop" LLEventPump, with the
+    /// frame number as payload
+    static LLEventChannel<U32>& mainloop();
+};
+
+#endif /* ! defined(LL_LLEVENTCHANNEL_H) */
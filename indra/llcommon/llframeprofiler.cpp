@@ -0,0 +1,305 @@
+/**
+ * @file llframeprofiler.cpp
+ * @brief Ring of per-frame block timer samples, dumped as a Chrome
+ * trace when a frame hitches
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llframeprofiler.h"
+
+#include "cpubudget.h"
+#include "llfasttimer.h"
+#include "llfile.h"
+#include "lltimer.h"
+#include "lltracerecording.h"
+#include "workqueue.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+
+namespace
+{
+    void write_json_string(std::ostream& os, const std::string& str)
+    {
+        os << '"';
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if ((U8)c < 0x20)
+                {
+                    os << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf] << "0123456789abcdef"[c & 0xf];
+                }
+                else
+                {
+                    os << c;
+                }
+            }
+        }
+        os << '"';
+    }
+
+    void write_event(std::ostream& os, const std::string& name, const char* category, U64 ts, U64 dur,
+                     const char* arg_name, U64 arg)
+    {
+        os << ",\n{\"name\":";
+        write_json_string(os, name);
+        os << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts
+           << ",\"dur\":" << dur << ",\"args\":{\"" << arg_name << "\":" << arg << "}}";
+    }
+}
+
+LLFrameProfiler::LLFrameProfiler(const std::string& dump_prefix, F32 hitch_ms, F32 seconds,
+                                 U32 max_dumps, size_t max_frames, size_t max_samples)
+:   mDumpPrefix(dump_prefix),
+    mMaxDumps(max_dumps),
+    mHitchUsec((U64)(hitch_ms * 1000.f)),
+    mSeconds(seconds),
+    mNextDumpUsec(0),
+    mFrames(llmax(max_frames, (size_t)1)),
+    mFrameCount(0),
+    mSamples(llmax(max_samples, (size_t)1)),
+    mSampleCount(0)
+{
+}
+
+std::string LLFrameProfiler::recordFrame(LLTrace::Recording& frame)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
+    const U64 now = LLTimer::getTotalTime();
+    const U64 duration = (U64)(frame.getDuration().value() * 1000000.0);
+
+    Frame& record = mFrames[mFrameCount % mFrames.size()];
+    record.mStartUsec = now - llmin(duration, now);
+    record.mDurationUsec = (U32)llmin(duration, (U64)U32_MAX);
+    record.mFirstSample = mSampleCount;
+    record.mNumber = mFrameCount++;
+
+    LLTrace::BlockTimerStatHandle& root = LLTrace::BlockTimer::getRootTimeBlock();
+    for (LLTrace::BlockTimerStatHandle* child : root.getChildren())
+    {
+        recordTimer(frame, *child, 0);
+    }
+    record.mNumSamples = (U32)(mSampleCount - record.mFirstSample);
+
+    if (!mHitchUsec || !mMaxDumps || duration < mHitchUsec || now < mNextDumpUsec)
+    {
+        return std::string();
+    }
+    mNextDumpUsec = now + (U64)(mSeconds * 1000000.f);
+
+    std::shared_ptr<frame_copies_t> frames = std::make_shared<frame_copies_t>();
+    copyFrames(mSeconds, *frames);
+    std::string filename = mDumpPrefix + "_" + std::to_string(record.mNumber) + ".json";
+    LL_WARNS("FrameProfiler") << "Frame " << record.mNumber << " took " << duration / 1000 << " ms, writing the last "
+                              << frames->size() << " frames to " << filename << LL_ENDL;
+
+    // Several MB of JSON: keep it off the frame that already hitched
+    const std::string prefix = mDumpPrefix;
+    const U32 keep = mMaxDumps - 1;
+    LL::WorkQueue::ptr_t queue = LL::WorkQueue::getInstance("General");
+    if (!queue || !queue->tryPost([prefix, keep, filename, frames]()
+        {
+            LL::CpuBudget::Blocking blocking;
+            pruneDumps(prefix, keep);
+            writeTraceFile(filename, *frames);
+        }))
+    {
+        pruneDumps(prefix, keep);
+        writeTraceFile(filename, *frames);
+    }
+    return filename;
+}
+
+void LLFrameProfiler::holdDumps(F32 seconds)
+{
+    const U64 now = LLTimer::getTotalTime();
+    mNextDumpUsec = llmax(mNextDumpUsec, now + (U64)(seconds * 1000000.f));
+}
+
+void LLFrameProfiler::recordTimer(LLTrace::Recording& frame, LLTrace::BlockTimerStatHandle& timer, U32 depth)
+{
+    const F64 seconds = frame.getSum(timer).value();
+    if (seconds <= 0.0 || mSampleCount - mFrames[(mFrameCount - 1) % mFrames.size()].mFirstSample >= mSamples.size())
+    {
+        // Timers that did not run have no descendants that did
+        return;
+    }
+
+    Sample& sample = mSamples[mSampleCount++ % mSamples.size()];
+    sample.mTimer = &timer;
+    sample.mTotalUsec = (U32)llmin(seconds * 1000000.0, (F64)U32_MAX);
+    sample.mCalls = (U32)frame.getSum(timer.callCount());
+    sample.mDepth = depth;
+
+    for (LLTrace::BlockTimerStatHandle* child : timer.getChildren())
+    {
+        recordTimer(frame, *child, depth + 1);
+    }
+}
+
+size_t LLFrameProfiler::getNumFrames() const
+{
+    return (size_t)llmin(mFrameCount, (U64)mFrames.size());
+}
+
+void LLFrameProfiler::copyFrames(F32 seconds, frame_copies_t& frames) const
+{
+    frames.clear();
+    if (!mFrameCount)
+    {
+        return;
+    }
+
+    // Samples older than this have been overwritten
+    const U64 oldest_sample = mSampleCount > mSamples.size() ? mSampleCount - mSamples.size() : 0;
+    const Frame& newest = mFrames[(mFrameCount - 1) % mFrames.size()];
+    const U64 newest_end = newest.mStartUsec + newest.mDurationUsec;
+    const U64 span = (U64)(seconds * 1000000.f);
+
+    for (U64 i = 0, count = getNumFrames(); i < count; ++i)
+    {
+        const Frame& frame = mFrames[(mFrameCount - 1 - i) % mFrames.size()];
+        if (frame.mFirstSample < oldest_sample || newest_end - frame.mStartUsec > span)
+        {
+            break;
+        }
+        frames.emplace_back();
+        FrameCopy& copy = frames.back();
+        copy.mFrame = frame;
+        copy.mSamples.reserve(frame.mNumSamples);
+        for (U64 s = frame.mFirstSample, end = s + frame.mNumSamples; s < end; ++s)
+        {
+            copy.mSamples.push_back(mSamples[s % mSamples.size()]);
+        }
+    }
+    std::reverse(frames.begin(), frames.end());
+}
+
+void LLFrameProfiler::writeTrace(std::ostream& os, F32 seconds) const
+{
+    frame_copies_t frames;
+    copyFrames(seconds, frames);
+    writeTrace(os, frames);
+}
+
+//static
+void LLFrameProfiler::writeTrace(std::ostream& os, const frame_copies_t& frames)
+{
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+       << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Main\"}}";
+
+    const U64 origin = frames.empty() ? 0 : frames.front().mFrame.mStartUsec;
+    // Where the next child at each depth starts, and where its parent ends
+    std::vector<U64> next_start;
+    std::vector<U64> parent_end;
+    for (const FrameCopy& copy : frames)
+    {
+        const Frame& frame = copy.mFrame;
+        const U64 frame_start = frame.mStartUsec - origin;
+        write_event(os, "Frame " + std::to_string(frame.mNumber), "frame", frame_start, frame.mDurationUsec,
+                    "frame", frame.mNumber);
+
+        next_start.assign(1, frame_start);
+        parent_end.assign(1, frame_start + frame.mDurationUsec);
+        for (const Sample& sample : copy.mSamples)
+        {
+            const U32 depth = sample.mDepth;
+            if (depth >= next_start.size())
+            {
+                // Only happens for a frame cut short by a full sample ring
+                break;
+            }
+            const U64 start = llmin(next_start[depth], parent_end[depth]);
+            const U64 end = llmin(start + sample.mTotalUsec, parent_end[depth]);
+            write_event(os, sample.mTimer->getName(), "timer", start, end - start, "calls", sample.mCalls);
+
+            next_start[depth] = end;
+            next_start.resize(depth + 2);
+            parent_end.resize(depth + 2);
+            next_start[depth + 1] = start;
+            parent_end[depth + 1] = end;
+        }
+    }
+    os << "\n]}\n";
+}
+
+//static
+bool LLFrameProfiler::writeTraceFile(const std::string& filename, const frame_copies_t& frames)
+{
+    llofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        LL_WARNS("FrameProfiler") << "Could not write " << filename << LL_ENDL;
+        return false;
+    }
+    writeTrace(file, frames);
+    return file.good();
+}
+
+//static
+void LLFrameProfiler::pruneDumps(const std::string& dump_prefix, U32 keep)
+{
+    namespace fs = std::filesystem;
+    const fs::path prefix(dump_prefix);
+    const std::string stem = prefix.filename().string() + "_";
+    fs::path dir = prefix.parent_path();
+    if (dir.empty())
+    {
+        dir = ".";
+    }
+
+    std::vector<std::pair<fs::file_time_type, fs::path>> dumps;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const std::string name = it->path().filename().string();
+        if (name.size() > stem.size() && name.compare(0, stem.size(), stem) == 0 &&
+            it->path().extension() == ".json" && it->is_regular_file(ec))
+        {
+            dumps.emplace_back(it->last_write_time(ec), it->path());
+        }
+    }
+    if (dumps.size() <= keep)
+    {
+        return;
+    }
+
+    std::sort(dumps.begin(), dumps.end());
+    for (size_t i = 0, count = dumps.size() - keep; i < count; ++i)
+    {
+        if (!fs::remove(dumps[i].second, ec))
+        {
+            LL_WARNS("FrameProfiler") << "Could not delete old dump " << dumps[i].second.string() << LL_ENDL;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * @file llframeprofiler.h
+ * @brief Ring of per-frame block timer samples, dumped as a Chrome
+ * trace when a frame hitches
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFRAMEPROFILER_H
+#define LL_LLFRAMEPROFILER_H
+
+#include "llsingleton.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace LLTrace
+{
+    class BlockTimerStatHandle;
+    class Recording;
+}
+
+// Keeps the BlockTimerStatHandle hierarchy of each recent frame in fixed size
+// rings, and when a frame takes longer than the hitch threshold, writes the
+// last few seconds of frames to a Chrome trace event file that
+// chrome://tracing and Perfetto open.  Block timers only keep totals per
+// frame, so each timer appears once per frame with its total time, laid out
+// after its earlier siblings inside its parent.
+//
+// At most max_dumps dump files are kept: before writing a new one, the oldest
+// files matching the dump prefix are deleted, including those left by earlier
+// sessions.
+//
+// Main thread only, apart from the file writing, which goes to the "General"
+// work queue when there is one.
+class LL_COMMON_API LLFrameProfiler : public LLSimpleton<LLFrameProfiler>
+{
+public:
+    // Timers under the root, in depth first order
+    struct Sample
+    {
+        const LLTrace::BlockTimerStatHandle* mTimer;
+        U32 mTotalUsec;
+        U32 mCalls;
+        U32 mDepth;     // 0 for children of the root timer
+    };
+
+    struct Frame
+    {
+        U64 mStartUsec;
+        U32 mDurationUsec;
+        U64 mFirstSample;   // position in the sample ring, never wrapped
+        U32 mNumSamples;
+        U64 mNumber;
+    };
+
+    static const size_t DEFAULT_MAX_FRAMES = 4096;
+    static const size_t DEFAULT_MAX_SAMPLES = 1 << 18;
+    static const U32 DEFAULT_MAX_DUMPS = 10;
+
+    // Dumps go to <dump_prefix>_<frame number>.json; frames over hitch_ms
+    // trigger one, holding the frames from the last 'seconds'.  After a dump,
+    // no other starts for 'seconds', so a run of slow frames is captured once.
+    LLFrameProfiler(const std::string& dump_prefix, F32 hitch_ms, F32 seconds,
+                    U32 max_dumps = DEFAULT_MAX_DUMPS,
+                    size_t max_frames = DEFAULT_MAX_FRAMES, size_t max_samples = DEFAULT_MAX_SAMPLES);
+
+    // Call once a frame with the frame's finished recording, after
+    // LLTrace::BlockTimer::processTimes() has placed the timers in the tree.
+    // Returns the file a dump started writing to, if the frame hitched.
+    std::string recordFrame(LLTrace::Recording& frame);
+
+    // Writes the frames from the last 'seconds' as Chrome trace JSON
+    void writeTrace(std::ostream& os, F32 seconds) const;
+
+    void setHitchThreshold(F32 hitch_ms) { mHitchUsec = (U64)(hitch_ms * 1000.f); }
+
+    // No dump starts for the next 'seconds'.  For periods where long frames
+    // are expected, like logging in or teleporting; frames are still kept.
+    void holdDumps(F32 seconds);
+    size_t getNumFrames() const;
+
+private:
+    // One frame's samples, copied out of the rings for writing
+    struct FrameCopy
+    {
+        Frame mFrame;
+        std::vector<Sample> mSamples;
+    };
+    typedef std::vector<FrameCopy> frame_copies_t;
+
+    void recordTimer(LLTrace::Recording& frame, LLTrace::BlockTimerStatHandle& timer, U32 depth);
+    void copyFrames(F32 seconds, frame_copies_t& frames) const;
+    static void writeTrace(std::ostream& os, const frame_copies_t& frames);
+    static bool writeTraceFile(const std::string& filename, const frame_copies_t& frames);
+    // Deletes the oldest dumps with this prefix until at most 'keep' remain
+    static void pruneDumps(const std::string& dump_prefix, U32 keep);
+
+    std::string mDumpPrefix;
+    U32 mMaxDumps;
+    U64 mHitchUsec;
+    F32 mSeconds;
+    U64 mNextDumpUsec;
+
+    std::vector<Frame> mFrames;
+    U64 mFrameCount;
+    std::vector<Sample> mSamples;
+    U64 mSampleCount;
+};
+
+#endif // LL_LLFRAMEPROFILER_H
@@ -0,0 +1,205 @@
+/**
+ * @file llmemtag.cpp
+ * @brief Heap accounting by subsystem: allocation tags, scoped per thread
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmemtag.h"
+
+#include "llfile.h"
+#include "lltimer.h"
+#include "lltrace.h"
+
+#include <atomic>
+#include <iomanip>
+#include <ostream>
+
+namespace
+{
+    const char* const TAG_NAMES[LLMemTag::COUNT] =
+    {
+        "Other", "Image", "Volume", "Mesh", "LLSD", "Inventory", "UI"
+    };
+
+    // One cache line per tag, so threads charging different tags do not
+    // fight over the line
+    struct alignas(64) Counters
+    {
+        std::atomic<S64> mLiveBytes;
+        std::atomic<U64> mAllocatedBytes;
+        std::atomic<U64> mAllocations;
+        std::atomic<U64> mFrees;
+    };
+    Counters sCounters[LLMemTag::COUNT];
+
+    // -1 outside any scope
+    thread_local S32 sScopeTag = -1;
+
+    LLTrace::SampleStatHandle<F64Megabytes> sLiveStats[LLMemTag::COUNT] =
+    {
+        { "memtag_other", "Live tagged heap not owned by a tracked subsystem" },
+        { "memtag_image", "Live image buffers" },
+        { "memtag_volume", "Live prim volume face buffers" },
+        { "memtag_mesh", "Live mesh repository allocations" },
+        { "memtag_llsd", "Live LLSD nodes outside a tagged subsystem" },
+        { "memtag_inventory", "Live inventory allocations" },
+        { "memtag_ui", "Live UI construction allocations" }
+    };
+
+    LLTrace::CountStatHandle<F64Megabytes> sAllocStats[LLMemTag::COUNT] =
+    {
+        { "memtag_other_alloc", "Tagged heap allocated outside a tracked subsystem" },
+        { "memtag_image_alloc", "Image buffers allocated" },
+        { "memtag_volume_alloc", "Prim volume face buffers allocated" },
+        { "memtag_mesh_alloc", "Mesh repository allocations" },
+        { "memtag_llsd_alloc", "LLSD nodes allocated outside a tagged subsystem" },
+        { "memtag_inventory_alloc", "Inventory allocations" },
+        { "memtag_ui_alloc", "UI construction allocations" }
+    };
+
+    // Allocated totals at the previous updateStats() and dump()
+    U64 sStatsAllocated[LLMemTag::COUNT] = { 0 };
+    U64 sDumpAllocated[LLMemTag::COUNT] = { 0 };
+    F64 sDumpSeconds = 0.0;
+}
+
+//static
+LLMemTag::ETag LLMemTag::current(ETag fallback)
+{
+    return sScopeTag < 0 ? fallback : (ETag)sScopeTag;
+}
+
+//static
+void LLMemTag::charge(ETag tag, size_t bytes)
+{
+    Counters& counters = sCounters[tag];
+    counters.mLiveBytes.fetch_add((S64)bytes, std::memory_order_relaxed);
+    counters.mAllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.mAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+//static
+void LLMemTag::discharge(ETag tag, size_t bytes)
+{
+    Counters& counters = sCounters[tag];
+    counters.mLiveBytes.fetch_sub((S64)bytes, std::memory_order_relaxed);
+    counters.mFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+//static
+LLMemTag::Stats LLMemTag::getStats(ETag tag)
+{
+    const Counters& counters = sCounters[tag];
+    Stats stats;
+    stats.mLiveBytes = counters.mLiveBytes.load(std::memory_order_relaxed);
+    stats.mAllocatedBytes = counters.mAllocatedBytes.load(std::memory_order_relaxed);
+    stats.mAllocations = counters.mAllocations.load(std::memory_order_relaxed);
+    stats.mFrees = counters.mFrees.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//static
+const char* LLMemTag::getName(ETag tag)
+{
+    return tag < COUNT ? TAG_NAMES[tag] : "Invalid";
+}
+
+//static
+void LLMemTag::updateStats()
+{
+    for (S32 i = 0; i < COUNT; ++i)
+    {
+        const Stats stats = getStats((ETag)i);
+        sample(sLiveStats[i], F64Bytes((F64)llmax(stats.mLiveBytes, (S64)0)));
+        add(sAllocStats[i], F64Bytes((F64)(stats.mAllocatedBytes - sStatsAllocated[i])));
+        sStatsAllocated[i] = stats.mAllocatedBytes;
+    }
+}
+
+//static
+void LLMemTag::dump(std::ostream& os)
+{
+    const F64 now = LLTimer::getElapsedSeconds();
+    const F64 seconds = now - sDumpSeconds;
+    sDumpSeconds = now;
+
+    const F64 MB = 1024.0 * 1024.0;
+    os << "Memory by subsystem, rates over the last " << std::fixed << std::setprecision(1) << seconds << " s\n"
+       << std::left << std::setw(12) << "Tag" << std::right
+       << std::setw(12) << "Live MB" << std::setw(14) << "Allocated MB" << std::setw(12) << "MB/s"
+       << std::setw(14) << "Allocations" << std::setw(14) << "Frees" << "\n";
+
+    Stats total = { 0, 0, 0, 0 };
+    U64 total_recent = 0;
+    for (S32 i = 0; i < COUNT; ++i)
+    {
+        const Stats stats = getStats((ETag)i);
+        const U64 recent = stats.mAllocatedBytes - sDumpAllocated[i];
+        sDumpAllocated[i] = stats.mAllocatedBytes;
+
+        os << std::left << std::setw(12) << TAG_NAMES[i] << std::right << std::setprecision(2)
+           << std::setw(12) << stats.mLiveBytes / MB << std::setw(14) << stats.mAllocatedBytes / MB
+           << std::setw(12) << (seconds > 0.0 ? recent / MB / seconds : 0.0)
+           << std::setw(14) << stats.mAllocations << std::setw(14) << stats.mFrees << "\n";
+
+        total.mLiveBytes += stats.mLiveBytes;
+        total.mAllocatedBytes += stats.mAllocatedBytes;
+        total.mAllocations += stats.mAllocations;
+        total.mFrees += stats.mFrees;
+        total_recent += recent;
+    }
+    os << std::left << std::setw(12) << "Total" << std::right
+       << std::setw(12) << total.mLiveBytes / MB << std::setw(14) << total.mAllocatedBytes / MB
+       << std::setw(12) << (seconds > 0.0 ? total_recent / MB / seconds : 0.0)
+       << std::setw(14) << total.mAllocations << std::setw(14) << total.mFrees << "\n";
+}
+
+//static
+bool LLMemTag::dump(const std::string& filename)
+{
+    llofstream file(filename.c_str(), std::ios::out | std::ios::app);
+    if (!file.is_open())
+    {
+        LL_WARNS("MemTag") << "Could not write " << filename << LL_ENDL;
+        return false;
+    }
+    file << "\n";
+    dump(file);
+    return file.good();
+}
+
+//static
+S32 LLMemTag::push(ETag tag)
+{
+    const S32 previous = sScopeTag;
+    sScopeTag = tag;
+    return previous;
+}
+
+//static
+void LLMemTag::pop(S32 previous)
+{
+    sScopeTag = previous;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file llmemtag.h
+ * @brief Heap accounting by subsystem: allocation tags, scoped per thread
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMEMTAG_H
+#define LL_LLMEMTAG_H
+
+#include <iosfwd>
+#include <string>
+
+// Live bytes and allocation totals for each subsystem that owns heap memory.
+// Tagged allocators (LLImageBase buffers, LLVolumeFace buffers, LLSD::Impl
+// nodes) charge the bytes they allocate to a tag and discharge them when
+// they free, against the same tag.  The tag is the innermost LLMemTagScope
+// on the allocating thread, or the allocator's own tag outside any scope, so
+// an LLSD document parsed under LLMemTagScope(LLMemTag::INVENTORY) counts as
+// inventory while one parsed elsewhere counts as LLSD.
+//
+// Counters are relaxed atomics: charges are safe from any thread and cost
+// an uncontended atomic add.  Untagged heap use is not seen at all; the
+// totals say where the tagged allocators' memory went, not the process size.
+class LL_COMMON_API LLMemTag
+{
+public:
+    enum ETag : U8
+    {
+        OTHER = 0,
+        IMAGE,
+        VOLUME,
+        MESH,
+        LLSD_NODES,
+        INVENTORY,
+        UI,
+        COUNT
+    };
+
+    struct Stats
+    {
+        S64 mLiveBytes;
+        U64 mAllocatedBytes;    // ever charged
+        U64 mAllocations;
+        U64 mFrees;
+    };
+
+    // The tag to charge an allocation to: the innermost scope on this
+    // thread, or 'fallback' outside any scope
+    static ETag current(ETag fallback);
+
+    static void charge(ETag tag, size_t bytes);
+    static void discharge(ETag tag, size_t bytes);
+
+    static Stats getStats(ETag tag);
+    static const char* getName(ETag tag);
+
+    // Samples every tag into its LLTrace stats, "memtag_<name>" for the live
+    // megabytes and "memtag_<name>_alloc" for the megabytes allocated, which
+    // the statistics floater shows as a rate.  Main thread, once a frame.
+    static void updateStats();
+
+    // Writes a table of every tag, with the allocation rate since the
+    // previous dump.  The file version appends, so repeated dumps show the
+    // growth over a session.  Main thread only.
+    static void dump(std::ostream& os);
+    static bool dump(const std::string& filename);
+
+private:
+    friend class LLMemTagScope;
+
+    // Returns the tag it replaces, for the scope to put back
+    static S32 push(ETag tag);
+    static void pop(S32 previous);
+};
+
+// Charges the tagged allocations this thread makes while it lives to 'tag'.
+// Scopes nest.  Do not hold one across a coroutine suspension: the thread
+// would carry it into whatever coroutine runs next.
+class LLMemTagScope
+{
+public:
+    LLMemTagScope(LLMemTag::ETag tag)
+    :   mPrevious(LLMemTag::push(tag))
+    {
+    }
+
+    ~LLMemTagScope()
+    {
+        LLMemTag::pop(mPrevious);
+    }
+
+    LLMemTagScope(const LLMemTagScope&) = delete;
+    LLMemTagScope& operator=(const LLMemTagScope&) = delete;
+
+private:
+    S32 mPrevious;
+};
+
+#endif // LL_LLMEMTAG_H
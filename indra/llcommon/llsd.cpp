@@ -34,6 +34,7 @@
 #include "llerror.h"
 #include "../llmath/llmath.h"
 #include "llformat.h"
+#include "llmemtag.h"
 #include "llsdserialize.h"
 #include "stringize.h"
 
@@ -101,6 +102,13 @@ protected:
     bool shared() const                         { return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
 
     U32 mUseCount;
+    LLMemTag::ETag mMemTag;
+
+public:
+    // Every node is charged to the current LLMemTag; the sized delete gets
+    // the size of the most derived Impl through the virtual destructor
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
 
 public:
     static void reset(Impl*& var, Impl* impl);
@@ -746,21 +754,45 @@ namespace
     }
 }
 
+namespace
+{
+    // operator delete runs after ~Impl() on the same thread, with no object
+    // left to ask which tag it was charged to
+    thread_local LLMemTag::ETag sDeletingMemTag = LLMemTag::LLSD_NODES;
+}
+
 LLSD::Impl::Impl()
-    : mUseCount(0)
+    : mUseCount(0),
+      mMemTag(LLMemTag::current(LLMemTag::LLSD_NODES))
 {
     ++sAllocationCount;
     ++sOutstandingCount;
 }
 
 LLSD::Impl::Impl(StaticAllocationMarker)
-    : mUseCount(0)
+    : mUseCount(0),
+      mMemTag(LLMemTag::LLSD_NODES)
 {
 }
 
 LLSD::Impl::~Impl()
 {
     --sOutstandingCount;
+    sDeletingMemTag = mMemTag;
+}
+
+void* LLSD::Impl::operator new(size_t size)
+{
+    void* ptr = ::operator new(size);
+    // Same thread and scope as the constructor that follows
+    LLMemTag::charge(LLMemTag::current(LLMemTag::LLSD_NODES), size);
+    return ptr;
+}
+
+void LLSD::Impl::operator delete(void* ptr, size_t size)
+{
+    LLMemTag::discharge(sDeletingMemTag, size);
+    ::operator delete(ptr);
 }
 
 void LLSD::Impl::reset(Impl*& var, Impl* impl)
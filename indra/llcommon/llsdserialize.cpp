@@ -461,6 +461,139 @@ void LLSDParser::account(llssize bytes) const
     if(mCheckLimits) mMaxBytesLeft -= bytes;
 }
 
+S32 LLSDParser::parse(std::istream& istr, LLSDParseVisitor& visitor, llssize max_bytes, S32 max_depth)
+{
+    mCheckLimits = LLSDSerialize::SIZE_UNLIMITED != max_bytes;
+    mMaxBytesLeft = max_bytes;
+    return doVisit(istr, visitor, max_depth);
+}
+
+// virtual
+S32 LLSDParser::doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    // Correct but not streaming: subclasses override this.
+    LLSD data;
+    S32 parse_count = doParse(istr, data, max_depth);
+    if((parse_count > 0) && !visitor.visit(data))
+    {
+        parse_count = PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
+
+/**
+ * LLSDParseVisitor
+ */
+bool LLSDParseVisitor::visit(const LLSD& data)
+{
+    switch(data.type())
+    {
+    case LLSD::TypeMap:
+    {
+        if(!beginMap((S32)data.size())) return false;
+        for(LLSD::map_const_iterator iter = data.beginMap(); iter != data.endMap(); ++iter)
+        {
+            if(!mapKey(iter->first) || !visit(iter->second)) return false;
+        }
+        return endMap();
+    }
+
+    case LLSD::TypeArray:
+    {
+        if(!beginArray((S32)data.size())) return false;
+        for(LLSD::array_const_iterator iter = data.beginArray(); iter != data.endArray(); ++iter)
+        {
+            if(!visit(*iter)) return false;
+        }
+        return endArray();
+    }
+
+    default:
+        return value(data);
+    }
+}
+
+
+/**
+ * LLSDTreeBuilder
+ */
+LLSDTreeBuilder::LLSDTreeBuilder()
+    : mComplete(false)
+{
+}
+
+void LLSDTreeBuilder::reset()
+{
+    mResult.clear();
+    mStack.clear();
+    mKey.clear();
+    mComplete = false;
+}
+
+LLSD& LLSDTreeBuilder::slot()
+{
+    if(mStack.empty())
+    {
+        mComplete = false;
+        mResult.clear();
+        return mResult;
+    }
+    // Pointers into the parent stay valid: nothing is added to a parent
+    // while one of its children is still open.
+    LLSD& parent = *mStack.back();
+    if(parent.isMap())
+    {
+        return parent[mKey];
+    }
+    return parent.append(LLSD());
+}
+
+bool LLSDTreeBuilder::beginMap(S32 size)
+{
+    LLSD& map = slot();
+    map = LLSD::emptyMap();
+    mStack.push_back(&map);
+    return true;
+}
+
+bool LLSDTreeBuilder::mapKey(const std::string& key)
+{
+    mKey = key;
+    return true;
+}
+
+bool LLSDTreeBuilder::endMap()
+{
+    if(mStack.empty()) return false;
+    mStack.pop_back();
+    mComplete = mStack.empty();
+    return true;
+}
+
+bool LLSDTreeBuilder::beginArray(S32 size)
+{
+    LLSD& array = slot();
+    array = LLSD::emptyArray();
+    mStack.push_back(&array);
+    return true;
+}
+
+bool LLSDTreeBuilder::endArray()
+{
+    if(mStack.empty()) return false;
+    mStack.pop_back();
+    mComplete = mStack.empty();
+    return true;
+}
+
+bool LLSDTreeBuilder::value(const LLSD& value)
+{
+    slot() = value;
+    mComplete = mStack.empty();
+    return true;
+}
+
 
 /**
  * LLSDNotationParser
@@ -835,6 +968,182 @@ S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array, S32 max_dept
     return parse_count;
 }
 
+// virtual
+S32 LLSDNotationParser::doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    char c;
+    c = istr.peek();
+    if (max_depth == 0)
+    {
+        return PARSE_FAILURE;
+    }
+    while(isspace(c))
+    {
+        // pop the whitespace.
+        c = get(istr);
+        c = istr.peek();
+        continue;
+    }
+    if(!istr.good())
+    {
+        return 0;
+    }
+    S32 parse_count = 1;
+    switch(c)
+    {
+    case '{':
+    {
+        S32 child_count = visitMap(istr, visitor, max_depth - 1);
+        if(child_count == PARSE_FAILURE)
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        if(istr.fail())
+        {
+            LL_INFOS() << "STREAM FAILURE reading map." << LL_ENDL;
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case '[':
+    {
+        S32 child_count = visitArray(istr, visitor, max_depth - 1);
+        if(child_count == PARSE_FAILURE)
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        if(istr.fail())
+        {
+            LL_INFOS() << "STREAM FAILURE reading array." << LL_ENDL;
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    default:
+    {
+        // Scalars are cheap to build, so let doParse() handle them.
+        LLSD data;
+        parse_count = doParse(istr, data, max_depth);
+        if((parse_count > 0) && !visitor.value(data))
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+    }
+    return parse_count;
+}
+
+S32 LLSDNotationParser::visitMap(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    // map: { string:object, string:object }
+    S32 parse_count = 0;
+    char c = get(istr);
+    if(c != '{')
+    {
+        return PARSE_FAILURE;
+    }
+    if(!visitor.beginMap(-1))
+    {
+        return PARSE_FAILURE;
+    }
+    // eat commas, white
+    bool found_name = false;
+    std::string name;
+    c = get(istr);
+    while(c != '}' && istr.good())
+    {
+        if(!found_name)
+        {
+            if((c == '\"') || (c == '\'') || (c == 's'))
+            {
+                putback(istr, c);
+                found_name = true;
+                auto count = deserialize_string(istr, name, mMaxBytesLeft);
+                if(PARSE_FAILURE == count) return PARSE_FAILURE;
+                account(count);
+            }
+            c = get(istr);
+        }
+        else
+        {
+            if(isspace(c) || (c == ':'))
+            {
+                c = get(istr);
+                continue;
+            }
+            putback(istr, c);
+            if(!visitor.mapKey(name))
+            {
+                return PARSE_FAILURE;
+            }
+            S32 count = doVisit(istr, visitor, max_depth);
+            if(count <= 0)
+            {
+                // There must be a value for every key.
+                return PARSE_FAILURE;
+            }
+            parse_count += count;
+            found_name = false;
+            c = get(istr);
+        }
+    }
+    if((c != '}') || !visitor.endMap())
+    {
+        return PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
+S32 LLSDNotationParser::visitArray(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    // array: [ object, object, object ]
+    S32 parse_count = 0;
+    char c = get(istr);
+    if(c != '[')
+    {
+        return PARSE_FAILURE;
+    }
+    if(!visitor.beginArray(-1))
+    {
+        return PARSE_FAILURE;
+    }
+    // eat commas, white
+    c = get(istr);
+    while((c != ']') && istr.good())
+    {
+        if(isspace(c) || (c == ','))
+        {
+            c = get(istr);
+            continue;
+        }
+        putback(istr, c);
+        S32 count = doVisit(istr, visitor, max_depth);
+        if(PARSE_FAILURE == count)
+        {
+            return PARSE_FAILURE;
+        }
+        parse_count += count;
+        c = get(istr);
+    }
+    if((c != ']') || !visitor.endArray())
+    {
+        return PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
 bool LLSDNotationParser::parseString(std::istream& istr, LLSD& data) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
@@ -909,7 +1218,9 @@ bool LLSDNotationParser::parseBinary(std::istream& istr, LLSD& data) const
         U8* write;
         std::vector<U8> value;
         c = get(istr);
-        while(c != '"')
+        // stop at the end of the stream too, or truncated data spins
+        // here forever; doParse() reports the stream failure
+        while((c != '"') && istr.good())
         {
             putback(istr, c);
             read = buf;
@@ -920,7 +1231,11 @@ bool LLSDNotationParser::parseBinary(std::istream& istr, LLSD& data) const
             {
                 byte = hex_as_nybble(*read++);
                 byte = byte << 4;
-                byte |= hex_as_nybble(*read++);
+                // an odd digit count must not step past the terminator
+                if(*read != '\0')
+                {
+                    byte |= hex_as_nybble(*read++);
+                }
                 *write++ = byte;
             }
             // copy the data out of the byte buffer
@@ -1276,6 +1591,166 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
     return parse_count;
 }
 
+// virtual
+S32 LLSDBinaryParser::doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    char c;
+    c = get(istr);
+    if(!istr.good())
+    {
+        return 0;
+    }
+    if (max_depth == 0)
+    {
+        return PARSE_FAILURE;
+    }
+    S32 parse_count = 1;
+    switch(c)
+    {
+    case '{':
+    {
+        S32 child_count = visitMap(istr, visitor, max_depth - 1);
+        if(child_count == PARSE_FAILURE)
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        if(istr.fail())
+        {
+            LL_INFOS() << "STREAM FAILURE reading binary map." << LL_ENDL;
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case '[':
+    {
+        S32 child_count = visitArray(istr, visitor, max_depth - 1);
+        if(child_count == PARSE_FAILURE)
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        if(istr.fail())
+        {
+            LL_INFOS() << "STREAM FAILURE reading binary array." << LL_ENDL;
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    default:
+    {
+        // Scalars are cheap to build, so let doParse() handle them.
+        putback(istr, c);
+        LLSD data;
+        parse_count = doParse(istr, data, max_depth);
+        if((parse_count > 0) && !visitor.value(data))
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+    }
+    return parse_count;
+}
+
+S32 LLSDBinaryParser::visitMap(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    U32 value_nbo = 0;
+    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
+    S32 size = (S32)ntohl(value_nbo);
+    if(!visitor.beginMap(size))
+    {
+        return PARSE_FAILURE;
+    }
+    S32 parse_count = 0;
+    S32 count = 0;
+    std::string name;
+    char c = get(istr);
+    while(c != '}' && (count < size) && istr.good())
+    {
+        name.clear();
+        switch(c)
+        {
+        case 'k':
+            if(!parseString(istr, name))
+            {
+                return PARSE_FAILURE;
+            }
+            break;
+        case '\'':
+        case '"':
+        {
+            auto cnt = deserialize_string_delim(istr, name, c);
+            if(PARSE_FAILURE == cnt) return PARSE_FAILURE;
+            account(cnt);
+            break;
+        }
+        }
+        if(!visitor.mapKey(name))
+        {
+            return PARSE_FAILURE;
+        }
+        S32 child_count = doVisit(istr, visitor, max_depth);
+        if(child_count <= 0)
+        {
+            // There must be a value for every key.
+            return PARSE_FAILURE;
+        }
+        parse_count += child_count;
+        ++count;
+        c = get(istr);
+    }
+    if((c != '}') || (count < size) || !visitor.endMap())
+    {
+        // Make sure it is correctly terminated and we parsed as many
+        // as were said to be there.
+        return PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
+S32 LLSDBinaryParser::visitArray(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    U32 value_nbo = 0;
+    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
+    S32 size = (S32)ntohl(value_nbo);
+    if(!visitor.beginArray(size))
+    {
+        return PARSE_FAILURE;
+    }
+    S32 parse_count = 0;
+    S32 count = 0;
+    char c = istr.peek();
+    while((c != ']') && (count < size) && istr.good())
+    {
+        S32 child_count = doVisit(istr, visitor, max_depth);
+        if(PARSE_FAILURE == child_count)
+        {
+            return PARSE_FAILURE;
+        }
+        parse_count += child_count;
+        ++count;
+        c = istr.peek();
+    }
+    c = get(istr);
+    if((c != ']') || (count < size) || !visitor.endArray())
+    {
+        // Make sure it is correctly terminated and we parsed as many
+        // as were said to be there.
+        return PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
 bool LLSDBinaryParser::parseString(
     std::istream& istr,
     std::string& value) const
@@ -1297,6 +1772,264 @@ bool LLSDBinaryParser::parseString(
 }
 
 
+/**
+ * LLSDBinaryCursor
+ */
+LLSDBinaryCursor::LLSDBinaryCursor(const U8* data, size_t size, S32 max_depth)
+    : mData(data),
+      mLength(data ? size : 0),
+      mPos(0),
+      mMaxDepth(max_depth),
+      mToken(TOKEN_END),
+      mCount(0),
+      mStarted(false),
+      mSkipping(false)
+{
+}
+
+LLSDBinaryCursor::EToken LLSDBinaryCursor::fail()
+{
+    mKey.clear();
+    mValue.clear();
+    return TOKEN_ERROR;
+}
+
+bool LLSDBinaryCursor::readBytes(void* dest, size_t count)
+{
+    if(count > mLength - mPos) return false;
+    if(dest)
+    {
+        memcpy(dest, mData + mPos, count);     /* Flawfinder: ignore */
+    }
+    mPos += count;
+    return true;
+}
+
+bool LLSDBinaryCursor::readSize(S32& size)
+{
+    U32 size_nbo = 0;
+    if(!readBytes(&size_nbo, sizeof(U32))) return false;
+    size = (S32)ntohl(size_nbo);
+    return (size >= 0);
+}
+
+LLSDBinaryCursor::EToken LLSDBinaryCursor::next()
+{
+    if(TOKEN_ERROR == mToken)
+    {
+        // errors are sticky
+        return mToken;
+    }
+    mCount = 0;
+    if(mStack.empty())
+    {
+        if(mStarted)
+        {
+            mValue.clear();
+            return mToken = TOKEN_END;
+        }
+        mStarted = true;
+        return mToken = readElement();
+    }
+
+    Frame& frame = mStack.back();
+    if(frame.mIsMap && frame.mWantKey)
+    {
+        if(frame.mRemaining <= 0)
+        {
+            if((mPos >= mLength) || (mData[mPos] != '}')) return mToken = fail();
+            ++mPos;
+            mStack.pop_back();
+            return mToken = TOKEN_MAP_END;
+        }
+        if(!readKey()) return mToken = fail();
+        frame.mWantKey = false;
+        return mToken = TOKEN_KEY;
+    }
+    if(!frame.mIsMap && (frame.mRemaining <= 0))
+    {
+        if((mPos >= mLength) || (mData[mPos] != ']')) return mToken = fail();
+        ++mPos;
+        mStack.pop_back();
+        return mToken = TOKEN_ARRAY_END;
+    }
+
+    // readElement() may push a new frame, so update this one first.
+    --frame.mRemaining;
+    frame.mWantKey = true;
+    return mToken = readElement();
+}
+
+bool LLSDBinaryCursor::skip()
+{
+    if(TOKEN_ERROR == mToken) return false;
+
+    mSkipping = true;
+    bool success = true;
+    if((mToken != TOKEN_MAP_BEGIN) && (mToken != TOKEN_ARRAY_BEGIN))
+    {
+        EToken token = next();
+        if((token != TOKEN_MAP_BEGIN) && (token != TOKEN_ARRAY_BEGIN))
+        {
+            mSkipping = false;
+            return (TOKEN_VALUE == token);
+        }
+    }
+    S32 target_depth = depth() - 1;
+    while(success && (depth() > target_depth))
+    {
+        EToken token = next();
+        success = (token != TOKEN_ERROR) && (token != TOKEN_END);
+    }
+    mSkipping = false;
+    return success;
+}
+
+bool LLSDBinaryCursor::readKey()
+{
+    if(mPos >= mLength) return false;
+    char c = (char)mData[mPos++];
+    switch(c)
+    {
+    case 'k':
+    {
+        S32 size = 0;
+        if(!readSize(size) || ((size_t)size > mLength - mPos)) return false;
+        if(!mSkipping)
+        {
+            mKey.assign((const char*)mData + mPos, size);
+        }
+        mPos += size;
+        return true;
+    }
+
+    case '\'':
+    case '"':
+    {
+        // notation style key, rare enough to go through the stream helper
+        boost::iostreams::stream<boost::iostreams::array_source> istr(
+            (const char*)mData + mPos, mLength - mPos);
+        llssize count = deserialize_string_delim(istr, mKey, c);
+        if(LLSDParser::PARSE_FAILURE == count) return false;
+        mPos += count;
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+LLSDBinaryCursor::EToken LLSDBinaryCursor::readElement()
+{
+    if(mPos >= mLength) return fail();
+    if((mMaxDepth >= 0) && (depth() >= mMaxDepth)) return fail();
+
+    char c = (char)mData[mPos++];
+    if(!mSkipping)
+    {
+        mValue.clear();
+    }
+    switch(c)
+    {
+    case '{':
+    case '[':
+    {
+        S32 size = 0;
+        if(!readSize(size)) return fail();
+        mStack.push_back({ c == '{', true, size });
+        mCount = size;
+        return (c == '{') ? TOKEN_MAP_BEGIN : TOKEN_ARRAY_BEGIN;
+    }
+
+    case '!':
+        break;
+
+    case '0':
+    case '1':
+        if(!mSkipping) mValue = (c == BINARY_TRUE_SERIAL);
+        break;
+
+    case 'i':
+    {
+        U32 value_nbo = 0;
+        if(!readBytes(&value_nbo, sizeof(U32))) return fail();
+        if(!mSkipping) mValue = (S32)ntohl(value_nbo);
+        break;
+    }
+
+    case 'r':
+    {
+        F64 real_nbo = 0.0;
+        if(!readBytes(&real_nbo, sizeof(F64))) return fail();
+        if(!mSkipping) mValue = ll_ntohd(real_nbo);
+        break;
+    }
+
+    case 'u':
+    {
+        LLUUID id;
+        if(!readBytes(id.mData, UUID_BYTES)) return fail();
+        if(!mSkipping) mValue = id;
+        break;
+    }
+
+    case 'd':
+    {
+        F64 real = 0.0;
+        if(!readBytes(&real, sizeof(F64))) return fail();
+        if(!mSkipping) mValue = LLDate(real);
+        break;
+    }
+
+    case 's':
+    case 'l':
+    case 'b':
+    {
+        S32 size = 0;
+        if(!readSize(size) || ((size_t)size > mLength - mPos)) return fail();
+        if(!mSkipping)
+        {
+            const char* start = (const char*)mData + mPos;
+            if('b' == c)
+            {
+                mValue = std::vector<U8>((const U8*)start, (const U8*)start + size);
+            }
+            else if('l' == c)
+            {
+                mValue = LLURI(std::string(start, size));
+            }
+            else
+            {
+                mValue = std::string(start, size);
+            }
+        }
+        mPos += size;
+        break;
+    }
+
+    case '\'':
+    case '"':
+    {
+        boost::iostreams::stream<boost::iostreams::array_source> istr(
+            (const char*)mData + mPos, mLength - mPos);
+        std::string value;
+        llssize count = deserialize_string_delim(istr, value, c);
+        if(LLSDParser::PARSE_FAILURE == count) return fail();
+        if(!mSkipping) mValue = value;
+        mPos += count;
+        break;
+    }
+
+    default:
+        LL_INFOS() << "Unrecognized character while parsing: int(" << int(c)
+            << ")" << LL_ENDL;
+        return fail();
+    }
+    return TOKEN_VALUE;
+}
+
+
 /**
  * LLSDFormatter
  */
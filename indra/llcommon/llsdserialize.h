@@ -34,6 +34,93 @@
 #include "llrefcount.h"
 #include "llsd.h"
 
+/**
+ * @class LLSDParseVisitor
+ * @brief Event interface for parsing LLSD without building a tree.
+ *
+ * Pass a visitor to LLSDParser::parse() instead of an LLSD to receive
+ * one callback per element as the stream is read. Maps and arrays are
+ * only bracketed by begin/end calls; each scalar is delivered as a
+ * small LLSD. The caller decides what, if anything, to keep. Return
+ * false from any callback to abandon the parse, which then returns
+ * PARSE_FAILURE.
+ */
+class LL_COMMON_API LLSDParseVisitor
+{
+public:
+    virtual ~LLSDParseVisitor() = default;
+
+    /**
+     * @brief A map starts.
+     * @param size The number of entries announced by the format, or -1
+     * when the format does not say (notation and XML).
+     */
+    virtual bool beginMap(S32 size)                 { return true; }
+    /**
+     * @brief The next event is the value stored under this key.
+     */
+    virtual bool mapKey(const std::string& key)     { return true; }
+    virtual bool endMap()                           { return true; }
+
+    /**
+     * @brief An array starts.
+     * @param size The number of elements announced by the format, or -1.
+     */
+    virtual bool beginArray(S32 size)               { return true; }
+    virtual bool endArray()                         { return true; }
+
+    /**
+     * @brief Any non-container value, including undefined.
+     */
+    virtual bool value(const LLSD& value)           { return true; }
+
+    /**
+     * @brief Feed an already built tree through this visitor.
+     * @return Returns false if a callback stopped the walk.
+     */
+    bool visit(const LLSD& data);
+};
+
+/**
+ * @class LLSDTreeBuilder
+ * @brief Visitor which assembles the events it receives back into LLSD.
+ *
+ * Useful on its own to materialize only part of a document: forward
+ * the events of an interesting sub-element to a builder and take the
+ * result once complete() becomes true.
+ */
+class LL_COMMON_API LLSDTreeBuilder : public LLSDParseVisitor
+{
+public:
+    LLSDTreeBuilder();
+
+    bool beginMap(S32 size) override;
+    bool mapKey(const std::string& key) override;
+    bool endMap() override;
+    bool beginArray(S32 size) override;
+    bool endArray() override;
+    bool value(const LLSD& value) override;
+
+    /**
+     * @brief True once a whole top level element has been received.
+     */
+    bool complete() const               { return mComplete; }
+    const LLSD& result() const          { return mResult; }
+
+    /**
+     * @brief Forget the current result and get ready for a new element.
+     */
+    void reset();
+
+private:
+    LLSD& slot();
+
+    LLSD mResult;
+    std::vector<LLSD*> mStack;
+    std::string mKey;
+    bool mComplete;
+};
+
 /**
  * @class LLSDParser
  * @brief Abstract base class for LLSD parsers.
@@ -79,6 +166,21 @@ public:
      */
     S32 parse(std::istream& istr, LLSD& data, llssize max_bytes, S32 max_depth = -1);
 
+    /**
+     * @brief Parse a stream for LLSD, reporting each element to a
+     * visitor instead of building a tree.
+     *
+     * Same stream, byte limit and depth semantics as the LLSD& flavor.
+     * @param istr The input stream.
+     * @param visitor Receives the parse events.
+     * @param max_bytes The maximum number of bytes that will be in
+     * the stream, or LLSDSerialize::SIZE_UNLIMITED.
+     * @param max_depth Max container depth, -1 - unlimited.
+     * @return Returns the number of LLSD objects visited. Returns
+     * PARSE_FAILURE (-1) on parse failure or if the visitor stopped.
+     */
+    S32 parse(std::istream& istr, LLSDParseVisitor& visitor, llssize max_bytes, S32 max_depth = -1);
+
     /** Like parse(), but uses a different call (istream.getline()) to read by lines
      *  This API is better suited for XML, where the parse cannot tell
      *  where the document actually ends.
@@ -110,6 +212,20 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const = 0;
 
+    /**
+     * @brief Virtual base for doing an event driven parse.
+     *
+     * The default implementation builds the tree with doParse() and
+     * replays it into the visitor; subclasses override this to stream.
+     * @param istr The input stream.
+     * @param visitor Receives the parse events.
+     * @param max_depth Max depth parser will check before exiting
+     *  with parse error, -1 - unlimited.
+     * @return Returns the number of LLSD objects visited. Returns
+     * PARSE_FAILURE (-1) on parse failure.
+     */
+    virtual S32 doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth = -1) const;
+
     /**
      * @brief Virtual default function for resetting the parser
      */
@@ -250,6 +366,11 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    /**
+     * @brief Streaming flavor of doParse(), see LLSDParser::doVisit().
+     */
+    virtual S32 doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth = -1) const;
+
 private:
     /**
      * @brief Parse a map from the istream
@@ -271,6 +392,12 @@ private:
      */
     S32 parseArray(std::istream& istr, LLSD& array, S32 max_depth) const;
 
+    /**
+     * @brief Visitor counterparts of parseMap() and parseArray().
+     */
+    S32 visitMap(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const;
+    S32 visitArray(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const;
+
     /**
      * @brief Parse a string from the istream and assign it to data.
      *
@@ -327,6 +454,11 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    /**
+     * @brief Streaming flavor of doParse(), see LLSDParser::doVisit().
+     */
+    virtual S32 doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth = -1) const;
+
     /**
      * @brief Virtual default function for resetting the parser
      */
@@ -377,6 +509,11 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    /**
+     * @brief Streaming flavor of doParse(), see LLSDParser::doVisit().
+     */
+    virtual S32 doVisit(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth = -1) const;
+
 private:
     /**
      * @brief Parse a map from the istream
@@ -398,6 +535,12 @@ private:
      */
     S32 parseArray(std::istream& istr, LLSD& array, S32 max_depth) const;
 
+    /**
+     * @brief Visitor counterparts of parseMap() and parseArray().
+     */
+    S32 visitMap(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const;
+    S32 visitArray(std::istream& istr, LLSDParseVisitor& visitor, S32 max_depth) const;
+
     /**
      * @brief Parse a string from the istream and assign it to data.
      *
@@ -409,6 +552,138 @@ private:
 };
 
 
+/**
+ * @class LLSDBinaryCursor
+ * @brief Pull parser over a complete binary LLSD buffer held in memory.
+ *
+ * Rather than receiving callbacks, the caller asks for one token at a
+ * time and may skip() whole sub-elements without materializing them.
+ * The buffer is not copied and must outlive the cursor. Typical use:
+ *
+ * <code>
+ *  LLSDBinaryCursor cursor(buffer, size);<br>
+ *  if (cursor.next() != LLSDBinaryCursor::TOKEN_MAP_BEGIN) return;<br>
+ *  while (cursor.next() == LLSDBinaryCursor::TOKEN_KEY)<br>
+ *  {<br>
+ *      if (cursor.key() != "version") { cursor.skip(); continue; }<br>
+ *      if (cursor.next() == LLSDBinaryCursor::TOKEN_VALUE)<br>
+ *          version = cursor.value().asInteger();<br>
+ *  }<br>
+ * </code>
+ */
+class LL_COMMON_API LLSDBinaryCursor
+{
+public:
+    typedef enum e_token
+    {
+        TOKEN_END,          // the top level element is finished
+        TOKEN_ERROR,        // malformed or truncated data, sticky
+        TOKEN_MAP_BEGIN,    // size() holds the announced entry count
+        TOKEN_MAP_END,
+        TOKEN_ARRAY_BEGIN,  // size() holds the announced element count
+        TOKEN_ARRAY_END,
+        TOKEN_KEY,          // key() holds the map key
+        TOKEN_VALUE         // value() holds a scalar
+    } EToken;
+
+    /**
+     * @param data Start of the binary LLSD, without any "<? LLSD/Binary ?>"
+     * header.
+     * @param size Number of bytes available at data.
+     * @param max_depth Max container depth, -1 - unlimited.
+     */
+    LLSDBinaryCursor(const U8* data, size_t size, S32 max_depth = -1);
+
+    /**
+     * @brief Advance to the next token.
+     */
+    EToken next();
+
+    /**
+     * @brief Step over the element that would be returned by the next
+     * call to next(), or if the last token was a MAP_BEGIN or
+     * ARRAY_BEGIN, over the rest of that container including its end.
+     * @return Returns false on malformed data.
+     */
+    bool skip();
+
+    EToken token() const                { return mToken; }
+    const std::string& key() const      { return mKey; }
+    const LLSD& value() const           { return mValue; }
+    S32 size() const                    { return mCount; }
+
+    /**
+     * @brief Number of containers currently open.
+     */
+    S32 depth() const                   { return (S32)mStack.size(); }
+
+    /**
+     * @brief Number of bytes consumed so far.
+     */
+    size_t offset() const               { return mPos; }
+
+private:
+    struct Frame
+    {
+        bool mIsMap;
+        bool mWantKey;
+        S32 mRemaining;
+    };
+
+    EToken readElement();
+    bool readKey();
+    bool readBytes(void* dest, size_t count);
+    bool readSize(S32& size);
+    EToken fail();
+
+    const U8* mData;
+    size_t mLength;
+    size_t mPos;
+    S32 mMaxDepth;
+    std::vector<Frame> mStack;
+    EToken mToken;
+    std::string mKey;
+    LLSD mValue;
+    S32 mCount;
+    bool mStarted;
+    bool mSkipping;
+};
+
+/**
+ * @class LLSDFastParse
+ * @brief Vectorized parsers for complete XML and notation documents in
+ * memory.
+ *
+ * These only handle the well formed subset of each format that viewers
+ * and simulators produce, and give up with FALLBACK on anything else so
+ * that the caller can hand the same buffer to the stream parser. Use
+ * LLSDSerialize::fromXMLBuffer() and fromNotationBuffer(), which do
+ * exactly that, rather than calling these directly.
+ */
+class LL_COMMON_API LLSDFastParse
+{
+public:
+    enum
+    {
+        FALLBACK = -2
+    };
+
+    /**
+     * @brief Parse an XML document.
+     * @return The number of LLSD objects parsed, as the stream parser
+     * would return, or FALLBACK.
+     */
+    static S32 parseXML(LLSD& data, const char* buf, size_t len);
+
+    /**
+     * @brief Parse one notation object.
+     * @param max_depth Max depth parser will check before exiting with
+     *  FALLBACK, -1 - unlimited.
+     * @return The number of LLSD objects parsed or FALLBACK.
+     */
+    static S32 parseNotation(LLSD& data, const char* buf, size_t len, S32 max_depth = -1);
+};
+
 /**
  * @class LLSDFormatter
  * @brief Abstract base class for formatting LLSD.
@@ -790,6 +1065,12 @@ public:
         (void)p->parse(str, sd, max_bytes);
         return sd;
     }
+    /**
+     * @brief Parse notation from a complete buffer, using LLSDFastParse
+     * when it can. Same results as fromNotation().
+     */
+    static S32 fromNotationBuffer(LLSD& sd, const char* buf, size_t len,
+                                  llssize max_bytes = SIZE_UNLIMITED);
 
     /*
      * XML Methods
@@ -825,6 +1106,11 @@ public:
         return fromXMLEmbedded(sd, str, emit_errors);
 //      return fromXMLDocument(sd, str, emit_errors);
     }
+    /**
+     * @brief Parse a complete XML document held in memory, using
+     * LLSDFastParse when it can. Same results as fromXML().
+     */
+    static S32 fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors=true);
 
     /*
      * Binary Methods
@@ -846,6 +1132,25 @@ public:
         (void)p->parse(str, sd, max_bytes, max_depth);
         return sd;
     }
+
+    /*
+     * Streaming (visitor) methods
+     */
+    static S32 visitNotation(LLSDParseVisitor& visitor, std::istream& str, llssize max_bytes)
+    {
+        LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
+        return p->parse(str, visitor, max_bytes);
+    }
+    static S32 visitXML(LLSDParseVisitor& visitor, std::istream& str, bool emit_errors=true)
+    {
+        LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+        return p->parse(str, visitor, LLSDSerialize::SIZE_UNLIMITED);
+    }
+    static S32 visitBinary(LLSDParseVisitor& visitor, std::istream& str, llssize max_bytes, S32 max_depth = -1)
+    {
+        LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
+        return p->parse(str, visitor, max_bytes, max_depth);
+    }
 };
 
 class LL_COMMON_API LLUZipHelper : public LLRefCount
@@ -0,0 +1,1806 @@
+/**
+ * @file llsdserialize_fast.cpp
+ * @brief Vectorized LLSD XML and notation parsers for in-memory buffers
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdserialize.h"
+
+#include <sstream>
+#include "apr_base64.h"
+
+#include "lldate.h"
+#include "llmemorystream.h"
+#include "llsd.h"
+#include "llstring.h"
+#include "lluri.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LL_LLSD_FAST_SSE2 1
+#include <emmintrin.h>
+#else
+#define LL_LLSD_FAST_SSE2 0
+#endif
+
+#if LL_WINDOWS
+#include <intrin.h>
+#endif
+
+// The parsers in this file only accept the subset of each format that
+// the viewer and simulator actually produce. Whenever they meet
+// anything else -- malformed input, DTDs, processing instructions,
+// duplicate keys handled differently by the two stream parsers, and so
+// on -- they give up with LLSDFastParse::FALLBACK and the caller hands
+// the same buffer to the stream parser, which stays the reference for
+// every corner case and every error message.
+
+namespace
+{
+
+// Deeper documents go to the stream parsers rather than risking the
+// C++ stack here.
+const S32 MAX_FAST_DEPTH = 256;
+
+const S32 FAIL = LLSDFastParse::FALLBACK;
+
+inline U32 lowest_bit(U32 mask)
+{
+#if LL_WINDOWS
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (U32)index;
+#else
+    return (U32)__builtin_ctz(mask);
+#endif
+}
+
+inline bool is_xml_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+// isspace() in the "C" locale, which is what the notation parser sees.
+inline bool is_c_space(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_alpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline bool is_name_start(char c)
+{
+    return is_alpha(c) || c == '_' || c == ':';
+}
+
+inline bool is_name_char(char c)
+{
+    return is_name_start(c) || is_digit(c) || c == '-' || c == '.';
+}
+
+/**
+ * Vectorized scanners
+ */
+
+// Returns the first '<' in [p, end), or end, and sets 'special' when a
+// byte before it needs more than a straight copy: '&', '\r', ']',
+// control characters other than tab and newline, or non-ASCII bytes.
+const char* scan_xml_text(const char* p, const char* end, bool& special)
+{
+#if LL_LLSD_FAST_SSE2
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i bracket = _mm_set1_epi8(']');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        U32 stop = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lt));
+        // the signed compare catches both control characters and
+        // bytes >= 0x80
+        __m128i odd = _mm_andnot_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, nl)),
+            _mm_cmplt_epi8(v, space));
+        odd = _mm_or_si128(odd, _mm_cmpeq_epi8(v, amp));
+        odd = _mm_or_si128(odd, _mm_cmpeq_epi8(v, cr));
+        odd = _mm_or_si128(odd, _mm_cmpeq_epi8(v, bracket));
+        U32 flags = _mm_movemask_epi8(odd);
+        if (stop)
+        {
+            U32 index = lowest_bit(stop);
+            special = special || (flags & ((1u << index) - 1)) != 0;
+            return p + index;
+        }
+        special = special || flags != 0;
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p)
+    {
+        U8 c = (U8)*p;
+        if (c == '<')
+        {
+            return p;
+        }
+        if (c == '&' || c == '\r' || c == ']' || c >= 0x80
+            || (c < 0x20 && c != '\t' && c != '\n'))
+        {
+            special = true;
+        }
+    }
+    return end;
+}
+
+// Returns the first of 'a' or 'b' in [p, end), or end.
+const char* find_either(const char* p, const char* end, char a, char b)
+{
+#if LL_LLSD_FAST_SSE2
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        U32 mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (mask)
+        {
+            return p + lowest_bit(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p)
+    {
+        if (*p == a || *p == b)
+        {
+            return p;
+        }
+    }
+    return end;
+}
+
+// Copies [p, end) to 'out' without the whitespace the XML parser's
+// "\\s" regex strips from base64 content. Returns false on non-ASCII
+// bytes, where the regex's idea of whitespace depends on the locale.
+bool strip_base64_space(const char* p, const char* end, std::string& out)
+{
+    out.resize(end - p);
+    char* dst = out.empty() ? NULL : &out[0];
+    char* const begin = dst;
+#if LL_LLSD_FAST_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        if (_mm_movemask_epi8(v))
+        {
+            return false;
+        }
+        __m128i ws = _mm_or_si128(
+            _mm_cmpeq_epi8(v, space),
+            _mm_and_si128(_mm_cmpgt_epi8(v, below_tab), _mm_cmplt_epi8(v, above_cr)));
+        U32 mask = _mm_movemask_epi8(ws);
+        if (!mask)
+        {
+            _mm_storeu_si128((__m128i*)dst, v);
+            dst += 16;
+        }
+        else
+        {
+            for (S32 i = 0; i < 16; ++i)
+            {
+                if (!(mask & (1u << i)))
+                {
+                    *dst++ = p[i];
+                }
+            }
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p)
+    {
+        if ((U8)*p >= 0x80)
+        {
+            return false;
+        }
+        if (!is_c_space(*p))
+        {
+            *dst++ = *p;
+        }
+    }
+    out.resize(dst - begin);
+    return true;
+}
+
+/**
+ * Character data
+ */
+
+// Length of the UTF-8 sequence at p if expat would accept it, else 0:
+// no overlong forms, surrogates, values past U+10FFFF or the
+// non-characters U+FFFE and U+FFFF.
+size_t utf8_length(const U8* p, const U8* end)
+{
+    U8 c = p[0];
+    if (c < 0xC2)
+    {
+        return 0;
+    }
+    if (c < 0xE0)
+    {
+        return (end - p >= 2 && (p[1] & 0xC0) == 0x80) ? 2 : 0;
+    }
+    if (c < 0xF0)
+    {
+        if (end - p < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80
+            || (c == 0xE0 && p[1] < 0xA0)
+            || (c == 0xED && p[1] >= 0xA0)
+            || (c == 0xEF && p[1] == 0xBF && p[2] >= 0xBE))
+        {
+            return 0;
+        }
+        return 3;
+    }
+    if (c < 0xF5)
+    {
+        if (end - p < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80
+            || (p[3] & 0xC0) != 0x80
+            || (c == 0xF0 && p[1] < 0x90)
+            || (c == 0xF4 && p[1] >= 0x90))
+        {
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+bool is_xml_char(U32 code)
+{
+    return code == 0x9 || code == 0xA || code == 0xD
+        || (code >= 0x20 && code <= 0xD7FF)
+        || (code >= 0xE000 && code <= 0xFFFD)
+        || (code >= 0x10000 && code <= 0x10FFFF);
+}
+
+void append_utf8(U32 code, std::string& out)
+{
+    if (code < 0x80)
+    {
+        out += (char)code;
+    }
+    else if (code < 0x800)
+    {
+        out += (char)(0xC0 | (code >> 6));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        out += (char)(0xE0 | (code >> 12));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | (code >> 18));
+        out += (char)(0x80 | ((code >> 12) & 0x3F));
+        out += (char)(0x80 | ((code >> 6) & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+// Decodes the entity or character reference starting at the '&' at p.
+bool decode_reference(const char*& p, const char* end, std::string* out)
+{
+    const char* limit = (end - p > 12) ? p + 12 : end;
+    const char* semi = (const char*)memchr(p, ';', limit - p);
+    if (!semi)
+    {
+        return false;
+    }
+    const char* name = p + 1;
+    size_t len = semi - name;
+    char c = 0;
+    if (len == 2 && name[0] == 'l' && name[1] == 't') c = '<';
+    else if (len == 2 && name[0] == 'g' && name[1] == 't') c = '>';
+    else if (len == 3 && !memcmp(name, "amp", 3)) c = '&';
+    else if (len == 4 && !memcmp(name, "quot", 4)) c = '"';
+    else if (len == 4 && !memcmp(name, "apos", 4)) c = '\'';
+
+    if (c)
+    {
+        if (out) *out += c;
+        p = semi + 1;
+        return true;
+    }
+
+    if (len < 2 || name[0] != '#')
+    {
+        return false;
+    }
+    U32 code = 0;
+    if (name[1] == 'x')
+    {
+        if (len < 3)
+        {
+            return false;
+        }
+        for (const char* d = name + 2; d < semi; ++d)
+        {
+            U32 nybble;
+            if (is_digit(*d)) nybble = *d - '0';
+            else if (*d >= 'a' && *d <= 'f') nybble = *d - 'a' + 10;
+            else if (*d >= 'A' && *d <= 'F') nybble = *d - 'A' + 10;
+            else return false;
+            code = (code << 4) | nybble;
+        }
+    }
+    else
+    {
+        for (const char* d = name + 1; d < semi; ++d)
+        {
+            if (!is_digit(*d))
+            {
+                return false;
+            }
+            code = code * 10 + (*d - '0');
+        }
+    }
+    // the window is too short for the value to wrap around a U32
+    if (!is_xml_char(code))
+    {
+        return false;
+    }
+    if (out) append_utf8(code, *out);
+    p = semi + 1;
+    return true;
+}
+
+// Slow path for character data that scan_xml_text() flagged: decodes
+// references (when 'markup' is set, i.e. outside CDATA and comments),
+// normalizes line ends the way expat does and rejects anything expat
+// would refuse. 'out' may be NULL to only validate.
+bool decode_xml_text(const char* p, const char* end, std::string* out, bool markup)
+{
+    while (p < end)
+    {
+        U8 c = (U8)*p;
+        if (c == '&' && markup)
+        {
+            if (!decode_reference(p, end, out))
+            {
+                return false;
+            }
+            continue;
+        }
+        if (c == '\r')
+        {
+            if (out) *out += '\n';
+            ++p;
+            if (p < end && *p == '\n')
+            {
+                ++p;
+            }
+            continue;
+        }
+        if (c == ']' && markup && end - p >= 3 && p[1] == ']' && p[2] == '>')
+        {
+            return false;
+        }
+        if (c >= 0x80)
+        {
+            size_t len = utf8_length((const U8*)p, (const U8*)end);
+            if (!len)
+            {
+                return false;
+            }
+            if (out) out->append(p, len);
+            p += len;
+            continue;
+        }
+        if (c < 0x20 && c != '\t' && c != '\n')
+        {
+            return false;
+        }
+        if (out) *out += (char)c;
+        ++p;
+    }
+    return true;
+}
+
+/**
+ * Numbers
+ */
+
+const F64 POW10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Scans [+-]digits[.digits][(e|E)[+-]digits] from p, the grammar
+// std::num_get accepts for a double. Returns the end of the number or
+// NULL when the text is not one of those. When the mantissa has at
+// most 15 significant digits and the exponent is within the exactly
+// representable powers of ten, a single multiply or divide of two
+// exact values gives the correctly rounded result and 'exact' is set;
+// otherwise the caller converts the token the same way the stream
+// parser does.
+const char* scan_real(const char* p, const char* end, F64& value, bool& exact)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+    U64 mantissa = 0;
+    S32 digits = 0;
+    S32 significant = 0;
+    S32 exponent = 0;
+    for (; p < end && is_digit(*p); ++p, ++digits)
+    {
+        if (mantissa || *p != '0')
+        {
+            ++significant;
+            if (significant <= 18)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+            else
+            {
+                ++exponent;
+            }
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && is_digit(*p); ++p, ++digits)
+        {
+            if (mantissa || *p != '0')
+            {
+                ++significant;
+                if (significant <= 18)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    --exponent;
+                }
+            }
+            else
+            {
+                --exponent;
+            }
+        }
+    }
+    if (!digits)
+    {
+        return NULL;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negative_exp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative_exp = (*p == '-');
+            ++p;
+        }
+        if (p == end || !is_digit(*p))
+        {
+            return NULL;
+        }
+        S32 e = 0;
+        for (; p < end && is_digit(*p); ++p)
+        {
+            if (e < 100000)
+            {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        exponent += negative_exp ? -e : e;
+    }
+
+    exact = false;
+    if (significant <= 15)
+    {
+        F64 m = (F64)mantissa;
+        if (!mantissa)
+        {
+            value = 0.0;
+            exact = true;
+        }
+        else if (exponent >= 0 && exponent <= 22)
+        {
+            value = m * POW10[exponent];
+            exact = true;
+        }
+        else if (exponent < 0 && exponent >= -22)
+        {
+            value = m / POW10[-exponent];
+            exact = true;
+        }
+        if (exact && negative)
+        {
+            value = -value;
+        }
+    }
+    return p;
+}
+
+// Converts a token the way the stream parsers do when scan_real()
+// could not do it exactly.
+bool stream_real(const char* begin, const char* end, F64& value)
+{
+    std::string token(begin, end);
+    std::istringstream istr(token);
+    value = 0.0;
+    istr >> value;
+    return !istr.fail();
+}
+
+// Parses exactly [+-]digits into a S32, rejecting overflow.
+const char* scan_integer(const char* p, const char* end, S32& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+    const char* digits = p;
+    S64 magnitude = 0;
+    for (; p < end && is_digit(*p); ++p)
+    {
+        magnitude = magnitude * 10 + (*p - '0');
+        if (magnitude > 2147483648LL)
+        {
+            return NULL;
+        }
+    }
+    if (p == digits || (!negative && magnitude > 2147483647LL))
+    {
+        return NULL;
+    }
+    value = (S32)(negative ? -magnitude : magnitude);
+    return p;
+}
+
+// Decimal length for raw strings and binary: digits only, no octal or
+// hex forms strtol() would also take.
+const char* scan_length(const char* p, const char* end, S32& value)
+{
+    const char* digits = p;
+    S64 len = 0;
+    for (; p < end && is_digit(*p) && (p - digits) < 10; ++p)
+    {
+        len = len * 10 + (*p - '0');
+    }
+    if (p == digits || (*digits == '0' && p - digits > 1) || len > S32_MAX)
+    {
+        return NULL;
+    }
+    value = (S32)len;
+    return p;
+}
+
+/**
+ * XML
+ */
+class FastXMLParser
+{
+public:
+    FastXMLParser(const char* buf, size_t len)
+        : mPos(buf), mEnd(buf + len), mParseCount(0)
+    {}
+
+    S32 parse(LLSD& data);
+
+private:
+    enum Element {
+        ELEMENT_LLSD,
+        ELEMENT_UNDEF,
+        ELEMENT_BOOL,
+        ELEMENT_INTEGER,
+        ELEMENT_REAL,
+        ELEMENT_STRING,
+        ELEMENT_UUID,
+        ELEMENT_DATE,
+        ELEMENT_URI,
+        ELEMENT_BINARY,
+        ELEMENT_MAP,
+        ELEMENT_ARRAY,
+        ELEMENT_KEY,
+        ELEMENT_UNKNOWN
+    };
+
+    struct Tag
+    {
+        const char* mName;
+        size_t mNameLen;
+        bool mClosing;      // </name>
+        bool mEmpty;        // <name/>
+        bool mBase64;       // no encoding attribute or encoding="base64"
+
+        bool is(const char* name, size_t len) const
+        {
+            return mNameLen == len && !memcmp(mName, name, len);
+        }
+        bool closes(const Tag& open) const
+        {
+            return mClosing && is(open.mName, open.mNameLen);
+        }
+    };
+
+    static Element readElement(const Tag& tag);
+
+    bool skipDeclaration();
+    bool skipMisc();
+    bool skipComment();
+    bool readCData(std::string* content);
+    bool readTag(Tag& tag);
+    bool readContent(std::string* content, Tag& tag);
+
+    bool parseValue(Element element, const Tag& tag, LLSD& value, S32 depth);
+    bool parseMap(const Tag& tag, LLSD& map, S32 depth);
+    bool parseArray(const Tag& tag, LLSD& array, S32 depth);
+    bool assignContent(Element element, LLSD& value);
+
+    const char* mPos;
+    const char* const mEnd;
+    S32 mParseCount;
+    std::string mContent;
+    std::string mScratch;
+};
+
+// Same dispatch as LLSDXMLParser::Impl::readElement().
+FastXMLParser::Element FastXMLParser::readElement(const Tag& tag)
+{
+    switch (tag.mName[0])
+    {
+        case 'k':
+            if (tag.is("key", 3)) { return ELEMENT_KEY; }
+            break;
+        case 'r':
+            if (tag.is("real", 4)) { return ELEMENT_REAL; }
+            break;
+        case 'i':
+            if (tag.is("integer", 7)) { return ELEMENT_INTEGER; }
+            break;
+        case 'a':
+            if (tag.is("array", 5)) { return ELEMENT_ARRAY; }
+            break;
+        case 'm':
+            if (tag.is("map", 3)) { return ELEMENT_MAP; }
+            break;
+        case 'u':
+            if (tag.is("uuid", 4)) { return ELEMENT_UUID; }
+            if (tag.is("undef", 5)) { return ELEMENT_UNDEF; }
+            if (tag.is("uri", 3)) { return ELEMENT_URI; }
+            break;
+        case 'b':
+            if (tag.is("binary", 6)) { return ELEMENT_BINARY; }
+            if (tag.is("boolean", 7)) { return ELEMENT_BOOL; }
+            break;
+        case 's':
+            if (tag.is("string", 6)) { return ELEMENT_STRING; }
+            break;
+        case 'l':
+            if (tag.is("llsd", 4)) { return ELEMENT_LLSD; }
+            break;
+        case 'd':
+            if (tag.is("date", 4)) { return ELEMENT_DATE; }
+            break;
+    }
+    return ELEMENT_UNKNOWN;
+}
+
+// Accepts an optional byte order mark and a plain
+// <?xml version="1.0" [encoding="..."] [standalone="yes|no"]?>
+// declaration at the very start. Anything more unusual is left to expat.
+bool FastXMLParser::skipDeclaration()
+{
+    if (mEnd - mPos >= 3 && !memcmp(mPos, "\xEF\xBB\xBF", 3))
+    {
+        mPos += 3;
+    }
+    if (mEnd - mPos < 6 || memcmp(mPos, "<?xml", 5) || !is_xml_space(mPos[5]))
+    {
+        return true;
+    }
+
+    static const char* const NAMES[] = { "version", "encoding", "standalone" };
+    const char* p = mPos + 5;
+    S32 next = 0;
+    while (true)
+    {
+        const char* start = p;
+        while (p < mEnd && is_xml_space(*p))
+        {
+            ++p;
+        }
+        if (mEnd - p >= 2 && p[0] == '?' && p[1] == '>')
+        {
+            if (!next)
+            {
+                return false;
+            }
+            mPos = p + 2;
+            return true;
+        }
+        if (p == start)
+        {
+            return false;
+        }
+
+        const char* name = p;
+        while (p < mEnd && is_alpha(*p))
+        {
+            ++p;
+        }
+        size_t len = p - name;
+        // version is required and the three must come in order
+        while (next < 3 && (strlen(NAMES[next]) != len || memcmp(NAMES[next], name, len)))
+        {
+            if (!next)
+            {
+                return false;
+            }
+            ++next;
+        }
+        if (next == 3)
+        {
+            return false;
+        }
+
+        while (p < mEnd && is_xml_space(*p)) ++p;
+        if (p == mEnd || *p != '=')
+        {
+            return false;
+        }
+        ++p;
+        while (p < mEnd && is_xml_space(*p)) ++p;
+        if (p == mEnd || (*p != '"' && *p != '\''))
+        {
+            return false;
+        }
+        const char quote = *p++;
+        const char* value = p;
+        while (p < mEnd && *p != quote && is_name_char(*p))
+        {
+            ++p;
+        }
+        if (p == mEnd || *p != quote)
+        {
+            return false;
+        }
+        std::string_view text(value, p - value);
+        if ((next == 0 && text != "1.0")
+            || (next == 1 && (text.empty() || !is_alpha(text[0])))
+            || (next == 2 && text != "yes" && text != "no"))
+        {
+            return false;
+        }
+        ++next;
+        ++p;
+    }
+}
+
+bool FastXMLParser::skipComment()
+{
+    // mPos is at "<!--"
+    const char* p = mPos + 4;
+    while (true)
+    {
+        const char* dash = (const char*)memchr(p, '-', mEnd - p);
+        if (!dash || mEnd - dash < 3)
+        {
+            return false;
+        }
+        if (dash[1] == '-')
+        {
+            // "--" may only end the comment
+            if (dash[2] != '>' || !decode_xml_text(mPos + 4, dash, NULL, false))
+            {
+                return false;
+            }
+            mPos = dash + 3;
+            return true;
+        }
+        p = dash + 1;
+    }
+}
+
+bool FastXMLParser::readCData(std::string* content)
+{
+    // mPos is at "<![CDATA["
+    const char* p = mPos + 9;
+    while (true)
+    {
+        const char* bracket = (const char*)memchr(p, ']', mEnd - p);
+        if (!bracket || mEnd - bracket < 3)
+        {
+            return false;
+        }
+        if (bracket[1] == ']' && bracket[2] == '>')
+        {
+            if (!decode_xml_text(mPos + 9, bracket, content, false))
+            {
+                return false;
+            }
+            mPos = bracket + 3;
+            return true;
+        }
+        p = bracket + 1;
+    }
+}
+
+bool FastXMLParser::skipMisc()
+{
+    while (true)
+    {
+        while (mPos < mEnd && is_xml_space(*mPos))
+        {
+            ++mPos;
+        }
+        if (mEnd - mPos >= 4 && !memcmp(mPos, "<!--", 4))
+        {
+            if (!skipComment())
+            {
+                return false;
+            }
+            continue;
+        }
+        return mPos < mEnd && *mPos == '<';
+    }
+}
+
+bool FastXMLParser::readTag(Tag& tag)
+{
+    // mPos is at '<'
+    const char* p = mPos + 1;
+    tag.mClosing = false;
+    tag.mEmpty = false;
+    tag.mBase64 = true;
+    if (p < mEnd && *p == '/')
+    {
+        tag.mClosing = true;
+        ++p;
+    }
+    if (p == mEnd || !is_name_start(*p))
+    {
+        // '?', '!' and non-ASCII names are left to expat
+        return false;
+    }
+    tag.mName = p;
+    while (p < mEnd && is_name_char(*p))
+    {
+        ++p;
+    }
+    tag.mNameLen = p - tag.mName;
+
+    const char* attr_names[8];
+    size_t attr_lens[8];
+    S32 attr_count = 0;
+    while (true)
+    {
+        bool space = false;
+        while (p < mEnd && is_xml_space(*p))
+        {
+            ++p;
+            space = true;
+        }
+        if (p == mEnd)
+        {
+            return false;
+        }
+        if (*p == '>')
+        {
+            mPos = p + 1;
+            return true;
+        }
+        if (tag.mClosing)
+        {
+            return false;
+        }
+        if (*p == '/')
+        {
+            if (p + 1 == mEnd || p[1] != '>')
+            {
+                return false;
+            }
+            tag.mEmpty = true;
+            mPos = p + 2;
+            return true;
+        }
+        if (!space || !is_name_start(*p) || attr_count == 8)
+        {
+            return false;
+        }
+
+        const char* name = p;
+        while (p < mEnd && is_name_char(*p))
+        {
+            ++p;
+        }
+        size_t name_len = p - name;
+        for (S32 i = 0; i < attr_count; ++i)
+        {
+            if (attr_lens[i] == name_len && !memcmp(attr_names[i], name, name_len))
+            {
+                return false;
+            }
+        }
+        attr_names[attr_count] = name;
+        attr_lens[attr_count] = name_len;
+        ++attr_count;
+
+        while (p < mEnd && is_xml_space(*p)) ++p;
+        if (p == mEnd || *p != '=')
+        {
+            return false;
+        }
+        ++p;
+        while (p < mEnd && is_xml_space(*p)) ++p;
+        if (p == mEnd || (*p != '"' && *p != '\''))
+        {
+            return false;
+        }
+        const char quote = *p++;
+        const char* value = p;
+        for (; p < mEnd && *p != quote; ++p)
+        {
+            // references, normalized whitespace and non-ASCII values
+            // are rare enough to leave to expat
+            U8 c = (U8)*p;
+            if (c == '<' || c == '&' || c < 0x20 || c >= 0x80)
+            {
+                return false;
+            }
+        }
+        if (p == mEnd)
+        {
+            return false;
+        }
+        if (name_len == 8 && !memcmp(name, "encoding", 8))
+        {
+            tag.mBase64 = (p - value == 6) && !memcmp(value, "base64", 6);
+        }
+        ++p;
+    }
+}
+
+// Reads character data up to the next start or end tag, appending it
+// to 'content' when that is not NULL. Comments are dropped and CDATA
+// sections count as text, as they do for expat.
+bool FastXMLParser::readContent(std::string* content, Tag& tag)
+{
+    while (true)
+    {
+        bool special = false;
+        const char* start = mPos;
+        const char* lt = scan_xml_text(mPos, mEnd, special);
+        if (lt == mEnd)
+        {
+            return false;
+        }
+        if (special)
+        {
+            if (!decode_xml_text(start, lt, content, true))
+            {
+                return false;
+            }
+        }
+        else if (content)
+        {
+            content->append(start, lt);
+        }
+        mPos = lt;
+
+        if (mEnd - mPos >= 4 && !memcmp(mPos, "<!--", 4))
+        {
+            if (!skipComment())
+            {
+                return false;
+            }
+            continue;
+        }
+        if (mEnd - mPos >= 9 && !memcmp(mPos, "<![CDATA[", 9))
+        {
+            if (!readCData(content))
+            {
+                return false;
+            }
+            continue;
+        }
+        return readTag(tag);
+    }
+}
+
+S32 FastXMLParser::parse(LLSD& data)
+{
+    Tag tag;
+    if (!skipDeclaration() || !skipMisc() || !readTag(tag)
+        || tag.mClosing || readElement(tag) != ELEMENT_LLSD)
+    {
+        return FAIL;
+    }
+
+    // The stream parser stops at </llsd>, so whatever follows is never
+    // looked at.
+    LLSD result;
+    if (!tag.mEmpty)
+    {
+        bool have_value = false;
+        while (true)
+        {
+            Tag child;
+            if (!readContent(NULL, child))
+            {
+                return FAIL;
+            }
+            if (child.closes(tag))
+            {
+                break;
+            }
+            if (child.mClosing || have_value
+                || !parseValue(readElement(child), child, result, 1))
+            {
+                return FAIL;
+            }
+            have_value = true;
+        }
+    }
+    data = result;
+    return mParseCount;
+}
+
+bool FastXMLParser::parseValue(Element element, const Tag& tag, LLSD& value, S32 depth)
+{
+    switch (element)
+    {
+        case ELEMENT_LLSD:
+        case ELEMENT_KEY:
+        case ELEMENT_UNKNOWN:
+            // the stream parser skips these with rules of its own
+            return false;
+
+        case ELEMENT_BINARY:
+            if (!tag.mBase64)
+            {
+                return false;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    ++mParseCount;
+    if (element == ELEMENT_MAP)
+    {
+        value = LLSD::emptyMap();
+        return tag.mEmpty || parseMap(tag, value, depth + 1);
+    }
+    if (element == ELEMENT_ARRAY)
+    {
+        value = LLSD::emptyArray();
+        return tag.mEmpty || parseArray(tag, value, depth + 1);
+    }
+
+    mContent.clear();
+    if (!tag.mEmpty)
+    {
+        Tag close;
+        if (!readContent(&mContent, close) || !close.closes(tag))
+        {
+            // includes elements nested inside a scalar
+            return false;
+        }
+    }
+    return assignContent(element, value);
+}
+
+bool FastXMLParser::parseMap(const Tag& tag, LLSD& map, S32 depth)
+{
+    if (depth > MAX_FAST_DEPTH)
+    {
+        return false;
+    }
+    std::string key;
+    bool have_key = false;
+    while (true)
+    {
+        Tag child;
+        if (!readContent(NULL, child))
+        {
+            return false;
+        }
+        if (child.mClosing)
+        {
+            // a dangling key would carry over into the parent for the
+            // stream parser
+            return child.closes(tag) && !have_key;
+        }
+        Element element = readElement(child);
+        if (element == ELEMENT_KEY)
+        {
+            key.clear();
+            if (!child.mEmpty)
+            {
+                Tag close;
+                if (!readContent(&key, close) || !close.closes(child))
+                {
+                    return false;
+                }
+            }
+            have_key = true;
+            continue;
+        }
+        // values without a key are skipped by the stream parser
+        if (!have_key || key.empty())
+        {
+            return false;
+        }
+        if (!parseValue(element, child, map[key], depth))
+        {
+            return false;
+        }
+        have_key = false;
+    }
+}
+
+bool FastXMLParser::parseArray(const Tag& tag, LLSD& array, S32 depth)
+{
+    if (depth > MAX_FAST_DEPTH)
+    {
+        return false;
+    }
+    while (true)
+    {
+        Tag child;
+        if (!readContent(NULL, child))
+        {
+            return false;
+        }
+        if (child.mClosing)
+        {
+            return child.closes(tag);
+        }
+        array.append(LLSD());
+        if (!parseValue(readElement(child), child, array[array.size() - 1], depth))
+        {
+            return false;
+        }
+    }
+}
+
+// Same conversions as LLSDXMLParser::Impl::assignContent(), with fast
+// paths for plain numbers.
+bool FastXMLParser::assignContent(Element element, LLSD& value)
+{
+    switch (element)
+    {
+        case ELEMENT_UNDEF:
+            value.clear();
+            break;
+
+        case ELEMENT_BOOL:
+            value = (mContent == "true" || mContent == "1");
+            break;
+
+        case ELEMENT_INTEGER:
+        {
+            const char* end = mContent.data() + mContent.size();
+            S32 i;
+            if (scan_integer(mContent.data(), end, i) == end)
+            {
+                value = i;
+            }
+            else if (sscanf(mContent.c_str(), "%d", &i) == 1)
+            {
+                value = i;
+            }
+            else
+            {
+                value = LLSD(mContent).asInteger();
+            }
+            break;
+        }
+
+        case ELEMENT_REAL:
+        {
+            const char* end = mContent.data() + mContent.size();
+            F64 r = 0.0;
+            bool exact = false;
+            if (scan_real(mContent.data(), end, r, exact) == end && exact)
+            {
+                value = r;
+            }
+            else
+            {
+                value = LLSD(mContent).asReal();
+            }
+            break;
+        }
+
+        case ELEMENT_STRING:
+            value = mContent;
+            break;
+
+        case ELEMENT_UUID:
+            value = LLUUID(mContent);
+            break;
+
+        case ELEMENT_DATE:
+            value = LLDate(mContent);
+            break;
+
+        case ELEMENT_URI:
+            value = LLURI(mContent);
+            break;
+
+        case ELEMENT_BINARY:
+        {
+            if (!strip_base64_space(mContent.data(), mContent.data() + mContent.size(), mScratch))
+            {
+                return false;
+            }
+            S32 len = apr_base64_decode_len(mScratch.c_str());
+            std::vector<U8> data;
+            data.resize(len);
+            len = apr_base64_decode_binary(&data[0], mScratch.c_str());
+            data.resize(len);
+            value = data;
+            break;
+        }
+
+        default:
+            break;
+    }
+    return true;
+}
+
+/**
+ * Notation
+ */
+class FastNotationParser
+{
+public:
+    FastNotationParser(const char* buf, size_t len)
+        : mPos(buf), mEnd(buf + len)
+    {}
+
+    S32 parse(LLSD& data, S32 max_depth);
+
+private:
+    S32 parseValue(LLSD& data, S32 max_depth, S32 depth);
+    S32 parseMap(LLSD& map, S32 max_depth, S32 depth);
+    S32 parseArray(LLSD& array, S32 max_depth, S32 depth);
+    bool parseDelimited(char delim, std::string& value);
+    bool parseRaw(std::string& value);
+    bool parseBinary(LLSD& data);
+    bool parseBoolean(const char* rest);
+
+    const char* mPos;
+    const char* const mEnd;
+};
+
+S32 FastNotationParser::parse(LLSD& data, S32 max_depth)
+{
+    LLSD result;
+    S32 parse_count = parseValue(result, max_depth, 0);
+    if (parse_count > 0)
+    {
+        data = result;
+    }
+    return parse_count;
+}
+
+// Mirrors LLSDNotationParser::doParse().
+S32 FastNotationParser::parseValue(LLSD& data, S32 max_depth, S32 depth)
+{
+    if (max_depth == 0 || depth > MAX_FAST_DEPTH)
+    {
+        return FAIL;
+    }
+    while (mPos < mEnd && is_c_space(*mPos))
+    {
+        ++mPos;
+    }
+    if (mPos == mEnd)
+    {
+        return FAIL;
+    }
+
+    switch (*mPos++)
+    {
+        case '{':
+        {
+            data = LLSD::emptyMap();
+            S32 child_count = parseMap(data, max_depth - 1, depth + 1);
+            return (child_count == FAIL) ? FAIL : child_count + 1;
+        }
+
+        case '[':
+        {
+            data = LLSD::emptyArray();
+            S32 child_count = parseArray(data, max_depth - 1, depth + 1);
+            return (child_count == FAIL) ? FAIL : child_count + 1;
+        }
+
+        case '!':
+            data.clear();
+            return 1;
+
+        case '0':
+            data = false;
+            return 1;
+
+        case '1':
+            data = true;
+            return 1;
+
+        case 'F':
+        case 'f':
+            if (!parseBoolean("alse"))
+            {
+                return FAIL;
+            }
+            data = false;
+            return 1;
+
+        case 'T':
+        case 't':
+            if (!parseBoolean("rue"))
+            {
+                return FAIL;
+            }
+            data = true;
+            return 1;
+
+        case 'i':
+        {
+            // operator>>() would also skip whitespace first
+            S32 integer = 0;
+            const char* end = scan_integer(mPos, mEnd, integer);
+            if (!end)
+            {
+                return FAIL;
+            }
+            mPos = end;
+            data = integer;
+            return 1;
+        }
+
+        case 'r':
+        {
+            F64 real = 0.0;
+            bool exact = false;
+            const char* end = scan_real(mPos, mEnd, real, exact);
+            if (!end || (!exact && !stream_real(mPos, end, real)))
+            {
+                return FAIL;
+            }
+            mPos = end;
+            data = real;
+            return 1;
+        }
+
+        case 'u':
+        {
+            // operator>>() reads 36 characters, skipping whitespace
+            if (mEnd - mPos < UUID_STR_LENGTH - 1)
+            {
+                return FAIL;
+            }
+            for (S32 i = 0; i < UUID_STR_LENGTH - 1; ++i)
+            {
+                if (!mPos[i] || is_c_space(mPos[i]))
+                {
+                    return FAIL;
+                }
+            }
+            LLUUID id;
+            id.set(std::string(mPos, UUID_STR_LENGTH - 1));
+            mPos += UUID_STR_LENGTH - 1;
+            data = id;
+            return 1;
+        }
+
+        case '\"':
+        case '\'':
+        {
+            std::string value;
+            if (!parseDelimited(mPos[-1], value))
+            {
+                return FAIL;
+            }
+            data = value;
+            return 1;
+        }
+
+        case 's':
+        {
+            std::string value;
+            if (!parseRaw(value))
+            {
+                return FAIL;
+            }
+            data = value;
+            return 1;
+        }
+
+        case 'l':
+        case 'd':
+        {
+            const char type = mPos[-1];
+            if (mPos == mEnd)
+            {
+                return FAIL;
+            }
+            const char delim = *mPos++;
+            if (delim == '\\')
+            {
+                // the stream parser would take it as an escape
+                return FAIL;
+            }
+            std::string value;
+            if (!parseDelimited(delim, value))
+            {
+                return FAIL;
+            }
+            if (type == 'l')
+            {
+                data = LLURI(value);
+            }
+            else
+            {
+                data = LLDate(value);
+            }
+            return 1;
+        }
+
+        case 'b':
+            --mPos;
+            return parseBinary(data) ? 1 : FAIL;
+
+        default:
+            return FAIL;
+    }
+}
+
+// Mirrors LLSDNotationParser::parseMap(), including its habit of
+// keeping the first value for a repeated key.
+S32 FastNotationParser::parseMap(LLSD& map, S32 max_depth, S32 depth)
+{
+    S32 parse_count = 0;
+    bool found_name = false;
+    // reused across keys: a zero length s(0)"" key leaves it unchanged
+    std::string name;
+    while (mPos < mEnd)
+    {
+        char c = *mPos++;
+        if (c == '}')
+        {
+            return parse_count;
+        }
+        if (!found_name)
+        {
+            if (c == '\"' || c == '\'')
+            {
+                if (!parseDelimited(c, name))
+                {
+                    return FAIL;
+                }
+                found_name = true;
+            }
+            else if (c == 's')
+            {
+                if (!parseRaw(name))
+                {
+                    return FAIL;
+                }
+                found_name = true;
+            }
+            else if (!is_c_space(c) && c != ',')
+            {
+                // the stream parser quietly drops other characters here
+                return FAIL;
+            }
+        }
+        else if (!is_c_space(c) && c != ':')
+        {
+            --mPos;
+            LLSD child;
+            S32 count = parseValue(child, max_depth, depth);
+            if (count <= 0)
+            {
+                return FAIL;
+            }
+            parse_count += count;
+            map.insert(name, child);
+            found_name = false;
+        }
+    }
+    return FAIL;
+}
+
+S32 FastNotationParser::parseArray(LLSD& array, S32 max_depth, S32 depth)
+{
+    S32 parse_count = 0;
+    while (mPos < mEnd)
+    {
+        char c = *mPos;
+        if (c == ']')
+        {
+            ++mPos;
+            return parse_count;
+        }
+        if (is_c_space(c) || c == ',')
+        {
+            ++mPos;
+            continue;
+        }
+        LLSD child;
+        S32 count = parseValue(child, max_depth, depth);
+        if (count == FAIL)
+        {
+            return FAIL;
+        }
+        parse_count += count;
+        array.append(child);
+    }
+    return FAIL;
+}
+
+// Matches the rest of "true" or "false" after the first letter the way
+// deserialize_boolean() does: any following letter commits to the
+// long form.
+bool FastNotationParser::parseBoolean(const char* rest)
+{
+    if (mPos == mEnd || (U8)*mPos >= 0x80)
+    {
+        return mPos == mEnd;
+    }
+    if (!is_alpha(*mPos))
+    {
+        return true;
+    }
+    for (; *rest; ++rest, ++mPos)
+    {
+        if (mPos == mEnd || (*mPos | 0x20) != *rest || !is_alpha(*mPos))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Mirrors deserialize_string_delim(); mPos is just past the opening
+// delimiter.
+bool FastNotationParser::parseDelimited(char delim, std::string& value)
+{
+    value.clear();
+    while (true)
+    {
+        const char* stop = find_either(mPos, mEnd, delim, '\\');
+        if (stop == mEnd)
+        {
+            return false;
+        }
+        value.append(mPos, stop);
+        mPos = stop + 1;
+        if (*stop == delim)
+        {
+            return true;
+        }
+
+        if (mPos == mEnd)
+        {
+            return false;
+        }
+        char c = *mPos++;
+        switch (c)
+        {
+            case 'x':
+                if (mEnd - mPos < 2)
+                {
+                    return false;
+                }
+                value += (char)((hex_as_nybble(mPos[0]) << 4) | hex_as_nybble(mPos[1]));
+                mPos += 2;
+                break;
+            case 'a': value += '\a'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'v': value += '\v'; break;
+            default:  value += c;    break;
+        }
+    }
+}
+
+// Mirrors deserialize_string_raw(); mPos is just past the 's'.
+bool FastNotationParser::parseRaw(std::string& value)
+{
+    if (mPos == mEnd || *mPos != '(')
+    {
+        return false;
+    }
+    S32 len = 0;
+    const char* p = scan_length(mPos + 1, mEnd, len);
+    // the stream parser reads the length through a 19 byte buffer
+    if (!p || p - mPos > 18 || mEnd - p < 2 || p[0] != ')' || (p[1] != '"' && p[1] != '\''))
+    {
+        return false;
+    }
+    p += 2;
+    if (mEnd - p < (S64)len + 1 || (p[len] != '"' && p[len] != '\''))
+    {
+        return false;
+    }
+    if (len)
+    {
+        value.assign(p, len);
+    }
+    mPos = p + len + 1;
+    return true;
+}
+
+// Mirrors LLSDNotationParser::parseBinary(); mPos is at the 'b'.
+bool FastNotationParser::parseBinary(LLSD& data)
+{
+    const char* limit = (mEnd - mPos > 255) ? mPos + 255 : mEnd;
+    const char* quote = (const char*)memchr(mPos, '"', limit - mPos);
+    if (!quote)
+    {
+        return false;
+    }
+    size_t header = quote - mPos;
+    const char* p = quote + 1;
+
+    if (header >= 2 && mPos[1] == '(')
+    {
+        S32 len = 0;
+        const char* end = scan_length(mPos + 2, quote, len);
+        if (!end || end + 1 != quote || *end != ')' || mEnd - p < (S64)len + 1)
+        {
+            return false;
+        }
+        std::vector<U8> value(p, p + len);
+        // the stream parser drops the next byte without checking it
+        mPos = p + len + 1;
+        data = value;
+        return true;
+    }
+
+    if (header == 3 && mPos[1] == '6' && mPos[2] == '4')
+    {
+        const char* end = (const char*)memchr(p, '"', mEnd - p);
+        if (!end || end == p)
+        {
+            return false;
+        }
+        std::string encoded(p, end);
+        S32 len = apr_base64_decode_len(encoded.c_str());
+        std::vector<U8> value;
+        if (len)
+        {
+            value.resize(len);
+            len = apr_base64_decode_binary(&value[0], encoded.c_str());
+            value.resize(len);
+        }
+        mPos = end + 1;
+        data = value;
+        return true;
+    }
+
+    if (header == 3 && mPos[1] == '1' && mPos[2] == '6')
+    {
+        const char* end = (const char*)memchr(p, '"', mEnd - p);
+        if (!end || ((end - p) & 1) || memchr(p, '\0', end - p))
+        {
+            return false;
+        }
+        std::vector<U8> value((end - p) / 2);
+        for (size_t i = 0; i < value.size(); ++i, p += 2)
+        {
+            value[i] = (hex_as_nybble(p[0]) << 4) | hex_as_nybble(p[1]);
+        }
+        mPos = end + 1;
+        data = value;
+        return true;
+    }
+
+    return false;
+}
+
+} // anonymous namespace
+
+/**
+ * LLSDFastParse
+ */
+// static
+S32 LLSDFastParse::parseXML(LLSD& data, const char* buf, size_t len)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    FastXMLParser parser(buf, len);
+    return parser.parse(data);
+}
+
+// static
+S32 LLSDFastParse::parseNotation(LLSD& data, const char* buf, size_t len, S32 max_depth)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    FastNotationParser parser(buf, len);
+    S32 parse_count = parser.parse(data, max_depth);
+    return (parse_count > 0) ? parse_count : FALLBACK;
+}
+
+/**
+ * LLSDSerialize buffer entry points
+ */
+// static
+S32 LLSDSerialize::fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors)
+{
+    S32 parse_count = LLSDFastParse::parseXML(sd, buf, len);
+    if (LLSDFastParse::FALLBACK != parse_count)
+    {
+        return parse_count;
+    }
+    LLMemoryStream str((const U8*)buf, (S32)len);
+    return fromXMLEmbedded(sd, str, emit_errors);
+}
+
+// static
+S32 LLSDSerialize::fromNotationBuffer(LLSD& sd, const char* buf, size_t len, llssize max_bytes)
+{
+    // Within these bounds none of the stream parser's size checks can
+    // trip, so both parsers agree.
+    if (SIZE_UNLIMITED == max_bytes || (llssize)len <= max_bytes)
+    {
+        S32 parse_count = LLSDFastParse::parseNotation(sd, buf, len);
+        if (LLSDFastParse::FALLBACK != parse_count)
+        {
+            return parse_count;
+        }
+    }
+    LLMemoryStream str((const U8*)buf, (S32)len);
+    return fromNotation(sd, str, max_bytes);
+}
@@ -274,6 +274,10 @@ public:
 
     void reset();
 
+    // Route parse events to visitor instead of building mResult, or
+    // back to tree building when NULL.
+    void setVisitor(LLSDParseVisitor* visitor) { mVisitor = visitor; }
+
 private:
     void startElementHandler(const XML_Char* name, const XML_Char** attributes);
     void endElementHandler(const XML_Char* name);
@@ -287,6 +291,8 @@ private:
         void* userData, const XML_Char* data, int length);
 
     void startSkipping();
+    void stopVisiting();
+    bool inMap() const;
 
     enum Element {
         ELEMENT_LLSD,
@@ -306,6 +312,8 @@ private:
     };
     static Element readElement(const XML_Char* name);
 
+    void assignContent(Element element, LLSD& value) const;
+
     static const XML_Char* findAttribute(const XML_Char* name, const XML_Char** pairs);
 
     bool mEmitErrors;
@@ -328,11 +336,16 @@ private:
 
     std::string mCurrentKey;        // Current XML <tag>
     std::string mCurrentContent;    // String data between <tag> and </tag>
+
+    LLSDParseVisitor* mVisitor;     // if set, receives events instead of mStack
+    std::vector<Element> mVisitStack; // open value elements in visitor mode
+    bool mVisitorStopped;           // a visitor callback returned false
 };
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
-    : mEmitErrors(emit_errors)
+    : mEmitErrors(emit_errors),
+      mVisitor(NULL)
 {
     mParser = XML_ParserCreate(NULL);
     reset();
@@ -410,6 +423,11 @@ S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
     // preserved
 
     status = XML_ParseBuffer(mParser, 0, true);
+    if (mVisitorStopped)
+    {
+        data = LLSD();
+        return LLSDParser::PARSE_FAILURE;
+    }
     if (status == XML_STATUS_ERROR && !mGracefullStop)
     {
         if (buffer)
@@ -501,6 +519,11 @@ S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
         status = XML_ParseBuffer(mParser, 0, true);
     }
 
+    if (mVisitorStopped)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+
     if (status == XML_STATUS_ERROR
         && !mGracefullStop)
     {
@@ -535,6 +558,9 @@ void LLSDXMLParser::Impl::reset()
 
     mCurrentKey.clear();
 
+    mVisitStack.clear();
+    mVisitorStopped = false;
+
     XML_ParserReset(mParser, "utf-8");
     XML_SetUserData(mParser, this);
     XML_SetElementHandler(mParser, sStartElementHandler, sEndElementHandler);
@@ -548,6 +574,21 @@ void LLSDXMLParser::Impl::startSkipping()
     mSkipThrough = mDepth;
 }
 
+void LLSDXMLParser::Impl::stopVisiting()
+{
+    mVisitorStopped = true;
+    XML_StopParser(mParser, false);
+}
+
+bool LLSDXMLParser::Impl::inMap() const
+{
+    if (mVisitor)
+    {
+        return !mVisitStack.empty() && (mVisitStack.back() == ELEMENT_MAP);
+    }
+    return !mStack.empty() && mStack.back()->isMap();
+}
+
 const XML_Char*
 LLSDXMLParser::Impl::findAttribute(const XML_Char* name, const XML_Char** pairs)
 {
@@ -611,7 +652,7 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
     #endif // XML_PARSER_PERFORMANCE_TESTS
 
     ++mDepth;
-    if (mSkipping)
+    if (mSkipping || mVisitorStopped)
     {
         return;
     }
@@ -632,7 +673,7 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
             return;
 
         case ELEMENT_KEY:
-            if (mStack.empty()  ||  !(mStack.back()->isMap()))
+            if (!inMap())
             {
                 mStackElements.pop();
                 return startSkipping();
@@ -662,6 +703,38 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
         return startSkipping();
     }
 
+    if (mVisitor)
+    {
+        if (inMap())
+        {
+            if (mCurrentKey.empty())
+            {
+                mStackElements.pop();
+                return startSkipping();
+            }
+            if (!mVisitor->mapKey(mCurrentKey))
+            {
+                return stopVisiting();
+            }
+            mCurrentKey.clear();
+        }
+        else if (!mVisitStack.empty() && (mVisitStack.back() != ELEMENT_ARRAY))
+        {
+            // improperly nested value in a non-structure
+            mStackElements.pop();
+            return startSkipping();
+        }
+
+        mVisitStack.push_back(element);
+        ++mParseCount;
+        if ((element == ELEMENT_MAP && !mVisitor->beginMap(-1))
+            || (element == ELEMENT_ARRAY && !mVisitor->beginArray(-1)))
+        {
+            stopVisiting();
+        }
+        return;
+    }
+
     if (mStack.empty())
     {
         mStack.push_back(&mResult);
@@ -725,6 +798,10 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
         }
         return;
     }
+    if (mVisitorStopped)
+    {
+        return;
+    }
 
     // <FS:ND>: we've saved the element we need in a stack, so we can avoid readElement()
     // Element element = readElement(name);
@@ -754,9 +831,44 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 
     if (!mInLLSDElement) { return; }
 
+    if (mVisitor)
+    {
+        if (mVisitStack.empty()) { return; }
+        mVisitStack.pop_back();
+
+        bool keep_going = true;
+        if (element == ELEMENT_MAP)
+        {
+            keep_going = mVisitor->endMap();
+        }
+        else if (element == ELEMENT_ARRAY)
+        {
+            keep_going = mVisitor->endArray();
+        }
+        else
+        {
+            LLSD value;
+            assignContent(element, value);
+            keep_going = mVisitor->value(value);
+        }
+        mCurrentContent.clear();
+        if (!keep_going)
+        {
+            stopVisiting();
+        }
+        return;
+    }
+
     LLSD& value = *mStack.back();
     mStack.pop_back();
 
+    assignContent(element, value);
+
+    mCurrentContent.clear();
+}
+
+void LLSDXMLParser::Impl::assignContent(Element element, LLSD& value) const
+{
     switch (element)
     {
         case ELEMENT_UNDEF:
@@ -842,8 +954,6 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
             // other values, map and array, have already been set
             break;
     }
-
-    mCurrentContent.clear();
 }
 
 void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
@@ -852,6 +962,10 @@ void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
     XML_Timer timer( &charDataTime );
     #endif  // XML_PARSER_PERFORMANCE_TESTS
 
+    if (mVisitorStopped)
+    {
+        return;
+    }
     mCurrentContent.append(data, length);
 }
 
@@ -980,6 +1094,18 @@ S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data, S32 max_depth) const
     return impl.parse(input, data);
 }
 
+// virtual
+S32 LLSDXMLParser::doVisit(std::istream& input, LLSDParseVisitor& visitor, S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+
+    LLSD ignored;
+    impl.setVisitor(&visitor);
+    S32 parse_count = mParseLines ? impl.parseLines(input, ignored) : impl.parse(input, ignored);
+    impl.setVisitor(NULL);
+    return parse_count;
+}
+
 //  virtual
 void LLSDXMLParser::doReset()
 {
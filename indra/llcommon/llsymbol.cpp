@@ -0,0 +1,152 @@
+/**
+ * @file   llsymbol.cpp
+ * @date   2026-10-19
+ * @brief  Implementation for LLSymbol.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llsymbol.h"
+// STL headers
+#include <deque>
+#include <unordered_map>
+// std headers
+#include <atomic>
+#include <mutex>
+#include <ostream>
+// external library headers
+// other Linden headers
+
+namespace
+{
+    // a string to look up, with its hash computed once for both the shard
+    // and the shard's map
+    struct Key
+    {
+        std::string_view mString;
+        size_t mHash;
+
+        bool operator==(const Key& other) const { return mString == other.mString; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return key.mHash; }
+    };
+} // anonymous namespace
+
+class LLSymbolTable
+{
+public:
+    typedef LLSymbol::Entry Entry;
+
+    const Entry* find(const Key& key)
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        auto found = shard.mIndex.find(key);
+        return found == shard.mIndex.end() ? nullptr : found->second;
+    }
+
+    const Entry* intern(const Key& key)
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        auto found = shard.mIndex.find(key);
+        if (found != shard.mIndex.end())
+        {
+            return found->second;
+        }
+        // std::deque never moves its elements, so the map's key can view
+        // the entry's own string
+        shard.mEntries.push_back(Entry{ std::string(key.mString), key.mHash });
+        const Entry* entry = &shard.mEntries.back();
+        shard.mIndex.emplace(Key{ entry->mString, entry->mHash }, entry);
+        ++mSize;
+        return entry;
+    }
+
+    size_t size() const { return mSize.load(); }
+
+private:
+    // Threads interning different names rarely contend for the same lock
+    static constexpr size_t SHARDS = 16;
+
+    struct Shard
+    {
+        std::mutex mMutex;
+        std::deque<Entry> mEntries;
+        std::unordered_map<Key, const Entry*, KeyHash> mIndex;
+    };
+
+    Shard& shardFor(const Key& key)
+    {
+        // the map buckets by the low bits: pick the shard from the high ones
+        return mShards[(key.mHash >> 32) % SHARDS];
+    }
+
+    Shard mShards[SHARDS];
+    std::atomic<size_t> mSize{ 0 };
+};
+
+namespace
+{
+    LLSymbolTable& getTable()
+    {
+        // Deliberately never destroyed: static LLSymbols elsewhere may
+        // outlive any static table.
+        static LLSymbolTable* sTable = new LLSymbolTable;
+        return *sTable;
+    }
+
+    Key makeKey(std::string_view str)
+    {
+        return { str, std::hash<std::string_view>()(str) };
+    }
+} // anonymous namespace
+
+LLSymbol::LLSymbol(std::string_view str)
+{
+    if (! str.empty())
+    {
+        mEntry = getTable().intern(makeKey(str));
+    }
+}
+
+// static
+std::optional<LLSymbol> LLSymbol::find(std::string_view str)
+{
+    if (str.empty())
+    {
+        return LLSymbol();
+    }
+    const Entry* entry = getTable().find(makeKey(str));
+    if (! entry)
+    {
+        return {};
+    }
+    return LLSymbol(entry);
+}
+
+// static
+size_t LLSymbol::tableSize()
+{
+    return getTable().size();
+}
+
+// static
+const std::string& LLSymbol::emptyString()
+{
+    static const std::string sEmpty;
+    return sEmpty;
+}
+
+std::ostream& operator<<(std::ostream& out, const LLSymbol& symbol)
+{
+    return out << symbol.str();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file   llsymbol.h
+ * @date   2026-10-19
+ * @brief  LLSymbol is an interned string: one shared copy of each distinct
+ *         string, compared by address.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_LLSYMBOL_H)
+#define LL_LLSYMBOL_H
+
+#include <functional>               // std::hash
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * LLSymbol stands for a string held once in a process-wide table, for
+ * names that are looked up far more often than they are created: view
+ * names, settings names and the like. Constructing an LLSymbol from a
+ * string hashes it and finds (or adds) its table entry; after that,
+ * comparing two LLSymbols compares two pointers and hashing one returns
+ * the hash computed when the string was first interned.
+ *
+ * The table is thread-safe and never shrinks: interning is meant for a
+ * bounded vocabulary of names, not for arbitrary user text. To test
+ * whether some string is a known name without adding it, use find(): a
+ * string nobody has interned cannot equal any existing LLSymbol.
+ *
+ * LLStringTable and the message system's gMessageStringTable remain as
+ * they are; their callers depend on their char* identity.
+ */
+class LL_COMMON_API LLSymbol
+{
+public:
+    /// the empty string
+    LLSymbol() {}
+    /// intern str
+    explicit LLSymbol(std::string_view str);
+
+    /// the LLSymbol for str, if str has ever been interned
+    static std::optional<LLSymbol> find(std::string_view str);
+
+    const std::string& str() const { return mEntry ? mEntry->mString : emptyString(); }
+    const char* c_str() const { return str().c_str(); }
+    operator std::string_view() const { return str(); }
+    bool empty() const { return ! mEntry; }
+
+    /// hash of the string, computed once when it was interned
+    size_t hash() const { return mEntry ? mEntry->mHash : 0; }
+
+    bool operator==(const LLSymbol& other) const { return mEntry == other.mEntry; }
+    bool operator!=(const LLSymbol& other) const { return mEntry != other.mEntry; }
+
+    /// number of distinct strings interned so far
+    static size_t tableSize();
+
+private:
+    friend class LLSymbolTable;
+    struct Entry
+    {
+        std::string mString;
+        size_t mHash;
+    };
+    explicit LLSymbol(const Entry* entry): mEntry(entry) {}
+    static const std::string& emptyString();
+
+    // nullptr for the empty string, so a default LLSymbol needs no table
+    const Entry* mEntry{ nullptr };
+};
+
+LL_COMMON_API std::ostream& operator<<(std::ostream& out, const LLSymbol& symbol);
+
+namespace std
+{
+    template <>
+    struct hash<LLSymbol>
+    {
+        size_t operator()(const LLSymbol& symbol) const noexcept { return symbol.hash(); }
+    };
+}
+
+#endif /* ! defined(LL_LLSYMBOL_H) */
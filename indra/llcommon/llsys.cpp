@@ -41,13 +41,13 @@
 
 #include "llprocessor.h"
 #include "llerrorcontrol.h"
+#include "lleventchannel.h"
 #include "llevents.h"
 #include "llformat.h"
 #include "llregex.h"
 #include "lltimer.h"
 #include "llsdserialize.h"
 #include "llsdutil.h"
-#include <boost/bind.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/range.hpp>
@@ -1206,10 +1206,10 @@ class FrameWatcher
 {
 public:
     FrameWatcher():
-        // Hooking onto the "mainloop" event pump gets us one call per frame.
-        mConnection(LLEventPumps::instance()
-                    .obtain("mainloop")
-                    .listen("FrameWatcher", boost::bind(&FrameWatcher::tick, this, _1))),
+        // Hooking onto the "mainloop" channel gets us one call per frame,
+        // without the cost of an LLSD event.
+        mConnection(LLEventChannels::mainloop()
+                    .listen("FrameWatcher", [this](const U32&){ return tick(); })),
         // Initializing mSampleStart to an invalid timestamp alerts us to skip
         // trying to compute framerate on the first call.
         mSampleStart(-1),
@@ -1226,7 +1226,7 @@ public:
         mSlowest(F32_MAX)
     {}
 
-    bool tick(const LLSD&)
+    bool tick()
     {
         F32 timestamp(mTimer.getElapsedTimeF32());
 
@@ -1322,9 +1322,9 @@ public:
     }
 
 private:
-    // Storing the connection in an LLTempBoundListener ensures it will be
+    // Storing the connection in a TempConnection ensures it will be
     // disconnected when we're destroyed.
-    LLTempBoundListener mConnection;
+    LLEventChannel<U32>::TempConnection mConnection;
     // Track elapsed time
     LLTimer mTimer;
     // Some of what you see here is in fact redundant with functionality you
@@ -33,8 +33,10 @@
 #include LLCOROS_CONDVAR_HEADER
 #include "llexception.h"
 #include "mutex.h"
+#include <algorithm>
 #include <chrono>
 #include <queue>
+#include <vector>
 #include <string>
 
 /*****************************************************************************
@@ -220,7 +222,9 @@ namespace LL
     /**
      * std::priority_queue's API is almost like std::queue, intentionally of
      * course, but you must access the element about to pop() as top() rather
-     * than as front(). Make an adapter for use with LLThreadSafeQueue.
+     * than as front(), and there is no way to move it out. Instead this
+     * adapter keeps its own heap in a Container, ordered by Compare the way
+     * std::priority_queue orders its own: front() is the highest element.
      */
     template <typename T, typename Container=std::vector<T>,
               typename Compare=std::less<typename Container::value_type>>
@@ -228,32 +232,155 @@ namespace LL
     {
     public:
         // publish all the same types
-        typedef std::priority_queue<T, Container, Compare> queue_type;
-        typedef typename queue_type::container_type  container_type;
-        typedef typename queue_type::value_compare   value_compare;
-        typedef typename queue_type::value_type      value_type;
-        typedef typename queue_type::size_type       size_type;
-        typedef typename queue_type::reference       reference;
-        typedef typename queue_type::const_reference const_reference;
-
-        // Although std::queue defines both const and non-const front()
-        // methods, std::priority_queue defines only const top().
-        const_reference front() const { return mQ.top(); }
-        // std::priority_queue has no equivalent to back(), so it's good that
+        typedef Container                             container_type;
+        typedef Compare                               value_compare;
+        typedef typename Container::value_type        value_type;
+        typedef typename Container::size_type         size_type;
+        typedef typename Container::reference         reference;
+        typedef typename Container::const_reference   const_reference;
+
+        const_reference front() const { return mItems.front(); }
+        // There is no equivalent to back(), so it's good that
         // LLThreadSafeQueue doesn't use it.
 
-        // All the rest of these merely forward to the corresponding
-        // queue_type methods.
-        bool empty() const                 { return mQ.empty(); }
-        size_type size() const             { return mQ.size(); }
-        void push(const value_type& value) { mQ.push(value); }
-        void push(value_type&& value)      { mQ.push(std::move(value)); }
+        bool empty() const                 { return mItems.empty(); }
+        size_type size() const             { return mItems.size(); }
+        void push(const value_type& value)
+        {
+            mItems.push_back(value);
+            std::push_heap(mItems.begin(), mItems.end(), mCompare);
+        }
+        void push(value_type&& value)
+        {
+            mItems.push_back(std::move(value));
+            std::push_heap(mItems.begin(), mItems.end(), mCompare);
+        }
+        template <typename... Args>
+        void emplace(Args&&... args)
+        {
+            mItems.emplace_back(std::forward<Args>(args)...);
+            std::push_heap(mItems.begin(), mItems.end(), mCompare);
+        }
+        void pop()
+        {
+            std::pop_heap(mItems.begin(), mItems.end(), mCompare);
+            mItems.pop_back();
+        }
+        // pop() into element: pop_heap() swaps the head to the back and
+        // re-sorts the rest, so the element is moved out only once nothing
+        // compares it any more
+        void pop(value_type& element)
+        {
+            std::pop_heap(mItems.begin(), mItems.end(), mCompare);
+            element = std::move(mItems.back());
+            mItems.pop_back();
+        }
+
+    private:
+        Container mItems;
+        Compare mCompare;
+    };
+
+    /**
+     * pop_front() moves a queue's head element into element and removes it,
+     * which is how LLThreadSafeQueue takes it. A std::queue-like container
+     * pops the moved-from front(); PriorityQueueAdapter has its own.
+     */
+    template <typename QueueT, typename ElementT>
+    void pop_front(QueueT& queue, ElementT& element)
+    {
+        element = std::move(queue.front());
+        queue.pop();
+    }
+
+    template <typename T, typename Container, typename Compare, typename ElementT>
+    void pop_front(PriorityQueueAdapter<T, Container, Compare>& queue, ElementT& element)
+    {
+        queue.pop(element);
+    }
+
+    /**
+     * RingQueue is a std::queue replacement for LLThreadSafeQueue whose
+     * storage is a circular buffer that doubles as needed and never shrinks.
+     * std::deque allocates and frees a block every few elements as a queue
+     * churns; once a RingQueue has grown to its busiest depth, pushing and
+     * popping never touch the heap. A popped slot is reset to T() at once,
+     * so it holds on to nothing. T must be default-constructible and
+     * movable.
+     *
+     * Besides the std::queue API, RingQueue supports back() and pop_back(),
+     * making it a double-ended queue.
+     */
+    template <typename T>
+    class RingQueue
+    {
+    public:
+        typedef T           value_type;
+        typedef size_t      size_type;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+
+        RingQueue(size_type initial=16)
+        {
+            // power of 2, so wrapping is a mask
+            size_type capacity = 1;
+            while (capacity < initial)
+                capacity *= 2;
+            mItems.resize(capacity);
+        }
+
+        bool empty() const                 { return ! mSize; }
+        size_type size() const             { return mSize; }
+        size_type capacity() const         { return mItems.size(); }
+
+        reference front()                  { return mItems[mHead]; }
+        const_reference front() const      { return mItems[mHead]; }
+        reference back()                   { return mItems[index(mSize - 1)]; }
+        const_reference back() const       { return mItems[index(mSize - 1)]; }
+
+        void push(const value_type& value) { emplace(value); }
+        void push(value_type&& value)      { emplace(std::move(value)); }
         template <typename... Args>
-        void emplace(Args&&... args)       { mQ.emplace(std::forward<Args>(args)...); }
-        void pop()                         { mQ.pop(); }
+        void emplace(Args&&... args)
+        {
+            if (mSize == mItems.size())
+            {
+                grow();
+            }
+            mItems[index(mSize)] = T(std::forward<Args>(args)...);
+            ++mSize;
+        }
+
+        void pop()
+        {
+            mItems[mHead] = T();
+            mHead = index(1);
+            --mSize;
+        }
+
+        void pop_back()
+        {
+            mItems[index(mSize - 1)] = T();
+            --mSize;
+        }
 
     private:
-        queue_type mQ;
+        size_type index(size_type offset) const { return (mHead + offset) & (mItems.size() - 1); }
+
+        void grow()
+        {
+            std::vector<T> items(mItems.size() * 2);
+            for (size_type i = 0; i < mSize; ++i)
+            {
+                items[i] = std::move(mItems[index(i)]);
+            }
+            mItems.swap(items);
+            mHead = 0;
+        }
+
+        std::vector<T> mItems;
+        size_type mHead{ 0 };
+        size_type mSize{ 0 };
     };
 } // namespace LL
 
@@ -365,7 +492,7 @@ bool LLThreadSafeQueue<ElementT, QueueT>::tryPush(T&& element)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
     return tryLock(
-        [this, element=std::move(element)](lock_t& lock)
+        [this, element=std::move(element)](lock_t& lock) mutable
         {
             if (mClosed)
                 return false;
@@ -397,7 +524,7 @@ bool LLThreadSafeQueue<ElementT, QueueT>::tryPushUntil(
     LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
     return tryLockUntil(
         until,
-        [this, until, element=std::move(element)](lock_t& lock)
+        [this, until, element=std::move(element)](lock_t& lock) mutable
         {
             while (true)
             {
@@ -436,9 +563,9 @@ LLThreadSafeQueue<ElementT, QueueT>::pop_(lock_t& lock, ElementT& element)
     if (! canPop(mStorage.front()))
         return WAITING;
 
-    // std::queue::front() is the element about to pop()
-    element = mStorage.front();
-    mStorage.pop();
+    // std::queue::front() is the element about to pop(): move, rather than
+    // copy, since it's going away
+    LL::pop_front(mStorage, element);
     lock.unlock();
     // now that we've popped, if somebody's been waiting to push, signal them
     mCapacityCond.notify_one();
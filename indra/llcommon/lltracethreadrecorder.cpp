@@ -29,6 +29,9 @@
 #include "llfasttimer.h"
 #include "lltrace.h"
 #include "llstl.h"
+#include "lltimer.h"
+
+#include <mutex>
 
 namespace LLTrace
 {
@@ -36,12 +39,24 @@ namespace LLTrace
 
 static ThreadRecorder* sMasterThreadRecorder = NULL;
 
+// Guards every child's link to its parent, so a parent cannot be destroyed
+// between a child reading mParentRecorder and unregistering from it. Never
+// destroyed: threads may still be exiting during static destruction.
+static std::mutex& parent_link_mutex()
+{
+    static std::mutex* sMutex = new std::mutex;
+    return *sMutex;
+}
+
 ///////////////////////////////////////////////////////////////////////
 // ThreadRecorder
 ///////////////////////////////////////////////////////////////////////
 
 ThreadRecorder::ThreadRecorder()
-:   mParentRecorder(NULL)
+:   mParentRecorder(NULL),
+    mDeltaHead(0),
+    mDeltaTail(0),
+    mNextPushTime(0)
 {
     init();
 }
@@ -89,16 +104,22 @@ void ThreadRecorder::init()
 
 
 ThreadRecorder::ThreadRecorder( ThreadRecorder& parent )
-:   mParentRecorder(&parent)
+:   mParentRecorder(&parent),
+    mDeltaHead(0),
+    mDeltaTail(0),
+    mNextPushTime(0)
 {
     init();
-    mParentRecorder->addChildRecorder(this);
+    std::lock_guard<std::mutex> lock(parent_link_mutex());
+    parent.addChildRecorder(this);
 }
 
 
 ThreadRecorder::~ThreadRecorder()
 {
 #if LL_TRACE_ENABLED
+    detachChildRecorders();
+
     LLThreadLocalSingletonPointer<BlockTimerStackRecord>::setInstance(NULL);
 
     //disclaim_alloc(gTraceMemStat, this);
@@ -118,9 +139,10 @@ ThreadRecorder::~ThreadRecorder()
     set_thread_recorder(NULL);
     delete[] mTimeBlockTreeNodes;
 
-    if (mParentRecorder)
+    std::lock_guard<std::mutex> lock(parent_link_mutex());
+    if (ThreadRecorder* parent = mParentRecorder.load())
     {
-        mParentRecorder->removeChildRecorder(this);
+        parent->removeChildRecorder(this);
     }
 #endif
 }
@@ -262,15 +284,53 @@ void ThreadRecorder::removeChildRecorder(ThreadRecorder* child)
 #endif
 }
 
-void ThreadRecorder::pushToParent()
+// called by the parent's thread
+void ThreadRecorder::detachChildRecorders()
+{
+#if LL_TRACE_ENABLED
+    std::lock_guard<std::mutex> link_lock(parent_link_mutex());
+    LLMutexLock lock(&mChildListMutex);
+    for (ThreadRecorder* child : mChildThreadRecorders)
+    {
+        child->mParentRecorder = NULL;
+    }
+    mChildThreadRecorders.clear();
+#endif
+}
+
+// called by child thread
+bool ThreadRecorder::pushToParent()
 {
 #if LL_TRACE_ENABLED
+    const U32 head = mDeltaHead.load(std::memory_order_relaxed);
+    if (head - mDeltaTail.load(std::memory_order_acquire) >= DELTA_SLOTS)
+    {
+        return false;
+    }
     if (ThreadRecorder* recorder = LLTrace::get_thread_recorder())
     {
-        LLMutexLock lock(&mSharedRecordingMutex);
         recorder->bringUpToDate(&mThreadRecordingBuffers);
-        mSharedRecordingBuffers.append(mThreadRecordingBuffers);
+        mDeltaSlots[head % DELTA_SLOTS].append(mThreadRecordingBuffers);
         mThreadRecordingBuffers.reset();
+        mDeltaHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+#endif
+    return false;
+}
+
+// called by child thread
+void ThreadRecorder::pushToParentIfDue()
+{
+#if LL_TRACE_ENABLED
+    if (!mParentRecorder)
+    {
+        return;
+    }
+    const U64 now = LLTimer::getTotalTime();
+    if (now >= mNextPushTime && pushToParent())
+    {
+        mNextPushTime = now + PUSH_INTERVAL_USEC;
     }
 #endif
 }
@@ -282,14 +342,21 @@ void ThreadRecorder::pullFromChildren()
     LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
     if (!mActiveRecordings.empty())
     {
+        // only contends with threads starting and stopping
         LLMutexLock lock(&mChildListMutex);
         AccumulatorBufferGroup& target_recording_buffers = mActiveRecordings.back()->mPartialRecording;
         target_recording_buffers.sync();
         for (LLTrace::ThreadRecorder* rec : mChildThreadRecorders)
         {
-            LLMutexLock lock(&(rec->mSharedRecordingMutex));
-            target_recording_buffers.merge(rec->mSharedRecordingBuffers);
-            rec->mSharedRecordingBuffers.reset();
+            U32 tail = rec->mDeltaTail.load(std::memory_order_relaxed);
+            const U32 head = rec->mDeltaHead.load(std::memory_order_acquire);
+            for (; tail != head; ++tail)
+            {
+                AccumulatorBufferGroup& delta = rec->mDeltaSlots[tail % DELTA_SLOTS];
+                target_recording_buffers.merge(delta);
+                delta.reset();
+            }
+            rec->mDeltaTail.store(tail, std::memory_order_release);
         }
     }
 #endif
@@ -33,6 +33,8 @@
 #include "llmutex.h"
 #include "lltraceaccumulators.h"
 
+#include <atomic>
+
 namespace LLTrace
 {
     class LL_COMMON_API ThreadRecorder
@@ -52,13 +54,23 @@ namespace LLTrace
 
         void addChildRecorder(class ThreadRecorder* child);
         void removeChildRecorder(class ThreadRecorder* child);
+        // stops the children still registered from reporting to this recorder;
+        // the destructor calls it, so children never reach a deleted parent
+        void detachChildRecorders();
 
         // call this periodically to gather stats data from child threads
         void pullFromChildren();
-        void pushToParent();
+        // hands this thread's measurements to the parent; false if the parent
+        // has yet to drain earlier ones, in which case they keep accumulating here
+        bool pushToParent();
+        // cheap enough to call after every work item: pushes at most every
+        // PUSH_INTERVAL_USEC
+        void pushToParentIfDue();
 
         TimeBlockTreeNode* getTimeBlockTreeNode(size_t index);
 
+        static const U64 PUSH_INTERVAL_USEC = 10000;
+
     protected:
         void init();
 
@@ -85,9 +97,16 @@ namespace LLTrace
 
         child_thread_recorder_list_t    mChildThreadRecorders;  // list of child thread recorders associated with this master
         LLMutex                         mChildListMutex;        // protects access to child list
-        LLMutex                         mSharedRecordingMutex;
-        AccumulatorBufferGroup          mSharedRecordingBuffers;
-        ThreadRecorder*                 mParentRecorder;
+        std::atomic<ThreadRecorder*>    mParentRecorder;        // cleared by the parent's detachChildRecorders()
+
+        // Single producer, single consumer ring of measurements pushed by this
+        // thread and not yet pulled by the parent.  The child fills the slot at
+        // mDeltaHead and the parent drains from mDeltaTail; neither locks.
+        static const U32                DELTA_SLOTS = 4;
+        AccumulatorBufferGroup          mDeltaSlots[DELTA_SLOTS];
+        std::atomic<U32>                mDeltaHead;
+        std::atomic<U32>                mDeltaTail;
+        U64                             mNextPushTime;
 
     };
 
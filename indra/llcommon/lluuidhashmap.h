@@ -0,0 +1,547 @@
+/**
+ * @file   lluuidhashmap.h
+ * @date   2026-10-19
+ * @brief  LLUUIDHashMap is an open-addressing hash map for LLUUID keys.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_LLUUIDHASHMAP_H)
+#define LL_LLUUIDHASHMAP_H
+
+#include "lluuid.h"
+#include <algorithm>
+#include <cstring>                  // memset
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LL_UUIDHASHMAP_SSE2 1
+#else
+#define LL_UUIDHASHMAP_SSE2 0
+#endif
+
+#if LL_WINDOWS
+#include <intrin.h>                 // _BitScanForward
+#endif
+
+/**
+ * LLUUIDHashMap<T> is a drop-in for std::unordered_map<LLUUID, T> (and
+ * std::map<LLUUID, T> where nobody depends on the order) for the viewer's
+ * big UUID-keyed tables. Entries live in one flat array rather than in a
+ * node per entry, so a lookup touches one 16-byte group of control bytes
+ * and then, almost always, just the entry it wants.
+ *
+ * Each slot has a control byte: empty, deleted, or 7 bits of the key's
+ * hash. A lookup compares a whole group of 16 control bytes at once with
+ * SSE2, and only compares keys whose 7 hash bits match. UUIDs are random
+ * already, so the hash is just the UUID's two 64-bit halves folded and
+ * multiplied: enough to spread sequential test or local IDs too.
+ *
+ * Differences from std::unordered_map:
+ * * Inserting may move every entry: it invalidates all iterators,
+ *   pointers and references into the map, not just iterators. Erasing
+ *   invalidates only the erased entry.
+ * * Iteration order is unspecified and changes when the table grows.
+ * * There is no bucket interface, custom hash or allocator.
+ */
+template <typename T>
+class LLUUIDHashMap
+{
+public:
+    typedef LLUUID key_type;
+    typedef T mapped_type;
+    typedef std::pair<const LLUUID, T> value_type;
+    typedef size_t size_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+
+private:
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr S8 EMPTY = -128;
+    static constexpr S8 DELETED = -2;
+
+    struct alignas(GROUP_SIZE) Group
+    {
+        S8 mCtrl[GROUP_SIZE];
+
+        // bit i set if mCtrl[i] == h2
+        U32 match(S8 h2) const
+        {
+#if LL_UUIDHASHMAP_SSE2
+            const __m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(mCtrl));
+            return U32(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+#else
+            U32 mask = 0;
+            for (size_t i = 0; i < GROUP_SIZE; ++i)
+            {
+                mask |= U32(mCtrl[i] == h2) << i;
+            }
+            return mask;
+#endif
+        }
+
+        U32 matchEmpty() const { return match(EMPTY); }
+
+        // empty and deleted are the only negative control bytes
+        U32 matchFree() const
+        {
+#if LL_UUIDHASHMAP_SSE2
+            const __m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(mCtrl));
+            return U32(_mm_movemask_epi8(ctrl));
+#else
+            U32 mask = 0;
+            for (size_t i = 0; i < GROUP_SIZE; ++i)
+            {
+                mask |= U32(mCtrl[i] < 0) << i;
+            }
+            return mask;
+#endif
+        }
+    };
+
+    static U32 lowestBit(U32 mask)
+    {
+#if LL_WINDOWS
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return U32(index);
+#else
+        return U32(__builtin_ctz(mask));
+#endif
+    }
+
+    static U64 hash(const LLUUID& id)
+    {
+        U64 h = id.getDigest64();
+        h ^= h >> 32;
+        h *= 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 32);
+    }
+
+    // top 7 bits: never negative, so never mistaken for EMPTY or DELETED
+    static S8 h2(U64 h) { return S8(h >> 57); }
+
+    // a slot is raw storage, constructed only while its control byte is full
+    union Slot
+    {
+        Slot() {}
+        ~Slot() {}
+        value_type mValue;
+    };
+
+    template <bool CONST>
+    class Iter
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename LLUUIDHashMap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::conditional_t<CONST, const value_type*, value_type*> pointer;
+        typedef std::conditional_t<CONST, const value_type&, value_type&> reference;
+
+        Iter() {}
+        // iterator converts to const_iterator
+        template <bool OTHER, typename = std::enable_if_t<CONST && ! OTHER>>
+        Iter(const Iter<OTHER>& other):
+            mCtrl(other.mCtrl),
+            mEnd(other.mEnd),
+            mSlot(other.mSlot)
+        {}
+
+        reference operator*() const { return mSlot->mValue; }
+        pointer operator->() const { return &mSlot->mValue; }
+
+        Iter& operator++()
+        {
+            ++mCtrl;
+            ++mSlot;
+            skipFree();
+            return *this;
+        }
+        Iter operator++(int)
+        {
+            Iter previous(*this);
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iter& other) const { return mCtrl == other.mCtrl; }
+        bool operator!=(const Iter& other) const { return mCtrl != other.mCtrl; }
+
+    private:
+        friend class LLUUIDHashMap;
+        template <bool> friend class Iter;
+
+        Iter(const S8* ctrl, const S8* end, Slot* slot):
+            mCtrl(ctrl),
+            mEnd(end),
+            mSlot(slot)
+        {}
+
+        void skipFree()
+        {
+            while (mCtrl != mEnd && *mCtrl < 0)
+            {
+                ++mCtrl;
+                ++mSlot;
+            }
+        }
+
+        const S8* mCtrl{ nullptr };
+        const S8* mEnd{ nullptr };
+        Slot* mSlot{ nullptr };
+    };
+
+public:
+    typedef Iter<false> iterator;
+    typedef Iter<true> const_iterator;
+
+    LLUUIDHashMap() {}
+
+    LLUUIDHashMap(const LLUUIDHashMap& other)
+    {
+        reserve(other.size());
+        for (const auto& entry : other)
+        {
+            insertNew(entry.first, entry.second);
+        }
+    }
+
+    LLUUIDHashMap(LLUUIDHashMap&& other) noexcept
+    {
+        swap(other);
+    }
+
+    LLUUIDHashMap& operator=(const LLUUIDHashMap& other)
+    {
+        if (this != &other)
+        {
+            LLUUIDHashMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    LLUUIDHashMap& operator=(LLUUIDHashMap&& other) noexcept
+    {
+        if (this != &other)
+        {
+            LLUUIDHashMap gone(std::move(other));
+            swap(gone);
+        }
+        return *this;
+    }
+
+    ~LLUUIDHashMap()
+    {
+        destroyAll();
+    }
+
+    void swap(LLUUIDHashMap& other) noexcept
+    {
+        std::swap(mGroups, other.mGroups);
+        std::swap(mSlots, other.mSlots);
+        std::swap(mCapacity, other.mCapacity);
+        std::swap(mSize, other.mSize);
+        std::swap(mGrowthLeft, other.mGrowthLeft);
+    }
+
+    iterator begin()
+    {
+        iterator it(ctrl(), ctrlEnd(), mSlots.get());
+        it.skipFree();
+        return it;
+    }
+    iterator end() { return iterator(ctrlEnd(), ctrlEnd(), mSlots.get() + mCapacity); }
+    const_iterator begin() const { return const_cast<LLUUIDHashMap*>(this)->begin(); }
+    const_iterator end() const { return const_cast<LLUUIDHashMap*>(this)->end(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return ! mSize; }
+    /// number of slots: the map grows when 7/8 of them have been used
+    size_t capacity() const { return mCapacity; }
+
+    iterator find(const LLUUID& key)
+    {
+        const size_t index = findIndex(key);
+        return index == NPOS ? end() : iteratorAt(index);
+    }
+    const_iterator find(const LLUUID& key) const
+    {
+        return const_cast<LLUUIDHashMap*>(this)->find(key);
+    }
+
+    size_t count(const LLUUID& key) const { return findIndex(key) == NPOS ? 0 : 1; }
+    bool contains(const LLUUID& key) const { return findIndex(key) != NPOS; }
+
+    T& at(const LLUUID& key)
+    {
+        const size_t index = findIndex(key);
+        if (index == NPOS)
+        {
+            throw std::out_of_range("LLUUIDHashMap::at(" + key.asString() + ")");
+        }
+        return mSlots[index].mValue.second;
+    }
+    const T& at(const LLUUID& key) const
+    {
+        return const_cast<LLUUIDHashMap*>(this)->at(key);
+    }
+
+    T& operator[](const LLUUID& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    template <typename... ARGS>
+    std::pair<iterator, bool> try_emplace(const LLUUID& key, ARGS&&... args)
+    {
+        const U64 h = hash(key);
+        size_t index = findIndex(key, h);
+        if (index != NPOS)
+        {
+            return { iteratorAt(index), false };
+        }
+        index = prepareInsert(h);
+        new (&mSlots[index].mValue) value_type(std::piecewise_construct,
+                                               std::forward_as_tuple(key),
+                                               std::forward_as_tuple(std::forward<ARGS>(args)...));
+        ++mSize;
+        return { iteratorAt(index), true };
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> emplace(const LLUUID& key, V&& value)
+    {
+        return try_emplace(key, std::forward<V>(value));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return try_emplace(value.first, value.second);
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> insert_or_assign(const LLUUID& key, V&& value)
+    {
+        auto result = try_emplace(key, std::forward<V>(value));
+        if (! result.second)
+        {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    size_t erase(const LLUUID& key)
+    {
+        const size_t index = findIndex(key);
+        if (index == NPOS)
+        {
+            return 0;
+        }
+        eraseAt(index);
+        return 1;
+    }
+
+    /// returns the iterator following pos, as for std::unordered_map
+    iterator erase(const_iterator pos)
+    {
+        const size_t index = size_t(pos.mCtrl - ctrl());
+        eraseAt(index);
+        iterator next(iteratorAt(index));
+        ++next;
+        return next;
+    }
+
+    void clear()
+    {
+        destroyAll();
+        if (mCapacity)
+        {
+            std::memset(ctrl(), EMPTY, mCapacity);
+            mGrowthLeft = maxLoad(mCapacity);
+        }
+    }
+
+    /// make room for count entries without growing again
+    void reserve(size_t count)
+    {
+        size_t capacity = GROUP_SIZE;
+        while (maxLoad(capacity) < count)
+        {
+            capacity *= 2;
+        }
+        if (capacity > mCapacity)
+        {
+            rehash(capacity);
+        }
+    }
+
+private:
+    static constexpr size_t NPOS = size_t(-1);
+
+    static size_t maxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+    S8* ctrl() { return mGroups ? mGroups[0].mCtrl : nullptr; }
+    S8* ctrlEnd() { return ctrl() + mCapacity; }
+    const S8* ctrl() const { return mGroups ? mGroups[0].mCtrl : nullptr; }
+
+    iterator iteratorAt(size_t index)
+    {
+        return iterator(ctrl() + index, ctrlEnd(), mSlots.get() + index);
+    }
+
+    size_t findIndex(const LLUUID& key) const { return findIndex(key, hash(key)); }
+
+    // Groups are probed in triangular steps from the one picked by the low
+    // hash bits: with a power-of-2 group count that visits every group.
+    size_t findIndex(const LLUUID& key, U64 h) const
+    {
+        if (! mCapacity)
+        {
+            return NPOS;
+        }
+        const size_t groupMask = mCapacity / GROUP_SIZE - 1;
+        const S8 tag = h2(h);
+        size_t group = size_t(h) & groupMask;
+        for (size_t step = 1; ; ++step)
+        {
+            const Group& g = mGroups[group];
+            for (U32 mask = g.match(tag); mask; mask &= mask - 1)
+            {
+                const size_t index = group * GROUP_SIZE + lowestBit(mask);
+                if (mSlots[index].mValue.first == key)
+                {
+                    return index;
+                }
+            }
+            // the key would have gone in a free slot here
+            if (g.matchEmpty() || step > groupMask)
+            {
+                return NPOS;
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // First free slot on h's probe sequence: with at most 7/8 of the slots
+    // in use there always is one
+    size_t findFree(U64 h) const
+    {
+        const size_t groupMask = mCapacity / GROUP_SIZE - 1;
+        size_t group = size_t(h) & groupMask;
+        for (size_t step = 1; ; ++step)
+        {
+            const U32 mask = mGroups[group].matchFree();
+            if (mask)
+            {
+                return group * GROUP_SIZE + lowestBit(mask);
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // Claim a free slot for a new key with hash h, and return its index
+    size_t prepareInsert(U64 h)
+    {
+        size_t index = mCapacity ? findFree(h) : NPOS;
+        if (index == NPOS || (! mGrowthLeft && ctrl()[index] == EMPTY))
+        {
+            // mostly deleted slots: reclaim them without growing
+            rehash(mCapacity && mSize < maxLoad(mCapacity) / 2 ? mCapacity : std::max(mCapacity * 2, GROUP_SIZE));
+            index = findFree(h);
+        }
+        if (ctrl()[index] == EMPTY)
+        {
+            --mGrowthLeft;
+        }
+        ctrl()[index] = h2(h);
+        return index;
+    }
+
+    void eraseAt(size_t index)
+    {
+        mSlots[index].mValue.~value_type();
+        --mSize;
+        // If this slot's group still has an empty slot, no probe has ever
+        // passed through it, so the slot can become empty again.
+        // Otherwise it must stay a tombstone for probes that did.
+        if (mGroups[index / GROUP_SIZE].matchEmpty())
+        {
+            ctrl()[index] = EMPTY;
+            ++mGrowthLeft;
+        }
+        else
+        {
+            ctrl()[index] = DELETED;
+        }
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::unique_ptr<Group[]> groups(new Group[capacity / GROUP_SIZE]);
+        std::memset(groups[0].mCtrl, EMPTY, capacity);
+        std::unique_ptr<Slot[]> slots(new Slot[capacity]);
+
+        std::swap(mGroups, groups);
+        std::swap(mSlots, slots);
+        const size_t oldCapacity = mCapacity;
+        mCapacity = capacity;
+        mGrowthLeft = maxLoad(capacity) - mSize;
+
+        // groups and slots are now the old table
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+            if (groups[i / GROUP_SIZE].mCtrl[i % GROUP_SIZE] >= 0)
+            {
+                value_type& value = slots[i].mValue;
+                const U64 h = hash(value.first);
+                const size_t index = findFree(h);
+                ctrl()[index] = h2(h);
+                new (&mSlots[index].mValue) value_type(std::move(value));
+                value.~value_type();
+            }
+        }
+    }
+
+    void destroyAll()
+    {
+        if constexpr (! std::is_trivially_destructible_v<value_type>)
+        {
+            for (size_t i = 0; i < mCapacity; ++i)
+            {
+                if (ctrl()[i] >= 0)
+                {
+                    mSlots[i].mValue.~value_type();
+                }
+            }
+        }
+        mSize = 0;
+    }
+
+    void insertNew(const LLUUID& key, const T& value)
+    {
+        const size_t index = prepareInsert(hash(key));
+        new (&mSlots[index].mValue) value_type(key, value);
+        ++mSize;
+    }
+
+    std::unique_ptr<Group[]> mGroups;
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mCapacity{ 0 };
+    size_t mSize{ 0 };
+    // how many more empty slots may be filled before growing
+    size_t mGrowthLeft{ 0 };
+};
+
+#endif /* ! defined(LL_LLUUIDHASHMAP_H) */
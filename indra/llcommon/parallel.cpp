@@ -0,0 +1,391 @@
+/**
+ * @file   parallel.cpp
+ * @date   2026-10-19
+ * @brief  Implementation for parallelFor() and TaskGraph.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "parallel.h"
+// STL headers
+// std headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+// external library headers
+// other Linden headers
+#include "llerror.h"
+#include "llfasttimer.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+namespace
+{
+    // How many helper work items to post to options.mQueue, or 0 to run on
+    // the calling thread alone
+    size_t helperLimit(const LL::ParallelOptions& options, LL::WorkQueueBase::ptr_t& queue)
+    {
+        queue = LL::WorkQueueBase::getInstance(options.mQueue);
+        if (! queue || queue->isClosed())
+        {
+            return 0;
+        }
+        // a queue with no ThreadPool behind it has nobody to help
+        return llmin(LL::ThreadPoolBase::getWidth(options.mQueue, 0), options.mMaxHelpers);
+    }
+
+    // Run 'work' under the options' fast timer, if any
+    template <typename CALLABLE>
+    void timed(LLTrace::BlockTimerStatHandle* timer, CALLABLE&& work)
+    {
+        if (timer)
+        {
+            LL_RECORD_BLOCK_TIME(*timer);
+            work();
+        }
+        else
+        {
+            work();
+        }
+    }
+
+    // Shared by the calling thread and its helpers. Helpers hold it by
+    // shared_ptr: one that only starts after parallelFor() has returned
+    // finds no chunk left to claim, and touches nothing else.
+    struct ForState
+    {
+        const std::function<void(size_t, size_t)>* mBody;
+        LLTrace::BlockTimerStatHandle* mTimer;
+        size_t mBegin;
+        size_t mEnd;
+        size_t mGrain;
+        size_t mChunks;
+
+        std::atomic<size_t> mNext{ 0 };
+        std::atomic<size_t> mDone{ 0 };
+        std::atomic<bool> mFailed{ false };
+
+        std::mutex mMutex;
+        std::condition_variable mCond;
+        std::exception_ptr mException;
+
+        void runChunks()
+        {
+            LL_PROFILE_ZONE_SCOPED;
+            for (size_t chunk; (chunk = mNext++) < mChunks; )
+            {
+                // after a failure, claimed chunks still count as done so
+                // the caller stops waiting
+                if (! mFailed.load())
+                {
+                    const size_t begin = mBegin + chunk * mGrain;
+                    const size_t end = llmin(begin + mGrain, mEnd);
+                    try
+                    {
+                        timed(mTimer, [this, begin, end](){ (*mBody)(begin, end); });
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        if (! mException)
+                        {
+                            mException = std::current_exception();
+                        }
+                        mFailed = true;
+                    }
+                }
+                if (++mDone == mChunks)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mCond.notify_all();
+                }
+            }
+        }
+    };
+} // anonymous namespace
+
+/*****************************************************************************
+*   parallelFor()
+*****************************************************************************/
+void LL::parallelFor(size_t begin, size_t end,
+                     const std::function<void(size_t, size_t)>& body,
+                     const ParallelOptions& options)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+    const size_t count = end - begin;
+
+    WorkQueueBase::ptr_t queue;
+    size_t helpers = helperLimit(options, queue);
+    size_t grain = options.mGrain;
+    if (! grain)
+    {
+        // a few chunks per thread, so a slow chunk doesn't hold up the rest
+        const size_t chunks = (helpers + 1) * 4;
+        grain = (count + chunks - 1) / chunks;
+    }
+    grain = llmax(grain, size_t(1));
+    const size_t chunks = (count + grain - 1) / grain;
+    helpers = llmin(helpers, chunks - 1);
+
+    if (! helpers)
+    {
+        timed(options.mTimer, [&body, begin, end](){ body(begin, end); });
+        return;
+    }
+
+    auto state = std::make_shared<ForState>();
+    state->mBody = &body;
+    state->mTimer = options.mTimer;
+    state->mBegin = begin;
+    state->mEnd = end;
+    state->mGrain = grain;
+    state->mChunks = chunks;
+
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        // never block the caller on a full queue: it just does more itself
+        if (! queue->tryPost([state](){ state->runChunks(); }))
+        {
+            break;
+        }
+    }
+    state->runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mMutex);
+    state->mCond.wait(lock, [&state](){ return state->mDone.load() == state->mChunks; });
+    if (state->mException)
+    {
+        std::rethrow_exception(state->mException);
+    }
+}
+
+/*****************************************************************************
+*   TaskGraph
+*****************************************************************************/
+struct LL::TaskGraph::State
+{
+    struct Node
+    {
+        Task mTask;
+        std::vector<TaskId> mSuccessors;
+        size_t mDependencies{ 0 };
+        // during run(), dependencies not yet finished
+        size_t mPending{ 0 };
+    };
+
+    ParallelOptions mOptions;
+    std::vector<Node> mNodes;
+
+    // everything below is guarded by mMutex during run()
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    std::vector<TaskId> mReady;
+    size_t mRemaining{ 0 };
+    size_t mHelpers{ 0 };
+    size_t mMaxHelpers{ 0 };
+    WorkQueueBase::ptr_t mQueue;
+    std::exception_ptr mException;
+    std::atomic<bool> mFailed{ false };
+
+    void runTask(TaskId id)
+    {
+        if (mFailed.load())
+        {
+            return;
+        }
+        try
+        {
+            timed(mOptions.mTimer, mNodes[id].mTask);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (! mException)
+            {
+                mException = std::current_exception();
+            }
+            mFailed = true;
+        }
+    }
+
+    // With mMutex locked: account for a finished task, and return how many
+    // more helpers to post for the tasks it made ready
+    size_t complete(TaskId id)
+    {
+        --mRemaining;
+        const size_t ready = mReady.size();
+        for (TaskId successor : mNodes[id].mSuccessors)
+        {
+            if (! --mNodes[successor].mPending)
+            {
+                mReady.push_back(successor);
+            }
+        }
+        if (mReady.size() > ready || ! mRemaining)
+        {
+            mCond.notify_one();
+        }
+        return reserveHelpers();
+    }
+
+    // With mMutex locked: one ready task is left for the current thread
+    size_t reserveHelpers()
+    {
+        const size_t wanted = mReady.size() > 1 ? mReady.size() - 1 : 0;
+        const size_t posted = llmin(wanted, mMaxHelpers - llmin(mHelpers, mMaxHelpers));
+        mHelpers += posted;
+        return posted;
+    }
+
+    // queue is mQueue as read with mMutex locked: run() may reset it
+    void postHelpers(const std::shared_ptr<State>& self, const WorkQueueBase::ptr_t& queue,
+                     size_t helpers)
+    {
+        for (size_t i = 0; i < helpers; ++i)
+        {
+            if (! queue->tryPost([self](){ self->help(); }))
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mHelpers -= helpers - i;
+                return;
+            }
+        }
+    }
+
+    // A helper runs whatever is ready, then goes back to its pool rather
+    // than waiting: complete() posts new helpers as tasks become ready.
+    void help()
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (! mReady.empty())
+        {
+            const TaskId id = mReady.back();
+            mReady.pop_back();
+            lock.unlock();
+            runTask(id);
+            lock.lock();
+            const size_t helpers = complete(id);
+            if (helpers)
+            {
+                WorkQueueBase::ptr_t queue{ mQueue };
+                lock.unlock();
+                postHelpers(mSelf.lock(), queue, helpers);
+                lock.lock();
+            }
+        }
+        --mHelpers;
+    }
+
+    std::weak_ptr<State> mSelf;
+};
+
+LL::TaskGraph::TaskGraph(const ParallelOptions& options):
+    mState(std::make_shared<State>())
+{
+    mState->mOptions = options;
+    mState->mSelf = mState;
+}
+
+LL::TaskGraph::~TaskGraph()
+{
+}
+
+LL::TaskGraph::TaskId LL::TaskGraph::add(const Task& task, std::initializer_list<TaskId> after)
+{
+    return add(task, std::vector<TaskId>(after));
+}
+
+LL::TaskGraph::TaskId LL::TaskGraph::add(const Task& task, const std::vector<TaskId>& after)
+{
+    const TaskId id = mState->mNodes.size();
+    for (TaskId before : after)
+    {
+        if (before >= id)
+        {
+            LL_ERRS("TaskGraph") << "Task " << id << " depends on task " << before
+                                 << ", which has not been added" << LL_ENDL;
+        }
+        mState->mNodes[before].mSuccessors.push_back(id);
+    }
+    mState->mNodes.emplace_back();
+    mState->mNodes.back().mTask = task;
+    mState->mNodes.back().mDependencies = after.size();
+    return id;
+}
+
+size_t LL::TaskGraph::size() const
+{
+    return mState->mNodes.size();
+}
+
+void LL::TaskGraph::run()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    State& state = *mState;
+    if (state.mNodes.empty())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(state.mMutex);
+    state.mReady.clear();
+    for (TaskId id = 0; id < state.mNodes.size(); ++id)
+    {
+        State::Node& node = state.mNodes[id];
+        node.mPending = node.mDependencies;
+        if (! node.mPending)
+        {
+            state.mReady.push_back(id);
+        }
+    }
+    // run roots in the order they were added
+    std::reverse(state.mReady.begin(), state.mReady.end());
+    state.mRemaining = state.mNodes.size();
+    state.mException = nullptr;
+    state.mFailed = false;
+    state.mMaxHelpers = helperLimit(state.mOptions, state.mQueue);
+
+    size_t helpers = state.reserveHelpers();
+    while (state.mRemaining)
+    {
+        if (helpers)
+        {
+            WorkQueueBase::ptr_t queue{ state.mQueue };
+            lock.unlock();
+            state.postHelpers(mState, queue, helpers);
+            lock.lock();
+        }
+        if (state.mReady.empty())
+        {
+            // waiting on tasks that helpers are running
+            helpers = 0;
+            state.mCond.wait(lock);
+            continue;
+        }
+        const TaskId id = state.mReady.back();
+        state.mReady.pop_back();
+        lock.unlock();
+        state.runTask(id);
+        lock.lock();
+        helpers = state.complete(id);
+    }
+    state.mQueue.reset();
+
+    if (state.mException)
+    {
+        std::exception_ptr exception = state.mException;
+        state.mException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
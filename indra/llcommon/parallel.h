@@ -0,0 +1,115 @@
+/**
+ * @file   parallel.h
+ * @date   2026-10-19
+ * @brief  Fork-join loops and dependent task graphs run on a WorkQueue.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_PARALLEL_H)
+#define LL_PARALLEL_H
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LLTrace
+{
+    class BlockTimerStatHandle;
+}
+
+namespace LL
+{
+    /**
+     * Where and how to run parallel work. The defaults suit a short loop on
+     * the main thread: use the "General" ThreadPool's workers as helpers and
+     * split the range into a few chunks per thread.
+     */
+    struct ParallelOptions
+    {
+        /// name of the WorkQueue whose workers help; work runs serially on
+        /// the calling thread if there is no such queue
+        std::string mQueue{ "General" };
+        /// smallest number of indices per chunk; 0 picks one that gives
+        /// each participating thread about four chunks
+        size_t mGrain{ 0 };
+        /// most helper work items to post, in addition to the caller; by
+        /// default the width of the ThreadPool serving mQueue
+        size_t mMaxHelpers{ size_t(-1) };
+        /// if set, every chunk or task is timed under this fast timer, on
+        /// whichever thread runs it
+        LLTrace::BlockTimerStatHandle* mTimer{ nullptr };
+    };
+
+    /**
+     * parallelFor() calls body(chunk_begin, chunk_end) for consecutive
+     * chunks covering [begin, end), on the calling thread and on workers of
+     * the options' WorkQueue, and returns once every chunk has run. Chunks
+     * run in no particular order and possibly at the same time, so body
+     * must only touch state belonging to its own indices.
+     *
+     * The calling thread runs chunks itself rather than just waiting, so
+     * parallelFor() makes progress even when every worker is busy, and may
+     * be nested: a body may itself call parallelFor().
+     *
+     * As with WorkQueue::waitForResult(), an exception thrown by body is
+     * rethrown on the calling thread. Once one chunk throws, chunks not yet
+     * started are skipped; the first exception wins.
+     */
+    LL_COMMON_API
+    void parallelFor(size_t begin, size_t end,
+                     const std::function<void(size_t, size_t)>& body,
+                     const ParallelOptions& options = ParallelOptions());
+
+    /**
+     * TaskGraph runs a set of tasks, each once, as soon as the tasks it
+     * depends on have finished, on the calling thread and on workers of the
+     * options' WorkQueue. Dependencies name tasks added earlier, so a graph
+     * cannot have cycles.
+     *
+     * @code
+     * LL::TaskGraph graph;
+     * auto load = graph.add([&](){ loadAll(); });
+     * auto left = graph.add([&](){ sortLeft(); }, { load });
+     * auto right = graph.add([&](){ sortRight(); }, { load });
+     * graph.add([&](){ merge(); }, { left, right });
+     * graph.run();
+     * @endcode
+     *
+     * run() returns when every task has finished. If a task throws, tasks
+     * not yet started are skipped and run() rethrows the first exception on
+     * the calling thread, like parallelFor().
+     */
+    class LL_COMMON_API TaskGraph
+    {
+    public:
+        using Task = std::function<void()>;
+        using TaskId = size_t;
+
+        TaskGraph(const ParallelOptions& options = ParallelOptions());
+        ~TaskGraph();
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        /// Add a task to run after every task in 'after'
+        TaskId add(const Task& task, std::initializer_list<TaskId> after = {});
+        TaskId add(const Task& task, const std::vector<TaskId>& after);
+
+        size_t size() const;
+
+        /// Run every task; a graph may be run again once run() returns
+        void run();
+
+    private:
+        struct State;
+        std::shared_ptr<State> mState;
+    };
+
+} // namespace LL
+
+#endif /* ! defined(LL_PARALLEL_H) */
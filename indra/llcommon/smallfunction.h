@@ -0,0 +1,216 @@
+/**
+ * @file   smallfunction.h
+ * @date   2026-10-19
+ * @brief  SmallFunction is a move-only std::function with inline storage
+ *         big enough for typical lambda captures.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_SMALLFUNCTION_H)
+#define LL_SMALLFUNCTION_H
+
+#include <cstddef>                  // std::max_align_t
+#include <functional>               // std::bad_function_call, std::invoke
+#include <new>                      // placement new
+#include <type_traits>
+#include <utility>
+
+namespace LL
+{
+    template <typename Signature, size_t INLINE_SIZE=64>
+    class SmallFunction;
+
+    /**
+     * SmallFunction<R(Args...)> holds any callable, like std::function, with
+     * two differences that matter for work passed between threads:
+     *
+     * * It stores a callable of up to INLINE_SIZE bytes inside itself, where
+     *   std::function only has room for a couple of pointers. A lambda
+     *   capturing a handful of pointers, a weak_ptr or an std::string is
+     *   stored without touching the heap; only bigger callables, or ones that
+     *   might throw while being moved, are allocated.
+     * * It is move-only, so it accepts move-only callables -- lambdas
+     *   capturing a std::unique_ptr or a promise -- and never copies a
+     *   capture behind your back.
+     *
+     * As with std::function, calling an empty SmallFunction throws
+     * std::bad_function_call.
+     */
+    template <typename R, typename... Args, size_t INLINE_SIZE>
+    class SmallFunction<R(Args...), INLINE_SIZE>
+    {
+    public:
+        SmallFunction() noexcept {}
+        SmallFunction(std::nullptr_t) noexcept {}
+
+        template <typename F,
+                  typename = std::enable_if_t<
+                      ! std::is_same_v<std::decay_t<F>, SmallFunction> &&
+                      std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+        SmallFunction(F&& callable)
+        {
+            assign(std::forward<F>(callable));
+        }
+
+        SmallFunction(SmallFunction&& other) noexcept
+        {
+            take(other);
+        }
+
+        SmallFunction& operator=(SmallFunction&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                take(other);
+            }
+            return *this;
+        }
+
+        SmallFunction& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        SmallFunction(const SmallFunction&) = delete;
+        SmallFunction& operator=(const SmallFunction&) = delete;
+
+        ~SmallFunction()
+        {
+            reset();
+        }
+
+        explicit operator bool() const noexcept { return mOps != nullptr; }
+
+        /// const like std::function::operator(): the callable itself may
+        /// still be a mutable lambda
+        R operator()(Args... args) const
+        {
+            if (! mOps)
+            {
+                throw std::bad_function_call();
+            }
+            return mOps->mInvoke(mStorage, std::forward<Args>(args)...);
+        }
+
+        /// true if the callable lives in our inline storage, false if it's
+        /// on the heap (or there is none)
+        bool isInline() const noexcept { return mOps && mOps->mInline; }
+
+        /// would a callable of type F be stored inline?
+        template <typename F>
+        static constexpr bool fitsInline()
+        {
+            return sizeof(F) <= INLINE_SIZE &&
+                alignof(F) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<F>;
+        }
+
+    private:
+        // one static table per stored callable type
+        struct Ops
+        {
+            R (*mInvoke)(void* storage, Args&&... args);
+            // move-construct from 'from' into 'to', destroying 'from'
+            void (*mRelocate)(void* from, void* to) noexcept;
+            void (*mDestroy)(void* storage) noexcept;
+            bool mInline;
+        };
+
+        template <typename F>
+        struct InlineOps
+        {
+            static R invoke(void* storage, Args&&... args)
+            {
+                return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+            }
+            static void relocate(void* from, void* to) noexcept
+            {
+                F* source = static_cast<F*>(from);
+                new (to) F(std::move(*source));
+                source->~F();
+            }
+            static void destroy(void* storage) noexcept
+            {
+                static_cast<F*>(storage)->~F();
+            }
+            static constexpr Ops sOps{ invoke, relocate, destroy, true };
+        };
+
+        // the storage holds only a pointer to the heap callable
+        template <typename F>
+        struct HeapOps
+        {
+            static F*& target(void* storage) { return *static_cast<F**>(storage); }
+
+            static R invoke(void* storage, Args&&... args)
+            {
+                return std::invoke(*target(storage), std::forward<Args>(args)...);
+            }
+            static void relocate(void* from, void* to) noexcept
+            {
+                new (to) F*(target(from));
+            }
+            static void destroy(void* storage) noexcept
+            {
+                delete target(storage);
+            }
+            static constexpr Ops sOps{ invoke, relocate, destroy, false };
+        };
+
+        template <typename F>
+        void assign(F&& callable)
+        {
+            using Stored = std::decay_t<F>;
+            if constexpr (std::is_pointer_v<Stored> || std::is_member_pointer_v<Stored>)
+            {
+                // a null function pointer makes an empty SmallFunction, as
+                // it would an empty std::function
+                if (! callable)
+                {
+                    return;
+                }
+            }
+            if constexpr (fitsInline<Stored>())
+            {
+                new (mStorage) Stored(std::forward<F>(callable));
+                mOps = &InlineOps<Stored>::sOps;
+            }
+            else
+            {
+                new (mStorage) Stored*(new Stored(std::forward<F>(callable)));
+                mOps = &HeapOps<Stored>::sOps;
+            }
+        }
+
+        void take(SmallFunction& other) noexcept
+        {
+            if (other.mOps)
+            {
+                other.mOps->mRelocate(other.mStorage, mStorage);
+                mOps = other.mOps;
+                other.mOps = nullptr;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (mOps)
+            {
+                mOps->mDestroy(mStorage);
+                mOps = nullptr;
+            }
+        }
+
+        // mutable for the const operator()
+        alignas(std::max_align_t) mutable unsigned char mStorage[INLINE_SIZE];
+        const Ops* mOps{ nullptr };
+    };
+
+} // namespace LL
+
+#endif /* ! defined(LL_SMALLFUNCTION_H) */
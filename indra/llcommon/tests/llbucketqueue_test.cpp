@@ -0,0 +1,331 @@
+/**
+ * @file llbucketqueue_test.cpp
+ * @brief Tests and scheduling benchmark for LLBucketQueue
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llbucketqueue.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <map>
+#include <vector>
+
+namespace tut
+{
+    struct bucketqueue_data
+    {
+        // Simulates the viewer texture list: NUM_ITEMS textures, a burst of
+        // priority changes as a region comes into view, then a steady trickle
+        // as the camera moves.  Each frame the scheduler may update 'budget'
+        // textures.  Staleness is the number of frames between a texture's
+        // priority changing and the scheduler getting to it.
+        struct Result
+        {
+            F64 mStaleness = 0.0;
+            F64 mImportantStaleness = 0.0;
+            F64 mProcessedPerMs = 0.0;
+        };
+
+        static const S32 NUM_ITEMS = 20000;
+        static const S32 NUM_FRAMES = 120;
+        static const S32 BURST = 15000;
+        static const S32 CHANGES_PER_FRAME = 200;
+        static const U32 IMPORTANT_LEVEL = 18;
+
+        struct Change
+        {
+            U32 mItem;
+            U32 mLevel;
+        };
+
+        // Deterministic change list per frame, shared by both schedulers
+        static std::vector<std::vector<Change> > makeChanges()
+        {
+            std::vector<std::vector<Change> > frames(NUM_FRAMES);
+            U32 seed = 4321;
+            auto next = [&seed]() { seed = seed * 1103515245 + 12345; return seed >> 8; };
+            for (S32 frame = 0; frame < NUM_FRAMES; ++frame)
+            {
+                S32 count = frame == 0 ? BURST : CHANGES_PER_FRAME;
+                for (S32 i = 0; i < count; ++i)
+                {
+                    U32 item = next() % NUM_ITEMS;
+                    // one change in ten is a texture filling a good part of the screen
+                    U32 level = (next() % 10) == 0 ? IMPORTANT_LEVEL + next() % 4 : next() % IMPORTANT_LEVEL;
+                    frames[frame].push_back(Change{ item, level });
+                }
+            }
+            return frames;
+        }
+
+        struct Tracker
+        {
+            std::vector<S32> mChangedFrame = std::vector<S32>(NUM_ITEMS, -1);
+            std::vector<U32> mLevel = std::vector<U32>(NUM_ITEMS, 0);
+            F64 mTotal = 0.0;
+            S32 mCount = 0;
+            F64 mImportantTotal = 0.0;
+            S32 mImportantCount = 0;
+
+            void change(const Change& change, S32 frame)
+            {
+                if (mChangedFrame[change.mItem] < 0)
+                {
+                    mChangedFrame[change.mItem] = frame;
+                }
+                mLevel[change.mItem] = change.mLevel;
+            }
+
+            void process(U32 item, S32 frame)
+            {
+                S32 changed = mChangedFrame[item];
+                if (changed < 0)
+                {
+                    return;
+                }
+                F64 staleness = (F64)(frame - changed);
+                mTotal += staleness;
+                ++mCount;
+                if (mLevel[item] >= IMPORTANT_LEVEL)
+                {
+                    mImportantTotal += staleness;
+                    ++mImportantCount;
+                }
+                mChangedFrame[item] = -1;
+            }
+
+            // Changes never processed count as stale for the rest of the run
+            void finish(Result& result)
+            {
+                for (U32 item = 0; item < (U32)NUM_ITEMS; ++item)
+                {
+                    process(item, NUM_FRAMES);
+                }
+                result.mStaleness = mTotal / llmax(mCount, 1);
+                result.mImportantStaleness = mImportantTotal / llmax(mImportantCount, 1);
+            }
+        };
+
+        // What LLViewerTextureList::updateImagesFetchTextures used to do: walk
+        // the whole map from where the last frame stopped.
+        static Result roundRobin(const std::vector<std::vector<Change> >& frames, S32 budget)
+        {
+            std::map<U32, S32> items;
+            for (U32 item = 0; item < (U32)NUM_ITEMS; ++item)
+            {
+                items[item] = 0;
+            }
+            Tracker tracker;
+            U32 last_key = 0;
+            S64 processed = 0;
+            F64 elapsed = 0.0;
+            std::vector<U32> entries;
+            for (S32 frame = 0; frame < NUM_FRAMES; ++frame)
+            {
+                for (const Change& change : frames[frame])
+                {
+                    tracker.change(change, frame);
+                }
+
+                LLTimer timer;
+                entries.clear();
+                auto iter = items.upper_bound(last_key);
+                for (S32 i = 0; i < budget; ++i)
+                {
+                    if (iter == items.end())
+                    {
+                        iter = items.begin();
+                    }
+                    entries.push_back(iter->first);
+                    ++iter;
+                }
+                elapsed += timer.getElapsedTimeF64();
+
+                for (U32 item : entries)
+                {
+                    last_key = item;
+                    tracker.process(item, frame);
+                }
+                processed += entries.size();
+            }
+            Result result;
+            tracker.finish(result);
+            result.mProcessedPerMs = (F64)processed / llmax(elapsed * 1000.0, 1e-6);
+            return result;
+        }
+
+        // The bucketed queue, plus a short round robin sweep for textures
+        // whose priority is never reported
+        static Result bucketed(const std::vector<std::vector<Change> >& frames, S32 budget, S32 sweep)
+        {
+            LLBucketQueue<U32> queue;
+            Tracker tracker;
+            U32 sweep_key = 0;
+            S64 processed = 0;
+            F64 elapsed = 0.0;
+            std::vector<U32> entries;
+            for (S32 frame = 0; frame < NUM_FRAMES; ++frame)
+            {
+                LLTimer timer;
+                for (const Change& change : frames[frame])
+                {
+                    tracker.change(change, frame);
+                    queue.push(change.mItem, change.mLevel, frame);
+                }
+
+                entries.clear();
+                U32 item;
+                while ((S32)entries.size() < budget && queue.pop(item))
+                {
+                    entries.push_back(item);
+                }
+                for (S32 i = 0; i < sweep; ++i)
+                {
+                    sweep_key = (sweep_key + 1) % NUM_ITEMS;
+                    queue.remove(sweep_key);
+                    entries.push_back(sweep_key);
+                }
+                elapsed += timer.getElapsedTimeF64();
+
+                for (U32 item : entries)
+                {
+                    tracker.process(item, frame);
+                }
+                processed += entries.size();
+            }
+            Result result;
+            tracker.finish(result);
+            result.mProcessedPerMs = (F64)processed / llmax(elapsed * 1000.0, 1e-6);
+            return result;
+        }
+    };
+    typedef test_group<bucketqueue_data> bucketqueue_test;
+    typedef bucketqueue_test::object bucketqueue_object;
+    tut::bucketqueue_test bucketqueue_testcase("LLBucketQueue");
+
+    template<> template<>
+    void bucketqueue_object::test<1>()
+    {
+        set_test_name("highest bucket first, oldest first within a bucket");
+
+        LLBucketQueue<S32> queue;
+        queue.push(1, 3, 10);
+        queue.push(2, 7, 11);
+        queue.push(3, 3, 12);
+        queue.push(4, 0, 13);
+        queue.push(5, 100, 14);    // clamped to the top bucket
+        ensure_equals("size", queue.size(), 5);
+
+        S32 data;
+        U32 bucket;
+        U64 stamp;
+        ensure("pop 5", queue.pop(data, &bucket, &stamp));
+        ensure_equals("top", data, 5);
+        ensure_equals("clamped", bucket, 31);
+        ensure_equals("stamp", stamp, 14);
+        ensure("pop 2", queue.pop(data) && data == 2);
+        ensure("pop 1", queue.pop(data) && data == 1);
+        ensure("pop 3", queue.pop(data) && data == 3);
+        ensure("pop 4", queue.pop(data) && data == 4);
+        ensure("empty", !queue.pop(data) && queue.empty());
+    }
+
+    template<> template<>
+    void bucketqueue_object::test<2>()
+    {
+        set_test_name("pushes only raise, remove drops");
+
+        LLBucketQueue<S32> queue;
+        queue.push(1, 5, 100);
+        queue.push(2, 6, 101);
+        queue.push(1, 2, 102);      // lower: ignored
+        queue.push(1, 9, 103);      // higher: moved, keeps first stamp
+        ensure_equals("size", queue.size(), 2);
+
+        S32 data;
+        U32 bucket;
+        U64 stamp;
+        ensure("pop raised", queue.pop(data, &bucket, &stamp));
+        ensure_equals("raised item", data, 1);
+        ensure_equals("raised bucket", bucket, 9);
+        ensure_equals("first stamp", stamp, 100);
+
+        queue.push(3, 1);
+        ensure("remove 2", queue.remove(2));
+        ensure("remove twice", !queue.remove(2));
+        ensure("contains 3", queue.contains(3));
+        ensure("pop 3", queue.pop(data) && data == 3);
+        ensure("empty", !queue.pop(data));
+    }
+
+    template<> template<>
+    void bucketqueue_object::test<3>()
+    {
+        set_test_name("dead entries are compacted");
+
+        LLBucketQueue<S32> queue;
+        for (S32 round = 0; round < 100; ++round)
+        {
+            for (S32 i = 0; i < 1000; ++i)
+            {
+                queue.push(i, round % 32);
+            }
+            for (S32 i = 0; i < 1000; i += 2)
+            {
+                queue.remove(i);
+            }
+        }
+        ensure_equals("live", queue.size(), 500);
+        S32 data;
+        S32 count = 0;
+        while (queue.pop(data))
+        {
+            ensure("odd only", data & 1);
+            ++count;
+        }
+        ensure_equals("popped", count, 500);
+    }
+
+    template<> template<>
+    void bucketqueue_object::test<4>()
+    {
+        set_test_name("texture scheduling benchmark");
+
+        std::vector<std::vector<Change> > frames = makeChanges();
+        const S32 budget = llmax(32, NUM_ITEMS / 20);
+        Result rr = roundRobin(frames, budget);
+        Result bq = bucketed(frames, budget, 32);
+
+        LL_INFOS() << "Round robin: staleness " << rr.mStaleness << " frames, important "
+                   << rr.mImportantStaleness << " frames, " << rr.mProcessedPerMs << " textures/ms" << LL_ENDL;
+        LL_INFOS() << "Bucketed: staleness " << bq.mStaleness << " frames, important "
+                   << bq.mImportantStaleness << " frames, " << bq.mProcessedPerMs << " textures/ms" << LL_ENDL;
+
+        ensure("important textures served sooner", bq.mImportantStaleness < rr.mImportantStaleness);
+        ensure("important textures within two frames", bq.mImportantStaleness <= 2.0);
+    }
+}
@@ -0,0 +1,302 @@
+/**
+ * @file   lleventchannel_test.cpp
+ * @date   2026-10-19
+ * @brief  Test for lleventchannel.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lleventchannel.h"
+// STL headers
+// std headers
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "../test/catch_and_store_what_in.h"
+#include "llsdutil.h"
+#include "stringize.h"
+
+namespace
+{
+    std::string str(const std::vector<S32>& calls)
+    {
+        std::ostringstream out;
+        const char* delim = "";
+        for (S32 call : calls)
+        {
+            out << delim << call;
+            delim = " ";
+        }
+        return out.str();
+    }
+
+    // nanoseconds per listener call for posting 'events' times to 'post'
+    template <typename POST>
+    F64 timePosts(size_t events, size_t listeners, POST&& post)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < events; ++i)
+        {
+            post(i);
+        }
+        std::chrono::duration<F64, std::nano> elapsed(std::chrono::steady_clock::now() - start);
+        return elapsed.count() / F64(events * listeners);
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct lleventchannel_data
+    {
+        LLEventChannel<S32> channel{ "channel" };
+        std::vector<S32> calls;
+
+        LLEventChannel<S32>::Listener record(S32 tag, bool stop = false)
+        {
+            return [this, tag, stop](const S32& payload)
+            {
+                calls.push_back(tag * 100 + payload);
+                return stop;
+            };
+        }
+    };
+    typedef test_group<lleventchannel_data> lleventchannel_group;
+    typedef lleventchannel_group::object object;
+    lleventchannel_group lleventchannelgrp("lleventchannel");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("listen, post, disconnect");
+        ensure("no listeners", ! channel.post(1));
+        auto first = channel.listen("first", record(1));
+        auto second = channel.listen("second", record(2));
+        ensure_equals("size", channel.size(), 2);
+        ensure("stopped", ! channel.post(3));
+        ensure_equals("calls", str(calls), "103 203");
+
+        first.disconnect();
+        ensure("still connected", ! first.connected());
+        ensure("other disconnected", second.connected());
+        // harmless twice
+        first.disconnect();
+        calls.clear();
+        channel.post(4);
+        ensure_equals("calls after disconnect", str(calls), "204");
+
+        // a freed name may be reused
+        auto again = channel.listen("first", record(3));
+        calls.clear();
+        channel.post(5);
+        ensure_equals("calls after relisten", str(calls), "205 305");
+
+        std::string what = catch_what<LLEventPump::DupListenerName>(
+            [this](){ channel.listen("second", record(4)); });
+        ensure_contains("duplicate name", what, "second");
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("stop propagation and TempConnection");
+        LLEventChannel<S32>::TempConnection stopper{ channel.listen("stopper", record(1, true)) };
+        {
+            LLEventChannel<S32>::TempConnection temp;
+            temp = channel.listen("temp", record(2));
+            ensure("not stopped", channel.post(6));
+            ensure_equals("calls", str(calls), "106");
+            stopper.disconnect();
+            calls.clear();
+            ensure("stopped without stopper", ! channel.post(7));
+            ensure_equals("calls without stopper", str(calls), "207");
+        }
+        ensure("temp still listening", channel.empty());
+
+        // a connection outliving its channel is harmless
+        LLEventChannel<S32>::Connection orphan;
+        {
+            LLEventChannel<S32> shortlived("shortlived");
+            orphan = shortlived.listen("orphan", record(5));
+        }
+        ensure("orphan connected", ! orphan.connected());
+        orphan.disconnect();
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("listeners changing the channel during post");
+        LLEventChannel<S32>::Connection second;
+        LLEventChannel<S32>::TempConnection added;
+        // the first listener disconnects the second and adds a third: the
+        // second is not called, the third only from the next post()
+        auto first = channel.listen("first", [&](const S32& payload)
+            {
+                calls.push_back(100 + payload);
+                second.disconnect();
+                if (! added.connected())
+                {
+                    added = channel.listen("third", record(3));
+                }
+                return false;
+            });
+        second = channel.listen("second", record(2));
+        channel.post(1);
+        ensure_equals("calls", str(calls), "101");
+        calls.clear();
+        channel.post(2);
+        ensure_equals("calls next time", str(calls), "102 302");
+
+        // a listener may disconnect itself
+        LLEventChannel<S32>::Connection self;
+        self = channel.listen("self", [&](const S32&){ self.disconnect(); calls.push_back(0); return false; });
+        calls.clear();
+        channel.post(3);
+        channel.post(4);
+        ensure_equals("self-disconnecting calls", str(calls), "103 303 0 104 304");
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("post from several threads while listeners change");
+        LLEventChannel<S32> shared("shared");
+        std::atomic<size_t> heard{ 0 };
+        std::atomic<bool> stop{ false };
+        auto count = [&heard](const S32&){ ++heard; return false; };
+        LLEventChannel<S32>::TempConnection always{ shared.listen("always", count) };
+
+        std::vector<std::thread> posters;
+        std::atomic<size_t> posted{ 0 };
+        for (S32 i = 0; i < 3; ++i)
+        {
+            posters.emplace_back([&shared, &stop, &posted, i]()
+                {
+                    while (! stop.load())
+                    {
+                        shared.post(i);
+                        ++posted;
+                    }
+                });
+        }
+        for (size_t i = 0; i < 2000; ++i)
+        {
+            LLEventChannel<S32>::TempConnection churn{ shared.listen(stringize("churn", i), count) };
+        }
+        stop = true;
+        for (auto& poster : posters)
+        {
+            poster.join();
+        }
+        ensure("missed events", heard.load() >= posted.load());
+        ensure_equals("listeners left", shared.size(), 1);
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("dispatch cost per listener vs LLEventStream");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        const size_t events = 20000;
+        for (size_t listeners : { 1, 4, 16 })
+        {
+            size_t sum = 0;
+            LLEventStream stream("benchstream", true);
+            LLEventChannel<S32> typed("benchchannel");
+            std::vector<LLTempBoundListener> streamConnections;
+            std::vector<std::unique_ptr<LLEventChannel<S32>::TempConnection>> typedConnections;
+            for (size_t i = 0; i < listeners; ++i)
+            {
+                streamConnections.emplace_back(
+                    stream.listen(stringize("l", i),
+                                  [&sum](const LLSD& event){ sum += event["frame"].asInteger(); return false; }));
+                typedConnections.emplace_back(new LLEventChannel<S32>::TempConnection(
+                    typed.listen(stringize("l", i),
+                                 [&sum](const S32& frame){ sum += frame; return false; })));
+            }
+            const F64 streamNs = timePosts(events, listeners, [&stream](size_t i)
+                {
+                    stream.post(llsd::map("frame", LLSD::Integer(i)));
+                });
+            const F64 typedNs = timePosts(events, listeners, [&typed](size_t i)
+                {
+                    typed.post(S32(i));
+                });
+            ensure("listeners not called", sum > 0);
+            LL_INFOS() << listeners << " listeners: LLEventStream " << streamNs
+                       << " ns/listener, LLEventChannel " << typedNs << " ns/listener" << LL_ENDL;
+        }
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("disconnect waits for a call on another thread");
+        LLEventChannel<S32> shared("shared");
+        std::atomic<bool> entered{ false }, finished{ false };
+        std::atomic<size_t> calls{ 0 };
+        LLEventChannel<S32>::Connection slow = shared.listen("slow", [&](const S32&)
+            {
+                ++calls;
+                entered = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                finished = true;
+                return false;
+            });
+        std::thread poster([&shared](){ shared.post(1); });
+        while (! entered.load())
+        {
+            std::this_thread::yield();
+        }
+        slow.disconnect();
+        ensure("disconnect returned during the call", finished.load());
+        poster.join();
+        shared.post(2);
+        ensure_equals("called after disconnect", calls.load(), 1);
+    }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("size from another thread while listeners change");
+        LLEventChannel<S32> shared("shared");
+        auto ignore = [](const S32&){ return false; };
+        LLEventChannel<S32>::TempConnection always{ shared.listen("always", ignore) };
+
+        std::atomic<bool> stop{ false };
+        std::atomic<size_t> bad{ 0 };
+        std::thread counter([&]()
+            {
+                while (! stop.load())
+                {
+                    size_t size = shared.size();
+                    if (size < 1 || size > 2)
+                    {
+                        ++bad;
+                    }
+                }
+            });
+        for (size_t i = 0; i < 2000; ++i)
+        {
+            LLEventChannel<S32>::TempConnection churn{ shared.listen(stringize("churn", i), ignore) };
+        }
+        stop = true;
+        counter.join();
+        ensure_equals("sizes out of range", bad.load(), 0);
+        ensure_equals("listeners left", shared.size(), 1);
+    }
+} // namespace tut
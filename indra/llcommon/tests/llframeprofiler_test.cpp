@@ -0,0 +1,231 @@
+/**
+ * @file llframeprofiler_test.cpp
+ * @brief Tests for LLFrameProfiler
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llframeprofiler.h"
+#include "llfasttimer.h"
+#include "llfile.h"
+#include "lltimer.h"
+#include "lltracerecording.h"
+#include "lltracethreadrecorder.h"
+#include "../test/lltut.h"
+
+#include <filesystem>
+#include <map>
+#include <regex>
+#include <sstream>
+
+namespace tut
+{
+    using namespace LLTrace;
+
+    static BlockTimerStatHandle FTM_BREW("Brew");
+    static BlockTimerStatHandle FTM_GRIND("Grind");
+    static BlockTimerStatHandle FTM_POUR("Pour");
+
+    struct frameprofiler_data
+    {
+        ThreadRecorder mRecorder;
+
+        // Runs one frame of grinding and pouring inside brewing, spending
+        // about 'ms' milliseconds in each, and hands it to the profiler
+        std::string brew(LLFrameProfiler& profiler, U32 ms)
+        {
+            Recording frame;
+            frame.start();
+            {
+                LL_RECORD_BLOCK_TIME(FTM_BREW);
+                {
+                    LL_RECORD_BLOCK_TIME(FTM_GRIND);
+                    ms_sleep(ms);
+                }
+                {
+                    LL_RECORD_BLOCK_TIME(FTM_POUR);
+                    ms_sleep(ms);
+                }
+            }
+            BlockTimer::processTimes();
+            frame.stop();
+            return profiler.recordFrame(frame);
+        }
+
+        struct Event
+        {
+            S64 mTs;
+            S64 mDur;
+            S64 mArg;
+        };
+        typedef std::multimap<std::string, Event> events_t;
+
+        // Complete events from a written trace, by name; the trace has one
+        // event per line
+        static events_t getEvents(const std::string& json)
+        {
+            static const std::regex EVENT("\\{\"name\":\"([^\"]*)\",\"cat\":\"[a-z]+\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                                          "\"ts\":([0-9]+),\"dur\":([0-9]+),\"args\":\\{\"[a-z]+\":([0-9]+)\\}\\}");
+            events_t events;
+            std::istringstream lines(json);
+            std::string line;
+            std::smatch match;
+            while (std::getline(lines, line))
+            {
+                if (std::regex_search(line, match, EVENT))
+                {
+                    events.emplace(match[1].str(), Event{ std::stoll(match[2].str()), std::stoll(match[3].str()),
+                                                          std::stoll(match[4].str()) });
+                }
+            }
+            return events;
+        }
+
+        static bool inside(const Event& inner, const Event& outer)
+        {
+            return inner.mTs >= outer.mTs && inner.mTs + inner.mDur <= outer.mTs + outer.mDur;
+        }
+    };
+    typedef test_group<frameprofiler_data> frameprofiler_test;
+    typedef frameprofiler_test::object frameprofiler_object;
+    tut::frameprofiler_test frameprofiler_testcase("LLFrameProfiler");
+
+    template<> template<>
+    void frameprofiler_object::test<1>()
+    {
+        set_test_name("timer hierarchy is written nested in each frame");
+
+        LLFrameProfiler profiler("", 0.f, 60.f, LLFrameProfiler::DEFAULT_MAX_DUMPS, 4);
+        for (S32 i = 0; i < 6; ++i)
+        {
+            ensure("no dump without a threshold", brew(profiler, 1).empty());
+        }
+        ensure_equals("ring keeps the newest frames", profiler.getNumFrames(), (size_t)4);
+
+        std::ostringstream json;
+        profiler.writeTrace(json, 60.f);
+        events_t events = getEvents(json.str());
+
+        ensure_equals("frames written", events.count("Frame 0") + events.count("Frame 1"), (size_t)0);
+        ensure_equals("newest frame written", events.count("Frame 5"), (size_t)1);
+        ensure_equals("one brew per frame", events.count("Brew"), (size_t)4);
+
+        const Event& frame = events.find("Frame 5")->second;
+        auto brews = events.equal_range("Brew");
+        const Event* brew = NULL;
+        for (auto it = brews.first; it != brews.second; ++it)
+        {
+            if (inside(it->second, frame))
+            {
+                brew = &it->second;
+            }
+        }
+        ensure("brew inside its frame", brew != NULL);
+        ensure_equals("brew called once", brew->mArg, (S64)1);
+
+        bool grind_inside = false;
+        bool pour_inside = false;
+        for (const auto& event : events)
+        {
+            grind_inside = grind_inside || (event.first == "Grind" && inside(event.second, *brew));
+            pour_inside = pour_inside || (event.first == "Pour" && inside(event.second, *brew));
+        }
+        ensure("grind inside brew", grind_inside);
+        ensure("pour inside brew", pour_inside);
+    }
+
+    template<> template<>
+    void frameprofiler_object::test<2>()
+    {
+        set_test_name("hitch dumps the recent frames once");
+
+        const std::string prefix = std::string(LLFile::tmpdir()) + "llframeprofiler_test";
+        LLFrameProfiler profiler(prefix, 15.f, 60.f);
+        ensure("fast frame", brew(profiler, 1).empty());
+
+        std::string filename = brew(profiler, 10);
+        ensure_equals("slow frame dumps", filename, prefix + "_1.json");
+        ensure("second slow frame waits", brew(profiler, 10).empty());
+
+        // Without a "General" work queue the dump is written straight away
+        llifstream file(filename.c_str());
+        std::stringstream json;
+        json << file.rdbuf();
+        file.close();
+        LLFile::remove(filename);
+
+        events_t events = getEvents(json.str());
+        ensure_equals("frames before the hitch", events.count("Frame 0"), (size_t)1);
+        ensure_equals("the hitch", events.count("Frame 1"), (size_t)1);
+        ensure_equals("nothing after it", events.count("Frame 2"), (size_t)0);
+    }
+
+    template<> template<>
+    void frameprofiler_object::test<3>()
+    {
+        set_test_name("old dumps are deleted beyond the limit");
+
+        namespace fs = std::filesystem;
+        const fs::path dir = fs::path(LLFile::tmpdir()) / "llframeprofiler_test_dumps";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        const std::string prefix = (dir / "hitch").string();
+
+        // Left by earlier sessions, oldest first
+        const fs::file_time_type past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+        for (S32 i = 0; i < 3; ++i)
+        {
+            const fs::path old = dir / ("hitch_" + std::to_string(100 + i) + ".json");
+            llofstream(old.string().c_str()) << "{}";
+            fs::last_write_time(old, past + std::chrono::minutes(i));
+        }
+        llofstream((dir / "unrelated.json").string().c_str()) << "{}";
+
+        LLFrameProfiler profiler(prefix, 5.f, 0.f, 2);
+        const std::string first = brew(profiler, 5);
+        ensure("first slow frame dumps", !first.empty());
+        ensure("newest old dump kept", fs::exists(dir / "hitch_102.json"));
+        ensure("older dumps deleted", !fs::exists(dir / "hitch_101.json") && !fs::exists(dir / "hitch_100.json"));
+
+        const std::string second = brew(profiler, 5);
+        ensure("second slow frame dumps", !second.empty());
+        ensure("both new dumps kept", fs::exists(first) && fs::exists(second));
+        ensure("last old dump deleted", !fs::exists(dir / "hitch_102.json"));
+        ensure("other files untouched", fs::exists(dir / "unrelated.json"));
+
+        fs::remove_all(dir);
+    }
+
+    template<> template<>
+    void frameprofiler_object::test<4>()
+    {
+        set_test_name("held dumps do not start");
+
+        const std::string prefix = std::string(LLFile::tmpdir()) + "llframeprofiler_test_held";
+        LLFrameProfiler profiler(prefix, 5.f, 0.f);
+        profiler.holdDumps(60.f);
+        ensure("slow frame while held", brew(profiler, 5).empty());
+        ensure_equals("frame still kept", profiler.getNumFrames(), (size_t)1);
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file llmemtag_test.cpp
+ * @brief Tests for LLMemTag
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmemtag.h"
+#include "llsd.h"
+#include "../test/lltut.h"
+
+#include <sstream>
+#include <thread>
+
+namespace tut
+{
+    struct memtag_data
+    {
+        static S64 live(LLMemTag::ETag tag)
+        {
+            return LLMemTag::getStats(tag).mLiveBytes;
+        }
+    };
+    typedef test_group<memtag_data> memtag_test;
+    typedef memtag_test::object memtag_object;
+    tut::memtag_test memtag_testcase("LLMemTag");
+
+    template<> template<>
+    void memtag_object::test<1>()
+    {
+        set_test_name("scopes nest and end");
+
+        ensure_equals("fallback outside scopes", LLMemTag::current(LLMemTag::IMAGE), LLMemTag::IMAGE);
+        {
+            LLMemTagScope mesh(LLMemTag::MESH);
+            ensure_equals("scope overrides fallback", LLMemTag::current(LLMemTag::IMAGE), LLMemTag::MESH);
+            {
+                LLMemTagScope ui(LLMemTag::UI);
+                ensure_equals("innermost scope", LLMemTag::current(LLMemTag::IMAGE), LLMemTag::UI);
+            }
+            ensure_equals("outer scope back", LLMemTag::current(LLMemTag::IMAGE), LLMemTag::MESH);
+
+            LLMemTag::ETag other_thread = LLMemTag::OTHER;
+            std::thread thread([&other_thread]() { other_thread = LLMemTag::current(LLMemTag::VOLUME); });
+            thread.join();
+            ensure_equals("scopes are per thread", other_thread, LLMemTag::VOLUME);
+        }
+        ensure_equals("fallback again", LLMemTag::current(LLMemTag::IMAGE), LLMemTag::IMAGE);
+    }
+
+    template<> template<>
+    void memtag_object::test<2>()
+    {
+        set_test_name("charges balance");
+
+        const LLMemTag::Stats before = LLMemTag::getStats(LLMemTag::UI);
+        LLMemTag::charge(LLMemTag::UI, 1000);
+        LLMemTag::charge(LLMemTag::UI, 24);
+        ensure_equals("live", live(LLMemTag::UI) - before.mLiveBytes, (S64)1024);
+        LLMemTag::discharge(LLMemTag::UI, 1000);
+        LLMemTag::discharge(LLMemTag::UI, 24);
+
+        const LLMemTag::Stats after = LLMemTag::getStats(LLMemTag::UI);
+        ensure_equals("nothing live", after.mLiveBytes, before.mLiveBytes);
+        ensure_equals("allocated", after.mAllocatedBytes - before.mAllocatedBytes, (U64)1024);
+        ensure_equals("allocations", after.mAllocations - before.mAllocations, (U64)2);
+        ensure_equals("frees", after.mFrees - before.mFrees, (U64)2);
+    }
+
+    template<> template<>
+    void memtag_object::test<3>()
+    {
+        set_test_name("LLSD nodes go to the scope they were made in");
+
+        const S64 llsd_before = live(LLMemTag::LLSD_NODES);
+        const S64 inventory_before = live(LLMemTag::INVENTORY);
+        {
+            LLSD untagged = LLSD::emptyMap();
+            untagged["name"] = "Rock";
+            ensure("untagged nodes", live(LLMemTag::LLSD_NODES) > llsd_before);
+
+            LLSD tagged;
+            {
+                LLMemTagScope scope(LLMemTag::INVENTORY);
+                tagged = LLSD::emptyArray();
+                tagged.append(LLSD::Integer(7));
+            }
+            const S64 inventory = live(LLMemTag::INVENTORY);
+            ensure("tagged nodes", inventory > inventory_before);
+
+            // Freed outside the scope, still discharged from inventory
+            tagged.clear();
+            ensure("tagged nodes freed", live(LLMemTag::INVENTORY) < inventory);
+        }
+        ensure_equals("LLSD balanced", live(LLMemTag::LLSD_NODES), llsd_before);
+        ensure_equals("inventory balanced", live(LLMemTag::INVENTORY), inventory_before);
+    }
+
+    template<> template<>
+    void memtag_object::test<4>()
+    {
+        set_test_name("dump lists every tag");
+
+        std::ostringstream out;
+        LLMemTag::dump(out);
+        const std::string table = out.str();
+        for (S32 i = 0; i < LLMemTag::COUNT; ++i)
+        {
+            ensure(LLMemTag::getName((LLMemTag::ETag)i), table.find(LLMemTag::getName((LLMemTag::ETag)i)) != std::string::npos);
+        }
+        ensure("total", table.find("Total") != std::string::npos);
+    }
+}
@@ -25,7 +25,7 @@
  * $/LicenseInfo$
  */
 
-
+#define LLSD_DEBUG_INFO
 #include "linden_common.h"
 
 #if LL_WINDOWS
@@ -51,13 +51,16 @@ typedef U32 uint32_t;
 #include "llsdutil.h"
 #include "llformat.h"
 #include "llmemorystream.h"
+#include "lltimer.h"
 
 #include "../test/hexdump.h"
 #include "../test/lltut.h"
 #include "../test/namedtempfile.h"
 #include "stringize.h"
 #include "StringVec.h"
+#include <cmath>
 #include <functional>
+#include <random>
 
 typedef std::function<void(const LLSD& data, std::ostream& str)> FormatterFunction;
 typedef std::function<bool(std::istream& istr, LLSD& data, llssize max_bytes)> ParserFunction;
@@ -2194,4 +2197,699 @@ namespace tut
                         { return LLSDSerialize::fromBinary(data, istr, max_bytes) > 0; });
     }
 |*==========================================================================*/
+
+    /**
+     * @class TestLLSDVisitor
+     * @brief Event driven parsing and the binary pull cursor
+     */
+    struct TestLLSDVisitor
+    {
+        // Formats we can both write and visit
+        enum EFormat { FORMAT_BINARY, FORMAT_NOTATION, FORMAT_XML };
+
+        static std::string format(const LLSD& sd, EFormat fmt)
+        {
+            std::ostringstream ostr;
+            switch (fmt)
+            {
+            case FORMAT_BINARY:   LLSDSerialize::toBinary(sd, ostr);   break;
+            case FORMAT_NOTATION: LLSDSerialize::toNotation(sd, ostr); break;
+            case FORMAT_XML:      LLSDSerialize::toXML(sd, ostr);      break;
+            }
+            return ostr.str();
+        }
+
+        static S32 visit(LLSDParseVisitor& visitor, const std::string& buffer, EFormat fmt)
+        {
+            std::istringstream istr(buffer);
+            switch (fmt)
+            {
+            case FORMAT_BINARY:   return LLSDSerialize::visitBinary(visitor, istr, buffer.size());
+            case FORMAT_NOTATION: return LLSDSerialize::visitNotation(visitor, istr, buffer.size());
+            case FORMAT_XML:      return LLSDSerialize::visitXML(visitor, istr);
+            }
+            return LLSDParser::PARSE_FAILURE;
+        }
+
+        static S32 parse(LLSD& sd, const std::string& buffer, EFormat fmt)
+        {
+            std::istringstream istr(buffer);
+            switch (fmt)
+            {
+            case FORMAT_BINARY:   return LLSDSerialize::fromBinary(sd, istr, buffer.size());
+            case FORMAT_NOTATION: return LLSDSerialize::fromNotation(sd, istr, buffer.size());
+            case FORMAT_XML:      return LLSDSerialize::fromXML(sd, istr);
+            }
+            return LLSDParser::PARSE_FAILURE;
+        }
+
+        static LLSD sample()
+        {
+            LLSD sd;
+            sd["integer"] = 42;
+            sd["real"] = 2.5;
+            sd["string"] = "hello \"quoted\" world";
+            sd["uuid"] = LLUUID("c96f9b1e-f589-4100-9774-d98643ce0bed");
+            sd["date"] = LLDate(12345.0);
+            sd["uri"] = LLURI("http://www.secondlife.com/");
+            sd["binary"] = string_to_vector("\x01\x02\x03 binary");
+            sd["true"] = true;
+            sd["false"] = false;
+            sd["undef"] = LLSD();
+            sd["array"].append(1);
+            sd["array"].append("two");
+            sd["array"].append(LLSD::emptyMap());
+            sd["array"].append(LLSD::emptyArray());
+            sd["nested"]["map"]["deep"] = "value";
+            return sd;
+        }
+
+        // Build an inventory-fetch-like reply with many items
+        static LLSD inventory(S32 count)
+        {
+            LLSD sd;
+            sd["agent_id"] = LLUUID::generateNewID();
+            LLSD& items = sd["items"];
+            for (S32 i = 0; i < count; ++i)
+            {
+                LLSD item;
+                item["item_id"] = LLUUID::generateNewID();
+                item["parent_id"] = LLUUID::generateNewID();
+                item["asset_id"] = LLUUID::generateNewID();
+                item["name"] = llformat("Inventory item number %d", i);
+                item["desc"] = "A moderately long description of the item";
+                item["type"] = i % 20;
+                item["inv_type"] = i % 24;
+                item["flags"] = 0;
+                item["created_at"] = 1700000000 + i;
+                item["permissions"]["owner_mask"] = 0x7fffffff;
+                item["permissions"]["group_mask"] = 0;
+                item["permissions"]["everyone_mask"] = 0;
+                item["permissions"]["next_owner_mask"] = 0x82000;
+                item["permissions"]["creator_id"] = LLUUID::generateNewID();
+                item["sale_info"]["sale_type"] = 0;
+                item["sale_info"]["sale_price"] = 10;
+                items.append(item);
+            }
+            return sd;
+        }
+    };
+
+    // Visitor which keeps only the item ids of an inventory reply
+    class ItemIdCollector : public LLSDParseVisitor
+    {
+    public:
+        ItemIdCollector() : mDepth(0), mWantId(false) {}
+
+        bool beginMap(S32) override     { ++mDepth; return true; }
+        bool endMap() override          { --mDepth; return true; }
+        bool beginArray(S32) override   { ++mDepth; return true; }
+        bool endArray() override        { --mDepth; return true; }
+        bool mapKey(const std::string& key) override
+        {
+            // top map -> items array -> item map
+            mWantId = (mDepth == 3 && key == "item_id");
+            return true;
+        }
+        bool value(const LLSD& value) override
+        {
+            if (mWantId)
+            {
+                mIds.push_back(value.asUUID());
+                mWantId = false;
+            }
+            return true;
+        }
+
+        S32 mDepth;
+        bool mWantId;
+        std::vector<LLUUID> mIds;
+    };
+
+    // Visitor which gives up at the first string
+    class StopAtString : public LLSDParseVisitor
+    {
+    public:
+        bool value(const LLSD& value) override { return !value.isString(); }
+    };
+
+    typedef tut::test_group<TestLLSDVisitor> TestLLSDVisitorGroup;
+    typedef TestLLSDVisitorGroup::object TestLLSDVisitorObject;
+    TestLLSDVisitorGroup gTestLLSDVisitorGroup("llsd serialize visitor");
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<1>()
+    {
+        set_test_name("visitor rebuilds the same tree for every format");
+        LLSD expected(sample());
+        for (EFormat fmt : { FORMAT_BINARY, FORMAT_NOTATION, FORMAT_XML })
+        {
+            std::string buffer(format(expected, fmt));
+            LLSD parsed;
+            S32 tree_count = parse(parsed, buffer, fmt);
+
+            LLSDTreeBuilder builder;
+            S32 visit_count = visit(builder, buffer, fmt);
+            std::string msg(stringize("format ", fmt));
+            ensure_equals(msg + " count", visit_count, tree_count);
+            ensure(msg + " complete", builder.complete());
+            ensure_equals(msg + " result", builder.result(), expected);
+        }
+    }
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<2>()
+    {
+        set_test_name("visitor can stop the parse");
+        LLSD sd(sample());
+        for (EFormat fmt : { FORMAT_BINARY, FORMAT_NOTATION, FORMAT_XML })
+        {
+            StopAtString stopper;
+            ensure_equals(stringize("format ", fmt),
+                          visit(stopper, format(sd, fmt), fmt),
+                          S32(LLSDParser::PARSE_FAILURE));
+        }
+    }
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<3>()
+    {
+        set_test_name("visitor rejects malformed input");
+        LLSDTreeBuilder builder;
+        ensure_equals("notation", visit(builder, "{'a':i1,'b':", FORMAT_NOTATION),
+                      S32(LLSDParser::PARSE_FAILURE));
+        std::string binary(format(sample(), FORMAT_BINARY));
+        binary.resize(binary.size() / 2);
+        ensure_equals("binary", visit(builder, binary, FORMAT_BINARY),
+                      S32(LLSDParser::PARSE_FAILURE));
+    }
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<4>()
+    {
+        set_test_name("binary cursor walks and skips");
+        LLSD sd;
+        sd["skipme"] = sample();
+        sd["version"] = 3;
+        sd["lods"].append(10);
+        sd["lods"].append(20);
+        std::string buffer(format(sd, FORMAT_BINARY));
+        LLSDBinaryCursor cursor((const U8*)buffer.data(), buffer.size());
+
+        ensure_equals("begin", cursor.next(), LLSDBinaryCursor::TOKEN_MAP_BEGIN);
+        ensure_equals("size", cursor.size(), 3);
+        S32 version = 0;
+        std::vector<S32> lods;
+        while (cursor.next() == LLSDBinaryCursor::TOKEN_KEY)
+        {
+            if (cursor.key() == "version")
+            {
+                ensure_equals("version value", cursor.next(), LLSDBinaryCursor::TOKEN_VALUE);
+                version = cursor.value().asInteger();
+            }
+            else if (cursor.key() == "lods")
+            {
+                ensure_equals("lods", cursor.next(), LLSDBinaryCursor::TOKEN_ARRAY_BEGIN);
+                while (cursor.next() == LLSDBinaryCursor::TOKEN_VALUE)
+                {
+                    lods.push_back(cursor.value().asInteger());
+                }
+                ensure_equals("lods end", cursor.token(), LLSDBinaryCursor::TOKEN_ARRAY_END);
+            }
+            else
+            {
+                ensure("skip", cursor.skip());
+            }
+        }
+        ensure_equals("map end", cursor.token(), LLSDBinaryCursor::TOKEN_MAP_END);
+        ensure_equals("end", cursor.next(), LLSDBinaryCursor::TOKEN_END);
+        ensure_equals("version", version, 3);
+        ensure_equals("lod count", lods.size(), size_t(2));
+        ensure_equals("lod 1", lods[1], 20);
+        ensure_equals("offset", cursor.offset(), buffer.size());
+    }
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<5>()
+    {
+        set_test_name("binary cursor values and errors");
+        LLSD expected(sample());
+        std::string buffer(format(expected, FORMAT_BINARY));
+
+        // Rebuild the tree from cursor tokens
+        LLSDBinaryCursor cursor((const U8*)buffer.data(), buffer.size());
+        LLSDTreeBuilder builder;
+        for (LLSDBinaryCursor::EToken token = cursor.next();
+             token != LLSDBinaryCursor::TOKEN_END; token = cursor.next())
+        {
+            ensure("no error", token != LLSDBinaryCursor::TOKEN_ERROR);
+            switch (token)
+            {
+            case LLSDBinaryCursor::TOKEN_MAP_BEGIN:   builder.beginMap(cursor.size());   break;
+            case LLSDBinaryCursor::TOKEN_MAP_END:     builder.endMap();                  break;
+            case LLSDBinaryCursor::TOKEN_ARRAY_BEGIN: builder.beginArray(cursor.size()); break;
+            case LLSDBinaryCursor::TOKEN_ARRAY_END:   builder.endArray();                break;
+            case LLSDBinaryCursor::TOKEN_KEY:         builder.mapKey(cursor.key());      break;
+            default:                                  builder.value(cursor.value());     break;
+            }
+        }
+        ensure_equals("rebuilt", builder.result(), expected);
+
+        // Truncation anywhere must end in an error, never a crash
+        for (size_t len = 0; len < buffer.size(); ++len)
+        {
+            LLSDBinaryCursor truncated((const U8*)buffer.data(), len);
+            LLSDBinaryCursor::EToken token;
+            do
+            {
+                token = truncated.next();
+            } while (token != LLSDBinaryCursor::TOKEN_END && token != LLSDBinaryCursor::TOKEN_ERROR);
+            ensure_equals(stringize("truncated at ", len), token, LLSDBinaryCursor::TOKEN_ERROR);
+        }
+
+        // Depth limit matches LLSDBinaryParser
+        LLSDBinaryCursor shallow((const U8*)buffer.data(), buffer.size(), 1);
+        ensure_equals("depth begin", shallow.next(), LLSDBinaryCursor::TOKEN_MAP_BEGIN);
+        ensure_equals("depth key", shallow.next(), LLSDBinaryCursor::TOKEN_KEY);
+        ensure_equals("depth value", shallow.next(), LLSDBinaryCursor::TOKEN_ERROR);
+    }
+
+    template<> template<>
+    void TestLLSDVisitorObject::test<6>()
+    {
+        set_test_name("tree vs visitor parse benchmark");
+        // Not a pass/fail test: reports the cost per parsed MB of building
+        // the whole tree vs. picking one field per element with a visitor.
+        const S32 ITEMS = 2000;
+        LLSD sd(inventory(ITEMS));
+        const char* names[] = { "binary", "notation", "xml" };
+        for (EFormat fmt : { FORMAT_BINARY, FORMAT_NOTATION, FORMAT_XML })
+        {
+            std::string buffer(format(sd, fmt));
+            F64 mb = F64(buffer.size()) / (1024.0 * 1024.0);
+
+            U32 impls_before = llsd::outstandingCount();
+            LLTimer timer;
+            LLSD parsed;
+            parse(parsed, buffer, fmt);
+            F64 tree_secs = timer.getElapsedTimeF64();
+            U32 tree_impls = llsd::outstandingCount() - impls_before;
+
+            ItemIdCollector collector;
+            impls_before = llsd::outstandingCount();
+            timer.reset();
+            S32 count = visit(collector, buffer, fmt);
+            F64 visit_secs = timer.getElapsedTimeF64();
+            U32 visit_impls = llsd::outstandingCount() - impls_before;
+
+            ensure("visited", count > 0);
+            ensure_equals(stringize(names[fmt], " ids"), collector.mIds.size(), size_t(ITEMS));
+            ensure_equals(stringize(names[fmt], " first id"), collector.mIds[0], sd["items"][0]["item_id"].asUUID());
+
+            std::cout << "\n" << names[fmt] << ": " << buffer.size() << " bytes, tree "
+                      << (tree_secs * 1000.0 / mb) << " ms/MB holding " << tree_impls
+                      << " LLSD nodes, visitor " << (visit_secs * 1000.0 / mb)
+                      << " ms/MB holding " << visit_impls << " LLSD nodes" << std::endl;
+        }
+    }
+}
+
+namespace tut
+{
+    /**
+     * @class TestLLSDFastParse
+     * @brief In-memory fast path parsers checked against the stream parsers
+     */
+    struct TestLLSDFastParse
+    {
+        enum EFormat { FORMAT_XML, FORMAT_NOTATION };
+
+        // Stricter than llsd_equals(): types must match and reals must
+        // have identical bit patterns.
+        static bool same(const LLSD& lhs, const LLSD& rhs)
+        {
+            if (lhs.type() != rhs.type())
+            {
+                return false;
+            }
+            switch (lhs.type())
+            {
+            case LLSD::TypeMap:
+                if (lhs.size() != rhs.size())
+                {
+                    return false;
+                }
+                for (LLSD::map_const_iterator it = lhs.beginMap(); it != lhs.endMap(); ++it)
+                {
+                    if (!rhs.has(it->first) || !same(it->second, rhs[it->first]))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            case LLSD::TypeArray:
+                if (lhs.size() != rhs.size())
+                {
+                    return false;
+                }
+                for (S32 i = 0; i < lhs.size(); ++i)
+                {
+                    if (!same(lhs[i], rhs[i]))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            case LLSD::TypeReal:
+            {
+                F64 a = lhs.asReal(), b = rhs.asReal();
+                return !memcmp(&a, &b, sizeof(F64));
+            }
+            default:
+                return llsd_equals(lhs, rhs);
+            }
+        }
+
+        static S32 streamParse(LLSD& sd, const std::string& buffer, EFormat fmt)
+        {
+            std::istringstream istr(buffer);
+            if (fmt == FORMAT_XML)
+            {
+                return LLSDSerialize::fromXML(sd, istr, false);
+            }
+            return LLSDSerialize::fromNotation(sd, istr, buffer.size());
+        }
+
+        static S32 bufferParse(LLSD& sd, const std::string& buffer, EFormat fmt)
+        {
+            if (fmt == FORMAT_XML)
+            {
+                return LLSDSerialize::fromXMLBuffer(sd, buffer.data(), buffer.size(), false);
+            }
+            return LLSDSerialize::fromNotationBuffer(sd, buffer.data(), buffer.size(), buffer.size());
+        }
+
+        static bool fastAccepts(const std::string& buffer, EFormat fmt)
+        {
+            LLSD sd;
+            S32 count = (fmt == FORMAT_XML)
+                ? LLSDFastParse::parseXML(sd, buffer.data(), buffer.size())
+                : LLSDFastParse::parseNotation(sd, buffer.data(), buffer.size());
+            return count != LLSDFastParse::FALLBACK;
+        }
+
+        // Both entry points must agree on the return value and the data.
+        static void check(const std::string& msg, const std::string& buffer, EFormat fmt)
+        {
+            LLSD expected, actual;
+            S32 expected_count = streamParse(expected, buffer, fmt);
+            S32 actual_count = bufferParse(actual, buffer, fmt);
+            ensure_equals(msg + " count", actual_count, expected_count);
+            if (expected_count > 0)
+            {
+                ensure(msg + " data", same(actual, expected));
+            }
+        }
+
+        // Checks and also requires the fast path to have handled it.
+        static void checkFast(const std::string& msg, const std::string& buffer, EFormat fmt)
+        {
+            ensure(msg + " took the fast path", fastAccepts(buffer, fmt));
+            check(msg, buffer, fmt);
+        }
+
+        static std::string randomString(std::mt19937& rng)
+        {
+            static const char* const PIECES[] =
+            {
+                "plain", " ", "&", "<", ">", "\"", "'", "\\", "\n", "\r\n", "\t",
+                "]]>", "caf\xC3\xA9", "\xF0\x9D\x84\x9E", "{", "}", "[", "]", ":",
+                ",", "0123456789abcdef0123456789abcdef"
+            };
+            std::string str;
+            S32 count = rng() % 6;
+            for (S32 i = 0; i < count; ++i)
+            {
+                str += PIECES[rng() % LL_ARRAY_SIZE(PIECES)];
+            }
+            return str;
+        }
+
+        static F64 randomReal(std::mt19937& rng)
+        {
+            switch (rng() % 6)
+            {
+            case 0:  return F64(S32(rng() % 2001) - 1000);
+            case 1:  return F64(S32(rng() % 200001) - 100000) / 1000.0;
+            case 2:  return std::ldexp(F64(rng()), S32(rng() % 200) - 100);
+            case 3:  return 1.0 / F64(rng() % 1000 + 1);
+            case 4:  return -0.0;
+            default: return std::ldexp(F64(rng()) * F64(rng()), S32(rng() % 1200) - 600);
+            }
+        }
+
+        static LLSD randomLLSD(std::mt19937& rng, S32 depth)
+        {
+            S32 kind = rng() % ((depth > 4) ? 10 : 13);
+            switch (kind)
+            {
+            case 0:  return LLSD();
+            case 1:  return LLSD(bool(rng() & 1));
+            case 2:  return LLSD(S32(rng()));
+            case 3:  return LLSD(randomReal(rng));
+            case 4:
+            case 5:  return LLSD(randomString(rng));
+            case 6:  return LLSD(LLUUID::generateNewID());
+            case 7:  return LLSD(LLDate(F64(rng() % 2000000000)));
+            case 8:  return LLSD(LLURI("http://example.com/" + LLURI::escape(randomString(rng))));
+            case 9:
+            {
+                std::vector<U8> bin(rng() % 64);
+                for (U8& b : bin)
+                {
+                    b = U8(rng());
+                }
+                return LLSD(bin);
+            }
+            case 10:
+            case 11:
+            {
+                LLSD map = LLSD::emptyMap();
+                S32 count = rng() % 6;
+                for (S32 i = 0; i < count; ++i)
+                {
+                    map[llformat("key%d", i) + randomString(rng)] = randomLLSD(rng, depth + 1);
+                }
+                return map;
+            }
+            default:
+            {
+                LLSD array = LLSD::emptyArray();
+                S32 count = rng() % 6;
+                for (S32 i = 0; i < count; ++i)
+                {
+                    array.append(randomLLSD(rng, depth + 1));
+                }
+                return array;
+            }
+            }
+        }
+
+        static std::string mutate(const std::string& buffer, std::mt19937& rng)
+        {
+            static const char* const INSERTS[] =
+            {
+                "&amp;", "&#x41;", "&#0;", "&bogus;", "<!-- note -->", "<![CDATA[x<y]]>",
+                "\r\n", "\r", "]]>", "\xC3\xA9", "\xFF", "\x01", "<", ">", "</map>",
+                "<key>k</key>", "<undef />", "s(3)\"abc\"", "i", "r1e", "'", "\"", "\\",
+                "{", "}", "[", "]", ",", ":", "<?xml version=\"1.0\"?>", "\xEF\xBB\xBF",
+                "b64\"", "b16\"4", "u", "t", "FALSE", "<llsd>"
+            };
+            std::string out(buffer);
+            if (out.empty())
+            {
+                return out;
+            }
+            size_t pos = rng() % out.size();
+            switch (rng() % 4)
+            {
+            case 0:
+                out[pos] = char(rng());
+                break;
+            case 1:
+                out.erase(pos, 1 + rng() % 8);
+                break;
+            case 2:
+                out.resize(pos);
+                break;
+            default:
+                out.insert(pos, INSERTS[rng() % LL_ARRAY_SIZE(INSERTS)]);
+                break;
+            }
+            return out;
+        }
+
+        static std::string format(const LLSD& sd, EFormat fmt, S32 style)
+        {
+            std::ostringstream ostr;
+            if (fmt == FORMAT_XML)
+            {
+                if (style & 1)
+                {
+                    LLSDSerialize::toPrettyXML(sd, ostr);
+                }
+                else
+                {
+                    LLSDSerialize::toXML(sd, ostr);
+                }
+            }
+            else
+            {
+                switch (style % 3)
+                {
+                case 0:  LLSDSerialize::toNotation(sd, ostr);             break;
+                case 1:  LLSDSerialize::toPrettyNotation(sd, ostr);       break;
+                default: LLSDSerialize::toPrettyBinaryNotation(sd, ostr); break;
+                }
+            }
+            return ostr.str();
+        }
+    };
+
+    typedef tut::test_group<TestLLSDFastParse> TestLLSDFastParseGroup;
+    typedef TestLLSDFastParseGroup::object TestLLSDFastParseObject;
+    TestLLSDFastParseGroup gTestLLSDFastParseGroup("llsd serialize fast path");
+
+    template<> template<>
+    void TestLLSDFastParseObject::test<1>()
+    {
+        set_test_name("xml constructs on the fast path");
+        checkFast("empty llsd", "<llsd/>", FORMAT_XML);
+        checkFast("declaration", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<llsd><integer>1</integer></llsd>", FORMAT_XML);
+        checkFast("bom", "\xEF\xBB\xBF<llsd><string>x</string></llsd>", FORMAT_XML);
+        checkFast("entities", "<llsd><string>a &lt;b&gt; &amp; &quot;c&apos; &#65;&#x263A;</string></llsd>", FORMAT_XML);
+        checkFast("cdata", "<llsd><string>a<![CDATA[<b>&amp;]]>c</string></llsd>", FORMAT_XML);
+        checkFast("comments", "<!-- c --><llsd><!-- c --><map><!-- c --><key>a</key><!-- c --><real>1.5</real></map></llsd>", FORMAT_XML);
+        checkFast("crlf", "<llsd><string>a\r\nb\rc</string></llsd>", FORMAT_XML);
+        checkFast("utf8", "<llsd><string>caf\xC3\xA9 \xF0\x9D\x84\x9E</string></llsd>", FORMAT_XML);
+        checkFast("empty elements", "<llsd><array><undef/><string /><integer/><real/><uuid/><binary/><map/><array/></array></llsd>", FORMAT_XML);
+        checkFast("numbers", "<llsd><array><integer>-2147483648</integer><integer> 7</integer><integer>1.9</integer>"
+                  "<real>-0</real><real>1e22</real><real>1.7976931348623157e308</real><real>.5</real><real>5.</real>"
+                  "<real>0.1</real><real>123456789012345678</real><real>1.5 </real><real>abc</real></array></llsd>", FORMAT_XML);
+        checkFast("booleans", "<llsd><array><boolean>true</boolean><boolean>1</boolean><boolean>TRUE</boolean><boolean/></array></llsd>", FORMAT_XML);
+        checkFast("base64", "<llsd><binary encoding=\"base64\">\n  aGVs\n  bG8=\n</binary></llsd>", FORMAT_XML);
+        checkFast("duplicate key", "<llsd><map><key>a</key><integer>1</integer><key>a</key><map><key>b</key><integer>2</integer></map></map></llsd>", FORMAT_XML);
+        checkFast("trailing garbage", "<llsd><integer>1</integer></llsd><<<garbage", FORMAT_XML);
+
+        // left to the stream parser, which must still give the same answer
+        check("doctype", "<!DOCTYPE llsd><llsd><integer>1</integer></llsd>", FORMAT_XML);
+        check("unknown element", "<llsd><array><foo>1</foo><integer>2</integer></array></llsd>", FORMAT_XML);
+        check("value without key", "<llsd><map><integer>1</integer><key>a</key><integer>2</integer></map></llsd>", FORMAT_XML);
+        check("other encoding", "<llsd><binary encoding=\"base16\">00</binary></llsd>", FORMAT_XML);
+        check("two values", "<llsd><integer>1</integer><integer>2</integer></llsd>", FORMAT_XML);
+        check("mismatched", "<llsd><map></array></llsd>", FORMAT_XML);
+        check("bad entity", "<llsd><string>&nbsp;</string></llsd>", FORMAT_XML);
+        check("bad utf8", "<llsd><string>\xC0\x80</string></llsd>", FORMAT_XML);
+        check("control", "<llsd><string>\x01</string></llsd>", FORMAT_XML);
+        check("unterminated", "<llsd><map><key>a</key>", FORMAT_XML);
+        check("not llsd", "<root><llsd><integer>1</integer></llsd></root>", FORMAT_XML);
+        check("empty", "", FORMAT_XML);
+    }
+
+    template<> template<>
+    void TestLLSDFastParseObject::test<2>()
+    {
+        set_test_name("notation constructs on the fast path");
+        checkFast("scalars", "[!, 0, 1, t, f, true, FALSE, i-42, r1.25e-3, r-0, "
+                  "u6cdb85a7-98e0-42c2-8c6e-5e27f58c59c1, d\"2024-01-02T03:04:05Z\", "
+                  "l\"http://example.com/\"]", FORMAT_NOTATION);
+        checkFast("strings", "['single', \"double\", 'esc\\'\\n\\t\\x41\\\\', s(5)\"a'b\"c\", s(0)'']", FORMAT_NOTATION);
+        checkFast("binary", "[b64\"aGVsbG8=\", b16\"48656C6C6F\", b(5)\"hello\", b16\"\"]", FORMAT_NOTATION);
+        checkFast("maps", "{'a':i1,\"b\" : [], s(1)\"c\":{}}", FORMAT_NOTATION);
+        checkFast("first key wins", "{'a':i1,'a':i2}", FORMAT_NOTATION);
+        checkFast("empty raw key", "{'a':i1,s(0)\"\":i2}", FORMAT_NOTATION);
+        checkFast("no separators", "{'a'i1'b'i2}[i1i2]", FORMAT_NOTATION);
+        checkFast("large real", "r123456789012345678901234567890", FORMAT_NOTATION);
+
+        check("spaced integer", "i 5", FORMAT_NOTATION);
+        check("integer overflow", "i2147483648", FORMAT_NOTATION);
+        check("bad boolean", "[fals]", FORMAT_NOTATION);
+        check("octal raw length", "s(010)\"abcdefgh\"", FORMAT_NOTATION);
+        check("junk in map", "{x'a':i1}", FORMAT_NOTATION);
+        check("unterminated", "{'a':[i1,", FORMAT_NOTATION);
+        check("odd b16", "b16\"123\"", FORMAT_NOTATION);
+        check("backslash delimited uri", "l\\abc\\", FORMAT_NOTATION);
+        check("whitespace only", "   ", FORMAT_NOTATION);
+
+        // depth limit applies the same way
+        LLSD sd;
+        std::string deep("[[[[i1]]]]");
+        ensure_equals("deep fast", LLSDFastParse::parseNotation(sd, deep.data(), deep.size(), 5), 5);
+        ensure_equals("too deep fast", LLSDFastParse::parseNotation(sd, deep.data(), deep.size(), 4),
+                      S32(LLSDFastParse::FALLBACK));
+    }
+
+    template<> template<>
+    void TestLLSDFastParseObject::test<3>()
+    {
+        set_test_name("fuzz fast path against the stream parsers");
+        std::mt19937 rng(1234);
+        for (S32 doc = 0; doc < 300; ++doc)
+        {
+            LLSD sd(randomLLSD(rng, 0));
+            for (EFormat fmt : { FORMAT_XML, FORMAT_NOTATION })
+            {
+                std::string buffer(format(sd, fmt, doc));
+                std::string msg(stringize("doc ", doc, (fmt == FORMAT_XML) ? " xml" : " notation"));
+                // everything the formatters write stays on the fast path
+                checkFast(msg, buffer, fmt);
+                for (S32 i = 0; i < 20; ++i)
+                {
+                    check(stringize(msg, " mutation ", i), mutate(buffer, rng), fmt);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void TestLLSDFastParseObject::test<4>()
+    {
+        set_test_name("stream vs fast parse benchmark");
+        // Not a pass/fail test: reports the cost per parsed MB of the
+        // stream parser and the buffer entry point on the same document.
+        LLSD sd;
+        LLSD& items = sd["items"];
+        for (S32 i = 0; i < 2000; ++i)
+        {
+            LLSD item;
+            item["item_id"] = LLUUID::generateNewID();
+            item["name"] = llformat("Inventory item & number %d", i);
+            item["desc"] = "A moderately long description of the item, with <markup>";
+            item["type"] = i % 20;
+            item["scale"] = 0.25 * i;
+            item["created_at"] = LLDate(1700000000.0 + i);
+            item["thumbnail"] = string_to_vector(llformat("thumbnail data %d", i));
+            items.append(item);
+        }
+
+        for (EFormat fmt : { FORMAT_XML, FORMAT_NOTATION })
+        {
+            std::string buffer(format(sd, fmt, 1));
+            F64 mb = F64(buffer.size()) / (1024.0 * 1024.0);
+            ensure("benchmark document on the fast path", fastAccepts(buffer, fmt));
+
+            LLSD stream_sd, buffer_sd;
+            LLTimer timer;
+            streamParse(stream_sd, buffer, fmt);
+            F64 stream_secs = timer.getElapsedTimeF64();
+            timer.reset();
+            bufferParse(buffer_sd, buffer, fmt);
+            F64 buffer_secs = timer.getElapsedTimeF64();
+            ensure("benchmark results match", same(stream_sd, buffer_sd));
+
+            std::cout << "\n" << ((fmt == FORMAT_XML) ? "xml" : "notation") << ": "
+                      << buffer.size() << " bytes, stream " << (stream_secs * 1000.0 / mb)
+                      << " ms/MB, buffer " << (buffer_secs * 1000.0 / mb) << " ms/MB" << std::endl;
+        }
+    }
 }
@@ -0,0 +1,217 @@
+/**
+ * @file   llsymbol_test.cpp
+ * @date   2026-10-19
+ * @brief  Test for llsymbol.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llsymbol.h"
+// STL headers
+#include <map>
+#include <unordered_map>
+#include <vector>
+// std headers
+#include <chrono>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+namespace
+{
+    // milliseconds taken by 'work'
+    template <typename WORK>
+    F64 timeMs(WORK&& work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // names shaped like the viewer's: long shared prefixes, as in
+    // "RenderShadowResolutionScale" and "panel_preferences_graphics"
+    std::vector<std::string> makeNames(const std::string& prefix, size_t count)
+    {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < count; ++i)
+        {
+            names.push_back(stringize(prefix, "Setting", i % 7, "Name", i));
+        }
+        return names;
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llsymbol_data
+    {
+    };
+    typedef test_group<llsymbol_data> llsymbol_group;
+    typedef llsymbol_group::object object;
+    llsymbol_group llsymbolgrp("llsymbol");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("interning");
+        LLSymbol empty, alsoEmpty("");
+        ensure("default not empty", empty.empty());
+        ensure("empty strings differ", empty == alsoEmpty);
+        ensure_equals("empty str", empty.str(), "");
+
+        std::string name("llsymbol_test_name");
+        LLSymbol a(name), b(std::string_view("llsymbol_test_name"));
+        ensure("same string, different symbols", a == b);
+        ensure("same string, different hashes", a.hash() == b.hash());
+        ensure("different strings, same symbol", a != LLSymbol("llsymbol_test_other"));
+        ensure_equals("str", a.str(), name);
+        ensure_equals("c_str", std::string(a.c_str()), name);
+        ensure_equals("stream", stringize(a), name);
+        // one copy of the string, shared by every symbol for it
+        ensure("string copied", &a.str() == &b.str());
+
+        auto found = LLSymbol::find("llsymbol_test_name");
+        ensure("interned string not found", bool(found));
+        ensure("found a different symbol", *found == a);
+        const size_t size = LLSymbol::tableSize();
+        ensure("found a string nobody interned", ! LLSymbol::find("llsymbol_test_never_interned"));
+        ensure_equals("find() interned", LLSymbol::tableSize(), size);
+        ensure("empty string not found", bool(LLSymbol::find("")));
+
+        std::unordered_map<LLSymbol, int> map;
+        map[a] = 1;
+        ensure_equals("unordered_map", map[b], 1);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("interning from several threads");
+        const std::vector<std::string> names(makeNames("Threaded", 500));
+        std::vector<std::vector<LLSymbol>> results(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t)
+        {
+            threads.emplace_back([&names, &result = results[t], t]()
+                {
+                    // each thread goes through the names in its own order
+                    for (size_t i = 0; i < names.size(); ++i)
+                    {
+                        result.push_back(LLSymbol(names[(i * (t + 1)) % names.size()]));
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (size_t t = 1; t < results.size(); ++t)
+        {
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                const LLSymbol& symbol = results[t][i];
+                ensure_equals("wrong string", symbol.str(), names[(i * (t + 1)) % names.size()]);
+                ensure("threads disagree", symbol == LLSymbol(symbol.str()));
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("lookup cost: string vs symbol");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+
+        // settings: a few thousand names, looked up by literal every frame
+        const std::vector<std::string> settings(makeNames("Render", 3000));
+        std::map<std::string, int, std::less<>> byString;
+        std::unordered_map<LLSymbol, int> bySymbol;
+        std::vector<LLSymbol> symbols;
+        const F64 internMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < settings.size(); ++i)
+                {
+                    symbols.emplace_back(settings[i]);
+                }
+            });
+        for (size_t i = 0; i < settings.size(); ++i)
+        {
+            byString[settings[i]] = int(i);
+            bySymbol[symbols[i]] = int(i);
+        }
+        const size_t lookups = 200000;
+        size_t sum = 0;
+        const F64 stringMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < lookups; ++i)
+                {
+                    sum += byString.find(std::string_view(settings[(i * 7) % settings.size()]))->second;
+                }
+            });
+        const F64 findMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < lookups; ++i)
+                {
+                    sum += bySymbol.find(*LLSymbol::find(settings[(i * 7) % settings.size()]))->second;
+                }
+            });
+        const F64 symbolMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < lookups; ++i)
+                {
+                    sum += bySymbol.find(symbols[(i * 7) % symbols.size()])->second;
+                }
+            });
+        LL_INFOS() << "interning " << settings.size() << " names: " << internMs << " ms" << LL_ENDL;
+        LL_INFOS() << lookups << " settings lookups: std::map " << stringMs
+                   << " ms, LLSymbol::find() " << findMs
+                   << " ms, pre-interned LLSymbol " << symbolMs << " ms (" << sum << ")" << LL_ENDL;
+
+        // child views: a linear scan comparing names. View names are not
+        // interned, since some are user text; findChildView() hashes the
+        // wanted name once and compares hashes before strings.
+        const std::vector<std::string> children(makeNames("panel_child_", 200));
+        std::vector<size_t> childHashes;
+        for (const std::string& child : children)
+        {
+            childHashes.push_back(std::hash<std::string_view>()(child));
+        }
+        size_t index = 0;
+        const F64 scanStringMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < 20000; ++i)
+                {
+                    std::string_view wanted(children[(i * 13) % children.size()]);
+                    for (index = 0; index < children.size() && children[index] != wanted; ++index)
+                        ;
+                    sum += index;
+                }
+            });
+        const F64 scanHashMs = timeMs([&]()
+            {
+                for (size_t i = 0; i < 20000; ++i)
+                {
+                    std::string_view wanted(children[(i * 13) % children.size()]);
+                    const size_t hash = std::hash<std::string_view>()(wanted);
+                    for (index = 0;
+                         index < children.size() && (childHashes[index] != hash || children[index] != wanted);
+                         ++index)
+                        ;
+                    sum += index;
+                }
+            });
+        LL_INFOS() << "20000 child scans: std::string " << scanStringMs << " ms, hashed "
+                   << scanHashMs << " ms (" << sum << ")" << LL_ENDL;
+    }
+} // namespace tut
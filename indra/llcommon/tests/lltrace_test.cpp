@@ -30,8 +30,14 @@
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
 #include "lltracerecording.h"
+#include "lltimer.h"
 #include "../test/lltut.h"
 
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
 #ifdef LL_WINDOWS
 #pragma warning(disable : 4244) // possible loss of data on conversions
 #endif
@@ -143,4 +149,111 @@ namespace tut
                 && after_3pm.getMax(sCaffeineLevelStat) == sCaffeinePerOz * ((S32Ounces)S32TallCup(1) + (S32Ounces)S32GrandeCup(3) + (S32Ounces)S32VentiCup(1)).value());
     }
 
+    static CountStatHandle<S32> sOrdersServed("ordersserved", "Orders handed over the counter");
+    static EventStatHandle<S32Ounces> sOrderSize("ordersize", "Size of each order");
+
+    // Has 'baristas' threads each serve 'orders' orders, pushing their
+    // measurements to parent as worker threads do, while this thread pulls
+    // them.  Returns the wall clock nanoseconds per measurement, across all
+    // threads.
+    F64 serve_orders(ThreadRecorder& parent, Recording& recording, S32 baristas, S32 orders)
+    {
+        std::atomic<S32> finished(0);
+        std::atomic<bool> closing(false);
+        std::vector<std::thread> threads;
+        LLTimer timer;
+        for (S32 i = 0; i < baristas; ++i)
+        {
+            threads.emplace_back([&parent, &finished, &closing, orders]()
+            {
+                ThreadRecorder recorder(parent);
+                for (S32 order = 0; order < orders; ++order)
+                {
+                    add(sOrdersServed, 1);
+                    record(sOrderSize, S32Ounces(1 + order % 20));
+                    if ((order & 1023) == 0)
+                    {
+                        recorder.pushToParentIfDue();
+                    }
+                }
+                while (!recorder.pushToParent())
+                {
+                    std::this_thread::yield();
+                }
+                ++finished;
+                // stay registered until the parent has pulled everything
+                while (!closing)
+                {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        while (finished < baristas)
+        {
+            parent.pullFromChildren();
+            std::this_thread::yield();
+        }
+        parent.pullFromChildren();
+        F64 elapsed = timer.getElapsedTimeF64().value();
+        closing = true;
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        recording.stop();
+        // two measurements per order
+        return elapsed * 1e9 / (2.0 * baristas * orders);
+    }
+
+    // child thread measurements reach the parent without locks
+    template<> template<>
+    void trace_object_t::test<2>()
+    {
+        const S32 ORDERS = 200000;
+        const S32 BARISTAS[] = { 1, 16 };
+        for (S32 baristas : BARISTAS)
+        {
+            Recording shift;
+            shift.start();
+            F64 ns_per_sample = serve_orders(mRecorder, shift, baristas, ORDERS);
+            std::cout << baristas << " threads: " << ns_per_sample << " ns per sample" << std::endl;
+
+            ensure_equals("every order counted", (S32)shift.getSum(sOrdersServed), baristas * ORDERS);
+            ensure_equals("every order size recorded", (S32)shift.getSampleCount(sOrderSize), baristas * ORDERS);
+            ensure("smallest order", shift.getMin(sOrderSize) == S32Ounces(1));
+            ensure("largest order", shift.getMax(sOrderSize) == S32Ounces(20));
+        }
+    }
+
+    // a child thread outliving its parent recorder is detached from it
+    template<> template<>
+    void trace_object_t::test<3>()
+    {
+        std::promise<ThreadRecorder*> opened;
+        std::promise<void> hired, closed;
+        std::shared_future<void> closed_future(closed.get_future());
+        // recorders set up thread-local state, so each gets its own thread
+        std::thread barista([&]()
+        {
+            ThreadRecorder recorder(*opened.get_future().get());
+            hired.set_value();
+            closed_future.wait();
+            // still records, and pushes into its own slots only
+            add(sOrdersServed, 1);
+            recorder.pushToParent();
+            recorder.pushToParentIfDue();
+        });
+        std::thread shop([&]()
+        {
+            ThreadRecorder* recorder = new ThreadRecorder();
+            std::future<void> hired_future(hired.get_future());
+            opened.set_value(recorder);
+            hired_future.wait();
+            delete recorder;
+            closed.set_value();
+        });
+        shop.join();
+        // ~ThreadRecorder() on the barista thread did not touch the deleted parent
+        barista.join();
+    }
 }
@@ -0,0 +1,275 @@
+/**
+ * @file   lluuidhashmap_test.cpp
+ * @date   2026-10-19
+ * @brief  Test for lluuidhashmap.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lluuidhashmap.h"
+// STL headers
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// std headers
+#include <chrono>
+#include <cstring>
+// external library headers
+#include <boost/unordered_map.hpp>
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+namespace
+{
+    // sequential IDs, as a test or a local ID generator might make: the
+    // worst case for a hash that just took the low bytes
+    LLUUID sequential(U32 n)
+    {
+        LLUUID id;
+        memcpy(&id.mData[12], &n, sizeof(n));
+        return id;
+    }
+
+    std::vector<LLUUID> randomIDs(size_t count)
+    {
+        std::vector<LLUUID> ids(count);
+        for (auto& id : ids)
+        {
+            id.generate();
+        }
+        return ids;
+    }
+
+    // milliseconds taken by 'work'
+    template <typename WORK>
+    F64 timeMs(WORK&& work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // insert, lookup and iteration times for one map type
+    template <typename MAP>
+    std::string bench(const std::vector<LLUUID>& ids, const std::vector<LLUUID>& misses)
+    {
+        MAP map;
+        size_t found = 0;
+        U64 sum = 0;
+        const F64 insert = timeMs([&]()
+            {
+                for (size_t i = 0; i < ids.size(); ++i)
+                {
+                    map[ids[i]] = i;
+                }
+            });
+        const F64 hit = timeMs([&]()
+            {
+                for (int pass = 0; pass < 4; ++pass)
+                {
+                    for (const auto& id : ids)
+                    {
+                        auto it = map.find(id);
+                        found += (it != map.end());
+                    }
+                }
+            });
+        const F64 miss = timeMs([&]()
+            {
+                for (const auto& id : misses)
+                {
+                    found += map.count(id);
+                }
+            });
+        const F64 iterate = timeMs([&]()
+            {
+                for (int pass = 0; pass < 4; ++pass)
+                {
+                    for (const auto& entry : map)
+                    {
+                        sum += entry.second;
+                    }
+                }
+            });
+        return stringize("insert ", insert, " ms, hit ", hit, " ms, miss ", miss,
+                         " ms, iterate ", iterate, " ms (", found, ", ", sum, ")");
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct lluuidhashmap_data
+    {
+        typedef LLUUIDHashMap<std::string> Map;
+    };
+    typedef test_group<lluuidhashmap_data> lluuidhashmap_group;
+    typedef lluuidhashmap_group::object object;
+    lluuidhashmap_group lluuidhashmapgrp("lluuidhashmap");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("insert, find, erase");
+        Map map;
+        ensure("new map not empty", map.empty());
+        ensure("found in empty map", map.find(LLUUID::null) == map.end());
+        ensure_equals("erased from empty map", map.erase(LLUUID::null), 0);
+
+        const LLUUID a(sequential(1)), b(sequential(2));
+        ensure("insert a", map.try_emplace(a, "a").second);
+        ensure("reinserted a", ! map.try_emplace(a, "again").second);
+        map[b] = "b";
+        map[LLUUID::null] = "null";
+        ensure_equals("size", map.size(), 3);
+        ensure_equals("a", map.at(a), "a");
+        ensure_equals("b", map.find(b)->second, "b");
+        ensure_equals("null", map[LLUUID::null], "null");
+
+        map.insert_or_assign(a, "A");
+        ensure_equals("assigned a", map.at(a), "A");
+
+        ensure_equals("erase a", map.erase(a), 1);
+        ensure_equals("erase a again", map.erase(a), 0);
+        ensure("a still there", ! map.contains(a));
+        ensure_equals("b after erase", map.at(b), "b");
+        ensure_equals("size after erase", map.size(), 2);
+
+        bool threw = false;
+        try
+        {
+            map.at(a);
+        }
+        catch (const std::out_of_range&)
+        {
+            threw = true;
+        }
+        ensure("at() of missing key didn't throw", threw);
+
+        map.clear();
+        ensure("cleared map not empty", map.empty());
+        ensure("found after clear", map.find(b) == map.end());
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("growth, churn and iteration");
+        Map map;
+        std::map<LLUUID, std::string> reference;
+        // sequential and random keys, with repeated insert/erase rounds to
+        // leave tombstones behind
+        std::vector<LLUUID> ids(randomIDs(3000));
+        for (U32 i = 0; i < 3000; ++i)
+        {
+            ids.push_back(sequential(i));
+        }
+        for (int round = 0; round < 5; ++round)
+        {
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                if ((i + round) % 3)
+                {
+                    map[ids[i]] = stringize(round, ':', i);
+                    reference[ids[i]] = stringize(round, ':', i);
+                }
+                else
+                {
+                    ensure_equals(stringize("erase ", i), map.erase(ids[i]), reference.erase(ids[i]));
+                }
+            }
+            ensure_equals(stringize("size in round ", round), map.size(), reference.size());
+        }
+        // tombstones are reclaimed rather than growing forever
+        ensure("capacity out of hand", map.capacity() <= 4 * ids.size());
+
+        size_t visited = 0;
+        for (const auto& entry : map)
+        {
+            ++visited;
+            auto found = reference.find(entry.first);
+            ensure("iterated a stray entry", found != reference.end());
+            ensure_equals("iterated value", entry.second, found->second);
+        }
+        ensure_equals("visited", visited, reference.size());
+
+        // erase while iterating, as std::unordered_map allows
+        for (auto it = map.begin(); it != map.end(); )
+        {
+            if (it->first.mData[15] & 1)
+            {
+                reference.erase(it->first);
+                it = map.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        ensure_equals("size after erasing odd keys", map.size(), reference.size());
+        for (const auto& entry : reference)
+        {
+            ensure_equals("value after erasing odd keys", map.at(entry.first), entry.second);
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("copy, move and non-trivial values");
+        LLUUIDHashMap<std::shared_ptr<int>> map;
+        auto shared = std::make_shared<int>(17);
+        std::vector<LLUUID> ids(randomIDs(100));
+        for (const auto& id : ids)
+        {
+            map[id] = shared;
+        }
+        ensure_equals("use count", shared.use_count(), 101);
+        {
+            LLUUIDHashMap<std::shared_ptr<int>> copy(map);
+            ensure_equals("copy use count", shared.use_count(), 201);
+            ensure_equals("copy size", copy.size(), 100);
+            LLUUIDHashMap<std::shared_ptr<int>> moved(std::move(copy));
+            ensure_equals("moved use count", shared.use_count(), 201);
+            ensure("moved-from not empty", copy.empty());
+        }
+        ensure_equals("use count after copies", shared.use_count(), 101);
+        map.erase(ids[0]);
+        ensure_equals("use count after erase", shared.use_count(), 100);
+        map.clear();
+        ensure_equals("use count after clear", shared.use_count(), 1);
+
+        // const access
+        map[ids[1]] = shared;
+        const auto& cmap = map;
+        ensure("const find", cmap.find(ids[1]) != cmap.end());
+        ensure_equals("const at", *cmap.at(ids[1]), 17);
+        ensure_equals("const count", cmap.count(ids[2]), 0);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("lookup, insert and iteration vs node-based maps");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        for (size_t count : { 1000, 100000 })
+        {
+            const std::vector<LLUUID> ids(randomIDs(count)), misses(randomIDs(count));
+            LL_INFOS() << count << " std::map            " << bench<std::map<LLUUID, U64>>(ids, misses) << LL_ENDL;
+            LL_INFOS() << count << " std::unordered_map  " << bench<std::unordered_map<LLUUID, U64>>(ids, misses) << LL_ENDL;
+            LL_INFOS() << count << " boost::unordered_map " << bench<boost::unordered_map<LLUUID, U64>>(ids, misses) << LL_ENDL;
+            LL_INFOS() << count << " LLUUIDHashMap       " << bench<LLUUIDHashMap<U64>>(ids, misses) << LL_ENDL;
+        }
+    }
+} // namespace tut
@@ -0,0 +1,215 @@
+/**
+ * @file   parallel_test.cpp
+ * @date   2026-10-19
+ * @brief  Test for parallel.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "parallel.h"
+// STL headers
+// std headers
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "../test/catch_and_store_what_in.h"
+#include "llfasttimer.h"
+#include "stringize.h"
+#include "threadpool.h"
+
+using namespace LL;
+
+static LLTrace::BlockTimerStatHandle FTM_PARALLEL_TEST("Parallel test");
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct parallel_data
+    {
+        parallel_data()
+        {
+            pool.start();
+            options.mQueue = "parallel";
+        }
+
+        ThreadPool pool{ "parallel", 3 };
+        ParallelOptions options;
+    };
+    typedef test_group<parallel_data> parallel_group;
+    typedef parallel_group::object object;
+    parallel_group parallelgrp("parallel");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("parallelFor covers the range once");
+        const size_t count = 10007;
+        std::vector<int> hits(count, 0);
+        options.mTimer = &FTM_PARALLEL_TEST;
+        parallelFor(3, count, [&hits](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    ++hits[i];
+                }
+            }, options);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ensure_equals(stringize("index ", i), hits[i], i < 3? 0 : 1);
+        }
+
+        // empty range: body never called
+        bool called = false;
+        parallelFor(5, 5, [&called](size_t, size_t){ called = true; }, options);
+        ensure("called for empty range", ! called);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("parallelFor chunking");
+        options.mGrain = 100;
+        std::atomic<size_t> chunks{ 0 }, small{ 0 };
+        parallelFor(0, 1050, [&](size_t begin, size_t end)
+            {
+                ++chunks;
+                if (end - begin < 100)
+                {
+                    ++small;
+                }
+            }, options);
+        ensure_equals("chunks", chunks.load(), 11);
+        ensure_equals("only the last chunk is short", small.load(), 1);
+
+        // without a queue, the whole range runs at once on this thread
+        options.mQueue = "no such queue";
+        const std::thread::id self = std::this_thread::get_id();
+        std::vector<std::pair<size_t, size_t>> calls;
+        parallelFor(0, 1050, [&](size_t begin, size_t end)
+            {
+                ensure("ran on another thread", std::this_thread::get_id() == self);
+                calls.emplace_back(begin, end);
+            }, options);
+        ensure_equals("serial calls", calls.size(), 1);
+        ensure_equals("serial end", calls[0].second, 1050);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("parallelFor exception and nesting");
+        options.mGrain = 1;
+        std::string what = catch_what<std::runtime_error>([this]()
+            {
+                parallelFor(0, 64, [](size_t begin, size_t)
+                    {
+                        if (begin == 17)
+                        {
+                            throw std::runtime_error("chunk 17");
+                        }
+                    }, options);
+            });
+        ensure_equals("exception not propagated", what, "chunk 17");
+
+        // nested loops: the inner caller always helps itself, so this
+        // cannot starve even with every worker inside an outer chunk
+        std::atomic<size_t> total{ 0 };
+        parallelFor(0, 8, [this, &total](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    parallelFor(0, 100, [&total](size_t b, size_t e){ total += e - b; }, options);
+                }
+            }, options);
+        ensure_equals("nested total", total.load(), 800);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("TaskGraph respects dependencies");
+        options.mTimer = &FTM_PARALLEL_TEST;
+        TaskGraph graph(options);
+        std::atomic<int> stage[6];
+        for (auto& s : stage)
+        {
+            s = 0;
+        }
+        std::atomic<bool> ordered{ true };
+        auto check = [&](size_t me, std::initializer_list<size_t> deps)
+        {
+            return [&, me, deps = std::vector<size_t>(deps)]()
+            {
+                // each dependency has run once more than this task so far
+                for (size_t dep : deps)
+                {
+                    if (stage[dep].load() <= stage[me].load())
+                    {
+                        ordered = false;
+                    }
+                }
+                ++stage[me];
+            };
+        };
+        // 1 and 2 after 0, 4 after 1 and 2, 5 after 3 and 4
+        auto t0 = graph.add(check(0, {}));
+        auto t1 = graph.add(check(1, { 0 }), { t0 });
+        auto t2 = graph.add(check(2, { 0 }), { t0 });
+        auto t3 = graph.add(check(3, {}));
+        auto t4 = graph.add(check(4, { 1, 2 }), { t1, t2 });
+        graph.add(check(5, { 3, 4 }), { t3, t4 });
+        ensure_equals("size", graph.size(), 6);
+
+        graph.run();
+        ensure("dependency ran late", ordered.load());
+        for (size_t i = 0; i < 6; ++i)
+        {
+            ensure_equals(stringize("task ", i, " runs"), stage[i].load(), 1);
+        }
+
+        // a graph may be run again
+        graph.run();
+        ensure("dependency ran late on rerun", ordered.load());
+        for (size_t i = 0; i < 6; ++i)
+        {
+            ensure_equals(stringize("task ", i, " reruns"), stage[i].load(), 2);
+        }
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("TaskGraph exception");
+        TaskGraph graph(options);
+        std::atomic<bool> dependentRan{ false };
+        auto bad = graph.add([](){ throw std::runtime_error("bad task"); });
+        graph.add([&dependentRan](){ dependentRan = true; }, { bad });
+        std::string what = catch_what<std::runtime_error>([&graph](){ graph.run(); });
+        ensure_equals("exception not propagated", what, "bad task");
+        ensure("dependent of a failed task ran", ! dependentRan.load());
+
+        // wide graph without helpers runs entirely on this thread
+        ParallelOptions serial;
+        serial.mQueue = "no such queue";
+        TaskGraph wide(serial);
+        const std::thread::id self = std::this_thread::get_id();
+        std::atomic<size_t> ran{ 0 };
+        for (size_t i = 0; i < 20; ++i)
+        {
+            wide.add([&](){ if (std::this_thread::get_id() == self) ++ran; });
+        }
+        wide.run();
+        ensure_equals("serial graph", ran.load(), 20);
+    }
+} // namespace tut
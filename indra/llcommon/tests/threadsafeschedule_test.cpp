@@ -16,6 +16,7 @@
 // STL headers
 // std headers
 #include <chrono>
+#include <memory>
 // external library headers
 // other Linden headers
 #include "../test/lltut.h"
@@ -67,4 +68,25 @@ namespace tut
         ensure("queue not empty", ! popped);
         ensure("queue not done", queue.done());
     }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("move-only items");
+        using PtrQueue = LL::ThreadSafeSchedule<std::unique_ptr<int>>;
+        PtrQueue ptrs;
+        auto now{ PtrQueue::Clock::now() };
+        for (int i : { 3, 1, 4, 2, 5 })
+        {
+            ptrs.push(PtrQueue::TimeTuple(now + i * 1ms, std::make_unique<int>(i)));
+        }
+        ptrs.close();
+        for (int i = 1; i <= 5; ++i)
+        {
+            auto entry = ptrs.pop();
+            ensure("popped empty pointer", bool(std::get<0>(entry)));
+            ensure_equals("popped out of order", *std::get<0>(entry), i);
+        }
+        ensure("queue not done", ptrs.done());
+    }
 } // namespace tut
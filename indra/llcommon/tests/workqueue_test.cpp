@@ -15,22 +15,76 @@
 #include "workqueue.h"
 // STL headers
 // std headers
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <deque>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
 // external library headers
 // other Linden headers
 #include "../test/lltut.h"
 #include "../test/catch_and_store_what_in.h"
+#include "cpubudget.h"
 #include "llcond.h"
 #include "llcoros.h"
 #include "lleventcoro.h"
 #include "llstring.h"
 #include "stringize.h"
+#include "workstealingqueue.h"
 
 using namespace LL;
 using namespace std::literals::chrono_literals; // ms suffix
 using namespace std::literals::string_literals; // s suffix
 
+/*****************************************************************************
+*   Allocation counting
+*****************************************************************************/
+// Count heap allocations made by this thread while an AllocationCounter
+// exists. Skip it when llcommon already replaces operator new for Tracy.
+#if ! (TRACY_ENABLE && LL_PROFILER_ENABLE_TRACY_MEMORY)
+#define COUNT_ALLOCATIONS 1
+namespace
+{
+    thread_local bool sCountAllocations = false;
+    thread_local size_t sAllocations = 0;
+}
+
+void* operator new(size_t size)
+{
+    if (sCountAllocations)
+    {
+        ++sAllocations;
+    }
+    void* ptr = (malloc)(size ? size : 1);
+    if (! ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    (free)(ptr);
+}
+#endif
+
+struct AllocationCounter
+{
+#if COUNT_ALLOCATIONS
+    AllocationCounter()  { sAllocations = 0; sCountAllocations = true; }
+    ~AllocationCounter() { sCountAllocations = false; }
+    size_t get() const   { return sAllocations; }
+#else
+    size_t get() const   { return 0; }
+#endif
+};
+
 /*****************************************************************************
 *   TUT
 *****************************************************************************/
@@ -39,6 +93,91 @@ namespace tut
     struct workqueue_data
     {
         WorkSchedule queue{"queue"};
+
+        // Run 'workers' threads on 'wq' until it's closed
+        static std::vector<std::thread> startWorkers(WorkQueue& wq, size_t workers,
+                                                     CpuBudget* budget=nullptr)
+        {
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < workers; ++i)
+            {
+                threads.emplace_back([&wq, budget](){ wq.runUntilClose(budget); });
+            }
+            return threads;
+        }
+
+        static void join(std::vector<std::thread>& threads)
+        {
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Wait for a counter, polling, rather than closing the queue while
+        // workers may still be posting follow-on work
+        static bool waitFor(const std::atomic<size_t>& count, size_t expected)
+        {
+            auto until = std::chrono::steady_clock::now() + 30s;
+            while (count.load() < expected)
+            {
+                if (std::chrono::steady_clock::now() > until)
+                {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        struct BenchResult
+        {
+            F64 mItemsPerSecond;
+            F64 mMedianMicroseconds;
+            F64 mP99Microseconds;
+        };
+
+        // Post 'items' tiny work items to a fresh WorkQueue with the given
+        // backend and 'workers' threads. Half come from this thread, half as
+        // follow-on work posted by the items themselves, the way a decode
+        // posts its completion. Times each item from post to start.
+        static BenchResult bench(WorkQueue::Backend backend, size_t workers, size_t items)
+        {
+            using clock = std::chrono::steady_clock;
+            WorkQueue wq("bench", items + 1, backend);
+            std::vector<clock::time_point> posted(items);
+            std::vector<F64> latency(items);
+            std::atomic<size_t> ran{ 0 };
+            auto threads = startWorkers(wq, workers);
+
+            auto start = clock::now();
+            for (size_t i = 0; i < items; i += 2)
+            {
+                posted[i] = clock::now();
+                wq.post([&, i]()
+                {
+                    latency[i] = std::chrono::duration<F64, std::micro>(clock::now() - posted[i]).count();
+                    ++ran;
+                    const size_t child = i + 1;
+                    if (child < items)
+                    {
+                        posted[child] = clock::now();
+                        wq.post([&, child]()
+                        {
+                            latency[child] = std::chrono::duration<F64, std::micro>(clock::now() - posted[child]).count();
+                            ++ran;
+                        });
+                    }
+                });
+            }
+            ensure("benchmark items all ran", waitFor(ran, items));
+            const F64 seconds = std::chrono::duration<F64>(clock::now() - start).count();
+            wq.close();
+            join(threads);
+
+            std::sort(latency.begin(), latency.end());
+            return { items / llmax(seconds, 1e-9), latency[items / 2], latency[items * 99 / 100] };
+        }
     };
     typedef test_group<workqueue_data> workqueue_group;
     typedef workqueue_group::object object;
@@ -236,4 +375,266 @@ namespace tut
         ensure_equals("didn't run coroutine", stored, "ran");
         ensure("void waitForResult() didn't return", done);
     }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("stealing backend post");
+        WorkQueue stealing("stealing", 2, WorkQueue::STEALING);
+        ensure_equals("backend", stealing.getBackend(), WorkQueue::STEALING);
+        bool wasRun{ false };
+        ensure("post", stealing.post([&wasRun](){ wasRun = true; }));
+        ensure("tryPost", stealing.tryPost([](){}));
+        ensure_equals("size", stealing.size(), 2);
+        ensure("tryPost should respect capacity", ! stealing.tryPost([](){}));
+        stealing.close();
+        ensure("post after close", ! stealing.post([](){}));
+        ensure("ran too soon", ! wasRun);
+        ensure("done too soon", ! stealing.done());
+        stealing.runUntilClose();
+        ensure("didn't run", wasRun);
+        ensure("not drained", stealing.done());
+    }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("stealing backend with several workers");
+        WorkQueue stealing("stealing", 1024, WorkQueue::STEALING);
+        auto threads = startWorkers(stealing, 4);
+        const size_t items = 5000;
+        std::atomic<size_t> ran{ 0 };
+        for (size_t i = 0; i < items; ++i)
+        {
+            // alternate hinted posts with posts that fan out from a worker
+            if (i % 2)
+            {
+                stealing.post([&ran](){ ++ran; }, i);
+            }
+            else
+            {
+                stealing.post([&ran, &stealing]()
+                {
+                    stealing.post([&ran](){ ++ran; });
+                    ++ran;
+                });
+            }
+        }
+        ensure("not all items ran", waitFor(ran, items + items / 2));
+        stealing.close();
+        join(threads);
+        ensure("not drained", stealing.done());
+        ensure_equals("ran", ran.load(), items + items / 2);
+    }
+
+    template<> template<>
+    void object::test<9>()
+    {
+        set_test_name("CpuBudget shared between queues");
+        CpuBudget budget(2);
+        WorkQueue first("first", 1024, WorkQueue::STEALING);
+        WorkQueue second("second");
+        auto threads = startWorkers(first, 3, &budget);
+        auto more = startWorkers(second, 3, &budget);
+        threads.insert(threads.end(), std::make_move_iterator(more.begin()),
+                       std::make_move_iterator(more.end()));
+
+        std::atomic<size_t> running{ 0 }, most{ 0 }, ran{ 0 };
+        auto work = [&]()
+        {
+            const size_t now = ++running;
+            size_t prev = most.load();
+            while (now > prev && ! most.compare_exchange_weak(prev, now))
+                ;
+            std::this_thread::sleep_for(1ms);
+            --running;
+            ++ran;
+        };
+        for (size_t i = 0; i < 30; ++i)
+        {
+            first.post(work);
+            second.post(work);
+        }
+        ensure("not all items ran", waitFor(ran, 60));
+        first.close();
+        second.close();
+        join(threads);
+        ensure("budget exceeded", most.load() <= 2);
+        ensure_equals("tokens leaked", budget.getBusy(), 0);
+    }
+
+    template<> template<>
+    void object::test<10>()
+    {
+        set_test_name("backend throughput and latency");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        const size_t items = 100000;
+        for (size_t workers : { 2, 4, 8 })
+        {
+            for (auto backend : { WorkQueue::SHARED, WorkQueue::STEALING })
+            {
+                const BenchResult result = bench(backend, workers, items);
+                LL_INFOS() << (backend == WorkQueue::SHARED? "Shared  " : "Stealing") << ' '
+                           << workers << " workers: " << S64(result.mItemsPerSecond) << " items/s, latency median "
+                           << result.mMedianMicroseconds << " us, p99 " << result.mP99Microseconds << " us"
+                           << LL_ENDL;
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<11>()
+    {
+        set_test_name("SmallFunction");
+        using Function = SmallFunction<int(int)>;
+        Function empty;
+        ensure("empty", ! empty);
+        ensure_equals("null function pointer", bool(Function(static_cast<int(*)(int)>(nullptr))), false);
+        std::string what = catch_what<std::bad_function_call>([&empty](){ empty(1); });
+        ensure("calling empty didn't throw", ! what.empty());
+
+        // move-only capture, stored inline
+        Function doubler([ptr = std::make_unique<int>(2)](int x){ return x * *ptr; });
+        ensure("small capture not inline", doubler.isInline());
+        Function moved{ std::move(doubler) };
+        ensure("moved-from not empty", ! doubler);
+        ensure_equals("moved call", moved(21), 42);
+
+        // big capture goes to the heap, and moving just passes the pointer
+        std::array<char, 256> big;
+        big.fill('x');
+        Function counter([big](int x){ return x + int(std::count(big.begin(), big.end(), 'x')); });
+        ensure("big capture inline", ! counter.isInline());
+        Function other;
+        other = std::move(counter);
+        ensure_equals("heap call", other(1), 257);
+        other = nullptr;
+        ensure("reset", ! other);
+    }
+
+    template<> template<>
+    void object::test<12>()
+    {
+        set_test_name("posting small work does not allocate");
+        const size_t items = 1000;
+        size_t total = 0;
+        auto postAll = [&total, items](WorkQueue& wq)
+        {
+            for (size_t i = 0; i < items; ++i)
+            {
+                // typical capture: a couple of pointers and a value
+                wq.post([&total, i, &wq](){ total += i + (wq.isClosed()? 1 : 0); });
+            }
+            wq.runPending();
+        };
+
+        for (auto backend : { WorkQueue::SHARED, WorkQueue::STEALING })
+        {
+            WorkQueue wq("alloc", 1024 * 1024, backend);
+            // first round grows the queue's storage to its busiest depth
+            postAll(wq);
+            size_t allocations;
+            {
+                AllocationCounter counter;
+                postAll(wq);
+                allocations = counter.get();
+            }
+            ensure_equals(STRINGIZE("allocations posting to " << (backend == WorkQueue::SHARED? "shared" : "stealing")),
+                          allocations, 0);
+        }
+        ensure_equals("work ran", total, 4 * (items * (items - 1) / 2));
+
+        // postTo() wraps the callable and the reply in further lambdas,
+        // which fit inline too
+        WorkQueue origin("origin"), target("target");
+        int result = 0;
+        auto roundTrip = [&]()
+        {
+            origin.postTo(target.getWeak(), [](){ return 17; }, [&result](int r){ result += r; });
+            target.runPending();
+            origin.runPending();
+        };
+        roundTrip();
+        size_t allocations;
+        {
+            AllocationCounter counter;
+            for (size_t i = 0; i < 100; ++i)
+            {
+                roundTrip();
+            }
+            allocations = counter.get();
+        }
+        ensure_equals("postTo allocations", allocations, 0);
+        ensure_equals("postTo result", result, 17 * 101);
+
+#if COUNT_ALLOCATIONS
+        // and the counter does see a callable too big to store inline
+        {
+            std::array<char, 256> big{};
+            AllocationCounter counter;
+            WorkQueue::Work work([big](){ (void)big; });
+            ensure("counter missed a heap callable", counter.get() > 0);
+        }
+#endif
+    }
+
+    template<> template<>
+    void object::test<13>()
+    {
+        set_test_name("one thread consuming several stealing queues");
+        WorkStealingQueue<int> first, second;
+        for (int i = 0; i < 200; ++i)
+        {
+            // each pop() used to re-register the thread in the other queue
+            ensure("push first", first.tryPush(i));
+            ensure_equals("pop first", first.pop(), i);
+            ensure("push second", second.tryPush(i));
+            ensure_equals("pop second", second.pop(), i);
+        }
+        ensure_equals("first workers", first.getWorkerCount(), 1);
+        ensure_equals("second workers", second.getWorkerCount(), 1);
+        ensure_equals("first index", first.getWorkerIndex(), 0);
+        ensure_equals("second index", second.getWorkerIndex(), 0);
+
+        // a queue built where a destroyed one was starts with no consumers
+        std::unique_ptr<WorkStealingQueue<int>> queue(new WorkStealingQueue<int>);
+        queue->tryPush(1);
+        queue->pop();
+        queue.reset();
+        queue.reset(new WorkStealingQueue<int>);
+        ensure_equals("inherited registration", queue->getWorkerIndex(), WorkStealingQueue<int>::NO_HINT);
+
+        // an item posted from a thread that is not a consumer stays reachable
+        std::thread([&queue](){ queue->tryPush(2, 7); }).join();
+        int element = 0;
+        ensure("lost item", queue->tryPop(element));
+        ensure_equals("item", element, 2);
+    }
+
+    template<> template<>
+    void object::test<14>()
+    {
+        set_test_name("CpuBudget::Blocking gives back the token");
+        CpuBudget budget(1);
+        {
+            // does nothing without a token
+            CpuBudget::Blocking blocking;
+            ensure_equals("busy without a token", budget.getBusy(), 0);
+        }
+        CpuBudget::Token token(budget);
+        ensure_equals("token held", budget.getBusy(), 1);
+        {
+            CpuBudget::Blocking blocking;
+            ensure_equals("token given back", budget.getBusy(), 0);
+            std::atomic<bool> ran{ false };
+            std::thread([&budget, &ran]()
+            {
+                CpuBudget::Token other(budget);
+                ran = true;
+            }).join();
+            ensure("other work starved", ran.load());
+        }
+        ensure_equals("token taken again", budget.getBusy(), 1);
+    }
 } // namespace tut
@@ -18,9 +18,11 @@
 // external library headers
 // other Linden headers
 #include "commoncontrol.h"
+#include "cpubudget.h"
 #include "llerror.h"
 #include "llevents.h"
 #include "llsd.h"
+#include "lltracethreadrecorder.h"
 #include "stringize.h"
 
 #include <boost/fiber/algo/round_robin.hpp>
@@ -142,14 +144,25 @@ void LL::ThreadPoolBase::run(const std::string& name)
     boost::fibers::use_scheduling_algorithm<sleepy_robin>();
 #endif // LL_WINDOWS
 
+    // like LLThread, report LLTrace stats to the master thread recorder
+    std::unique_ptr<LLTrace::ThreadRecorder> recorder;
+    if (LLTrace::ThreadRecorder* master = LLTrace::get_master_thread_recorder())
+    {
+        recorder.reset(new LLTrace::ThreadRecorder(*master));
+    }
+
     LL_DEBUGS("ThreadPool") << name << " starting" << LL_ENDL;
     run();
     LL_DEBUGS("ThreadPool") << name << " stopping" << LL_ENDL;
+
+    // Recorders must be destroyed on their own thread. If the master was
+    // destroyed first, it detached this one and there is nothing to leave.
+    recorder.reset();
 }
 
 void LL::ThreadPoolBase::run()
 {
-    mQueue->runUntilClose();
+    mQueue->runUntilClose(mBudget);
 }
 
 //static
@@ -206,3 +219,62 @@ size_t LL::ThreadPoolBase::getWidth(const std::string& name, size_t dft)
         return getConfiguredWidth(name, dft);
     }
 }
+
+//static
+LL::WorkQueue::Backend LL::ThreadPoolBase::getConfiguredBackend(const std::string& name,
+                                                                WorkQueue::Backend dft)
+{
+    LLSD backends;
+    try
+    {
+        backends = LL::CommonControl::get("Global", "ThreadPoolBackends");
+    }
+    catch (const LL::CommonControl::Error& exc)
+    {
+        // as with ThreadPoolSizes, the setting is optional
+        LL_DEBUGS("ThreadPool") << "Can't check 'ThreadPoolBackends': " << exc.what() << LL_ENDL;
+    }
+
+    const std::string backend{ backends[name].asString() };
+    if (backend == "stealing")
+    {
+        return WorkQueue::STEALING;
+    }
+    if (backend == "shared")
+    {
+        return WorkQueue::SHARED;
+    }
+    if (! backend.empty())
+    {
+        LL_WARNS("ThreadPool") << "Unknown ThreadPoolBackends entry '" << backend
+                               << "' for ThreadPool '" << name << "'" << LL_ENDL;
+    }
+    return dft;
+}
+
+//static
+LL::CpuBudget& LL::ThreadPoolBase::getCpuBudget()
+{
+    static CpuBudget sBudget{ []()
+        {
+            LLSD width;
+            try
+            {
+                width = LL::CommonControl::get("Global", "ThreadPoolCpuBudget");
+            }
+            catch (const LL::CommonControl::Error& exc)
+            {
+                LL_DEBUGS("ThreadPool") << "Can't check 'ThreadPoolCpuBudget': " << exc.what() << LL_ENDL;
+            }
+
+            size_t budget = width.isInteger()? llmax(width.asInteger(), 0) : 0;
+            if (! budget)
+            {
+                const size_t cores = std::thread::hardware_concurrency();
+                budget = cores > 1? cores - 1 : 1;
+            }
+            LL_INFOS("ThreadPool") << "Worker CPU budget " << budget << LL_ENDL;
+            return budget;
+        }() };
+    return sBudget;
+}
@@ -18,6 +18,7 @@
 #include <memory>                   // std::unique_ptr
 #include <string>
 #include <thread>
+#include <type_traits>              // std::is_constructible_v
 #include <utility>                  // std::pair
 #include <vector>
 
@@ -57,6 +58,16 @@ namespace LL
          */
         virtual void close();
 
+        /**
+         * Call shareCpuBudget() before start() to have this ThreadPool's
+         * workers hold a token from the process-wide getCpuBudget() while
+         * running each work item. Pools that share the budget then never run
+         * more items at once, between them, than it allows. Leave out pools
+         * whose work must run promptly regardless, or that wait on work in
+         * other budgeted pools.
+         */
+        void shareCpuBudget() { mBudget = &getCpuBudget(); }
+
         std::string getName() const { return mName; }
         size_t getWidth() const { return mThreads.size(); }
 
@@ -85,6 +96,27 @@ namespace LL
         static
         size_t getWidth(const std::string& name, size_t dft);
 
+        /**
+         * getConfiguredBackend() returns the WorkQueue backend named for the
+         * specified ThreadPool in the "ThreadPoolBackends" LLSD map setting,
+         * "shared" or "stealing". Returns dft if there is no such entry.
+         */
+        static
+        WorkQueue::Backend getConfiguredBackend(const std::string& name,
+                                                WorkQueue::Backend dft=WorkQueue::SHARED);
+
+        /**
+         * getCpuBudget() returns the CpuBudget shared by every ThreadPool
+         * that calls shareCpuBudget(), and by other threads that decode or
+         * split work on their own (mesh decode, image decode threads), one
+         * token per running thread. Its width comes from the
+         * "ThreadPoolCpuBudget" setting, read on first use; 0 or no setting
+         * means one less than the number of hardware threads, leaving a core
+         * for the main thread.
+         */
+        static
+        CpuBudget& getCpuBudget();
+
     protected:
         std::unique_ptr<WorkQueueBase> mQueue;
         std::vector<std::pair<std::string, std::thread>> mThreads;
@@ -95,6 +127,7 @@ namespace LL
 
         std::string mName;
         size_t mThreadCount;
+        CpuBudget* mBudget{ nullptr };
     };
 
     /**
@@ -117,12 +150,15 @@ namespace LL
          * Pass an explicit capacity to limit the size of the queue.
          * Constraining the queue can cause a submitter to block. Do not
          * constrain any ThreadPool accepting work from the main thread.
+         *
+         * A queue_t that supports a choice of backend gets the one named for
+         * this ThreadPool in the "ThreadPoolBackends" setting.
          */
         ThreadPoolUsing(const std::string& name,
                         size_t threads=1,
                         size_t capacity=1024*1024,
                         bool auto_shutdown = true):
-            ThreadPoolBase(name, threads, new queue_t(name, capacity), auto_shutdown)
+            ThreadPoolBase(name, threads, makeQueue(name, capacity), auto_shutdown)
         {}
         ~ThreadPoolUsing() override {}
 
@@ -131,6 +167,19 @@ namespace LL
          * post work to it
          */
         queue_t& getQueue() { return static_cast<queue_t&>(*mQueue); }
+
+    private:
+        static queue_t* makeQueue(const std::string& name, size_t capacity)
+        {
+            if constexpr (std::is_constructible_v<queue_t, std::string, size_t, WorkQueue::Backend>)
+            {
+                return new queue_t(name, capacity, getConfiguredBackend(name));
+            }
+            else
+            {
+                return new queue_t(name, capacity);
+            }
+        }
     };
 
     /// ThreadPool is shorthand for using the simpler WorkQueue
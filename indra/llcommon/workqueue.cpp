@@ -17,10 +17,12 @@
 // std headers
 // external library headers
 // other Linden headers
+#include "cpubudget.h"
 #include "llcoros.h"
 #include LLCOROS_MUTEX_HEADER
 #include "llerror.h"
 #include "llexception.h"
+#include "lltracethreadrecorder.h"
 #include "stringize.h"
 
 using Mutex = LLCoros::Mutex;
@@ -36,14 +38,30 @@ LL::WorkQueueBase::WorkQueueBase(const std::string& name):
     // viewer shutdown.
 }
 
-void LL::WorkQueueBase::runUntilClose()
+void LL::WorkQueueBase::runUntilClose(CpuBudget* budget)
 {
     try
     {
+        // worker threads hand their LLTrace measurements to the main thread
+        // between work items
+        LLTrace::ThreadRecorder* recorder = LLTrace::get_thread_recorder();
         for (;;)
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
-            callWork(pop_());
+            Work work{ pop_() };
+            if (budget)
+            {
+                CpuBudget::Token token(*budget);
+                callWork(work);
+            }
+            else
+            {
+                callWork(work);
+            }
+            if (recorder)
+            {
+                recorder->pushToParentIfDue();
+            }
         }
     }
     catch (const Closed&)
@@ -135,50 +153,67 @@ void LL::WorkQueueBase::checkCoroutine(const std::string& method)
 /*****************************************************************************
 *   WorkQueue
 *****************************************************************************/
-LL::WorkQueue::WorkQueue(const std::string& name, size_t capacity):
+LL::WorkQueue::WorkQueue(const std::string& name, size_t capacity, Backend backend):
     super(name),
     mQueue(capacity)
 {
+    if (backend == STEALING)
+    {
+        mStealing.reset(new StealingQueue(capacity));
+    }
 }
 
 void LL::WorkQueue::close()
 {
-    mQueue.close();
+    if (mStealing)
+    {
+        mStealing->close();
+    }
+    else
+    {
+        mQueue.close();
+    }
 }
 
 size_t LL::WorkQueue::size()
 {
-    return mQueue.size();
+    return mStealing? mStealing->size() : mQueue.size();
 }
 
 bool LL::WorkQueue::isClosed()
 {
-    return mQueue.isClosed();
+    return mStealing? mStealing->isClosed() : mQueue.isClosed();
 }
 
 bool LL::WorkQueue::done()
 {
-    return mQueue.done();
+    return mStealing? mStealing->done() : mQueue.done();
 }
 
-bool LL::WorkQueue::post(const Work& callable)
+bool LL::WorkQueue::post(Work callable)
 {
-    return mQueue.pushIfOpen(callable);
+    return mStealing? mStealing->pushIfOpen(std::move(callable)) : mQueue.pushIfOpen(std::move(callable));
 }
 
-bool LL::WorkQueue::tryPost(const Work& callable)
+bool LL::WorkQueue::post(Work callable, size_t worker_hint)
 {
-    return mQueue.tryPush(callable);
+    return mStealing? mStealing->pushIfOpen(std::move(callable), worker_hint)
+        : mQueue.pushIfOpen(std::move(callable));
+}
+
+bool LL::WorkQueue::tryPost(Work callable)
+{
+    return mStealing? mStealing->tryPush(std::move(callable)) : mQueue.tryPush(std::move(callable));
 }
 
 LL::WorkQueue::Work LL::WorkQueue::pop_()
 {
-    return mQueue.pop();
+    return mStealing? mStealing->pop() : mQueue.pop();
 }
 
 bool LL::WorkQueue::tryPop_(Work& work)
 {
-    return mQueue.tryPop(work);
+    return mStealing? mStealing->tryPop(work) : mQueue.tryPop(work);
 }
 
 /*****************************************************************************
@@ -210,28 +245,28 @@ bool LL::WorkSchedule::done()
     return mQueue.done();
 }
 
-bool LL::WorkSchedule::post(const Work& callable)
+bool LL::WorkSchedule::post(Work callable)
 {
     // Use TimePoint::clock::now() instead of TimePoint's representation of
     // the epoch because this WorkSchedule may contain a mix of past-due
     // TimedWork items and TimedWork items scheduled for the future. Sift this
     // new item into the correct place.
-    return post(callable, TimePoint::clock::now());
+    return post(std::move(callable), TimePoint::clock::now());
 }
 
-bool LL::WorkSchedule::post(const Work& callable, const TimePoint& time)
+bool LL::WorkSchedule::post(Work callable, const TimePoint& time)
 {
-    return mQueue.pushIfOpen(TimedWork(time, callable));
+    return mQueue.pushIfOpen(TimedWork(time, std::move(callable)));
 }
 
-bool LL::WorkSchedule::tryPost(const Work& callable)
+bool LL::WorkSchedule::tryPost(Work callable)
 {
-    return tryPost(callable, TimePoint::clock::now());
+    return tryPost(std::move(callable), TimePoint::clock::now());
 }
 
-bool LL::WorkSchedule::tryPost(const Work& callable, const TimePoint& time)
+bool LL::WorkSchedule::tryPost(Work callable, const TimePoint& time)
 {
-    return mQueue.tryPush(TimedWork(time, callable));
+    return mQueue.tryPush(TimedWork(time, std::move(callable)));
 }
 
 LL::WorkSchedule::Work LL::WorkSchedule::pop_()
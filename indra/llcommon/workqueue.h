@@ -16,14 +16,17 @@
 #include "llexception.h"
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
+#include "smallfunction.h"
 #include "threadsafeschedule.h"
+#include "workstealingqueue.h"
 #include <chrono>
 #include <exception>                // std::current_exception
-#include <functional>               // std::function
+#include <memory>                   // std::unique_ptr
 #include <string>
 
 namespace LL
 {
+    class CpuBudget;
 
 /*****************************************************************************
 *   WorkQueueBase: API for WorkQueue and WorkSchedule
@@ -37,7 +40,8 @@ namespace LL
         using super = LLInstanceTracker<WorkQueueBase, std::string>;
 
     public:
-        using Work = std::function<void()>;
+        // Move-only, and stores typical lambdas without a heap allocation.
+        using Work = SmallFunction<void()>;
         using Closed = LLThreadSafeQueueInterrupt;
         // for runFor()
         using TimePoint = std::chrono::steady_clock::time_point;
@@ -86,12 +90,12 @@ namespace LL
         /**
          * post work, unless the queue is closed before we can post
          */
-        virtual bool post(const Work&) = 0;
+        virtual bool post(Work) = 0;
 
         /**
          * post work, unless the queue is full
          */
-        virtual bool tryPost(const Work&) = 0;
+        virtual bool tryPost(Work) = 0;
 
         /**
          * Post work to another WorkQueue, which may or may not still exist
@@ -133,8 +137,12 @@ namespace LL
          * runUntilClose() pulls TimedWork items off this WorkQueue until the
          * queue is closed, at which point it returns. This would be the
          * typical entry point for a simple worker thread.
+         *
+         * Pass a CpuBudget to hold one of its tokens while running each work
+         * item, so worker threads of several pools sharing that budget never
+         * run more items at once than it allows.
          */
-        void runUntilClose();
+        void runUntilClose(CpuBudget* budget=nullptr);
 
         /**
          * runPending() runs all TimedWork items that are ready to run. It
@@ -208,11 +216,22 @@ namespace LL
         using super = LLInstanceTrackerSubclass<WorkQueue, WorkQueueBase>;
 
     public:
+        /**
+         * SHARED feeds every consumer from one LLThreadSafeQueue. STEALING
+         * gives each consumer thread its own deque and lets idle consumers
+         * steal from busy ones: see WorkStealingQueue. STEALING suits a
+         * queue with several worker threads and many small items.
+         */
+        enum Backend { SHARED, STEALING };
+
         /**
          * You may omit the WorkQueue name, in which case a unique name is
          * synthesized; for practical purposes that makes it anonymous.
          */
-        WorkQueue(const std::string& name = std::string(), size_t capacity=1024);
+        WorkQueue(const std::string& name = std::string(), size_t capacity=1024,
+                  Backend backend=SHARED);
+
+        Backend getBackend() const { return mStealing? STEALING : SHARED; }
 
         /**
          * Since the point of WorkQueue is to pass work to some other worker
@@ -247,16 +266,31 @@ namespace LL
         /**
          * post work, unless the queue is closed before we can post
          */
-        bool post(const Work&) override;
+        bool post(Work) override;
+
+        /**
+         * post work with an affinity hint: with the STEALING backend, items
+         * posted with the same worker_hint queue up for the same worker
+         * thread (modulo the number of workers), unless some idle worker
+         * steals them. Work posted by one of this queue's own workers stays
+         * with that worker regardless. The SHARED backend ignores the hint.
+         */
+        bool post(Work, size_t worker_hint);
 
         /**
          * post work, unless the queue is full
          */
-        bool tryPost(const Work&) override;
+        bool tryPost(Work) override;
 
     private:
-        using Queue = LLThreadSafeQueue<Work>;
+        // RingQueue reuses its slots, so a steady stream of posts doesn't
+        // allocate queue storage either
+        using Queue = LLThreadSafeQueue<Work, RingQueue<Work>>;
+        using StealingQueue = WorkStealingQueue<Work>;
         Queue mQueue;
+        // engaged only for the STEALING backend, in which case mQueue is
+        // unused
+        std::unique_ptr<StealingQueue> mStealing;
 
         Work pop_() override;
         bool tryPop_(Work&) override;
@@ -317,23 +351,23 @@ namespace LL
         /**
          * post work, unless the queue is closed before we can post
          */
-        bool post(const Work& callable) override;
+        bool post(Work callable) override;
 
         /**
          * post work for a particular time, unless the queue is closed before
          * we can post
          */
-        bool post(const Work& callable, const TimePoint& time);
+        bool post(Work callable, const TimePoint& time);
 
         /**
          * post work, unless the queue is full
          */
-        bool tryPost(const Work& callable) override;
+        bool tryPost(Work callable) override;
 
         /**
          * post work for a particular time, unless the queue is full
          */
-        bool tryPost(const Work& callable, const TimePoint& time);
+        bool tryPost(Work callable, const TimePoint& time);
 
         /**
          * Launch a callable returning bool that will trigger repeatedly at
@@ -0,0 +1,400 @@
+/**
+ * @file   workstealingqueue.h
+ * @date   2026-10-19
+ * @brief  WorkStealingQueue keeps a deque per consumer thread, and
+ *         consumers that run dry steal from the others.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_WORKSTEALINGQUEUE_H)
+#define LL_WORKSTEALINGQUEUE_H
+
+#include "llcoros.h"
+#include LLCOROS_MUTEX_HEADER
+#include LLCOROS_CONDVAR_HEADER
+#include "llthreadsafequeue.h"      // LLThreadSafeQueueInterrupt, RingQueue
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace LL
+{
+    /**
+     * WorkStealingQueue is a drop-in for LLThreadSafeQueue, with the same
+     * close(), pushIfOpen(), tryPush(), pop() and tryPop() semantics, for a
+     * queue serviced by a pool of threads. Instead of every producer and
+     * consumer taking turns on one lock, each consumer thread owns a deque
+     * with its own lock:
+     *
+     * * A consumer pops the oldest item from its own deque. When that is
+     *   empty it steals the newest item from another consumer's deque, so
+     *   work spreads to idle threads without a shared hot spot.
+     * * An item pushed by one of the consumers goes to that consumer's own
+     *   deque, so follow-on work tends to stay on the thread whose cache
+     *   holds its data.
+     * * An item pushed by any other thread goes to the deque picked by an
+     *   affinity hint, or round robin when there is none.
+     *
+     * A thread becomes a consumer the first time it pops, up to MAX_WORKERS;
+     * any further consumers only steal. A thread keeps its deque for the
+     * life of the queue, however many other queues it also consumes.
+     */
+    template <typename ElementT>
+    class WorkStealingQueue
+    {
+    public:
+        static constexpr size_t MAX_WORKERS = 64;
+        static constexpr size_t NO_HINT = size_t(-1);
+
+        WorkStealingQueue(size_t capacity = 1024):
+            mSerial(nextSerial_()),
+            mCapacity(capacity)
+        {}
+
+        /// Push unless closed, waiting while full. Pass a worker index as
+        /// hint to queue the item for that worker rather than round robin.
+        template <typename T>
+        bool pushIfOpen(T&& element, size_t hint = NO_HINT)
+        {
+            while (! reserve_())
+            {
+                LLCoros::LockType lock(mWaitMutex);
+                while (! mClosed.load() && mSize.load() >= mCapacity)
+                {
+                    mSpaceCond.wait(lock);
+                }
+                if (mClosed.load())
+                {
+                    return false;
+                }
+            }
+            push_(std::forward<T>(element), hint);
+            return true;
+        }
+
+        /// Push unless closed or full, without waiting
+        template <typename T>
+        bool tryPush(T&& element, size_t hint = NO_HINT)
+        {
+            if (! reserve_())
+            {
+                return false;
+            }
+            push_(std::forward<T>(element), hint);
+            return true;
+        }
+
+        /// Pop an item, waiting for one. Throws LLThreadSafeQueueInterrupt
+        /// once the queue is closed and drained. The first pop() from a
+        /// thread makes it a consumer with its own deque.
+        ElementT pop()
+        {
+            registerWorker_();
+            ElementT element;
+            for (;;)
+            {
+                if (tryPop(element))
+                {
+                    return element;
+                }
+                LLCoros::LockType lock(mWaitMutex);
+                // Announce ourselves before the last look, so that a producer
+                // either sees a sleeper to wake or we see its item
+                ++mSleepers;
+                while (! mSize.load() && ! mClosed.load())
+                {
+                    mWorkCond.wait(lock);
+                }
+                --mSleepers;
+                // closed first: a producer that counts an item after we look
+                // at mSize will then see mClosed and take it back
+                if (mClosed.load() && ! mSize.load())
+                {
+                    LLTHROW(LLThreadSafeQueueInterrupt());
+                }
+            }
+        }
+
+        /// Pop an item if there is one available anywhere
+        bool tryPop(ElementT& element)
+        {
+            if (! mSize.load())
+            {
+                return false;
+            }
+            const size_t self = getWorkerIndex();
+            if (self != NO_HINT && mDeques[self].popFront(element))
+            {
+                popped_();
+                return true;
+            }
+            // steal, starting after ourselves so thieves spread out
+            const size_t workers = getWorkerCount();
+            const size_t start = self != NO_HINT ? self + 1 : 0;
+            for (size_t i = 0; i < workers; ++i)
+            {
+                if (mDeques[(start + i) % workers].popBack(element))
+                {
+                    popped_();
+                    return true;
+                }
+            }
+            // pushed before any consumer registered
+            if (mDeques[MAX_WORKERS].popFront(element))
+            {
+                popped_();
+                return true;
+            }
+            return false;
+        }
+
+        void close()
+        {
+            LLCoros::LockType lock(mWaitMutex);
+            mClosed = true;
+            mWorkCond.notify_all();
+            mSpaceCond.notify_all();
+        }
+
+        bool isClosed() const { return mClosed.load(); }
+
+        bool done() const { return mClosed.load() && ! mSize.load(); }
+
+        size_t size() const { return mSize.load(); }
+
+        /// Index of the calling thread's deque, or NO_HINT if it has none
+        size_t getWorkerIndex() const
+        {
+            if (const Registration* reg = findRegistration_())
+            {
+                return reg->mIndex;
+            }
+            return remember_(lookUpWorker_(), false).mIndex;
+        }
+
+        size_t getWorkerCount() const { return mWorkers.load(); }
+
+    private:
+        struct alignas(64) Deque
+        {
+            std::mutex mMutex;
+            RingQueue<ElementT> mItems;
+
+            template <typename T>
+            void push(T&& element)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mItems.push(std::forward<T>(element));
+            }
+
+            bool popFront(ElementT& element)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mItems.empty())
+                {
+                    return false;
+                }
+                element = std::move(mItems.front());
+                mItems.pop();
+                return true;
+            }
+
+            bool popBack(ElementT& element)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mItems.empty())
+                {
+                    return false;
+                }
+                element = std::move(mItems.back());
+                mItems.pop_back();
+                return true;
+            }
+        };
+
+        // The calling thread's deque in one queue, if any. Queues are told
+        // apart by serial number rather than address, so a queue built
+        // where a destroyed one was does not inherit its registrations.
+        struct Registration
+        {
+            U64 mSerial = 0;
+            size_t mIndex = NO_HINT;
+            // whether the thread has tried to become a consumer
+            bool mEnlisted = false;
+        };
+        // Each thread remembers the last few queues it used, so the usual
+        // lookup takes no lock. mWorkerIds is the authority.
+        static constexpr size_t REMEMBERED = 4;
+        struct Registrations
+        {
+            Registration mEntries[REMEMBERED];
+            size_t mNext = 0;
+        };
+        static thread_local Registrations sRegistrations;
+
+        static U64 nextSerial_()
+        {
+            static std::atomic<U64> sSerial{ 0 };
+            return ++sSerial;
+        }
+
+        const Registration* findRegistration_() const
+        {
+            for (const Registration& reg : sRegistrations.mEntries)
+            {
+                if (reg.mSerial == mSerial)
+                {
+                    return &reg;
+                }
+            }
+            return nullptr;
+        }
+
+        const Registration& remember_(size_t index, bool enlisted) const
+        {
+            Registrations& regs = sRegistrations;
+            Registration* reg = const_cast<Registration*>(findRegistration_());
+            if (! reg)
+            {
+                reg = &regs.mEntries[regs.mNext++ % REMEMBERED];
+                reg->mSerial = mSerial;
+            }
+            reg->mIndex = index;
+            reg->mEnlisted = enlisted;
+            return *reg;
+        }
+
+        // the calling thread's deque according to mWorkerIds
+        size_t lookUpWorker_() const
+        {
+            const std::thread::id self = std::this_thread::get_id();
+            std::lock_guard<std::mutex> lock(mRegistryMutex);
+            const size_t workers = mWorkers.load();
+            for (size_t i = 0; i < workers; ++i)
+            {
+                if (mWorkerIds[i] == self)
+                {
+                    return i;
+                }
+            }
+            return NO_HINT;
+        }
+
+        void registerWorker_()
+        {
+            const Registration* reg = findRegistration_();
+            if (reg && reg->mEnlisted)
+            {
+                return;
+            }
+            size_t index = lookUpWorker_();
+            if (index == NO_HINT)
+            {
+                std::lock_guard<std::mutex> lock(mRegistryMutex);
+                // only this thread can add itself, so it is still absent
+                const size_t workers = mWorkers.load();
+                if (workers < MAX_WORKERS)
+                {
+                    mWorkerIds[workers] = std::this_thread::get_id();
+                    // publish the id before its deque can be targeted
+                    mWorkers.store(workers + 1);
+                    index = workers;
+                }
+            }
+            remember_(index, true);
+        }
+
+        // Counts an item in before it is pushed, unless closed or full.
+        // Producers do not share a lock: a failed attempt briefly overcounts.
+        bool reserve_()
+        {
+            if (mClosed.load())
+            {
+                return false;
+            }
+            if (mSize++ >= mCapacity)
+            {
+                --mSize;
+                return false;
+            }
+            if (mClosed.load())
+            {
+                --mSize;
+                return false;
+            }
+            return true;
+        }
+
+        template <typename T>
+        void push_(T&& element, size_t hint)
+        {
+            const size_t workers = getWorkerCount();
+            size_t target = getWorkerIndex();
+            // every deque below mWorkers is one tryPop() looks in
+            if (target >= workers)
+            {
+                if (! workers)
+                {
+                    target = MAX_WORKERS;
+                }
+                else if (hint != NO_HINT)
+                {
+                    target = hint % workers;
+                }
+                else
+                {
+                    target = mNextDeque++ % workers;
+                }
+            }
+            mDeques[target].push(std::forward<T>(element));
+
+            // mSize was already counted: a sleeper that checked it before
+            // then is counted in mSleepers, one that checks it later does
+            // not sleep
+            if (mSleepers.load())
+            {
+                LLCoros::LockType lock(mWaitMutex);
+                mWorkCond.notify_one();
+            }
+        }
+
+        void popped_()
+        {
+            if (mSize-- >= mCapacity)
+            {
+                LLCoros::LockType lock(mWaitMutex);
+                mSpaceCond.notify_one();
+            }
+        }
+
+        // one per possible consumer, plus one for items pushed before the
+        // first consumer registered
+        Deque mDeques[MAX_WORKERS + 1];
+        const U64 mSerial;
+        // which thread owns each of the first mWorkers deques
+        mutable std::mutex mRegistryMutex;
+        std::thread::id mWorkerIds[MAX_WORKERS];
+        std::atomic<size_t> mWorkers{ 0 };
+        std::atomic<size_t> mNextDeque{ 0 };
+        std::atomic<size_t> mSize{ 0 };
+        std::atomic<size_t> mSleepers{ 0 };
+        const size_t mCapacity;
+
+        std::atomic<bool> mClosed{ false };
+
+        // only for sleeping: consumers with nothing to do, producers with
+        // no room
+        LLCoros::Mutex mWaitMutex;
+        LLCoros::ConditionVariable mWorkCond;
+        LLCoros::ConditionVariable mSpaceCond;
+    };
+
+    template <typename ElementT>
+    thread_local typename WorkStealingQueue<ElementT>::Registrations WorkStealingQueue<ElementT>::sRegistrations;
+
+} // namespace LL
+
+#endif /* ! defined(LL_WORKSTEALINGQUEUE_H) */
@@ -586,6 +586,7 @@ static void bilinear_scale(const U8 *src, U32 srcW, U32 srcH, U32 srcCh, U32 src
 
 //static
 thread_local std::string LLImage::sLastThreadErrorMessage;
+thread_local S32 LLImage::sThreadDecodeThreads = 1;
 bool LLImage::sUseNewByteRange = false;
 S32  LLImage::sMinimalReverseByteRangePercent = 75;
 
@@ -628,7 +629,8 @@ LLImageBase::LLImageBase()
     mHeight(0),
     mComponents(0),
     mBadBufferAllocation(false),
-    mAllowOverSize(false)
+    mAllowOverSize(false),
+    mMemTag(LLMemTag::IMAGE)
 {}
 
 // virtual
@@ -671,6 +673,10 @@ void LLImageBase::sanityCheck()
 // virtual
 void LLImageBase::deleteData()
 {
+    if (mData)
+    {
+        LLMemTag::discharge(mMemTag, mDataSize);
+    }
     ll_aligned_free_16(mData);
     mDataSize = 0;
     mData = NULL;
@@ -716,6 +722,11 @@ U8* LLImageBase::allocateData(S32 size)
             LL_WARNS() << "Failed to allocate image data size [" << size << "]" << LL_ENDL;
             mBadBufferAllocation = true;
         }
+        else
+        {
+            mMemTag = LLMemTag::current(LLMemTag::IMAGE);
+            LLMemTag::charge(mMemTag, size);
+        }
     }
 
     if (mBadBufferAllocation)
@@ -748,7 +759,10 @@ U8* LLImageBase::reallocateData(S32 size)
         S32 bytes = llmin(mDataSize, size);
         memcpy(new_datap, mData, bytes);    /* Flawfinder: ignore */
         ll_aligned_free_16(mData) ;
+        LLMemTag::discharge(mMemTag, mDataSize);
     }
+    mMemTag = LLMemTag::current(LLMemTag::IMAGE);
+    LLMemTag::charge(mMemTag, size);
     mData = new_datap;
     mDataSize = size;
     mBadBufferAllocation = false;
@@ -2617,6 +2631,17 @@ static void avg4_colors2(const U8* a, const U8* b, const U8* c, const U8* d, U8*
 void LLImageBase::setDataAndSize(U8 *data, S32 size)
 {
     ll_assert_aligned(data, 16);
+    // Callers free the old buffer first, or hand it to someone else along
+    // with its charge
+    if (mData)
+    {
+        LLMemTag::discharge(mMemTag, mDataSize);
+    }
+    if (data)
+    {
+        mMemTag = LLMemTag::current(LLMemTag::IMAGE);
+        LLMemTag::charge(mMemTag, size);
+    }
     mData = data;
     mDataSize = size;
 }
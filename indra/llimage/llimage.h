@@ -31,6 +31,7 @@
 #include "llstring.h"
 #include "llpointer.h"
 #include "lltrace.h"
+#include "llmemtag.h"
 
 constexpr S32 MIN_IMAGE_MIP =  2; // 4x4, only used for expand/contract power of 2
 constexpr S32 MAX_IMAGE_MIP = 12; // 4096x4096
@@ -102,8 +103,15 @@ public:
     static bool useNewByteRange() { return sUseNewByteRange; }
     static S32  getReverseByteRangePercent() { return sMinimalReverseByteRangePercent; }
 
+    // Threads a decode on the calling thread may use, counting itself.
+    // LLImageDecodeThread sets this for each request so that codecs with
+    // multithreaded decoding do not oversubscribe the machine.
+    static S32 getThreadDecodeThreads() { return sThreadDecodeThreads; }
+    static void setThreadDecodeThreads(S32 threads) { sThreadDecodeThreads = llmax(threads, 1); }
+
 protected:
     static thread_local std::string sLastThreadErrorMessage;
+    static thread_local S32 sThreadDecodeThreads;
     static bool sUseNewByteRange;
     static S32  sMinimalReverseByteRangePercent;
 };
@@ -174,6 +182,9 @@ private:
     bool mBadBufferAllocation;
     bool mAllowOverSize;
 
+    // The subsystem mData is charged to, see LLMemTag
+    LLMemTag::ETag mMemTag;
+
 private:
     mutable LLSharedMutex mDataMutex;
 
@@ -0,0 +1,794 @@
+/**
+ * @file llimagebc.cpp
+ * @brief CPU block compression (BC1, BC3 and BC7) of raw image data.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagebc.h"
+
+namespace
+{
+    const S32 BLOCK_TEXELS = 16;
+
+    // BC7 interpolation weights for 4 bit indices, out of 64
+    const S32 BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    F32 clamp_channel(F32 v)
+    {
+        return llclamp(v, 0.f, 255.f);
+    }
+
+    // Fits a line through the first 'channels' channels of the block texels
+    // and returns the extreme points of the block along it.
+    void fit_line(const U8* rgba, S32 channels, F32* low, F32* high)
+    {
+        F32 mean[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            for (S32 c = 0; c < channels; ++c)
+            {
+                mean[c] += rgba[i * 4 + c];
+            }
+        }
+        for (S32 c = 0; c < channels; ++c)
+        {
+            mean[c] /= (F32)BLOCK_TEXELS;
+        }
+
+        F32 cov[4][4] = {};
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            F32 d[4];
+            for (S32 c = 0; c < channels; ++c)
+            {
+                d[c] = rgba[i * 4 + c] - mean[c];
+            }
+            for (S32 r = 0; r < channels; ++r)
+            {
+                for (S32 c = r; c < channels; ++c)
+                {
+                    cov[r][c] += d[r] * d[c];
+                }
+            }
+        }
+        for (S32 r = 0; r < channels; ++r)
+        {
+            for (S32 c = 0; c < r; ++c)
+            {
+                cov[r][c] = cov[c][r];
+            }
+        }
+
+        // Power iteration, seeded with the row of the widest channel
+        S32 widest = 0;
+        for (S32 c = 1; c < channels; ++c)
+        {
+            if (cov[c][c] > cov[widest][widest])
+            {
+                widest = c;
+            }
+        }
+        F32 axis[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 c = 0; c < channels; ++c)
+        {
+            axis[c] = cov[widest][c];
+        }
+        for (S32 iter = 0; iter < 8; ++iter)
+        {
+            F32 next[4] = { 0.f, 0.f, 0.f, 0.f };
+            F32 largest = 0.f;
+            for (S32 r = 0; r < channels; ++r)
+            {
+                for (S32 c = 0; c < channels; ++c)
+                {
+                    next[r] += cov[r][c] * axis[c];
+                }
+                largest = llmax(largest, fabsf(next[r]));
+            }
+            if (largest <= 0.f)
+            {
+                break;
+            }
+            for (S32 c = 0; c < channels; ++c)
+            {
+                axis[c] = next[c] / largest;
+            }
+        }
+
+        F32 length = 0.f;
+        for (S32 c = 0; c < channels; ++c)
+        {
+            length += axis[c] * axis[c];
+        }
+        if (length <= 0.f)
+        {
+            // Flat block
+            for (S32 c = 0; c < channels; ++c)
+            {
+                low[c] = high[c] = mean[c];
+            }
+            return;
+        }
+        length = sqrtf(length);
+        for (S32 c = 0; c < channels; ++c)
+        {
+            axis[c] /= length;
+        }
+
+        F32 tmin = 0.f;
+        F32 tmax = 0.f;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            F32 t = 0.f;
+            for (S32 c = 0; c < channels; ++c)
+            {
+                t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+            }
+            tmin = llmin(tmin, t);
+            tmax = llmax(tmax, t);
+        }
+        for (S32 c = 0; c < channels; ++c)
+        {
+            low[c] = clamp_channel(mean[c] + tmin * axis[c]);
+            high[c] = clamp_channel(mean[c] + tmax * axis[c]);
+        }
+    }
+
+    // Least squares endpoints for the current index assignment. weights[i]
+    // is the share of endpoint a in texel i.
+    bool fit_endpoints(const U8* rgba, S32 channels, const F32* weights, F32* a, F32* b)
+    {
+        F32 aa = 0.f, bb = 0.f, ab = 0.f;
+        F32 ax[4] = { 0.f, 0.f, 0.f, 0.f };
+        F32 bx[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            F32 wa = weights[i];
+            F32 wb = 1.f - wa;
+            aa += wa * wa;
+            bb += wb * wb;
+            ab += wa * wb;
+            for (S32 c = 0; c < channels; ++c)
+            {
+                ax[c] += wa * rgba[i * 4 + c];
+                bx[c] += wb * rgba[i * 4 + c];
+            }
+        }
+        F32 det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+        {
+            return false;
+        }
+        F32 inv = 1.f / det;
+        for (S32 c = 0; c < channels; ++c)
+        {
+            a[c] = clamp_channel((ax[c] * bb - bx[c] * ab) * inv);
+            b[c] = clamp_channel((bx[c] * aa - ax[c] * ab) * inv);
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    // BC1 colour block
+
+    U16 pack_565(const F32* c)
+    {
+        S32 r = llclamp((S32)(c[0] * (31.f / 255.f) + 0.5f), 0, 31);
+        S32 g = llclamp((S32)(c[1] * (63.f / 255.f) + 0.5f), 0, 63);
+        S32 b = llclamp((S32)(c[2] * (31.f / 255.f) + 0.5f), 0, 31);
+        return (U16)((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(U16 v, S32* c)
+    {
+        S32 r = (v >> 11) & 31;
+        S32 g = (v >> 5) & 63;
+        S32 b = v & 31;
+        c[0] = (r << 3) | (r >> 2);
+        c[1] = (g << 2) | (g >> 4);
+        c[2] = (b << 3) | (b >> 2);
+    }
+
+    // Four colour palette: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+    void color_palette(U16 c0, U16 c1, S32 palette[4][3])
+    {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (S32 c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+
+    S32 color_indices(const U8* rgba, U16 c0, U16 c1, U8* indices)
+    {
+        S32 palette[4][3];
+        color_palette(c0, c1, palette);
+        S32 total = 0;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            const U8* texel = rgba + i * 4;
+            S32 best = 0;
+            S32 best_error = S32_MAX;
+            for (S32 p = 0; p < 4; ++p)
+            {
+                S32 dr = texel[0] - palette[p][0];
+                S32 dg = texel[1] - palette[p][1];
+                S32 db = texel[2] - palette[p][2];
+                S32 error = dr * dr + dg * dg + db * db;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices[i] = (U8)best;
+            total += best_error;
+        }
+        return total;
+    }
+
+    void encode_color_block(const U8* rgba, U8* block)
+    {
+        static const F32 weights_of_c0[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+        F32 low[4], high[4];
+        fit_line(rgba, 3, low, high);
+        U16 c0 = pack_565(high);
+        U16 c1 = pack_565(low);
+        U8 indices[BLOCK_TEXELS];
+        S32 error = color_indices(rgba, c0, c1, indices);
+
+        for (S32 iter = 0; iter < 2 && error > 0; ++iter)
+        {
+            F32 weights[BLOCK_TEXELS];
+            for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                weights[i] = weights_of_c0[indices[i]];
+            }
+            F32 a[4], b[4];
+            if (!fit_endpoints(rgba, 3, weights, a, b))
+            {
+                break;
+            }
+            U16 n0 = pack_565(a);
+            U16 n1 = pack_565(b);
+            if (n0 == c0 && n1 == c1)
+            {
+                break;
+            }
+            U8 new_indices[BLOCK_TEXELS];
+            S32 new_error = color_indices(rgba, n0, n1, new_indices);
+            if (new_error >= error)
+            {
+                break;
+            }
+            c0 = n0;
+            c1 = n1;
+            error = new_error;
+            memcpy(indices, new_indices, BLOCK_TEXELS);    /* Flawfinder: ignore */
+        }
+
+        // Four colour mode needs c0 > c1; equal endpoints only use index 0.
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                indices[i] ^= 1;
+            }
+        }
+        else if (c0 == c1)
+        {
+            memset(indices, 0, BLOCK_TEXELS);
+        }
+
+        U32 bits = 0;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            bits |= (U32)indices[i] << (i * 2);
+        }
+        block[0] = (U8)(c0 & 0xff);
+        block[1] = (U8)(c0 >> 8);
+        block[2] = (U8)(c1 & 0xff);
+        block[3] = (U8)(c1 >> 8);
+        for (S32 i = 0; i < 4; ++i)
+        {
+            block[4 + i] = (U8)(bits >> (i * 8));
+        }
+    }
+
+    void decode_color_block(const U8* block, U8* rgba, bool four_color_only)
+    {
+        U16 c0 = (U16)(block[0] | (block[1] << 8));
+        U16 c1 = (U16)(block[2] | (block[3] << 8));
+        S32 palette[4][4];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+        if (c0 > c1 || four_color_only)
+        {
+            for (S32 c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+        }
+        else
+        {
+            for (S32 c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            palette[3][3] = 0;
+        }
+
+        U32 bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((U32)block[7] << 24);
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            const S32* entry = palette[(bits >> (i * 2)) & 3];
+            for (S32 c = 0; c < 4; ++c)
+            {
+                rgba[i * 4 + c] = (U8)entry[c];
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // BC3 alpha block
+
+    void alpha_palette(S32 a0, S32 a1, S32* palette)
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (S32 k = 1; k < 7; ++k)
+            {
+                palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+            }
+        }
+        else
+        {
+            for (S32 k = 1; k < 5; ++k)
+            {
+                palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encode_alpha_block(const U8* rgba, U8* block)
+    {
+        S32 amin = 255;
+        S32 amax = 0;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            amin = llmin(amin, (S32)rgba[i * 4 + 3]);
+            amax = llmax(amax, (S32)rgba[i * 4 + 3]);
+        }
+
+        block[0] = (U8)amax;
+        block[1] = (U8)amin;
+        if (amin == amax)
+        {
+            memset(block + 2, 0, 6);
+            return;
+        }
+
+        S32 palette[8];
+        alpha_palette(amax, amin, palette);
+        U64 bits = 0;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            S32 alpha = rgba[i * 4 + 3];
+            S32 best = 0;
+            S32 best_error = S32_MAX;
+            for (S32 p = 0; p < 8; ++p)
+            {
+                S32 error = llabs(alpha - palette[p]);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            bits |= (U64)best << (i * 3);
+        }
+        for (S32 i = 0; i < 6; ++i)
+        {
+            block[2 + i] = (U8)(bits >> (i * 8));
+        }
+    }
+
+    void decode_alpha_block(const U8* block, U8* rgba)
+    {
+        S32 palette[8];
+        alpha_palette(block[0], block[1], palette);
+        U64 bits = 0;
+        for (S32 i = 0; i < 6; ++i)
+        {
+            bits |= (U64)block[2 + i] << (i * 8);
+        }
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            rgba[i * 4 + 3] = (U8)palette[(bits >> (i * 3)) & 7];
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // BC7 mode 6
+
+    void put_bits(U8* block, S32& pos, U32 value, S32 count)
+    {
+        for (S32 i = 0; i < count; ++i, ++pos)
+        {
+            if (value & (1u << i))
+            {
+                block[pos >> 3] |= (U8)(1 << (pos & 7));
+            }
+        }
+    }
+
+    U32 get_bits(const U8* block, S32& pos, S32 count)
+    {
+        U32 value = 0;
+        for (S32 i = 0; i < count; ++i, ++pos)
+        {
+            value |= (U32)((block[pos >> 3] >> (pos & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    // 7 bit channels sharing one p-bit, picking the p-bit closest to e
+    void quantize_bc7_endpoint(const F32* e, U8* q, U8& pbit)
+    {
+        F32 best_error = F32_MAX;
+        for (S32 p = 0; p < 2; ++p)
+        {
+            U8 candidate[4];
+            F32 error = 0.f;
+            for (S32 c = 0; c < 4; ++c)
+            {
+                S32 v = llclamp((S32)((e[c] - p) * 0.5f + 0.5f), 0, 127);
+                candidate[c] = (U8)v;
+                F32 d = (F32)((v << 1) | p) - e[c];
+                error += d * d;
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                pbit = (U8)p;
+                memcpy(q, candidate, 4);    /* Flawfinder: ignore */
+            }
+        }
+    }
+
+    void bc7_palette(const U8* q0, U8 p0, const U8* q1, U8 p1, S32 palette[16][4])
+    {
+        for (S32 c = 0; c < 4; ++c)
+        {
+            S32 e0 = (q0[c] << 1) | p0;
+            S32 e1 = (q1[c] << 1) | p1;
+            for (S32 i = 0; i < 16; ++i)
+            {
+                palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6;
+            }
+        }
+    }
+
+    // Projects each texel onto the endpoint line and only compares the
+    // nearest few palette entries, as the weights are almost evenly spaced.
+    S32 bc7_indices(const U8* rgba, const U8* q0, U8 p0, const U8* q1, U8 p1, U8* indices)
+    {
+        S32 palette[16][4];
+        bc7_palette(q0, p0, q1, p1, palette);
+        F32 dir[4];
+        F32 length = 0.f;
+        for (S32 c = 0; c < 4; ++c)
+        {
+            dir[c] = (F32)(palette[15][c] - palette[0][c]);
+            length += dir[c] * dir[c];
+        }
+        F32 scale = length > 0.f ? 15.f / length : 0.f;
+
+        S32 total = 0;
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            const U8* texel = rgba + i * 4;
+            F32 t = 0.f;
+            for (S32 c = 0; c < 4; ++c)
+            {
+                t += (texel[c] - palette[0][c]) * dir[c];
+            }
+            S32 guess = llclamp((S32)(t * scale + 0.5f), 0, 15);
+            S32 best = guess;
+            S32 best_error = S32_MAX;
+            for (S32 p = llmax(guess - 1, 0); p <= llmin(guess + 1, 15); ++p)
+            {
+                S32 error = 0;
+                for (S32 c = 0; c < 4; ++c)
+                {
+                    S32 d = texel[c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices[i] = (U8)best;
+            total += best_error;
+        }
+        return total;
+    }
+}
+
+//static
+S32 LLImageBC::compressedSize(EFormat format, S32 width, S32 height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+//static
+void LLImageBC::encodeBC1Block(const U8* rgba, U8* block)
+{
+    encode_color_block(rgba, block);
+}
+
+//static
+void LLImageBC::encodeBC3Block(const U8* rgba, U8* block)
+{
+    encode_alpha_block(rgba, block);
+    encode_color_block(rgba, block + 8);
+}
+
+//static
+void LLImageBC::encodeBC7Block(const U8* rgba, U8* block)
+{
+    F32 e0[4], e1[4];
+    fit_line(rgba, 4, e0, e1);
+    U8 q0[4], q1[4];
+    U8 p0 = 0, p1 = 0;
+    quantize_bc7_endpoint(e0, q0, p0);
+    quantize_bc7_endpoint(e1, q1, p1);
+    U8 indices[BLOCK_TEXELS];
+    S32 error = bc7_indices(rgba, q0, p0, q1, p1, indices);
+
+    for (S32 iter = 0; iter < 2 && error > 0; ++iter)
+    {
+        F32 weights[BLOCK_TEXELS];
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            weights[i] = (64 - BC7_WEIGHTS[indices[i]]) / 64.f;
+        }
+        if (!fit_endpoints(rgba, 4, weights, e0, e1))
+        {
+            break;
+        }
+        U8 n0[4], n1[4];
+        U8 np0 = 0, np1 = 0;
+        quantize_bc7_endpoint(e0, n0, np0);
+        quantize_bc7_endpoint(e1, n1, np1);
+        U8 new_indices[BLOCK_TEXELS];
+        S32 new_error = bc7_indices(rgba, n0, np0, n1, np1, new_indices);
+        if (new_error >= error)
+        {
+            break;
+        }
+        memcpy(q0, n0, 4);  /* Flawfinder: ignore */
+        memcpy(q1, n1, 4);  /* Flawfinder: ignore */
+        p0 = np0;
+        p1 = np1;
+        error = new_error;
+        memcpy(indices, new_indices, BLOCK_TEXELS);    /* Flawfinder: ignore */
+    }
+
+    // The first index is stored with its top bit implied zero
+    if (indices[0] & 8)
+    {
+        for (S32 c = 0; c < 4; ++c)
+        {
+            std::swap(q0[c], q1[c]);
+        }
+        std::swap(p0, p1);
+        for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+        {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    memset(block, 0, 16);
+    S32 pos = 0;
+    put_bits(block, pos, 1 << 6, 7);
+    for (S32 c = 0; c < 4; ++c)
+    {
+        put_bits(block, pos, q0[c], 7);
+        put_bits(block, pos, q1[c], 7);
+    }
+    put_bits(block, pos, p0, 1);
+    put_bits(block, pos, p1, 1);
+    for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        put_bits(block, pos, indices[i], i ? 4 : 3);
+    }
+}
+
+//static
+void LLImageBC::decodeBC1Block(const U8* block, U8* rgba)
+{
+    decode_color_block(block, rgba, false);
+}
+
+//static
+void LLImageBC::decodeBC3Block(const U8* block, U8* rgba)
+{
+    decode_color_block(block + 8, rgba, true);
+    decode_alpha_block(block, rgba);
+}
+
+//static
+void LLImageBC::decodeBC7Block(const U8* block, U8* rgba)
+{
+    S32 pos = 0;
+    S32 mode = 0;
+    while (mode < 8 && !get_bits(block, pos, 1))
+    {
+        ++mode;
+    }
+    if (mode != 6)
+    {
+        memset(rgba, 0, BLOCK_TEXELS * 4);
+        return;
+    }
+
+    U8 q0[4], q1[4];
+    for (S32 c = 0; c < 4; ++c)
+    {
+        q0[c] = (U8)get_bits(block, pos, 7);
+        q1[c] = (U8)get_bits(block, pos, 7);
+    }
+    U8 p0 = (U8)get_bits(block, pos, 1);
+    U8 p1 = (U8)get_bits(block, pos, 1);
+    S32 palette[16][4];
+    bc7_palette(q0, p0, q1, p1, palette);
+    for (S32 i = 0; i < BLOCK_TEXELS; ++i)
+    {
+        const S32* entry = palette[get_bits(block, pos, i ? 4 : 3)];
+        for (S32 c = 0; c < 4; ++c)
+        {
+            rgba[i * 4 + c] = (U8)entry[c];
+        }
+    }
+}
+
+//static
+void LLImageBC::compress(EFormat format, const U8* src, S32 width, S32 height, S32 components, U8* dst)
+{
+    llassert(components >= 1 && components <= 4);
+
+    const S32 block_bytes = blockBytes(format);
+    U8 rgba[BLOCK_TEXELS * 4];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            for (S32 y = 0; y < 4; ++y)
+            {
+                S32 sy = llmin(by + y, height - 1);
+                for (S32 x = 0; x < 4; ++x)
+                {
+                    S32 sx = llmin(bx + x, width - 1);
+                    const U8* texel = src + (sy * width + sx) * components;
+                    U8* out = rgba + (y * 4 + x) * 4;
+                    switch (components)
+                    {
+                      case 1:
+                        out[0] = out[1] = out[2] = texel[0];
+                        out[3] = 255;
+                        break;
+                      case 2:
+                        out[0] = out[1] = out[2] = texel[0];
+                        out[3] = texel[1];
+                        break;
+                      case 3:
+                        out[0] = texel[0];
+                        out[1] = texel[1];
+                        out[2] = texel[2];
+                        out[3] = 255;
+                        break;
+                      default:
+                        out[0] = texel[0];
+                        out[1] = texel[1];
+                        out[2] = texel[2];
+                        out[3] = texel[3];
+                        break;
+                    }
+                }
+            }
+
+            switch (format)
+            {
+              case BC1: encodeBC1Block(rgba, dst); break;
+              case BC3: encodeBC3Block(rgba, dst); break;
+              case BC7: encodeBC7Block(rgba, dst); break;
+            }
+            dst += block_bytes;
+        }
+    }
+}
+
+//static
+void LLImageBC::decompress(EFormat format, const U8* src, S32 width, S32 height, S32 components, U8* dst)
+{
+    llassert(components >= 1 && components <= 4);
+
+    const S32 block_bytes = blockBytes(format);
+    U8 rgba[BLOCK_TEXELS * 4];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            switch (format)
+            {
+              case BC1: decodeBC1Block(src, rgba); break;
+              case BC3: decodeBC3Block(src, rgba); break;
+              case BC7: decodeBC7Block(src, rgba); break;
+            }
+            src += block_bytes;
+
+            for (S32 y = 0; y < 4 && by + y < height; ++y)
+            {
+                for (S32 x = 0; x < 4 && bx + x < width; ++x)
+                {
+                    const U8* texel = rgba + (y * 4 + x) * 4;
+                    U8* out = dst + ((by + y) * width + bx + x) * components;
+                    switch (components)
+                    {
+                      case 1:
+                        out[0] = texel[0];
+                        break;
+                      case 2:
+                        out[0] = texel[0];
+                        out[1] = texel[3];
+                        break;
+                      case 3:
+                        out[0] = texel[0];
+                        out[1] = texel[1];
+                        out[2] = texel[2];
+                        break;
+                      default:
+                        memcpy(out, texel, 4);  /* Flawfinder: ignore */
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file llimagebc.h
+ * @brief CPU block compression (BC1, BC3 and BC7) of raw image data.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEBC_H
+#define LL_LLIMAGEBC_H
+
+// Encoders and decoders for 4x4 texel blocks in the GPU block compressed
+// formats, used to shrink fetched textures before they are uploaded:
+//  - BC1 (DXT1): opaque RGB, 8 bytes per block, always in 4 colour mode.
+//  - BC3 (DXT5): RGB as BC1 plus an interpolated alpha block, 16 bytes.
+//  - BC7: mode 6 only (one RGBA endpoint pair, 4 bit indices), 16 bytes.
+//    Other BC7 modes decode as transparent black.
+//
+// Blocks are fitted along the principal axis of their colours and refined
+// once by least squares; this trades some quality against offline tools for
+// speed, as the work runs while textures stream in.
+//
+// Images are packed 1 to 4 byte texels; partial blocks at the edges repeat
+// the last row and column.
+
+class LLImageBC
+{
+public:
+    enum EFormat
+    {
+        BC1,
+        BC3,
+        BC7
+    };
+
+    static S32 blockBytes(EFormat format) { return format == BC1 ? 8 : 16; }
+    // Size of the compressed image, whole blocks only
+    static S32 compressedSize(EFormat format, S32 width, S32 height);
+
+    static void compress(EFormat format, const U8* src, S32 width, S32 height, S32 components, U8* dst);
+    // dst receives width x height texels of 'components' bytes
+    static void decompress(EFormat format, const U8* src, S32 width, S32 height, S32 components, U8* dst);
+
+    // Single blocks, as 16 RGBA texels in row order
+    static void encodeBC1Block(const U8* rgba, U8* block);
+    static void encodeBC3Block(const U8* rgba, U8* block);
+    static void encodeBC7Block(const U8* rgba, U8* block);
+    static void decodeBC1Block(const U8* block, U8* rgba);
+    static void decodeBC3Block(const U8* block, U8* rgba);
+    static void decodeBC7Block(const U8* block, U8* rgba);
+};
+
+#endif // LL_LLIMAGEBC_H
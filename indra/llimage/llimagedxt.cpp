@@ -26,12 +26,13 @@
 #include "linden_common.h"
 
 #include "llimagedxt.h"
+#include "llimagebc.h"
 #include "llmemory.h"
 
 //static
 void LLImageDXT::checkMinWidthHeight(EFileFormat format, S32& width, S32& height)
 {
-    S32 mindim = (format >= FORMAT_DXT1 && format <= FORMAT_DXR5) ? 4 : 1;
+    S32 mindim = (format >= FORMAT_DXT1 && format <= FORMAT_DXR7) ? 4 : 1;
     width = llmax(width, mindim);
     height = llmax(height, mindim);
 }
@@ -49,6 +50,7 @@ S32 LLImageDXT::formatBits(EFileFormat format)
       case FORMAT_DXR3:     return 8;
       case FORMAT_DXR5:     return 8;
       case FORMAT_DXT5:     return 8;
+      case FORMAT_DXR7:     return 8;
       case FORMAT_RGB8:     return 24;
       case FORMAT_RGBA8:    return 32;
       default:
@@ -79,6 +81,7 @@ S32 LLImageDXT::formatComponents(EFileFormat format)
       case FORMAT_DXR3:     return 4;
       case FORMAT_DXT5:     return 4;
       case FORMAT_DXR5:     return 4;
+      case FORMAT_DXR7:     return 4;
       case FORMAT_RGB8:     return 3;
       case FORMAT_RGBA8:    return 4;
       default:
@@ -101,6 +104,7 @@ LLImageDXT::EFileFormat LLImageDXT::getFormat(S32 fourcc)
         case 0x33525844: return FORMAT_DXR3;
         case 0x34525844: return FORMAT_DXR4;
         case 0x35525844: return FORMAT_DXR5;
+        case 0x37525844: return FORMAT_DXR7;
         case 0x31545844: return FORMAT_DXT1;
         case 0x32545844: return FORMAT_DXT2;
         case 0x33545844: return FORMAT_DXT3;
@@ -124,6 +128,7 @@ S32 LLImageDXT::getFourCC(EFileFormat format)
         case FORMAT_DXR3: return 0x33525844;
         case FORMAT_DXR4: return 0x34525844;
         case FORMAT_DXR5: return 0x35525844;
+        case FORMAT_DXR7: return 0x37525844;
         case FORMAT_DXT1: return 0x31545844;
         case FORMAT_DXT2: return 0x32545844;
         case FORMAT_DXT3: return 0x33545844;
@@ -418,6 +423,84 @@ bool LLImageDXT::encode(const LLImageRaw* raw_image, F32 time)
     return encodeDXT(raw_image, time, false);
 }
 
+bool LLImageDXT::encodeBlockCompressed(const LLImageRaw* raw_image, EFileFormat format)
+{
+    llassert_always(raw_image);
+
+    LLImageBC::EFormat bc_format;
+    switch (format)
+    {
+      case FORMAT_DXR1: bc_format = LLImageBC::BC1; break;
+      case FORMAT_DXR5: bc_format = LLImageBC::BC3; break;
+      case FORMAT_DXR7: bc_format = LLImageBC::BC7; break;
+      default:
+        LL_WARNS() << "LLImageDXT::encodeBlockCompressed: unsupported format: " << format << LL_ENDL;
+        return false;
+    }
+
+    LLImageDataSharedLock lock_in(raw_image);
+    LLImageDataLock lock(this);
+
+    const U8* rawdata = raw_image->getData();
+    S32 ncomponents = raw_image->getComponents();
+    S32 width = raw_image->getWidth();
+    S32 height = raw_image->getHeight();
+    if (!rawdata || width <= 0 || height <= 0)
+    {
+        setLastError("LLImageDXT::encodeBlockCompressed: no image data");
+        return false;
+    }
+
+    setSize(width, height, formatComponents(format));
+    mHeaderSize = sizeof(dxtfile_header_t);
+    mFileFormat = format;
+
+    S32 nmips = calcNumMips(width, height);
+    S32 w = width;
+    S32 h = height;
+
+    S32 totbytes = mHeaderSize;
+    for (S32 mip=0; mip<nmips; mip++)
+    {
+        totbytes += formatBytes(format,w,h);
+        w >>= 1;
+        h >>= 1;
+    }
+
+    U8* data = allocateData(totbytes);
+    if (!data)
+    {
+        return false;
+    }
+    dxtfile_header_t* header = (dxtfile_header_t*)data;
+    memset(header, 0, mHeaderSize);
+    header->fourcc = 0x20534444;
+    header->pixel_fmt.fourcc = getFourCC(format);
+    header->num_mips = nmips;
+    header->maxwidth = width;
+    header->maxheight = height;
+
+    // Each mip is box filtered from the previous uncompressed level
+    std::vector<U8> scratch[2];
+    const U8* level = rawdata;
+    w = width, h = height;
+    for (S32 mip=0; mip<nmips; mip++)
+    {
+        if (mip > 0)
+        {
+            std::vector<U8>& mipdata = scratch[mip & 1];
+            mipdata.resize(w * h * ncomponents);
+            generateMip(level, mipdata.data(), w, h, ncomponents);
+            level = mipdata.data();
+        }
+        LLImageBC::compress(bc_format, level, w, h, ncomponents, data + getMipOffset(mip));
+        w >>= 1;
+        h >>= 1;
+    }
+
+    return true;
+}
+
 // virtual
 bool LLImageDXT::convertToDXR()
 {
@@ -429,6 +512,7 @@ bool LLImageDXT::convertToDXR()
       case FORMAT_DXR3:
       case FORMAT_DXR4:
       case FORMAT_DXR5:
+      case FORMAT_DXR7:
         return false; // nothing to do
       case FORMAT_DXT1: newformat = FORMAT_DXR1; break;
       case FORMAT_DXT2: newformat = FORMAT_DXR2; break;
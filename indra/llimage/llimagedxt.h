@@ -51,6 +51,7 @@ public:
         FORMAT_DXR3,
         FORMAT_DXR4,
         FORMAT_DXR5,
+        FORMAT_DXR7, // BC7 (mode 6 only when encoded here), mips stored as DXR
         FORMAT_NOFILE = 0xff,
     };
 
@@ -96,6 +97,10 @@ private:
     bool encodeDXT(const LLImageRaw* raw_image, F32 decode_time, bool explicit_mips);
 
 public:
+    // Block compresses raw_image and its box filtered mips into one of the
+    // DXR1, DXR5 or DXR7 formats, e.g. for uploading as a compressed texture.
+    bool encodeBlockCompressed(const LLImageRaw* raw_image, EFileFormat format);
+
     LLImageDXT();
 
     /*virtual*/ std::string getExtension() { return std::string("dxt"); }
@@ -113,7 +118,7 @@ public:
     S32 getMipOffset(S32 discard);
 
     EFileFormat getFileFormat() { return mFileFormat; }
-    bool isCompressed() { return (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR5); }
+    bool isCompressed() { return (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR7); }
 
     bool convertToDXR(); // convert from DXT to DXR
 
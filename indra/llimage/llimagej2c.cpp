@@ -27,6 +27,7 @@
 #include "llapr.h"
 #include "lldir.h"
 #include "llimagej2c.h"
+#include "llimagej2clayout.h"
 #include "lltimer.h"
 #include "llmath.h"
 #include "llmemory.h"
@@ -64,6 +65,7 @@ LLImageJ2C::LLImageJ2C() :  LLImageFormatted(IMG_CODEC_J2C),
     for( S32 i = 0; i <= MAX_DISCARD_LEVEL; i++)
     {   // Array size is MAX_DISCARD_LEVEL+1
         mDataSizes[i] = 0;
+        mDataSizeExact[i] = false;
     }
 
     // If that test log has ben requested but not yet created, create it
@@ -121,6 +123,8 @@ bool LLImageJ2C::updateData()
 
     if (res)
     {
+        updateDataSizesFromLayout();
+
         // SJB: override discard based on mMaxBytes elsewhere
         S32 max_bytes = getDataSize(); // mMaxBytes ? mMaxBytes : getDataSize();
         S32 discard = calcDiscardLevelBytes(max_bytes);
@@ -312,12 +316,41 @@ S32 LLImageJ2C::calcDataSize(S32 discard_level)
         while ( level >= 0 )
         {
             mDataSizes[level] = calcDataSizeJ2C(getWidth(), getHeight(), getComponents(), level, mRate);
+            mDataSizeExact[level] = false;
             level--;
         }
     }
     return mDataSizes[discard_level];
 }
 
+void LLImageJ2C::updateDataSizesFromLayout()
+{
+    calcDataSize(0); // estimates for the current size
+
+    LLImageJ2CLayout layout;
+    if (!layout.parse(getData(), getDataSize())
+        || layout.getWidth() != getWidth() || layout.getHeight() != getHeight())
+    {
+        return;
+    }
+
+    // Exact sizes where the packet lengths tell, keeping the table
+    // decreasing with the discard level
+    for (S32 level = MAX_DISCARD_LEVEL; level >= 0; level--)
+    {
+        S32 exact = layout.getDiscardBytes(level);
+        if (exact > 0)
+        {
+            mDataSizes[level] = exact;
+            mDataSizeExact[level] = true;
+        }
+        if (level < MAX_DISCARD_LEVEL && mDataSizes[level] < mDataSizes[level + 1])
+        {
+            mDataSizes[level] = mDataSizes[level + 1];
+        }
+    }
+}
+
 S32 LLImageJ2C::calcDiscardLevelBytes(S32 bytes)
 {
     llassert(bytes >= 0);
@@ -329,8 +362,16 @@ S32 LLImageJ2C::calcDiscardLevelBytes(S32 bytes)
     while (1)
     {
         S32 bytes_needed = calcDataSize(discard_level);
+        if (mDataSizeExact[discard_level])
+        {
+            // read from the codestream, no slack needed
+            if (bytes >= bytes_needed)
+            {
+                break;
+            }
+        }
         // Use TextureReverseByteRange percent (see settings.xml) of the optimal size to qualify as correct rendering for the given discard level
-        if (bytes >= (bytes_needed*LLImage::getReverseByteRangePercent()/100))
+        else if (bytes >= (bytes_needed*LLImage::getReverseByteRangePercent()/100))
         {
             break;
         }
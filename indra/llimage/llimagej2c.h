@@ -85,10 +85,14 @@ protected:
     friend class LLImageCompressionTester;
     void decodeFailed();
     void updateRawDiscardLevel();
+    // Replaces the estimates in mDataSizes with the sizes the codestream's
+    // packet length markers give, where they do
+    void updateDataSizesFromLayout();
 
     S32 mMaxBytes; // Maximum number of bytes of data to use...
 
     S32 mDataSizes[MAX_DISCARD_LEVEL+1];        // Size of data required to reach a given level
+    bool mDataSizeExact[MAX_DISCARD_LEVEL+1];   // mDataSizes entry was read from the codestream
     U32 mAreaUsedForDataSizeCalcs;              // Height * width used to calculate mDataSizes
 
     S8  mRawDiscardLevel;
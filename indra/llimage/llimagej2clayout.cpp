@@ -0,0 +1,516 @@
+/**
+ * @file llimagej2clayout.cpp
+ * @brief Byte layout of JPEG 2000 codestreams, and a model of it for
+ * planning partial texture fetches.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagej2clayout.h"
+#include "llimagej2c.h"
+
+#include <cmath>
+
+namespace
+{
+    // Codestream markers (ITU-T T.800 Annex A)
+    const U16 J2K_SOC = 0xff4f;
+    const U16 J2K_SIZ = 0xff51;
+    const U16 J2K_COD = 0xff52;
+    const U16 J2K_COC = 0xff53;
+    const U16 J2K_PLM = 0xff57;
+    const U16 J2K_PLT = 0xff58;
+    const U16 J2K_POC = 0xff5f;
+    const U16 J2K_PPM = 0xff60;
+    const U16 J2K_PPT = 0xff61;
+    const U16 J2K_SOT = 0xff90;
+    const U16 J2K_SOD = 0xff93;
+
+    // Precincts span the whole resolution unless COD says otherwise
+    const U8 DEFAULT_PRECINCT = 0xff;
+
+    U16 read16(const U8* p)
+    {
+        return (U16)((p[0] << 8) | p[1]);
+    }
+
+    U32 read32(const U8* p)
+    {
+        return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | (U32)p[3];
+    }
+
+    S64 ceil_div(S64 a, S64 b)
+    {
+        return (a + b - 1) / b;
+    }
+}
+
+LLImageJ2CLayout::LLImageJ2CLayout()
+:   mWidth(0),
+    mHeight(0),
+    mOriginX(0),
+    mOriginY(0),
+    mComponents(0),
+    mLevels(0),
+    mLayers(0),
+    mProgression(LRCP),
+    mSingleTile(false),
+    mSupported(false),
+    mHasPacketLengths(false)
+{
+    memset(mSubsamplingX, 1, sizeof(mSubsamplingX));
+    memset(mSubsamplingY, 1, sizeof(mSubsamplingY));
+    memset(mPrecinctSizes, DEFAULT_PRECINCT, sizeof(mPrecinctSizes));
+    memset(mDiscardBytes, 0, sizeof(mDiscardBytes));
+}
+
+bool LLImageJ2CLayout::parse(const U8* data, S32 size)
+{
+    *this = LLImageJ2CLayout();
+    if (!data || size < 4 || read16(data) != J2K_SOC)
+    {
+        return false;
+    }
+
+    S32 pos = 2;
+    if (!parseMainHeader(data, size, pos))
+    {
+        mSupported = false;
+        return false;
+    }
+    parseTileParts(data, size, pos);
+    computeDiscardBytes();
+    return true;
+}
+
+bool LLImageJ2CLayout::parseMainHeader(const U8* data, S32 size, S32& pos)
+{
+    bool have_siz = false;
+    bool have_cod = false;
+    mSupported = true;
+    while (pos + 4 <= size)
+    {
+        U16 marker = read16(data + pos);
+        if (marker == J2K_SOT)
+        {
+            return have_siz && have_cod;
+        }
+        if ((marker & 0xff00) != 0xff00)
+        {
+            return false;
+        }
+        S32 length = read16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size)
+        {
+            return false;
+        }
+        const U8* segment = data + pos + 4;
+        S32 segment_size = length - 2;
+
+        switch (marker)
+        {
+        case J2K_SIZ:
+        {
+            if (segment_size < 38)
+            {
+                return false;
+            }
+            U32 xsiz = read32(segment + 2);
+            U32 ysiz = read32(segment + 6);
+            U32 xosiz = read32(segment + 10);
+            U32 yosiz = read32(segment + 14);
+            U32 xtsiz = read32(segment + 18);
+            U32 ytsiz = read32(segment + 22);
+            U32 xtosiz = read32(segment + 26);
+            U32 ytosiz = read32(segment + 30);
+            S32 components = read16(segment + 34);
+            if (xsiz <= xosiz || ysiz <= yosiz || xsiz > 0x7fffffff || ysiz > 0x7fffffff
+                || components < 1 || segment_size < 36 + components * 3)
+            {
+                return false;
+            }
+            mWidth = (S32)(xsiz - xosiz);
+            mHeight = (S32)(ysiz - yosiz);
+            mOriginX = (S32)xosiz;
+            mOriginY = (S32)yosiz;
+            mComponents = components;
+            mSingleTile = (U64)xtosiz + xtsiz >= xsiz && (U64)ytosiz + ytsiz >= ysiz;
+            if (components > 4)
+            {
+                mSupported = false;
+            }
+            else
+            {
+                for (S32 c = 0; c < components; ++c)
+                {
+                    mSubsamplingX[c] = llmax(segment[36 + c * 3 + 1], (U8)1);
+                    mSubsamplingY[c] = llmax(segment[36 + c * 3 + 2], (U8)1);
+                }
+            }
+            have_siz = true;
+            break;
+        }
+        case J2K_COD:
+        {
+            if (segment_size < 10)
+            {
+                return false;
+            }
+            U8 scod = segment[0];
+            mProgression = segment[1];
+            mLayers = read16(segment + 2);
+            mLevels = segment[5];
+            if (mLevels > 32 || mLayers < 1)
+            {
+                return false;
+            }
+            if (scod & 1)
+            {
+                if (segment_size < 10 + mLevels + 1)
+                {
+                    return false;
+                }
+                memcpy(mPrecinctSizes, segment + 10, mLevels + 1); /* Flawfinder: ignore */
+            }
+            have_cod = true;
+            break;
+        }
+        case J2K_COC:
+        case J2K_POC:
+        case J2K_PPM:
+        case J2K_PLM:
+            // per component coding styles, progression changes and packed
+            // headers change the packet order or lengths; not worked out
+            mSupported = false;
+            break;
+        default:
+            break;
+        }
+        pos += 2 + length;
+    }
+    // ran out of data before the first tile-part
+    return false;
+}
+
+void LLImageJ2CLayout::parseTileParts(const U8* data, S32 size, S32 pos)
+{
+    std::vector<S32> lengths;
+    while (pos + 12 <= size && read16(data + pos) == J2K_SOT)
+    {
+        S32 tile_part_start = pos;
+        U32 psot = read32(data + pos + 6);
+        if (read16(data + pos + 4) != 0)
+        {
+            // only tile 0 of a single tile codestream is laid out
+            mSupported = false;
+            return;
+        }
+        pos += 2 + read16(data + pos + 2);
+
+        // tile-part header, up to the start of data
+        lengths.clear();
+        bool complete = false;
+        while (pos + 2 <= size)
+        {
+            U16 marker = read16(data + pos);
+            if (marker == J2K_SOD)
+            {
+                pos += 2;
+                complete = true;
+                break;
+            }
+            if (pos + 4 > size)
+            {
+                break;
+            }
+            S32 length = read16(data + pos + 2);
+            if (length < 2 || pos + 2 + length > size)
+            {
+                break;
+            }
+            if (marker == J2K_PLT)
+            {
+                // Iplt: packet lengths, 7 bits per byte, most significant first
+                const U8* p = data + pos + 5;
+                const U8* end = data + pos + 2 + length;
+                U32 value = 0;
+                for (; p < end; ++p)
+                {
+                    value = (value << 7) | (*p & 0x7f);
+                    if (!(*p & 0x80))
+                    {
+                        lengths.push_back((S32)value);
+                        value = 0;
+                    }
+                }
+            }
+            else if (marker == J2K_COD || marker == J2K_COC || marker == J2K_POC || marker == J2K_PPT)
+            {
+                mSupported = false;
+                return;
+            }
+            pos += 2 + length;
+        }
+        if (!complete || lengths.empty())
+        {
+            // truncated header, or no packet lengths for this tile-part
+            return;
+        }
+
+        S32 offset = pos;
+        for (S32 length : lengths)
+        {
+            offset += length;
+            mPacketEnds.push_back(offset);
+        }
+        mHasPacketLengths = true;
+
+        if (psot == 0)
+        {
+            // last tile-part, runs to the end of the codestream
+            return;
+        }
+        pos = tile_part_start + (S32)psot;
+        if (psot < 14 || pos < offset)
+        {
+            // lengths do not add up; trust neither
+            mPacketEnds.clear();
+            mSupported = false;
+            return;
+        }
+    }
+}
+
+S32 LLImageJ2CLayout::numPrecincts(S32 component, S32 resolution) const
+{
+    S64 x0 = ceil_div(mOriginX, mSubsamplingX[component]);
+    S64 x1 = ceil_div((S64)mOriginX + mWidth, mSubsamplingX[component]);
+    S64 y0 = ceil_div(mOriginY, mSubsamplingY[component]);
+    S64 y1 = ceil_div((S64)mOriginY + mHeight, mSubsamplingY[component]);
+
+    S64 scale = (S64)1 << (mLevels - resolution);
+    S64 rx0 = ceil_div(x0, scale);
+    S64 rx1 = ceil_div(x1, scale);
+    S64 ry0 = ceil_div(y0, scale);
+    S64 ry1 = ceil_div(y1, scale);
+    if (rx1 <= rx0 || ry1 <= ry0)
+    {
+        return 0;
+    }
+
+    S32 ppx = mPrecinctSizes[resolution] & 0x0f;
+    S32 ppy = mPrecinctSizes[resolution] >> 4;
+    S64 wide = ceil_div(rx1, (S64)1 << ppx) - (rx0 >> ppx);
+    S64 high = ceil_div(ry1, (S64)1 << ppy) - (ry0 >> ppy);
+    return (S32)llmin(wide * high, (S64)0x7fffffff);
+}
+
+void LLImageJ2CLayout::computeDiscardBytes()
+{
+    memset(mDiscardBytes, 0, sizeof(mDiscardBytes));
+    if (!mSupported || !mSingleTile || mPacketEnds.empty()
+        || (mProgression != LRCP && mProgression != RLCP && mProgression != RPCL))
+    {
+        return;
+    }
+
+    S32 resolutions = mLevels + 1;
+    std::vector<S32> precincts(resolutions * mComponents);
+    S64 total = 0;
+    for (S32 r = 0; r < resolutions; ++r)
+    {
+        for (S32 c = 0; c < mComponents; ++c)
+        {
+            S32 count = numPrecincts(c, r);
+            if (mProgression == RPCL && count != numPrecincts(0, r))
+            {
+                // position order across differently sized components is not worked out
+                return;
+            }
+            precincts[r * mComponents + c] = count;
+            total += (S64)count * mLayers;
+        }
+    }
+    if (total < (S64)mPacketEnds.size() || total > 1000000)
+    {
+        // more packet lengths than packets: not the layout we think it is
+        return;
+    }
+
+    S32 max_end[MAX_DISCARD_LEVEL + 1] = { 0 };
+    bool unknown[MAX_DISCARD_LEVEL + 1] = { false };
+    S32 max_resolution[MAX_DISCARD_LEVEL + 1];
+    S32 max_layers[MAX_DISCARD_LEVEL + 1];
+    for (S32 d = 0; d <= MAX_DISCARD_LEVEL; ++d)
+    {
+        max_resolution[d] = mLevels - llmin(d, mLevels);
+        max_layers[d] = layersForDiscard(mLayers, d);
+    }
+
+    S32 index = 0;
+    const S32 known = (S32)mPacketEnds.size();
+    auto packet = [&](S32 layer, S32 resolution)
+    {
+        for (S32 d = 0; d <= MAX_DISCARD_LEVEL; ++d)
+        {
+            if (layer < max_layers[d] && resolution <= max_resolution[d])
+            {
+                if (index < known)
+                {
+                    max_end[d] = llmax(max_end[d], mPacketEnds[index]);
+                }
+                else
+                {
+                    unknown[d] = true;
+                }
+            }
+        }
+        ++index;
+    };
+
+    switch (mProgression)
+    {
+    case LRCP:
+        for (S32 l = 0; l < mLayers; ++l)
+            for (S32 r = 0; r < resolutions; ++r)
+                for (S32 c = 0; c < mComponents; ++c)
+                    for (S32 p = 0; p < precincts[r * mComponents + c]; ++p)
+                        packet(l, r);
+        break;
+    case RLCP:
+        for (S32 r = 0; r < resolutions; ++r)
+            for (S32 l = 0; l < mLayers; ++l)
+                for (S32 c = 0; c < mComponents; ++c)
+                    for (S32 p = 0; p < precincts[r * mComponents + c]; ++p)
+                        packet(l, r);
+        break;
+    case RPCL:
+        for (S32 r = 0; r < resolutions; ++r)
+            for (S32 p = 0; p < precincts[r * mComponents]; ++p)
+                for (S32 c = 0; c < mComponents; ++c)
+                    for (S32 l = 0; l < mLayers; ++l)
+                        packet(l, r);
+        break;
+    }
+
+    for (S32 d = 0; d <= MAX_DISCARD_LEVEL; ++d)
+    {
+        mDiscardBytes[d] = unknown[d] ? 0 : max_end[d];
+    }
+}
+
+S32 LLImageJ2CLayout::getDiscardBytes(S32 discard_level) const
+{
+    if (discard_level < 0 || discard_level > MAX_DISCARD_LEVEL)
+    {
+        return 0;
+    }
+    return mDiscardBytes[discard_level];
+}
+
+//static
+S32 LLImageJ2CLayout::layersForDiscard(S32 layers, S32 discard_level)
+{
+    return llclamp(MAX_DISCARD_LEVEL + 1 - discard_level, 1, llmax(layers, 1));
+}
+
+//-----------------------------------------------------------------------------
+
+LLImageJ2CByteModel::LLImageJ2CByteModel()
+:   mSamples(0)
+{
+}
+
+//static
+U32 LLImageJ2CByteModel::getKey(S32 width, S32 height, S32 components, S32 discard_level)
+{
+    U32 log_w = 0;
+    while (log_w < 31 && (1 << (log_w + 1)) <= width)
+    {
+        ++log_w;
+    }
+    U32 log_h = 0;
+    while (log_h < 31 && (1 << (log_h + 1)) <= height)
+    {
+        ++log_h;
+    }
+    return log_w | (log_h << 5) | ((U32)llclamp(components, 0, 7) << 10) | ((U32)discard_level << 13);
+}
+
+void LLImageJ2CByteModel::learn(const LLImageJ2CLayout& layout)
+{
+    S32 w = layout.getWidth();
+    S32 h = layout.getHeight();
+    S32 c = layout.getComponents();
+    if (w <= 0 || h <= 0 || c <= 0)
+    {
+        return;
+    }
+
+    LLMutexLock lock(&mMutex);
+    bool learned = false;
+    for (S32 d = 0; d <= MAX_DISCARD_LEVEL; ++d)
+    {
+        S32 exact = layout.getDiscardBytes(d);
+        if (exact <= 0)
+        {
+            continue;
+        }
+        F64 ratio = (F64)exact / (F64)LLImageJ2C::calcDataSizeJ2C(w, h, c, d);
+        Stats& stats = mStats[getKey(w, h, c, d)];
+        ++stats.mCount;
+        stats.mSum += ratio;
+        stats.mSumSq += ratio * ratio;
+        learned = true;
+    }
+    if (learned)
+    {
+        ++mSamples;
+    }
+}
+
+S32 LLImageJ2CByteModel::predict(S32 width, S32 height, S32 components, S32 discard_level) const
+{
+    S32 estimate = LLImageJ2C::calcDataSizeJ2C(width, height, components, discard_level);
+    F64 ratio = 1.0;
+    {
+        LLMutexLock lock(&mMutex);
+        stats_map_t::const_iterator iter = mStats.find(getKey(width, height, components, discard_level));
+        if (iter == mStats.end() || iter->second.mCount < MIN_SAMPLES)
+        {
+            return estimate;
+        }
+        const Stats& stats = iter->second;
+        F64 mean = stats.mSum / stats.mCount;
+        F64 variance = llmax(stats.mSumSq / stats.mCount - mean * mean, 0.0);
+        ratio = mean + 2.0 * sqrt(variance);
+    }
+    return llmax((S32)ceil(estimate * ratio), LLImageJ2C::calcHeaderSizeJ2C());
+}
+
+U32 LLImageJ2CByteModel::getSamples() const
+{
+    LLMutexLock lock(&mMutex);
+    return mSamples;
+}
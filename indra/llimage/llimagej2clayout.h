@@ -0,0 +1,143 @@
+/**
+ * @file llimagej2clayout.h
+ * @brief Byte layout of JPEG 2000 codestreams, and a model of it for
+ * planning partial texture fetches.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEJ2CLAYOUT_H
+#define LL_LLIMAGEJ2CLAYOUT_H
+
+#include "llimage.h"
+#include "llmutex.h"
+
+#include <map>
+
+// Where the packets of a JPEG 2000 codestream are, read from its markers
+// (SIZ, COD, SOT and PLT) without decoding anything.
+//
+// Discard level d needs the packets of resolution levels up to
+// levels - d, in the first layersForDiscard(d) quality layers: the same
+// quality LLImageJ2C::calcDataSizeJ2C() aims for.  When the codestream has
+// packet length markers this gives the exact number of bytes to fetch for
+// each discard level.  That is only possible for single tile codestreams in
+// LRCP, RLCP or RPCL order; getDiscardBytes() returns 0 otherwise.
+//
+// Parsing works on a truncated codestream, such as the first bytes of a
+// texture in the cache: discard levels whose packets lie in tile-parts that
+// have not been read yet are unknown.
+class LLImageJ2CLayout
+{
+public:
+    enum EProgression
+    {
+        LRCP = 0,
+        RLCP = 1,
+        RPCL = 2,
+        PCRL = 3,
+        CPRL = 4
+    };
+
+    LLImageJ2CLayout();
+
+    // Returns false if data does not hold a complete, valid main header
+    bool parse(const U8* data, S32 size);
+
+    S32 getWidth() const { return mWidth; }
+    S32 getHeight() const { return mHeight; }
+    S32 getComponents() const { return mComponents; }
+    S32 getLevels() const { return mLevels; }
+    S32 getLayers() const { return mLayers; }
+    S32 getProgression() const { return mProgression; }
+    S32 getNumPackets() const { return (S32)mPacketEnds.size(); }
+    bool hasPacketLengths() const { return mHasPacketLengths; }
+
+    // Bytes from the start of the codestream that hold every packet needed
+    // for discard_level, or 0 if unknown
+    S32 getDiscardBytes(S32 discard_level) const;
+
+    // Quality layers calcDataSizeJ2C() assumes for a discard level
+    static S32 layersForDiscard(S32 layers, S32 discard_level);
+
+private:
+    bool parseMainHeader(const U8* data, S32 size, S32& pos);
+    void parseTileParts(const U8* data, S32 size, S32 pos);
+    void computeDiscardBytes();
+    S32 numPrecincts(S32 component, S32 resolution) const;
+
+    S32 mWidth;
+    S32 mHeight;
+    S32 mOriginX;
+    S32 mOriginY;
+    S32 mComponents;
+    S32 mLevels;
+    S32 mLayers;
+    S32 mProgression;
+    bool mSingleTile;
+    bool mSupported;            // false for layouts the packet order is not worked out for
+    bool mHasPacketLengths;
+    U8 mSubsamplingX[4];
+    U8 mSubsamplingY[4];
+    U8 mPrecinctSizes[33];      // log2 sizes, low nibble x, high nibble y, per resolution
+    std::vector<S32> mPacketEnds;   // end offset of each packet, in codestream order
+    S32 mDiscardBytes[MAX_DISCARD_LEVEL + 1];
+};
+
+// Learns how many bytes each discard level really takes, relative to the
+// calcDataSizeJ2C() estimate, from the layouts of textures already fetched,
+// grouped by power of two size and component count.  Once a group has
+// enough samples, predictions use the mean ratio plus two standard deviations,
+// so most fetches need a single request without fetching much more than
+// needed.  Thread safe.
+class LLImageJ2CByteModel
+{
+public:
+    LLImageJ2CByteModel();
+
+    // Adds the exact per discard sizes of layout, if it has any
+    void learn(const LLImageJ2CLayout& layout);
+    // Bytes to fetch for discard_level of an image, from the estimate and
+    // what was learned about images like it
+    S32 predict(S32 width, S32 height, S32 components, S32 discard_level) const;
+
+    U32 getSamples() const;
+
+    static constexpr U32 MIN_SAMPLES = 8;
+
+private:
+    struct Stats
+    {
+        U32 mCount = 0;
+        F64 mSum = 0.0;
+        F64 mSumSq = 0.0;
+    };
+    typedef std::map<U32, Stats> stats_map_t;
+
+    static U32 getKey(S32 width, S32 height, S32 components, S32 discard_level);
+
+    mutable LLMutex mMutex;
+    stats_map_t mStats;
+    U32 mSamples;
+};
+
+#endif // LL_LLIMAGEJ2CLAYOUT_H
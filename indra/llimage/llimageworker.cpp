@@ -28,13 +28,49 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "cpubudget.h"
 #include "threadpool.h"
 
+/*--------------------------------------------------------------------------*/
+// Threads reserved for the decodes of one request, offered to the codec
+// through LLImage::setThreadDecodeThreads() and given back when done.
+class DecodeThreadReservation
+{
+public:
+    DecodeThreadReservation(LLImageDecodeThread* owner)
+        : mOwner(owner), mThreads(0)
+    {
+    }
+
+    ~DecodeThreadReservation()
+    {
+        if (mThreads)
+        {
+            LLImage::setThreadDecodeThreads(1);
+            mOwner->releaseThreads(mThreads);
+        }
+    }
+
+    void reserve(S32 pixels)
+    {
+        if (mOwner && !mThreads)
+        {
+            mThreads = mOwner->reserveThreads(pixels);
+            LLImage::setThreadDecodeThreads(mThreads);
+        }
+    }
+
+private:
+    LLImageDecodeThread* mOwner;
+    S32 mThreads;
+};
+
 /*--------------------------------------------------------------------------*/
 class ImageRequest
 {
 public:
-    ImageRequest(const LLPointer<LLImageFormatted>& image,
+    ImageRequest(LLImageDecodeThread* owner,
+                 const LLPointer<LLImageFormatted>& image,
                  S32 discard,
                  bool needs_aux,
                  const LLPointer<LLImageDecodeThread::Responder>& responder,
@@ -45,9 +81,13 @@ public:
     /*virtual*/ void finishRequest(bool completed);
 
 private:
+    // Pixels the decode will produce, at the requested discard level
+    S32 getDecodedPixels() const;
+
     // LLPointers stored in ImageRequest MUST be LLPointer instances rather
     // than references: we need to increment the refcount when storing these.
     // input
+    LLImageDecodeThread* mOwner;
     LLPointer<LLImageFormatted> mFormattedImage;
     S32 mDiscardLevel;
     U32 mRequestId;
@@ -68,6 +108,9 @@ LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
     : mDecodeCount(0)
 {
     mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
+    // decodes share cores with the General pool rather than each pool
+    // assuming it has the machine to itself
+    mThreadPool->shareCpuBudget();
     mThreadPool->start();
 }
 
@@ -102,7 +145,7 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
 
     // Instantiate the ImageRequest right in the lambda, why not?
     bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
+        [req = ImageRequest(this, image, discard, needs_aux, responder, decode_id)]
         () mutable
         {
             auto done = req.processRequest();
@@ -122,18 +165,45 @@ void LLImageDecodeThread::shutdown()
     mThreadPool->close();
 }
 
+// ANY THREAD
+S32 LLImageDecodeThread::reserveThreads(S32 pixels)
+{
+    const S32 wanted = llclamp(pixels / PIXELS_PER_THREAD, 1, MAX_THREADS_PER_DECODE);
+    // The worker runs on its own token; each extra thread takes one more
+    // from the budget every pool shares, and none are waited for
+    LL::CpuBudget& budget = LL::ThreadPoolBase::getCpuBudget();
+    S32 threads = 1;
+    while (threads < wanted && budget.tryAcquire())
+    {
+        ++threads;
+    }
+    return threads;
+}
+
+// ANY THREAD
+void LLImageDecodeThread::releaseThreads(S32 threads)
+{
+    LL::CpuBudget& budget = LL::ThreadPoolBase::getCpuBudget();
+    for (S32 i = 1; i < threads; ++i)
+    {
+        budget.release();
+    }
+}
+
 LLImageDecodeThread::Responder::~Responder()
 {
 }
 
 //----------------------------------------------------------------------------
 
-ImageRequest::ImageRequest(const LLPointer<LLImageFormatted>& image,
+ImageRequest::ImageRequest(LLImageDecodeThread* owner,
+                           const LLPointer<LLImageFormatted>& image,
                            S32 discard,
                            bool needs_aux,
                            const LLPointer<LLImageDecodeThread::Responder>& responder,
                            U32 request_id)
-    : mFormattedImage(image),
+    : mOwner(owner),
+      mFormattedImage(image),
       mDiscardLevel(discard),
       mNeedsAux(needs_aux),
       mDecodedRaw(false),
@@ -167,6 +237,7 @@ bool ImageRequest::processRequest()
     LLImageDataLock lockFormatted(mFormattedImage);
     LLImageDataLock lockDecodedRaw(mDecodedImageRaw);
     LLImageDataLock lockDecodedAux(mDecodedImageAux);
+    DecodeThreadReservation threads(mOwner);
 
     if (!mDecodedRaw)
     {
@@ -191,6 +262,8 @@ bool ImageRequest::processRequest()
                                               mFormattedImage->getComponents());
         }
 
+        threads.reserve(getDecodedPixels());
+
         // <FS:ND> Probably out of memory crash
         // done = mFormattedImage->decode(mDecodedImageRaw, decode_time_slice);
         if( mDecodedImageRaw->getData() )
@@ -218,6 +291,7 @@ bool ImageRequest::processRequest()
                                               mFormattedImage->getHeight(),
                                               1);
         }
+        threads.reserve(getDecodedPixels());
         done = mFormattedImage->decodeChannels(mDecodedImageAux, decode_time_slice, 4, 4);
         mDecodedAux = done && mDecodedImageAux->getData();
 
@@ -228,6 +302,12 @@ bool ImageRequest::processRequest()
     return done;
 }
 
+S32 ImageRequest::getDecodedPixels() const
+{
+    S32 discard = llclamp((S32)mFormattedImage->getDiscardLevel(), 0, 15);
+    return (mFormattedImage->getWidth() >> discard) * (mFormattedImage->getHeight() >> discard);
+}
+
 void ImageRequest::finishRequest(bool completed)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
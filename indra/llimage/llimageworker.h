@@ -56,6 +56,16 @@ public:
     S32 getTotalDecodeCount() { return mDecodeCount; }
     void shutdown();
 
+    // Reserves threads for decoding an image of 'pixels' pixels, counting
+    // the worker running the decode: more for bigger images, each beyond
+    // the first taken from the shared CPU budget while tokens are free.
+    // Returns at least one.  Every reservation must be released.
+    S32 reserveThreads(S32 pixels);
+    void releaseThreads(S32 threads);
+
+    static const S32 MAX_THREADS_PER_DECODE = 4;
+    static const S32 PIXELS_PER_THREAD = 128 * 1024;
+
 private:
     // As of SL-17483, LLImageDecodeThread is no longer itself an
     // LLQueuedThread - instead this is the API by which we submit work to the
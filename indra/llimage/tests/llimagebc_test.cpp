@@ -0,0 +1,221 @@
+/**
+ * @file llimagebc_test.cpp
+ * @brief Quality and throughput tests for the BC1, BC3 and BC7 block encoders.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagebc.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <cmath>
+#include <vector>
+
+namespace tut
+{
+    struct imagebc_data
+    {
+        // Smooth gradients with a little deterministic noise, which is what
+        // photographic textures look like at block scale.
+        static std::vector<U8> makeImage(S32 width, S32 height, S32 components)
+        {
+            std::vector<U8> image(width * height * components);
+            U32 seed = 12345;
+            for (S32 y = 0; y < height; ++y)
+            {
+                for (S32 x = 0; x < width; ++x)
+                {
+                    seed = seed * 1103515245 + 12345;
+                    S32 noise = (S32)((seed >> 16) & 7) - 4;
+                    U8* texel = &image[(y * width + x) * components];
+                    texel[0] = (U8)llclamp(x * 255 / width + noise, 0, 255);
+                    if (components > 1)
+                    {
+                        texel[1] = (U8)llclamp(y * 255 / height + noise, 0, 255);
+                    }
+                    if (components > 2)
+                    {
+                        texel[2] = (U8)llclamp(128 + (S32)(100.f * sinf((x + y) * 0.05f)) + noise, 0, 255);
+                    }
+                    if (components > 3)
+                    {
+                        texel[3] = (U8)llclamp((x ^ y) & 0x80 ? 255 - y : y, 0, 255);
+                    }
+                }
+            }
+            return image;
+        }
+
+        static F64 psnr(const std::vector<U8>& a, const std::vector<U8>& b)
+        {
+            F64 error = 0.0;
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                F64 d = (F64)a[i] - (F64)b[i];
+                error += d * d;
+            }
+            if (error == 0.0)
+            {
+                return 99.0;
+            }
+            F64 mse = error / (F64)a.size();
+            return 10.0 * log10(255.0 * 255.0 / mse);
+        }
+
+        static F64 roundTrip(LLImageBC::EFormat format, S32 width, S32 height, S32 components)
+        {
+            std::vector<U8> image = makeImage(width, height, components);
+            std::vector<U8> blocks(LLImageBC::compressedSize(format, width, height));
+            std::vector<U8> decoded(image.size());
+            LLImageBC::compress(format, image.data(), width, height, components, blocks.data());
+            LLImageBC::decompress(format, blocks.data(), width, height, components, decoded.data());
+            return psnr(image, decoded);
+        }
+    };
+    typedef test_group<imagebc_data> imagebc_test;
+    typedef imagebc_test::object imagebc_object;
+    tut::imagebc_test imagebc_testcase("LLImageBC");
+
+    template<> template<>
+    void imagebc_object::test<1>()
+    {
+        set_test_name("sizes");
+
+        ensure_equals("BC1 block", LLImageBC::blockBytes(LLImageBC::BC1), 8);
+        ensure_equals("BC3 block", LLImageBC::blockBytes(LLImageBC::BC3), 16);
+        ensure_equals("BC7 block", LLImageBC::blockBytes(LLImageBC::BC7), 16);
+        ensure_equals("BC1 256x128", LLImageBC::compressedSize(LLImageBC::BC1, 256, 128), 64 * 32 * 8);
+        ensure_equals("partial blocks", LLImageBC::compressedSize(LLImageBC::BC7, 2, 1), 16);
+    }
+
+    template<> template<>
+    void imagebc_object::test<2>()
+    {
+        set_test_name("flat blocks");
+
+        U8 rgba[64];
+        for (S32 i = 0; i < 16; ++i)
+        {
+            rgba[i * 4 + 0] = 255;
+            rgba[i * 4 + 1] = 0;
+            rgba[i * 4 + 2] = 255;
+            rgba[i * 4 + 3] = 77;
+        }
+        U8 block[16];
+        U8 decoded[64];
+
+        LLImageBC::encodeBC1Block(rgba, block);
+        LLImageBC::decodeBC1Block(block, decoded);
+        ensure_equals("BC1 red", decoded[0], 255);
+        ensure_equals("BC1 green", decoded[1], 0);
+        ensure_equals("BC1 blue", decoded[2], 255);
+        ensure_equals("BC1 opaque", decoded[3], 255);
+
+        LLImageBC::encodeBC3Block(rgba, block);
+        LLImageBC::decodeBC3Block(block, decoded);
+        ensure_equals("BC3 alpha", decoded[63], 77);
+        ensure_equals("BC3 blue", decoded[62], 255);
+
+        LLImageBC::encodeBC7Block(rgba, block);
+        ensure_equals("BC7 mode 6", block[0] & 0x7f, 0x40);
+        LLImageBC::decodeBC7Block(block, decoded);
+        // Endpoints share one low bit across channels, so odd values can be off by one
+        for (S32 i = 0; i < 64; ++i)
+        {
+            ensure("BC7 within 1", llabs((S32)decoded[i] - (S32)rgba[i]) <= 1);
+        }
+    }
+
+    template<> template<>
+    void imagebc_object::test<3>()
+    {
+        set_test_name("BC7 keeps the anchor index in range");
+
+        // Bright first texel fading to dark, so the natural fit puts index 15 first
+        U8 rgba[64];
+        for (S32 i = 0; i < 16; ++i)
+        {
+            U8 v = (U8)(255 - i * 17);
+            rgba[i * 4 + 0] = v;
+            rgba[i * 4 + 1] = v;
+            rgba[i * 4 + 2] = v;
+            rgba[i * 4 + 3] = (U8)(i * 17);
+        }
+        U8 block[16];
+        U8 decoded[64];
+        LLImageBC::encodeBC7Block(rgba, block);
+        LLImageBC::decodeBC7Block(block, decoded);
+        for (S32 i = 0; i < 64; ++i)
+        {
+            ensure("BC7 ramp within 4", llabs((S32)decoded[i] - (S32)rgba[i]) <= 4);
+        }
+    }
+
+    template<> template<>
+    void imagebc_object::test<4>()
+    {
+        set_test_name("PSNR");
+
+        F64 bc1 = roundTrip(LLImageBC::BC1, 256, 256, 3);
+        F64 bc3 = roundTrip(LLImageBC::BC3, 256, 256, 4);
+        F64 bc7 = roundTrip(LLImageBC::BC7, 256, 256, 4);
+        F64 bc7_rgb = roundTrip(LLImageBC::BC7, 256, 256, 3);
+        LL_INFOS() << "PSNR BC1 " << bc1 << " BC3 " << bc3 << " BC7 " << bc7 << " BC7 RGB " << bc7_rgb << LL_ENDL;
+        ensure("BC1 PSNR " + std::to_string(bc1), bc1 > 32.0);
+        ensure("BC3 PSNR " + std::to_string(bc3), bc3 > 32.0);
+        ensure("BC7 PSNR " + std::to_string(bc7), bc7 > 36.0);
+        ensure("BC7 beats BC1 on RGB", bc7_rgb > bc1);
+        // Odd sizes go through the edge clamping
+        ensure("BC1 odd size", roundTrip(LLImageBC::BC1, 2, 1, 3) > 32.0);
+        ensure("BC3 luminance alpha", roundTrip(LLImageBC::BC3, 64, 32, 2) > 32.0);
+    }
+
+    template<> template<>
+    void imagebc_object::test<5>()
+    {
+        set_test_name("throughput");
+
+        const S32 size = 512;
+        std::vector<U8> rgb = makeImage(size, size, 3);
+        std::vector<U8> rgba = makeImage(size, size, 4);
+        std::vector<U8> blocks(LLImageBC::compressedSize(LLImageBC::BC7, size, size));
+
+        LLTimer timer;
+        LLImageBC::compress(LLImageBC::BC1, rgb.data(), size, size, 3, blocks.data());
+        F64 bc1 = timer.getElapsedTimeAndResetF64();
+        LLImageBC::compress(LLImageBC::BC3, rgba.data(), size, size, 4, blocks.data());
+        F64 bc3 = timer.getElapsedTimeAndResetF64();
+        LLImageBC::compress(LLImageBC::BC7, rgba.data(), size, size, 4, blocks.data());
+        F64 bc7 = timer.getElapsedTimeAndResetF64();
+
+        F64 mpixels = (F64)(size * size) / 1000000.0;
+        LL_INFOS() << "Block compression Mpixels/s: BC1 " << mpixels / llmax(bc1, 1e-6)
+                   << " BC3 " << mpixels / llmax(bc3, 1e-6)
+                   << " BC7 " << mpixels / llmax(bc7, 1e-6) << LL_ENDL;
+        // Generous bound: a 512x512 texture must never stall the worker for long
+        ensure("BC7 512x512 under 5 seconds", bc7 < 5.0);
+    }
+}
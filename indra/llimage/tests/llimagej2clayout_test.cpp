@@ -0,0 +1,511 @@
+/**
+ * @file llimagej2clayout_test.cpp
+ * @brief Tests and fetch planning benchmark for LLImageJ2CLayout
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagej2clayout.h"
+#include "../llimagej2c.h"
+
+#include "../test/lltut.h"
+
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+
+S32 LLImageJ2C::calcHeaderSizeJ2C()
+{
+    return FIRST_PACKET_SIZE;
+}
+
+// Same estimate as LLImageJ2C::calcDataSizeJ2C(), so that the benchmark
+// below compares against what the viewer requests today
+S32 LLImageJ2C::calcDataSizeJ2C(S32 w, S32 h, S32 comp, S32 discard_level, F32 rate)
+{
+    S32 nb_layers = 1;
+    const S32 surface = w * h;
+    S32 s = 64 * 64;
+    S32 totalbytes = (S32)(s * 4 * 8 * rate);
+    while (surface > s)
+    {
+        if (nb_layers <= (5 - discard_level))
+            totalbytes += (S32)(s * 4 * 8 * rate);
+        nb_layers++;
+        s *= 4;
+    }
+    return totalbytes / 8 + calcHeaderSizeJ2C();
+}
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct imagej2clayout_data
+    {
+        // Writes a single tile codestream with one precinct per resolution
+        // and component.  Packet bodies are zero filled: only their lengths
+        // matter to the layout.  With tile_part_per_layer, each quality layer
+        // goes in a tile-part of its own, which needs LRCP order.
+        struct Codestream
+        {
+            S32 mWidth = 64;
+            S32 mHeight = 64;
+            S32 mComponents = 1;
+            S32 mLevels = 1;
+            S32 mLayers = 2;
+            S32 mProgression = LLImageJ2CLayout::LRCP;
+            bool mPacketLengths = true;
+            bool mTilePartPerLayer = false;
+            bool mComponentStyle = false;
+            std::vector<S32> mPacketSizes;  // in codestream order
+
+            std::vector<U8> mData;
+            std::vector<S32> mPacketEnds;
+
+            void put8(U32 v) { mData.push_back((U8)v); }
+            void put16(U32 v) { put8(v >> 8); put8(v); }
+            void put32(U32 v) { put16(v >> 16); put16(v); }
+
+            const std::vector<U8>& build()
+            {
+                mData.clear();
+                mPacketEnds.clear();
+                put16(0xff4f);
+
+                put16(0xff51);                  // SIZ
+                put16(38 + 3 * mComponents);
+                put16(0);
+                put32(mWidth);
+                put32(mHeight);
+                put32(0);
+                put32(0);
+                put32(mWidth);
+                put32(mHeight);
+                put32(0);
+                put32(0);
+                put16(mComponents);
+                for (S32 c = 0; c < mComponents; ++c)
+                {
+                    put8(7);
+                    put8(1);
+                    put8(1);
+                }
+
+                put16(0xff52);                  // COD
+                put16(12);
+                put8(0);
+                put8(mProgression);
+                put16(mLayers);
+                put8(mComponents >= 3 ? 1 : 0);
+                put8(mLevels);
+                put8(4);
+                put8(4);
+                put8(0);
+                put8(1);
+
+                if (mComponentStyle)
+                {
+                    put16(0xff53);              // COC
+                    put16(9);
+                    put8(0);
+                    put8(0);
+                    put8(mLevels);
+                    put8(4);
+                    put8(4);
+                    put8(0);
+                    put8(1);
+                }
+
+                S32 packets_per_part = mTilePartPerLayer ? (S32)mPacketSizes.size() / mLayers : (S32)mPacketSizes.size();
+                S32 parts = (S32)mPacketSizes.size() / packets_per_part;
+                for (S32 part = 0; part < parts; ++part)
+                {
+                    size_t sot = mData.size();
+                    put16(0xff90);              // SOT
+                    put16(10);
+                    put16(0);
+                    put32(0);                   // Psot, filled in below
+                    put8(part);
+                    put8(parts);
+
+                    if (mPacketLengths)
+                    {
+                        std::vector<U8> lengths;
+                        for (S32 i = 0; i < packets_per_part; ++i)
+                        {
+                            U32 length = mPacketSizes[part * packets_per_part + i];
+                            U8 bytes[5];
+                            S32 count = 0;
+                            do
+                            {
+                                bytes[count++] = length & 0x7f;
+                                length >>= 7;
+                            } while (length);
+                            while (count--)
+                            {
+                                lengths.push_back(bytes[count] | (count ? 0x80 : 0));
+                            }
+                        }
+                        put16(0xff58);          // PLT
+                        put16(3 + (U32)lengths.size());
+                        put8(0);
+                        mData.insert(mData.end(), lengths.begin(), lengths.end());
+                    }
+
+                    put16(0xff93);              // SOD
+                    for (S32 i = 0; i < packets_per_part; ++i)
+                    {
+                        mData.resize(mData.size() + mPacketSizes[part * packets_per_part + i], 0);
+                        mPacketEnds.push_back((S32)mData.size());
+                    }
+
+                    U32 psot = (U32)(mData.size() - sot);
+                    mData[sot + 6] = (U8)(psot >> 24);
+                    mData[sot + 7] = (U8)(psot >> 16);
+                    mData[sot + 8] = (U8)(psot >> 8);
+                    mData[sot + 9] = (U8)psot;
+                }
+                put16(0xffd9);
+                return mData;
+            }
+        };
+
+        static U32 random(U32& seed)
+        {
+            seed = seed * 1103515245 + 12345;
+            return seed >> 8;
+        }
+
+        // Packet sizes for a texture of the given detail in bits per
+        // sample, layered the way the viewer uploads: one quality layer per
+        // fourfold step in area above 64x64, layer l bringing resolutions up
+        // to 64 << l pixels wide to full quality.  Most of a resolution's
+        // bytes go in the first layer that reaches it, the rest refines it
+        // in later layers, and earlier layers leave it empty.
+        static void fillPackets(Codestream& cs, F64 bits_per_sample, U32& seed)
+        {
+            cs.mLayers = 1;
+            for (S32 s = 64 * 64; cs.mWidth * cs.mHeight > s; s *= 4)
+            {
+                ++cs.mLayers;
+            }
+            auto size = [&](S32 l, S32 r)
+            {
+                S32 first_layer = llmax(0, r - (cs.mLevels - cs.mLayers + 1));
+                if (l < first_layer)
+                {
+                    return 1;
+                }
+                F64 samples = (F64)cs.mWidth * cs.mHeight / (F64)(1 << (2 * (cs.mLevels - r)));
+                if (r > 0)
+                {
+                    samples *= 0.75;
+                }
+                S32 later = cs.mLayers - 1 - first_layer;
+                F64 share = later == 0 ? 1.0 : (l == first_layer ? 0.7 : 0.3 / later);
+                F64 noise = 0.8 + 0.4 * (random(seed) % 1000) / 1000.0;
+                return llmax(1, (S32)(samples * bits_per_sample / 8.0 * share * noise));
+            };
+            // LRCP with one precinct per resolution and component
+            cs.mPacketSizes.clear();
+            for (S32 l = 0; l < cs.mLayers; ++l)
+                for (S32 r = 0; r <= cs.mLevels; ++r)
+                    for (S32 c = 0; c < cs.mComponents; ++c)
+                        cs.mPacketSizes.push_back(size(l, r));
+        }
+    };
+    typedef test_group<imagej2clayout_data> imagej2clayout_test;
+    typedef imagej2clayout_test::object imagej2clayout_object;
+    tut::imagej2clayout_test imagej2clayout_testcase("LLImageJ2CLayout");
+
+    template<> template<>
+    void imagej2clayout_object::test<1>()
+    {
+        set_test_name("main header and LRCP discard bytes");
+
+        // 2 layers, 2 resolutions, 1 component: packets (l,r) in order
+        // (0,0) (0,1) (1,0) (1,1)
+        Codestream cs;
+        cs.mPacketSizes = { 100, 200, 300, 400 };
+        const std::vector<U8>& data = cs.build();
+
+        LLImageJ2CLayout layout;
+        ensure("parsed", layout.parse(data.data(), (S32)data.size()));
+        ensure_equals("width", layout.getWidth(), 64);
+        ensure_equals("height", layout.getHeight(), 64);
+        ensure_equals("components", layout.getComponents(), 1);
+        ensure_equals("levels", layout.getLevels(), 1);
+        ensure_equals("layers", layout.getLayers(), 2);
+        ensure("packet lengths", layout.hasPacketLengths());
+        ensure_equals("packets", layout.getNumPackets(), 4);
+
+        ensure_equals("discard 0: everything", layout.getDiscardBytes(0), cs.mPacketEnds[3]);
+        ensure_equals("discard 1: both layers of resolution 0", layout.getDiscardBytes(1), cs.mPacketEnds[2]);
+        ensure_equals("discard 4: both layers of resolution 0", layout.getDiscardBytes(4), cs.mPacketEnds[2]);
+        ensure_equals("discard 5: first layer of resolution 0", layout.getDiscardBytes(5), cs.mPacketEnds[0]);
+        ensure_equals("out of range", layout.getDiscardBytes(6), 0);
+    }
+
+    template<> template<>
+    void imagej2clayout_object::test<2>()
+    {
+        set_test_name("RLCP order, and a header only read");
+
+        // packets (l,r) in order (0,0) (1,0) (0,1) (1,1)
+        Codestream cs;
+        cs.mProgression = LLImageJ2CLayout::RLCP;
+        cs.mPacketSizes = { 100, 200, 300, 400 };
+        const std::vector<U8>& data = cs.build();
+
+        LLImageJ2CLayout layout;
+        ensure("parsed", layout.parse(data.data(), (S32)data.size()));
+        ensure_equals("discard 0", layout.getDiscardBytes(0), cs.mPacketEnds[3]);
+        ensure_equals("discard 1", layout.getDiscardBytes(1), cs.mPacketEnds[1]);
+        ensure_equals("discard 5", layout.getDiscardBytes(5), cs.mPacketEnds[0]);
+
+        // The packet lengths are all in the tile-part header, so the first
+        // bytes of the file are enough to plan every discard level
+        LLImageJ2CLayout head;
+        S32 header_size = cs.mPacketEnds[0] - cs.mPacketSizes[0];
+        ensure("header parsed", head.parse(data.data(), header_size));
+        for (S32 d = 0; d <= MAX_DISCARD_LEVEL; ++d)
+        {
+            ensure_equals("same from the header", head.getDiscardBytes(d), layout.getDiscardBytes(d));
+        }
+    }
+
+    template<> template<>
+    void imagej2clayout_object::test<3>()
+    {
+        set_test_name("one tile-part per layer, truncated");
+
+        Codestream cs;
+        cs.mTilePartPerLayer = true;
+        cs.mPacketSizes = { 100, 200, 300, 400 };
+        const std::vector<U8>& data = cs.build();
+
+        LLImageJ2CLayout layout;
+        ensure("parsed", layout.parse(data.data(), (S32)data.size()));
+        ensure_equals("packets", layout.getNumPackets(), 4);
+        ensure_equals("discard 0", layout.getDiscardBytes(0), cs.mPacketEnds[3]);
+        ensure_equals("discard 1", layout.getDiscardBytes(1), cs.mPacketEnds[2]);
+        ensure_equals("discard 5", layout.getDiscardBytes(5), cs.mPacketEnds[0]);
+
+        // Only the first tile-part read: the second layer is not known yet
+        LLImageJ2CLayout head;
+        ensure("head parsed", head.parse(data.data(), cs.mPacketEnds[1]));
+        ensure_equals("head packets", head.getNumPackets(), 2);
+        ensure_equals("discard 0 unknown", head.getDiscardBytes(0), 0);
+        ensure_equals("discard 1 unknown", head.getDiscardBytes(1), 0);
+        ensure_equals("discard 5 known", head.getDiscardBytes(5), cs.mPacketEnds[0]);
+    }
+
+    template<> template<>
+    void imagej2clayout_object::test<4>()
+    {
+        set_test_name("layouts that cannot be planned");
+
+        LLImageJ2CLayout layout;
+        ensure("null", !layout.parse(NULL, 0));
+        const U8 junk[] = { 0x12, 0x34, 0x56, 0x78, 0x9a };
+        ensure("not a codestream", !layout.parse(junk, sizeof(junk)));
+
+        Codestream cs;
+        cs.mPacketSizes = { 100, 200, 300, 400 };
+        const std::vector<U8>& full = cs.build();
+        ensure("main header cut short", !layout.parse(full.data(), 20));
+
+        cs.mPacketLengths = false;
+        const std::vector<U8>& no_plt = cs.build();
+        ensure("parsed without packet lengths", layout.parse(no_plt.data(), (S32)no_plt.size()));
+        ensure("no packet lengths", !layout.hasPacketLengths());
+        ensure_equals("no packet lengths, no sizes", layout.getDiscardBytes(0), 0);
+
+        cs.mPacketLengths = true;
+        cs.mComponentStyle = true;
+        const std::vector<U8>& coc = cs.build();
+        ensure("parsed with COC", layout.parse(coc.data(), (S32)coc.size()));
+        ensure_equals("per component style, no sizes", layout.getDiscardBytes(0), 0);
+
+        cs.mComponentStyle = false;
+        cs.mProgression = LLImageJ2CLayout::CPRL;
+        const std::vector<U8>& cprl = cs.build();
+        ensure("parsed CPRL", layout.parse(cprl.data(), (S32)cprl.size()));
+        ensure_equals("CPRL, no sizes", layout.getDiscardBytes(0), 0);
+
+        cs.mProgression = LLImageJ2CLayout::LRCP;
+        cs.mPacketSizes = { 100, 200, 300, 400, 500 };
+        const std::vector<U8>& extra = cs.build();
+        ensure("parsed extra packets", layout.parse(extra.data(), (S32)extra.size()));
+        ensure_equals("more lengths than packets, no sizes", layout.getDiscardBytes(0), 0);
+    }
+
+    template<> template<>
+    void imagej2clayout_object::test<5>()
+    {
+        set_test_name("byte model");
+
+        LLImageJ2CByteModel model;
+        const S32 estimate = LLImageJ2C::calcDataSizeJ2C(256, 256, 3, 2);
+        ensure_equals("no samples: the estimate", model.predict(256, 256, 3, 2), estimate);
+
+        U32 seed = 99;
+        S32 largest = 0;
+        for (U32 i = 0; i < LLImageJ2CByteModel::MIN_SAMPLES; ++i)
+        {
+            Codestream cs;
+            cs.mWidth = 256;
+            cs.mHeight = 256;
+            cs.mComponents = 3;
+            cs.mLevels = 5;
+            fillPackets(cs, 1.0, seed);
+            const std::vector<U8>& data = cs.build();
+            LLImageJ2CLayout layout;
+            ensure("parsed", layout.parse(data.data(), (S32)data.size()));
+            ensure("exact", layout.getDiscardBytes(2) > 0);
+            largest = llmax(largest, layout.getDiscardBytes(2));
+            model.learn(layout);
+            if (i + 1 < LLImageJ2CByteModel::MIN_SAMPLES)
+            {
+                ensure_equals("too few samples", model.predict(256, 256, 3, 2), estimate);
+            }
+        }
+        ensure_equals("samples", model.getSamples(), LLImageJ2CByteModel::MIN_SAMPLES);
+
+        S32 predicted = model.predict(256, 256, 3, 2);
+        ensure("learned", predicted != estimate);
+        ensure("covers most textures", predicted >= largest * 9 / 10);
+        ensure("not far over", predicted <= largest * 5 / 4);
+        ensure_equals("other sizes untouched", model.predict(512, 256, 3, 2),
+                      LLImageJ2C::calcDataSizeJ2C(512, 256, 3, 2));
+    }
+
+    template<> template<>
+    void imagej2clayout_object::test<6>()
+    {
+        set_test_name("fetch planning benchmark");
+
+        // A fetch log: each texture is first wanted at a coarse discard
+        // level, with nothing cached, then at a finer one as the camera gets
+        // closer.  Compares requesting calcDataSizeJ2C() bytes against
+        // planning from the layout (once the header is cached) or the byte
+        // model (before).  A fetch that stops short of the bytes the discard
+        // level needs takes a second request for the rest.
+        struct Totals
+        {
+            S64 mBytes = 0;
+            S64 mNeeded = 0;
+            S32 mRequests = 0;
+            S32 mFetches = 0;
+        };
+        auto fetch = [](Totals& totals, S32& have, S32 request, S32 needed, S32 file_size)
+        {
+            ++totals.mFetches;
+            totals.mNeeded += needed - llmin(have, needed);
+            if (have >= needed)
+            {
+                return;
+            }
+            request = llmin(request, file_size);
+            if (request > have)
+            {
+                totals.mBytes += request - have;
+                ++totals.mRequests;
+                have = request;
+            }
+            if (have < needed)
+            {
+                totals.mBytes += needed - have;
+                ++totals.mRequests;
+                have = needed;
+            }
+        };
+
+        const S32 NUM_TEXTURES = 2000;
+        U32 seed = 2026;
+        LLImageJ2CByteModel model;
+        Totals heuristic;
+        Totals planned;
+        S32 exact_plans = 0;
+        for (S32 i = 0; i < NUM_TEXTURES; ++i)
+        {
+            Codestream cs;
+            cs.mWidth = 64 << (random(seed) % 5);
+            cs.mHeight = 64 << (random(seed) % 5);
+            cs.mComponents = (random(seed) % 3) == 0 ? 4 : 3;
+            cs.mLevels = 5;
+            // mostly photographic detail, some flat colour
+            F64 bits = (random(seed) % 5) == 0 ? 0.2 : 0.5 + (random(seed) % 100) / 40.0;
+            fillPackets(cs, bits, seed);
+            const std::vector<U8>& data = cs.build();
+            const S32 file_size = (S32)data.size();
+
+            LLImageJ2CLayout truth;
+            truth.parse(data.data(), file_size);
+
+            const S32 w = cs.mWidth;
+            const S32 h = cs.mHeight;
+            const S32 c = cs.mComponents;
+            const S32 first = 2 + random(seed) % 3;
+            const S32 second = random(seed) % 2;
+
+            S32 have = 0;
+            fetch(heuristic, have, LLImageJ2C::calcDataSizeJ2C(w, h, c, first), truth.getDiscardBytes(first), file_size);
+            fetch(heuristic, have, LLImageJ2C::calcDataSizeJ2C(w, h, c, second), truth.getDiscardBytes(second), file_size);
+
+            have = 0;
+            fetch(planned, have, model.predict(w, h, c, first), truth.getDiscardBytes(first), file_size);
+            LLImageJ2CLayout cached;
+            S32 request = model.predict(w, h, c, second);
+            if (cached.parse(data.data(), have))
+            {
+                model.learn(cached);
+                if (cached.getDiscardBytes(second) > 0)
+                {
+                    request = cached.getDiscardBytes(second);
+                    ++exact_plans;
+                }
+            }
+            fetch(planned, have, request, truth.getDiscardBytes(second), file_size);
+        }
+
+        F64 heuristic_bytes = (F64)heuristic.mBytes / NUM_TEXTURES;
+        F64 planned_bytes = (F64)planned.mBytes / NUM_TEXTURES;
+        F64 needed_bytes = (F64)heuristic.mNeeded / NUM_TEXTURES;
+        F64 heuristic_requests = (F64)heuristic.mRequests / NUM_TEXTURES;
+        F64 planned_requests = (F64)planned.mRequests / NUM_TEXTURES;
+        LL_INFOS() << "Fetch log of " << NUM_TEXTURES << " textures, " << needed_bytes << " bytes needed per texture" << LL_ENDL;
+        LL_INFOS() << "calcDataSizeJ2C: " << heuristic_bytes << " bytes and " << heuristic_requests
+                   << " requests per texture" << LL_ENDL;
+        LL_INFOS() << "Layout planned: " << planned_bytes << " bytes and " << planned_requests
+                   << " requests per texture, " << exact_plans << " exact plans" << LL_ENDL;
+
+        ensure_equals("every cached header planned exactly", exact_plans, NUM_TEXTURES);
+        ensure("fewer requests", planned_requests < heuristic_requests);
+        ensure("fewer bytes", planned_bytes < heuristic_bytes);
+    }
+}
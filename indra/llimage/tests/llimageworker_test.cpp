@@ -33,6 +33,9 @@
 #include "../llcommon/lltimer.h"
 // for lltrace class
 #include "../llcommon/lltrace.h"
+// for the shared CPU budget
+#include "../llcommon/cpubudget.h"
+#include "../llcommon/threadpool.h"
 // Tut header
 #include "../test/lltut.h"
 
@@ -69,6 +72,7 @@ U8* LLImageRaw::reallocateData(S32 size) { return NULL; }
 const U8* LLImageBase::getData() const { return NULL; }
 U8* LLImageBase::getData() { return NULL; }
 const std::string& LLImage::getLastThreadError() { static std::string msg; return msg; }
+thread_local S32 LLImage::sThreadDecodeThreads = 1;
 
 // End Stubbing
 // -------------------------------------------------------------------------------------------
@@ -166,4 +170,39 @@ namespace tut
         // Verifies that the responder has now been called
         ensure("LLImageDecodeThread: threaded work unit not processed", done == true);
     }
+
+    template<> template<>
+    void imagedecodethread_object_t::test<2>()
+    {
+        // Threads beyond a decode's worker come out of the shared CPU budget
+        mThread = new LLImageDecodeThread(true);
+        LL::CpuBudget& budget = LL::ThreadPoolBase::getCpuBudget();
+        const size_t busy = budget.getBusy();
+        const S32 big = 2048 * 2048;
+        ensure_equals("small images decode on their worker only", mThread->reserveThreads(64 * 64), 1);
+        mThread->releaseThreads(1);
+        ensure_equals("small images take no tokens", budget.getBusy(), busy);
+
+        S32 first = mThread->reserveThreads(big);
+        ensure("big images get more threads", first >= 1 && first <= LLImageDecodeThread::MAX_THREADS_PER_DECODE);
+        ensure_equals("extra threads hold tokens", budget.getBusy(), busy + first - 1);
+
+        // Once the budget is spent every decode runs on its worker alone
+        std::vector<S32> reservations(1, first);
+        for (S32 i = 0; i < 64; ++i)
+        {
+            reservations.push_back(mThread->reserveThreads(big));
+        }
+        ensure_equals("over budget", reservations.back(), 1);
+        ensure("never more threads than the budget", budget.getBusy() <= budget.getWidth());
+
+        for (S32 threads : reservations)
+        {
+            mThread->releaseThreads(threads);
+        }
+        ensure_equals("tokens given back", budget.getBusy(), busy);
+        S32 again = mThread->reserveThreads(big);
+        ensure_equals("released", again, first);
+        mThread->releaseThreads(again);
+    }
 }
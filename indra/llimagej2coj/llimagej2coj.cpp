@@ -347,6 +347,8 @@ public:
         opj_set_warning_handler(decoder, opj_warn, this);
         opj_set_error_handler(decoder, opj_error, this);
 
+        setDecodeThreads();
+
         if (stream)
         {
             opj_stream_destroy(stream);
@@ -410,6 +412,19 @@ public:
     opj_image_t* getImage() { return image; }
 
 private:
+    // Lets OpenJPEG decode code-blocks in parallel, on as many threads as
+    // LLImageDecodeThread reserved for this decode (OpenJPEG 2.2 and later)
+    void setDecodeThreads()
+    {
+#if OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 2)
+        S32 threads = LLImage::getThreadDecodeThreads();
+        if (threads > 1 && opj_has_thread_support())
+        {
+            opj_codec_set_threads(decoder, threads);
+        }
+#endif
+    }
+
     opj_dparameters_t         parameters;
     opj_event_mgr_t           event_mgr;
     opj_image_t*              image = nullptr;
@@ -0,0 +1,162 @@
+/**
+ * @file llimagej2coj_test.cpp
+ * @brief Decode tests and benchmark for the OpenJPEG implementation of LLImageJ2C
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagej2coj.h"
+#include "llimagej2c.h"
+#include "llimageworker.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace tut
+{
+    struct imagej2coj_data
+    {
+        typedef std::vector<U8> buffer_t;
+
+        // The J2C files shipped with the skins, or those under the
+        // directory named by LL_J2C_CORPUS
+        static const std::vector<buffer_t>& getCorpus()
+        {
+            static std::vector<buffer_t> corpus;
+            if (!corpus.empty())
+            {
+                return corpus;
+            }
+
+            namespace fs = std::filesystem;
+            const char* env = getenv("LL_J2C_CORPUS");
+            fs::path root = env ? fs::path(env) : fs::path(__FILE__).parent_path() / ".." / ".." / "newview" / "skins";
+            std::error_code ec;
+            for (fs::recursive_directory_iterator iter(root, ec), end; !ec && iter != end; iter.increment(ec))
+            {
+                std::string extension = iter->path().extension().string();
+                LLStringUtil::toLower(extension);
+                if (extension != ".j2c")
+                {
+                    continue;
+                }
+                std::ifstream file(iter->path(), std::ios::binary);
+                corpus.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+            return corpus;
+        }
+
+        // Decodes data at discard_level using up to 'threads' threads
+        static LLPointer<LLImageRaw> decode(const buffer_t& data, S32 discard_level, S32 threads)
+        {
+            LLPointer<LLImageJ2C> image = new LLImageJ2C;
+            U8* buffer = image->allocateData((S32)data.size());
+            if (!buffer)
+            {
+                return NULL;
+            }
+            memcpy(buffer, data.data(), data.size()); /* Flawfinder: ignore */
+            if (!image->updateData())
+            {
+                return NULL;
+            }
+            image->setDiscardLevel(discard_level);
+
+            LLPointer<LLImageRaw> raw = new LLImageRaw(image->getWidth(), image->getHeight(), image->getComponents());
+            LLImage::setThreadDecodeThreads(threads);
+            bool decoded = image->decode(raw, 0.f);
+            LLImage::setThreadDecodeThreads(1);
+            if (!decoded || !raw->getData())
+            {
+                return NULL;
+            }
+            return raw;
+        }
+    };
+    typedef test_group<imagej2coj_data> imagej2coj_test;
+    typedef imagej2coj_test::object imagej2coj_object;
+    tut::imagej2coj_test imagej2coj_testcase("LLImageJ2COJ");
+
+    template<> template<>
+    void imagej2coj_object::test<1>()
+    {
+        set_test_name("multithreaded decode matches single threaded");
+
+        const std::vector<buffer_t>& corpus = getCorpus();
+        ensure("corpus found", !corpus.empty());
+
+        for (const buffer_t& data : corpus)
+        {
+            for (S32 discard = 0; discard <= MAX_DISCARD_LEVEL; ++discard)
+            {
+                LLPointer<LLImageRaw> single = decode(data, discard, 1);
+                ensure("decoded", single.notNull());
+                LLPointer<LLImageRaw> multi = decode(data, discard, LLImageDecodeThread::MAX_THREADS_PER_DECODE);
+                ensure("decoded multithreaded", multi.notNull());
+                ensure_equals("width", multi->getWidth(), single->getWidth());
+                ensure_equals("height", multi->getHeight(), single->getHeight());
+                ensure_equals("components", multi->getComponents(), single->getComponents());
+                ensure("same pixels", !memcmp(multi->getData(), single->getData(), single->getDataSize()));
+            }
+        }
+    }
+
+    template<> template<>
+    void imagej2coj_object::test<2>()
+    {
+        set_test_name("decode benchmark");
+
+        const std::vector<buffer_t>& corpus = getCorpus();
+        ensure("corpus found", !corpus.empty());
+
+        for (S32 discard = 0; discard <= MAX_DISCARD_LEVEL; ++discard)
+        {
+            F64 ms_per_megapixel[2] = { 0.0, 0.0 };
+            const S32 thread_counts[2] = { 1, LLImageDecodeThread::MAX_THREADS_PER_DECODE };
+            for (S32 i = 0; i < 2; ++i)
+            {
+                F64 pixels = 0.0;
+                LLTimer timer;
+                for (const buffer_t& data : corpus)
+                {
+                    LLPointer<LLImageRaw> raw = decode(data, discard, thread_counts[i]);
+                    if (raw.notNull())
+                    {
+                        pixels += (F64)raw->getWidth() * raw->getHeight();
+                    }
+                }
+                F64 elapsed_ms = timer.getElapsedTimeF64() * 1000.0;
+                ms_per_megapixel[i] = elapsed_ms / llmax(pixels / 1000000.0, 1e-6);
+            }
+            LL_INFOS() << "Discard " << discard << ": " << ms_per_megapixel[0] << " ms/MP on one thread, "
+                       << ms_per_megapixel[1] << " ms/MP on " << thread_counts[1] << " threads" << LL_ENDL;
+            ensure("decoded something", ms_per_megapixel[0] > 0.0);
+        }
+    }
+}
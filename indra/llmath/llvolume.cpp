@@ -4742,7 +4742,9 @@ LLVolumeFace::LLVolumeFace() :
     mWeightsScrubbed(false),
     mOctree(NULL),
     mOctreeTriangles(NULL),
-    mOptimized(false)
+    mOptimized(false),
+    mMemTag(LLMemTag::VOLUME),
+    mMemBytes(0)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
     mExtents[0].splat(-0.5f);
@@ -4772,7 +4774,9 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 #endif
     mWeightsScrubbed(false),
     mOctree(NULL),
-    mOctreeTriangles(NULL)
+    mOctreeTriangles(NULL),
+    mMemTag(LLMemTag::VOLUME),
+    mMemBytes(0)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
     mCenter = mExtents+2;
@@ -4877,6 +4881,7 @@ LLVolumeFace& LLVolumeFace::operator=(const LLVolumeFace& src)
 
     mOptimized = src.mOptimized;
     mNormalizedScale = src.mNormalizedScale;
+    updateMemCharge();
 
     //delete
     return *this;
@@ -4913,6 +4918,7 @@ void LLVolumeFace::freeData()
     ll_aligned_free_16(mJustWeights);
     mJustWeights = NULL;
 #endif
+    updateMemCharge();
 
     destroyOctree();
 }
@@ -5030,6 +5036,7 @@ void LLVolumeFace::remap()
     mTexCoords = remap_tex_coords;
     mNumVertices = remap_vertices_count;
     mNumAllocatedVertices = remap_vertices_count;
+    updateMemCharge();
 }
 
 void LLVolumeFace::optimize(F32 angle_cutoff)
@@ -5592,6 +5599,7 @@ bool LLVolumeFace::cacheOptimize(bool gen_tangents)
     meshopt_optimizeVertexCache<U16>(mIndices, src_indices, mNumIndices, mNumVertices);
 
     ll_aligned_free_16(src_indices);
+    updateMemCharge();
 
     return true;
 }
@@ -5704,6 +5712,8 @@ void LLVolumeFace::swapData(LLVolumeFace& rhs)
     llswap(rhs.mIndices,mIndices);
     llswap(rhs.mNumVertices, mNumVertices);
     llswap(rhs.mNumIndices, mNumIndices);
+    updateMemCharge();
+    rhs.updateMemCharge();
 }
 
 void    LerpPlanarVertex(LLVolumeFace::VertexData& v0,
@@ -6471,6 +6481,7 @@ void LLVolumeFace::resizeVertices(S32 num_verts)
         mNumVertices = 0;
         mNumAllocatedVertices = 0;
     }
+    updateMemCharge();
 
     // Force update
     mJointRiggingInfoTab.clear();
@@ -6521,7 +6532,7 @@ void LLVolumeFace::pushVertex(const LLVector4a& pos, const LLVector4a& norm, con
         ll_aligned_free<64>(old_buf);
 
         mNumAllocatedVertices = new_verts;
-
+        updateMemCharge();
     }
 
     mPositions[mNumVertices] = pos;
@@ -6535,13 +6546,14 @@ void LLVolumeFace::allocateTangents(S32 num_verts)
 {
     ll_aligned_free_16(mTangents);
     mTangents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
+    updateMemCharge();
 }
 
 void LLVolumeFace::allocateWeights(S32 num_verts)
 {
     ll_aligned_free_16(mWeights);
     mWeights = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
-
+    updateMemCharge();
 }
 
 void LLVolumeFace::allocateJointIndices(S32 num_verts)
@@ -6552,6 +6564,7 @@ void LLVolumeFace::allocateJointIndices(S32 num_verts)
 
     mJointIndices = (U8*)ll_aligned_malloc_16(sizeof(U8) * 4 * num_verts);
     mJustWeights = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * num_verts);
+    updateMemCharge();
 #endif
 }
 
@@ -6581,6 +6594,7 @@ void LLVolumeFace::resizeIndices(S32 num_indices)
         // Either num_indices is zero or allocation failure
         mNumIndices = 0;
     }
+    updateMemCharge();
 }
 
 void LLVolumeFace::pushIndex(const U16& idx)
@@ -6596,6 +6610,61 @@ void LLVolumeFace::pushIndex(const U16& idx)
     }
 
     mIndices[mNumIndices++] = idx;
+    if (new_size != old_size)
+    {
+        updateMemCharge();
+    }
+}
+
+void LLVolumeFace::updateMemCharge()
+{
+    // Sizes as allocated above; tangents and weights follow mNumVertices
+    S64 bytes = 0;
+    if (mPositions)
+    {
+        bytes += sizeof(LLVector4a) * 2 * mNumAllocatedVertices + (((mNumAllocatedVertices * sizeof(LLVector2)) + 0xF) & ~0xF);
+    }
+    if (mIndices)
+    {
+        bytes += ((mNumIndices * sizeof(U16)) + 0xF) & ~0xF;
+    }
+    if (mTangents)
+    {
+        bytes += sizeof(LLVector4a) * mNumVertices;
+    }
+    if (mWeights)
+    {
+        bytes += sizeof(LLVector4a) * mNumVertices;
+    }
+#if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
+    if (mJustWeights)
+    {
+        bytes += sizeof(LLVector4a) * mNumVertices;
+    }
+    if (mJointIndices)
+    {
+        bytes += sizeof(U8) * 4 * mNumVertices;
+    }
+#endif
+
+    if (bytes == mMemBytes)
+    {
+        return;
+    }
+    if (mMemBytes)
+    {
+        LLMemTag::discharge(mMemTag, (size_t)mMemBytes);
+    }
+    else
+    {
+        // A face keeps the tag it was built under until it is emptied
+        mMemTag = LLMemTag::current(LLMemTag::VOLUME);
+    }
+    if (bytes)
+    {
+        LLMemTag::charge(mMemTag, (size_t)bytes);
+    }
+    mMemBytes = bytes;
 }
 
 void LLVolumeFace::fillFromLegacyData(std::vector<LLVolumeFace::VertexData>& v, std::vector<U16>& idx)
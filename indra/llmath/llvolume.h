@@ -60,6 +60,7 @@ class LLVolumeOctree;
 #include "llfile.h"
 #include "llalignedarray.h"
 #include "llrigginginfo.h"
+#include "llmemtag.h"
 
 //============================================================================
 
@@ -996,6 +997,12 @@ private:
     LLVolumeOctree* mOctree;
     LLVolumeTriangle* mOctreeTriangles;
 
+    // Buffer bytes charged to mMemTag, brought up to date after every
+    // (re)allocation by updateMemCharge()
+    LLMemTag::ETag mMemTag;
+    S64 mMemBytes;
+
+    void updateMemCharge();
     bool createUnCutCubeCap(LLVolume* volume, bool partial_build = false);
     bool createCap(LLVolume* volume, bool partial_build = false);
     bool createSide(LLVolume* volume, bool partial_build = false);
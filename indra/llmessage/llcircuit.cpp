@@ -441,6 +441,8 @@ LLCircuit::LLCircuit(const F32Seconds circuit_heartbeat_interval, const F32Secon
 
 LLCircuit::~LLCircuit()
 {
+    LLMutexLock lock(&mCircuitDataMutex);
+
     // delete pointers in the map.
     for (auto circ_pair : mCircuitData)
     {
@@ -453,7 +455,10 @@ LLCircuitData *LLCircuit::addCircuitData(const LLHost &host, TPACKETID in_id)
     // This should really validate if one already exists
     LL_INFOS() << "LLCircuit::addCircuitData for " << host << LL_ENDL;
     LLCircuitData *tempp = new LLCircuitData(host, in_id, mHeartbeatInterval, mHeartbeatTimeout);
-    mCircuitData.insert(circuit_data_map::value_type(host, tempp));
+    {
+        LLMutexLock lock(&mCircuitDataMutex);
+        mCircuitData.insert(circuit_data_map::value_type(host, tempp));
+    }
     mPingSet.insert(tempp);
 
     mLastCircuit = tempp;
@@ -468,6 +473,8 @@ void LLCircuit::removeCircuitData(const LLHost &host)
     if(it != mCircuitData.end())
     {
         LLCircuitData *cdp = it->second;
+        // Held until cdp is deleted below
+        LLMutexLock lock(&mCircuitDataMutex);
         mCircuitData.erase(it);
 
         LLCircuit::ping_set_t::iterator psit = mPingSet.find(cdp);
@@ -620,6 +627,19 @@ void LLCircuit::dumpResends()
     }
 }
 
+bool LLCircuit::nextPacketOutID(const LLHost& host, TPACKETID& id)
+{
+    // Not findCircuit(): mLastCircuit belongs to the main thread.
+    LLMutexLock lock(&mCircuitDataMutex);
+    circuit_data_map::const_iterator it = mCircuitData.find(host);
+    if (it == mCircuitData.end())
+    {
+        return false;
+    }
+    id = it->second->nextPacketOutID();
+    return true;
+}
+
 LLCircuitData* LLCircuit::findCircuit(const LLHost& host) const
 {
     // An optimization on finding the previously found circuit.
@@ -1144,6 +1164,10 @@ void LLCircuit::sendAcks(F32 collect_time)
                     gMessageSystem->sendMessage(cd->mHost);
                 }
 
+                // Measured from when the oldest ack was collected, so time
+                // the packet sat in the socket buffer is not included.
+                gMessageSystem->getAckLatencyStats().record((U64)(age * 1000000.f));
+
                 if(gMessageSystem->mVerboseLog)
                 {
                     std::ostringstream str;
@@ -1260,16 +1284,21 @@ TPACKETID LLCircuitData::nextPacketOutID()
 {
     mPacketsOut++;
 
+    // The network receive thread may be taking IDs for its acks at the
+    // same time, so advance with a compare-exchange.
+    TPACKETID old_id = mPacketsOutID;
     TPACKETID id;
+    do
+    {
+        id = (old_id + 1) % LL_MAX_OUT_PACKET_ID;
+    }
+    while (!mPacketsOutID.compare_exchange_weak(old_id, id));
 
-    id = (mPacketsOutID + 1) % LL_MAX_OUT_PACKET_ID;
-
-    if (id < mPacketsOutID)
+    if (id < old_id)
     {
         // we just wrapped on a circuit, reset the wrap ID to zero
         mWrapID = 0;
     }
-    mPacketsOutID = id;
     return id;
 }
 
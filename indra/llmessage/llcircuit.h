@@ -28,10 +28,12 @@
 #ifndef LL_LLCIRCUIT_H
 #define LL_LLCIRCUIT_H
 
+#include <atomic>
 #include <map>
 #include <vector>
 
 #include "llerror.h"
+#include "llmutex.h"
 
 #include "lltimer.h"
 #include "net.h"
@@ -198,11 +200,13 @@ protected:
 
     LLThrottleGroup mThrottles;
 
-    TPACKETID       mWrapID;
+    std::atomic<TPACKETID>  mWrapID;
 
     // Current packet IDs of incoming/outgoing packets
     // Used for packet sequencing/packet loss detection.
-    TPACKETID       mPacketsOutID;
+    // Outgoing IDs are also taken by the network receive thread for the
+    // acks it sends, see LLCircuit::nextPacketOutID().
+    std::atomic<TPACKETID>  mPacketsOutID;
     TPACKETID       mPacketsInID;
     TPACKETID       mHighestPacketID;
 
@@ -258,7 +262,7 @@ protected:
     // as far as I can tell.
     //
 
-    U32     mPacketsOut;
+    std::atomic<U32>    mPacketsOut;
     U32     mPacketsIn;
     S32     mPacketsLost;
     S32Bytes    mBytesIn,
@@ -311,6 +315,11 @@ public:
     // to send out any acks that did not get sent already.
     void sendAcks(F32 collect_time);
 
+    // Safe to call from the network receive thread: takes the next
+    // outgoing packet ID on the circuit to host. Returns false if there is
+    // no such circuit.
+    bool nextPacketOutID(const LLHost& host, TPACKETID& id);
+
     friend std::ostream& operator<<(std::ostream& s, LLCircuit &circuit);
     void getInfo(LLSD& info) const;
 
@@ -351,5 +360,9 @@ protected:
 private:
     const F32Seconds mHeartbeatInterval;
     const F32Seconds mHeartbeatTimeout;
+
+    // Held while mCircuitData changes so nextPacketOutID() can look up
+    // circuits from another thread. Main thread reads need no lock.
+    LLMutex mCircuitDataMutex;
 };
 #endif
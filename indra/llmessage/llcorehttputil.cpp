@@ -117,9 +117,12 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
         return false;
     }
 
-    LLCore::BufferArrayStream bas(body);
+    // One contiguous copy lets the in-memory parser handle the body,
+    // which is much faster than streaming it through expat.
+    std::string text(body->size(), '\0');
+    text.resize(body->read(0, &text[0], text.size()));
     LLSD body_llsd;
-    S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, log));
+    S32 parse_status(LLSDSerialize::fromXMLBuffer(body_llsd, text.data(), text.size(), log));
     if (LLSDParser::PARSE_FAILURE == parse_status){
         return false;
     }
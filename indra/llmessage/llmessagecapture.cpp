@@ -0,0 +1,152 @@
+/**
+ * @file llmessagecapture.cpp
+ * @brief Records received template messages to a file for offline replay
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llmessagecapture.h"
+
+#include "llfile.h"
+#include "lltimer.h"
+#include "message.h"
+
+#include <algorithm>
+
+namespace
+{
+    const char CAPTURE_MAGIC[8] = { 'L', 'L', 'M', 'S', 'G', 'C', 'A', 'P' };
+
+    LLFILE* sCaptureFile = NULL;
+    U64 sCaptureStart = 0;
+    // Hashed names, compared by address
+    std::vector<const char*> sCaptureNames;
+}
+
+//static
+bool LLMessageCapture::start(const std::string& filename, const std::vector<std::string>& names)
+{
+    stop();
+
+    sCaptureFile = LLFile::fopen(filename, "wb");
+    if (!sCaptureFile)
+    {
+        LL_WARNS("Messaging") << "Could not open message capture " << filename << LL_ENDL;
+        return false;
+    }
+
+    Header header;
+    memcpy(header.mMagic, CAPTURE_MAGIC, sizeof(header.mMagic)); /* Flawfinder: ignore */
+    header.mVersion = VERSION;
+    header.mReserved = 0;
+    fwrite(&header, sizeof(header), 1, sCaptureFile);
+
+    sCaptureNames.clear();
+    for (const std::string& name : names)
+    {
+        sCaptureNames.push_back(LLMessageStringTable::getInstance()->getString(name.c_str()));
+    }
+    sCaptureStart = LLTimer::getTotalTime();
+    LL_INFOS("Messaging") << "Recording messages to " << filename << LL_ENDL;
+    return true;
+}
+
+//static
+void LLMessageCapture::stop()
+{
+    if (sCaptureFile)
+    {
+        LLFile::close(sCaptureFile);
+        sCaptureFile = NULL;
+    }
+}
+
+//static
+bool LLMessageCapture::isRecording()
+{
+    return sCaptureFile != NULL;
+}
+
+//static
+void LLMessageCapture::receive(const char* hashed_name, const U8* buffer, S32 size, void*)
+{
+    if (!sCaptureFile || size <= 0
+        || (!sCaptureNames.empty()
+            && std::find(sCaptureNames.begin(), sCaptureNames.end(), hashed_name) == sCaptureNames.end()))
+    {
+        return;
+    }
+
+    RecordHeader record;
+    record.mTime = LLTimer::getTotalTime() - sCaptureStart;
+    record.mSize = (U32)size;
+    record.mReserved = 0;
+    if (fwrite(&record, sizeof(record), 1, sCaptureFile) != 1
+        || fwrite(buffer, 1, size, sCaptureFile) != (size_t)size)
+    {
+        LL_WARNS("Messaging") << "Message capture write failed, stopping" << LL_ENDL;
+        stop();
+    }
+}
+
+//static
+bool LLMessageCapture::read(const std::string& filename, std::vector<Record>& records)
+{
+    records.clear();
+    LLUniqueFile file(LLFile::fopen(filename, "rb"));
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.mMagic, CAPTURE_MAGIC, sizeof(header.mMagic))
+        || header.mVersion != VERSION)
+    {
+        LL_WARNS("Messaging") << filename << " is not a message capture" << LL_ENDL;
+        return false;
+    }
+
+    RecordHeader record;
+    while (fread(&record, sizeof(record), 1, file) == 1)
+    {
+        if (record.mSize > (U32)MAX_BUFFER_SIZE)
+        {
+            LL_WARNS("Messaging") << filename << " has a " << record.mSize << " byte message, stopping there"
+                                  << LL_ENDL;
+            break;
+        }
+        records.emplace_back();
+        records.back().mTime = record.mTime;
+        records.back().mData.resize(record.mSize);
+        if (fread(records.back().mData.data(), 1, record.mSize, file) != record.mSize)
+        {
+            records.pop_back();
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file llmessagecapture.h
+ * @brief Records received template messages to a file for offline replay
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGECAPTURE_H
+#define LL_LLMESSAGECAPTURE_H
+
+#include <string>
+#include <vector>
+
+// Writes the template messages LLMessageSystem receives to a file, so that
+// a session's message stream can be replayed later through the template
+// reader, e.g. by tests/llmessagedecodebench_test.cpp.  Install with
+//
+//     LLMessageCapture::start(filename, names);
+//     msg->setReceiveFunc(LLMessageCapture::receive);
+//
+// The file is a Header followed by, for each message, a RecordHeader and
+// the packet as LLTemplateMessageReader::validateMessage() takes it, in
+// native byte order.  Packets only decode against the message template
+// they were recorded with.  Main thread only.
+class LLMessageCapture
+{
+public:
+    struct Header
+    {
+        char mMagic[8];
+        U32 mVersion;
+        U32 mReserved;
+    };
+
+    struct RecordHeader
+    {
+        U64 mTime;      // microseconds since recording started
+        U32 mSize;
+        U32 mReserved;
+    };
+
+    struct Record
+    {
+        U64 mTime;
+        std::vector<U8> mData;
+    };
+
+    static const U32 VERSION = 1;
+
+    // Records the messages named in 'names', or all of them when it is empty
+    static bool start(const std::string& filename, const std::vector<std::string>& names);
+    static void stop();
+    static bool isRecording();
+
+    // LLMessageSystem::msg_receive_callback
+    static void receive(const char* hashed_name, const U8* buffer, S32 size, void* data);
+
+    // Reads a whole capture; returns false if filename is not one
+    static bool read(const std::string& filename, std::vector<Record>& records);
+};
+
+#endif // LL_LLMESSAGECAPTURE_H
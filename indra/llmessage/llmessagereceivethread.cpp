@@ -0,0 +1,428 @@
+/**
+ * @file llmessagereceivethread.cpp
+ * @brief Network thread that receives, acks and expands UDP messages
+ * ahead of LLMessageSystem::checkMessages().
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmessagereceivethread.h"
+
+#if LL_WINDOWS
+    #include <winsock2.h>
+#else
+    #include <sys/select.h>
+    #include <netinet/in.h>
+#endif
+
+#include "llcircuit.h"
+#include "llmessagetemplate.h"
+#include "llpacketring.h"
+#include "llproxy.h"
+#include "lltimer.h"
+#include "message.h"
+
+// PacketAck is Fixed 0xFFFFFFFB: four header bytes, then the block count
+static const U8 PACKET_ACK_NUMBER[] = { 0xFF, 0xFF, 0xFF, 0xFB };
+static const S32 PACKET_ACK_HEADER_SIZE = LL_PACKET_ID_SIZE + sizeof(PACKET_ACK_NUMBER) + 1;
+
+// Same scheme as LLMessageSystem::zeroCodeExpand(): past the header, a zero
+// byte is followed by the length of the run it stands for, with each extra
+// zero adding 256. Returns false instead of writing past out.
+static bool zero_code_expand(const U8* in, S32 in_size, U8* out, S32& out_size)
+{
+    S32 i = 0;
+    S32 o = 0;
+    for (; i < LL_PACKET_ID_SIZE; ++i)
+    {
+        out[o++] = in[i];
+    }
+    out[0] &= ~LL_ZERO_CODE_FLAG;
+
+    while (i < in_size)
+    {
+        if (o >= NET_BUFFER_SIZE)
+        {
+            return false;
+        }
+        U8 c = in[i++];
+        out[o++] = c;
+        if (c)
+        {
+            continue;
+        }
+
+        while (i < in_size && !in[i])
+        {
+            ++i;
+            if (o + 256 > NET_BUFFER_SIZE)
+            {
+                return false;
+            }
+            memset(out + o, 0, 256);
+            o += 256;
+        }
+        if (i >= in_size)
+        {
+            break;
+        }
+
+        S32 run = in[i++] - 1;
+        if (o + run > NET_BUFFER_SIZE)
+        {
+            return false;
+        }
+        memset(out + o, 0, run);
+        o += run;
+    }
+
+    out_size = o;
+    return true;
+}
+
+// Fewest bytes the blocks of a message can take. decodeData() accepts a
+// message that stops before a variable block's count, so those count for
+// nothing; a variable length field counts only its size bytes.
+static S32 min_body_size(const LLMessageTemplate& message)
+{
+    S32 size = 0;
+    for (const LLMessageBlock* block : message.mMemberBlocks)
+    {
+        if (block->mType == MBT_VARIABLE)
+        {
+            continue;
+        }
+        S32 block_size = 0;
+        for (const LLMessageVariable* variable : block->mMemberVariables)
+        {
+            block_size += variable->getSize();
+        }
+        size += block->mNumber * block_size;
+    }
+    return size;
+}
+
+///////////////////////////////////////////////////////////
+
+LLAckLatencyStats::LLAckLatencyStats()
+:   mTotalUsec(0),
+    mCount(0),
+    mMaxUsec(0)
+{
+}
+
+void LLAckLatencyStats::record(U64 usec)
+{
+    mTotalUsec += usec;
+    mCount++;
+    U64 max_usec = mMaxUsec;
+    while (usec > max_usec && !mMaxUsec.compare_exchange_weak(max_usec, usec))
+    {
+    }
+}
+
+void LLAckLatencyStats::getAndReset(F32& mean_ms, F32& max_ms)
+{
+    U64 count = mCount.exchange(0);
+    U64 total = mTotalUsec.exchange(0);
+    U64 max_usec = mMaxUsec.exchange(0);
+    mean_ms = count ? (F32)((F64)total / (F64)count / 1000.0) : 0.f;
+    max_ms = (F32)((F64)max_usec / 1000.0);
+}
+
+///////////////////////////////////////////////////////////
+
+LLMessageReceiveThread::LLMessageReceiveThread(S32 socket, LLCircuit& circuits, LLAckLatencyStats& ack_latency,
+                                               const LLTemplateMessageReader::message_template_number_map_t& templates)
+:   LLThread("MessageReceive"),
+    mSocket(socket),
+    mCircuits(circuits),
+    mAckLatency(ack_latency),
+    mQueue(new LLReceivedPacket[QUEUE_SIZE]),
+    mHead(0),
+    mTail(0),
+    mMaxQueueDepth(0),
+    mPacketsReceived(0),
+    mPacketsDiscarded(0),
+    mAcksSent(0)
+{
+    for (const auto& entry : templates)
+    {
+        if (entry.second)
+        {
+            mMinMessageSizes[entry.first] = LL_PACKET_ID_SIZE + (S32)entry.second->mFrequency + min_body_size(*entry.second);
+        }
+    }
+}
+
+LLMessageReceiveThread::~LLMessageReceiveThread()
+{
+    shutdown();
+    delete[] mQueue;
+}
+
+bool LLMessageReceiveThread::popPacket(LLReceivedPacket& packet)
+{
+    U32 head = mHead.load(std::memory_order_relaxed);
+    if (head == mTail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const LLReceivedPacket& slot = mQueue[head & (QUEUE_SIZE - 1)];
+    memcpy(packet.mData, slot.mData, slot.mSize);   /* Flawfinder: ignore */
+    memcpy(packet.mAckData, slot.mAckData, slot.mAckCount * sizeof(TPACKETID));   /* Flawfinder: ignore */
+    packet.mSize = slot.mSize;
+    packet.mWireSize = slot.mWireSize;
+    packet.mCompressedSize = slot.mCompressedSize;
+    packet.mAckCount = slot.mAckCount;
+    packet.mSender = slot.mSender;
+    packet.mReceivingIF = slot.mReceivingIF;
+    packet.mReceiveTime = slot.mReceiveTime;
+    packet.mAcked = slot.mAcked;
+
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+S32 LLMessageReceiveThread::getQueueDepth() const
+{
+    return (S32)(mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire));
+}
+
+S32 LLMessageReceiveThread::getAndResetMaxQueueDepth()
+{
+    return mMaxQueueDepth.exchange(getQueueDepth());
+}
+
+void LLMessageReceiveThread::run()
+{
+    while (!isQuitting())
+    {
+        U32 tail = mTail.load(std::memory_order_relaxed);
+        U32 free_slots = QUEUE_SIZE - (tail - mHead.load(std::memory_order_acquire));
+        if (!free_slots)
+        {
+            // The main thread is behind; leave the rest in the socket buffer.
+            ms_sleep(1);
+            continue;
+        }
+
+        if (!waitForData(50))
+        {
+            continue;
+        }
+
+        S32 count = mPool.receive(mSocket, llmin((S32)free_slots, (S32)NET_MAX_PACKET_BATCH));
+        mPacketsReceived += count;
+
+        U32 end = tail;
+        for (S32 i = 0; i < count; ++i)
+        {
+            if (unpack(mPool.get(i), mQueue[end & (QUEUE_SIZE - 1)]))
+            {
+                ++end;
+            }
+            else
+            {
+                mPacketsDiscarded++;
+            }
+        }
+
+        if (end != tail)
+        {
+            sendAcks(tail, end);
+            mTail.store(end, std::memory_order_release);
+
+            S32 depth = getQueueDepth();
+            S32 max_depth = mMaxQueueDepth;
+            while (depth > max_depth && !mMaxQueueDepth.compare_exchange_weak(max_depth, depth))
+            {
+            }
+        }
+    }
+}
+
+bool LLMessageReceiveThread::waitForData(S32 timeout_ms) const
+{
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(mSocket, &read_fds);
+
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = timeout_ms * 1000;
+
+    return select(mSocket + 1, &read_fds, NULL, NULL, &timeout) > 0;
+}
+
+bool LLMessageReceiveThread::unpack(const LLPacketBuffer& datagram, LLReceivedPacket& slot) const
+{
+    S32 size = 0;
+    const U8* data = (const U8*)LLPacketRing::unwrapPacket(datagram, size, slot.mSender);
+    if (!data)
+    {
+        return false;
+    }
+    if (size < LL_MINIMUM_VALID_PACKET_SIZE)
+    {
+        LL_WARNS("Messaging") << "Invalid (too short) packet discarded " << size << LL_ENDL;
+        return false;
+    }
+
+    slot.mWireSize = size;
+    slot.mAckCount = 0;
+    if (data[0] & LL_ACK_FLAG)
+    {
+        S32 acks = data[--size];
+        if (size < (S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE))
+        {
+            LL_WARNS("Messaging") << "Malformed packet received. Packet size "
+                << size << " with invalid no. of acks " << acks << LL_ENDL;
+            return false;
+        }
+        size -= acks * sizeof(TPACKETID);
+        memcpy(slot.mAckData, data + size, acks * sizeof(TPACKETID));  /* Flawfinder: ignore */
+        slot.mAckCount = acks;
+    }
+
+    if (data[0] & LL_ZERO_CODE_FLAG)
+    {
+        slot.mCompressedSize = size;
+        if (!zero_code_expand(data, size, slot.mData, slot.mSize))
+        {
+            LL_WARNS("Messaging") << "Zero-coded packet from " << slot.mSender
+                << " expands past " << NET_BUFFER_SIZE << " bytes, discarded" << LL_ENDL;
+            return false;
+        }
+    }
+    else
+    {
+        slot.mCompressedSize = 0;
+        slot.mSize = size;
+        memcpy(slot.mData, data, size);  /* Flawfinder: ignore */
+    }
+
+    slot.mReceivingIF = datagram.getReceivingInterface();
+    slot.mReceiveTime = totalTime();
+    slot.mAckable = (slot.mData[PHL_FLAGS] & LL_RELIABLE_FLAG) && canAck(slot);
+    slot.mAcked = false;
+    return true;
+}
+
+bool LLMessageReceiveThread::canAck(const LLReceivedPacket& packet) const
+{
+    // checkMessages() drops these without acking them, so acking them here
+    // would tell the sender a message arrived that was never handled.
+    U32 number = 0;
+    if (!LLTemplateMessageReader::decodeMessageNumber(packet.mData, packet.mSize, number))
+    {
+        return false;
+    }
+    std::unordered_map<U32, S32>::const_iterator it = mMinMessageSizes.find(number);
+    return it != mMinMessageSizes.end()
+        && packet.mSize >= it->second + packet.mData[PHL_OFFSET];
+}
+
+void LLMessageReceiveThread::sendAcks(U32 begin, U32 end)
+{
+    if (LLProxy::isSOCKSProxyEnabled())
+    {
+        return;
+    }
+
+    // At most NET_MAX_PACKET_BATCH slots, so a linear scan per sender is fine
+    struct PendingAck
+    {
+        LLHost mHost;
+        U64 mOldest;
+        S32 mCount;
+        U8 mBuffer[PACKET_ACK_HEADER_SIZE + NET_MAX_PACKET_BATCH * sizeof(TPACKETID)];
+    };
+    PendingAck pending[NET_MAX_PACKET_BATCH];
+    S32 hosts = 0;
+
+    for (U32 index = begin; index != end; ++index)
+    {
+        LLReceivedPacket& slot = mQueue[index & (QUEUE_SIZE - 1)];
+        if (!slot.mAckable)
+        {
+            continue;
+        }
+
+        S32 h = 0;
+        while (h < hosts && pending[h].mHost != slot.mSender)
+        {
+            ++h;
+        }
+        if (h == hosts)
+        {
+            pending[h].mHost = slot.mSender;
+            pending[h].mOldest = slot.mReceiveTime;
+            pending[h].mCount = 0;
+            ++hosts;
+        }
+
+        U32 packet_id = ntohl(*((U32*)(&slot.mData[PHL_PACKET_ID])));
+        htolememcpy(&pending[h].mBuffer[PACKET_ACK_HEADER_SIZE + pending[h].mCount * sizeof(TPACKETID)], &packet_id, MVT_U32, sizeof(TPACKETID));
+        pending[h].mCount++;
+        slot.mAcked = true;
+    }
+
+    if (!hosts)
+    {
+        return;
+    }
+
+    U64 now = totalTime();
+    for (S32 h = 0; h < hosts; ++h)
+    {
+        PendingAck& ack = pending[h];
+        TPACKETID out_id;
+        if (!mCircuits.nextPacketOutID(ack.mHost, out_id))
+        {
+            // No circuit yet (e.g. UseCircuitCode); checkMessages() acks these
+            for (U32 index = begin; index != end; ++index)
+            {
+                LLReceivedPacket& slot = mQueue[index & (QUEUE_SIZE - 1)];
+                if (slot.mSender == ack.mHost)
+                {
+                    slot.mAcked = false;
+                }
+            }
+            continue;
+        }
+
+        U8* buffer = ack.mBuffer;
+        memset(buffer, 0, LL_PACKET_ID_SIZE);
+        *((U32*)&buffer[PHL_PACKET_ID]) = htonl(out_id);
+        memcpy(&buffer[PHL_NAME], PACKET_ACK_NUMBER, sizeof(PACKET_ACK_NUMBER));    /* Flawfinder: ignore */
+        buffer[PACKET_ACK_HEADER_SIZE - 1] = (U8)ack.mCount;
+
+        mAckPool.append(ack.mHost, (const char*)buffer, PACKET_ACK_HEADER_SIZE + ack.mCount * sizeof(TPACKETID));
+        mAckLatency.record(now - ack.mOldest);
+        mAcksSent += ack.mCount;
+    }
+    mAckPool.send(mSocket);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file llmessagereceivethread.h
+ * @brief Network thread that receives, acks and expands UDP messages
+ * ahead of LLMessageSystem::checkMessages().
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGERECEIVETHREAD_H
+#define LL_LLMESSAGERECEIVETHREAD_H
+
+#include <atomic>
+#include <unordered_map>
+
+#include "llhost.h"
+#include "llpacketbuffer.h"
+#include "lltemplatemessagereader.h"
+#include "llthread.h"
+#include "net.h"
+
+class LLCircuit;
+
+// Most acks a sender can append to one datagram (the count is a U8)
+const S32 LL_MAX_APPENDED_ACKS = 255;
+
+// A datagram that the network thread has validated, acked and zero-code
+// expanded, waiting for the main thread.
+struct LLReceivedPacket
+{
+    U8          mData[NET_BUFFER_SIZE];     // expanded message, without appended acks
+    S32         mSize;                      // bytes used in mData
+    S32         mWireSize;                  // bytes received, including appended acks
+    S32         mCompressedSize;            // zero-coded size before expansion, 0 if not zero-coded
+    U8          mAckData[LL_MAX_APPENDED_ACKS * sizeof(TPACKETID)]; // appended acks, as sent
+    S32         mAckCount;
+    LLHost      mSender;
+    LLHost      mReceivingIF;
+    U64         mReceiveTime;               // usec, totalTime() when read off the socket
+    bool        mAckable;                   // reliable, with a registered message number and room for its blocks
+    bool        mAcked;                     // reliable, and already acked by the network thread
+};
+
+// Thread-safe accumulator for how long reliable packets wait before their
+// PacketAck goes out. Each sample is the oldest ack in one PacketAck.
+class LLAckLatencyStats
+{
+public:
+    LLAckLatencyStats();
+
+    void record(U64 usec);
+    // Mean and max since the previous call, in milliseconds. Both are zero
+    // if nothing was acked in between.
+    void getAndReset(F32& mean_ms, F32& max_ms);
+
+private:
+    std::atomic<U64> mTotalUsec;
+    std::atomic<U64> mCount;
+    std::atomic<U64> mMaxUsec;
+};
+
+// Reads the message socket on its own thread so acks go out without
+// waiting for the main loop. Each datagram is checked for size, its
+// appended acks split off and its payload zero-code expanded. A reliable
+// packet on a known circuit is acked straight away if its message number
+// is registered and it is long enough for that message's fixed blocks;
+// any other packet is left for checkMessages() to ack once it has
+// validated it. The results are handed to the main thread through a
+// single-producer/single-consumer ring, and all decoding and handlers stay
+// in LLMessageSystem::checkMessages().
+//
+// Datagrams are unwrapped from the SOCKS proxy's header the same way
+// LLPacketRing does, but sends made here bypass LLPacketRing, so acks are
+// left to the main thread while a SOCKS proxy is enabled. LLPacketRing's
+// inbound throttle and packet loss simulation need the packets to go
+// through it, so LLMessageSystem stops this thread while either is on.
+class LLMessageReceiveThread : public LLThread
+{
+public:
+    // Slots in the hand-off ring; a power of two.
+    static const U32 QUEUE_SIZE = 256;
+
+    // The templates are only read here, to size each registered message.
+    LLMessageReceiveThread(S32 socket, LLCircuit& circuits, LLAckLatencyStats& ack_latency,
+                           const LLTemplateMessageReader::message_template_number_map_t& templates);
+    ~LLMessageReceiveThread();
+
+    // Main thread: copies the oldest waiting packet into packet. Returns
+    // false if there is none.
+    bool popPacket(LLReceivedPacket& packet);
+
+    // Packets waiting for the main thread, now and at most since the
+    // previous call.
+    S32 getQueueDepth() const;
+    S32 getAndResetMaxQueueDepth();
+
+    U64 getPacketsReceived() const  { return mPacketsReceived; }
+    U64 getPacketsDiscarded() const { return mPacketsDiscarded; }
+    U64 getAcksSent() const         { return mAcksSent; }
+
+protected:
+    void run() override;
+
+private:
+    // Blocks for up to timeout_ms waiting for the socket to become readable.
+    bool waitForData(S32 timeout_ms) const;
+    // Fills the slot at index from a received datagram. Returns false if
+    // the datagram is malformed and should be dropped.
+    bool unpack(const LLPacketBuffer& datagram, LLReceivedPacket& slot) const;
+    // Whether the expanded message in packet names a registered message and
+    // holds at least that message's fixed blocks.
+    bool canAck(const LLReceivedPacket& packet) const;
+    // Sends one PacketAck per sender for the reliable packets in slots
+    // [begin, end) and marks them acked.
+    void sendAcks(U32 begin, U32 end);
+
+    S32 mSocket;
+    LLCircuit& mCircuits;
+    LLAckLatencyStats& mAckLatency;
+    LLPacketBufferPool mPool;               // datagrams read off the socket
+    LLPacketBufferPool mAckPool;            // PacketAcks being sent
+    std::unordered_map<U32, S32> mMinMessageSizes;  // by message number, header included
+
+    LLReceivedPacket* mQueue;               // QUEUE_SIZE slots
+    std::atomic<U32> mHead;                 // next slot the main thread reads
+    std::atomic<U32> mTail;                 // next slot the network thread fills
+    std::atomic<S32> mMaxQueueDepth;
+
+    std::atomic<U64> mPacketsReceived;
+    std::atomic<U64> mPacketsDiscarded;
+    std::atomic<U64> mAcksSent;
+};
+
+#endif // LL_LLMESSAGERECEIVETHREAD_H
@@ -190,3 +190,49 @@ void LLMessageTemplate::banUdp()
     }
 }
 
+
+bool LLMessageVariableHandle::bind(const LLMessageTemplate* msgtemplate, const char* blockname, const char* varname)
+{
+    if (mBlockName && (mBlockName != blockname || mVariableName != varname))
+    {
+        LL_WARNS("Messaging") << "Handle for " << mBlockName << "." << mVariableName
+            << " can not be bound to " << blockname << "." << varname << LL_ENDL;
+        return false;
+    }
+    mBlockName = blockname;
+    mVariableName = varname;
+
+    if (!msgtemplate || find(msgtemplate))
+    {
+        return msgtemplate != NULL;
+    }
+
+    LLMessageTemplate::message_block_map_t::const_iterator block_iter =
+        msgtemplate->mMemberBlocks.find(const_cast<char*>(blockname));
+    if (block_iter == msgtemplate->mMemberBlocks.end())
+    {
+        return false;
+    }
+
+    const LLMessageBlock* block = *block_iter;
+    LLMessageBlock::message_variable_map_t::const_iterator var_iter =
+        block->mMemberVariables.find(varname);
+    if (var_iter == block->mMemberVariables.end())
+    {
+        return false;
+    }
+
+    if (mBindingCount == MAX_BINDINGS)
+    {
+        LL_WARNS("Messaging") << "Handle for " << blockname << "." << varname
+            << " is already bound to " << MAX_BINDINGS << " messages, reading "
+            << msgtemplate->mName << " by name" << LL_ENDL;
+        return false;
+    }
+
+    Binding& binding = mBindings[mBindingCount++];
+    binding.mTemplate = msgtemplate;
+    binding.mBlock = (S32)(block_iter - msgtemplate->mMemberBlocks.begin());
+    binding.mVariable = (S32)(var_iter - block->mMemberVariables.begin());
+    return true;
+}
@@ -34,6 +34,11 @@
 
 ///////////////////////////////////////////////////////////
 
+LLPacketBuffer::LLPacketBuffer() : mSize(0)
+{
+    mData[0] = '!';
+}
+
 LLPacketBuffer::LLPacketBuffer(const LLHost &host, const char *datap, const S32 size) : mHost(host)
 {
     mSize = 0;
@@ -74,3 +79,67 @@ void LLPacketBuffer::init (S32 hSocket)
     mReceivingIF = ::get_receiving_interface();
 }
 
+///////////////////////////////////////////////////////////
+
+LLPacketBufferPool::LLPacketBufferPool()
+:   mBuffers(NET_MAX_PACKET_BATCH),
+    mCount(0)
+{
+}
+
+S32 LLPacketBufferPool::receive(S32 hSocket, S32 max_count)
+{
+    char* buffers[NET_MAX_PACKET_BATCH];
+    S32 sizes[NET_MAX_PACKET_BATCH];
+    LLHost senders[NET_MAX_PACKET_BATCH];
+    LLHost receiving_ifs[NET_MAX_PACKET_BATCH];
+    for (S32 i = 0; i < NET_MAX_PACKET_BATCH; ++i)
+    {
+        buffers[i] = mBuffers[i].mData;
+    }
+
+    mCount = receive_packets(hSocket, buffers, sizes, senders, receiving_ifs, llmin(max_count, (S32)NET_MAX_PACKET_BATCH));
+    for (S32 i = 0; i < mCount; ++i)
+    {
+        mBuffers[i].mSize = sizes[i];
+        mBuffers[i].mHost = senders[i];
+        mBuffers[i].mReceivingIF = receiving_ifs[i];
+    }
+    return mCount;
+}
+
+bool LLPacketBufferPool::append(const LLHost& host, const char* datap, S32 size)
+{
+    if (isFull() || size > NET_BUFFER_SIZE || !datap)
+    {
+        return false;
+    }
+
+    LLPacketBuffer& buffer = mBuffers[mCount++];
+    memcpy(buffer.mData, datap, size);  /* Flawfinder: ignore */
+    buffer.mSize = size;
+    buffer.mHost = host;
+    return true;
+}
+
+S32 LLPacketBufferPool::send(S32 hSocket)
+{
+    if (!mCount)
+    {
+        return 0;
+    }
+
+    const char* buffers[NET_MAX_PACKET_BATCH];
+    S32 sizes[NET_MAX_PACKET_BATCH];
+    LLHost recipients[NET_MAX_PACKET_BATCH];
+    for (S32 i = 0; i < mCount; ++i)
+    {
+        buffers[i] = mBuffers[i].mData;
+        sizes[i] = mBuffers[i].mSize;
+        recipients[i] = mBuffers[i].mHost;
+    }
+
+    S32 sent = send_packets(hSocket, buffers, sizes, recipients, mCount);
+    mCount = 0;
+    return sent;
+}
@@ -28,12 +28,15 @@
 #ifndef LL_LLPACKETBUFFER_H
 #define LL_LLPACKETBUFFER_H
 
+#include <vector>
+
 #include "net.h"        // for NET_BUFFER_SIZE
 #include "llhost.h"
 
 class LLPacketBuffer
 {
 public:
+    LLPacketBuffer();                      // empty, for LLPacketBufferPool
     LLPacketBuffer(const LLHost &host, const char *datap, const S32 size);
     LLPacketBuffer(S32 hSocket);           // receive a packet
     ~LLPacketBuffer();
@@ -45,12 +48,45 @@ public:
     void init(S32 hSocket);
 
 protected:
+    friend class LLPacketBufferPool;
+
     char    mData[NET_BUFFER_SIZE];        // packet data       /* Flawfinder : ignore */
     S32     mSize;          // size of buffer in bytes
     LLHost  mHost;         // source/dest IP and port
     LLHost  mReceivingIF;         // source/dest IP and port
 };
 
+// A preallocated set of packet buffers that is filled or drained in one go,
+// so a burst of datagrams costs a single receive_packets()/send_packets()
+// call instead of one system call each.
+class LLPacketBufferPool
+{
+public:
+    LLPacketBufferPool();
+
+    // Replaces the contents with whatever is waiting on the socket, up to
+    // max_count (at most NET_MAX_PACKET_BATCH) datagrams. Returns the number
+    // received.
+    S32 receive(S32 hSocket, S32 max_count = NET_MAX_PACKET_BATCH);
+
+    // Queues an outgoing datagram. Returns false if the pool is full or the
+    // datagram is too large; the caller should send() and retry.
+    bool append(const LLHost& host, const char* datap, S32 size);
+    // Sends everything queued by append() and empties the pool. Returns the
+    // number of datagrams sent successfully.
+    S32 send(S32 hSocket);
+
+    S32 getCount() const                        { return mCount; }
+    bool isEmpty() const                        { return mCount == 0; }
+    bool isFull() const                         { return mCount >= NET_MAX_PACKET_BATCH; }
+    const LLPacketBuffer& get(S32 index) const  { return mBuffers[index]; }
+    void clear()                                { mCount = 0; }
+
+private:
+    std::vector<LLPacketBuffer> mBuffers;
+    S32 mCount;
+};
+
 #endif
 
 
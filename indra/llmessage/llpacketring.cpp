@@ -55,7 +55,12 @@ LLPacketRing::LLPacketRing () :
     mInBufferLength(0),
     mOutBufferLength(0),
     mDropPercentage(0.0f),
-    mPacketsToDrop(0x0)
+    mPacketsToDrop(0x0),
+    mUseBatching(true),
+    mBatchingSends(false),
+    mReceiveBatchIndex(0),
+    mPacketsReceived(0),
+    mPacketsSent(0)
 {
 }
 
@@ -83,6 +88,11 @@ void LLPacketRing::cleanup ()
         delete packetp;
         mSendQueue.pop();
     }
+
+    mReceiveBatch.clear();
+    mReceiveBatchIndex = 0;
+    mSendBatch.clear();
+    mBatchingSends = false;
 }
 
 ///////////////////////////////////////////////////////////
@@ -116,6 +126,86 @@ void LLPacketRing::setOutBandwidth(const F32 bps)
 {
     mOutThrottle.setRate(bps);
 }
+
+void LLPacketRing::setUseBatching(const bool use_batching)
+{
+    mUseBatching = use_batching;
+}
+
+void LLPacketRing::beginSendBatch()
+{
+    mBatchingSends = mUseBatching;
+}
+
+void LLPacketRing::flushSendBatch(int h_socket)
+{
+    mBatchingSends = false;
+    S32 count = mSendBatch.getCount();
+    if (count)
+    {
+        S32 sent = mSendBatch.send(h_socket);
+        mPacketsSent += sent;
+        if (sent < count)
+        {
+            LL_WARNS() << "Batched send dropped " << (count - sent) << " of " << count << " packets" << LL_ENDL;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////
+S32 LLPacketRing::receiveFromBatch(S32 socket, char *datap)
+{
+    while (true)
+    {
+        if (mReceiveBatchIndex >= mReceiveBatch.getCount())
+        {
+            // Drained; refill with everything waiting on the socket in one call.
+            mReceiveBatchIndex = 0;
+            if (!mReceiveBatch.receive(socket))
+            {
+                return 0;
+            }
+            mPacketsReceived += mReceiveBatch.getCount();
+        }
+
+        const LLPacketBuffer& packet = mReceiveBatch.get(mReceiveBatchIndex++);
+        S32 packet_size = 0;
+        const char* message = unwrapPacket(packet, packet_size, mLastSender);
+        if (!message)
+        {
+            // Not a proxied datagram, try the next one
+            continue;
+        }
+
+        memcpy(datap, message, packet_size);  /* Flawfinder: ignore */
+        mLastReceivingIF = packet.getReceivingInterface();
+        return packet_size;
+    }
+}
+
+// static
+const char* LLPacketRing::unwrapPacket(const LLPacketBuffer& packet, S32& size, LLHost& sender)
+{
+    size = packet.getSize();
+    if (!LLProxy::isSOCKSProxyEnabled())
+    {
+        sender = packet.getHost();
+        return packet.getData();
+    }
+
+    if (size <= SOCKS_HEADER_SIZE)
+    {
+        return NULL;
+    }
+
+    // *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+    const proxywrap_t * header = static_cast<const proxywrap_t*>(static_cast<const void*>(packet.getData()));
+    sender.setAddress(header->addr);
+    sender.setPort(ntohs(header->port));
+
+    size -= SOCKS_HEADER_SIZE; // The unwrapped packet size
+    return packet.getData() + SOCKS_HEADER_SIZE;
+}
 ///////////////////////////////////////////////////////////
 S32 LLPacketRing::receiveFromRing (S32 socket, char *datap)
 {
@@ -171,6 +261,7 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 
             if (packetp->getSize())
             {
+                mPacketsReceived++;
                 mActualBitsIn += packetp->getSize() * 8;
 
                 // Fake packet loss
@@ -224,7 +315,11 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
     else
     {
         // no delay, pull straight from net
-        if (LLProxy::isSOCKSProxyEnabled())
+        if (mUseBatching)
+        {
+            packet_size = receiveFromBatch(socket, datap);
+        }
+        else if (LLProxy::isSOCKSProxyEnabled())
         {
             U8 buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
             packet_size = receive_packet(socket, static_cast<char*>(static_cast<void*>(buffer)));
@@ -250,7 +345,14 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
             mLastSender = ::get_sender();
         }
 
-        mLastReceivingIF = ::get_receiving_interface();
+        if (!mUseBatching)
+        {
+            mLastReceivingIF = ::get_receiving_interface();
+            if (packet_size)
+            {
+                mPacketsReceived++;
+            }
+        }
 
         if (packet_size)  // did we actually get a packet?
         {
@@ -349,7 +451,26 @@ bool LLPacketRing::sendPacketImpl(int h_socket, const char * send_buffer, S32 bu
 
     if (!LLProxy::isSOCKSProxyEnabled())
     {
-        return send_packet(h_socket, send_buffer, buf_size, host.getAddress(), host.getPort());
+        if (mBatchingSends)
+        {
+            if (mSendBatch.isFull())
+            {
+                flushSendBatch(h_socket);
+                mBatchingSends = true;
+            }
+            if (mSendBatch.append(host, send_buffer, buf_size))
+            {
+                // Delivery failures are reported by flushSendBatch()
+                return true;
+            }
+        }
+
+        bool success = send_packet(h_socket, send_buffer, buf_size, host.getAddress(), host.getPort());
+        if (success)
+        {
+            mPacketsSent++;
+        }
+        return success;
     }
 
     char headered_send_buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
@@ -363,9 +484,14 @@ bool LLPacketRing::sendPacketImpl(int h_socket, const char * send_buffer, S32 bu
 
     memcpy(headered_send_buffer + SOCKS_HEADER_SIZE, send_buffer, buf_size);
 
-    return send_packet( h_socket,
+    bool success = send_packet( h_socket,
                         headered_send_buffer,
                         buf_size + SOCKS_HEADER_SIZE,
                         LLProxy::getInstance()->getUDPProxy().getAddress(),
                         LLProxy::getInstance()->getUDPProxy().getPort());
+    if (success)
+    {
+        mPacketsSent++;
+    }
+    return success;
 }
@@ -55,6 +55,30 @@ public:
 
     bool sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
+    // Finds the message in a datagram read off the socket, past the SOCKS 5
+    // UDP header when the proxy is enabled, and its real sender. Returns
+    // NULL if the datagram is too short to be a proxied message.
+    static const char* unwrapPacket(const LLPacketBuffer& packet, S32& size, LLHost& sender);
+
+    // True while inbound throttling or packet loss simulation is on. Both
+    // only work for packets read through receivePacket().
+    bool isSimulatingInbound() const { return mUseInThrottle || mDropPercentage > 0.f || mPacketsToDrop; }
+
+    // Batched socket I/O through LLPacketBufferPool, on by default. Applies
+    // to the unthrottled paths only; the throttles keep per-packet timing.
+    void setUseBatching(const bool use_batching);
+    bool getUseBatching() const                 { return mUseBatching; }
+    // Between these calls outgoing datagrams are queued and written with as
+    // few send_packets() calls as possible. Use around bursts such as acks
+    // and resends. Sends through a SOCKS proxy are never queued.
+    void beginSendBatch();
+    void flushSendBatch(int h_socket);
+
+    // Datagrams moved through the socket by this ring. Compare against
+    // get_receive_syscall_count()/get_send_syscall_count() to see batching.
+    U64 getPacketsReceived() const              { return mPacketsReceived; }
+    U64 getPacketsSent() const                  { return mPacketsSent; }
+
     inline LLHost getLastSender();
     inline LLHost getLastReceivingInterface();
 
@@ -83,7 +107,17 @@ protected:
     LLHost mLastSender;
     LLHost mLastReceivingIF;
 
+    bool mUseBatching;
+    bool mBatchingSends;
+    LLPacketBufferPool mReceiveBatch;   // datagrams read but not yet handed out
+    S32 mReceiveBatchIndex;             // next datagram to hand out of mReceiveBatch
+    LLPacketBufferPool mSendBatch;      // datagrams queued since beginSendBatch()
+
+    U64 mPacketsReceived;
+    U64 mPacketsSent;
+
 private:
+    S32  receiveFromBatch(S32 socket, char *datap);
     bool sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
 };
 
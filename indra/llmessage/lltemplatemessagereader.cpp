@@ -40,6 +40,52 @@
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
 
+namespace
+{
+    // Checks on decoded values, shared by the name and handle getters so
+    // both treat bad packet data the same way.
+    void finiteOrZero(F32& d, const char* getter, const char* block, const char* var)
+    {
+        if( !llfinite( d ) )
+        {
+            LL_WARNS() << "non-finite in " << getter << " " << block << " " << var
+                    << LL_ENDL;
+            d = 0;
+        }
+    }
+
+    void finiteOrZero(LLVector3& v, const char* getter, const char* block, const char* var)
+    {
+        if( !v.isFinite() )
+        {
+            LL_WARNS() << "non-finite in " << getter << " " << block << " "
+                    << var << LL_ENDL;
+            v.zeroVec();
+        }
+    }
+
+    void unpackQuat(const LLVector3& vec, LLQuaternion& q, const char* block, const char* var)
+    {
+        if( vec.isFinite() )
+        {
+            q.unpackFromVector3( vec );
+        }
+        else
+        {
+            LL_WARNS() << "non-finite in getQuatFast " << block << " " << var
+                    << LL_ENDL;
+            q.loadIdentity();
+        }
+    }
+
+    // 's' was filled by getData() with at most MTUBYTES bytes
+    void terminateString(char (&s)[MTUBYTES + 1], std::string& outstr)
+    {
+        s[MTUBYTES] = '\0';
+        outstr = s;
+    }
+}
+
 LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
                                                  number_template_map) :
     mReceiveSize(0),
@@ -63,6 +109,8 @@ void LLTemplateMessageReader::clearMessage()
     mCurrentRMessageTemplate = NULL;
     delete mCurrentRMessageData;
     mCurrentRMessageData = NULL;
+    mBlockInstances.clear();
+    mBlockStarts.clear();
 }
 
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
@@ -104,10 +152,37 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 
     LLMsgVarData& vardata = msg_block_data->mMemberVarData[vnamep];
 
+    copyData(vardata, datap, size, max_size);
+}
+
+void LLTemplateMessageReader::getData(const LLMessageVariableHandle& var, void *datap, S32 size, S32 blocknum, S32 max_size)
+{
+    const LLMessageVariableHandle::Binding* binding =
+        mCurrentRMessageData ? var.find(mCurrentRMessageTemplate) : NULL;
+    if (!binding)
+    {
+        getData(var.getBlockName(), var.getVariableName(), datap, size, blocknum, max_size);
+        return;
+    }
+
+    S32 first = mBlockStarts[binding->mBlock];
+    if (blocknum < 0 || first + blocknum >= mBlockStarts[binding->mBlock + 1])
+    {
+        LL_ERRS() << "Block " << var.getBlockName() << " #" << blocknum
+            << " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+        return;
+    }
+
+    const LLMsgBlkData* msg_block_data = mBlockInstances[first + blocknum];
+    copyData(*(msg_block_data->mMemberVarData.begin() + binding->mVariable), datap, size, max_size);
+}
+
+void LLTemplateMessageReader::copyData(const LLMsgVarData& vardata, void *datap, S32 size, S32 max_size) const
+{
     if (size && size != vardata.getSize())
     {
         LL_ERRS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
+            << " variable " << vardata.getName()
             << " is size " << vardata.getSize()
             << " but copying into buffer of size " << size
             << LL_ENDL;
@@ -121,17 +196,17 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
         switch( vardata_size )
         {
         case 1:
-            *((U8*)datap) = *((U8*)vardata.getData());
+            *((U8*)datap) = *((const U8*)vardata.getData());
             break;
         case 2:
-            *((U16*)datap) = *((U16*)vardata.getData());
+            *((U16*)datap) = *((const U16*)vardata.getData());
             break;
         case 4:
-            *((U32*)datap) = *((U32*)vardata.getData());
+            *((U32*)datap) = *((const U32*)vardata.getData());
             break;
         case 8:
-            ((U32*)datap)[0] = ((U32*)vardata.getData())[0];
-            ((U32*)datap)[1] = ((U32*)vardata.getData())[1];
+            ((U32*)datap)[0] = ((const U32*)vardata.getData())[0];
+            ((U32*)datap)[1] = ((const U32*)vardata.getData())[1];
             break;
         default:
             memcpy(datap, vardata.getData(), vardata_size);
@@ -141,7 +216,7 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
     else
     {
         LL_WARNS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
+            << " variable " << vardata.getName()
             << " is size " << vardata.getSize()
             << " but truncated to max size of " << max_size
             << LL_ENDL;
@@ -265,6 +340,38 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const
     return vardata.getSize();
 }
 
+S32 LLTemplateMessageReader::getNumberOfBlocks(const LLMessageVariableHandle& var)
+{
+    const LLMessageVariableHandle::Binding* binding =
+        mCurrentRMessageData ? var.find(mCurrentRMessageTemplate) : NULL;
+    if (!binding)
+    {
+        return getNumberOfBlocks(var.getBlockName());
+    }
+    return mBlockStarts[binding->mBlock + 1] - mBlockStarts[binding->mBlock];
+}
+
+S32 LLTemplateMessageReader::getSize(const LLMessageVariableHandle& var, S32 blocknum)
+{
+    const LLMessageVariableHandle::Binding* binding =
+        mCurrentRMessageData ? var.find(mCurrentRMessageTemplate) : NULL;
+    if (!binding)
+    {
+        return getSize(var.getBlockName(), blocknum, var.getVariableName());
+    }
+
+    S32 first = mBlockStarts[binding->mBlock];
+    if (blocknum < 0 || first + blocknum >= mBlockStarts[binding->mBlock + 1])
+    {   // don't crash
+        LL_INFOS() << "Block " << var.getBlockName() << " #" << blocknum
+            << " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+        return LL_BLOCK_NOT_IN_MESSAGE;
+    }
+
+    const LLMsgBlkData* msg_block_data = mBlockInstances[first + blocknum];
+    return (msg_block_data->mMemberVarData.begin() + binding->mVariable)->getSize();
+}
+
 void LLTemplateMessageReader::getBinaryData(const char *blockname,
                                             const char *varname, void *datap,
                                             S32 size, S32 blocknum,
@@ -327,13 +434,7 @@ void LLTemplateMessageReader::getF32(const char *block, const char *var,
                                      F32 &d, S32 blocknum)
 {
     getData(block, var, &d, sizeof(F32), blocknum);
-
-    if( !llfinite( d ) )
-    {
-        LL_WARNS() << "non-finite in getF32Fast " << block << " " << var
-                << LL_ENDL;
-        d = 0;
-    }
+    finiteOrZero(d, "getF32Fast", block, var);
 }
 
 void LLTemplateMessageReader::getF64(const char *block, const char *var,
@@ -353,13 +454,7 @@ void LLTemplateMessageReader::getVector3(const char *block, const char *var,
                                          LLVector3 &v, S32 blocknum )
 {
     getData(block, var, &v.mV[0], sizeof(v.mV), blocknum);
-
-    if( !v.isFinite() )
-    {
-        LL_WARNS() << "non-finite in getVector3Fast " << block << " "
-                << var << LL_ENDL;
-        v.zeroVec();
-    }
+    finiteOrZero(v, "getVector3Fast", block, var);
 }
 
 void LLTemplateMessageReader::getVector4(const char *block, const char *var,
@@ -394,16 +489,7 @@ void LLTemplateMessageReader::getQuat(const char *block, const char *var,
 {
     LLVector3 vec;
     getData(block, var, &vec.mV[0], sizeof(vec.mV), blocknum);
-    if( vec.isFinite() )
-    {
-        q.unpackFromVector3( vec );
-    }
-    else
-    {
-        LL_WARNS() << "non-finite in getQuatFast " << block << " " << var
-                << LL_ENDL;
-        q.loadIdentity();
-    }
+    unpackQuat(vec, q, block, var);
 }
 
 void LLTemplateMessageReader::getUUID(const char *block, const char *var,
@@ -434,8 +520,70 @@ inline void LLTemplateMessageReader::getString(const char *block, const char *va
 {
     char s[MTUBYTES + 1]= {0}; // every element is initialized with 0
     getData(block, var, s, 0, blocknum, MTUBYTES);
-    s[MTUBYTES] = '\0';
-    outstr = s;
+    terminateString(s, outstr);
+}
+
+void LLTemplateMessageReader::getBOOL(const LLMessageVariableHandle& var, bool &b, S32 blocknum)
+{
+    U8 value(0);
+    getData(var, &value, sizeof(U8), blocknum);
+    b = (bool)value;
+}
+
+void LLTemplateMessageReader::getU8(const LLMessageVariableHandle& var, U8 &u, S32 blocknum)
+{
+    getData(var, &u, sizeof(U8), blocknum);
+}
+
+void LLTemplateMessageReader::getU16(const LLMessageVariableHandle& var, U16 &d, S32 blocknum)
+{
+    getData(var, &d, sizeof(U16), blocknum);
+}
+
+void LLTemplateMessageReader::getS32(const LLMessageVariableHandle& var, S32 &d, S32 blocknum)
+{
+    getData(var, &d, sizeof(S32), blocknum);
+}
+
+void LLTemplateMessageReader::getU32(const LLMessageVariableHandle& var, U32 &d, S32 blocknum)
+{
+    getData(var, &d, sizeof(U32), blocknum);
+}
+
+void LLTemplateMessageReader::getU64(const LLMessageVariableHandle& var, U64 &d, S32 blocknum)
+{
+    getData(var, &d, sizeof(U64), blocknum);
+}
+
+void LLTemplateMessageReader::getF32(const LLMessageVariableHandle& var, F32 &d, S32 blocknum)
+{
+    getData(var, &d, sizeof(F32), blocknum);
+    finiteOrZero(d, "getF32Fast", var.getBlockName(), var.getVariableName());
+}
+
+void LLTemplateMessageReader::getVector3(const LLMessageVariableHandle& var, LLVector3 &v, S32 blocknum)
+{
+    getData(var, &v.mV[0], sizeof(v.mV), blocknum);
+    finiteOrZero(v, "getVector3Fast", var.getBlockName(), var.getVariableName());
+}
+
+void LLTemplateMessageReader::getQuat(const LLMessageVariableHandle& var, LLQuaternion &q, S32 blocknum)
+{
+    LLVector3 vec;
+    getData(var, &vec.mV[0], sizeof(vec.mV), blocknum);
+    unpackQuat(vec, q, var.getBlockName(), var.getVariableName());
+}
+
+void LLTemplateMessageReader::getUUID(const LLMessageVariableHandle& var, LLUUID &u, S32 blocknum)
+{
+    getData(var, &u.mData[0], sizeof(u.mData), blocknum);
+}
+
+void LLTemplateMessageReader::getString(const LLMessageVariableHandle& var, std::string& outstr, S32 blocknum)
+{
+    char s[MTUBYTES + 1]= {0}; // every element is initialized with 0
+    getData(var, s, 0, blocknum, MTUBYTES);
+    terminateString(s, outstr);
 }
 
 //virtual
@@ -444,22 +592,11 @@ S32 LLTemplateMessageReader::getMessageSize() const
     return mReceiveSize;
 }
 
-// Returns template for the message contained in buffer
-bool LLTemplateMessageReader::decodeTemplate(
-        const U8* buffer, S32 buffer_size,  // inputs
-        LLMessageTemplate** msg_template ) // outputs
+// static
+bool LLTemplateMessageReader::decodeMessageNumber(const U8* buffer, S32 buffer_size, U32& num)
 {
     const U8* header = buffer + LL_PACKET_ID_SIZE;
 
-    // is there a message ready to go?
-    if (buffer_size <= 0)
-    {
-        LL_WARNS() << "No message waiting for decode!" << LL_ENDL;
-        return(false);
-    }
-
-    U32 num = 0;
-
     if (header[0] != 255)
     {
         // high frequency message
@@ -489,6 +626,27 @@ bool LLTemplateMessageReader::decodeTemplate(
     }
     else // bogus packet received (too short)
     {
+        return false;
+    }
+    return true;
+}
+
+// Returns template for the message contained in buffer
+bool LLTemplateMessageReader::decodeTemplate(
+        const U8* buffer, S32 buffer_size,  // inputs
+        LLMessageTemplate** msg_template ) // outputs
+{
+    // is there a message ready to go?
+    if (buffer_size <= 0)
+    {
+        LL_WARNS() << "No message waiting for decode!" << LL_ENDL;
+        return(false);
+    }
+
+    U32 num = 0;
+    if (!decodeMessageNumber(buffer, buffer_size, num))
+    {
+        // bogus packet received (too short)
         LL_WARNS() << "Packet with unusable length received (too short): "
                 << buffer_size << LL_ENDL;
         return(false);
@@ -554,6 +712,8 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
     // create base working data set
     mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+    mBlockInstances.clear();
+    mBlockStarts.clear();
 
     // loop through the template building the data structure as we go
     LLMessageTemplate::message_block_map_t::const_iterator iter;
@@ -566,6 +726,8 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
         U8  repeat_number;
         S32 i;
 
+        mBlockStarts.push_back((S32)mBlockInstances.size());
+
         // how many of this block?
 
         if (mbci->mType == MBT_SINGLE)
@@ -629,6 +791,7 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
             // add the block to the message
             mCurrentRMessageData->addBlock(cur_data_block);
+            mBlockInstances.push_back(cur_data_block);
 
             // now read the variables
             for (LLMessageBlock::message_variable_map_t::const_iterator iter =
@@ -710,6 +873,8 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
         }
     }
 
+    mBlockStarts.push_back((S32)mBlockInstances.size());
+
     if (mCurrentRMessageData->mMemberBlocks.empty()
         && !mCurrentRMessageTemplate->mMemberBlocks.empty())
     {
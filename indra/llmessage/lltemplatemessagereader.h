@@ -30,9 +30,13 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>
 
 class LLMessageTemplate;
+class LLMessageVariableHandle;
+class LLMsgBlkData;
 class LLMsgData;
+class LLMsgVarData;
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -91,6 +95,25 @@ public:
     virtual S32 getSize(const char *blockname, S32 blocknum,
                         const char *varname);
 
+    /** Handle overloads of the above, see LLMessageVariableHandle. A
+     *  handle that is not bound to the current message's template is
+     *  read by name. They apply the same checks as the name getters. */
+    void getData(const LLMessageVariableHandle& var, void *datap,
+                 S32 size = 0, S32 blocknum = 0, S32 max_size = S32_MAX);
+    void getBOOL(const LLMessageVariableHandle& var, bool &data, S32 blocknum = 0);
+    void getU8(const LLMessageVariableHandle& var, U8 &data, S32 blocknum = 0);
+    void getU16(const LLMessageVariableHandle& var, U16 &data, S32 blocknum = 0);
+    void getS32(const LLMessageVariableHandle& var, S32 &data, S32 blocknum = 0);
+    void getU32(const LLMessageVariableHandle& var, U32 &data, S32 blocknum = 0);
+    void getU64(const LLMessageVariableHandle& var, U64 &data, S32 blocknum = 0);
+    void getF32(const LLMessageVariableHandle& var, F32 &data, S32 blocknum = 0);
+    void getVector3(const LLMessageVariableHandle& var, LLVector3 &vec, S32 blocknum = 0);
+    void getQuat(const LLMessageVariableHandle& var, LLQuaternion &q, S32 blocknum = 0);
+    void getUUID(const LLMessageVariableHandle& var, LLUUID &uuid, S32 blocknum = 0);
+    void getString(const LLMessageVariableHandle& var, std::string& outstr, S32 blocknum = 0);
+    S32 getNumberOfBlocks(const LLMessageVariableHandle& var);
+    S32 getSize(const LLMessageVariableHandle& var, S32 blocknum);
+
     virtual void clearMessage();
 
     virtual const char* getMessageName() const;
@@ -106,11 +129,18 @@ public:
     bool isBanned(bool trusted_source) const;
     bool isUdpBanned() const;
 
+    // Reads the message number that follows the packet header. Returns
+    // false if buffer is too short to hold it.
+    static bool decodeMessageNumber(const U8* buffer, S32 buffer_size, U32& num);
+
 private:
 
     void getData(const char *blockname, const char *varname, void *datap,
                  S32 size = 0, S32 blocknum = 0, S32 max_size = S32_MAX);
 
+    void copyData(const LLMsgVarData& vardata, void *datap,
+                  S32 size, S32 max_size) const;
+
     bool decodeTemplate(const U8* buffer, S32 buffer_size,  // inputs
                         LLMessageTemplate** msg_template ); // outputs
 
@@ -122,6 +152,13 @@ private:
     LLMessageTemplate* mCurrentRMessageTemplate;
     LLMsgData* mCurrentRMessageData;
     message_template_number_map_t& mMessageNumbers;
+
+    // Decoded blocks of the current message in template order, so that a
+    // bound LLMessageVariableHandle can find one by index. The instances of
+    // template block b are mBlockInstances[mBlockStarts[b]] up to
+    // mBlockInstances[mBlockStarts[b + 1]].
+    std::vector<LLMsgBlkData*> mBlockInstances;
+    std::vector<S32> mBlockStarts;
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -186,11 +186,19 @@ void LLMessageSystem::init()
     mIncomingCompressedSize = 0;
     mCurrentRecvPacketID = 0;
 
+    mUseReceiveThread = false;
+    mReceiveThread = NULL;
+    mThreadPacket = NULL;
+    mThreadPacketsReceived = 0;
+
     mMessageFileVersionNumber = 0.f;
 
     mTimingCallback = NULL;
     mTimingCallbackData = NULL;
 
+    mReceiveCallback = NULL;
+    mReceiveCallbackData = NULL;
+
     mMessageBuilder = NULL;
     LockMessageReader(mMessageReader, NULL);
 }
@@ -324,6 +332,12 @@ void LLMessageSystem::loadTemplateFile(const std::string& filename, bool failure
 
 LLMessageSystem::~LLMessageSystem()
 {
+    // Before the socket and circuits go away
+    if (mReceiveThread)
+    {
+        deleteReceiveThread();
+    }
+
     mMessageTemplates.clear(); // don't delete templates.
     for_each(mMessageNumbers.begin(), mMessageNumbers.end(), DeletePairedPointer());
     mMessageNumbers.clear();
@@ -494,6 +508,11 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 
     LLTransferTargetVFile::updateQueue();
 
+    if (mUseReceiveThread)
+    {
+        updateReceiveThread();
+    }
+
     if (!mNumMessageCounts)
     {
         // This is the first message being handled after a resetReceiveCounts,
@@ -511,18 +530,43 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 
         bool recv_reliable = false;
         bool recv_resent = false;
+        bool acked_on_thread = false;
         S32 acks = 0;
         S32 true_rcv_size = 0;
+        const U8* ack_data = NULL;  // appended acks, in the order sent
 
         U8* buffer = mTrueReceiveBuffer;
 
-        mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
-        // If you want to dump all received packets into SecondLife.log, uncomment this
-        //dumpPacketToLog();
+        if (mReceiveThread)
+        {
+            // Already size checked, split from its acks and expanded on the network thread
+            if (mReceiveThread->popPacket(*mThreadPacket))
+            {
+                mTrueReceiveSize = mThreadPacket->mWireSize;
+                receive_size = mThreadPacket->mSize;
+                mLastSender = mThreadPacket->mSender;
+                mLastReceivingIF = mThreadPacket->mReceivingIF;
+            }
+            else
+            {
+                mTrueReceiveSize = receive_size = 0;
+                if (mReceiveThread->isStopped())
+                {
+                    // Stopped or crashed, and drained: back to reading the socket here
+                    deleteReceiveThread();
+                }
+            }
+        }
+        else
+        {
+            mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
+            // If you want to dump all received packets into SecondLife.log, uncomment this
+            //dumpPacketToLog();
 
-        receive_size = mTrueReceiveSize;
-        mLastSender = mPacketRing.getLastSender();
-        mLastReceivingIF = mPacketRing.getLastReceivingInterface();
+            receive_size = mTrueReceiveSize;
+            mLastSender = mPacketRing.getLastSender();
+            mLastReceivingIF = mPacketRing.getLastReceivingInterface();
+        }
 
         if (receive_size < (S32) LL_MINIMUM_VALID_PACKET_SIZE)
         {
@@ -541,29 +585,55 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
             LLHost host;
             LLCircuitData* cdp;
 
-            // note if packet acks are appended.
-            if(buffer[0] & LL_ACK_FLAG)
+            if (mReceiveThread)
             {
-                acks += buffer[--receive_size];
-                true_rcv_size = receive_size;
-                if(receive_size >= ((S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE)))
+                buffer = mThreadPacket->mData;
+                acks = mThreadPacket->mAckCount;
+                ack_data = mThreadPacket->mAckData;
+                true_rcv_size = mTrueReceiveSize - (acks ? 1 : 0);
+                acked_on_thread = mThreadPacket->mAcked;
+                mIncomingCompressedSize = mThreadPacket->mCompressedSize;
+
+                // The byte counts zeroCodeExpand() would have kept
+                if (mIncomingCompressedSize)
                 {
-                    receive_size -= acks * sizeof(TPACKETID);
+                    mTotalBytesIn += mIncomingCompressedSize;
+                    mCompressedPacketsIn++;
+                    mCompressedBytesIn += mIncomingCompressedSize;
+                    mUncompressedBytesIn += receive_size;
                 }
                 else
                 {
-                    // mal-formed packet. ignore it and continue with
-                    // the next one
-                    LL_WARNS("Messaging") << "Malformed packet received. Packet size "
-                        << receive_size << " with invalid no. of acks " << acks
-                        << LL_ENDL;
-                    valid_packet = false;
-                    continue;
+                    mTotalBytesIn += receive_size;
                 }
             }
+            else
+            {
+                // note if packet acks are appended.
+                if(buffer[0] & LL_ACK_FLAG)
+                {
+                    acks += buffer[--receive_size];
+                    true_rcv_size = receive_size;
+                    if(receive_size >= ((S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE)))
+                    {
+                        receive_size -= acks * sizeof(TPACKETID);
+                        ack_data = &mTrueReceiveBuffer[receive_size];
+                    }
+                    else
+                    {
+                        // mal-formed packet. ignore it and continue with
+                        // the next one
+                        LL_WARNS("Messaging") << "Malformed packet received. Packet size "
+                            << receive_size << " with invalid no. of acks " << acks
+                            << LL_ENDL;
+                        valid_packet = false;
+                        continue;
+                    }
+                }
 
-            // process the message as normal
-            mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+                // process the message as normal
+                mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+            }
             mCurrentRecvPacketID = ntohl(*((U32*)(&buffer[1])));
             host = getSender();
 
@@ -578,10 +648,9 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
             {
                 TPACKETID packet_id;
                 U32 mem_id=0;
-                for(S32 i = 0; i < acks; ++i)
+                for(S32 i = acks - 1; i >= 0; --i)
                 {
-                    true_rcv_size -= sizeof(TPACKETID);
-                    memcpy(&mem_id, &mTrueReceiveBuffer[true_rcv_size], /* Flawfinder: ignore*/
+                    memcpy(&mem_id, &ack_data[i * sizeof(TPACKETID)], /* Flawfinder: ignore*/
                          sizeof(TPACKETID));
                     packet_id = ntohl(mem_id);
                     //LL_INFOS("Messaging") << "got ack: " << packet_id << LL_ENDL;
@@ -606,7 +675,7 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
                     // We need to ACK here to suppress
                     // further resends of packets we've
                     // already seen.
-                    if (recv_reliable)
+                    if (recv_reliable && !acked_on_thread)
                     {
                         //mAckList.addData(new LLPacketAck(host, mCurrentRecvPacketID));
                         // ***************************************
@@ -687,6 +756,12 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
             {
                 logValidMsg(cdp, host, recv_reliable, recv_resent, acks>0 );
 
+                if (mReceiveCallback)
+                {
+                    mReceiveCallback(mTemplateMessageReader->getMessageName(), buffer, receive_size,
+                                     mReceiveCallbackData);
+                }
+
                 // <FS:ND> Handle invalid packets by throwing an exception and a graceful continue
 
                 // valid_packet = mTemplateMessageReader->readMessage(buffer, host);
@@ -714,7 +789,10 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
                     cdp->mRecentlyReceivedReliablePackets[mCurrentRecvPacketID] = getMessageTimeUsecs();
 
                     // Put it onto the list of packets to be acked
-                    cdp->collectRAck(mCurrentRecvPacketID);
+                    if (!acked_on_thread)
+                    {
+                        cdp->collectRAck(mCurrentRecvPacketID);
+                    }
                     mReliablePacketsIn++;
                 }
             }
@@ -749,6 +827,81 @@ bool LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
     return valid_packet;
 }
 
+void LLMessageSystem::startReceiveThread()
+{
+    mUseReceiveThread = true;
+    updateReceiveThread();
+}
+
+void LLMessageSystem::stopReceiveThread()
+{
+    mUseReceiveThread = false;
+    if (mReceiveThread)
+    {
+        shutdownReceiveThread();
+    }
+}
+
+void LLMessageSystem::updateReceiveThread()
+{
+    bool simulating = mPacketRing.isSimulatingInbound();
+    if (mReceiveThread)
+    {
+        if (simulating && !mReceiveThread->isStopped())
+        {
+            LL_INFOS("Messaging") << "Inbound packet simulation on, reading through the packet ring" << LL_ENDL;
+            shutdownReceiveThread();
+        }
+    }
+    else if (mUseReceiveThread && !simulating && !mbError)
+    {
+        createReceiveThread();
+    }
+}
+
+void LLMessageSystem::createReceiveThread()
+{
+    LL_INFOS("Messaging") << "Starting network receive thread" << LL_ENDL;
+    mThreadPacket = new LLReceivedPacket;
+    mReceiveThread = new LLMessageReceiveThread(mSocket, mCircuitInfo, mAckLatency, mMessageNumbers);
+    mReceiveThread->start();
+}
+
+void LLMessageSystem::shutdownReceiveThread()
+{
+    // Packets still queued have been acked already, so they must be
+    // handled; checkMessages() drains them and then deletes the thread.
+    mReceiveThread->shutdown();
+    if (!mReceiveThread->getQueueDepth())
+    {
+        deleteReceiveThread();
+    }
+}
+
+void LLMessageSystem::deleteReceiveThread()
+{
+    LL_INFOS("Messaging") << "Network receive thread stopped after "
+        << mReceiveThread->getPacketsReceived() << " packets, "
+        << mReceiveThread->getAcksSent() << " acks sent, "
+        << mReceiveThread->getPacketsDiscarded() << " discarded" << LL_ENDL;
+
+    mThreadPacketsReceived += mReceiveThread->getPacketsReceived();
+    delete mReceiveThread;
+    mReceiveThread = NULL;
+    delete mThreadPacket;
+    mThreadPacket = NULL;
+}
+
+S32 LLMessageSystem::getReceiveQueueDepth() const
+{
+    return mReceiveThread ? mReceiveThread->getQueueDepth() : 0;
+}
+
+S32 LLMessageSystem::getAndResetMaxReceiveQueueDepth()
+{
+    return mReceiveThread ? mReceiveThread->getAndResetMaxQueueDepth() : 0;
+}
+
 S32 LLMessageSystem::getReceiveBytes() const
 {
     if (getReceiveCompressedSize())
@@ -781,6 +934,10 @@ void LLMessageSystem::processAcks(LockMessageChecker&, F32 collect_time)
 
     bool dump = false;
     {
+        // Acks, resends and denials come in bursts; write them with as few
+        // socket calls as possible.
+        mPacketRing.beginSendBatch();
+
         // Check the status of circuits
         mCircuitInfo.updateWatchDogTimers(this);
 
@@ -800,6 +957,8 @@ void LLMessageSystem::processAcks(LockMessageChecker&, F32 collect_time)
             mDenyTrustedCircuitSet.clear();
         }
 
+        mPacketRing.flushSendBatch(mSocket);
+
         if (mMaxMessageCounts >= 0)
         {
             if (mNumMessageCounts >= mMaxMessageCounts)
@@ -2623,6 +2782,18 @@ void LLMessageSystem::summarizeLogs(std::ostream& str)
     buffer = llformat( "Off-circuit rejected packets: %17d", mOffCircuitPackets);
     str << buffer << std::endl;
     buffer = llformat( "On-circuit invalid packets:   %17d", mInvalidOnCircuitPackets);
+    str << buffer << std::endl;
+    // The syscall count includes the receive thread's reads, which bypass mPacketRing
+    U64 packets_received = mPacketRing.getPacketsReceived() + mThreadPacketsReceived;
+    if (mReceiveThread)
+    {
+        packets_received += mReceiveThread->getPacketsReceived();
+    }
+    tmp_str = U64_to_str(get_receive_syscall_count());
+    buffer = llformat( "Receive system calls:      %20s (%5.2f packets per call)", tmp_str.c_str(), (F32)packets_received / (F32)(get_receive_syscall_count() + 1));
+    str << buffer << std::endl;
+    tmp_str = U64_to_str(get_send_syscall_count());
+    buffer = llformat( "Send system calls:         %20s (%5.2f packets per call)", tmp_str.c_str(), (F32)mPacketRing.getPacketsSent() / (F32)(get_send_syscall_count() + 1));
     str << buffer << std::endl << std::endl;
 
     str << "Decoding: " << std::endl;
@@ -2949,6 +3120,18 @@ void LLMessageSystem::setHandlerFuncFast(const char *name, void (*handler_func)(
     }
 }
 
+bool LLMessageSystem::bindVariableHandleFast(LLMessageVariableHandle& var, const char* name,
+                                             const char* blockname, const char* varname)
+{
+    LLMessageTemplate* msgtemplate = get_ptr_in_map(mMessageTemplates, name);
+    if (!msgtemplate)
+    {
+        LL_WARNS("Messaging") << name << " is not a known message name!" << LL_ENDL;
+        return false;
+    }
+    return var.bind(msgtemplate, blockname, varname);
+}
+
 bool LLMessageSystem::callHandler(const char *name,
         bool trustedSource, LLMessageSystem* msg)
 {
@@ -3020,6 +3203,12 @@ void LLMessageSystem::setTimingFunc(msg_timing_callback func, void* data)
     mTimingCallbackData = data;
 }
 
+void LLMessageSystem::setReceiveFunc(msg_receive_callback func, void* data)
+{
+    mReceiveCallback = func;
+    mReceiveCallbackData = data;
+}
+
 bool LLMessageSystem::isCircuitCodeKnown(U32 code) const
 {
     if(mCircuitCodes.find(code) == mCircuitCodes.end())
@@ -3934,6 +4123,164 @@ void LLMessageSystem::getString(const char *block, const char *var,
                   blocknum);
 }
 
+void LLMessageSystem::getBinaryDataFast(const LLMessageVariableHandle& var,
+                                        void *datap, S32 size, S32 blocknum,
+                                        S32 max_size)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getData(var, datap, size, blocknum, max_size);
+    }
+    else
+    {
+        mMessageReader->getBinaryData(var.getBlockName(), var.getVariableName(),
+                                      datap, size, blocknum, max_size);
+    }
+}
+
+void LLMessageSystem::getBOOLFast(const LLMessageVariableHandle& var, bool &b,
+                                  S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getBOOL(var, b, blocknum);
+    }
+    else
+    {
+        mMessageReader->getBOOL(var.getBlockName(), var.getVariableName(), b, blocknum);
+    }
+}
+
+void LLMessageSystem::getU8Fast(const LLMessageVariableHandle& var, U8 &u,
+                                S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getU8(var, u, blocknum);
+    }
+    else
+    {
+        mMessageReader->getU8(var.getBlockName(), var.getVariableName(), u, blocknum);
+    }
+}
+
+void LLMessageSystem::getU16Fast(const LLMessageVariableHandle& var, U16 &d,
+                                 S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getU16(var, d, blocknum);
+    }
+    else
+    {
+        mMessageReader->getU16(var.getBlockName(), var.getVariableName(), d, blocknum);
+    }
+}
+
+void LLMessageSystem::getS32Fast(const LLMessageVariableHandle& var, S32 &d,
+                                 S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getS32(var, d, blocknum);
+    }
+    else
+    {
+        mMessageReader->getS32(var.getBlockName(), var.getVariableName(), d, blocknum);
+    }
+}
+
+void LLMessageSystem::getU32Fast(const LLMessageVariableHandle& var, U32 &d,
+                                 S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getU32(var, d, blocknum);
+    }
+    else
+    {
+        mMessageReader->getU32(var.getBlockName(), var.getVariableName(), d, blocknum);
+    }
+}
+
+void LLMessageSystem::getU64Fast(const LLMessageVariableHandle& var, U64 &d,
+                                 S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getU64(var, d, blocknum);
+    }
+    else
+    {
+        mMessageReader->getU64(var.getBlockName(), var.getVariableName(), d, blocknum);
+    }
+}
+
+void LLMessageSystem::getF32Fast(const LLMessageVariableHandle& var, F32 &d,
+                                 S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getF32(var, d, blocknum);
+    }
+    else
+    {
+        mMessageReader->getF32(var.getBlockName(), var.getVariableName(), d, blocknum);
+    }
+}
+
+void LLMessageSystem::getVector3Fast(const LLMessageVariableHandle& var,
+                                     LLVector3 &v, S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getVector3(var, v, blocknum);
+    }
+    else
+    {
+        mMessageReader->getVector3(var.getBlockName(), var.getVariableName(), v, blocknum);
+    }
+}
+
+void LLMessageSystem::getQuatFast(const LLMessageVariableHandle& var,
+                                  LLQuaternion &q, S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getQuat(var, q, blocknum);
+    }
+    else
+    {
+        mMessageReader->getQuat(var.getBlockName(), var.getVariableName(), q, blocknum);
+    }
+}
+
+void LLMessageSystem::getUUIDFast(const LLMessageVariableHandle& var,
+                                  LLUUID &u, S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getUUID(var, u, blocknum);
+    }
+    else
+    {
+        mMessageReader->getUUID(var.getBlockName(), var.getVariableName(), u, blocknum);
+    }
+}
+
+void LLMessageSystem::getStringFast(const LLMessageVariableHandle& var,
+                                    std::string& outstr, S32 blocknum)
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        mTemplateMessageReader->getString(var, outstr, blocknum);
+    }
+    else
+    {
+        mMessageReader->getString(var.getBlockName(), var.getVariableName(), outstr, blocknum);
+    }
+}
+
 bool    LLMessageSystem::has(const char *blockname) const
 {
     return getNumberOfBlocks(blockname) > 0;
@@ -3974,6 +4321,24 @@ S32 LLMessageSystem::getSize(const char *blockname, S32 blocknum,
                        LLMessageStringTable::getInstance()->getString(varname));
 }
 
+S32 LLMessageSystem::getNumberOfBlocksFast(const LLMessageVariableHandle& var) const
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        return mTemplateMessageReader->getNumberOfBlocks(var);
+    }
+    return mMessageReader->getNumberOfBlocks(var.getBlockName());
+}
+
+S32 LLMessageSystem::getSizeFast(const LLMessageVariableHandle& var, S32 blocknum) const
+{
+    if (mMessageReader == mTemplateMessageReader)
+    {
+        return mTemplateMessageReader->getSize(var, blocknum);
+    }
+    return mMessageReader->getSize(var.getBlockName(), blocknum, var.getVariableName());
+}
+
 S32 LLMessageSystem::getReceiveSize() const
 {
     return mMessageReader->getMessageSize();
@@ -45,6 +45,7 @@
 #include "llcircuit.h"
 #include "lltimer.h"
 #include "llpacketring.h"
+#include "llmessagereceivethread.h"
 #include "llhost.h"
 #include "llhttpnode.h"
 //#include "llpacketack.h"
@@ -186,6 +187,59 @@ class LLMessageReader;
 class LLTemplateMessageReader;
 class LLSDMessageReader;
 
+/**
+ * Pre-resolved reference to one variable of a message block.
+ *
+ * The get*Fast() accessors find a variable with a map search on the block
+ * name and another on the variable name, on every call. A handle is bound
+ * once, normally next to the setHandlerFuncFast() call, to the template of
+ * each message it will be read from. Reading through it then costs a
+ * template pointer compare and two vector indexes into the decoded message.
+ *
+ * Reads from a message the handle was not bound to, or from a message
+ * delivered as LLSD, fall back to the name lookup, so a handle is never
+ * less correct than the names it was built from.
+ */
+class LLMessageVariableHandle
+{
+public:
+    struct Binding
+    {
+        const LLMessageTemplate*    mTemplate;
+        S32                         mBlock;     // index in template block order
+        S32                         mVariable;  // index in template variable order
+    };
+
+    LLMessageVariableHandle() : mBlockName(NULL), mVariableName(NULL), mBindingCount(0) {}
+
+    // Adds a binding for blockname.varname (canonical strings) in
+    // msgtemplate. Returns false if the variable is not in that message
+    // or the handle is already bound to MAX_BINDINGS other templates.
+    bool bind(const LLMessageTemplate* msgtemplate, const char* blockname, const char* varname);
+
+    const Binding* find(const LLMessageTemplate* msgtemplate) const
+    {
+        for (S32 i = 0; i < mBindingCount; ++i)
+        {
+            if (mBindings[i].mTemplate == msgtemplate)
+            {
+                return &mBindings[i];
+            }
+        }
+        return NULL;
+    }
+
+    const char* getBlockName() const    { return mBlockName; }
+    const char* getVariableName() const { return mVariableName; }
+
+    static const S32 MAX_BINDINGS = 4;
+
+private:
+    const char* mBlockName;
+    const char* mVariableName;
+    Binding     mBindings[MAX_BINDINGS];
+    S32         mBindingCount;
+};
 
 
 class LLUseCircuitCodeResponder
@@ -386,6 +440,11 @@ public:
         setHandlerFuncFast(LLMessageStringTable::getInstance()->getString(name), handler_func, user_data);
     }
 
+    // Binds var to blockname.varname of message name; see
+    // LLMessageVariableHandle. Returns false if the message has no such
+    // variable.
+    bool    bindVariableHandleFast(LLMessageVariableHandle& var, const char* name, const char* blockname, const char* varname);
+
     // Set a callback function for a message system exception.
     void setExceptionFunc(EMessageException exception, msg_exception_callback func, void* data = NULL);
     // Call the specified exception func, and return true if a
@@ -406,6 +465,13 @@ public:
         return mTimingCallbackData;
     }
 
+    // Set a function that will be called with each valid template message
+    // just before its handler runs, with the hashed message name and the
+    // packet after zero-code expansion, header included.  Used to record
+    // message streams for offline replay.
+    typedef void (*msg_receive_callback)(const char* hashed_name, const U8* buffer, S32 size, void* data);
+    void setReceiveFunc(msg_receive_callback func, void* data = NULL);
+
     // This method returns true if the code is in the circuit codes map.
     bool isCircuitCodeKnown(U32 code) const;
 
@@ -638,6 +704,20 @@ public:
     void getStringFast( const char *block, const char *var, std::string& outstr, S32 blocknum = 0);
     void    getString(  const char *block, const char *var, std::string& outstr, S32 blocknum = 0);
 
+    // Same as the above, reading through a bound LLMessageVariableHandle.
+    void    getBinaryDataFast(const LLMessageVariableHandle& var, void *datap, S32 size, S32 blocknum = 0, S32 max_size = S32_MAX);
+    void    getBOOLFast(    const LLMessageVariableHandle& var, bool &data, S32 blocknum = 0);
+    void    getU8Fast(      const LLMessageVariableHandle& var, U8 &data, S32 blocknum = 0);
+    void    getU16Fast(     const LLMessageVariableHandle& var, U16 &data, S32 blocknum = 0);
+    void    getS32Fast(     const LLMessageVariableHandle& var, S32 &data, S32 blocknum = 0);
+    void    getU32Fast(     const LLMessageVariableHandle& var, U32 &data, S32 blocknum = 0);
+    void    getU64Fast(     const LLMessageVariableHandle& var, U64 &data, S32 blocknum = 0);
+    void    getF32Fast(     const LLMessageVariableHandle& var, F32 &data, S32 blocknum = 0);
+    void    getVector3Fast( const LLMessageVariableHandle& var, LLVector3 &vec, S32 blocknum = 0);
+    void    getQuatFast(    const LLMessageVariableHandle& var, LLQuaternion &q, S32 blocknum = 0);
+    void    getUUIDFast(    const LLMessageVariableHandle& var, LLUUID &uuid, S32 blocknum = 0);
+    void    getStringFast(  const LLMessageVariableHandle& var, std::string& outstr, S32 blocknum = 0);
+
 
     // Utility functions to generate a replay-resistant digest check
     // against the shared secret. The window specifies how much of a
@@ -733,6 +813,8 @@ public:
     S32     getSizeFast(const char *blockname, S32 blocknum,
                         const char *varname) const; // size in bytes of data
     S32     getSize(const char *blockname, S32 blocknum, const char *varname) const;
+    S32     getNumberOfBlocksFast(const LLMessageVariableHandle& var) const;
+    S32     getSizeFast(const LLMessageVariableHandle& var, S32 blocknum) const;
 
     void    resetReceiveCounts();               // resets receive counts for all message types to 0
     void    dumpReceiveCounts();                // dumps receive count for each message type to LL_INFOS()
@@ -753,6 +835,23 @@ public:
 
     S32     getUnackedListSize() const          { return mUnackedListSize; }
 
+    // Moves socket reads, ack sending and zero-code expansion onto a
+    // dedicated network thread (see LLMessageReceiveThread). Decoding and
+    // handlers still run from checkMessages() on the calling thread. While
+    // mPacketRing throttles or drops inbound packets, checkMessages() reads
+    // through the ring instead and resumes the thread afterwards.
+    void    startReceiveThread();
+    void    stopReceiveThread();
+    bool    isReceiveThreadRunning() const      { return mReceiveThread && !mReceiveThread->isStopped(); }
+
+    // Packets received on the network thread but not yet handled, now and
+    // at most since the previous call. Zero without the thread.
+    S32     getReceiveQueueDepth() const;
+    S32     getAndResetMaxReceiveQueueDepth();
+
+    // Time from receiving a reliable packet to sending its ack
+    LLAckLatencyStats& getAckLatencyStats()     { return mAckLatency; }
+
     //const char* getCurrentSMessageName() const { return mCurrentSMessageName; }
     //const char* getCurrentSBlockName() const { return mCurrentSBlockName; }
 
@@ -863,6 +962,18 @@ private:
     U8  mTrueReceiveBuffer[MAX_BUFFER_SIZE];
     S32 mTrueReceiveSize;
 
+    void createReceiveThread();
+    void shutdownReceiveThread();
+    void deleteReceiveThread();
+    // Starts or stops mReceiveThread as mPacketRing's simulation settings change
+    void updateReceiveThread();
+
+    bool                    mUseReceiveThread;  // set by startReceiveThread()
+    LLMessageReceiveThread* mReceiveThread;
+    LLReceivedPacket*       mThreadPacket;      // packet being handled from mReceiveThread
+    U64                     mThreadPacketsReceived; // by receive threads already deleted
+    LLAckLatencyStats       mAckLatency;
+
     // Must be valid during decode
 
     bool    mbError;
@@ -893,6 +1004,9 @@ private:
     msg_timing_callback mTimingCallback;
     void* mTimingCallbackData;
 
+    msg_receive_callback mReceiveCallback;
+    void* mReceiveCallbackData;
+
     void init(); // ctor shared initialisation.
 
     LLHost mLastSender;
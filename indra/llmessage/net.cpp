@@ -29,6 +29,7 @@
 //#include "net.h"
 
 // system library includes
+#include <atomic>
 #include <stdexcept>
 
 #if LL_WINDOWS
@@ -73,6 +74,10 @@ typedef int socklen_t;
 
 static U32 gsnReceivingIFAddr = INVALID_HOST_IP_ADDRESS; // Address to which datagram was sent
 
+// Socket system call counts, see get_receive_syscall_count()
+static std::atomic<U64> sReceiveSyscalls(0);
+static std::atomic<U64> sSendSyscalls(0);
+
 const char* LOOPBACK_ADDRESS_STRING = "127.0.0.1";
 const char* BROADCAST_ADDRESS_STRING = "255.255.255.255";
 
@@ -112,6 +117,16 @@ U32 get_receiving_interface_ip(void)
     return gsnReceivingIFAddr;
 }
 
+U64 get_receive_syscall_count()
+{
+    return sReceiveSyscalls.load(std::memory_order_relaxed);
+}
+
+U64 get_send_syscall_count()
+{
+    return sSendSyscalls.load(std::memory_order_relaxed);
+}
+
 const char* u32_to_ip_string(U32 ip)
 {
     static char buffer[MAXADDRSTR];  /* Flawfinder: ignore */
@@ -325,6 +340,7 @@ S32 receive_packet(int hSocket, char * receiveBuffer)
     int nRet;
     int addr_size = sizeof(struct sockaddr_in);
 
+    sReceiveSyscalls.fetch_add(1, std::memory_order_relaxed);
     nRet = recvfrom(hSocket, receiveBuffer, NET_BUFFER_SIZE, 0, (struct sockaddr*)&stSrcAddr, &addr_size);
     if (nRet == SOCKET_ERROR )
     {
@@ -346,11 +362,14 @@ bool send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, i
     int nRet = 0;
     U32 last_error = 0;
 
-    stDstAddr.sin_addr.s_addr = recipient;
-    stDstAddr.sin_port = htons(nPort);
+    // Local copy so the network receive thread can send acks concurrently
+    SOCKADDR_IN dst_addr = stDstAddr;
+    dst_addr.sin_addr.s_addr = recipient;
+    dst_addr.sin_port = htons(nPort);
     do
     {
-        nRet = sendto(hSocket, sendBuffer, size, 0, (struct sockaddr*)&stDstAddr, sizeof(stDstAddr));
+        sSendSyscalls.fetch_add(1, std::memory_order_relaxed);
+        nRet = sendto(hSocket, sendBuffer, size, 0, (struct sockaddr*)&dst_addr, sizeof(dst_addr));
 
         if (nRet == SOCKET_ERROR )
         {
@@ -578,6 +597,7 @@ int receive_packet(int hSocket, char * receiveBuffer)
     socklen_t addr_size = sizeof(struct sockaddr_in);
 
     gsnReceivingIFAddr = INVALID_HOST_IP_ADDRESS;
+    sReceiveSyscalls.fetch_add(1, std::memory_order_relaxed);
 
 #if LL_LINUX
     nRet = recvfrom_destip(hSocket, receiveBuffer, NET_BUFFER_SIZE, (struct sockaddr*)&stSrcAddr, &addr_size, &gsnReceivingIFAddr);
@@ -605,12 +625,15 @@ bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
     bool    resend;
     S32     send_attempts = 0;
 
-    stDstAddr.sin_addr.s_addr = recipient;
-    stDstAddr.sin_port = htons(nPort);
+    // Local copy so the network receive thread can send acks concurrently
+    struct sockaddr_in dst_addr = stDstAddr;
+    dst_addr.sin_addr.s_addr = recipient;
+    dst_addr.sin_port = htons(nPort);
 
     do
     {
-        ret = sendto(hSocket, sendBuffer, size, 0,  (struct sockaddr*)&stDstAddr, sizeof(stDstAddr));
+        sSendSyscalls.fetch_add(1, std::memory_order_relaxed);
+        ret = sendto(hSocket, sendBuffer, size, 0,  (struct sockaddr*)&dst_addr, sizeof(dst_addr));
         send_attempts++;
 
         if (ret >= 0)
@@ -628,21 +651,21 @@ bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
             {
                 // say nothing, just repeat send
                 LL_INFOS() << "sendto() reported buffer full, resending (attempt " << send_attempts << ")" << LL_ENDL;
-                LL_INFOS() << inet_ntoa(stDstAddr.sin_addr) << ":" << nPort << LL_ENDL;
+                LL_INFOS() << inet_ntoa(dst_addr.sin_addr) << ":" << nPort << LL_ENDL;
                 resend = true;
             }
             else if (errno == ECONNREFUSED)
             {
                 // response to ICMP connection refused message on earlier send
                 LL_INFOS() << "sendto() reported connection refused, resending (attempt " << send_attempts << ")" << LL_ENDL;
-                LL_INFOS() << inet_ntoa(stDstAddr.sin_addr) << ":" << nPort << LL_ENDL;
+                LL_INFOS() << inet_ntoa(dst_addr.sin_addr) << ":" << nPort << LL_ENDL;
                 resend = true;
             }
             else
             {
                 // some other error
                 LL_INFOS() << "sendto() failed: " << errno << ", " << strerror(errno) << LL_ENDL;
-                LL_INFOS() << inet_ntoa(stDstAddr.sin_addr) << ":" << nPort << LL_ENDL;
+                LL_INFOS() << inet_ntoa(dst_addr.sin_addr) << ":" << nPort << LL_ENDL;
                 resend = false;
             }
         }
@@ -658,6 +681,152 @@ bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
     return success;
 }
 
+#if LL_LINUX
+S32 receive_packets(int hSocket, char* const* buffers, S32* sizes, LLHost* senders, LLHost* receiving_ifs, S32 count)
+{
+    count = llmin(count, (S32)NET_MAX_PACKET_BATCH);
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    struct mmsghdr msgs[NET_MAX_PACKET_BATCH];
+    struct iovec iovs[NET_MAX_PACKET_BATCH];
+    struct sockaddr_in addrs[NET_MAX_PACKET_BATCH];
+    char cmsgs[NET_MAX_PACKET_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = buffers[i];
+        iovs[i].iov_len = NET_BUFFER_SIZE;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = cmsgs[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+    }
+
+    sReceiveSyscalls.fetch_add(1, std::memory_order_relaxed);
+    int received = recvmmsg(hSocket, msgs, count, MSG_DONTWAIT, NULL);
+    if (received <= 0)
+    {
+        // As in receive_packet(), nothing waiting and errors both read as "no data".
+        return 0;
+    }
+
+    for (S32 i = 0; i < received; ++i)
+    {
+        sizes[i] = msgs[i].msg_len;
+        senders[i] = LLHost(addrs[i].sin_addr.s_addr, ntohs(addrs[i].sin_port));
+
+        U32 dstip = INVALID_HOST_IP_ADDRESS;
+        for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+        {
+            if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+            {
+                // See recvfrom_destip() for why this is ipi_spec_dst
+                dstip = ((in_pktinfo*)CMSG_DATA(cmsgptr))->ipi_spec_dst.s_addr;
+            }
+        }
+        receiving_ifs[i] = LLHost(dstip, INVALID_PORT);
+    }
+
+    return received;
+}
+
+S32 send_packets(int hSocket, const char* const* buffers, const S32* sizes, const LLHost* recipients, S32 count)
+{
+    count = llmin(count, (S32)NET_MAX_PACKET_BATCH);
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    struct mmsghdr msgs[NET_MAX_PACKET_BATCH];
+    struct iovec iovs[NET_MAX_PACKET_BATCH];
+    struct sockaddr_in addrs[NET_MAX_PACKET_BATCH];
+
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    memset(addrs, 0, sizeof(addrs[0]) * count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        addrs[i].sin_family = AF_INET;
+        addrs[i].sin_addr.s_addr = recipients[i].getAddress();
+        addrs[i].sin_port = htons(recipients[i].getPort());
+        iovs[i].iov_base = const_cast<char*>(buffers[i]);
+        iovs[i].iov_len = sizes[i];
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    S32 sent = 0;
+    S32 done = 0;
+    while (done < count)
+    {
+        sSendSyscalls.fetch_add(1, std::memory_order_relaxed);
+        int ret = sendmmsg(hSocket, msgs + done, count - done, 0);
+        if (ret > 0)
+        {
+            sent += ret;
+            done += ret;
+        }
+        else
+        {
+            // The datagram at the head of the batch failed. Let send_packet()
+            // apply its usual retry and logging to it, then carry on with
+            // the rest of the batch.
+            if (send_packet(hSocket, buffers[done], sizes[done], recipients[done].getAddress(), recipients[done].getPort()))
+            {
+                ++sent;
+            }
+            ++done;
+        }
+    }
+
+    return sent;
+}
+#endif
+
+#endif
+
+#if !LL_LINUX
+// Portable batch fallbacks, one system call per datagram
+S32 receive_packets(int hSocket, char* const* buffers, S32* sizes, LLHost* senders, LLHost* receiving_ifs, S32 count)
+{
+    count = llmin(count, (S32)NET_MAX_PACKET_BATCH);
+    S32 received = 0;
+    while (received < count)
+    {
+        S32 size = receive_packet(hSocket, buffers[received]);
+        if (size <= 0)
+        {
+            break;
+        }
+        sizes[received] = size;
+        senders[received] = get_sender();
+        receiving_ifs[received] = get_receiving_interface();
+        ++received;
+    }
+    return received;
+}
+
+S32 send_packets(int hSocket, const char* const* buffers, const S32* sizes, const LLHost* recipients, S32 count)
+{
+    count = llmin(count, (S32)NET_MAX_PACKET_BATCH);
+    S32 sent = 0;
+    for (S32 i = 0; i < count; ++i)
+    {
+        if (send_packet(hSocket, buffers[i], sizes[i], recipients[i].getAddress(), recipients[i].getPort()))
+        {
+            ++sent;
+        }
+    }
+    return sent;
+}
 #endif
 
 //EOF
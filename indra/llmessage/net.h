@@ -32,6 +32,9 @@ class LLHost;
 
 #define NET_BUFFER_SIZE (0x2000)
 
+// Most datagrams moved by one receive_packets()/send_packets() call
+#define NET_MAX_PACKET_BATCH 32
+
 // Request a free local port from the operating system
 #define NET_USE_OS_ASSIGNED_PORT 0
 
@@ -45,6 +48,23 @@ S32     receive_packet(int hSocket, char * receiveBuffer);
 
 bool    send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);   // Returns true on success.
 
+// Batched variants. On Linux these use recvmmsg()/sendmmsg() so a burst of
+// datagrams costs a single system call; elsewhere they loop over
+// receive_packet()/send_packet().
+//
+// receive_packets() reads up to count (at most NET_MAX_PACKET_BATCH) waiting
+// datagrams without blocking. Each buffers[i] must hold NET_BUFFER_SIZE bytes.
+// Fills sizes, senders and receiving_ifs for every datagram read and returns
+// how many there were, zero if none.
+S32     receive_packets(int hSocket, char* const* buffers, S32* sizes, LLHost* senders, LLHost* receiving_ifs, S32 count);
+// Sends count (at most NET_MAX_PACKET_BATCH) datagrams. Returns the number
+// that were sent successfully.
+S32     send_packets(int hSocket, const char* const* buffers, const S32* sizes, const LLHost* recipients, S32 count);
+
+// Socket receive/send system calls made so far, for measuring batching.
+U64     get_receive_syscall_count();
+U64     get_send_syscall_count();
+
 //void  get_sender(char * tmp);
 LLHost  get_sender();
 U32     get_sender_port();
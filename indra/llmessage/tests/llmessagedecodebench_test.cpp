@@ -0,0 +1,826 @@
+/**
+ * @file llmessagedecodebench_test.cpp
+ * @brief Benchmarks template decoding of object update messages
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llmessagecapture.h"
+#include "../lldatapacker.h"
+#include "../llmessagetemplate.h"
+#include "../llmessagetemplateparser.h"
+#include "../lltemplatemessagebuilder.h"
+#include "../lltemplatemessagereader.h"
+#include "../message.h"
+#include "../message_prehash.h"
+#include "../net.h"
+#include "llapr.h"
+#include "llfile.h"
+#include "llmath.h"
+#include "llquantize.h"
+#include "llquaternion.h"
+#include "v3math.h"
+#include "v4math.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+// An llmessage decode benchmark: ObjectUpdate, ObjectUpdateCompressed,
+// ObjectUpdateCached and ImprovedTerseObjectUpdate read by the template
+// reader and their update data unpacked per the wire layout.  Decoded
+// updates only go to a local id table, which checks the stream was read
+// correctly; nothing here measures LLViewerObjectList, LLVOCache or the
+// spatial partitions.
+//
+// The stream is synthetic unless LL_OBJECT_UPDATE_STREAM names a capture
+// recorded with the viewer's --captureobjectupdates.  LL_MESSAGE_TEMPLATE overrides the message template, for
+// captures from another grid.
+
+namespace
+{
+    typedef std::chrono::steady_clock bench_clock;
+
+    const F32 REGION_WIDTH = 256.f;
+    const S32 FULL_DATA_SIZE = 60;      // position, velocity, acceleration, rotation, angular velocity
+    const S32 TERSE_DATA_SIZE = 44;
+    const S32 MAX_UPDATE_DATA_SIZE = 1024;
+
+    enum EPhase
+    {
+        PHASE_DECODE = 0,   // template reader, outside the handlers
+        PHASE_UNPACK,       // block fields and packed update data
+        PHASE_TABLE,        // local id table and cache lookups
+        PHASE_COUNT
+    };
+    const char* const PHASE_NAMES[PHASE_COUNT] = { "decode", "unpack", "table" };
+
+    // What the benchmark takes from one object's update
+    struct UpdateData
+    {
+        LLUUID mID;         // null in terse updates
+        U32 mLocalID = 0;
+        U32 mParentID = 0;
+        U32 mCRC = 0;
+        U8 mPCode = 0;
+        LLVector3 mScale;
+        LLVector3 mPosition;
+        LLVector3 mVelocity;
+        LLQuaternion mRotation;
+    };
+
+    // The start of the ObjectUpdateCompressed Data that
+    // LLViewerObject::processUpdateMessage() reads, up to the parent id
+    std::vector<U8> pack_compressed(const UpdateData& update)
+    {
+        U8 buffer[128];
+        LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+        dp.packUUID(update.mID, "ID");
+        dp.packU32(update.mLocalID, "LocalID");
+        dp.packU8(update.mPCode, "PCode");
+        dp.packU8(0, "State");
+        dp.packU32(update.mCRC, "CRC");
+        dp.packU8(0, "Material");
+        dp.packU8(0, "ClickAction");
+        dp.packVector3(update.mScale, "Scale");
+        dp.packVector3(update.mPosition, "Pos");
+        dp.packVector3(update.mRotation.packToVector3(), "Rot");
+        dp.packU32(update.mParentID ? 0x20 : 0, "SpecialCode");
+        dp.packUUID(LLUUID::null, "Owner");
+        if (update.mParentID)
+        {
+            dp.packU32(update.mParentID, "ParentID");
+        }
+        return std::vector<U8>(buffer, buffer + dp.getCurrentSize());
+    }
+
+    bool unpack_compressed(const U8* data, S32 size, UpdateData& update)
+    {
+        LLDataPackerBinaryBuffer dp(const_cast<U8*>(data), size);
+        U8 state, material, click_action;
+        U32 special_code;
+        LLUUID owner;
+        LLVector3 rot;
+        bool ok = dp.unpackUUID(update.mID, "ID")
+            && dp.unpackU32(update.mLocalID, "LocalID")
+            && dp.unpackU8(update.mPCode, "PCode")
+            && dp.unpackU8(state, "State")
+            && dp.unpackU32(update.mCRC, "CRC")
+            && dp.unpackU8(material, "Material")
+            && dp.unpackU8(click_action, "ClickAction")
+            && dp.unpackVector3(update.mScale, "Scale")
+            && dp.unpackVector3(update.mPosition, "Pos")
+            && dp.unpackVector3(rot, "Rot")
+            && dp.unpackU32(special_code, "SpecialCode")
+            && dp.unpackUUID(owner, "Owner");
+        if (ok && (special_code & 0x80))
+        {
+            LLVector3 omega;
+            ok = dp.unpackVector3(omega, "Omega");
+        }
+        update.mParentID = 0;
+        if (ok && (special_code & 0x20))
+        {
+            ok = dp.unpackU32(update.mParentID, "ParentID");
+        }
+        update.mRotation.unpackFromVector3(rot);
+        return ok;
+    }
+
+    // The ObjectUpdate ObjectData field, in its unquantized form
+    void pack_full(const UpdateData& update, U8* data)
+    {
+        const LLVector3 vectors[5] = { update.mPosition, update.mVelocity, LLVector3::zero,
+                                       update.mRotation.packToVector3(), LLVector3::zero };
+        memcpy(data, vectors, FULL_DATA_SIZE); /* Flawfinder: ignore */
+    }
+
+    bool unpack_full(const U8* data, S32 size, UpdateData& update)
+    {
+        if (size == FULL_DATA_SIZE || size == FULL_DATA_SIZE + 16)
+        {
+            // Avatars lead with their collision plane
+            LLVector3 vectors[5];
+            memcpy(vectors, data + size - FULL_DATA_SIZE, FULL_DATA_SIZE); /* Flawfinder: ignore */
+            update.mPosition = vectors[0];
+            update.mVelocity = vectors[1];
+            update.mRotation.unpackFromVector3(vectors[3]);
+            return true;
+        }
+        if (size == 32 || size == 48)
+        {
+            U16 values[16];
+            memcpy(values, data + size - 32, 32); /* Flawfinder: ignore */
+            for (S32 i = 0; i < 3; ++i)
+            {
+                update.mPosition.mV[i] = U16_to_F32(values[i], -0.5f * REGION_WIDTH, 1.5f * REGION_WIDTH);
+                update.mVelocity.mV[i] = U16_to_F32(values[3 + i], -REGION_WIDTH, REGION_WIDTH);
+            }
+            update.mRotation.set(U16_to_F32(values[9], -1.f, 1.f), U16_to_F32(values[10], -1.f, 1.f),
+                                 U16_to_F32(values[11], -1.f, 1.f), U16_to_F32(values[12], -1.f, 1.f));
+            return true;
+        }
+        return false;
+    }
+
+    // The ImprovedTerseObjectUpdate Data field of a prim
+    std::vector<U8> pack_terse(const UpdateData& update)
+    {
+        U8 buffer[TERSE_DATA_SIZE];
+        LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+        dp.packU32(update.mLocalID, "LocalID");
+        dp.packU8(0, "State");
+        dp.packU8(0, "AvatarFlag");
+        dp.packVector3(update.mPosition, "Pos");
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(update.mVelocity.mV[i], -REGION_WIDTH, REGION_WIDTH), "Vel");
+        }
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(0.f, -REGION_WIDTH, REGION_WIDTH), "Accel");
+        }
+        for (S32 i = 0; i < 4; ++i)
+        {
+            dp.packU16(F32_to_U16(update.mRotation.mQ[i], -1.f, 1.f), "Rot");
+        }
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(0.f, -REGION_WIDTH, REGION_WIDTH), "AngVel");
+        }
+        return std::vector<U8>(buffer, buffer + dp.getCurrentSize());
+    }
+
+    bool unpack_terse(const U8* data, S32 size, UpdateData& update)
+    {
+        LLDataPackerBinaryBuffer dp(const_cast<U8*>(data), size);
+        U8 state, avatar;
+        if (!dp.unpackU32(update.mLocalID, "LocalID") || !dp.unpackU8(state, "State")
+            || !dp.unpackU8(avatar, "AvatarFlag"))
+        {
+            return false;
+        }
+        if (avatar)
+        {
+            LLVector4 collision_plane;
+            dp.unpackVector4(collision_plane, "CollisionPlane");
+        }
+        U16 values[13];
+        bool ok = dp.unpackVector3(update.mPosition, "Pos");
+        for (S32 i = 0; ok && i < 13; ++i)
+        {
+            ok = dp.unpackU16(values[i], "Motion");
+        }
+        if (!ok)
+        {
+            return false;
+        }
+        for (S32 i = 0; i < 3; ++i)
+        {
+            update.mVelocity.mV[i] = U16_to_F32(values[i], -REGION_WIDTH, REGION_WIDTH);
+        }
+        update.mRotation.set(U16_to_F32(values[6], -1.f, 1.f), U16_to_F32(values[7], -1.f, 1.f),
+                             U16_to_F32(values[8], -1.f, 1.f), U16_to_F32(values[9], -1.f, 1.f));
+        update.mRotation.normalize();
+        return true;
+    }
+
+    // Templates from the message template file, parsed once and never freed
+    struct Templates
+    {
+        LLTemplateMessageBuilder::message_template_name_map_t mByName;
+        LLTemplateMessageReader::message_template_number_map_t mByNumber;
+    };
+
+    Templates& get_templates()
+    {
+        static Templates templates;
+        if (templates.mByName.empty())
+        {
+#ifdef LL_MESSAGE_TEMPLATE_FILE
+            const std::string default_file(LL_MESSAGE_TEMPLATE_FILE);
+#else
+            const std::string default_file("../../scripts/messages/message_template.msg");
+#endif
+            const std::string filename = LLStringUtil::getenv("LL_MESSAGE_TEMPLATE", default_file);
+            llifstream file(filename.c_str());
+            std::stringstream body;
+            body << file.rdbuf();
+            tut::ensure("read " + filename, !body.str().empty());
+
+            LLTemplateTokenizer tokens(body.str());
+            LLTemplateParser parsed(tokens);
+            for (LLTemplateParser::message_iterator iter = parsed.getMessagesBegin();
+                 iter != parsed.getMessagesEnd(); ++iter)
+            {
+                templates.mByName[(*iter)->mName] = *iter;
+                templates.mByNumber[(*iter)->mMessageNumber] = *iter;
+            }
+        }
+        return templates;
+    }
+
+    // Handles the four object update messages while it exists, keeping the
+    // decoded updates by local id and compressed ones for cached updates
+    class Decoder
+    {
+    public:
+        struct CacheEntry
+        {
+            U32 mCRC;
+            std::vector<U8> mData;
+        };
+
+        Decoder(Templates& templates, LLTemplateMessageReader& reader)
+        :   mTemplates(templates),
+            mReader(reader),
+            mUpdates(0),
+            mCreated(0),
+            mCacheHits(0),
+            mCacheMisses(0),
+            mUnknown(0)
+        {
+            for (F64& seconds : mSeconds)
+            {
+                seconds = 0.0;
+            }
+            setHandlers(&Decoder::processObjectUpdate, &Decoder::processCompressedObjectUpdate,
+                        &Decoder::processCachedObjectUpdate, &Decoder::processTerseObjectUpdate);
+        }
+
+        ~Decoder()
+        {
+            setHandlers(NULL, NULL, NULL, NULL);
+        }
+
+        // Reads and dispatches each packet of stream; returns the seconds taken
+        F64 replay(const std::vector<LLMessageCapture::Record>& stream)
+        {
+            const bench_clock::time_point start = bench_clock::now();
+            for (const LLMessageCapture::Record& record : stream)
+            {
+                // Captures of every message can hold some without handlers here
+                if (mReader.validateMessage(record.mData.data(), (S32)record.mData.size(), LLHost(), true)
+                    && handles(mReader.getMessageName()))
+                {
+                    mReader.readMessage(record.mData.data(), LLHost());
+                }
+            }
+            const F64 seconds = std::chrono::duration<F64>(bench_clock::now() - start).count();
+
+            F64 handler_seconds = 0.0;
+            for (S32 phase = PHASE_UNPACK; phase < PHASE_COUNT; ++phase)
+            {
+                handler_seconds += mSeconds[phase];
+            }
+            mSeconds[PHASE_DECODE] = llmax(seconds - handler_seconds, 0.0);
+            return seconds;
+        }
+
+        void seedCache(const UpdateData& update, U32 crc)
+        {
+            CacheEntry& entry = mCache[update.mLocalID];
+            entry.mCRC = crc;
+            entry.mData = pack_compressed(update);
+        }
+
+        const UpdateData* findObject(U32 local_id) const
+        {
+            auto iter = mObjects.find(local_id);
+            return iter != mObjects.end() ? &iter->second : NULL;
+        }
+
+        void report(const std::string& label, F64 seconds) const
+        {
+            std::cout << "\n" << label << ": " << mUpdates << " object updates in " << (S32)(seconds * 1000.0)
+                      << " ms, " << (S32)(mUpdates / llmax(seconds, 1e-9)) << " objects/s; "
+                      << mCreated << " created, " << mCacheHits << " cache hits, " << mCacheMisses
+                      << " cache misses, " << mUnknown << " unknown" << std::endl;
+            for (S32 phase = 0; phase < PHASE_COUNT; ++phase)
+            {
+                std::cout << "  " << PHASE_NAMES[phase] << ": " << (S32)(mSeconds[phase] * 1000.0) << " ms, "
+                          << (S32)(mSeconds[phase] * 1e9 / llmax(mUpdates, 1U)) << " ns per update" << std::endl;
+            }
+        }
+
+        U32 mUpdates;
+        U32 mCreated;
+        U32 mCacheHits;
+        U32 mCacheMisses;
+        U32 mUnknown;
+
+    private:
+        typedef void (*handler_t)(LLMessageSystem*, void**);
+
+        void setHandlers(handler_t full, handler_t compressed, handler_t cached, handler_t terse)
+        {
+            void** user_data = full ? (void**)this : NULL;
+            mTemplates.mByName[_PREHASH_ObjectUpdate]->setHandlerFunc(full, user_data);
+            mTemplates.mByName[_PREHASH_ObjectUpdateCompressed]->setHandlerFunc(compressed, user_data);
+            mTemplates.mByName[_PREHASH_ObjectUpdateCached]->setHandlerFunc(cached, user_data);
+            mTemplates.mByName[_PREHASH_ImprovedTerseObjectUpdate]->setHandlerFunc(terse, user_data);
+        }
+
+        static bool handles(const char* name)
+        {
+            return name == _PREHASH_ObjectUpdate || name == _PREHASH_ObjectUpdateCompressed
+                || name == _PREHASH_ObjectUpdateCached || name == _PREHASH_ImprovedTerseObjectUpdate;
+        }
+
+        void startLap()
+        {
+            mLap = bench_clock::now();
+        }
+
+        void lap(EPhase phase)
+        {
+            const bench_clock::time_point now = bench_clock::now();
+            mSeconds[phase] += std::chrono::duration<F64>(now - mLap).count();
+            mLap = now;
+        }
+
+        // Keeps the latest update for its local id
+        void apply(const UpdateData& update, bool full)
+        {
+            if (full)
+            {
+                auto inserted = mObjects.emplace(update.mLocalID, update);
+                if (inserted.second)
+                {
+                    ++mCreated;
+                }
+                else
+                {
+                    inserted.first->second = update;
+                }
+            }
+            else
+            {
+                auto iter = mObjects.find(update.mLocalID);
+                if (iter == mObjects.end())
+                {
+                    // The viewer asks the simulator for the object
+                    ++mUnknown;
+                    lap(PHASE_TABLE);
+                    return;
+                }
+                iter->second.mPosition = update.mPosition;
+                iter->second.mVelocity = update.mVelocity;
+                iter->second.mRotation = update.mRotation;
+            }
+            lap(PHASE_TABLE);
+            ++mUpdates;
+        }
+
+        static void processObjectUpdate(LLMessageSystem*, void** user_data)
+        {
+            Decoder* self = (Decoder*)user_data;
+            LLTemplateMessageReader& reader = self->mReader;
+            self->startLap();
+
+            U8 data[MAX_UPDATE_DATA_SIZE];
+            const S32 count = reader.getNumberOfBlocks(_PREHASH_ObjectData);
+            for (S32 i = 0; i < count; ++i)
+            {
+                UpdateData update;
+                reader.getU32(_PREHASH_ObjectData, _PREHASH_ID, update.mLocalID, i);
+                reader.getUUID(_PREHASH_ObjectData, _PREHASH_FullID, update.mID, i);
+                reader.getU32(_PREHASH_ObjectData, _PREHASH_CRC, update.mCRC, i);
+                reader.getU8(_PREHASH_ObjectData, _PREHASH_PCode, update.mPCode, i);
+                reader.getVector3(_PREHASH_ObjectData, _PREHASH_Scale, update.mScale, i);
+                reader.getU32(_PREHASH_ObjectData, _PREHASH_ParentID, update.mParentID, i);
+                const S32 size = llmin(reader.getSize(_PREHASH_ObjectData, i, _PREHASH_ObjectData),
+                                       MAX_UPDATE_DATA_SIZE);
+                reader.getBinaryData(_PREHASH_ObjectData, _PREHASH_ObjectData, data, size, i, MAX_UPDATE_DATA_SIZE);
+                const bool ok = unpack_full(data, size, update);
+                self->lap(PHASE_UNPACK);
+                if (ok)
+                {
+                    self->apply(update, true);
+                }
+            }
+        }
+
+        static void processCompressedObjectUpdate(LLMessageSystem*, void** user_data)
+        {
+            Decoder* self = (Decoder*)user_data;
+            LLTemplateMessageReader& reader = self->mReader;
+            self->startLap();
+
+            U8 data[MAX_UPDATE_DATA_SIZE];
+            const S32 count = reader.getNumberOfBlocks(_PREHASH_ObjectData);
+            for (S32 i = 0; i < count; ++i)
+            {
+                const S32 size = llmin(reader.getSize(_PREHASH_ObjectData, i, _PREHASH_Data), MAX_UPDATE_DATA_SIZE);
+                reader.getBinaryData(_PREHASH_ObjectData, _PREHASH_Data, data, size, i, MAX_UPDATE_DATA_SIZE);
+                UpdateData update;
+                const bool ok = unpack_compressed(data, size, update);
+                self->lap(PHASE_UNPACK);
+                if (ok)
+                {
+                    // LLVOCache keeps compressed updates for the next visit
+                    CacheEntry& entry = self->mCache[update.mLocalID];
+                    entry.mCRC = update.mCRC;
+                    entry.mData.assign(data, data + size);
+                    self->apply(update, true);
+                }
+            }
+        }
+
+        static void processCachedObjectUpdate(LLMessageSystem*, void** user_data)
+        {
+            Decoder* self = (Decoder*)user_data;
+            LLTemplateMessageReader& reader = self->mReader;
+            self->startLap();
+
+            const S32 count = reader.getNumberOfBlocks(_PREHASH_ObjectData);
+            for (S32 i = 0; i < count; ++i)
+            {
+                U32 local_id, crc;
+                reader.getU32(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+                reader.getU32(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
+                self->lap(PHASE_UNPACK);
+
+                auto iter = self->mCache.find(local_id);
+                if (iter == self->mCache.end() || iter->second.mCRC != crc)
+                {
+                    // The viewer requests a full update
+                    ++self->mCacheMisses;
+                    self->lap(PHASE_TABLE);
+                    continue;
+                }
+                ++self->mCacheHits;
+                self->lap(PHASE_TABLE);
+
+                UpdateData update;
+                const bool ok = unpack_compressed(iter->second.mData.data(), (S32)iter->second.mData.size(), update);
+                self->lap(PHASE_UNPACK);
+                if (ok)
+                {
+                    self->apply(update, true);
+                }
+            }
+        }
+
+        static void processTerseObjectUpdate(LLMessageSystem*, void** user_data)
+        {
+            Decoder* self = (Decoder*)user_data;
+            LLTemplateMessageReader& reader = self->mReader;
+            self->startLap();
+
+            U8 data[MAX_UPDATE_DATA_SIZE];
+            const S32 count = reader.getNumberOfBlocks(_PREHASH_ObjectData);
+            for (S32 i = 0; i < count; ++i)
+            {
+                const S32 size = llmin(reader.getSize(_PREHASH_ObjectData, i, _PREHASH_Data), MAX_UPDATE_DATA_SIZE);
+                reader.getBinaryData(_PREHASH_ObjectData, _PREHASH_Data, data, size, i, MAX_UPDATE_DATA_SIZE);
+                UpdateData update;
+                const bool ok = unpack_terse(data, size, update);
+                self->lap(PHASE_UNPACK);
+                if (ok)
+                {
+                    self->apply(update, false);
+                }
+            }
+        }
+
+        Templates& mTemplates;
+        LLTemplateMessageReader& mReader;
+        std::unordered_map<U32, UpdateData> mObjects;
+        std::unordered_map<U32, CacheEntry> mCache;
+        F64 mSeconds[PHASE_COUNT];
+        bench_clock::time_point mLap;
+    };
+
+    // Builds packets of the four messages the way a simulator fills them
+    class StreamBuilder
+    {
+    public:
+        StreamBuilder(Templates& templates)
+        :   mTemplates(templates),
+            mBuilder(templates.mByName),
+            mMessage(NULL),
+            mBlocks(0)
+        {
+        }
+
+        void addFull(const UpdateData& update)
+        {
+            nextBlock(_PREHASH_ObjectUpdate, 5);
+
+            // Everything the benchmark does not read stays zero
+            static const U8 ZEROS[64] = { 0 };
+            const LLMessageTemplate* message = mTemplates.mByName[_PREHASH_ObjectUpdate];
+            const LLMessageBlock* block = message->getBlock(const_cast<char*>(_PREHASH_ObjectData));
+            for (const LLMessageVariable* var : block->mMemberVariables)
+            {
+                mBuilder.addBinaryData(var->getName(), ZEROS, var->getType() == MVT_VARIABLE ? 0 : var->getSize());
+            }
+
+            U8 data[FULL_DATA_SIZE];
+            pack_full(update, data);
+            mBuilder.addU32(_PREHASH_ID, update.mLocalID);
+            mBuilder.addUUID(_PREHASH_FullID, update.mID);
+            mBuilder.addU32(_PREHASH_CRC, update.mCRC);
+            mBuilder.addU8(_PREHASH_PCode, update.mPCode);
+            mBuilder.addVector3(_PREHASH_Scale, update.mScale);
+            mBuilder.addBinaryData(_PREHASH_ObjectData, data, FULL_DATA_SIZE);
+            mBuilder.addU32(_PREHASH_ParentID, update.mParentID);
+        }
+
+        void addCompressed(const UpdateData& update)
+        {
+            nextBlock(_PREHASH_ObjectUpdateCompressed, 10);
+            const std::vector<U8> data = pack_compressed(update);
+            mBuilder.addU32(_PREHASH_UpdateFlags, 0);
+            mBuilder.addBinaryData(_PREHASH_Data, data.data(), (S32)data.size());
+        }
+
+        void addCached(const UpdateData& update)
+        {
+            nextBlock(_PREHASH_ObjectUpdateCached, 60);
+            mBuilder.addU32(_PREHASH_ID, update.mLocalID);
+            mBuilder.addU32(_PREHASH_CRC, update.mCRC);
+            mBuilder.addU32(_PREHASH_UpdateFlags, 0);
+        }
+
+        void addTerse(const UpdateData& update)
+        {
+            nextBlock(_PREHASH_ImprovedTerseObjectUpdate, 20);
+            const std::vector<U8> data = pack_terse(update);
+            mBuilder.addBinaryData(_PREHASH_Data, data.data(), (S32)data.size());
+            mBuilder.addBinaryData(_PREHASH_TextureEntry, data.data(), 0);
+        }
+
+        // Finishes the packet being filled
+        void flush()
+        {
+            if (!mMessage)
+            {
+                return;
+            }
+            U8 buffer[MAX_BUFFER_SIZE];
+            memset(buffer, 0, LL_PACKET_ID_SIZE);
+            const U32 size = mBuilder.buildMessage(buffer, sizeof(buffer), 0);
+            mStream.emplace_back();
+            mStream.back().mTime = mStream.size() * 1000;
+            mStream.back().mData.assign(buffer, buffer + size);
+            mMessage = NULL;
+            mBlocks = 0;
+        }
+
+        std::vector<LLMessageCapture::Record> mStream;
+
+    private:
+        void nextBlock(const char* message, S32 max_blocks)
+        {
+            if (mMessage != message || mBlocks >= max_blocks)
+            {
+                flush();
+                mBuilder.newMessage(message);
+                mBuilder.nextBlock(_PREHASH_RegionData);
+                mBuilder.addU64(_PREHASH_RegionHandle, 0);
+                mBuilder.addU16(_PREHASH_TimeDilation, 65535);
+                mMessage = message;
+            }
+            mBuilder.nextBlock(_PREHASH_ObjectData);
+            ++mBlocks;
+        }
+
+        Templates& mTemplates;
+        LLTemplateMessageBuilder mBuilder;
+        const char* mMessage;
+        S32 mBlocks;
+    };
+
+    // A prim somewhere in the region; the same local id always gives the same one
+    UpdateData make_object(U32 local_id)
+    {
+        U32 seed = local_id * 2654435761U;
+        auto next = [&seed]()
+        {
+            seed = seed * 1664525U + 1013904223U;
+            return (F32)(seed >> 8) / (F32)(1 << 24);
+        };
+
+        UpdateData update;
+        update.mID.generate(std::to_string(local_id));
+        update.mLocalID = local_id;
+        update.mCRC = local_id * 7 + 1;
+        update.mPCode = 9;  // LL_PCODE_VOLUME
+        update.mScale.set(0.1f + next() * 10.f, 0.1f + next() * 10.f, 0.1f + next() * 10.f);
+        update.mPosition.set(next() * REGION_WIDTH, next() * REGION_WIDTH, 20.f + next() * 80.f);
+        update.mVelocity.set(next() * 4.f - 2.f, next() * 4.f - 2.f, 0.f);
+        update.mRotation.setAngleAxis(next() * F_TWO_PI, 0.f, 0.f, 1.f);
+        return update;
+    }
+}
+
+namespace tut
+{
+    struct messagedecodebench_data
+    {
+        messagedecodebench_data()
+        {
+            static bool init = false;
+            if (!init)
+            {
+                // Only for gMessageSystem, which the template reader reports
+                // through; the templates come from get_templates()
+                ll_init_apr();
+                start_messaging_system("notafile", NET_USE_OS_ASSIGNED_PORT, 1, 0, 0, false,
+                                       "notasharedsecret", NULL, false, 5.f, 100.f);
+                init = true;
+            }
+        }
+    };
+    typedef test_group<messagedecodebench_data> messagedecodebench_test;
+    typedef messagedecodebench_test::object messagedecodebench_object;
+    tut::messagedecodebench_test messagedecodebench_testcase("LLMessageDecodeBench");
+
+    template<> template<>
+    void messagedecodebench_object::test<1>()
+    {
+        set_test_name("capture keeps the named messages");
+
+        Templates& templates = get_templates();
+        StreamBuilder builder(templates);
+        builder.addCached(make_object(1));
+        builder.addTerse(make_object(1));
+        builder.flush();
+        ensure_equals("packets built", builder.mStream.size(), (size_t)2);
+
+        const std::string filename = std::string(LLFile::tmpdir()) + "llmessagedecodebench_test.capture";
+        std::vector<std::string> names;
+        names.push_back("ImprovedTerseObjectUpdate");
+        ensure("capture started", LLMessageCapture::start(filename, names));
+
+        LLTemplateMessageReader reader(templates.mByNumber);
+        for (const LLMessageCapture::Record& record : builder.mStream)
+        {
+            ensure("packet decodes", reader.validateMessage(record.mData.data(), (S32)record.mData.size(), LLHost(), true));
+            LLMessageCapture::receive(reader.getMessageName(), record.mData.data(), (S32)record.mData.size(), NULL);
+        }
+        LLMessageCapture::stop();
+
+        std::vector<LLMessageCapture::Record> records;
+        ensure("capture read", LLMessageCapture::read(filename, records));
+        LLFile::remove(filename);
+        ensure_equals("one message kept", records.size(), (size_t)1);
+        ensure("terse update kept", records[0].mData == builder.mStream[1].mData);
+    }
+
+    template<> template<>
+    void messagedecodebench_object::test<2>()
+    {
+        set_test_name("decode object updates");
+
+        Templates& templates = get_templates();
+        LLTemplateMessageReader reader(templates.mByNumber);
+        Decoder decoder(templates, reader);
+
+        const std::string capture = LLStringUtil::getenv("LL_OBJECT_UPDATE_STREAM");
+        if (!capture.empty())
+        {
+            std::vector<LLMessageCapture::Record> stream;
+            ensure("read " + capture, LLMessageCapture::read(capture, stream));
+            decoder.report(capture, decoder.replay(stream));
+            return;
+        }
+
+        // A region arriving as a third each of full, compressed and cached
+        // updates, one in ten cached ones stale, then a quarter of the
+        // objects moving for a few seconds of terse updates
+        const U32 OBJECTS = 3000;
+        const U32 ROUNDS = 40;
+        StreamBuilder builder(templates);
+        U32 misses = 0;
+        for (U32 local_id = 1; local_id <= OBJECTS; ++local_id)
+        {
+            const UpdateData update = make_object(local_id);
+            switch (local_id % 3)
+            {
+            case 0:
+                builder.addFull(update);
+                break;
+            case 1:
+                builder.addCompressed(update);
+                break;
+            default:
+                if (local_id % 10 == 2)
+                {
+                    decoder.seedCache(update, update.mCRC + 1);
+                    ++misses;
+                }
+                else
+                {
+                    decoder.seedCache(update, update.mCRC);
+                }
+                builder.addCached(update);
+                break;
+            }
+        }
+
+        U32 terse = 0;
+        U32 unknown = 0;
+        UpdateData moved;
+        for (U32 round = 1; round <= ROUNDS; ++round)
+        {
+            for (U32 local_id = 4; local_id <= OBJECTS; local_id += 4)
+            {
+                UpdateData update = make_object(local_id);
+                update.mPosition += update.mVelocity * (0.2f * round);
+                update.mPosition.clamp(0.f, REGION_WIDTH);
+                builder.addTerse(update);
+                if (local_id % 3 == 2 && local_id % 10 == 2)
+                {
+                    ++unknown;
+                }
+                else
+                {
+                    ++terse;
+                }
+                moved = update;
+            }
+        }
+        builder.flush();
+
+        const F64 seconds = decoder.replay(builder.mStream);
+        decoder.report("synthetic stream", seconds);
+
+        ensure_equals("created", decoder.mCreated, OBJECTS - misses);
+        ensure_equals("cache misses", decoder.mCacheMisses, misses);
+        ensure_equals("cache hits", decoder.mCacheHits, OBJECTS / 3 - misses);
+        ensure_equals("terse updates for missing objects", decoder.mUnknown, unknown);
+        ensure_equals("updates applied", decoder.mUpdates, decoder.mCreated + terse);
+
+        const UpdateData* object = decoder.findObject(moved.mLocalID);
+        ensure("moved object exists", object != NULL);
+        ensure_equals("moved object at its last position", object->mPosition, moved.mPosition);
+    }
+}
@@ -0,0 +1,510 @@
+/**
+ * @file llmessagereceivethread_test.cpp
+ * @brief Loopback tests for LLMessageReceiveThread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmessagereceivethread.h"
+#include "../llcircuit.h"
+#include "../llmessagetemplate.h"
+#include "../llpacketbuffer.h"
+#include "../llproxy.h"
+#include "../message.h"
+#include "../net.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <thread>
+
+#if LL_WINDOWS
+    #include <winsock2.h>
+    #define close_socket closesocket
+    #define SHUT_RDWR SD_BOTH
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <unistd.h>
+    #define close_socket close
+#endif
+
+namespace
+{
+    // Just enough of a SOCKS 5 server for LLProxy::startSOCKSProxy(): it
+    // accepts one control connection without authentication and grants a
+    // UDP association on relay_port, then holds the connection open.
+    class FakeSOCKSServer
+    {
+    public:
+        FakeSOCKSServer(U16 relay_port)
+        :   mListener((int)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)),
+            mConnection(-1),
+            mPort(0),
+            mRelayPort(relay_port)
+        {
+            sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t size = sizeof(address);
+            if (bind(mListener, (sockaddr*)&address, size) == 0
+                && listen(mListener, 1) == 0
+                && getsockname(mListener, (sockaddr*)&address, &size) == 0)
+            {
+                mPort = ntohs(address.sin_port);
+                mThread = std::thread([this]{ serve(); });
+            }
+        }
+
+        ~FakeSOCKSServer()
+        {
+            // Unblocks accept() or recv() in serve()
+            shutdown(mListener, SHUT_RDWR);
+            int connection = mConnection.exchange(-1);
+            if (connection >= 0)
+            {
+                shutdown(connection, SHUT_RDWR);
+            }
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+            close_socket(mListener);
+            if (connection >= 0)
+            {
+                close_socket(connection);
+            }
+        }
+
+        LLHost getHost() const
+        {
+            return LLHost(ip_string_to_u32(LOOPBACK_ADDRESS_STRING), mPort);
+        }
+
+    private:
+        static bool readAll(int connection, char* buffer, int size)
+        {
+            while (size > 0)
+            {
+                int got = recv(connection, buffer, size, 0);
+                if (got <= 0)
+                {
+                    return false;
+                }
+                buffer += got;
+                size -= got;
+            }
+            return true;
+        }
+
+        void serve()
+        {
+            int connection = (int)accept(mListener, NULL, NULL);
+            if (connection < 0)
+            {
+                return;
+            }
+            mConnection = connection;
+
+            socks_auth_request_t auth_request;
+            if (!readAll(connection, (char*)&auth_request, sizeof(auth_request)))
+            {
+                return;
+            }
+            socks_auth_response_t auth_response;
+            auth_response.version = SOCKS_VERSION;
+            auth_response.method = METHOD_NOAUTH;
+            send(connection, (const char*)&auth_response, sizeof(auth_response), 0);
+
+            socks_command_request_t command;
+            if (!readAll(connection, (char*)&command, sizeof(command)))
+            {
+                return;
+            }
+            socks_command_response_t response;
+            memset(&response, 0, sizeof(response));
+            response.version = SOCKS_VERSION;
+            response.reply = REPLY_REQUEST_GRANTED;
+            response.atype = ADDRESS_IPV4;
+            response.port = htons(mRelayPort);
+            send(connection, (const char*)&response, sizeof(response), 0);
+
+            // Hold the control channel until LLProxy closes it
+            char byte;
+            while (recv(connection, &byte, 1, 0) > 0)
+            {
+            }
+        }
+
+        int mListener;
+        std::atomic<int> mConnection;
+        U16 mPort;
+        U16 mRelayPort;
+        std::thread mThread;
+    };
+}
+
+namespace tut
+{
+    struct receivethread_data
+    {
+        S32 mReceiver;
+        S32 mSender;
+        LLHost mReceiverHost;
+        LLHost mSenderHost;
+        // Never deleted: LLCircuitData's destructor reports through
+        // gMessageSystem, which these tests do not start.
+        LLCircuit* mCircuits;
+        LLAckLatencyStats mAckLatency;
+        LLTemplateMessageReader::message_template_number_map_t mTemplates;
+        LLMessageReceiveThread* mThread;
+
+        receivethread_data()
+        :   mReceiver(-1),
+            mSender(-1),
+            mCircuits(new LLCircuit(F32Seconds(60.f), F32Seconds(60.f))),
+            mThread(NULL)
+        {
+            // High frequency messages 1 and 2, with one and four fixed bytes
+            addTemplate(1, 1);
+            addTemplate(2, 4);
+
+            int port = NET_USE_OS_ASSIGNED_PORT;
+            ensure_equals("receiver socket", start_net(mReceiver, port), 0);
+            mReceiverHost = LLHost(ip_string_to_u32(LOOPBACK_ADDRESS_STRING), port);
+
+            port = NET_USE_OS_ASSIGNED_PORT;
+            ensure_equals("sender socket", start_net(mSender, port), 0);
+            mSenderHost = LLHost(ip_string_to_u32(LOOPBACK_ADDRESS_STRING), port);
+
+            mThread = new LLMessageReceiveThread(mReceiver, *mCircuits, mAckLatency, mTemplates);
+            mThread->start();
+        }
+
+        ~receivethread_data()
+        {
+            if (LLProxy::isSOCKSProxyEnabled())
+            {
+                LLProxy::getInstance()->stopSOCKSProxy();
+            }
+            delete mThread;
+            end_net(mReceiver);
+            end_net(mSender);
+            for (auto& entry : mTemplates)
+            {
+                delete entry.second;
+            }
+        }
+
+        void addTemplate(U32 number, S32 size)
+        {
+            LLMessageTemplate* message = new LLMessageTemplate("TestMessage", number, MFT_HIGH);
+            LLMessageBlock* block = new LLMessageBlock("TestBlock", MBT_SINGLE);
+            block->addVariable(LLMessageStringTable::getInstance()->getString("Data"), MVT_FIXED, size);
+            message->addBlock(block);
+            mTemplates[number] = message;
+        }
+
+        // Packet header: flags, big-endian packet id, extra header offset
+        static S32 makeHeader(U8 flags, U32 id, U8* buffer)
+        {
+            buffer[PHL_FLAGS] = flags;
+            U32 net_id = htonl(id);
+            memcpy(&buffer[PHL_PACKET_ID], &net_id, sizeof(net_id));    /* Flawfinder: ignore */
+            buffer[PHL_OFFSET] = 0;
+            return LL_PACKET_ID_SIZE;
+        }
+
+        void send(const U8* buffer, S32 size)
+        {
+            ensure("send_packet", send_packet(mSender, (const char*)buffer, size, mReceiverHost.getAddress(), mReceiverHost.getPort()));
+        }
+
+        // The thread picks datagrams up asynchronously, so poll for a while.
+        bool waitForPacket(LLReceivedPacket& packet)
+        {
+            for (S32 tries = 0; tries < 2000; ++tries)
+            {
+                if (mThread->popPacket(packet))
+                {
+                    return true;
+                }
+                ms_sleep(1);
+            }
+            return false;
+        }
+
+        S32 waitForReply(U8* buffer)
+        {
+            for (S32 tries = 0; tries < 2000; ++tries)
+            {
+                S32 size = receive_packet(mSender, (char*)buffer);
+                if (size > 0)
+                {
+                    return size;
+                }
+                ms_sleep(1);
+            }
+            return 0;
+        }
+    };
+    typedef test_group<receivethread_data> receivethread_test;
+    typedef receivethread_test::object receivethread_object;
+    tut::receivethread_test receivethread_testcase("LLMessageReceiveThread");
+
+    template<> template<>
+    void receivethread_object::test<1>()
+    {
+        set_test_name("plain datagram");
+
+        U8 buffer[NET_BUFFER_SIZE];
+        S32 size = makeHeader(0, 7, buffer);
+        for (S32 i = 0; i < 40; ++i)
+        {
+            buffer[size++] = (U8)(i + 1);
+        }
+        send(buffer, size);
+
+        LLReceivedPacket packet;
+        ensure("popped", waitForPacket(packet));
+        ensure_equals("size", packet.mSize, size);
+        ensure_equals("wire size", packet.mWireSize, size);
+        ensure_equals("not zero coded", packet.mCompressedSize, 0);
+        ensure("data", memcmp(packet.mData, buffer, size) == 0);
+        ensure_equals("no acks", packet.mAckCount, 0);
+        ensure("sender", packet.mSender == mSenderHost);
+        ensure("unreliable is not acked", !packet.mAcked);
+        ensure("queue emptied", !mThread->popPacket(packet));
+    }
+
+    template<> template<>
+    void receivethread_object::test<2>()
+    {
+        set_test_name("zero coded with appended acks");
+
+        U8 buffer[NET_BUFFER_SIZE];
+        S32 size = makeHeader(LL_ZERO_CODE_FLAG | LL_ACK_FLAG, 8, buffer);
+        // 5, ten zeros, 7, 256 + 3 zeros, 9
+        const U8 payload[] = { 5, 0, 10, 7, 0, 0, 3, 9 };
+        memcpy(&buffer[size], payload, sizeof(payload));    /* Flawfinder: ignore */
+        S32 compressed_size = size + sizeof(payload);
+        size = compressed_size;
+        const U32 acks[] = { htonl(100), htonl(200) };
+        memcpy(&buffer[size], acks, sizeof(acks));  /* Flawfinder: ignore */
+        size += sizeof(acks);
+        buffer[size++] = 2;
+        send(buffer, size);
+
+        U8 expected[NET_BUFFER_SIZE];
+        S32 expected_size = makeHeader(LL_ACK_FLAG, 8, expected);
+        expected[expected_size++] = 5;
+        memset(&expected[expected_size], 0, 10);
+        expected_size += 10;
+        expected[expected_size++] = 7;
+        memset(&expected[expected_size], 0, 259);
+        expected_size += 259;
+        expected[expected_size++] = 9;
+
+        LLReceivedPacket packet;
+        ensure("popped", waitForPacket(packet));
+        ensure_equals("wire size", packet.mWireSize, size);
+        ensure_equals("compressed size", packet.mCompressedSize, compressed_size);
+        ensure_equals("expanded size", packet.mSize, expected_size);
+        ensure("expanded data", memcmp(packet.mData, expected, expected_size) == 0);
+        ensure_equals("ack count", packet.mAckCount, 2);
+        ensure("ack data", memcmp(packet.mAckData, acks, sizeof(acks)) == 0);
+    }
+
+    template<> template<>
+    void receivethread_object::test<3>()
+    {
+        set_test_name("reliable packet on a circuit is acked");
+
+        mCircuits->addCircuitData(mSenderHost, 0);
+
+        U8 buffer[NET_BUFFER_SIZE];
+        S32 size = makeHeader(LL_RELIABLE_FLAG, 42, buffer);
+        buffer[size++] = 1;
+        buffer[size++] = 2;
+        send(buffer, size);
+
+        LLReceivedPacket packet;
+        ensure("popped", waitForPacket(packet));
+        ensure("acked", packet.mAcked);
+
+        U8 reply[NET_BUFFER_SIZE];
+        S32 reply_size = waitForReply(reply);
+        ensure_equals("PacketAck size", reply_size, LL_PACKET_ID_SIZE + 4 + 1 + 4);
+        U32 out_id;
+        memcpy(&out_id, &reply[PHL_PACKET_ID], sizeof(out_id));     /* Flawfinder: ignore */
+        ensure_equals("first packet out on the circuit", ntohl(out_id), (U32)1);
+        const U8 number[] = { 0xFF, 0xFF, 0xFF, 0xFB };
+        ensure("PacketAck number", memcmp(&reply[PHL_NAME], number, sizeof(number)) == 0);
+        ensure_equals("block count", (S32)reply[PHL_NAME + 4], 1);
+        U32 acked_id;
+        htolememcpy(&acked_id, &reply[PHL_NAME + 5], MVT_U32, sizeof(acked_id));
+        ensure_equals("acked id", acked_id, (U32)42);
+        ensure_equals("acks sent", mThread->getAcksSent(), (U64)1);
+    }
+
+    template<> template<>
+    void receivethread_object::test<4>()
+    {
+        set_test_name("reliable packet without a circuit is left to the main thread");
+
+        U8 buffer[NET_BUFFER_SIZE];
+        S32 size = makeHeader(LL_RELIABLE_FLAG, 43, buffer);
+        buffer[size++] = 1;
+        buffer[size++] = 2;
+        send(buffer, size);
+
+        LLReceivedPacket packet;
+        ensure("popped", waitForPacket(packet));
+        ensure("not acked", !packet.mAcked);
+        ensure_equals("acks sent", mThread->getAcksSent(), (U64)0);
+    }
+
+    template<> template<>
+    void receivethread_object::test<5>()
+    {
+        set_test_name("malformed datagrams are dropped");
+
+        U8 buffer[NET_BUFFER_SIZE];
+        // Too short
+        send(buffer, 3);
+        // Claims more acks than it carries
+        S32 size = makeHeader(LL_ACK_FLAG, 9, buffer);
+        buffer[size++] = 1;
+        buffer[size++] = 50;
+        send(buffer, size);
+
+        for (S32 tries = 0; tries < 2000 && mThread->getPacketsDiscarded() < 2; ++tries)
+        {
+            ms_sleep(1);
+        }
+        ensure_equals("discarded", mThread->getPacketsDiscarded(), (U64)2);
+        LLReceivedPacket packet;
+        ensure("nothing queued", !mThread->popPacket(packet));
+    }
+
+    template<> template<>
+    void receivethread_object::test<6>()
+    {
+        set_test_name("proxied datagram is unwrapped");
+
+        // The relay is the sender socket, so datagrams "from the proxy" are
+        // the ones sent by this test.
+        FakeSOCKSServer proxy(mSenderHost.getPort());
+        ensure_equals("proxy started", LLProxy::getInstance()->startSOCKSProxy(proxy.getHost()), SOCKS_OK);
+        ensure("proxy enabled", LLProxy::isSOCKSProxyEnabled());
+
+        // A reliable message from a simulator with a circuit, wrapped the
+        // way the proxy relays it
+        const LLHost origin(ip_string_to_u32("10.1.2.3"), 13005);
+        mCircuits->addCircuitData(origin, 0);
+
+        U8 message[NET_BUFFER_SIZE];
+        S32 message_size = makeHeader(LL_RELIABLE_FLAG, 44, message);
+        for (S32 i = 0; i < 20; ++i)
+        {
+            message[message_size++] = (U8)(i + 1);
+        }
+
+        U8 buffer[NET_BUFFER_SIZE];
+        proxywrap_t* header = (proxywrap_t*)buffer;
+        header->rsv = 0;
+        header->frag = 0;
+        header->atype = ADDRESS_IPV4;
+        header->addr = origin.getAddress();
+        header->port = htons(origin.getPort());
+        memcpy(buffer + SOCKS_HEADER_SIZE, message, message_size);  /* Flawfinder: ignore */
+        send(buffer, SOCKS_HEADER_SIZE + message_size);
+
+        LLReceivedPacket packet;
+        ensure("popped", waitForPacket(packet));
+        ensure_equals("size", packet.mSize, message_size);
+        ensure_equals("wire size", packet.mWireSize, message_size);
+        ensure("data", memcmp(packet.mData, message, message_size) == 0);
+        ensure("sender from header", packet.mSender == origin);
+        // Acks must go out through the proxy, from the main thread
+        ensure("not acked", !packet.mAcked);
+        ensure_equals("acks sent", mThread->getAcksSent(), (U64)0);
+
+        // Too short to carry a SOCKS header
+        send(message, SOCKS_HEADER_SIZE);
+        for (S32 tries = 0; tries < 2000 && !mThread->getPacketsDiscarded(); ++tries)
+        {
+            ms_sleep(1);
+        }
+        ensure_equals("unwrapped runt discarded", mThread->getPacketsDiscarded(), (U64)1);
+
+        LLProxy::getInstance()->stopSOCKSProxy();
+    }
+
+    template<> template<>
+    void receivethread_object::test<7>()
+    {
+        set_test_name("reliable packet checkMessages() would drop is left to it");
+
+        mCircuits->addCircuitData(mSenderHost, 0);
+
+        // Message 9 is not registered
+        U8 buffer[NET_BUFFER_SIZE];
+        S32 size = makeHeader(LL_RELIABLE_FLAG, 45, buffer);
+        buffer[size++] = 9;
+        buffer[size++] = 2;
+        send(buffer, size);
+
+        LLReceivedPacket packet;
+        ensure("unregistered popped", waitForPacket(packet));
+        ensure("unregistered not acked", !packet.mAcked);
+
+        // Message 2 needs four bytes after its number
+        size = makeHeader(LL_RELIABLE_FLAG, 46, buffer);
+        buffer[size++] = 2;
+        buffer[size++] = 1;
+        buffer[size++] = 2;
+        send(buffer, size);
+
+        ensure("short popped", waitForPacket(packet));
+        ensure("short not acked", !packet.mAcked);
+        ensure_equals("acks sent", mThread->getAcksSent(), (U64)0);
+
+        // and is acked once they are there
+        size = makeHeader(LL_RELIABLE_FLAG, 47, buffer);
+        buffer[size++] = 2;
+        for (S32 i = 0; i < 4; ++i)
+        {
+            buffer[size++] = (U8)(i + 1);
+        }
+        send(buffer, size);
+
+        ensure("full popped", waitForPacket(packet));
+        ensure("full acked", packet.mAcked);
+        ensure_equals("acks sent", mThread->getAcksSent(), (U64)1);
+    }
+}
@@ -0,0 +1,229 @@
+/**
+ * @file llpacketring_test.cpp
+ * @brief Loopback tests for batched packet I/O through LLPacketRing.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+#include "../llpacketbuffer.h"
+#include "../net.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct packetring_data
+    {
+        S32 mReceiver;
+        S32 mSender;
+        LLHost mReceiverHost;
+        LLHost mSenderHost;
+
+        packetring_data() : mReceiver(-1), mSender(-1)
+        {
+            int port = NET_USE_OS_ASSIGNED_PORT;
+            ensure_equals("receiver socket", start_net(mReceiver, port), 0);
+            mReceiverHost = LLHost(ip_string_to_u32(LOOPBACK_ADDRESS_STRING), port);
+
+            port = NET_USE_OS_ASSIGNED_PORT;
+            ensure_equals("sender socket", start_net(mSender, port), 0);
+            mSenderHost = LLHost(ip_string_to_u32(LOOPBACK_ADDRESS_STRING), port);
+        }
+
+        ~packetring_data()
+        {
+            end_net(mReceiver);
+            end_net(mSender);
+        }
+
+        // Synthetic sender: datagram i carries its index and a size that varies with it.
+        static S32 makePacket(S32 i, char* buffer)
+        {
+            S32 size = 16 + (i * 37) % 1100;
+            for (S32 j = 0; j < size; ++j)
+            {
+                buffer[j] = (char)(i + j);
+            }
+            return size;
+        }
+
+        void sendPackets(S32 count)
+        {
+            char buffer[NET_BUFFER_SIZE];
+            for (S32 i = 0; i < count; ++i)
+            {
+                S32 size = makePacket(i, buffer);
+                ensure("send_packet", send_packet(mSender, buffer, size, mReceiverHost.getAddress(), mReceiverHost.getPort()));
+            }
+        }
+
+        void checkPacket(S32 i, const char* data, S32 size)
+        {
+            char expected[NET_BUFFER_SIZE];
+            S32 expected_size = makePacket(i, expected);
+            ensure_equals("packet size", size, expected_size);
+            ensure("packet data", memcmp(data, expected, size) == 0);
+        }
+
+        // Reads through the ring until it runs dry, checking each datagram.
+        S32 drainRing(LLPacketRing& ring)
+        {
+            char buffer[NET_BUFFER_SIZE];
+            S32 received = 0;
+            while (S32 size = ring.receivePacket(mReceiver, buffer))
+            {
+                checkPacket(received, buffer, size);
+                ensure("sender", ring.getLastSender() == mSenderHost);
+                ++received;
+            }
+            return received;
+        }
+    };
+    typedef test_group<packetring_data> packetring_test;
+    typedef packetring_test::object packetring_object;
+    tut::packetring_test packetring_testcase("LLPacketRing");
+
+    template<> template<>
+    void packetring_object::test<1>()
+    {
+        set_test_name("pool round trip");
+
+        LLPacketBufferPool out;
+        char buffer[NET_BUFFER_SIZE];
+        for (S32 i = 0; i < NET_MAX_PACKET_BATCH; ++i)
+        {
+            S32 size = makePacket(i, buffer);
+            ensure("append", out.append(mReceiverHost, buffer, size));
+        }
+        ensure("full", out.isFull());
+        ensure("append past full", !out.append(mReceiverHost, buffer, 16));
+        ensure_equals("sent", out.send(mSender), (S32)NET_MAX_PACKET_BATCH);
+        ensure("emptied by send", out.isEmpty());
+
+        LLPacketBufferPool in;
+        S32 received = 0;
+        for (S32 tries = 0; tries < 100 && received < NET_MAX_PACKET_BATCH; ++tries)
+        {
+            S32 count = in.receive(mReceiver);
+            for (S32 i = 0; i < count; ++i, ++received)
+            {
+                const LLPacketBuffer& packet = in.get(i);
+                checkPacket(received, packet.getData(), packet.getSize());
+                ensure("sender", packet.getHost() == mSenderHost);
+            }
+        }
+        ensure_equals("received", received, (S32)NET_MAX_PACKET_BATCH);
+        ensure_equals("nothing left", in.receive(mReceiver), 0);
+    }
+
+    template<> template<>
+    void packetring_object::test<2>()
+    {
+        set_test_name("batched receive");
+
+        const S32 COUNT = 200;
+        sendPackets(COUNT);
+
+        LLPacketRing ring;
+        U64 calls = get_receive_syscall_count();
+        ensure_equals("received", drainRing(ring), COUNT);
+        calls = get_receive_syscall_count() - calls;
+        ensure_equals("ring count", ring.getPacketsReceived(), (U64)COUNT);
+#if LL_LINUX
+        // One call per full batch plus the one that finds the socket empty
+        ensure("batched", calls <= (U64)(COUNT / NET_MAX_PACKET_BATCH + 2));
+#endif
+    }
+
+    template<> template<>
+    void packetring_object::test<3>()
+    {
+        set_test_name("unbatched receive matches");
+
+        const S32 COUNT = 50;
+        sendPackets(COUNT);
+
+        LLPacketRing ring;
+        ring.setUseBatching(false);
+        U64 calls = get_receive_syscall_count();
+        ensure_equals("received", drainRing(ring), COUNT);
+        ensure_equals("one call per packet", get_receive_syscall_count() - calls, (U64)(COUNT + 1));
+    }
+
+    template<> template<>
+    void packetring_object::test<4>()
+    {
+        set_test_name("batched send");
+
+        const S32 COUNT = 70;
+        LLPacketRing out;
+        char buffer[NET_BUFFER_SIZE];
+        U64 calls = get_send_syscall_count();
+        out.beginSendBatch();
+        for (S32 i = 0; i < COUNT; ++i)
+        {
+            S32 size = makePacket(i, buffer);
+            ensure("queued", out.sendPacket(mSender, buffer, size, mReceiverHost));
+        }
+        out.flushSendBatch(mSender);
+        calls = get_send_syscall_count() - calls;
+        ensure_equals("ring count", out.getPacketsSent(), (U64)COUNT);
+#if LL_LINUX
+        ensure("batched", calls <= (U64)(COUNT / NET_MAX_PACKET_BATCH + 1));
+#endif
+
+        LLPacketRing in;
+        ensure_equals("received", drainRing(in), COUNT);
+    }
+
+    template<> template<>
+    void packetring_object::test<5>()
+    {
+        set_test_name("inbound simulation is reported");
+
+        LLPacketRing ring;
+        ensure("off by default", !ring.isSimulatingInbound());
+        ring.setUseOutThrottle(true);
+        ensure("out throttle only", !ring.isSimulatingInbound());
+
+        ring.dropPackets(1);
+        ensure("dropping one", ring.isSimulatingInbound());
+        sendPackets(2);
+        char buffer[NET_BUFFER_SIZE];
+        S32 size = 0;
+        for (S32 tries = 0; tries < 100 && !size; ++tries)
+        {
+            size = ring.receivePacket(mReceiver, buffer);
+        }
+        checkPacket(1, buffer, size);
+        ensure("dropped", !ring.isSimulatingInbound());
+
+        ring.setDropPercentage(5.f);
+        ensure("drop percentage", ring.isSimulatingInbound());
+        ring.setDropPercentage(0.f);
+        ring.setUseInThrottle(true);
+        ensure("in throttle", ring.isSimulatingInbound());
+    }
+}
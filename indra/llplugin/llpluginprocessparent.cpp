@@ -29,6 +29,7 @@
 #include "linden_common.h"
 
 #include "llapp.h"
+#include "cpubudget.h"
 #include "llpluginprocessparent.h"
 #include "llpluginmessagepipe.h"
 #include "llpluginmessageclasses.h"
@@ -539,6 +540,8 @@ void LLPluginProcessParent::idle(void)
                             general_queue,
                             [process_params]() // Work done on general queue
                             {
+                                // waits on fork/exec, not the CPU
+                                LL::CpuBudget::Blocking blocking;
                                 return LLProcess::create(process_params);
                             },
                             [this](LLProcessPtr new_process) // Callback to main thread
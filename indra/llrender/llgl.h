@@ -106,6 +106,7 @@ public:
     bool mHasDebugOutput = false;
     bool mHasTransformFeedback = false;
     bool mHasAnisotropic = false;
+    bool mHasTextureCompressionBPTC = false;
 
     // Vendor-specific extensions
     bool mHasAMDAssociations = false;
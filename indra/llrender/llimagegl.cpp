@@ -34,6 +34,7 @@
 #include "llerror.h"
 #include "llfasttimer.h"
 #include "llimage.h"
+#include "llimagedxt.h"
 
 #include "llmath.h"
 #include "llgl.h"
@@ -43,6 +44,10 @@
 #include "llframetimer.h"
 #include <unordered_set>
 
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
 extern LL_COMMON_API bool on_main_thread();
 
 #if !LL_IMAGEGL_THREAD_CHECK
@@ -286,6 +291,7 @@ S32 LLImageGL::dataFormatBits(S32 dataformat)
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:    return 8;
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:          return 8;
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:    return 8;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:             return 8;
     case GL_LUMINANCE:                              return 8;
     case GL_ALPHA:                                  return 8;
     case GL_RED:                                    return 8;
@@ -317,6 +323,7 @@ S64 LLImageGL::dataFormatBytes(S32 dataformat, S32 width, S32 height)
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
         if (width < 4) width = 4;
         if (height < 4) height = 4;
         break;
@@ -339,6 +346,7 @@ S32 LLImageGL::dataFormatComponents(S32 dataformat)
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: return 4;
       case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:    return 4;
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return 4;
+      case GL_COMPRESSED_RGBA_BPTC_UNORM:       return 4;
       case GL_LUMINANCE:                        return 1;
       case GL_ALPHA:                            return 1;
       case GL_RED:                              return 1;
@@ -1542,6 +1550,67 @@ bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
     return createGLTexture(discard_level, rawdata, false, usename, defer_copy, tex_name);
 }
 
+bool LLImageGL::createCompressedGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* compressed, S32 category)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    checkActiveThread();
+
+    LLGLenum format = 0;
+    if (compressed)
+    {
+        switch (compressed->getFileFormat())
+        {
+          case LLImageDXT::FORMAT_DXR1: format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+          case LLImageDXT::FORMAT_DXR5: format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+          case LLImageDXT::FORMAT_DXR7: format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+          default: break;
+        }
+    }
+
+    if (!format || gGLManager.mIsDisabled || !mUseMipMaps || mHasExplicitFormat
+        || !imageraw || imageraw->isBufferInvalid()
+        || (imageraw->getComponents() != 3 && imageraw->getComponents() != 4)
+        || compressed->getWidth() != imageraw->getWidth() || compressed->getHeight() != imageraw->getHeight())
+    {
+        return createGLTexture(discard_level, imageraw, 0, true, category);
+    }
+
+    if (discard_level < 0)
+    {
+        llassert(mCurrentDiscardLevel >= 0);
+        discard_level = mCurrentDiscardLevel;
+    }
+
+    S32 raw_w = imageraw->getWidth();
+    S32 raw_h = imageraw->getHeight();
+    if (!setSize(raw_w << discard_level, raw_h << discard_level, imageraw->getComponents(), discard_level))
+    {
+        LL_WARNS() << "Trying to create a texture with incorrect dimensions!" << LL_ENDL;
+        mGLTextureCreated = false;
+        return false;
+    }
+
+    // Alpha analysis and the pick mask need the uncompressed texels, which
+    // setImage() skips for compressed data.
+    mFormatPrimary = mComponents == 4 ? GL_RGBA : GL_RGB;
+    mFormatType = GL_UNSIGNED_BYTE;
+    calcAlphaChannelOffsetAndStride();
+    {
+        LLImageDataSharedLock lock(imageraw);
+        analyzeAlpha(imageraw->getData(), raw_w, raw_h);
+        updatePickMask(raw_w, raw_h, imageraw->getData());
+    }
+
+    mFormatInternal = format;
+    mFormatPrimary = format;
+
+    setCategory(category);
+    LLImageDataSharedLock lock(compressed);
+    // The largest mip is last, the smaller ones precede it
+    const U8* data = compressed->getData() + compressed->getMipOffset(0);
+    return createGLTexture(discard_level, data, true);
+}
+
 bool LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, bool data_hasmips, S32 usename, bool defer_copy, LLGLuint* tex_name)
 // Call with void data, vmem is allocated but unitialized
 {
@@ -1812,7 +1881,13 @@ bool LLImageGL::readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compre
             return false ;
         }
 
-        glGetTexImage(GL_TEXTURE_2D, gl_discard, mFormatPrimary, mFormatType, (GLvoid*)(imageraw->getData()));
+        // Block compressed uploads (see createCompressedGLTexture) decompress on read back
+        LLGLenum format = mFormatPrimary;
+        if (isCompressed())
+        {
+            format = ncomponents == 4 ? GL_RGBA : GL_RGB;
+        }
+        glGetTexImage(GL_TEXTURE_2D, gl_discard, format, mFormatType, (GLvoid*)(imageraw->getData()));
         //stop_glerror();
     }
 
@@ -2217,7 +2292,7 @@ void LLImageGL::freePickMask()
     mPickMaskWidth = mPickMaskHeight = 0;
 }
 
-bool LLImageGL::isCompressed()
+bool LLImageGL::isCompressed() const
 {
     llassert(mFormatPrimary != 0);
     // *NOTE: Not all compressed formats are included here.
@@ -2230,6 +2305,7 @@ bool LLImageGL::isCompressed()
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
         is_compressed = true;
         break;
     default:
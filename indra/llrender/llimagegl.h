@@ -43,6 +43,7 @@
 
 #define LL_IMAGEGL_THREAD_CHECK 0 //set to 1 to enable thread debugging for ImageGL
 
+class LLImageDXT;
 class LLWindow;
 
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
@@ -127,6 +128,10 @@ public:
     bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, bool to_create = true,
         S32 category = sMaxCategories-1, bool defer_copy = false, LLGLuint* tex_name = nullptr);
     bool createGLTexture(S32 discard_level, const U8* data, bool data_hasmips = false, S32 usename = 0, bool defer_copy = false, LLGLuint* tex_name = nullptr);
+    // Uploads the mip chain of compressed (DXR1, DXR5 or DXR7), encoded from
+    // imageraw. The alpha analysis and pick mask still come from imageraw.
+    // Falls back to imageraw when compressed does not fit this texture.
+    bool createCompressedGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* compressed, S32 category = sMaxCategories-1);
     void setImage(const LLImageRaw* imageraw);
     bool setImage(const U8* data_in, bool data_hasmips = false, S32 usename = 0);
     // *TODO: This function may not work if the textures is compressed (i.e.
@@ -232,7 +237,7 @@ public:
 private:
     U32 createPickMask(S32 pWidth, S32 pHeight);
     void freePickMask();
-    bool isCompressed();
+    bool isCompressed() const;
 
     LLPointer<LLImageRaw> mSaveData; // used for destroyGL/restoreGL
     LL::WorkQueue::weak_t mMainQueue;
@@ -30,6 +30,7 @@
 #include "llaccordionctrl.h"
 
 #include "lllocalcliprect.h"
+#include "llpanel.h"
 #include "llscrollbar.h"
 #include "lltextbox.h"
 #include "lltextutil.h"
@@ -397,6 +398,10 @@ void LLAccordionCtrlTab::setDisplayChildren(bool display)
 
     if (mContainerPanel)
     {
+        if (getDisplayChildren())
+        {
+            buildContainerPanel();
+        }
         mContainerPanel->setVisible(getDisplayChildren());
     }
 
@@ -611,6 +616,14 @@ LLView* LLAccordionCtrlTab::findContainerView()
     return nullptr;
 }
 
+void LLAccordionCtrlTab::buildContainerPanel()
+{
+    if (LLPanel* panel = dynamic_cast<LLPanel*>(mContainerPanel))
+    {
+        panel->buildDeferred();
+    }
+}
+
 void LLAccordionCtrlTab::selectOnFocusReceived()
 {
     if (getParent()) // A parent may not be set if tabs are added dynamically.
@@ -690,6 +703,10 @@ bool LLAccordionCtrlTab::postBuild()
 
     if (mContainerPanel)
     {
+        if (mDisplayChildren)
+        {
+            buildContainerPanel();
+        }
         mContainerPanel->setVisible(mDisplayChildren);
     }
 
@@ -215,6 +215,8 @@ protected:
     void drawChild(const LLRect& root_rect,LLView* child);
 
     LLView* findContainerView   ();
+    // build a lazy_build container panel before it is first expanded
+    void buildContainerPanel    ();
 
     void selectOnFocusReceived();
     void deselectOnFocusLost();
@@ -45,6 +45,7 @@
 #include "llresizehandle.h"
 #include "llkeyboard.h"
 #include "llmenugl.h"   // MENU_BAR_HEIGHT
+#include "llmemtag.h"
 #include "llmodaldialog.h"
 #include "lltextbox.h"
 #include "llresmgr.h"
@@ -3801,7 +3802,7 @@ bool LLFloater::initFloaterXML(LLXMLNodePtr node, LLView *parent, const std::str
 
         LLUICtrlFactory::instance().pushFileName(xml_filename);
 
-        if (!LLUICtrlFactory::getLayeredXMLNode(xml_filename, referenced_xml))
+        if (!LLUICtrlFactory::getCachedXMLNode(xml_filename, referenced_xml))
         {
             LL_WARNS() << "Couldn't parse panel from: " << xml_filename << LL_ENDL;
 
@@ -3924,9 +3925,10 @@ bool LLFloater::isVisible(const LLFloater* floater)
 bool LLFloater::buildFromFile(const std::string& filename)
 {
     LL_PROFILE_ZONE_SCOPED;
+    LLMemTagScope mem_tag(LLMemTag::UI);
     LLXMLNodePtr root;
 
-    if (!LLUICtrlFactory::getLayeredXMLNode(filename, root))
+    if (!LLUICtrlFactory::getCachedXMLNode(filename, root))
     {
         LL_WARNS() << "Couldn't find (or parse) floater from: " << filename << LL_ENDL;
         return false;
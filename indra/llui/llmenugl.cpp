@@ -1026,12 +1026,12 @@ LLView* LLMenuItemBranchGL::getChildView(std::string_view name, bool recurse) co
     return LLView::getChildView(name, recurse);
 }
 
-LLView* LLMenuItemBranchGL::findChildView(std::string_view name, bool recurse) const
+LLView* LLMenuItemBranchGL::findChildView(const ChildName& name, bool recurse) const
 {
     LLMenuGL* branch = getBranch();
     if (branch)
     {
-        if (branch->getName() == name)
+        if (branch->hasName(name))
         {
             return branch;
         }
@@ -693,7 +693,8 @@ public:
     virtual void openMenu();
 
     virtual LLView* getChildView(std::string_view name, bool recurse = true) const;
-    virtual LLView* findChildView(std::string_view name, bool recurse = true) const;
+    using LLView::findChildView;
+    virtual LLView* findChildView(const ChildName& name, bool recurse = true) const;
 
 private:
     LLHandle<LLView> mBranchHandle;
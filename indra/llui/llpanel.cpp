@@ -40,6 +40,7 @@
 
 #include "llbutton.h"
 #include "llmenugl.h"
+#include "llmemtag.h"
 #include "llui.h"
 #include "llkeyboard.h"
 #include "lllineeditor.h"
@@ -85,7 +86,8 @@ LLPanel::Params::Params()
     class_name("class"),
     help_topic("help_topic"),
     visible_callback("visible_callback"),
-    accepts_badge("accepts_badge")
+    accepts_badge("accepts_badge"),
+    lazy_build("lazy_build", false)
 {
     addSynonym(background_visible, "bg_visible");
     addSynonym(has_border, "border_visible");
@@ -356,6 +358,11 @@ bool LLPanel::handleKeyHere( KEY key, MASK mask )
 
 void LLPanel::onVisibilityChange ( bool new_visibility )
 {
+    if (new_visibility)
+    {
+        // build before telling the children, so the new ones hear it too
+        buildDeferred();
+    }
     LLUICtrl::onVisibilityChange ( new_visibility );
     if (mVisibleSignal)
         (*mVisibleSignal)(this, LLSD(new_visibility) ); // Pass bool as LLSD
@@ -512,6 +519,7 @@ bool LLPanel::initPanelXML(LLXMLNodePtr node, LLView *parent, LLXMLNodePtr outpu
 
         LLXMLNodePtr referenced_xml;
         std::string xml_filename = mXMLFilename;
+        bool deferred = false;
 
         // if the panel didn't provide a filename, check the node
         if (xml_filename.empty())
@@ -539,7 +547,7 @@ bool LLPanel::initPanelXML(LLXMLNodePtr node, LLView *parent, LLXMLNodePtr outpu
             LLUICtrlFactory::instance().pushFileName(xml_filename);
 
             LL_RECORD_BLOCK_TIME(FTM_EXTERNAL_PANEL_LOAD);
-            if (!LLUICtrlFactory::getLayeredXMLNode(xml_filename, referenced_xml))
+            if (!LLUICtrlFactory::getCachedXMLNode(xml_filename, referenced_xml))
             {
                 LL_WARNS() << "Couldn't parse panel from: " << xml_filename << LL_ENDL;
 
@@ -550,7 +558,18 @@ bool LLPanel::initPanelXML(LLXMLNodePtr node, LLView *parent, LLXMLNodePtr outpu
 
             // add children using dimensions from referenced xml for consistent layout
             setShape(params.rect);
-            LLUICtrlFactory::createChildren(this, referenced_xml, child_registry_t::instance());
+
+            bool lazy_build = params.lazy_build;
+            node->getAttributeBOOL("lazy_build", lazy_build);
+            if (lazy_build)
+            {
+                deferred = true;
+                mDeferredRect = params.rect();
+            }
+            else
+            {
+                LLUICtrlFactory::createChildren(this, referenced_xml, child_registry_t::instance());
+            }
 
             LLUICtrlFactory::instance().popFileName();
         }
@@ -585,6 +604,13 @@ bool LLPanel::initPanelXML(LLXMLNodePtr node, LLView *parent, LLXMLNodePtr outpu
             parent->addChild(this, tab_group);
         }
 
+        if (deferred)
+        {
+            // Only now, so that nothing above builds it half initialized. The
+            // template is cached and shared, so holding on to it is cheap.
+            mDeferredXML = referenced_xml;
+        }
+        else
         {
             LL_RECORD_BLOCK_TIME(FTM_PANEL_POSTBUILD);
             postBuild();
@@ -593,6 +619,67 @@ bool LLPanel::initPanelXML(LLXMLNodePtr node, LLView *parent, LLXMLNodePtr outpu
     return true;
 }
 
+static LLTrace::BlockTimerStatHandle FTM_PANEL_DEFERRED_BUILD("Panel Deferred Build");
+
+bool LLPanel::buildDeferred()
+{
+    if (mDeferredXML.isNull())
+    {
+        return false;
+    }
+    LL_RECORD_BLOCK_TIME(FTM_PANEL_DEFERRED_BUILD);
+    LLMemTagScope mem_tag(LLMemTag::UI);
+
+    // clear first: building can make the panel visible, which lands back here
+    LLXMLNodePtr referenced_xml = mDeferredXML;
+    mDeferredXML = NULL;
+
+    // The children's XML may name factory panels and callbacks registered by
+    // any enclosing panel or floater, as it could when the floater was built.
+    std::vector<LLPanel*> scopes;
+    for (LLView* view = this; view; view = view->getParent())
+    {
+        if (LLPanel* panel = dynamic_cast<LLPanel*>(view))
+        {
+            scopes.push_back(panel);
+        }
+    }
+    for (LLPanel* panel : scopes)
+    {
+        sFactoryStack.push_back(&panel->getFactoryMap());
+    }
+    // the innermost scope is searched first, so push it last
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+    {
+        (*it)->getCommitCallbackRegistrar().pushScope();
+        (*it)->getEnableCallbackRegistrar().pushScope();
+    }
+
+    LLUICtrlFactory::instance().pushFileName(mXMLFilename);
+    {
+        // lay the children out in the rect they were written for, then
+        // let their follows flags carry them to the panel's current shape
+        LLRect rect = getRect();
+        setShape(mDeferredRect);
+        LLUICtrlFactory::createChildren(this, referenced_xml, child_registry_t::instance());
+        setShape(rect);
+    }
+    LLUICtrlFactory::instance().popFileName();
+
+    for (LLPanel* panel : scopes)
+    {
+        panel->getCommitCallbackRegistrar().popScope();
+        panel->getEnableCallbackRegistrar().popScope();
+        sFactoryStack.pop_back();
+    }
+
+    {
+        LL_RECORD_BLOCK_TIME(FTM_PANEL_POSTBUILD);
+        postBuild();
+    }
+    return true;
+}
+
 bool LLPanel::hasString(std::string_view name)
 {
     return mUIStrings.find(name) != mUIStrings.end();
@@ -806,10 +893,11 @@ boost::signals2::connection LLPanel::setVisibleCallback( const commit_signal_t::
 bool LLPanel::buildFromFile(const std::string& filename, const LLPanel::Params& default_params)
 {
     LL_PROFILE_ZONE_SCOPED;
+    LLMemTagScope mem_tag(LLMemTag::UI);
     bool didPost = false;
     LLXMLNodePtr root;
 
-    if (!LLUICtrlFactory::getLayeredXMLNode(filename, root))
+    if (!LLUICtrlFactory::getCachedXMLNode(filename, root))
     {
         LL_WARNS() << "Couldn't parse panel from: " << filename << LL_ENDL;
         return didPost;
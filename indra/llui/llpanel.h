@@ -93,6 +93,10 @@ public:
 
         Optional<bool>          accepts_badge;
 
+        // With a filename, read only the panel's own attributes up front and
+        // build its children the first time it is shown (see buildDeferred())
+        Optional<bool>          lazy_build;
+
         Params();
     };
 
@@ -169,6 +173,13 @@ public:
     void initFromParams(const Params& p);
     bool initPanelXML(  LLXMLNodePtr node, LLView *parent, LLXMLNodePtr output_node, const LLPanel::Params& default_params);
 
+    // For a lazy_build panel, create the children from its XML file and run
+    // postBuild(). Tab containers and accordion tabs call this as the panel
+    // is first shown; call it yourself before reaching into a panel that may
+    // not have been shown yet. Returns false if there was nothing to build.
+    bool buildDeferred();
+    bool isBuildDeferred() const { return mDeferredXML.notNull(); }
+
     bool hasString(std::string_view name);
     std::string getString(std::string_view name, const LLStringUtil::format_map_t& args) const;
     std::string getString(std::string_view name) const;
@@ -237,6 +248,11 @@ protected:
     // for setting the xml filename when building panel in context dependent cases
     std::string     mXMLFilename;
 
+    // lazy_build: the referenced XML whose children are still to be built,
+    // and the rect they were laid out in
+    LLXMLNodePtr    mDeferredXML;
+    LLRect          mDeferredRect;
+
 private:
     bool            mBgVisible;             // any background at all?
     bool            mBgOpaque;              // use opaque color or image
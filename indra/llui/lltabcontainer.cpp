@@ -372,13 +372,13 @@ LLView* LLTabContainer::getChildView(std::string_view name, bool recurse) const
 }
 
 //virtual
-LLView* LLTabContainer::findChildView(std::string_view name, bool recurse) const
+LLView* LLTabContainer::findChildView(const ChildName& name, bool recurse) const
 {
     tuple_list_t::const_iterator itor;
     for (itor = mTabList.begin(); itor != mTabList.end(); ++itor)
     {
         LLPanel *panel = (*itor)->mTabPanel;
-        if (panel->getName() == name)
+        if (panel->hasName(name))
         {
             return panel;
         }
@@ -1692,6 +1692,13 @@ bool LLTabContainer::setTab(S32 which)
     {
         setCurrentPanelIndex(which);
 
+        // a lazy_build tab gets its children the first time it is selected,
+        // even while the container itself is hidden
+        if (selected_tuple->mTabPanel)
+        {
+            selected_tuple->mTabPanel->buildDeferred();
+        }
+
         S32 i = 0;
         for(tuple_list_t::iterator iter = mTabList.begin(); iter != mTabList.end(); ++iter)
         {
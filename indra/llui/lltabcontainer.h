@@ -167,7 +167,8 @@ public:
                                        EDragAndDropType type, void* cargo_data,
                                        EAcceptance* accept, std::string& tooltip);
     /*virtual*/ LLView* getChildView(std::string_view name, bool recurse = true) const;
-    /*virtual*/ LLView* findChildView(std::string_view name, bool recurse = true) const;
+    using LLView::findChildView;
+    /*virtual*/ LLView* findChildView(const ChildName& name, bool recurse = true) const;
     /*virtual*/ void initFromParams(const LLPanel::Params& p);
     /*virtual*/ bool addChild(LLView* view, S32 tab_group = 0);
     /*virtual*/ bool postBuild();
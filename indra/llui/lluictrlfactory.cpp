@@ -36,6 +36,7 @@
 
 // other library includes
 #include "llcontrol.h"
+#include "llmemtag.h"
 #include "lldir.h"
 #include "v4color.h"
 #include "v3dmath.h"
@@ -102,7 +103,7 @@ void LLUICtrlFactory::loadWidgetTemplate(const std::string& widget_tag, LLInitPa
     {
         LLUICtrlFactory::instance().pushFileName(base_filename);
 
-        if (!LLXMLNode::getLayeredXMLNode(root_node, search_paths))
+        if (!LLXMLNode::getCachedLayeredXMLNode(root_node, search_paths))
         {
             LL_WARNS() << "Couldn't parse widget from: " << base_filename << LL_ENDL;
             return;
@@ -172,6 +173,24 @@ void LLUICtrlFactory::createChildren(LLView* viewp, LLXMLNodePtr node, const wid
 //-----------------------------------------------------------------------------
 bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root,
                                         LLDir::ESkinConstraint constraint)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+    LLXMLNodePtr cached;
+    if (!getCachedXMLNode(xui_filename, cached, constraint))
+    {
+        return false;
+    }
+
+    // callers are free to modify what they get: give them their own copy
+    root = cached->deepCopy();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// getCachedXMLNode()
+//-----------------------------------------------------------------------------
+bool LLUICtrlFactory::getCachedXMLNode(const std::string &xui_filename, LLXMLNodePtr& root,
+                                       LLDir::ESkinConstraint constraint)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
     std::vector<std::string> paths =
@@ -183,7 +202,7 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
         paths.push_back(xui_filename);
     }
 
-    return LLXMLNode::getLayeredXMLNode(root, paths);
+    return LLXMLNode::getCachedLayeredXMLNode(root, paths);
 }
 
 
@@ -201,6 +220,7 @@ S32 LLUICtrlFactory::saveToXML(LLView* viewp, const std::string& filename)
 LLView *LLUICtrlFactory::createFromXML(LLXMLNodePtr node, LLView* parent, const std::string& filename, const widget_registry_t& registry, LLXMLNodePtr output_node)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+    LLMemTagScope mem_tag(LLMemTag::UI);
     std::string ctrl_type = node->getName()->mString;
     LLStringUtil::toLower(ctrl_type);
 
@@ -156,7 +156,7 @@ public:
         {
             LLXMLNodePtr root_node;
 
-            if (!LLUICtrlFactory::getLayeredXMLNode(filename, root_node))
+            if (!LLUICtrlFactory::getCachedXMLNode(filename, root_node))
             {
                 LL_WARNS() << "Couldn't parse XUI from path: " << instance().getCurFileName() << ", from filename: " << filename << LL_ENDL;
                 goto fail;
@@ -194,6 +194,13 @@ fail:
     static bool getLayeredXMLNode(const std::string &filename, LLXMLNodePtr& root,
                                   LLDir::ESkinConstraint constraint=LLDir::CURRENT_SKIN);
 
+    // Same as getLayeredXMLNode(), but returns the parsed template itself
+    // rather than a copy. Each XUI file is then parsed once, however many
+    // floaters and panels are built from it. The tree is shared by every
+    // caller, so only use this to build views from it: never modify it.
+    static bool getCachedXMLNode(const std::string &filename, LLXMLNodePtr& root,
+                                 LLDir::ESkinConstraint constraint=LLDir::CURRENT_SKIN);
+
 private:
     //NOTE: both friend declarations are necessary to keep both gcc and msvc happy
     template <typename T> friend class LLChildRegistry;
@@ -144,6 +144,7 @@ LLView::LLView(const LLView::Params& p)
 :   mVisible(p.visible),
     mInDraw(false),
     mName(p.name),
+    mNameHash(hashName(getName())),
     mParentView(NULL),
     mReshapeFlags(FOLLOWS_NONE),
     mFromXUI(p.from_xui),
@@ -1713,7 +1714,7 @@ LLView* LLView::getChildView(std::string_view name, bool recurse) const
     return getChild<LLView>(name, recurse);
 }
 
-LLView* LLView::findChildView(std::string_view name, bool recurse) const
+LLView* LLView::findChildView(const ChildName& name, bool recurse) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
 
@@ -1721,7 +1722,7 @@ LLView* LLView::findChildView(std::string_view name, bool recurse) const
     for (LLView* childp : mChildList)
     {
         llassert(childp);
-        if (childp->getName() == name)
+        if (childp->hasName(name))
         {
             return childp;
         }
@@ -38,6 +38,7 @@
 #include "llmortician.h"
 #include "llmousehandler.h"
 #include "llstring.h"
+#include "llsymbol.h"
 #include "llrect.h"
 #include "llui.h"
 #include "lluistring.h"
@@ -237,7 +238,7 @@ public:
     void        setFollowsAll()                 { mReshapeFlags |= FOLLOWS_ALL; }
 
     void        setSoundFlags(U8 flags)         { mSoundFlags = flags; }
-    void        setName(std::string name)           { mName = name; }
+    void        setName(std::string name)           { mName = name; mNameHash = hashName(getName()); }
     void        setUseBoundingRect( bool use_bounding_rect );
     bool        getUseBoundingRect() const;
 
@@ -466,8 +467,29 @@ public:
         return *getChild<T>(name, recurse);
     }
 
+    /**
+     * A name to look for among child views, hashed once for a whole
+     * findChildView() search so that most views are ruled out without a
+     * string compare. View names are not interned, since some come from
+     * user data such as inventory item names; pass an LLSymbol for a
+     * literal key to skip even the one hash.
+     */
+    struct ChildName
+    {
+        ChildName(std::string_view name): mName(name), mHash(hashName(name)) {}
+        ChildName(const LLSymbol& name): mName(name.str()), mHash(name.empty() ? hashName(mName) : name.hash()) {}
+
+        std::string_view mName;
+        size_t mHash;
+    };
+    // the same hash as LLSymbol::hash()
+    static size_t hashName(std::string_view name) { return std::hash<std::string_view>()(name); }
+    bool hasName(const ChildName& name) const { return mNameHash == name.mHash && getName() == name.mName; }
+
     virtual LLView* getChildView(std::string_view name, bool recurse = true) const;
-    virtual LLView* findChildView(std::string_view name, bool recurse = true) const;
+    LLView* findChildView(std::string_view name, bool recurse = true) const { return findChildView(ChildName(name), recurse); }
+    LLView* findChildView(const LLSymbol& name, bool recurse = true) const { return findChildView(ChildName(name), recurse); }
+    virtual LLView* findChildView(const ChildName& name, bool recurse = true) const;
 
     template <class T> T* getDefaultWidget(std::string_view name) const
     {
@@ -596,6 +618,7 @@ private:
 
     std::string mLayout;
     std::string mName;
+    size_t      mNameHash;  // of getName()
 
     U32         mReshapeFlags;
 
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <iterator>
 
 #include "llcontrol.h"
 
@@ -47,6 +48,8 @@
 #include "llfile.h"
 #include "lltimer.h"
 #include "lldir.h"
+#include "hbxxh.h"
+#include "llmemorystream.h"
 
 #if LL_RELEASE_WITH_DEBUG_INFO || LL_DEBUG
 #define CONTROL_ERRS LL_ERRS("ControlErrors")
@@ -169,6 +172,7 @@ LLControlVariable::LLControlVariable(const std::string& name, eControlType type,
     }
     //Push back versus setValue'ing here, since we don't want to call a signal yet
     mValues.push_back(initial);
+    publishValue();
 
     mSanityValues.push_back(sanityValues[0]);
     mSanityValues.push_back(sanityValues[1]);
@@ -233,7 +237,7 @@ void LLControlVariable::setValue(const LLSD& new_value, bool saved_value)
     if(saved_value)
     {
         // If we're going to save this value, return to default but don't fire
-        resetToDefault(false);
+        popToDefault();
         if (!llsd_compare(mValues.back(), storable_value))
         {
             mValues.push_back(storable_value);
@@ -265,6 +269,7 @@ void LLControlVariable::setValue(const LLSD& new_value, bool saved_value)
 
     if(value_changed)
     {
+        publishValue();
         firePropertyChanged(original_value);
         mSanitySignal(this,isSane());
     }
@@ -280,10 +285,11 @@ void LLControlVariable::setDefaultValue(const LLSD& value)
     LLSD comparable_value = getComparableValue(value);
     LLSD original_value = getValue();
     bool value_changed = !llsd_compare(original_value, comparable_value);
-    resetToDefault(false);
+    popToDefault();
     mValues[0] = comparable_value;
     if (value_changed)
     {
+        publishValue();
         mSanitySignal(this,isSane());
         firePropertyChanged(original_value);
     }
@@ -317,15 +323,90 @@ void LLControlVariable::resetToDefault(bool fire_signal)
     //Pop to it and fire off the listener
     LLSD originalValue = mValues.back();
 
+    popToDefault();
+    publishValue();
+
+    if(fire_signal)
+    {
+        firePropertyChanged(originalValue);
+    }
+}
+
+void LLControlVariable::popToDefault()
+{
+    // Doesn't publish: setValue() and setDefaultValue() pass through the
+    // default on their way to the new value, and handle readers on other
+    // threads mustn't see it.
     while(mValues.size() > 1)
     {
         mValues.pop_back();
     }
+}
 
-    if(fire_signal)
+// static
+LLSD LLControlVariable::unsharedCopy(const LLSD& value)
+{
+    switch (value.type())
     {
-        firePropertyChanged(originalValue);
+    case LLSD::TypeMap:
+    {
+        LLSD copy(LLSD::emptyMap());
+        for (LLSD::map_const_iterator it = value.beginMap(); it != value.endMap(); ++it)
+        {
+            copy[it->first] = unsharedCopy(it->second);
+        }
+        return copy;
+    }
+    case LLSD::TypeArray:
+    {
+        LLSD copy(LLSD::emptyArray());
+        for (LLSD::array_const_iterator it = value.beginArray(); it != value.endArray(); ++it)
+        {
+            copy.append(unsharedCopy(*it));
+        }
+        return copy;
+    }
+    case LLSD::TypeBoolean: return LLSD(value.asBoolean());
+    case LLSD::TypeInteger: return LLSD(value.asInteger());
+    case LLSD::TypeReal:    return LLSD(value.asReal());
+    case LLSD::TypeString:  return LLSD(value.asString());
+    case LLSD::TypeUUID:    return LLSD(value.asUUID());
+    case LLSD::TypeDate:    return LLSD(value.asDate());
+    case LLSD::TypeURI:     return LLSD(value.asURI());
+    case LLSD::TypeBinary:  return LLSD(value.asBinary());
+    default:                return LLSD();
+    }
+}
+
+void LLControlVariable::publishValue()
+{
+    const LLSD& value = mValues.back();
+    U32 bits = 0;
+    switch (mType)
+    {
+    case TYPE_BOOLEAN:
+        bits = value.asBoolean() ? 1 : 0;
+        break;
+    case TYPE_S32:
+    {
+        S32 s32 = value.asInteger();
+        memcpy(&bits, &s32, sizeof(bits));
+        break;
+    }
+    case TYPE_U32:
+        bits = (U32)value.asInteger();
+        break;
+    case TYPE_F32:
+    {
+        F32 f32 = (F32)value.asReal();
+        memcpy(&bits, &f32, sizeof(bits));
+        break;
     }
+    default:
+        break;
+    }
+    mScalarBits.store(bits, std::memory_order_release);
+    std::atomic_store(&mSnapshot, std::shared_ptr<const LLSD>(std::make_shared<LLSD>(unsharedCopy(value))));
 }
 
 bool LLControlVariable::isSane()
@@ -419,8 +500,25 @@ LLPointer<LLControlVariable> LLControlGroup::getControl(std::string_view name)
         incrCount(name);
     }
 
-    ctrl_name_table_t::iterator iter = mNameTable.find(name);
-    return iter == mNameTable.end() ? LLPointer<LLControlVariable>() : iter->second;
+    // a name nobody has interned cannot be a control
+    auto symbol = LLSymbol::find(name);
+    if (! symbol)
+    {
+        return LLPointer<LLControlVariable>();
+    }
+    ctrl_symbol_table_t::iterator iter = mSymbolTable.find(*symbol);
+    return iter == mSymbolTable.end() ? LLPointer<LLControlVariable>() : iter->second;
+}
+
+LLPointer<LLControlVariable> LLControlGroup::getControl(const LLSymbol& name)
+{
+    if (mSettingsProfile)
+    {
+        incrCount(name.str());
+    }
+
+    ctrl_symbol_table_t::iterator iter = mSymbolTable.find(name);
+    return iter == mSymbolTable.end() ? LLPointer<LLControlVariable>() : iter->second;
 }
 
 
@@ -452,6 +550,8 @@ const std::string LLControlGroup::mSanityTypeString[SANITY_TYPE_COUNT] = { "None
                                                                           ,"NotBetween"
                                                                           };
 
+std::string LLControlGroup::sSnapshotDirectory;
+
 LLControlGroup::LLControlGroup(const std::string& name)
 :   LLInstanceTracker<LLControlGroup, std::string>(name),
     mSettingsProfile(false)
@@ -529,6 +629,7 @@ void LLControlGroup::cleanup()
     }
 
     mNameTable.clear();
+    mSymbolTable.clear();
 }
 
 eControlType LLControlGroup::typeStringToEnum(const std::string& typestr)
@@ -572,9 +673,18 @@ LLControlVariable* LLControlGroup::declareControl(const std::string& name, eCont
             if (!existing_control->llsd_compare(existing_control->getDefault(), initial_val))
             {
                 // Sometimes we need to declare a control *after* it has been loaded from a settings file.
+                // Swap the default in under the loaded value directly: going through
+                // setDefaultValue() and setValue() would publish the declared default
+                // to handle readers in between. The value itself doesn't change, so
+                // nothing fires.
                 LLSD cur_value = existing_control->getValue(); // get the current value
-                existing_control->setDefaultValue(initial_val); // set the default to the declared value
-                existing_control->setValue(cur_value); // now set to the loaded value
+                existing_control->popToDefault();
+                existing_control->mValues[0] = existing_control->getComparableValue(initial_val);
+                if (!existing_control->llsd_compare(existing_control->mValues[0], cur_value))
+                {
+                    existing_control->mValues.push_back(cur_value); // keep the loaded value
+                }
+                existing_control->publishValue();
             }
         }
         else
@@ -590,6 +700,7 @@ LLControlVariable* LLControlGroup::declareControl(const std::string& name, eCont
     LLControlVariable* control = new LLControlVariable(name, type, initial_val, comment, sanity_type, sanity_value, sanity_comment, persist, can_backup, hidefromsettingseditor);
     // </FS:Zi>
     mNameTable[name] = control;
+    mSymbolTable[LLSymbol(name)] = control;
     return control;
 }
 
@@ -1052,6 +1163,362 @@ U32 LLControlGroup::loadFromFileLegacy(const std::string& filename, bool require
     return validitems;
 }
 
+namespace
+{
+    // One entry of a settings file, as loadFromFile() applies it
+    struct SettingRecord
+    {
+        std::string mName;
+        S32         mType{ TYPE_COUNT };        // typeStringToEnum(), may be -1
+        LLSD        mValue;
+        std::string mComment;
+        // "Persist" and "Backup" are optional: -1 when absent, which
+        // loadFromFile() treats the same as any other non-zero value
+        S32         mPersist{ -1 };
+        S32         mBackup{ -1 };              // <FS:Zi> Backup Settings
+        S32         mHideFromEditor{ 0 };
+        S32         mSanityType{ SANITY_TYPE_NONE };
+        LLSD        mSanityValue;
+        std::string mSanityComment;
+    };
+    typedef std::vector<SettingRecord> setting_records_t;
+
+    void records_from_llsd(const LLSD& settings, setting_records_t& records)
+    {
+        records.clear();
+        records.reserve(settings.size());
+        for (LLSD::map_const_iterator itr = settings.beginMap(); itr != settings.endMap(); ++itr)
+        {
+            LLSD const & control_map = itr->second;
+            records.emplace_back();
+            SettingRecord& record = records.back();
+            record.mName = itr->first;
+            record.mType = LLControlGroup::typeStringToEnum(control_map["Type"].asString());
+            record.mValue = control_map["Value"];
+            record.mComment = control_map["Comment"].asString();
+            if (control_map.has("Persist"))
+            {
+                record.mPersist = control_map["Persist"].asInteger();
+            }
+            if (control_map.has("Backup"))
+            {
+                record.mBackup = control_map["Backup"].asInteger();
+            }
+            record.mHideFromEditor = control_map["HideFromEditor"].asInteger();
+            record.mSanityType = LLControlGroup::sanityTypeStringToEnum(control_map["SanityCheckType"].asString());
+            record.mSanityValue = control_map["SanityValue"];
+            record.mSanityComment = control_map["SanityComment"].asString();
+        }
+    }
+
+    // A settings snapshot is this header followed by mRecords SettingRecords,
+    // with strings and containers length-prefixed. Snapshots are private to
+    // one machine, so everything is in native byte order.
+    const char SNAPSHOT_MAGIC[8] = { 'L', 'L', 'C', 'T', 'R', 'L', 'S', '3' };
+
+    struct SnapshotHeader
+    {
+        char mMagic[sizeof(SNAPSHOT_MAGIC)];
+        U64  mSourceHash;   // HBXXH64 of the XML the snapshot was made from
+        U64  mPayloadHash;  // HBXXH64 of the payload
+        U64  mPayloadSize;  // bytes after the header
+        U64  mRecords;
+    };
+
+    class SnapshotWriter
+    {
+    public:
+        template <typename T>
+        void put(T value)
+        {
+            mBuffer.append((const char*)&value, sizeof(value));
+        }
+
+        void putString(const std::string& str)
+        {
+            put<U32>((U32)str.size());
+            mBuffer.append(str);
+        }
+
+        // tagged by LLSD type, so that values read back exactly as the
+        // XML parser made them
+        void putLLSD(const LLSD& value)
+        {
+            switch (value.type())
+            {
+            case LLSD::TypeBoolean: put<char>('b'); put<U8>(value.asBoolean()); break;
+            case LLSD::TypeInteger: put<char>('i'); put<S32>(value.asInteger()); break;
+            case LLSD::TypeReal:    put<char>('r'); put<F64>(value.asReal()); break;
+            case LLSD::TypeString:  put<char>('s'); putString(value.asString()); break;
+            case LLSD::TypeUUID:    put<char>('x'); mBuffer.append((const char*)value.asUUID().mData, UUID_BYTES); break;
+            case LLSD::TypeDate:    put<char>('d'); put<F64>(value.asDate().secondsSinceEpoch()); break;
+            case LLSD::TypeURI:     put<char>('l'); putString(value.asString()); break;
+            case LLSD::TypeBinary:
+            {
+                const LLSD::Binary& binary = value.asBinary();
+                put<char>('B');
+                put<U32>((U32)binary.size());
+                mBuffer.append((const char*)binary.data(), binary.size());
+                break;
+            }
+            case LLSD::TypeArray:
+                put<char>('[');
+                put<U32>((U32)value.size());
+                for (LLSD::array_const_iterator it = value.beginArray(); it != value.endArray(); ++it)
+                {
+                    putLLSD(*it);
+                }
+                break;
+            case LLSD::TypeMap:
+                put<char>('{');
+                put<U32>((U32)value.size());
+                for (LLSD::map_const_iterator it = value.beginMap(); it != value.endMap(); ++it)
+                {
+                    putString(it->first);
+                    putLLSD(it->second);
+                }
+                break;
+            default:
+                put<char>('!');
+                break;
+            }
+        }
+
+        void putRecord(const SettingRecord& record)
+        {
+            putString(record.mName);
+            put<S32>(record.mType);
+            put<S32>(record.mPersist);
+            put<S32>(record.mBackup);
+            put<S32>(record.mHideFromEditor);
+            put<S32>(record.mSanityType);
+            putString(record.mComment);
+            putString(record.mSanityComment);
+            putLLSD(record.mValue);
+            putLLSD(record.mSanityValue);
+        }
+
+        const std::string& buffer() const { return mBuffer; }
+
+    private:
+        std::string mBuffer;
+    };
+
+    // Every read is bounds checked: a truncated or corrupt snapshot makes
+    // the reader fail rather than read past the buffer.
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader(const char* data, size_t size): mData(data), mEnd(data + size) {}
+
+        template <typename T>
+        bool get(T& value)
+        {
+            if ((size_t)(mEnd - mData) < sizeof(value))
+            {
+                return false;
+            }
+            memcpy(&value, mData, sizeof(value));
+            mData += sizeof(value);
+            return true;
+        }
+
+        bool getString(std::string& str)
+        {
+            U32 size;
+            if (!get(size) || (size_t)(mEnd - mData) < size)
+            {
+                return false;
+            }
+            str.assign(mData, size);
+            mData += size;
+            return true;
+        }
+
+        bool getLLSD(LLSD& value, S32 depth = 0)
+        {
+            char tag;
+            if (depth > MAX_DEPTH || !get(tag))
+            {
+                return false;
+            }
+            switch (tag)
+            {
+            case 'b': { U8 b; if (!get(b)) return false; value = LLSD::Boolean(b != 0); return true; }
+            case 'i': { S32 i; if (!get(i)) return false; value = LLSD::Integer(i); return true; }
+            case 'r': { F64 r; if (!get(r)) return false; value = LLSD::Real(r); return true; }
+            case 's': { std::string str; if (!getString(str)) return false; value = str; return true; }
+            case 'x':
+            {
+                LLUUID id;
+                if ((size_t)(mEnd - mData) < UUID_BYTES) return false;
+                memcpy(id.mData, mData, UUID_BYTES);
+                mData += UUID_BYTES;
+                value = id;
+                return true;
+            }
+            case 'd': { F64 d; if (!get(d)) return false; value = LLDate(d); return true; }
+            case 'l': { std::string str; if (!getString(str)) return false; value = LLURI(str); return true; }
+            case 'B':
+            {
+                U32 size;
+                if (!get(size) || (size_t)(mEnd - mData) < size) return false;
+                value = LLSD::Binary((const U8*)mData, (const U8*)mData + size);
+                mData += size;
+                return true;
+            }
+            case '[':
+            {
+                U32 count;
+                if (!get(count)) return false;
+                value = LLSD::emptyArray();
+                for (U32 i = 0; i < count; ++i)
+                {
+                    LLSD element;
+                    if (!getLLSD(element, depth + 1)) return false;
+                    value.append(element);
+                }
+                return true;
+            }
+            case '{':
+            {
+                U32 count;
+                if (!get(count)) return false;
+                value = LLSD::emptyMap();
+                for (U32 i = 0; i < count; ++i)
+                {
+                    std::string key;
+                    LLSD element;
+                    if (!getString(key) || !getLLSD(element, depth + 1)) return false;
+                    value[key] = element;
+                }
+                return true;
+            }
+            case '!':
+                value.clear();
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool getRecord(SettingRecord& record)
+        {
+            return getString(record.mName)
+                && get(record.mType)
+                && get(record.mPersist)
+                && get(record.mBackup)
+                && get(record.mHideFromEditor)
+                && get(record.mSanityType)
+                && getString(record.mComment)
+                && getString(record.mSanityComment)
+                && getLLSD(record.mValue)
+                && getLLSD(record.mSanityValue);
+        }
+
+        bool atEnd() const { return mData == mEnd; }
+
+    private:
+        static const S32 MAX_DEPTH = 64;
+        const char* mData;
+        const char* mEnd;
+    };
+
+    std::string snapshot_path(const std::string& filename)
+    {
+        // one snapshot per settings file path
+        return gDirUtilp->add(LLControlGroup::getSnapshotDirectory(),
+                              llformat("settings_%016llx.snapshot", (unsigned long long)HBXXH64::digest(filename)));
+    }
+
+    bool load_snapshot(const std::string& filename, U64 source_hash, setting_records_t& records)
+    {
+        if (LLControlGroup::getSnapshotDirectory().empty())
+        {
+            return false;
+        }
+        // one read for the whole file, a check of the fixed-size header,
+        // then one pass over the records
+        const std::string buffer(LLFile::getContents(snapshot_path(filename)));
+        SnapshotHeader header;
+        if (buffer.size() < sizeof(header))
+        {
+            return false;
+        }
+        memcpy(&header, buffer.data(), sizeof(header));
+        if (memcmp(header.mMagic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+            || header.mSourceHash != source_hash
+            || header.mPayloadSize != buffer.size() - sizeof(header))
+        {
+            LL_DEBUGS("Settings") << "Stale or missing snapshot for " << filename << LL_ENDL;
+            return false;
+        }
+        // a damaged payload can still parse, into wrong values that would
+        // then be saved back to the XML
+        const char* payload = buffer.data() + sizeof(header);
+        if (header.mPayloadHash != HBXXH64::digest(payload, header.mPayloadSize))
+        {
+            LL_WARNS("Settings") << "Corrupt settings snapshot for " << filename << LL_ENDL;
+            return false;
+        }
+        SnapshotReader reader(payload, header.mPayloadSize);
+        // every record takes well over one byte: a bogus count can't
+        // make us reserve more than the buffer could hold
+        records.clear();
+        records.reserve(llmin(header.mRecords, header.mPayloadSize));
+        for (U64 i = 0; i < header.mRecords; ++i)
+        {
+            records.emplace_back();
+            if (!reader.getRecord(records.back()))
+            {
+                LL_WARNS("Settings") << "Corrupt settings snapshot for " << filename << LL_ENDL;
+                records.clear();
+                return false;
+            }
+        }
+        return reader.atEnd();
+    }
+
+    void save_snapshot(const std::string& filename, U64 source_hash, const setting_records_t& records)
+    {
+        if (LLControlGroup::getSnapshotDirectory().empty())
+        {
+            return;
+        }
+        SnapshotWriter writer;
+        for (const SettingRecord& record : records)
+        {
+            writer.putRecord(record);
+        }
+
+        SnapshotHeader header;
+        memcpy(header.mMagic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.mSourceHash = source_hash;
+        header.mPayloadHash = HBXXH64::digest(writer.buffer().data(), writer.buffer().size());
+        header.mPayloadSize = writer.buffer().size();
+        header.mRecords = records.size();
+
+        // write aside and rename, so a reader never sees half a snapshot
+        const std::string path(snapshot_path(filename));
+        const std::string temp_path(path + ".tmp");
+        LLFILE* file = LLFile::fopen(temp_path, "wb");
+        if (!file)
+        {
+            LL_WARNS("Settings") << "Unable to write settings snapshot " << temp_path << LL_ENDL;
+            return;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                       && fwrite(writer.buffer().data(), 1, writer.buffer().size(), file) == writer.buffer().size();
+        LLFile::close(file);
+        LLFile::remove(path, ENOENT);
+        if (!written || LLFile::rename(temp_path, path) != 0)
+        {
+            LL_WARNS("Settings") << "Unable to write settings snapshot " << path << LL_ENDL;
+            LLFile::remove(temp_path, ENOENT);
+        }
+    }
+} // anonymous namespace
+
 U32 LLControlGroup::saveToFile(const std::string& filename, bool nondefault_only)
 {
     LLSD settings;
@@ -1073,13 +1540,23 @@ U32 LLControlGroup::saveToFile(const std::string& filename, bool nondefault_only
             ++num_saved;
         }
     }
+    std::ostringstream xml;
+    LLSDSerialize::toPrettyXML(settings, xml);
+    const std::string contents(xml.str());
     llofstream file;
-    file.open(filename.c_str());
+    file.open(filename.c_str(), std::ios::out | std::ios::binary);
     if (file.is_open())
     {
-        LLSDSerialize::toPrettyXML(settings, file);
+        file.write(contents.data(), contents.size());
         file.close();
         LL_INFOS("Settings") << "Saved to " << filename << LL_ENDL;
+        if (!sSnapshotDirectory.empty())
+        {
+            // the next loadFromFile() reads back exactly these bytes
+            setting_records_t records;
+            records_from_llsd(settings, records);
+            save_snapshot(filename, HBXXH64::digest(contents), records);
+        }
     }
     else
     {
@@ -1092,7 +1569,6 @@ U32 LLControlGroup::saveToFile(const std::string& filename, bool nondefault_only
 
 U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_values, bool save_values)
 {
-    LLSD settings;
     llifstream infile;
     infile.open(filename.c_str());
     if(!infile.is_open())
@@ -1101,47 +1577,51 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
         return 0;
     }
 
-    if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(settings, infile))
+    LLTimer load_timer;
+    // Read the whole file so the in-memory parser can be used
+    std::string contents((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    infile.close();
+    const U64 source_hash = sSnapshotDirectory.empty() ? 0 : HBXXH64::digest(contents);
+    setting_records_t records;
+    const bool from_snapshot = load_snapshot(filename, source_hash, records);
+    if (!from_snapshot)
     {
-        infile.close();
-        LL_WARNS("Settings") << "Unable to parse LLSD control file " << filename << ". Trying Legacy Method." << LL_ENDL;
-        return loadFromFileLegacy(filename, true, TYPE_STRING);
+        LLSD settings;
+        if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXMLBuffer(settings, contents.data(), contents.size()))
+        {
+            LL_WARNS("Settings") << "Unable to parse LLSD control file " << filename << ". Trying Legacy Method." << LL_ENDL;
+            return loadFromFileLegacy(filename, true, TYPE_STRING);
+        }
+        records_from_llsd(settings, records);
+        save_snapshot(filename, source_hash, records);
     }
+    const F64 parse_ms = load_timer.getElapsedTimeF64() * 1000.0;
 
     U32 validitems = 0;
-    bool hidefromsettingseditor = false;
 
-    for(LLSD::map_const_iterator itr = settings.beginMap(); itr != settings.endMap(); ++itr)
+    for (const SettingRecord& record : records)
     {
         LLControlVariable::ePersist persist = LLControlVariable::PERSIST_NONDFT;
         bool can_backup = true;     // <FS:Zi> Backup Settings
-        std::string const & name = itr->first;
-        LLSD const & control_map = itr->second;
+        std::string const & name = record.mName;
 
-        if(control_map.has("Persist"))
+        if(record.mPersist >= 0)
         {
-            persist = control_map["Persist"].asInteger()?
+            persist = record.mPersist?
                       LLControlVariable::PERSIST_NONDFT : LLControlVariable::PERSIST_NO;
         }
 
         // <FS:Zi> Backup Settings
-        if(control_map.has("Backup"))
+        if(record.mBackup >= 0)
         {
-            can_backup = control_map["Backup"].asInteger();
+            can_backup = record.mBackup;
         }
         // </FS:Zi>
 
         // Sometimes we want to use the settings system to provide cheap persistence, but we
         // don't want the settings themselves to be easily manipulated in the UI because
         // doing so can cause support problems. So we have this option:
-        if(control_map.has("HideFromEditor"))
-        {
-            hidefromsettingseditor = control_map["HideFromEditor"].asInteger();
-        }
-        else
-        {
-            hidefromsettingseditor = false;
-        }
+        bool hidefromsettingseditor = record.mHideFromEditor != 0;
 
         // If the control exists just set the value from the input file.
         LLControlVariable* existing_control = getControl(name);
@@ -1153,13 +1633,13 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
             {
                 // Override all previously set properties of this control.
                 // ... except for type. The types must match.
-                eControlType new_type = typeStringToEnum(control_map["Type"].asString());
+                eControlType new_type = (eControlType)record.mType;
                 if(existing_control->isType(new_type))
                 {
-                    existing_control->setDefaultValue(control_map["Value"]);
+                    existing_control->setDefaultValue(record.mValue);
                     existing_control->setPersist(persist);
                     existing_control->setHiddenFromSettingsEditor(hidefromsettingseditor);
-                    existing_control->setComment(control_map["Comment"].asString());
+                    existing_control->setComment(record.mComment);
                     existing_control->setBackupable(can_backup);        // <FS:Zi> Backup Settings
                 }
                 else
@@ -1174,7 +1654,7 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
                 // save_values is specifically false for (e.g.)
                 // SessionSettingsFile and UserSessionSettingsFile -- in other
                 // words, for a file that's supposed to be transient.
-                existing_control->setValue(control_map["Value"], save_values);
+                existing_control->setValue(record.mValue, save_values);
             }
             // *NOTE: If not persisted and not setting defaults,
             // the value should not get loaded.
@@ -1215,12 +1695,12 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
             }
 
             declareControl(name,
-                           typeStringToEnum(control_map["Type"].asString()),
-                           control_map["Value"],
-                           control_map["Comment"].asString(),
-                           sanityTypeStringToEnum(control_map["SanityCheckType"].asString()),
-                           control_map["SanityValue"],
-                           control_map["SanityComment"].asString(),
+                           (eControlType)record.mType,
+                           record.mValue,
+                           record.mComment,
+                           (eSanityType)record.mSanityType,
+                           record.mSanityValue,
+                           record.mSanityComment,
                            persist,
                            can_backup,      // <FS:Zi> Backup Settings
                            hidefromsettingseditor
@@ -1230,10 +1710,23 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
         ++validitems;
     }
 
-    LL_DEBUGS("Settings") << "Loaded " << validitems << " settings from " << filename << LL_ENDL;
+    LL_INFOS("Settings") << "Loaded " << validitems << " settings from " << filename
+                         << (from_snapshot ? " (snapshot)" : " (XML)") << ": parsed in " << parse_ms
+                         << " ms, applied in " << (load_timer.getElapsedTimeF64() * 1000.0 - parse_ms)
+                         << " ms" << LL_ENDL;
     return validitems;
 }
 
+// static
+void LLControlGroup::setSnapshotDirectory(const std::string& dir)
+{
+    if (!dir.empty() && !LLFile::isdir(dir))
+    {
+        LLFile::mkdir(dir);
+    }
+    sSnapshotDirectory = dir;
+}
+
 void LLControlGroup::resetToDefaults()
 {
     ctrl_name_table_t::iterator control_iter;
@@ -30,10 +30,16 @@
 #include "llboost.h"
 #include "llevent.h"
 #include "llstring.h"
+#include "llsymbol.h"
 #include "llrect.h"
 #include "llrefcount.h"
 #include "llinstancetracker.h"
 
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/bind.hpp>
@@ -106,6 +112,11 @@ private:
     bool            mHideFromSettingsEditor;
     std::vector<LLSD> mValues;
     std::vector<LLSD> mSanityValues;
+    // mValues.back() as published for LLControlHandle, which may read it
+    // from other threads: the raw bits of a bool/S32/U32/F32 value, and a
+    // private copy of the LLSD for every type
+    std::atomic<U32> mScalarBits{ 0 };
+    std::shared_ptr<const LLSD> mSnapshot;
 
     commit_signal_t mCommitSignal;
     validate_signal_t mValidateSignal;
@@ -163,7 +174,16 @@ public:
     void setHiddenFromSettingsEditor(bool hide);
     void setComment(const std::string& comment);
 
+    // Thread-safe reads of the current value, for LLControlHandle
+    U32 getScalarBits() const { return mScalarBits.load(std::memory_order_acquire); }
+    std::shared_ptr<const LLSD> getSnapshot() const { return std::atomic_load(&mSnapshot); }
+    // LLSD copies share their (non-atomic) reference counts: a copy to hand
+    // to another thread must share nothing with the original
+    static LLSD unsharedCopy(const LLSD& value);
+
 private:
+    void popToDefault();
+    void publishValue();
     void firePropertyChanged(const LLSD &pPreviousValue)
     {
         mCommitSignal(this, mValues.back(), pPreviousValue);
@@ -204,8 +224,12 @@ class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 protected:
     typedef std::map<std::string, LLControlVariablePtr, std::less<> > ctrl_name_table_t;
     ctrl_name_table_t mNameTable;
+    // the same controls by interned name, for getControl()
+    typedef std::unordered_map<LLSymbol, LLControlVariablePtr> ctrl_symbol_table_t;
+    ctrl_symbol_table_t mSymbolTable;
     static const std::string mTypeString[TYPE_COUNT];
     static const std::string mSanityTypeString[SANITY_TYPE_COUNT];
+    static std::string sSnapshotDirectory;
 
 public:
     static eControlType typeStringToEnum(const std::string& typestr);
@@ -218,6 +242,8 @@ public:
     void cleanup();
 
     LLControlVariablePtr getControl(std::string_view name);
+    // Hot paths can intern a name once and skip hashing it on each lookup
+    LLControlVariablePtr getControl(const LLSymbol& name);
 
     struct ApplyFunctor
     {
@@ -323,6 +349,14 @@ public:
     U32 loadFromFileLegacy(const std::string& filename, bool require_declaration = true, eControlType declare_as = TYPE_STRING);
     U32 saveToFile(const std::string& filename, bool nondefault_only);
     U32 loadFromFile(const std::string& filename, bool default_values = false, bool save_values = true);
+
+    // loadFromFile() can skip parsing XML by reading a binary snapshot of
+    // the parsed file, kept in this directory and only used while a hash
+    // of the XML still matches. saveToFile() refreshes the snapshot of the
+    // file it writes. An empty directory (the default) disables snapshots.
+    static void setSnapshotDirectory(const std::string& dir);
+    static const std::string& getSnapshotDirectory() { return sSnapshotDirectory; }
+
     void    resetToDefaults();
     void    incrCount(std::string_view name);
 
@@ -454,6 +488,103 @@ private:
     LLPointer<LLControlCache<T> > mCachedControlPtr;
 };
 
+//! LLControlHandle finds its control once, then reads the value the control
+//! publishes on every change: no name lookup, no signal connection, and no
+//! lock. A bool, S32, U32 or F32 handle on a control of that type reads one
+//! atomic word; other types convert a snapshot of the LLSD value.
+//!
+//! Construct it on the main thread (typically as a function-local static);
+//! get() is then safe to call from any thread. Writes still go through the
+//! LLControlGroup, on the main thread.
+template <typename T>
+class LLControlHandle
+{
+public:
+    // This constructor will declare a control if it doesn't exist in the contol group
+    LLControlHandle(LLControlGroup& group,
+                    const std::string& name,
+                    const T& default_value,
+                    const std::string& comment = "Declared In Code")
+    {
+        if (!group.controlExists(name))
+        {
+            // as LLControlCache declares it
+            eControlType type = get_control_type<T>();
+            if (type >= TYPE_COUNT)
+            {
+                LL_ERRS() << "The control could not be created!!!" << LL_ENDL;
+            }
+            group.declareControl(name, type, convert_to_llsd(default_value), comment, SANITY_TYPE_NONE, LLSD(), std::string(""), LLControlVariable::PERSIST_NO);
+        }
+        bindToControl(group, name);
+    }
+
+    LLControlHandle(LLControlGroup& group,
+                    const std::string& name)
+    {
+        bindToControl(group, name);
+    }
+
+    T get() const
+    {
+        if constexpr (is_scalar())
+        {
+            if (mScalar)
+            {
+                U32 bits = mControl->getScalarBits();
+                if constexpr (std::is_same_v<T, bool>)
+                {
+                    return bits != 0;
+                }
+                else
+                {
+                    T value;
+                    memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+            }
+        }
+        std::shared_ptr<const LLSD> snapshot(mControl->getSnapshot());
+        if constexpr (std::is_same_v<T, LLSD>)
+        {
+            // other threads may be reading the same snapshot
+            return LLControlVariable::unsharedCopy(*snapshot);
+        }
+        else
+        {
+            return convert_from_llsd<T>(*snapshot, mType, mControl->getName());
+        }
+    }
+
+    operator T() const { return get(); }
+    T operator()() const { return get(); }
+
+    LLControlVariable* getControl() const { return mControl.get(); }
+
+private:
+    static constexpr bool is_scalar()
+    {
+        return std::is_same_v<T, bool> || std::is_same_v<T, S32> ||
+               std::is_same_v<T, U32> || std::is_same_v<T, F32>;
+    }
+
+    void bindToControl(LLControlGroup& group, const std::string& name)
+    {
+        mControl = group.getControl(name);
+        if (!mControl)
+        {
+            LL_ERRS() << "Control named \"" << name << "\" not found." << LL_ENDL;
+        }
+        mType = mControl->type();
+        // the published bits are only meaningful as the control's own type
+        mScalar = is_scalar() && mType == get_control_type<T>();
+    }
+
+    LLControlVariablePtr mControl;
+    eControlType mType{ TYPE_COUNT };
+    bool mScalar{ false };
+};
+
 template <> eControlType get_control_type<U32>();
 template <> eControlType get_control_type<S32>();
 template <> eControlType get_control_type<F32>();
@@ -29,6 +29,9 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "llxmlnode.h"
 
@@ -39,6 +42,7 @@
 #include "v3dmath.h"
 #include "v4math.h"
 #include "llbase64.h"
+#include "hbxxh.h"
 #include "llquaternion.h"
 #include "llsd.h"
 #include "llstring.h"
@@ -125,7 +129,7 @@ LLXMLNode::LLXMLNode(const LLXMLNode& rhs) :
     mPrecision(rhs.mPrecision),
     mType(rhs.mType),
     mEncoding(rhs.mEncoding),
-    mLineNumber(0),
+    mLineNumber(rhs.mLineNumber),
     mParser(NULL),
     mParent(NULL),
     mChildren(NULL),
@@ -144,10 +148,10 @@ LLXMLNodePtr LLXMLNode::deepCopy()
     LLXMLNodePtr newnode = LLXMLNodePtr(new LLXMLNode(*this));
     if (mChildren.notNull())
     {
-        for (LLXMLChildList::iterator iter = mChildren->map.begin();
-             iter != mChildren->map.end(); ++iter)
+        // walk the sibling list rather than the name map: widget order matters
+        for (LLXMLNodePtr child = mChildren->head; child.notNull(); child = child->mNext)
         {
-            LLXMLNodePtr temp_ptr_for_gcc(iter->second->deepCopy());
+            LLXMLNodePtr temp_ptr_for_gcc(child->deepCopy());
             newnode->addChild(temp_ptr_for_gcc);
         }
     }
@@ -891,6 +895,653 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
     return true;
 }
 
+namespace
+{
+    // The string table of a bundle read by loadLayeredXMLNodeCache(),
+    // pointing into the bundle's buffer. Node names are interned in
+    // gStringTable once per distinct string, when first needed.
+    struct BundleStrings
+    {
+        std::vector<std::pair<const char*, U32> > mStrings;
+        std::vector<LLStringTableEntry*> mNames;
+    };
+
+    // A bundle read back from disk, kept whole while any of its trees is
+    // still undecoded. The compact form is several times smaller than the
+    // LLXMLNode trees it holds.
+    struct LoadedBundle
+    {
+        std::string mBuffer;
+        BundleStrings mStrings;
+    };
+
+    // Every read is bounds checked: a truncated or corrupt bundle makes the
+    // reader fail rather than read past the buffer.
+    class BundleReader
+    {
+    public:
+        BundleReader(const char* data, size_t size, BundleStrings& strings):
+            mData(data), mEnd(data + size), mStrings(strings)
+        {}
+
+        template <typename T>
+        bool get(T& value)
+        {
+            if ((size_t)(mEnd - mData) < sizeof(value))
+            {
+                return false;
+            }
+            memcpy(&value, mData, sizeof(value));
+            mData += sizeof(value);
+            return true;
+        }
+
+        bool getStrings(U32 count)
+        {
+            // every string takes at least its size: a bogus count can't
+            // make us reserve more than the buffer could hold
+            mStrings.mStrings.reserve(llmin((size_t)count, (size_t)(mEnd - mData) / sizeof(U32)));
+            for (U32 i = 0; i < count; ++i)
+            {
+                U32 size;
+                if (!get(size) || (size_t)(mEnd - mData) < size)
+                {
+                    return false;
+                }
+                mStrings.mStrings.emplace_back(mData, size);
+                mData += size;
+            }
+            mStrings.mNames.assign(mStrings.mStrings.size(), NULL);
+            return true;
+        }
+
+        bool getString(std::string& str)
+        {
+            U32 index;
+            if (!get(index) || index >= mStrings.mStrings.size())
+            {
+                return false;
+            }
+            str.assign(mStrings.mStrings[index].first, mStrings.mStrings[index].second);
+            return true;
+        }
+
+        LLStringTableEntry* getName()
+        {
+            U32 index;
+            if (!get(index) || index >= mStrings.mStrings.size())
+            {
+                return NULL;
+            }
+            if (!mStrings.mNames[index])
+            {
+                const auto& str = mStrings.mStrings[index];
+                mStrings.mNames[index] = gStringTable.addStringEntry(std::string(str.first, str.second));
+            }
+            return mStrings.mNames[index];
+        }
+
+        LLXMLNodePtr getNode(S32 depth = 0);
+
+        const char* position() const { return mData; }
+        bool atEnd() const { return mData == mEnd; }
+
+    private:
+        const char* mData;
+        const char* mEnd;
+        BundleStrings& mStrings;
+    };
+
+    // Parsed layered XML, keyed by the list of files it was layered from.
+    // Each entry remembers the size and modification time of its files so
+    // that editing a skin file on disk is picked up on the next lookup.
+    // Entries read from a bundle are only decoded when first looked up.
+    class LayeredXMLNodeCache
+    {
+    public:
+        typedef std::vector<std::pair<S64, S64> > stamps_t;
+
+        struct Entry
+        {
+            stamps_t mStamps;
+            LLXMLNodePtr mRoot;     // null until decoded from mBundle
+            std::shared_ptr<LoadedBundle> mBundle;
+            const char* mTree{ NULL };
+            size_t mTreeSize{ 0 };
+            U32 mUnusedSessions{ 0 };   // as read from the bundle
+            U32 mSavedUnusedSessions{ 0 };
+            bool mUsed{ false };    // looked up this session
+
+            // sessions in a row without a lookup, counting this one
+            U32 unusedSessions() const { return mUsed ? 0 : mUnusedSessions + 1; }
+        };
+        typedef std::map<std::string, Entry> entries_t;
+
+        static LayeredXMLNodeCache& instance()
+        {
+            // Deliberately never destroyed: the trees may be referenced by
+            // static UI objects torn down after any static cache.
+            static LayeredXMLNodeCache* sInstance = new LayeredXMLNodeCache;
+            return *sInstance;
+        }
+
+        // false if any of the files is missing
+        static bool getStamps(const std::vector<std::string>& paths, stamps_t& stamps)
+        {
+            stamps.clear();
+            for (const std::string& path : paths)
+            {
+                llstat status;
+                if (path.empty())
+                {
+                    // getLayeredXMLNode() skips empty layers
+                    stamps.emplace_back(0, 0);
+                    continue;
+                }
+                if (LLFile::stat(path, &status) != 0)
+                {
+                    return false;
+                }
+                stamps.emplace_back(S64(status.st_mtime), S64(status.st_size));
+            }
+            return true;
+        }
+
+        static std::string makeKey(const std::vector<std::string>& paths)
+        {
+            std::string key;
+            for (const std::string& path : paths)
+            {
+                key.append(path).push_back('\n');
+            }
+            return key;
+        }
+
+        static std::vector<std::string> splitKey(const std::string& key)
+        {
+            std::vector<std::string> paths;
+            size_t start = 0;
+            for (size_t end; (end = key.find('\n', start)) != std::string::npos; start = end + 1)
+            {
+                paths.push_back(key.substr(start, end - start));
+            }
+            return paths;
+        }
+
+        LLXMLNodePtr find(const std::string& key, const stamps_t& stamps)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto found = mEntries.find(key);
+            if (found == mEntries.end() || found->second.mStamps != stamps)
+            {
+                return LLXMLNodePtr();
+            }
+            Entry& entry = found->second;
+            if (entry.mRoot.isNull())
+            {
+                entry.mRoot = decode(entry);
+                if (entry.mRoot.isNull())
+                {
+                    LL_WARNS() << "Corrupt XUI bundle entry for " << key << LL_ENDL;
+                    mEntries.erase(found);
+                    return LLXMLNodePtr();
+                }
+                entry.mBundle.reset();
+            }
+            entry.mUsed = true;
+            return entry.mRoot;
+        }
+
+        // a tree parsed this session
+        void insert(const std::string& key, const stamps_t& stamps, const LLXMLNodePtr& root)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            Entry& entry = mEntries[key];
+            entry = Entry();
+            entry.mStamps = stamps;
+            entry.mRoot = root;
+            entry.mUsed = true;
+            mChanged = true;
+        }
+
+        // a tree read from a bundle, left encoded until looked up
+        void insertBundled(const std::string& key, const stamps_t& stamps, const std::shared_ptr<LoadedBundle>& bundle,
+                           const char* tree, size_t tree_size, U32 unused_sessions)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            Entry& entry = mEntries[key];
+            entry = Entry();
+            entry.mStamps = stamps;
+            entry.mBundle = bundle;
+            entry.mTree = tree;
+            entry.mTreeSize = tree_size;
+            entry.mUnusedSessions = unused_sessions;
+            entry.mSavedUnusedSessions = unused_sessions;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mEntries.clear();
+            mChanged = true;
+        }
+
+        // true if a bundle saved now would differ from the last one: a
+        // tree was parsed, or an entry's count of unused sessions moved
+        bool needsSaving()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            bool needed = mChanged;
+            for (auto it = mEntries.begin(); !needed && it != mEntries.end(); ++it)
+            {
+                needed = it->second.unusedSessions() != it->second.mSavedUnusedSessions;
+            }
+            return needed;
+        }
+
+        // A copy with every tree decoded, for writing a bundle. Trees
+        // decoded only for this are not kept.
+        entries_t getEntriesToSave()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            entries_t entries;
+            for (const auto& entry : mEntries)
+            {
+                Entry copy(entry.second);
+                if (copy.mRoot.isNull())
+                {
+                    copy.mRoot = decode(copy);
+                    if (copy.mRoot.isNull())
+                    {
+                        continue;
+                    }
+                }
+                copy.mBundle.reset();
+                entries.emplace(entry.first, copy);
+            }
+            return entries;
+        }
+
+        void setSaved()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mChanged = false;
+            for (auto& entry : mEntries)
+            {
+                entry.second.mSavedUnusedSessions = entry.second.unusedSessions();
+            }
+        }
+
+    private:
+        // With mMutex locked, as decoding interns names in the bundle's
+        // string table
+        static LLXMLNodePtr decode(const Entry& entry)
+        {
+            if (!entry.mBundle)
+            {
+                return LLXMLNodePtr();
+            }
+            BundleReader reader(entry.mTree, entry.mTreeSize, entry.mBundle->mStrings);
+            LLXMLNodePtr root = reader.getNode();
+            return reader.atEnd() ? root : LLXMLNodePtr();
+        }
+
+        std::mutex mMutex;
+        entries_t mEntries;
+        bool mChanged{ false };
+    };
+
+    // A bundle is this header followed by the payload: a table of every
+    // distinct string in the bundle, an index of the cache entries, each a
+    // key, the stamps of its files, its count of unused sessions and where
+    // its tree is, then the trees. Nodes refer to their names and values by
+    // index into the string table, so the many repeats of "name", "layout"
+    // or "topleft" are stored, and interned, once. Bundles are private to
+    // one machine, so everything is in native byte order.
+    const char BUNDLE_MAGIC[8] = { 'L', 'L', 'X', 'U', 'I', 'B', 'N', '2' };
+
+    struct BundleHeader
+    {
+        char mMagic[sizeof(BUNDLE_MAGIC)];
+        U64  mPayloadHash;  // HBXXH64 of the payload
+        U64  mPayloadSize;  // bytes after the header
+        U32  mStrings;
+        U32  mEntries;
+    };
+
+    // nesting deeper than any real XUI file, to stop a corrupt bundle
+    // from recursing without end
+    const S32 BUNDLE_MAX_DEPTH = 256;
+
+    LLXMLNodePtr BundleReader::getNode(S32 depth)
+    {
+        LLStringTableEntry* name = getName();
+        std::string value, id;
+        S32 line_number;
+        U8 is_attribute, type, encoding;
+        U32 precision, length, version_major, version_minor, attributes;
+        if (depth > BUNDLE_MAX_DEPTH || !name
+            || !getString(value) || !getString(id) || !get(line_number)
+            || !get(is_attribute) || !get(type) || !get(encoding)
+            || !get(precision) || !get(length) || !get(version_major) || !get(version_minor)
+            || type > LLXMLNode::TYPE_NODEREF || encoding > LLXMLNode::ENCODING_HEX
+            || !get(attributes))
+        {
+            return LLXMLNodePtr();
+        }
+
+        LLXMLNodePtr node(new LLXMLNode(name, is_attribute != 0));
+        node->setValue(value);
+        node->mID = id;
+        node->mLineNumber = line_number;
+        node->mType = (LLXMLNode::ValueType)type;
+        node->mEncoding = (LLXMLNode::Encoding)encoding;
+        node->mPrecision = precision;
+        node->mLength = length;
+        node->mVersionMajor = version_major;
+        node->mVersionMinor = version_minor;
+        for (U32 i = 0; i < attributes; ++i)
+        {
+            LLXMLNodePtr attribute = getNode(depth + 1);
+            if (attribute.isNull())
+            {
+                return LLXMLNodePtr();
+            }
+            node->addChild(attribute);
+        }
+        U32 children;
+        if (!get(children))
+        {
+            return LLXMLNodePtr();
+        }
+        for (U32 i = 0; i < children; ++i)
+        {
+            LLXMLNodePtr child = getNode(depth + 1);
+            if (child.isNull())
+            {
+                return LLXMLNodePtr();
+            }
+            node->addChild(child);
+        }
+        return node;
+    }
+
+    class BundleWriter
+    {
+    public:
+        template <typename T>
+        static void put(std::string& buffer, T value)
+        {
+            buffer.append((const char*)&value, sizeof(value));
+        }
+
+        // index of str in the string table, adding it if need be
+        U32 intern(const std::string& str)
+        {
+            auto inserted = mIndex.emplace(str, (U32)mStrings.size());
+            if (inserted.second)
+            {
+                mStrings.push_back(&inserted.first->first);
+            }
+            return inserted.first->second;
+        }
+
+        void putEntry(const std::string& key, const LayeredXMLNodeCache::stamps_t& stamps, U32 unused_sessions,
+                      const LLXMLNode* root)
+        {
+            put<U32>(mEntries, intern(key));
+            put<U32>(mEntries, (U32)stamps.size());
+            for (const auto& stamp : stamps)
+            {
+                put<S64>(mEntries, stamp.first);
+                put<S64>(mEntries, stamp.second);
+            }
+            put<U32>(mEntries, unused_sessions);
+            const U64 offset = mTrees.size();
+            putNode(root);
+            put<U64>(mEntries, offset);
+            put<U64>(mEntries, mTrees.size() - offset);
+        }
+
+        // the string table goes ahead of the entries that refer to it
+        std::string finish() const
+        {
+            std::string payload;
+            for (const std::string* str : mStrings)
+            {
+                put<U32>(payload, (U32)str->size());
+                payload.append(*str);
+            }
+            return payload + mEntries + mTrees;
+        }
+
+        U32 strings() const { return (U32)mStrings.size(); }
+
+    private:
+        void putNode(const LLXMLNode* node)
+        {
+            put<U32>(mTrees, intern(node->getName() ? node->getName()->mString : ""));
+            put<U32>(mTrees, intern(node->getValue()));
+            put<U32>(mTrees, intern(node->mID));
+            put<S32>(mTrees, node->mLineNumber);
+            put<U8>(mTrees, node->mIsAttribute);
+            put<U8>(mTrees, (U8)node->mType);
+            put<U8>(mTrees, (U8)node->mEncoding);
+            put<U32>(mTrees, node->mPrecision);
+            put<U32>(mTrees, node->mLength);
+            put<U32>(mTrees, node->mVersionMajor);
+            put<U32>(mTrees, node->mVersionMinor);
+            put<U32>(mTrees, (U32)node->mAttributes.size());
+            for (const auto& attribute : node->mAttributes)
+            {
+                putNode(attribute.second);
+            }
+            U32 children = 0;
+            for (const LLXMLNode* child = node->mChildren.notNull() ? node->mChildren->head.get() : NULL;
+                 child; child = child->mNext)
+            {
+                ++children;
+            }
+            put<U32>(mTrees, children);
+            for (const LLXMLNode* child = node->mChildren.notNull() ? node->mChildren->head.get() : NULL;
+                 child; child = child->mNext)
+            {
+                putNode(child);
+            }
+        }
+
+        std::string mEntries;
+        std::string mTrees;
+        std::unordered_map<std::string, U32> mIndex;
+        std::vector<const std::string*> mStrings;
+    };
+} // anonymous namespace
+
+// static
+bool LLXMLNode::getCachedLayeredXMLNode(LLXMLNodePtr& root,
+                                        const std::vector<std::string>& paths)
+{
+    LayeredXMLNodeCache::stamps_t stamps;
+    if (!LayeredXMLNodeCache::getStamps(paths, stamps))
+    {
+        // let getLayeredXMLNode() report whatever is wrong with the files
+        return getLayeredXMLNode(root, paths);
+    }
+
+    const std::string key(LayeredXMLNodeCache::makeKey(paths));
+    LayeredXMLNodeCache& cache = LayeredXMLNodeCache::instance();
+    root = cache.find(key, stamps);
+    if (root.notNull())
+    {
+        return true;
+    }
+    if (!getLayeredXMLNode(root, paths))
+    {
+        return false;
+    }
+    cache.insert(key, stamps, root);
+    return true;
+}
+
+// static
+void LLXMLNode::clearLayeredXMLNodeCache()
+{
+    LayeredXMLNodeCache::instance().clear();
+}
+
+// static
+S32 LLXMLNode::loadLayeredXMLNodeCache(const std::string& filename)
+{
+    // one read for the whole file and one pass over its index, with no XML
+    // parsing: entries are checked against their files, and their trees
+    // decoded, when looked up
+    std::shared_ptr<LoadedBundle> bundle = std::make_shared<LoadedBundle>();
+    bundle->mBuffer = LLFile::getContents(filename);
+    const std::string& buffer = bundle->mBuffer;
+    BundleHeader header;
+    if (buffer.size() < sizeof(header))
+    {
+        return 0;
+    }
+    memcpy(&header, buffer.data(), sizeof(header));
+    const char* payload = buffer.data() + sizeof(header);
+    if (memcmp(header.mMagic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0
+        || header.mPayloadSize != buffer.size() - sizeof(header)
+        || header.mPayloadHash != HBXXH64::digest(payload, header.mPayloadSize))
+    {
+        LL_WARNS() << "Ignoring stale or corrupt XUI bundle " << filename << LL_ENDL;
+        return 0;
+    }
+
+    BundleReader reader(payload, header.mPayloadSize, bundle->mStrings);
+    if (!reader.getStrings(header.mStrings))
+    {
+        LL_WARNS() << "Corrupt XUI bundle " << filename << LL_ENDL;
+        return 0;
+    }
+    // read the whole index before adding any of it to the cache
+    struct Indexed
+    {
+        std::string mKey;
+        LayeredXMLNodeCache::stamps_t mStamps;
+        U32 mUnusedSessions;
+        U64 mTreeOffset;
+        U64 mTreeSize;
+    };
+    // every entry takes well over one byte: a bogus count can't make us
+    // reserve more than the buffer could hold
+    std::vector<Indexed> entries;
+    entries.reserve(llmin((size_t)header.mEntries, (size_t)header.mPayloadSize));
+    for (U32 i = 0; i < header.mEntries; ++i)
+    {
+        Indexed entry;
+        U32 stamp_count;
+        if (!reader.getString(entry.mKey) || !reader.get(stamp_count))
+        {
+            LL_WARNS() << "Corrupt XUI bundle " << filename << LL_ENDL;
+            return 0;
+        }
+        for (U32 s = 0; s < stamp_count; ++s)
+        {
+            std::pair<S64, S64> stamp;
+            if (!reader.get(stamp.first) || !reader.get(stamp.second))
+            {
+                LL_WARNS() << "Corrupt XUI bundle " << filename << LL_ENDL;
+                return 0;
+            }
+            entry.mStamps.push_back(stamp);
+        }
+        if (!reader.get(entry.mUnusedSessions) || !reader.get(entry.mTreeOffset) || !reader.get(entry.mTreeSize))
+        {
+            LL_WARNS() << "Corrupt XUI bundle " << filename << LL_ENDL;
+            return 0;
+        }
+        entries.push_back(entry);
+    }
+    // the trees follow the index
+    const char* trees = reader.position();
+    const U64 trees_size = (U64)(payload + header.mPayloadSize - trees);
+    for (const Indexed& entry : entries)
+    {
+        if (entry.mTreeOffset > trees_size || entry.mTreeSize > trees_size - entry.mTreeOffset)
+        {
+            LL_WARNS() << "Corrupt XUI bundle " << filename << LL_ENDL;
+            return 0;
+        }
+    }
+
+    LayeredXMLNodeCache& cache = LayeredXMLNodeCache::instance();
+    for (const Indexed& entry : entries)
+    {
+        cache.insertBundled(entry.mKey, entry.mStamps, bundle, trees + entry.mTreeOffset, (size_t)entry.mTreeSize,
+                            entry.mUnusedSessions);
+    }
+    return (S32)entries.size();
+}
+
+// static
+S32 LLXMLNode::saveLayeredXMLNodeCache(const std::string& filename, U32 max_unused_sessions)
+{
+    LayeredXMLNodeCache& cache = LayeredXMLNodeCache::instance();
+    if (!cache.needsSaving() && LLFile::isfile(filename))
+    {
+        // nothing was parsed since the bundle was read, and everything in
+        // it was used again
+        return 0;
+    }
+
+    BundleWriter writer;
+    U32 saved = 0;
+    for (const auto& entry : cache.getEntriesToSave())
+    {
+        // leave out what was not used for a while, or whose files changed
+        // or went away, rather than carry it from bundle to bundle
+        const U32 unused_sessions = entry.second.unusedSessions();
+        if (unused_sessions >= max_unused_sessions)
+        {
+            continue;
+        }
+        LayeredXMLNodeCache::stamps_t stamps;
+        if (!LayeredXMLNodeCache::getStamps(LayeredXMLNodeCache::splitKey(entry.first), stamps)
+            || stamps != entry.second.mStamps)
+        {
+            continue;
+        }
+        writer.putEntry(entry.first, stamps, unused_sessions, entry.second.mRoot);
+        ++saved;
+    }
+    const std::string payload(writer.finish());
+
+    BundleHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.mMagic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.mPayloadHash = HBXXH64::digest(payload.data(), payload.size());
+    header.mPayloadSize = payload.size();
+    header.mStrings = writer.strings();
+    header.mEntries = saved;
+
+    // write aside and rename, so a reader never sees half a bundle
+    const std::string temp_filename(filename + ".tmp");
+    LLFILE* file = LLFile::fopen(temp_filename, "wb");
+    if (!file)
+    {
+        LL_WARNS() << "Unable to write XUI bundle " << temp_filename << LL_ENDL;
+        return -1;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                   && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    LLFile::close(file);
+    LLFile::remove(filename, ENOENT);
+    if (!written || LLFile::rename(temp_filename, filename) != 0)
+    {
+        LL_WARNS() << "Unable to write XUI bundle " << filename << LL_ENDL;
+        LLFile::remove(temp_filename, ENOENT);
+        return -1;
+    }
+    cache.setSaved();
+    return (S32)saved;
+}
+
 // static
 void LLXMLNode::writeHeaderToFile(LLFILE *out_file)
 {
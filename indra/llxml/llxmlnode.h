@@ -122,6 +122,7 @@ public:
     LLXMLNode(const char* name, bool is_attribute);
     LLXMLNode(LLStringTableEntry* name, bool is_attribute);
     LLXMLNode(const LLXMLNode& rhs);
+    // children are copied in document order
     LLXMLNodePtr deepCopy();
 
     bool isNull();
@@ -150,6 +151,26 @@ public:
 
     static bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
 
+    // Like getLayeredXMLNode(), but parses each set of paths only once and
+    // hands every later caller the same tree, for as long as none of the
+    // files changes on disk. The tree is shared: treat it as read-only, and
+    // deepCopy() it before modifying it.
+    static bool getCachedLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
+    static void clearLayeredXMLNodeCache();
+
+    // Save the cached trees in one binary bundle file, or read one back
+    // into the cache, so that a later run can skip opening and parsing the
+    // XML files it needs. A loaded tree is only decoded when it is first
+    // looked up. Entries whose files have changed since are left out, or
+    // ignored when looked up, as are entries not looked up in the last
+    // max_unused_sessions runs. Both return the number of entries (0 for an
+    // unreadable bundle, or when nothing needed saving), or -1 if the
+    // bundle couldn't be written.
+    static const U32 DEFAULT_BUNDLE_UNUSED_SESSIONS = 5;
+    static S32 saveLayeredXMLNodeCache(const std::string& filename,
+                                       U32 max_unused_sessions = DEFAULT_BUNDLE_UNUSED_SESSIONS);
+    static S32 loadLayeredXMLNodeCache(const std::string& filename);
+
 
     // Write standard XML file header:
     // <?xml version="1.0" encoding="utf-8" standalone="yes" ?>
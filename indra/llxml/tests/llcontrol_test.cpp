@@ -27,13 +27,18 @@
 
 #include "linden_common.h"
 #include "llsdserialize.h"
+#include "llsdutil.h"
 #include "llfile.h"
 #include "stringize.h"
 
 #include "../llcontrol.h"
+#include "lldiriterator.h"
 
 #include "../test/lltut.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <vector>
 
 namespace tut
@@ -80,6 +85,21 @@ namespace tut
             }
             file.close();
         }
+        static std::vector<std::string> listSnapshots(const std::string& dir)
+        {
+            std::vector<std::string> found;
+            LLDirIterator iter(dir, "*.snapshot");
+            std::string name;
+            while (iter.next(name))
+            {
+                found.push_back(dir + "/" + name);
+            }
+            return found;
+        }
+        static size_t countSnapshots(const std::string& dir)
+        {
+            return listSnapshots(dir).size();
+        }
         static bool handleListenerTest()
         {
             control_group::mListenerFired = true;
@@ -151,4 +171,229 @@ namespace tut
         ensure("listener fired on changed setting", mListenerFired);
     }
 
+    //lookup by interned name
+    template<> template<>
+    void control_group_t::test<5>()
+    {
+        mCG->loadFromFile(mTestConfigFile.c_str());
+        const LLSymbol name("TestSetting");
+        LLControlVariable* control = mCG->getControl(name);
+        ensure("control not found by symbol", control != NULL);
+        ensure("symbol and string lookups differ", control == mCG->getControl("TestSetting").get());
+        ensure("found unknown control by symbol", mCG->getControl(LLSymbol("NoSuchTestSetting")).isNull());
+        ensure("found never-interned control", mCG->getControl("NeverInternedTestSetting").isNull());
+        mCG->cleanup();
+        ensure("found control after cleanup", mCG->getControl(name).isNull());
+    }
+
+    // LLControlHandle
+    template<> template<>
+    void control_group_t::test<6>()
+    {
+        mCG->loadFromFile(mTestConfigFile.c_str());
+        LLControlHandle<U32> setting(*mCG, "TestSetting");
+        ensure_equals("handle value", setting.get(), 12);
+        mCG->setU32("TestSetting", 13);
+        ensure_equals("handle value after set", U32(setting), 13);
+        mCG->getControl("TestSetting")->resetToDefault();
+        ensure_equals("handle value after reset", setting(), 12);
+        mCG->getControl("TestSetting")->setValue(LLSD(14), false);
+        ensure_equals("handle value after unsaved set", setting(), 14);
+
+        // declared on demand, like LLCachedControl
+        LLControlHandle<F32> declared(*mCG, "TestHandleF32", 0.5f);
+        ensure_equals("declared value", declared(), 0.5f);
+        mCG->setF32("TestHandleF32", -2.25f);
+        ensure_equals("declared value after set", declared(), -2.25f);
+        LLControlHandle<bool> flag(*mCG, "TestHandleBool", true);
+        ensure("declared bool", flag());
+        mCG->setBOOL("TestHandleBool", false);
+        ensure("bool after set", !flag());
+        LLControlHandle<S32> negative(*mCG, "TestHandleS32", -7);
+        ensure_equals("declared S32", negative(), -7);
+
+        // non-scalar types read the published snapshot
+        LLControlHandle<std::string> text(*mCG, "TestHandleString", std::string("before"));
+        mCG->setString("TestHandleString", "after");
+        ensure_equals("string after set", text(), "after");
+        LLControlHandle<LLSD> sd(*mCG, "TestHandleLLSD", LLSD());
+        mCG->setLLSD("TestHandleLLSD", llsd::array(1, "two", 3.0));
+        ensure_equals("LLSD after set", sd()[1].asString(), "two");
+
+        // readers on another thread only ever see values that were set:
+        // never the default a saved value passes through on its way in
+        mCG->setU32("TestSetting", 100);
+        std::atomic<bool> done{ false }, bad{ false };
+        std::thread reader([&]()
+            {
+                while (!done)
+                {
+                    U32 value = setting();
+                    std::string str = text();
+                    if (value < 100 || (str != "after" && str.compare(0, 5, "value")))
+                    {
+                        bad = true;
+                    }
+                }
+            });
+        for (U32 i = 101; i < 2000; ++i)
+        {
+            mCG->setU32("TestSetting", i);
+            mCG->setString("TestHandleString", stringize("value", i));
+        }
+        done = true;
+        reader.join();
+        ensure("reader saw an intermediate value", !bad);
+        ensure_equals("final value", setting(), 1999);
+    }
+
+    // binary settings snapshots
+    template<> template<>
+    void control_group_t::test<7>()
+    {
+        const std::string snapshot_dir(mTestConfigDir + "snapshots");
+        LLControlGroup::setSnapshotDirectory(snapshot_dir);
+        ensure("snapshot directory not created", LLFile::isdir(snapshot_dir));
+
+        // the first load parses the XML and writes a snapshot...
+        ensure_equals("loaded from XML", mCG->loadFromFile(mTestConfigFile.c_str(), true), 1);
+        ensure_equals("value from XML", mCG->getU32("TestSetting"), 12);
+        ensure_equals("snapshot written", countSnapshots(snapshot_dir), 1);
+
+        // ...which the next load reads instead, with the same result
+        LLControlGroup from_snapshot("foo_snapshot");
+        ensure_equals("loaded from snapshot", from_snapshot.loadFromFile(mTestConfigFile.c_str(), true), 1);
+        ensure_equals("value from snapshot", from_snapshot.getU32("TestSetting"), 12);
+        ensure_equals("comment from snapshot", from_snapshot.getControl("TestSetting")->getComment(),
+                      "Dummy setting used for testing");
+
+        // an edited XML file makes the snapshot stale
+        LLSD config;
+        config["TestSetting"]["Comment"] = "Dummy setting used for testing";
+        config["TestSetting"]["Persist"] = 1;
+        config["TestSetting"]["Type"] = "U32";
+        config["TestSetting"]["Value"] = 21;
+        writeSettingsFile(config);
+        LLControlGroup after_edit("foo_edited");
+        after_edit.loadFromFile(mTestConfigFile.c_str(), true);
+        ensure_equals("stale snapshot used", after_edit.getU32("TestSetting"), 21);
+
+        // so does a damaged value that still parses
+        for (const auto& snapshot : listSnapshots(snapshot_dir))
+        {
+            std::string contents(LLFile::getContents(snapshot));
+            const S32 saved = 21, damaged = 99;
+            const std::string from = std::string(1, 'i') + std::string((const char*)&saved, sizeof(saved));
+            const std::string to = std::string(1, 'i') + std::string((const char*)&damaged, sizeof(damaged));
+            const size_t found = contents.find(from);
+            ensure("value in snapshot", found != std::string::npos);
+            contents.replace(found, from.size(), to);
+            llofstream file(snapshot.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file << contents;
+        }
+        LLControlGroup after_damage("foo_damaged");
+        after_damage.loadFromFile(mTestConfigFile.c_str(), true);
+        ensure_equals("value after damaged snapshot", after_damage.getU32("TestSetting"), 21);
+
+        // saveToFile() leaves a snapshot matching what it wrote
+        const std::string saved_file(mTestConfigDir + "saved_settings.xml");
+        mCleanups.push_back(saved_file);
+        after_edit.setU32("TestSetting", 33);
+        after_edit.saveToFile(saved_file, true);
+        ensure_equals("snapshot per file", countSnapshots(snapshot_dir), 2);
+        LLControlGroup reloaded("foo_reloaded");
+        reloaded.loadFromFile(mTestConfigFile.c_str(), true);
+        reloaded.loadFromFile(saved_file);
+        ensure_equals("saved value from snapshot", reloaded.getU32("TestSetting"), 33);
+
+        // a corrupt snapshot falls back to the XML
+        for (const auto& snapshot : listSnapshots(snapshot_dir))
+        {
+            llofstream file(snapshot.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file << "LLCTRLS1 truncated";
+        }
+        LLControlGroup after_corruption("foo_corrupt");
+        after_corruption.loadFromFile(mTestConfigFile.c_str(), true);
+        ensure_equals("value after corrupt snapshot", after_corruption.getU32("TestSetting"), 21);
+
+        LLControlGroup::setSnapshotDirectory("");
+        for (const auto& snapshot : listSnapshots(snapshot_dir))
+        {
+            LLFile::remove(snapshot);
+        }
+        LLFile::rmdir(snapshot_dir);
+    }
+
+    template<> template<>
+    void control_group_t::test<8>()
+    {
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        LLSD config;
+        for (S32 i = 0; i < 3000; ++i)
+        {
+            std::string name(stringize("RenderBenchSetting", i));
+            config[name]["Comment"] = stringize("Setting number ", i, " of a settings.xml sized file");
+            config[name]["Persist"] = 1;
+            switch (i % 4)
+            {
+            case 0:
+                config[name]["Type"] = "Boolean";
+                config[name]["Value"] = (i % 8) != 0;
+                break;
+            case 1:
+                config[name]["Type"] = "F32";
+                config[name]["Value"] = i * 0.25;
+                break;
+            case 2:
+                config[name]["Type"] = "String";
+                config[name]["Value"] = stringize("value ", i);
+                break;
+            default:
+                config[name]["Type"] = "Color4";
+                config[name]["Value"] = llsd::array(0.25, 0.5, 0.75, 1.0);
+                break;
+            }
+        }
+        writeSettingsFile(config);
+
+        const std::string snapshot_dir(mTestConfigDir + "snapshots");
+        auto time_load = [this](const std::string& name)
+        {
+            LLControlGroup group(name);
+            auto start = std::chrono::steady_clock::now();
+            group.loadFromFile(mTestConfigFile.c_str(), true);
+            return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        const F64 xml_ms = time_load("bench_xml");
+        LLControlGroup::setSnapshotDirectory(snapshot_dir);
+        const F64 first_ms = time_load("bench_first");
+        const F64 snapshot_ms = time_load("bench_snapshot");
+        LL_INFOS() << "loading 3000 settings: XML " << xml_ms << " ms, XML + writing snapshot "
+                   << first_ms << " ms, snapshot " << snapshot_ms << " ms" << LL_ENDL;
+
+        LLControlGroup::setSnapshotDirectory("");
+        for (const auto& snapshot : listSnapshots(snapshot_dir))
+        {
+            LLFile::remove(snapshot);
+        }
+        LLFile::rmdir(snapshot_dir);
+    }
+
+    // redeclaring a loaded control
+    template<> template<>
+    void control_group_t::test<9>()
+    {
+        mCG->loadFromFile(mTestConfigFile.c_str());
+        LLControlHandle<U32> setting(*mCG, "TestSetting");
+        mListenerFired = false;
+        mCG->getControl("TestSetting")->getSignal()->connect(boost::bind(&this->handleListenerTest));
+        mCG->declareU32("TestSetting", 7, "Dummy setting used for testing");
+        ensure_equals("loaded value kept", mCG->getU32("TestSetting"), 12);
+        ensure_equals("handle value kept", setting(), 12);
+        ensure_equals("declared default", mCG->getControl("TestSetting")->getDefault().asInteger(), 7);
+        ensure("listener fired on redeclaration", !mListenerFired);
+        mCG->getControl("TestSetting")->resetToDefault();
+        ensure_equals("handle value after reset", setting(), 7);
+    }
 }
@@ -0,0 +1,424 @@
+/**
+ * @file   llxmlnode_test.cpp
+ * @date   2026-10-19
+ * @brief  Test for llxmlnode.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llxmlnode.h"
+// STL headers
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+// std headers
+#include <chrono>
+#include <fstream>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "llfile.h"
+#include "stringize.h"
+
+namespace
+{
+    // milliseconds taken by 'work'
+    template <typename WORK>
+    F64 timeMs(WORK&& work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<std::string> childNames(LLXMLNodePtr node)
+    {
+        std::vector<std::string> names;
+        for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+        {
+            std::string name;
+            child->getAttributeString("name", name);
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    // why the trees differ, or the empty string if they don't
+    std::string compareTrees(LLXMLNodePtr a, LLXMLNodePtr b)
+    {
+        const std::string where(a->getName()->mString);
+        if (a->getName() != b->getName() || a->getValue() != b->getValue()
+            || a->mID != b->mID || a->mLineNumber != b->mLineNumber
+            || a->mIsAttribute != b->mIsAttribute || a->mType != b->mType)
+        {
+            return stringize("node ", where, " differs from ", b->getName()->mString);
+        }
+        if (a->mAttributes.size() != b->mAttributes.size())
+        {
+            return stringize("attributes of ", where);
+        }
+        for (auto ait = a->mAttributes.begin(), bit = b->mAttributes.begin();
+             ait != a->mAttributes.end(); ++ait, ++bit)
+        {
+            std::string diff(compareTrees(ait->second, bit->second));
+            if (!diff.empty())
+            {
+                return diff;
+            }
+        }
+        LLXMLNodePtr achild = a->getFirstChild(), bchild = b->getFirstChild();
+        for ( ; achild.notNull() && bchild.notNull();
+              achild = achild->getNextSibling(), bchild = bchild->getNextSibling())
+        {
+            std::string diff(compareTrees(achild, bchild));
+            if (!diff.empty())
+            {
+                return diff;
+            }
+        }
+        return (achild.notNull() || bchild.notNull()) ? stringize("children of ", where) : "";
+    }
+
+    // a floater shaped like floater_preferences.xml: a tab container of
+    // panels full of labelled controls
+    std::string makeFloater(S32 panels, S32 controls)
+    {
+        std::ostringstream out;
+        out << "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n"
+            << "<floater name=\"bench\" title=\"Bench\" height=\"600\" width=\"800\">\n"
+            << " <tab_container name=\"tabs\" tab_position=\"left\" height=\"560\" width=\"780\">\n";
+        for (S32 p = 0; p < panels; ++p)
+        {
+            out << "  <panel name=\"panel_" << p << "\" label=\"Panel " << p
+                << "\" layout=\"topleft\" follows=\"all\" height=\"560\" width=\"640\">\n";
+            for (S32 c = 0; c < controls; ++c)
+            {
+                out << "   <check_box control_name=\"BenchSetting" << p << "_" << c
+                    << "\" label=\"Setting " << c << " of panel " << p
+                    << "\" layout=\"topleft\" follows=\"left|top\" left=\"10\" top_pad=\"4\" height=\"16\""
+                    << " width=\"300\" name=\"check_" << p << "_" << c << "\" tool_tip=\"Tool tip for setting "
+                    << c << "\">\n"
+                    << "    <check_box.commit_callback function=\"Bench.Commit\" parameter=\"" << c << "\"/>\n"
+                    << "   </check_box>\n";
+            }
+            out << "  </panel>\n";
+        }
+        out << " </tab_container>\n"
+            << "</floater>\n";
+        return out.str();
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llxmlnode_data
+    {
+        std::string mDir;
+        std::vector<std::string> mFiles;
+
+        llxmlnode_data()
+        {
+            LLUUID random;
+            random.generate();
+            mDir = STRINGIZE(LLFile::tmpdir() << "llxmlnode-test-" << random << "/");
+            LLFile::mkdir(mDir);
+        }
+
+        ~llxmlnode_data()
+        {
+            LLXMLNode::clearLayeredXMLNodeCache();
+            for (const auto& file : mFiles)
+            {
+                LLFile::remove(file);
+            }
+            LLFile::rmdir(mDir);
+        }
+
+        std::string writeFile(const std::string& name, const std::string& contents)
+        {
+            std::string path(mDir + name);
+            {
+                std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+                out << contents;
+            }
+            if (std::find(mFiles.begin(), mFiles.end(), path) == mFiles.end())
+            {
+                mFiles.push_back(path);
+            }
+            return path;
+        }
+    };
+    typedef test_group<llxmlnode_data> llxmlnode_group;
+    typedef llxmlnode_group::object object;
+    llxmlnode_group llxmlnodegrp("llxmlnode");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("deepCopy keeps document order");
+        // names sorting differently from their document order
+        const std::string xml(
+            "<panel name=\"root\">\n"
+            " <button name=\"zebra\" label=\"Z\"/>\n"
+            " <text name=\"apple\">some text</text>\n"
+            " <button name=\"mango\" label=\"M\"/>\n"
+            " <check_box name=\"kiwi\"/>\n"
+            "</panel>\n");
+        LLXMLNodePtr root;
+        ensure("parse", LLXMLNode::parseBuffer(xml.data(), xml.size(), root, NULL));
+
+        LLXMLNodePtr copy = root->deepCopy();
+        ensure("copy is the original", copy.get() != root.get());
+        ensure("children reordered", childNames(copy) == childNames(root));
+        ensure_equals("first child", childNames(copy).front(), "zebra");
+
+        LLXMLNodePtr text;
+        ensure("text child", copy->getChild("text", text));
+        ensure_equals("text value", text->getSanitizedValue(), "some text");
+        ensure_equals("line number", text->getLineNumber(), 3);
+
+        // the copy is independent of the original
+        copy->setAttributeString("name", "changed");
+        std::string name;
+        root->getAttributeString("name", name);
+        ensure_equals("original changed through copy", name, "root");
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("cached layered XML");
+        const std::string base(writeFile("base.xml",
+            "<floater name=\"f\" title=\"English\"><button name=\"b\" label=\"OK\"/></floater>\n"));
+        const std::string local(writeFile("local.xml",
+            "<floater name=\"f\" title=\"Deutsch\"/>\n"));
+        const std::vector<std::string> paths{ base, local };
+
+        LLXMLNodePtr first, second;
+        ensure("first lookup", LLXMLNode::getCachedLayeredXMLNode(first, paths));
+        std::string title;
+        first->getAttributeString("title", title);
+        ensure_equals("layered title", title, "Deutsch");
+        ensure("second lookup", LLXMLNode::getCachedLayeredXMLNode(second, paths));
+        ensure("parsed twice", first.get() == second.get());
+
+        // the base layer alone is a different template
+        LLXMLNodePtr english;
+        ensure("base only", LLXMLNode::getCachedLayeredXMLNode(english, { base }));
+        ensure("layers ignored", english.get() != first.get());
+        english->getAttributeString("title", title);
+        ensure_equals("base title", title, "English");
+
+        // a changed file is parsed again (different size, so a coarse
+        // timestamp doesn't hide the change)
+        writeFile("local.xml", "<floater name=\"f\" title=\"Francais, merci\"/>\n");
+        LLXMLNodePtr third;
+        ensure("lookup after change", LLXMLNode::getCachedLayeredXMLNode(third, paths));
+        ensure("stale template", third.get() != first.get());
+        third->getAttributeString("title", title);
+        ensure_equals("new title", title, "Francais, merci");
+
+        LLXMLNode::clearLayeredXMLNodeCache();
+        LLXMLNodePtr fourth;
+        ensure("lookup after clear", LLXMLNode::getCachedLayeredXMLNode(fourth, paths));
+        ensure("cache not cleared", fourth.get() != third.get());
+
+        // failures aren't cached
+        LLXMLNodePtr missing;
+        const std::vector<std::string> later{ mDir + "later.xml" };
+        ensure("missing file", ! LLXMLNode::getCachedLayeredXMLNode(missing, later));
+        writeFile("later.xml", "<floater name=\"later\"/>");
+        ensure("file created later", LLXMLNode::getCachedLayeredXMLNode(missing, later));
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("floater XML load: parse vs template cache");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        // This is the part of opening a floater that happens before any
+        // view is built: reading its layered XUI.
+        const std::vector<std::string> paths{ writeFile("floater_bench.xml", makeFloater(16, 40)),
+                                              writeFile("floater_bench_de.xml",
+                                                        "<floater name=\"bench\" title=\"Bank\"/>\n") };
+        const S32 opens = 20;
+        LLXMLNodePtr root;
+        const F64 parseMs = timeMs([&]()
+            {
+                for (S32 i = 0; i < opens; ++i)
+                {
+                    LLXMLNode::getLayeredXMLNode(root, paths);
+                }
+            });
+        const F64 firstMs = timeMs([&]()
+            {
+                LLXMLNode::getCachedLayeredXMLNode(root, paths);
+            });
+        const F64 cachedMs = timeMs([&]()
+            {
+                for (S32 i = 0; i < opens; ++i)
+                {
+                    LLXMLNode::getCachedLayeredXMLNode(root, paths);
+                }
+            });
+        const F64 copyMs = timeMs([&]()
+            {
+                for (S32 i = 0; i < opens; ++i)
+                {
+                    LLXMLNode::getCachedLayeredXMLNode(root, paths);
+                    root->deepCopy();
+                }
+            });
+        LL_INFOS() << opens << " loads of a 640 control floater: parse " << parseMs / opens
+                   << " ms each, first cached " << firstMs << " ms, cached " << cachedMs / opens
+                   << " ms each, cached + copy " << copyMs / opens << " ms each" << LL_ENDL;
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("XUI bundle round trip");
+        const std::string floater(writeFile("floater.xml", makeFloater(3, 5)));
+        const std::string floater_de(writeFile("floater_de.xml",
+            "<floater name=\"bench\" title=\"Bank\">\n"
+            " <tab_container name=\"tabs\"><panel name=\"panel_1\" label=\"Tafel\"/></tab_container>\n"
+            "</floater>\n"));
+        const std::string strings(writeFile("strings.xml",
+            "<strings>\n"
+            " <string name=\"a\">  spaced &amp; escaped &lt;text&gt;  </string>\n"
+            " <string name=\"b\" value=\"\"/>\n"
+            "</strings>\n"));
+        const std::vector<std::string> floater_paths{ floater, floater_de }, strings_paths{ strings };
+        const std::string bundle(mDir + "xui.bundle");
+        mFiles.push_back(bundle);
+
+        LLXMLNodePtr parsed_floater, parsed_strings, root;
+        ensure("parse floater", LLXMLNode::getLayeredXMLNode(parsed_floater, floater_paths));
+        ensure("parse strings", LLXMLNode::getLayeredXMLNode(parsed_strings, strings_paths));
+        ensure("cache floater", LLXMLNode::getCachedLayeredXMLNode(root, floater_paths));
+        ensure("cache strings", LLXMLNode::getCachedLayeredXMLNode(root, strings_paths));
+        ensure_equals("saved", LLXMLNode::saveLayeredXMLNodeCache(bundle), 2);
+        ensure_equals("saved again unchanged", LLXMLNode::saveLayeredXMLNodeCache(bundle), 0);
+
+        LLXMLNode::clearLayeredXMLNodeCache();
+        ensure_equals("loaded", LLXMLNode::loadLayeredXMLNodeCache(bundle), 2);
+        LLXMLNodePtr bundled;
+        ensure("bundled floater", LLXMLNode::getCachedLayeredXMLNode(bundled, floater_paths));
+        ensure_equals("floater", compareTrees(bundled, parsed_floater), "");
+        std::string title;
+        bundled->getAttributeString("title", title);
+        ensure_equals("layered title", title, "Bank");
+        ensure("bundled strings", LLXMLNode::getCachedLayeredXMLNode(bundled, strings_paths));
+        ensure_equals("strings", compareTrees(bundled, parsed_strings), "");
+        ensure("copy of bundled tree",
+               compareTrees(bundled->deepCopy(), parsed_strings).empty());
+
+        // a file changed since the bundle was saved is parsed again, and
+        // the stale tree is left out of the next bundle
+        writeFile("strings.xml", "<strings><string name=\"c\">new</string></strings>\n");
+        ensure("changed strings", LLXMLNode::getCachedLayeredXMLNode(bundled, strings_paths));
+        LLXMLNodePtr string_c;
+        ensure("new string", bundled->getChild("string", string_c));
+        ensure_equals("new string value", string_c->getValue(), "new");
+        LLFile::remove(floater_de);
+        ensure_equals("saved without removed file", LLXMLNode::saveLayeredXMLNodeCache(bundle), 1);
+
+        // a damaged bundle is ignored, whatever the damage
+        const std::string contents(LLFile::getContents(bundle));
+        writeFile("xui.bundle", contents.substr(0, contents.size() - 1));
+        ensure_equals("truncated", LLXMLNode::loadLayeredXMLNodeCache(bundle), 0);
+        std::string flipped(contents);
+        flipped[flipped.size() / 2] ^= 0x40;
+        writeFile("xui.bundle", flipped);
+        ensure_equals("flipped", LLXMLNode::loadLayeredXMLNodeCache(bundle), 0);
+        ensure_equals("missing", LLXMLNode::loadLayeredXMLNodeCache(mDir + "no.bundle"), 0);
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("startup XUI load: XML files vs bundle");
+        // Microbenchmark, not a pass/fail criterion: timing on a loaded
+        // build host is too noisy to assert on. Compare the log lines.
+        // Roughly what a viewer reads before the login screen: a few
+        // hundred small widget and panel files and a few large ones.
+        std::vector<std::vector<std::string>> files;
+        for (S32 i = 0; i < 300; ++i)
+        {
+            const bool large = (i % 50) == 0;
+            files.push_back({ writeFile(stringize("xui_", i, ".xml"), makeFloater(large ? 8 : 1, large ? 40 : 6)) });
+        }
+        const std::string bundle(mDir + "startup.bundle");
+        mFiles.push_back(bundle);
+
+        LLXMLNodePtr root;
+        const F64 parseMs = timeMs([&]()
+            {
+                for (const auto& paths : files)
+                {
+                    LLXMLNode::getCachedLayeredXMLNode(root, paths);
+                }
+            });
+        const F64 saveMs = timeMs([&]()
+            {
+                LLXMLNode::saveLayeredXMLNodeCache(bundle);
+            });
+        LLXMLNode::clearLayeredXMLNodeCache();
+        const F64 loadMs = timeMs([&]()
+            {
+                LLXMLNode::loadLayeredXMLNodeCache(bundle);
+                for (const auto& paths : files)
+                {
+                    LLXMLNode::getCachedLayeredXMLNode(root, paths);
+                }
+            });
+        llstat status;
+        LLFile::stat(bundle, &status);
+        LL_INFOS() << files.size() << " XUI files: parsing " << parseMs << " ms, bundle of "
+                   << status.st_size / 1024 << " KB written in " << saveMs << " ms, read back and looked up in "
+                   << loadMs << " ms" << LL_ENDL;
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("unused XUI bundle entries are dropped");
+        const std::vector<std::string> used{ writeFile("used.xml", makeFloater(1, 2)) };
+        const std::vector<std::string> unused{ writeFile("unused.xml", makeFloater(1, 3)) };
+        const std::string bundle(mDir + "aging.bundle");
+        mFiles.push_back(bundle);
+        const U32 max_unused = 2;
+
+        LLXMLNodePtr root;
+        LLXMLNode::clearLayeredXMLNodeCache();
+        ensure("cache used", LLXMLNode::getCachedLayeredXMLNode(root, used));
+        ensure("cache unused", LLXMLNode::getCachedLayeredXMLNode(root, unused));
+        ensure_equals("first session", LLXMLNode::saveLayeredXMLNodeCache(bundle, max_unused), 2);
+
+        // a session looking up only one of them keeps both...
+        LLXMLNode::clearLayeredXMLNodeCache();
+        ensure_equals("loaded for second session", LLXMLNode::loadLayeredXMLNodeCache(bundle), 2);
+        ensure("bundled used", LLXMLNode::getCachedLayeredXMLNode(root, used));
+        ensure_equals("second session", LLXMLNode::saveLayeredXMLNodeCache(bundle, max_unused), 2);
+        ensure_equals("second session saved again", LLXMLNode::saveLayeredXMLNodeCache(bundle, max_unused), 0);
+
+        // ...until the other goes unused for max_unused sessions
+        LLXMLNode::clearLayeredXMLNodeCache();
+        ensure_equals("loaded for third session", LLXMLNode::loadLayeredXMLNodeCache(bundle), 2);
+        ensure_equals("third session", LLXMLNode::saveLayeredXMLNodeCache(bundle, max_unused), 1);
+        LLXMLNode::clearLayeredXMLNodeCache();
+        ensure_equals("left in bundle", LLXMLNode::loadLayeredXMLNodeCache(bundle), 1);
+        ensure("bundled used again", LLXMLNode::getCachedLayeredXMLNode(root, used));
+        LLXMLNode::clearLayeredXMLNodeCache();
+    }
+} // namespace tut
@@ -37,6 +37,7 @@
 #include "llerrorcontrol.h"
 #include "lleventtimer.h"
 #include "llfile.h"
+#include "llframeprofiler.h"
 #include "llviewertexturelist.h"
 #include "llgroupmgr.h"
 #include "llagent.h"
@@ -130,6 +131,8 @@
 #include "llexperiencecache.h"
 #include "llimagej2c.h"
 #include "llmemory.h"
+#include "llmemtag.h"
+#include "llmessagecapture.h"
 #include "llprimitive.h"
 #include "llurlaction.h"
 #include "llurlentry.h"
@@ -175,7 +178,9 @@
 #include "llworkerthread.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
+#include "lltexturefetchreplay.h"
 #include "llimageworker.h"
+#include "lleventchannel.h"
 #include "llevents.h"
 
 // The files below handle dependencies from cleanup.
@@ -1130,9 +1135,40 @@ bool LLAppViewer::init()
     }
     LL_INFOS("InitInfo") << "Cache initialization is done." << LL_ENDL ;
 
+    // Replay a recorded texture fetch trace against the fresh cache while
+    // the login screen is up
+    const std::string texture_fetch_replay = gSavedSettings.getString("TextureFetchReplayFile");
+    if (!texture_fetch_replay.empty())
+    {
+        LLTextureFetchReplay::start(texture_fetch_replay, gSavedSettings.getString("TextureFetchReplayAssets"),
+                                    gSavedSettings.getF32("TextureFetchReplaySpeed"));
+    }
+
     // Initialize event recorder
     LLViewerEventRecorder::createInstance();
 
+    if (gSavedSettings.getBOOL("FrameProfilerEnabled"))
+    {
+        LLFrameProfiler::createInstance(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "frame_hitch"),
+                                        gSavedSettings.getF32("FrameProfilerHitchMs"),
+                                        gSavedSettings.getF32("FrameProfilerSeconds"),
+                                        gSavedSettings.getU32("FrameProfilerMaxDumps"));
+        gSavedSettings.getControl("FrameProfilerHitchMs")->getSignal()->connect(
+            [](LLControlVariable*, const LLSD& new_value, const LLSD&)
+            {
+                LLFrameProfiler::instance().setHitchThreshold((F32)new_value.asReal());
+            });
+        // Region crossings hitch as a matter of course
+        gAgent.addRegionChangedCallback(
+            []()
+            {
+                if (LLFrameProfiler::instanceExists())
+                {
+                    LLFrameProfiler::instance().holdDumps(gSavedSettings.getF32("FrameProfilerSettleSeconds"));
+                }
+            });
+    }
+
     //
     // Initialize the window
     //
@@ -1650,13 +1686,25 @@ bool LLAppViewer::doFrame()
         nd::etw::logFrame(); // <FS:ND> Write the start of each frame. Even if our Provider (qikfox3D) would be enabled, this has only light impact. Does nothing on OSX and Linux.
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_APP("df LLTrace");
-            if (LLFloaterReg::instanceVisible("block_timers"))
+            // the frame profiler needs the timer tree every frame
+            if (LLFloaterReg::instanceVisible("block_timers") || LLFrameProfiler::instanceExists())
             {
                 LLTrace::BlockTimer::processTimes();
             }
 
             LLTrace::get_frame_recording().nextPeriod();
             LLTrace::BlockTimer::logStats();
+            if (LLFrameProfiler::instanceExists())
+            {
+                // Logging in and teleporting hitch as a matter of course, as
+                // do the first frames after them
+                if (LLStartUp::getStartupState() < STATE_STARTED
+                    || gAgent.getTeleportState() != LLAgent::TELEPORT_NONE)
+                {
+                    LLFrameProfiler::instance().holdDumps(gSavedSettings.getF32("FrameProfilerSettleSeconds"));
+                }
+                LLFrameProfiler::instance().recordFrame(LLTrace::get_frame_recording().getLastRecording());
+            }
         }
 
         LLTrace::get_thread_recorder()->pullFromChildren();
@@ -1707,6 +1755,8 @@ bool LLAppViewer::doFrame()
                 LL_PROFILE_ZONE_NAMED_CATEGORY_APP("df mainloop");
                 // canonical per-frame event
                 mainloop.post(newFrame);
+                // and its typed counterpart for hot internal listeners
+                LLEventChannels::mainloop().post(gFrameCount);
             }
             {
                 LL_PROFILE_ZONE_NAMED_CATEGORY_APP("df suspend");
@@ -2380,6 +2430,21 @@ bool LLAppViewer::cleanup()
     if(mSaveSettingsOnExit)     // <FS:Zi> Backup Settings
     LLURLHistory::saveFile("url_history.xml");
 
+    // Keep the XUI parsed this session for the next startup
+    if (!isSecondInstance())
+    {
+        std::string xui_bundle = gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, "xui_templates.bundle");
+        if (gSavedSettings.getBOOL("XUITemplateBundle"))
+        {
+            S32 entries = LLXMLNode::saveLayeredXMLNodeCache(xui_bundle);
+            LL_INFOS() << "Saved " << entries << " XUI templates to " << xui_bundle << LL_ENDL;
+        }
+        else
+        {
+            LLFile::remove(xui_bundle, ENOENT);
+        }
+    }
+
     // save mute list. gMuteList used to also be deleted here too.
     if (gAgent.isInitialized() && LLMuteList::instanceExists())
     {
@@ -2460,6 +2525,7 @@ bool LLAppViewer::cleanup()
     LLLFSThread::sLocal->shutdown();
 
     LL_INFOS() << "Shutting down message system" << LL_ENDL;
+    LLMessageCapture::stop();
     end_messaging_system();
 
     // Non-LLCurl libcurl library
@@ -2552,6 +2618,13 @@ bool LLAppViewer::cleanup()
     LLSelectMgr::deleteSingleton();
     LLViewerStatsRecorder::deleteSingleton();
     LLViewerEventRecorder::deleteSingleton();
+    LLFrameProfiler::deleteSingleton();
+    {
+        // Late in cleanup, so what is still live points at leaks
+        std::ostringstream mem_tags;
+        LLMemTag::dump(mem_tags);
+        LL_INFOS("MemTag") << mem_tags.str() << LL_ENDL;
+    }
     LLWorld::deleteSingleton();
     LLVoiceClient::deleteSingleton();
     LLUI::deleteSingleton();
@@ -2585,6 +2658,7 @@ void LLAppViewer::initGeneralThread()
     }
 
     mGeneralThreadPool = new LL::ThreadPool("General", 3);
+    mGeneralThreadPool->shareCpuBudget();
     mGeneralThreadPool->start();
 }
 
@@ -3002,6 +3076,17 @@ bool LLAppViewer::initConfiguration()
     // - apply command line settings (to override the overrides)
     // - load per account settings (happens in llstartup
 
+    // Binary snapshots of the parsed settings files spare later startups
+    // the XML parse; each is only used while its XML is unchanged.  Whether
+    // to keep them is a user setting, so until the user settings are in,
+    // they are only used if an earlier session kept them.
+    const std::string settings_snapshot_dir = gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, "settings_snapshots");
+    if (LLFile::isdir(settings_snapshot_dir))
+    {
+        LLControlGroup::setSnapshotDirectory(settings_snapshot_dir);
+    }
+    LLTimer settings_timer;
+
     // - load defaults
     bool set_defaults = true;
     if (!loadSettingsFromDirectory("Default", set_defaults))
@@ -3022,6 +3107,17 @@ bool LLAppViewer::initConfiguration()
         LL_INFOS() << "Loaded settings file " << fsdata_defaults << LL_ENDL;
     }
     //</FS:Techwolf Lupindo>
+    LL_INFOS("Settings") << "Default settings loaded in " << settings_timer.getElapsedTimeF64() * 1000.0 << " ms" << LL_ENDL;
+
+    // The XUI trees parsed in earlier sessions, saved on exit: widgets,
+    // floaters and panels then come without XML parsing. Each tree is
+    // decoded when first looked up.
+    if (gSavedSettings.getBOOL("XUITemplateBundle"))
+    {
+        LLTimer bundle_timer;
+        S32 entries = LLXMLNode::loadLayeredXMLNodeCache(gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, "xui_templates.bundle"));
+        LL_INFOS("AppInit") << "Loaded " << entries << " XUI templates in " << bundle_timer.getElapsedTimeF64() * 1000.0 << " ms" << LL_ENDL;
+    }
 
     initStrings(); // setup paths for LLTrans based on settings files only
     // - set procedural settings
@@ -3110,6 +3206,20 @@ bool LLAppViewer::initConfiguration()
     // - load overrides from user_settings
     loadSettingsFromDirectory("User");
 
+    if (gSavedSettings.getBOOL("SettingsBinarySnapshots"))
+    {
+        LLControlGroup::setSnapshotDirectory(settings_snapshot_dir);
+    }
+    else
+    {
+        // and none are read next time either
+        LLControlGroup::setSnapshotDirectory(LLStringUtil::null);
+        if (LLFile::isdir(settings_snapshot_dir))
+        {
+            gDirUtilp->deleteDirAndContents(settings_snapshot_dir);
+        }
+    }
+
     if (gSavedSettings.getBOOL("FirstRunThisInstall"))
     {
         // Set firstrun flag to indicate that some further init actiona should be taken
@@ -3180,6 +3290,8 @@ bool LLAppViewer::initConfiguration()
     // <FS:AO> Re-read user settings again. This is a qikfox3D hack to get user settings to override modes
     //Todo, find a cleaner way of doing this via the various set_default arguments.
     loadSettingsFromDirectory("User");
+    LL_INFOS("Settings") << "Default, user and session settings loaded in "
+                         << settings_timer.getElapsedTimeF64() * 1000.0 << " ms" << LL_ENDL;
 
     // <FS:Ansariel> Debug setting to disable log throttle
     nd::logging::setThrottleEnabled(gSavedSettings.getBOOL("FSEnableLogThrottle"));
@@ -6097,9 +6209,9 @@ void LLAppViewer::updateNameLookupUrl(const LLViewerRegion * regionp)
     }
 }
 
-void LLAppViewer::postToMainCoro(const LL::WorkQueue::Work& work)
+void LLAppViewer::postToMainCoro(LL::WorkQueue::Work work)
 {
-    gMainloopWork.post(work);
+    gMainloopWork.post(std::move(work));
 }
 
 void LLAppViewer::outOfMemorySoftQuit()
@@ -237,7 +237,7 @@ public:
     void updateNameLookupUrl(const LLViewerRegion* regionp);
 
     // post given work to the "mainloop" work queue for handling on the main thread
-    void postToMainCoro(const LL::WorkQueue::Work& work);
+    void postToMainCoro(LL::WorkQueue::Work work);
 
     // Attempt a 'soft' quit with disconnect and saving of settings/cache.
     // Intended to be thread safe.
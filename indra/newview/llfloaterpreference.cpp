@@ -687,6 +687,7 @@ bool LLFloaterPreference::postBuild()
     LLTabContainer* tabcontainer = getChild<LLTabContainer>("pref core");
     if (!tabcontainer->selectTab(gSavedSettings.getS32("LastPrefTab")))
         tabcontainer->selectFirstTab();
+    tabcontainer->setCommitCallback(boost::bind(&LLFloaterPreference::onTabChanged, this));
 
     getChild<LLUICtrl>("cache_location")->setEnabled(false); // make it read-only but selectable (STORM-227)
     // getChildView("log_path_string")->setEnabled(false);// do the same for chat logs path - <FS:PP> Field removed from Privacy tab, we have it already in Network & Files tab along with few fancy buttons (03 Mar 2015)
@@ -970,7 +971,7 @@ void LLFloaterPreference::saveSettings()
     {
         LLView* view = *iter;
         LLPanelPreference* panel = dynamic_cast<LLPanelPreference*>(view);
-        if (panel)
+        if (panel && !panel->isBuildDeferred())
             panel->saveSettings();
     }
     saveIgnoredNotifications();
@@ -994,7 +995,7 @@ void LLFloaterPreference::apply()
     {
         LLView* view = *iter;
         LLPanelPreference* panel = dynamic_cast<LLPanelPreference*>(view);
-        if (panel)
+        if (panel && !panel->isBuildDeferred())
             panel->apply();
     }
 
@@ -1063,7 +1064,7 @@ void LLFloaterPreference::cancel(const std::vector<std::string> settings_to_skip
     {
         LLView* view = *iter;
         LLPanelPreference* panel = dynamic_cast<LLPanelPreference*>(view);
-        if (panel)
+        if (panel && !panel->isBuildDeferred())
             panel->cancel(settings_to_skip);
     }
     // hide joystick pref floater
@@ -1251,12 +1252,16 @@ void LLFloaterPreference::onOpen(const LLSD& key)
     // <FS:Ansariel> Call onOpen on all panels for additional initialization on open
     // Call onOpen() on all panels that derive from LLPanelPreference
     LLTabContainer* tabcontainer = getChild<LLTabContainer>("pref core");
+    mOpenKey = key;
+    mUnopenedTabs.clear();
     for (child_list_t::const_iterator iter = tabcontainer->getChildList()->begin();
         iter != tabcontainer->getChildList()->end(); ++iter)
     {
         LLView* view = *iter;
         LLPanelPreference* panel = dynamic_cast<LLPanelPreference*>(view);
-        if (panel)
+        if (panel && panel->isBuildDeferred())
+            mUnopenedTabs.insert(panel);
+        else if (panel)
             panel->onOpen(key);
     }
     // </FS:Ansariel>
@@ -4860,6 +4865,12 @@ void LLFloaterPreference::onUpdateFilterTerm(bool force)
     if (!mSearchData || (mSearchData->mLastFilter == seachValue && !force))
         return;
 
+    // the search has to see the controls of tabs nobody has opened yet
+    if (!seachValue.empty() && buildDeferredTabs())
+    {
+        mSearchDataDirty = true;
+    }
+
     if (mSearchDataDirty)
     {
         // Data exists, but is obsolete, regenerate
@@ -4958,6 +4969,45 @@ void collectChildren( LLView const *aView, ll::prefs::PanelDataPtr aParentPanel,
     }
 }
 
+void LLFloaterPreference::onTabChanged()
+{
+    LLPanelPreference* panel = dynamic_cast<LLPanelPreference*>(getChild<LLTabContainer>("pref core")->getCurrentPanel());
+    if (panel)
+    {
+        openDeferredTab(panel);
+    }
+}
+
+bool LLFloaterPreference::buildDeferredTabs()
+{
+    bool built = false;
+    LLTabContainer* tabcontainer = getChild<LLTabContainer>("pref core");
+    for (LLView* view : *tabcontainer->getChildList())
+    {
+        LLPanel* panel = dynamic_cast<LLPanel*>(view);
+        if (panel && panel->buildDeferred())
+        {
+            built = true;
+            if (LLPanelPreference* pref_panel = dynamic_cast<LLPanelPreference*>(panel))
+            {
+                openDeferredTab(pref_panel);
+            }
+        }
+    }
+    return built;
+}
+
+void LLFloaterPreference::openDeferredTab(LLPanelPreference* panel)
+{
+    // built after onOpen() saved the other tabs, so save this one's
+    // starting values now for cancel() to go back to
+    if (!panel->isBuildDeferred() && mUnopenedTabs.erase(panel))
+    {
+        panel->onOpen(mOpenKey);
+        panel->saveSettings();
+    }
+}
+
 void LLFloaterPreference::collectSearchableItems()
 {
     mSearchData.reset( nullptr );
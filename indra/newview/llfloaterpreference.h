@@ -338,6 +338,15 @@ private:
     void collectSearchableItems();
     //void filterIgnorableNotifications(); // <FS:Ansariel> Using different solution
 
+    // lazy_build tabs are left out of onOpen(), saveSettings(), apply() and
+    // cancel() until they are built; openDeferredTab() then gives a tab
+    // built while the floater is open the onOpen() and saveSettings() it missed
+    void onTabChanged();
+    bool buildDeferredTabs();
+    void openDeferredTab(LLPanelPreference* panel);
+    std::set<LLPanelPreference*> mUnopenedTabs;
+    LLSD mOpenKey;
+
     std::map<std::string, bool> mIgnorableNotifs;
 
     // <FS:Zi> FIRE-19539 - Include the alert messages in Prefs>Notifications>Alerts in preference Search.
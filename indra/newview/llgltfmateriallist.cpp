@@ -168,11 +168,9 @@ namespace
 
 void LLGLTFMaterialList::applyOverrideMessage(LLMessageSystem* msg, const std::string& data_in)
 {
-    std::istringstream str(data_in);
-
     LLSD data;
 
-    LLSDSerialize::fromNotation(data, str, data_in.length());
+    LLSDSerialize::fromNotationBuffer(data, data_in.data(), data_in.length(), data_in.length());
 
     const LLHost& host = msg->getSender();
 
@@ -45,6 +45,7 @@
 #include "llinventoryobserver.h"
 #include "llinventorypanel.h"
 #include "llfloaterpreviewtrash.h"
+#include "llmemtag.h"
 #include "llnotificationsutil.h"
 #include "llmarketplacefunctions.h"
 #include "llwindow.h"
@@ -3602,6 +3603,7 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
                                     bool &is_cache_obsolete)
 {
     LL_PROFILE_ZONE_NAMED("inventory load from file");
+    LLMemTagScope mem_tag(LLMemTag::INVENTORY);
 
     if(filename.empty())
     {
@@ -5523,6 +5525,132 @@ bool decompress_file(const char* src_filename, const char* dst_filename)
 /// Class LLInventoryModel::FetchItemHttpHandler
 ///----------------------------------------------------------------------------
 
+namespace
+{
+
+// Streams a FetchInventory2 reply: each element of the top level
+// "items" array is materialized and unpacked on its own, so the whole
+// reply never exists as one LLSD tree.
+class FetchItemReplyVisitor : public LLSDParseVisitor
+{
+public:
+    FetchItemReplyVisitor()
+        : mDepth(0),
+          mIsMap(false),
+          mHasError(false),
+          mItemsNext(false),
+          mInItems(false)
+    {}
+
+    bool beginMap(S32 size) override
+    {
+        if (mDepth == 0)
+        {
+            mIsMap = true;
+        }
+        else if (forward())
+        {
+            mBuilder.beginMap(size);
+        }
+        ++mDepth;
+        return true;
+    }
+
+    bool endMap() override
+    {
+        --mDepth;
+        if (forward())
+        {
+            mBuilder.endMap();
+            checkItem();
+        }
+        return true;
+    }
+
+    bool beginArray(S32 size) override
+    {
+        if (forward())
+        {
+            mBuilder.beginArray(size);
+        }
+        else if (mDepth == 1 && mItemsNext)
+        {
+            mInItems = true;
+            mItems.reserve(llmax(size, 0));
+        }
+        ++mDepth;
+        return true;
+    }
+
+    bool endArray() override
+    {
+        --mDepth;
+        if (forward())
+        {
+            mBuilder.endArray();
+            checkItem();
+        }
+        else if (mDepth == 1)
+        {
+            mInItems = false;
+        }
+        return true;
+    }
+
+    bool mapKey(const std::string& key) override
+    {
+        if (mDepth == 1)
+        {
+            mItemsNext = (key == "items");
+            mHasError = mHasError || (key == "error");
+        }
+        else if (forward())
+        {
+            mBuilder.mapKey(key);
+        }
+        return true;
+    }
+
+    bool value(const LLSD& value) override
+    {
+        if (forward())
+        {
+            mBuilder.value(value);
+            checkItem();
+        }
+        return true;
+    }
+
+    bool isMap() const                              { return mIsMap; }
+    bool hasError() const                           { return mHasError; }
+    LLInventoryModel::item_array_t& getItems()      { return mItems; }
+
+private:
+    // true for events belonging to an element of the items array
+    bool forward() const                            { return mInItems && mDepth >= 2; }
+
+    void checkItem()
+    {
+        if (mBuilder.complete())
+        {
+            LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+            titem->unpackMessage(mBuilder.result());
+            mItems.push_back(titem);
+            mBuilder.reset();
+        }
+    }
+
+    S32 mDepth;
+    bool mIsMap;
+    bool mHasError;
+    bool mItemsNext;
+    bool mInItems;
+    LLSDTreeBuilder mBuilder;
+    LLInventoryModel::item_array_t mItems;
+};
+
+} // anonymous namespace
+
 LLInventoryModel::FetchItemHttpHandler::FetchItemHttpHandler(const LLSD & request_sd)
     : LLCore::HttpHandler(),
       mRequestSD(request_sd)
@@ -5554,8 +5682,11 @@ void LLInventoryModel::FetchItemHttpHandler::onCompleted(LLCore::HttpHandle hand
         }
 
         // body->write(0, "Garbage Response", 16);      // Dev tool to force error handling
-        LLSD body_llsd;
-        if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
+        // Items are unpacked while the body is parsed rather than from a
+        // full LLSD tree of the reply.
+        LLCore::BufferArrayStream bas(body);
+        FetchItemReplyVisitor reply;
+        if (LLSDParser::PARSE_FAILURE == LLSDSerialize::visitXML(reply, bas, true))
         {
             // INFOS-level logging will occur on the parsed failure
             processFailure("HTTP response for inventory item query has malformed LLSD", response);
@@ -5563,8 +5694,7 @@ void LLInventoryModel::FetchItemHttpHandler::onCompleted(LLCore::HttpHandle hand
         }
 
         // Expect top-level structure to be a map
-        // body_llsd = LLSD::emptyArray();              // Dev tool to force error handling
-        if (! body_llsd.isMap())
+        if (! reply.isMap())
         {
             processFailure("LLSD response for inventory item not a map", response);
             break;          // Goto common exit
@@ -5579,52 +5709,32 @@ void LLInventoryModel::FetchItemHttpHandler::onCompleted(LLCore::HttpHandle hand
         // maybe that would make progress.  Or perhaps there's structured information
         // that can tell us what went wrong.  Need to dig into this and firm up
         // the API.
-        //
-        // body_llsd["error"] = LLSD::emptyMap();       // Dev tool to force error handling
-        // body_llsd["error"]["identifier"] = "Development";
-        // body_llsd["error"]["message"] = "You left development code in the viewer";
-        if (body_llsd.has("error"))
+        if (reply.hasError())
         {
             processFailure("Inventory application error (200-with-error)", response);
             break;          // Goto common exit
         }
 
         // Okay, process data if possible
-        processData(body_llsd, response);
+        processData(reply.getItems(), response);
     }
     while (false);
 }
 
-void LLInventoryModel::FetchItemHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
+void LLInventoryModel::FetchItemHttpHandler::processData(item_array_t & items, LLCore::HttpResponse * response)
 {
     start_new_inventory_observer();
 
-#if 0
-    LLUUID agent_id;
-    agent_id = content["agent_id"].asUUID();
-    if (agent_id != gAgent.getID())
-    {
-        LL_WARNS(LOG_INV) << "Got a inventory update for the wrong agent: " << agent_id
-                          << LL_ENDL;
-        return;
-    }
-#endif
-
-    LLInventoryModel::item_array_t items;
     LLInventoryModel::update_map_t update;
     LLUUID folder_id;
-    LLSD content_items(content["items"]);
-    const S32 count(static_cast<S32>(content_items.size()));
 
     // Does this loop ever execute more than once?
-    for (S32 i(0); i < count; ++i)
+    for (item_array_t::iterator it = items.begin(); it != items.end(); ++it)
     {
-        LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-        titem->unpackMessage(content_items[i]);
+        LLViewerInventoryItem * titem(*it);
 
         LL_DEBUGS(LOG_INV) << "ItemHttpHandler::httpSuccess item id: "
                            << titem->getUUID() << LL_ENDL;
-        items.push_back(titem);
 
         // examine update for changes.
         LLViewerInventoryItem * itemp(gInventory.getItem(titem->getUUID()));
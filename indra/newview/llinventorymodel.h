@@ -135,7 +135,7 @@ public:
         virtual void onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response);
 
     private:
-        void processData(LLSD & body, LLCore::HttpResponse * response);
+        void processData(item_array_t & items, LLCore::HttpResponse * response);
         void processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response);
         void processFailure(const char * const reason, LLCore::HttpResponse * response);
 
@@ -33,6 +33,7 @@
 #include "llcallbacklist.h"
 #include "llinventorymodel.h"
 #include "llinventorypanel.h"
+#include "llmemtag.h"
 #include "llnotificationsutil.h"
 #include "llstartup.h"
 #include "llviewercontrol.h"
@@ -44,6 +45,7 @@
 #include "bufferarray.h"
 #include "bufferstream.h"
 #include "llcorehttputil.h"
+#include "llsdserialize.h"
 #include "llviewermenu.h"
 #include "llviewernetwork.h"
 
@@ -136,6 +138,8 @@ protected:
 /// Class <anonymous>::BGFolderHttpHandler
 ///----------------------------------------------------------------------------
 
+class FolderReplyVisitor;
+
 // Http request handler class for folders.
 //
 // Handler for FetchInventoryDescendents2 and FetchLibDescendents2
@@ -169,7 +173,7 @@ public:
     bool getIsRecursive(const LLUUID & cat_id) const;
 
 private:
-    void processData(LLSD & body, LLCore::HttpResponse * response);
+    void processData(FolderReplyVisitor & reply, LLCore::HttpResponse * response);
     void processFailure(LLCore::HttpStatus status, LLCore::HttpResponse * response);
     void processFailure(const char * const reason, LLCore::HttpResponse * response);
 
@@ -1448,12 +1452,232 @@ bool LLInventoryModelBackgroundFetch::fetchQueueContainsNoDescendentsOf(const LL
 namespace
 {
 
+///----------------------------------------------------------------------------
+/// Class <anonymous>::FolderReplyVisitor
+///----------------------------------------------------------------------------
+
+// Streams a FetchInventoryDescendents2 reply: each item is unpacked as
+// soon as it has been parsed, and only the small per-folder fields and
+// categories are kept as LLSD, so a reply with thousands of items never
+// exists as one LLSD tree.  A folder's keys may come in any order, so
+// folders are applied once the whole reply has parsed.
+class FolderReplyVisitor : public LLSDParseVisitor
+{
+public:
+    struct Folder
+    {
+        LLUUID mFolderID;
+        LLUUID mOwnerID;
+        S32 mVersion = 0;
+        S32 mDescendents = 0;
+        std::vector<LLSD> mCategories;
+        LLInventoryModel::item_array_t mItems;
+    };
+
+    FolderReplyVisitor()
+        : mDepth(0),
+          mIsMap(false),
+          mHasError(false),
+          mInFolder(false),
+          mSection(SECTION_NONE),
+          mField(FIELD_NONE)
+    {}
+
+    bool beginMap(S32 size) override
+    {
+        if (mDepth == 0)
+        {
+            mIsMap = true;
+        }
+        else if (forward())
+        {
+            mBuilder.beginMap(size);
+        }
+        else if (mDepth == 2 && mSection == SECTION_FOLDERS)
+        {
+            mFolders.emplace_back();
+            mInFolder = true;
+        }
+        ++mDepth;
+        return true;
+    }
+
+    bool endMap() override
+    {
+        --mDepth;
+        if (forward())
+        {
+            mBuilder.endMap();
+            checkElement();
+        }
+        else if (mDepth == 2)
+        {
+            mInFolder = false;
+        }
+        return true;
+    }
+
+    bool beginArray(S32 size) override
+    {
+        if (forward())
+        {
+            mBuilder.beginArray(size);
+        }
+        else if (mDepth == 1)
+        {
+            mSection = mTopKey == "folders" ? SECTION_FOLDERS
+                : mTopKey == "bad_folders" ? SECTION_BAD_FOLDERS : SECTION_NONE;
+        }
+        else if (mDepth == 3 && mInFolder)
+        {
+            mField = mFolderKey == "items" ? FIELD_ITEMS
+                : mFolderKey == "categories" ? FIELD_CATEGORIES : FIELD_NONE;
+            if (mField == FIELD_ITEMS)
+            {
+                mFolders.back().mItems.reserve(llmax(size, 0));
+            }
+        }
+        ++mDepth;
+        return true;
+    }
+
+    bool endArray() override
+    {
+        --mDepth;
+        if (forward())
+        {
+            mBuilder.endArray();
+            checkElement();
+        }
+        else if (mDepth == 1)
+        {
+            mSection = SECTION_NONE;
+        }
+        else if (mDepth == 3)
+        {
+            mField = FIELD_NONE;
+        }
+        return true;
+    }
+
+    bool mapKey(const std::string& key) override
+    {
+        if (forward())
+        {
+            mBuilder.mapKey(key);
+        }
+        else if (mDepth == 1)
+        {
+            mTopKey = key;
+            mHasError = mHasError || (key == "error");
+        }
+        else if (mDepth == 3 && mInFolder)
+        {
+            mFolderKey = key;
+        }
+        return true;
+    }
+
+    bool value(const LLSD& value) override
+    {
+        if (forward())
+        {
+            mBuilder.value(value);
+            checkElement();
+        }
+        else if (mDepth == 3 && mInFolder)
+        {
+            Folder& folder = mFolders.back();
+            if (mFolderKey == "folder_id")
+            {
+                folder.mFolderID = value.asUUID();
+            }
+            else if (mFolderKey == "owner_id")
+            {
+                folder.mOwnerID = value.asUUID();
+            }
+            else if (mFolderKey == "version")
+            {
+                folder.mVersion = value.asInteger();
+            }
+            else if (mFolderKey == "descendents")
+            {
+                folder.mDescendents = value.asInteger();
+            }
+        }
+        return true;
+    }
+
+    bool isMap() const                          { return mIsMap; }
+    bool hasError() const                       { return mHasError; }
+    std::vector<Folder>& getFolders()           { return mFolders; }
+    const std::vector<LLSD>& getBadFolders() const  { return mBadFolders; }
+
+private:
+    enum ESection
+    {
+        SECTION_NONE,
+        SECTION_FOLDERS,
+        SECTION_BAD_FOLDERS
+    };
+
+    enum EField
+    {
+        FIELD_NONE,
+        FIELD_ITEMS,
+        FIELD_CATEGORIES
+    };
+
+    // true for events belonging to an item, a category or a bad folder
+    bool forward() const
+    {
+        return (mSection == SECTION_BAD_FOLDERS && mDepth >= 2)
+            || (mSection == SECTION_FOLDERS && mField != FIELD_NONE && mDepth >= 4);
+    }
+
+    void checkElement()
+    {
+        if (!mBuilder.complete())
+        {
+            return;
+        }
+        if (mSection == SECTION_BAD_FOLDERS)
+        {
+            mBadFolders.push_back(mBuilder.result());
+        }
+        else if (mField == FIELD_ITEMS)
+        {
+            LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+            titem->unpackMessage(mBuilder.result());
+            mFolders.back().mItems.push_back(titem);
+        }
+        else
+        {
+            mFolders.back().mCategories.push_back(mBuilder.result());
+        }
+        mBuilder.reset();
+    }
+
+    S32 mDepth;
+    bool mIsMap;
+    bool mHasError;
+    bool mInFolder;
+    ESection mSection;
+    EField mField;
+    std::string mTopKey;
+    std::string mFolderKey;
+    LLSDTreeBuilder mBuilder;
+    std::vector<Folder> mFolders;
+    std::vector<LLSD> mBadFolders;
+};
+
 ///----------------------------------------------------------------------------
 /// Class <anonymous>::BGFolderHttpHandler
 ///----------------------------------------------------------------------------
 
 void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response)
 {
+    LLMemTagScope mem_tag(LLMemTag::INVENTORY);
     do      // Single-pass do-while used for common exit handling
     {
         LLCore::HttpStatus status(response->getStatus());
@@ -1476,10 +1700,12 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
 
         // Could test 'Content-Type' header but probably unreliable.
 
-        // Convert response to LLSD
         // body->write(0, "Garbage Response", 16);      // Dev tool to force error handling
-        LLSD body_llsd;
-        if (! LLCoreHttpUtil::responseToLLSD(response, true, body_llsd))
+        // Items are unpacked while the body is parsed rather than from a
+        // full LLSD tree of the reply.
+        LLCore::BufferArrayStream bas(body);
+        FolderReplyVisitor reply;
+        if (LLSDParser::PARSE_FAILURE == LLSDSerialize::visitXML(reply, bas, true))
         {
             // INFOS-level logging will occur on the parsed failure
             processFailure("HTTP response contained malformed LLSD", response);
@@ -1487,8 +1713,7 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
         }
 
         // Expect top-level structure to be a map
-        // body_llsd = LLSD::emptyArray();              // Dev tool to force error handling
-        if (! body_llsd.isMap())
+        if (! reply.isMap())
         {
             processFailure("LLSD response not a map", response);
             break;          // goto common exit
@@ -1497,24 +1722,20 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
         // Check for 200-with-error failures
         //
         // See comments in llinventorymodel.cpp about this mode of error.
-        //
-        // body_llsd["error"] = LLSD::emptyMap();       // Dev tool to force error handling
-        // body_llsd["error"]["identifier"] = "Development";
-        // body_llsd["error"]["message"] = "You left development code in the viewer";
-        if (body_llsd.has("error"))
+        if (reply.hasError())
         {
             processFailure("Inventory application error (200-with-error)", response);
             break;          // goto common exit
         }
 
         // Okay, process data if possible
-        processData(body_llsd, response);
+        processData(reply, response);
     }
     while (false);
 }
 
 
-void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
+void BGFolderHttpHandler::processData(FolderReplyVisitor & reply, LLCore::HttpResponse * response)
 {
     LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
 
@@ -1522,130 +1743,89 @@ void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * res
     // in response as an application-level error.
 
     // Instead, we assume success and attempt to extract information.
-    if (content.has("folders"))
+    for (FolderReplyVisitor::Folder & folder : reply.getFolders())
     {
-        LLSD folders(content["folders"]);
-
-        for (LLSD::array_const_iterator folder_it = folders.beginArray();
-            folder_it != folders.endArray();
-            ++folder_it)
-        {
-            LLSD folder_sd(*folder_it);
-
-            //LLUUID agent_id = folder_sd["agent_id"];
+        //LLUUID agent_id = folder_sd["agent_id"];
 
-            //if(agent_id != gAgent.getID())    //This should never happen.
-            //{
-            //  LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
-            //          << LL_ENDL;
-            //  break;
-            //}
+        //if(agent_id != gAgent.getID())    //This should never happen.
+        //{
+        //  LL_WARNS(LOG_INV) << "Got a UpdateInventoryItem for the wrong agent."
+        //          << LL_ENDL;
+        //  break;
+        //}
 
-            LLUUID parent_id(folder_sd["folder_id"].asUUID());
-            LLUUID owner_id(folder_sd["owner_id"].asUUID());
-            S32    version(folder_sd["version"].asInteger());
-            S32    descendents(folder_sd["descendents"].asInteger());
-            LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(owner_id);
+        const LLUUID & parent_id(folder.mFolderID);
+        LLPointer<LLViewerInventoryCategory> tcategory = new LLViewerInventoryCategory(folder.mOwnerID);
 
-            if (parent_id.isNull())
+        if (parent_id.isNull())
+        {
+            for (LLViewerInventoryItem * titem : folder.mItems)
             {
-                LLSD items(folder_sd["items"]);
-                LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
+                const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
 
-                for (LLSD::array_const_iterator item_it = items.beginArray();
-                    item_it != items.endArray();
-                    ++item_it)
+                if (lost_uuid.notNull())
                 {
-                    const LLUUID lost_uuid(gInventory.findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND));
-
-                    if (lost_uuid.notNull())
+                    LLInventoryModel::update_list_t update;
+                    LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
+                    update.push_back(new_folder);
+                    gInventory.accountForUpdate(update);
+
+                    titem->setParent(lost_uuid);
+                    titem->updateParentOnServer(false);
+                    gInventory.updateItem(titem);
+                    // <FS:Ansariel> FIRE-21376: Inventory not loading properly on OpenSim
+                    if (!LLGridManager::getInstance()->isInSecondLife())
                     {
-                        LLSD item(*item_it);
-
-                        titem->unpackMessage(item);
-
-                        LLInventoryModel::update_list_t update;
-                        LLInventoryModel::LLCategoryUpdate new_folder(lost_uuid, 1);
-                        update.push_back(new_folder);
-                        gInventory.accountForUpdate(update);
-
-                        titem->setParent(lost_uuid);
-                        titem->updateParentOnServer(false);
-                        gInventory.updateItem(titem);
-                        // <FS:Ansariel> FIRE-21376: Inventory not loading properly on OpenSim
-                        if (!LLGridManager::getInstance()->isInSecondLife())
-                        {
-                            gInventory.notifyObservers();
-                        }
-                        // </FS:Ansariel>
+                        gInventory.notifyObservers();
                     }
+                    // </FS:Ansariel>
                 }
             }
+        }
 
-            LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
-            if (! pcat)
-            {
-                continue;
-            }
-
-            LLSD categories(folder_sd["categories"]);
-            for (LLSD::array_const_iterator category_it = categories.beginArray();
-                category_it != categories.endArray();
-                ++category_it)
-            {
-                LLSD category(*category_it);
-                tcategory->fromLLSD(category);
+        LLViewerInventoryCategory * pcat(gInventory.getCategory(parent_id));
+        if (! pcat)
+        {
+            continue;
+        }
 
-                const bool recursive(getIsRecursive(tcategory->getUUID()));
-                if (recursive)
-                {
-                    fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
-                }
-                else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
-                {
-                    gInventory.updateCategory(tcategory);
-                }
-            }
+        for (const LLSD & category : folder.mCategories)
+        {
+            tcategory->fromLLSD(category);
 
-            LLSD items(folder_sd["items"]);
-            LLPointer<LLViewerInventoryItem> titem = new LLViewerInventoryItem;
-            for (LLSD::array_const_iterator item_it = items.beginArray();
-                 item_it != items.endArray();
-                 ++item_it)
+            const bool recursive(getIsRecursive(tcategory->getUUID()));
+            if (recursive)
             {
-                LLSD item(*item_it);
-                titem->unpackMessage(item);
-
-                gInventory.updateItem(titem);
+                fetcher->addRequestAtBack(tcategory->getUUID(), recursive, true);
             }
-
-            // Set version and descendentcount according to message.
-            LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
-            if (cat)
+            else if (! gInventory.isCategoryComplete(tcategory->getUUID()))
             {
-                cat->setVersion(version);
-                cat->setDescendentCount(descendents);
-                cat->determineFolderType();
+                gInventory.updateCategory(tcategory);
             }
         }
-    }
 
-    if (content.has("bad_folders"))
-    {
-        LLSD bad_folders(content["bad_folders"]);
-        for (LLSD::array_const_iterator folder_it = bad_folders.beginArray();
-             folder_it != bad_folders.endArray();
-             ++folder_it)
+        for (LLViewerInventoryItem * titem : folder.mItems)
         {
-            // *TODO: Stop copying data [ed:  this isn't copying data]
-            LLSD folder_sd(*folder_it);
+            gInventory.updateItem(titem);
+        }
 
-            // These folders failed on the dataserver.  We probably don't want to retry them.
-            LL_WARNS(LOG_INV) << "Folder " << folder_sd["folder_id"].asString()
-                              << "Error: " << folder_sd["error"].asString() << LL_ENDL;
+        // Set version and descendentcount according to message.
+        LLViewerInventoryCategory * cat(gInventory.getCategory(parent_id));
+        if (cat)
+        {
+            cat->setVersion(folder.mVersion);
+            cat->setDescendentCount(folder.mDescendents);
+            cat->determineFolderType();
         }
     }
 
+    for (const LLSD & folder_sd : reply.getBadFolders())
+    {
+        // These folders failed on the dataserver.  We probably don't want to retry them.
+        LL_WARNS(LOG_INV) << "Folder " << folder_sd["folder_id"].asString()
+                          << "Error: " << folder_sd["error"].asString() << LL_ENDL;
+    }
+
     if (fetcher->isBulkFetchProcessingComplete())
     {
         fetcher->setAllFoldersFetched();
@@ -44,6 +44,7 @@
 #include "llimagej2c.h"
 #include "llhost.h"
 #include "llmath.h"
+#include "llmemtag.h"
 #include "llnotificationsutil.h"
 #include "llsd.h"
 #include "llsdutil_math.h"
@@ -72,6 +73,8 @@
 #include "bufferstream.h"
 #include "llfasttimer.h"
 #include "llcorehttputil.h"
+#include "cpubudget.h"
+#include "threadpool.h"
 #include "lltrans.h"
 #include "llstatusbar.h"
 #include "llinventorypanel.h"
@@ -857,6 +860,7 @@ LLMeshRepoThread::LLMeshRepoThread()
   mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
   mHttpLegacyPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID), // <FS:Ansariel> [UDP Assets]
   mHttpLargePolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+  mDisableRangeRequests(gSavedSettings, "HttpRangeRequestsDisable", false),
   mLegacyGetMeshVersion(0) // <FS:Ansariel> [UDP Assets]
 {
     LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
@@ -1346,7 +1350,7 @@ LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url, int l
                                                   const LLCore::HttpHandler::ptr_t &handler)
 {
     // Also used in lltexturefetch.cpp
-    static LLCachedControl<bool> disable_range_req(gSavedSettings, "HttpRangeRequestsDisable", false);
+    const bool disable_range_req(mDisableRangeRequests);
 
     LLCore::HttpHandle handle(LLCORE_HTTP_HANDLE_INVALID);
 
@@ -1987,10 +1991,144 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
     return retval;
 }
 
+bool LLMeshHeader::fromBinary(LLSDBinaryCursor& cursor)
+{
+    const char* lod[] =
+    {
+        "lowest_lod",
+        "low_lod",
+        "medium_lod",
+        "high_lod"
+    };
+
+    // fromLLSD() reads missing entries as 0, do the same
+    mVersion = 0;
+    mSkinOffset = mSkinSize = 0;
+    mPhysicsConvexOffset = mPhysicsConvexSize = 0;
+    mPhysicsMeshOffset = mPhysicsMeshSize = 0;
+    for (U32 i = 0; i < 4; ++i)
+    {
+        mLodOffset[i] = mLodSize[i] = 0;
+    }
+    m404 = false;
+
+    // Reads one value, stepping over it if it turns out to be a container
+    auto read_value = [&cursor](LLSD& value) -> bool
+    {
+        value.clear();
+        switch (cursor.next())
+        {
+        case LLSDBinaryCursor::TOKEN_VALUE:
+            value = cursor.value();
+            return true;
+        case LLSDBinaryCursor::TOKEN_MAP_BEGIN:
+        case LLSDBinaryCursor::TOKEN_ARRAY_BEGIN:
+            return cursor.skip();
+        default:
+            return false;
+        }
+    };
+
+    // Reads an { offset, size } block
+    auto read_block = [&cursor, &read_value](S32& offset, S32& size) -> bool
+    {
+        LLSDBinaryCursor::EToken token = cursor.next();
+        if (token == LLSDBinaryCursor::TOKEN_VALUE)
+        {
+            return true;
+        }
+        if (token == LLSDBinaryCursor::TOKEN_ARRAY_BEGIN)
+        {
+            return cursor.skip();
+        }
+        if (token != LLSDBinaryCursor::TOKEN_MAP_BEGIN)
+        {
+            return false;
+        }
+        LLSD value;
+        while (cursor.next() == LLSDBinaryCursor::TOKEN_KEY)
+        {
+            S32* dest = cursor.key() == "offset" ? &offset : cursor.key() == "size" ? &size : NULL;
+            if (!dest)
+            {
+                if (!cursor.skip()) return false;
+            }
+            else if (read_value(value))
+            {
+                *dest = value.asInteger();
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return cursor.token() == LLSDBinaryCursor::TOKEN_MAP_END;
+    };
+
+    if (cursor.next() != LLSDBinaryCursor::TOKEN_MAP_BEGIN)
+    {
+        return false;
+    }
+
+    LLSD value;
+    while (cursor.next() == LLSDBinaryCursor::TOKEN_KEY)
+    {
+        const std::string key = cursor.key();
+        bool success = true;
+        if (key == "version")
+        {
+            success = read_value(value);
+            mVersion = value.asInteger();
+        }
+        else if (key == "skin")
+        {
+            success = read_block(mSkinOffset, mSkinSize);
+        }
+        else if (key == "physics_convex")
+        {
+            success = read_block(mPhysicsConvexOffset, mPhysicsConvexSize);
+        }
+        else if (key == "physics_mesh")
+        {
+            success = read_block(mPhysicsMeshOffset, mPhysicsMeshSize);
+        }
+        else if (key == "404")
+        {
+            m404 = true;
+            success = cursor.skip();
+        }
+        // <FS:Ansariel> DAE export
+        else if (key == "creator")
+        {
+            success = read_value(value);
+            if (value.isUUID())
+            {
+                mCreatorId = value.asUUID();
+            }
+        }
+        // </FS:Ansariel>
+        else
+        {
+            S32 i = 0;
+            while (i < 4 && key != lod[i])
+            {
+                ++i;
+            }
+            success = (i < 4) ? read_block(mLodOffset[i], mLodSize[i]) : cursor.skip();
+        }
+        if (!success)
+        {
+            return false;
+        }
+    }
+    return cursor.token() == LLSDBinaryCursor::TOKEN_MAP_END;
+}
+
 EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size)
 {
+    LLMemTagScope mem_tag(LLMemTag::MESH);
+    LL::CpuBudget::Token budget(LL::ThreadPoolBase::getCpuBudget());
     const LLUUID mesh_id = mesh_params.getSculptID();
-    LLSD header_data;
 
     LLMeshHeader header;
 
@@ -2002,23 +2140,20 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
         data_size = (S32)dsize;
 
-        boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
-
-        if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
-        {
-            LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
-                               << LL_ENDL;
-            return MESH_PARSE_FAILURE;
-        }
-
-        if (!header_data.isMap())
+        // Pull the few fields we need without building an LLSD tree
+        LLSDBinaryCursor cursor((const U8*)result_ptr, data_size);
+        if (!header.fromBinary(cursor))
         {
+            if (cursor.token() == LLSDBinaryCursor::TOKEN_ERROR)
+            {
+                LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
+                                   << LL_ENDL;
+                return MESH_PARSE_FAILURE;
+            }
             LL_WARNS(LOG_MESH) << "Mesh header is invalid for ID: " << mesh_id << LL_ENDL;
             return MESH_INVALID;
         }
 
-        header.fromLLSD(header_data);
-
         if (header.mVersion > MAX_MESH_VERSION)
         {
             LL_INFOS(LOG_MESH) << "Wrong version in header for " << mesh_id << LL_ENDL;
@@ -2027,7 +2162,7 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
         // make sure there is at least one lod, function returns -1 and marks as 404 otherwise
         else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
         {
-            header_size += stream.tellg();
+            header_size += cursor.offset();
         }
     }
     else
@@ -2066,6 +2201,8 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
 EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size)
 {
+    LLMemTagScope mem_tag(LLMemTag::MESH);
+    LL::CpuBudget::Token budget(LL::ThreadPoolBase::getCpuBudget());
     if (data == NULL || data_size == 0)
     {
         return MESH_NO_DATA;
@@ -2096,6 +2233,8 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
 
 bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
 {
+    LLMemTagScope mem_tag(LLMemTag::MESH);
+    LL::CpuBudget::Token budget(LL::ThreadPoolBase::getCpuBudget());
     LLSD skin;
 
     if (data_size > 0)
@@ -2142,6 +2281,8 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 
 bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
 {
+    LLMemTagScope mem_tag(LLMemTag::MESH);
+    LL::CpuBudget::Token budget(LL::ThreadPoolBase::getCpuBudget());
     LLSD decomp;
 
     if (data_size > 0)
@@ -2178,6 +2319,8 @@ bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S3
 
 EMeshProcessingResult LLMeshRepoThread::physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
 {
+    LLMemTagScope mem_tag(LLMemTag::MESH);
+    LL::CpuBudget::Token budget(LL::ThreadPoolBase::getCpuBudget());
     LLSD physics_shape;
 
     LLModel::Decomposition* d = new LLModel::Decomposition();
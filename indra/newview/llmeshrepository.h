@@ -29,8 +29,10 @@
 
 #include <unordered_map>
 #include "llassettype.h"
+#include "llcontrol.h"
 #include "llmodel.h"
 #include "lluuid.h"
+#include "lluuidhashmap.h"
 #include "llviewertexture.h"
 #include "llvolume.h"
 #include "lldeadmantimer.h"
@@ -47,6 +49,7 @@
 #include "lluploadfloaterobservers.h"
 
 class LLVOVolume;
+class LLSDBinaryCursor;
 class LLMutex;
 class LLCondition;
 class LLMeshRepository;
@@ -242,6 +245,11 @@ public:
         // </FS:Ansariel>
     }
 
+    // Same result as fromLLSD(), but reads the fields straight out of
+    // binary LLSD without building a tree. Returns false if the data
+    // is malformed or not a map; check cursor.token() to tell which.
+    bool fromBinary(LLSDBinaryCursor& cursor);
+
     S32 mVersion = -1;
     S32 mSkinOffset = -1;
     S32 mSkinSize = -1;
@@ -277,7 +285,7 @@ public:
     LLCondition* mSignal;
 
     //map of known mesh headers
-    typedef boost::unordered_map<LLUUID, std::pair<U32, LLMeshHeader>> mesh_header_map; // pair is header_size and data
+    typedef LLUUIDHashMap<std::pair<U32, LLMeshHeader>> mesh_header_map; // pair is header_size and data
     mesh_header_map mMeshHeader;
 
     class HeaderRequest : public RequestStats
@@ -390,6 +398,8 @@ public:
     LLCore::HttpRequest::policy_t       mHttpPolicyClass;
     LLCore::HttpRequest::policy_t       mHttpLegacyPolicyClass; // <FS:Ansariel> [UDP Assets]
     LLCore::HttpRequest::policy_t       mHttpLargePolicyClass;
+    // read on this thread, resolved by the constructor on the main thread
+    LLControlHandle<bool>               mDisableRangeRequests;
 
     typedef std::set<LLCore::HttpHandler::ptr_t> http_request_set;
     http_request_set                    mHttpRequestSet;            // Outstanding HTTP requests
@@ -411,6 +421,8 @@ public:
 
     bool fetchMeshHeader(const LLVolumeParams& mesh_params, bool can_retry = true);
     bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry = true);
+    // Each of these decodes one asset while holding a token from the
+    // ThreadPool CPU budget, so mesh decode shares cores with image decode.
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -65,6 +65,7 @@
 #include "llloginflags.h"
 #include "llmd5.h"
 #include "llmemorystream.h"
+#include "llmessagecapture.h"
 #include "llmessageconfig.h"
 #include "llmoveview.h"
 #include "llfloaterimcontainer.h"
@@ -883,6 +884,21 @@ bool idle_startup()
                 msg->startLogging();
             }
 
+            std::string capture_file = gSavedSettings.getString("ObjectUpdateCaptureFile");
+            if (!capture_file.empty())
+            {
+                // For the decode benchmark in llmessage/tests
+                std::vector<std::string> names;
+                names.push_back("ObjectUpdate");
+                names.push_back("ObjectUpdateCompressed");
+                names.push_back("ObjectUpdateCached");
+                names.push_back("ImprovedTerseObjectUpdate");
+                if (LLMessageCapture::start(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, capture_file), names))
+                {
+                    msg->setReceiveFunc(LLMessageCapture::receive);
+                }
+            }
+
             // start the xfer system. by default, choke the downloads
             // a lot...
             const S32 VIEWER_MAX_XFER = 3;
@@ -914,6 +930,11 @@ bool idle_startup()
                 msg->mPacketRing.setUseOutThrottle(true);
                 msg->mPacketRing.setOutBandwidth(outBandwidth);
             }
+
+            if (gSavedSettings.getBOOL("FSNetworkReceiveThread"))
+            {
+                msg->startReceiveThread();
+            }
         }
 
         LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
@@ -3552,6 +3573,7 @@ void register_viewer_callbacks(LLMessageSystem* msg)
     msg->setHandlerFunc("ObjectUpdateCompressed",               process_compressed_object_update );
     msg->setHandlerFunc("ObjectUpdateCached",                   process_cached_object_update );
     msg->setHandlerFuncFast(_PREHASH_ImprovedTerseObjectUpdate, process_terse_object_update_improved );
+    LLViewerObject::bindUpdateHandles(msg);
     msg->setHandlerFunc("SimStats",             process_sim_stats);
     msg->setHandlerFuncFast(_PREHASH_HealthMessage,         process_health_message );
     msg->setHandlerFuncFast(_PREHASH_EconomyData,               process_economy_data);
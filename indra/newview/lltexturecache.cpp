@@ -801,7 +801,8 @@ LLTextureCache::LLTextureCache(bool threaded)
       mDoPurge(false),
       mFastCachep(NULL),
       mFastCachePoolp(NULL),
-      mFastCachePadBuffer(NULL)
+      mFastCachePadBuffer(NULL),
+      mRawCache(std::make_shared<LLTextureRawCache>())
 {
     mHeaderAPRFilePoolp = new LLVolatileAPRPool(); // is_local = true, because this pool is for headers, headers are under own mutex
 }
@@ -940,6 +941,7 @@ const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
 const char* textures_dirname = "texturecache";
 const char* fast_cache_filename = "FastCache.cache";
+const char* raw_cache_dirname = "rawmips";
 
 void LLTextureCache::setDirNames(ELLPath location)
 {
@@ -950,6 +952,7 @@ void LLTextureCache::setDirNames(ELLPath location)
     mHeaderDataFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, cache_filename);
     mTexturesDirName = gDirUtilp->getExpandedFilename(location, textures_dirname);
     mFastCacheFileName =  gDirUtilp->getExpandedFilename(location, textures_dirname, fast_cache_filename);
+    mRawCacheDirName = gDirUtilp->getExpandedFilename(location, textures_dirname, raw_cache_dirname);
 }
 
 void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
@@ -1043,6 +1046,9 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
     llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
     openFastCache(true);
 
+    S64 raw_cache_size = gSavedSettings.getBOOL("FSTextureRawCache") ? (S64)gSavedSettings.getU32("FSTextureRawCacheSize") * 1024 * 1024 : 0;
+    mRawCache->init(mRawCacheDirName, raw_cache_size, gSavedSettings.getBOOL("FSTextureRawCacheCompression"), mReadOnly);
+
     return max_size; // unused cache space
 }
 
@@ -1623,6 +1629,7 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
             PeekMessage(&msg, 0, 0, 0, PM_NOREMOVE | PM_NOYIELD);
 #endif
         }
+        mRawCache->purge(mRawCacheDirName, purge_directories);
         // <FS:Ansariel> Only delete folder if it actually exist
         if (LLFile::isdir(mTexturesDirName))
         {
@@ -2319,6 +2326,8 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
         }
 
         unlockHeaders() ;
+
+        mRawCache->remove(id);
     }
     return ret ;
 }
@@ -33,6 +33,7 @@
 #include "lluuid.h"
 
 #include "llworkerthread.h"
+#include "lltexturerawcache.h"
 
 class LLImageFormatted;
 class LLTextureCacheWorker;
@@ -133,6 +134,9 @@ public:
 
     bool removeFromCache(const LLUUID& id);
 
+    // Decoded mips, checked before the J2C entries
+    LLTextureRawCache* getRawCache() { return mRawCache.get(); }
+
     // For LLTextureCacheWorker::Responder
     LLTextureCacheWorker* getReader(handle_t handle);
     LLTextureCacheWorker* getWriter(handle_t handle);
@@ -222,6 +226,7 @@ private:
     std::string mHeaderEntriesFileName;
     std::string mHeaderDataFileName;
     std::string mFastCacheFileName;
+    std::string mRawCacheDirName;
     EntriesInfo mHeaderEntriesInfo;
     std::set<S32> mFreeList; // deleted entries
     std::set<LLUUID> mLRU;
@@ -232,6 +237,8 @@ private:
     LLFrameTimer mFastCacheTimer;
     U8*          mFastCachePadBuffer;
 
+    std::shared_ptr<LLTextureRawCache> mRawCache;
+
     // BODIES (TEXTURES minus headers)
     std::string mTexturesDirName;
     typedef std::map<LLUUID,S32> size_map_t;
@@ -27,6 +27,7 @@
 #include "llviewerprecompiledheaders.h"
 
 #include <iostream>
+#include <atomic>
 #include <map>
 #include <algorithm>
 
@@ -36,12 +37,14 @@
 #include "llhttpconstants.h"
 #include "llimage.h"
 #include "llimagej2c.h"
+#include "llimagej2clayout.h"
 #include "llimageworker.h"
 #include "llworkerthread.h"
 #include "message.h"
 
 #include "llagent.h"
 #include "lltexturecache.h"
+#include "lltexturefetchtrace.h"
 #include "llviewercontrol.h"
 #include "llviewertexturelist.h"
 #include "llviewertexture.h"
@@ -68,6 +71,9 @@
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheHit("texture_cache_hit");
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheAttempt("texture_cache_attempt");
 LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > LLTextureFetch::sCacheHitRate("texture_cache_hits");
+LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > LLTextureFetch::sRawCacheHitRate("texture_raw_cache_hits");
+LLTrace::CountStatHandle<F64Seconds> LLTextureFetch::sRawCacheDecodeSaved("texture_raw_cache_decode_saved");
+LLTrace::CountStatHandle<> LLTextureFetch::sExactRangeRequests("texture_exact_range_requests", "Texture fetches sized from the packet lengths of cached data");
 
 LLTrace::SampleStatHandle<F32Seconds> LLTextureFetch::sCacheReadLatency("texture_cache_read_latency");
 LLTrace::SampleStatHandle<F32Seconds> LLTextureFetch::sTexDecodeLatency("texture_decode_latency");
@@ -404,6 +410,9 @@ public:
     // Threads:  Tid
     void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id);
 
+    // Threads:  T*
+    void callbackRawCacheRead(U32 request, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time);
+
     // Threads:  T*
     void setGetStatus(LLCore::HttpStatus status, const std::string& reason)
     {
@@ -487,6 +496,23 @@ private:
     // Locks:  Mw
     void removeFromCache();
 
+    // Threads:  Ttf
+    // Locks:  Mw
+    bool canUseRawCache() const;
+
+    // Starts the decoded mip read, then takes its result. Returns true once
+    // the mip is loaded; mRawCacheState tells waiting from a miss otherwise.
+    // Threads:  Ttf
+    // Locks:  Mw
+    bool loadFromRawCache();
+
+    // Reads the packet lengths in the data we already have, if any, to fetch
+    // exactly the bytes mDesiredDiscard needs.  Returns true if the data we
+    // have is already enough.
+    // Threads:  Ttf
+    // Locks:  Mw
+    bool planFromLayout();
+
     // Threads:  Ttf
     // <FS:Ansariel> OpenSim compatibility
     // Locks:  Mw
@@ -547,7 +573,20 @@ private:
     void setState(e_state new_state);
     LLViewerRegion* getRegion();
 
+    enum e_raw_cache_state //mRawCacheState
+    {
+        RAW_CACHE_UNCHECKED = 0,
+        RAW_CACHE_READING,
+        RAW_CACHE_LOADED,   // mRawCacheImage holds the result, null on a miss
+        RAW_CACHE_CHECKED
+    };
+
     e_write_to_cache_state mWriteToCacheState;
+    e_raw_cache_state mRawCacheState;
+    U32 mRawCacheRequest;
+    LLPointer<LLImageRaw> mRawCacheImage;
+    S32 mRawCacheDiscard;
+    F32 mRawCacheDecodeTime;
     LLTextureFetch* mFetcher;
     LLPointer<LLImageFormatted> mFormattedImage;
     LLPointer<LLImageRaw>       mRawImage,
@@ -582,6 +621,7 @@ private:
     S32                         mRequestedSize,
                                 mRequestedOffset,
                                 mDesiredSize,
+                                mPlannedSize,   // exact size for mDesiredDiscard, 0 if unknown
                                 mFileSize,
                                 mCachedSize;
     e_request_state mSentRequest;
@@ -887,6 +927,14 @@ const char* sStateDescs[] = {
 const std::set<S32> LOGGED_STATES = { LLTextureFetchWorker::LOAD_FROM_TEXTURE_CACHE, LLTextureFetchWorker::LOAD_FROM_NETWORK, LLTextureFetchWorker::LOAD_FROM_SIMULATOR, // <FS:Ansariel> OpenSim compatibility
                                         LLTextureFetchWorker::WAIT_HTTP_REQ, LLTextureFetchWorker::DECODE_IMAGE_UPDATE, LLTextureFetchWorker::WAIT_ON_WRITE };
 
+// Traces record worker states as they are
+static_assert(LLTextureFetchWorker::LOAD_FROM_TEXTURE_CACHE == LLTextureFetchTrace::LOAD_FROM_TEXTURE_CACHE
+              && LLTextureFetchWorker::WAIT_HTTP_REQ == LLTextureFetchTrace::WAIT_HTTP_REQ
+              && LLTextureFetchWorker::DECODE_IMAGE == LLTextureFetchTrace::DECODE_IMAGE
+              && LLTextureFetchWorker::WRITE_TO_CACHE == LLTextureFetchTrace::WRITE_TO_CACHE
+              && LLTextureFetchWorker::DONE == LLTextureFetchTrace::DONE,
+              "LLTextureFetchTrace::EState must mirror LLTextureFetchWorker::e_state");
+
 // static
 volatile bool LLTextureFetch::svMetricsDataBreak(true); // Start with a data break
 
@@ -904,6 +952,10 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       LLCore::HttpHandler(),
       mState(INIT),
       mWriteToCacheState(NOT_WRITE),
+      mRawCacheState(RAW_CACHE_UNCHECKED),
+      mRawCacheRequest(0),
+      mRawCacheDiscard(-1),
+      mRawCacheDecodeTime(0.f),
       mFetcher(fetcher),
       mFTType(f_type),
       mID(id),
@@ -925,6 +977,7 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mRequestedSize(0),
       mRequestedOffset(0),
       mDesiredSize(TEXTURE_CACHE_ENTRY_SIZE),
+      mPlannedSize(0),
       mFileSize(0),
       mSkippedStatesTime(0),
       mCachedSize(0),
@@ -1080,6 +1133,7 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
         }
         mDesiredDiscard = discard;
         mDesiredSize = size;
+        mPlannedSize = 0;
     }
     else if (size > mDesiredSize)
     {
@@ -1225,6 +1279,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mDecodedDiscard = -1;
         mRequestedSize = 0;
         mRequestedOffset = 0;
+        mPlannedSize = 0;
         mFileSize = 0;
         mCachedSize = 0;
         mLoaded = false;
@@ -1242,6 +1297,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
         clearPackets(); // <FS:Ansariel> OpenSim compatibility
         mCacheReadHandle = LLTextureCache::nullHandle();
         mCacheWriteHandle = LLTextureCache::nullHandle();
+        mRawCacheState = RAW_CACHE_UNCHECKED;
+        mRawCacheImage = NULL;
         setState(LOAD_FROM_TEXTURE_CACHE);
         mInCache = false;
         mDesiredSize = llmax(mDesiredSize, TEXTURE_CACHE_ENTRY_SIZE); // min desired size is TEXTURE_CACHE_ENTRY_SIZE
@@ -1256,6 +1313,16 @@ bool LLTextureFetchWorker::doWork(S32 param)
         LL_PROFILE_ZONE_NAMED_CATEGORY_THREAD("tfwdw - LOAD_FROM_TEXTURE_CACHE");
         if (mCacheReadHandle == LLTextureCache::nullHandle())
         {
+            if (loadFromRawCache())
+            {
+                setState(DONE);
+                return doWork(param);
+            }
+            if (mRawCacheState == RAW_CACHE_READING)
+            {
+                return false;
+            }
+
             S32 offset = mFormattedImage.notNull() ? mFormattedImage->getDataSize() : 0;
             S32 size = mDesiredSize - offset;
             if (size <= 0)
@@ -1327,8 +1394,14 @@ bool LLTextureFetchWorker::doWork(S32 param)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_THREAD("tfwdw - CACHE_POST");
         mCachedSize = mFormattedImage.notNull() ? mFormattedImage->getDataSize() : 0;
+        bool have_enough = (mCachedSize >= mDesiredSize) || mHaveAllData;
+        if (!have_enough && mCachedSize > 0)
+        {
+            // the cached header may tell exactly how much more is needed
+            have_enough = planFromLayout();
+        }
         // Successfully loaded
-        if ((mCachedSize >= mDesiredSize) || mHaveAllData)
+        if (have_enough)
         {
             // we have enough data, decode it
             llassert_always(mFormattedImage->getDataSize() > 0);
@@ -1557,7 +1630,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_THREAD("tfwdw - SEND_HTTP_REQ");
         // Also used in llmeshrepository
-        static LLCachedControl<bool> disable_range_req(gSavedSettings, "HttpRangeRequestsDisable", false);
+        const bool disable_range_req(mFetcher->mDisableRangeRequests);
 
         if (! mCanUseHTTP)
         {
@@ -1596,7 +1669,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 }
             }
         }
-        mRequestedSize = mDesiredSize;
+        mRequestedSize = mPlannedSize > 0 ? mPlannedSize : mDesiredSize;
         mRequestedDiscard = mDesiredDiscard;
         mRequestedSize -= cur_size;
         mRequestedOffset = cur_size;
@@ -1886,6 +1959,15 @@ bool LLTextureFetchWorker::doWork(S32 param)
             // NOTE: setData releases current data and owns new data (buffer)
             mFormattedImage->setData(buffer, total_size);
 
+            if (mFormattedImage->getCodec() == IMG_CODEC_J2C)
+            {
+                LLImageJ2CLayout layout;
+                if (layout.parse(buffer, total_size))
+                {
+                    mFetcher->mByteModel.learn(layout);
+                }
+            }
+
             // Done with buffer array
             mHttpBufferArray->release();
             mHttpBufferArray = NULL;
@@ -1923,9 +2005,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
     if (mState == DECODE_IMAGE)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_THREAD("tfwdw - DECODE_IMAGE");
-        static LLCachedControl<bool> textures_decode_disabled(gSavedSettings, "TextureDecodeDisabled", false);
-
-        if (textures_decode_disabled)
+        if (mFetcher->mDecodeDisabled)
         {
             // for debug use, don't decode
             setState(DONE);
@@ -2017,6 +2097,10 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 llassert_always(mRawImage.notNull());
                 LL_DEBUGS(LOG_TXT) << mID << ": Decoded. Discard: " << mDecodedDiscard
                                    << " Raw Image: " << llformat("%dx%d",mRawImage->getWidth(),mRawImage->getHeight()) << LL_ENDL;
+                if (canUseRawCache())
+                {
+                    mFetcher->mTextureCache->getRawCache()->write(mID, mRawImage, mDecodedDiscard, mDecodeTime);
+                }
                 setState(WRITE_TO_CACHE);
             }
             // fall through
@@ -2120,9 +2204,11 @@ bool LLTextureFetchWorker::doWork(S32 param)
 void LLTextureFetchWorker::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response)
 {
     LL_PROFILE_ZONE_SCOPED;
-    static LLCachedControl<bool> log_to_viewer_log(gSavedSettings, "LogTextureDownloadsToViewerLog", false);
-    static LLCachedControl<bool> log_to_sim(gSavedSettings, "LogTextureDownloadsToSimulator", false);
-    static LLCachedControl<bool> log_texture_traffic(gSavedSettings, "LogTextureNetworkTraffic", false) ;
+    // This runs on the worker thread: read settings through the handles
+    // LLTextureFetch resolved on the main thread
+    const bool log_to_viewer_log(mFetcher->mLogToViewerLog);
+    const bool log_to_sim(mFetcher->mLogToSim);
+    const bool log_texture_traffic(mFetcher->mLogTextureTraffic);
 
     LLMutexLock lock(&mWorkMutex);                                      // +Mw
 
@@ -2137,7 +2223,7 @@ void LLTextureFetchWorker::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRe
         mFetcher->mTextureInfo.setRequestCompleteTimeAndLog(mID, LLTimer::getTotalTime());
     }
 
-    static LLCachedControl<F32> fake_failure_rate(gSavedSettings, "TextureFetchFakeFailureRate", 0.0f);
+    const F32 fake_failure_rate(mFetcher->mFakeFailureRate);
     F32 rand_val = ll_frand();
     F32 rate = fake_failure_rate;
     if (mFTType == FTT_SERVER_BAKE && (fake_failure_rate > 0.0) && (rand_val < fake_failure_rate))
@@ -2333,6 +2419,113 @@ void LLTextureFetchWorker::removeFromCache()
     }
 }
 
+// Threads:  Ttf
+// Locks:  Mw
+bool LLTextureFetchWorker::canUseRawCache() const
+{
+    // Same textures the J2C cache holds; aux channels are not kept
+    return !mNeedsAux
+        && (mUrl.empty() || mFTType == FTT_SERVER_BAKE)
+        && mFetcher->canLoadFromCache()
+        && mFetcher->mTextureCache->getRawCache()->isEnabled();
+}
+
+// Threads:  Ttf
+// Locks:  Mw
+bool LLTextureFetchWorker::loadFromRawCache()
+{
+    if (mRawCacheState == RAW_CACHE_UNCHECKED)
+    {
+        mRawCacheState = RAW_CACHE_CHECKED;
+        if (!canUseRawCache() || mDesiredDiscard < 0
+            || (mFormattedImage.notNull() && mFormattedImage->getDataSize() > 0))
+        {
+            return false;
+        }
+
+        // The file is read on the work queue; the worker waits in this
+        // state for callbackRawCacheRead(). Request numbers are unique
+        // across workers so a late callback cannot match a newer worker
+        // for the same texture.
+        static std::atomic<U32> s_raw_cache_requests(0);
+        U32 request = ++s_raw_cache_requests;
+        LLTextureFetch* fetcher = mFetcher;
+        LLUUID id = mID;
+        if (!mFetcher->mTextureCache->getRawCache()->readAsync(mID, mDesiredDiscard,
+                [fetcher, id, request](LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time)
+                {
+                    LLTextureFetchWorker* worker = fetcher->getWorker(id);
+                    if (worker)
+                    {
+                        worker->callbackRawCacheRead(request, raw, discard, decode_time);
+                    }
+                }))
+        {
+            record(LLTextureFetch::sRawCacheHitRate, LLUnits::Ratio::fromValue(0));
+            return false;
+        }
+        mRawCacheRequest = request;
+        mRawCacheState = RAW_CACHE_READING;
+        return false;
+    }
+    if (mRawCacheState != RAW_CACHE_LOADED)
+    {
+        return false;
+    }
+
+    mRawCacheState = RAW_CACHE_CHECKED;
+    LLPointer<LLImageRaw> raw = mRawCacheImage;
+    mRawCacheImage = NULL;
+    if (raw.isNull())
+    {
+        record(LLTextureFetch::sRawCacheHitRate, LLUnits::Ratio::fromValue(0));
+        return false;
+    }
+    record(LLTextureFetch::sRawCacheHitRate, LLUnits::Ratio::fromValue(1));
+    add(LLTextureFetch::sRawCacheDecodeSaved, F64Seconds(mRawCacheDecodeTime));
+
+    mRawImage = raw;
+    mAuxImage = NULL;
+    mLoadedDiscard = mRawCacheDiscard;
+    mDecodedDiscard = mRawCacheDiscard;
+    mDecoded = true;
+    mDecodeTime = 0.f;
+    mInCache = true;
+    mWriteToCacheState = NOT_WRITE;
+    LL_DEBUGS(LOG_TXT) << mID << ": Decoded mip cached. Discard: " << mDecodedDiscard
+                       << " Raw Image: " << llformat("%dx%d",mRawImage->getWidth(),mRawImage->getHeight()) << LL_ENDL;
+    return true;
+}
+
+bool LLTextureFetchWorker::planFromLayout()
+{
+    // discard 0 fetches the whole file
+    if (mFormattedImage.isNull() || mFormattedImage->getCodec() != IMG_CODEC_J2C || mDesiredDiscard <= 0)
+    {
+        return false;
+    }
+
+    LLImageDataSharedLock lock(mFormattedImage);
+    LLImageJ2CLayout layout;
+    if (!layout.parse(mFormattedImage->getData(), mFormattedImage->getDataSize()))
+    {
+        return false;
+    }
+
+    S32 exact = layout.getDiscardBytes(mDesiredDiscard);
+    if (exact <= 0)
+    {
+        return false;
+    }
+    if (mFormattedImage->getDataSize() >= exact)
+    {
+        return true;
+    }
+    mPlannedSize = llmax(exact, TEXTURE_CACHE_ENTRY_SIZE);
+    add(LLTextureFetch::sExactRangeRequests, 1);
+    return false;
+}
+
 // <FS:Ansariel> OpenSim compatibility
 //////////////////////////////////////////////////////////////////////////////
 
@@ -2538,6 +2731,21 @@ void LLTextureFetchWorker::callbackCacheRead(bool success, LLImageFormatted* ima
     mLoaded = true;
 }                                                                       // -Mw
 
+// Threads:  T*
+void LLTextureFetchWorker::callbackRawCacheRead(U32 request, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    LLMutexLock lock(&mWorkMutex);                                      // +Mw
+    if (mState != LOAD_FROM_TEXTURE_CACHE || mRawCacheState != RAW_CACHE_READING || mRawCacheRequest != request)
+    {
+        return; // aborted or reinited, ignore
+    }
+    mRawCacheImage = raw;
+    mRawCacheDiscard = discard;
+    mRawCacheDecodeTime = decode_time;
+    mRawCacheState = RAW_CACHE_LOADED;
+}                                                                       // -Mw
+
 // Threads:  Ttc
 void LLTextureFetchWorker::callbackCacheWrite(bool success)
 {
@@ -2686,6 +2894,12 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
       mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
       mHttpMetricsHeaders(),
       mHttpMetricsPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+      mDisableRangeRequests(gSavedSettings, "HttpRangeRequestsDisable", false),
+      mDecodeDisabled(gSavedSettings, "TextureDecodeDisabled", false),
+      mLogToViewerLog(gSavedSettings, "LogTextureDownloadsToViewerLog", false),
+      mLogToSim(gSavedSettings, "LogTextureDownloadsToSimulator", false),
+      mLogTextureTraffic(gSavedSettings, "LogTextureNetworkTraffic", false),
+      mFakeFailureRate(gSavedSettings, "TextureFetchFakeFailureRate", 0.0f),
       mTotalCacheReadCount(0U),
       mTotalCacheWriteCount(0U),
       mTotalResourceWaitCount(0U),
@@ -2721,10 +2935,17 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, bool threaded, bool qa_mod
             sTesterp = NULL;
         }
     }
+
+    std::string trace_file = gSavedSettings.getString("TextureFetchTraceFile");
+    if (!trace_file.empty())
+    {
+        LLTextureFetchTrace::start(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, trace_file));
+    }
 }
 
 LLTextureFetch::~LLTextureFetch()
 {
+    LLTextureFetchTrace::stop();
     clearDeleteList();
 
     while (! mCommands.empty())
@@ -2802,7 +3023,7 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         // If the requester knows the dimensions of the image,
         // this will calculate how much data we need without having to parse the header
 
-        desired_size = LLImageJ2C::calcDataSizeJ2C(w, h, c, desired_discard);
+        desired_size = mByteModel.predict(w, h, c, desired_discard);
     }
     else
     {
@@ -3612,6 +3833,22 @@ void LLTextureFetchWorker::setState(e_state new_state)
     }
 
     mStateTimer.reset();
+
+    if (LLTextureFetchTrace::isRecording())
+    {
+        LLTextureFetchTrace::Record record;
+        record.mID = mID;
+        record.mDesiredSize = mDesiredSize;
+        record.mDataSize = mFormattedImage.notNull() ? mFormattedImage->getDataSize() : 0;
+        record.mFileSize = mFileSize;
+        record.mPriority = mImagePriority;
+        record.mState = (U8)new_state;
+        record.mPrevState = (U8)mState;
+        record.mDiscard = (S8)mDesiredDiscard;
+        record.mType = (U8)mFTType;
+        LLTextureFetchTrace::record(record);
+    }
+
     mState = new_state;
 }
 
@@ -30,8 +30,10 @@
 #include <vector>
 #include <map>
 
+#include "llcontrol.h"
 #include "lldir.h"
 #include "llimage.h"
+#include "llimagej2clayout.h"
 #include "lluuid.h"
 #include "llworkerthread.h"
 #include "lltextureinfo.h"
@@ -326,6 +328,9 @@ public:
     static LLTrace::SampleStatHandle<F32Seconds> sCacheWriteLatency;
     static LLTrace::SampleStatHandle<F32Seconds> sTexFetchLatency;
     static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sCacheHitRate;
+    static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sRawCacheHitRate;
+    static LLTrace::CountStatHandle<F64Seconds> sRawCacheDecodeSaved;
+    static LLTrace::CountStatHandle<> sExactRangeRequests;
 
 private:
     LLMutex mQueueMutex;        //to protect mRequestMap and mCommands only
@@ -348,6 +353,9 @@ private:
     LLTextureInfo mTextureInfo;
     LLTextureInfo mTextureInfoMainThread;
 
+    // Bytes per discard level learned from fetched codestreams
+    LLImageJ2CByteModel mByteModel;
+
     // XXX possible delete
     U32Bits mHTTPTextureBits;                                               // Mfnq
 
@@ -378,6 +386,15 @@ private:
     S32                                 mHttpHighWater;                 // Ttf
     S32                                 mHttpLowWater;                  // Ttf
 
+    // Debug settings the workers read on every request.  Resolved by
+    // the constructor on the main thread, readable from any thread.
+    LLControlHandle<bool>               mDisableRangeRequests;          // T*
+    LLControlHandle<bool>               mDecodeDisabled;                // T*
+    LLControlHandle<bool>               mLogToViewerLog;                // T*
+    LLControlHandle<bool>               mLogToSim;                      // T*
+    LLControlHandle<bool>               mLogTextureTraffic;             // T*
+    LLControlHandle<F32>                mFakeFailureRate;               // T*
+
     // We use a resource semaphore to keep HTTP requests in
     // WAIT_HTTP_RESOURCE2 if there aren't sufficient slots in the
     // transport.  This keeps them near where they can be cheaply
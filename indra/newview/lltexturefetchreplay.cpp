@@ -0,0 +1,424 @@
+/**
+ * @file lltexturefetchreplay.cpp
+ * @brief Plays a texture fetch trace back through the texture cache and
+ * decode threads
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturefetchreplay.h"
+
+#include "llappviewer.h"
+#include "llcallbacklist.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llimagej2c.h"
+#include "llimageworker.h"
+#include "lltexturecache.h"
+
+namespace
+{
+    const char* OP_NAMES[LLTextureFetchReplay::OP_COUNT] =
+    {
+        "cache read",
+        "http",
+        "decode",
+        "cache write"
+    };
+}
+
+LLTextureFetchReplay* LLTextureFetchReplay::sInstance = NULL;
+
+// One texture's operations, run one after the other.  Responders set
+// mFinished from the cache and decode threads; the rest is main thread only.
+class LLTextureFetchReplay::Job : public LLThreadSafeRefCount
+{
+public:
+    Job(const LLUUID& id, std::vector<Op>& ops)
+        : mID(id), mNext(0), mStarted(0), mDue(0), mFinished(0), mSuccess(false),
+          mHandle(LLTextureCache::nullHandle()), mDone(false)
+    {
+        mOps.swap(ops);
+    }
+
+    void finish(bool success)
+    {
+        mSuccess = success;
+        mFinished = LLTimer::getTotalTime();
+    }
+
+    LLUUID mID;
+    std::vector<Op> mOps;
+    size_t mNext;
+    U64 mStarted;                   // 0 until the current op starts
+    U64 mDue;                       // when a replayed HTTP request answers
+    std::atomic<U64> mFinished;     // 0 until the current op completes
+    std::atomic<bool> mSuccess;
+    LLTextureCache::handle_t mHandle;
+    LLPointer<LLImageFormatted> mImage;
+    LLPointer<LLImageRaw> mRaw;
+    bool mDone;
+};
+
+class LLTextureFetchReplay::CacheReadResponder : public LLTextureCache::ReadResponder
+{
+public:
+    CacheReadResponder(Job* job) : mJob(job) {}
+
+    // Threads:  Ttc
+    virtual void completed(bool success)
+    {
+        mJob->mImage = success ? mFormattedImage : LLPointer<LLImageFormatted>();
+        mJob->finish(success);
+    }
+private:
+    LLPointer<Job> mJob;
+};
+
+class LLTextureFetchReplay::CacheWriteResponder : public LLTextureCache::WriteResponder
+{
+public:
+    CacheWriteResponder(Job* job) : mJob(job) {}
+
+    // Threads:  Ttc
+    virtual void completed(bool success)
+    {
+        mJob->finish(success);
+    }
+private:
+    LLPointer<Job> mJob;
+};
+
+class LLTextureFetchReplay::DecodeResponder : public LLImageDecodeThread::Responder
+{
+public:
+    DecodeResponder(Job* job) : mJob(job) {}
+
+    // Threads:  Tid
+    virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id)
+    {
+        mJob->mRaw = success ? raw : NULL;
+        mJob->finish(success && raw);
+    }
+private:
+    LLPointer<Job> mJob;
+};
+
+//static
+void LLTextureFetchReplay::buildOps(const std::vector<LLTextureFetchTrace::Record>& records,
+                                    std::map<LLUUID, std::vector<Op> >& ops)
+{
+    // Index of the last record seen for each texture, to time HTTP requests
+    // by the state change that ended them
+    std::map<LLUUID, size_t> last;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const LLTextureFetchTrace::Record& record = records[i];
+        std::vector<Op>& texture_ops = ops[record.mID];
+
+        std::map<LLUUID, size_t>::iterator prev = last.find(record.mID);
+        if (prev != last.end() && records[prev->second].mState == LLTextureFetchTrace::WAIT_HTTP_REQ
+            && !texture_ops.empty() && texture_ops.back().mType == OP_HTTP)
+        {
+            Op& http = texture_ops.back();
+            http.mLatency = record.mTime - http.mTime;
+            http.mSize = llmax(http.mSize, record.mDataSize);
+            http.mFileSize = llmax(http.mFileSize, record.mFileSize);
+        }
+        last[record.mID] = i;
+
+        Op op;
+        op.mTime = record.mTime - records.front().mTime;
+        op.mLatency = 0;
+        op.mSize = record.mDesiredSize;
+        op.mFileSize = record.mFileSize;
+        op.mDiscard = record.mDiscard;
+        switch (record.mState)
+        {
+        case LLTextureFetchTrace::LOAD_FROM_TEXTURE_CACHE:
+            op.mType = OP_CACHE_READ;
+            break;
+        case LLTextureFetchTrace::WAIT_HTTP_REQ:
+            op.mType = OP_HTTP;
+            break;
+        case LLTextureFetchTrace::DECODE_IMAGE:
+            op.mType = OP_DECODE;
+            break;
+        case LLTextureFetchTrace::WRITE_TO_CACHE:
+            op.mType = OP_CACHE_WRITE;
+            break;
+        default:
+            continue;
+        }
+        texture_ops.push_back(op);
+    }
+}
+
+//static
+bool LLTextureFetchReplay::start(const std::string& trace_file, const std::string& asset_dir, F32 speed)
+{
+    if (sInstance)
+    {
+        LL_WARNS("Texture") << "Texture fetch replay already running" << LL_ENDL;
+        return false;
+    }
+
+    std::vector<LLTextureFetchTrace::Record> records;
+    if (!LLTextureFetchTrace::read(trace_file, records))
+    {
+        LL_WARNS("Texture") << "Could not read texture fetch trace " << trace_file << LL_ENDL;
+        return false;
+    }
+
+    std::map<LLUUID, std::vector<Op> > ops;
+    buildOps(records, ops);
+
+    LLTextureFetchReplay* replay = new LLTextureFetchReplay(asset_dir, speed);
+    for (auto& texture_ops : ops)
+    {
+        if (!texture_ops.second.empty())
+        {
+            replay->mJobs.push_back(new Job(texture_ops.first, texture_ops.second));
+        }
+    }
+    replay->mTextures = (U32)replay->mJobs.size();
+
+    LL_INFOS("Texture") << "Replaying " << records.size() << " texture fetch state changes for "
+                        << replay->mTextures << " textures from " << trace_file << LL_ENDL;
+    sInstance = replay;
+    gIdleCallbacks.addFunction(onIdle, replay);
+    return true;
+}
+
+LLTextureFetchReplay::LLTextureFetchReplay(const std::string& asset_dir, F32 speed)
+    : mCache(LLAppViewer::getTextureCache()),
+      mDecodeThread(LLAppViewer::getImageDecodeThread()),
+      mAssetDir(asset_dir),
+      mSpeed(llmax(speed, 0.f)),
+      mTextures(0),
+      mMissingAssets(0)
+{
+}
+
+LLTextureFetchReplay::~LLTextureFetchReplay()
+{
+    sInstance = NULL;
+}
+
+//static
+void LLTextureFetchReplay::onIdle(void* data)
+{
+    LLTextureFetchReplay* self = (LLTextureFetchReplay*)data;
+    if (!self->update())
+    {
+        self->report();
+        gIdleCallbacks.deleteFunction(onIdle, data);
+        delete self;
+    }
+}
+
+bool LLTextureFetchReplay::update()
+{
+    const U64 now = (U64)(mTimer.getElapsedTimeF64().value() * 1000000.0);
+    bool pending = false;
+    for (LLPointer<Job>& job : mJobs)
+    {
+        while (!job->mDone)
+        {
+            if (job->mNext >= job->mOps.size())
+            {
+                job->mDone = true;
+                break;
+            }
+            const Op& op = job->mOps[job->mNext];
+            if (!job->mStarted)
+            {
+                if ((U64)(op.mTime * mSpeed) > now)
+                {
+                    break;
+                }
+                job->mStarted = LLTimer::getTotalTime();
+                job->mFinished = 0;
+                if (!startOp(*job, op))
+                {
+                    // Nothing left worth replaying for this texture
+                    ++mStats[op.mType].mFailed;
+                    job->mDone = true;
+                    break;
+                }
+            }
+            if (!finishOp(*job, op))
+            {
+                break;
+            }
+            job->mStarted = 0;
+            ++job->mNext;
+        }
+        pending = pending || !job->mDone;
+    }
+    return pending;
+}
+
+bool LLTextureFetchReplay::startOp(Job& job, const Op& op)
+{
+    switch (op.mType)
+    {
+    case OP_CACHE_READ:
+        job.mHandle = mCache->readFromCache(job.mID, 0, op.mSize, new CacheReadResponder(&job));
+        return true;
+    case OP_HTTP:
+        job.mDue = job.mStarted + (U64)(op.mLatency * mSpeed);
+        return readAsset(job, op);
+    case OP_DECODE:
+        if (job.mImage.isNull() || !job.mImage->getDataSize())
+        {
+            return false;
+        }
+        mDecodeThread->decodeImage(job.mImage, op.mDiscard, false, new DecodeResponder(&job));
+        return true;
+    case OP_CACHE_WRITE:
+        if (job.mImage.isNull() || job.mRaw.isNull())
+        {
+            return false;
+        }
+        job.mHandle = mCache->writeToCache(job.mID, job.mImage->getData(), job.mImage->getDataSize(),
+                                           llmax(op.mFileSize, job.mImage->getDataSize()), job.mRaw,
+                                           op.mDiscard, new CacheWriteResponder(&job));
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool LLTextureFetchReplay::finishOp(Job& job, const Op& op)
+{
+    Stats& stats = mStats[op.mType];
+    if (op.mType == OP_HTTP)
+    {
+        // Answered from disk in startOp; only the recorded latency remains
+        if (LLTimer::getTotalTime() < job.mDue)
+        {
+            return false;
+        }
+        ++stats.mCount;
+        stats.mSeconds += op.mLatency / 1000000.0;
+        return true;
+    }
+
+    const U64 finished = job.mFinished;
+    if (!finished)
+    {
+        return false;
+    }
+    if (op.mType == OP_CACHE_READ)
+    {
+        mCache->readComplete(job.mHandle, false);
+    }
+    else if (op.mType == OP_CACHE_WRITE && !mCache->writeComplete(job.mHandle))
+    {
+        return false;
+    }
+    job.mHandle = LLTextureCache::nullHandle();
+
+    ++stats.mCount;
+    stats.mSeconds += (finished - job.mStarted) / 1000000.0;
+    if (!job.mSuccess)
+    {
+        ++stats.mFailed;
+    }
+    else if (op.mType == OP_DECODE)
+    {
+        stats.mPixels += (F64)job.mRaw->getWidth() * job.mRaw->getHeight();
+        stats.mBytes += job.mImage->getDataSize();
+    }
+    else if (job.mImage.notNull())
+    {
+        stats.mBytes += job.mImage->getDataSize();
+    }
+    return true;
+}
+
+bool LLTextureFetchReplay::readAsset(Job& job, const Op& op)
+{
+    const S32 offset = job.mImage.notNull() ? job.mImage->getDataSize() : 0;
+    const std::string filename = mAssetDir + gDirUtilp->getDirDelimiter() + job.mID.asString() + ".j2c";
+    LLUniqueFile file(LLFile::fopen(filename, "rb"));
+    if (!file)
+    {
+        ++mMissingAssets;
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const S32 file_size = (S32)ftell(file);
+    const S32 size = llmin(op.mSize, file_size) - offset;
+    if (size <= 0)
+    {
+        // Already had everything the request returned
+        return true;
+    }
+
+    U8* data = (U8*)ll_aligned_malloc_16(size);
+    if (!data)
+    {
+        return false;
+    }
+    fseek(file, offset, SEEK_SET);
+    if (fread(data, 1, size, file) != (size_t)size)
+    {
+        ll_aligned_free_16(data);
+        return false;
+    }
+
+    if (job.mImage.isNull())
+    {
+        job.mImage = new LLImageJ2C;
+        job.mImage->setData(data, size);
+    }
+    else
+    {
+        job.mImage->appendData(data, size);
+    }
+    mStats[OP_HTTP].mBytes += size;
+    return true;
+}
+
+void LLTextureFetchReplay::report() const
+{
+    LL_INFOS("Texture") << "Texture fetch replay of " << mTextures << " textures finished in "
+                        << mTimer.getElapsedTimeF64().value() << "s at speed " << mSpeed
+                        << ", " << mMissingAssets << " assets missing" << LL_ENDL;
+    for (S32 i = 0; i < OP_COUNT; ++i)
+    {
+        const Stats& stats = mStats[i];
+        LL_INFOS("Texture") << OP_NAMES[i] << ": " << stats.mCount << " done, " << stats.mFailed << " failed, "
+                            << stats.mBytes / 1024 << " KB, average "
+                            << (stats.mCount ? stats.mSeconds * 1000.0 / stats.mCount : 0.0) << " ms";
+        if (i == OP_DECODE && stats.mPixels > 0.0)
+        {
+            LL_CONT << ", " << stats.mSeconds * 1000.0 / (stats.mPixels / 1000000.0) << " ms/MP";
+        }
+        LL_CONT << LL_ENDL;
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file lltexturefetchreplay.h
+ * @brief Plays a texture fetch trace back through the texture cache and
+ * decode threads
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREFETCHREPLAY_H
+#define LL_LLTEXTUREFETCHREPLAY_H
+
+#include "lltexturefetchtrace.h"
+#include "lltimer.h"
+
+class LLTextureCache;
+class LLImageDecodeThread;
+
+// Replays a trace recorded by LLTextureFetchTrace without a grid: the
+// cache reads, decodes and cache writes it recorded are issued to the
+// texture cache and decode threads, and a directory of asset files named
+// <uuid>.j2c stands in for the texture HTTP service, answering each request
+// after the latency recorded for it.  Cache and decode times are measured;
+// the totals are logged when the replay ends.
+//
+// Started from the login screen with --texturefetchreplay <trace> and
+// --texturefetchreplayassets <dir>.  TextureFetchReplaySpeed scales the
+// recorded timeline; 0 replays as fast as the pipeline allows.
+class LLTextureFetchReplay
+{
+public:
+    enum EOp
+    {
+        OP_CACHE_READ = 0,
+        OP_HTTP,
+        OP_DECODE,
+        OP_CACHE_WRITE,
+        OP_COUNT
+    };
+
+    struct Op
+    {
+        EOp mType;
+        U64 mTime;          // microseconds into the trace
+        U64 mLatency;       // recorded time for HTTP requests
+        S32 mSize;          // bytes to read, or to have after the request
+        S32 mFileSize;
+        S8 mDiscard;
+    };
+
+    // Turns the state changes of a trace into the operations to replay, in
+    // order for each texture
+    static void buildOps(const std::vector<LLTextureFetchTrace::Record>& records,
+                         std::map<LLUUID, std::vector<Op> >& ops);
+
+    // Starts replaying trace_file; false if it cannot be read
+    static bool start(const std::string& trace_file, const std::string& asset_dir, F32 speed);
+    static bool isRunning() { return sInstance != NULL; }
+
+private:
+    class Job;
+    class CacheReadResponder;
+    class CacheWriteResponder;
+    class DecodeResponder;
+
+    struct Stats
+    {
+        U32 mCount = 0;
+        U32 mFailed = 0;
+        S64 mBytes = 0;
+        F64 mPixels = 0.0;
+        F64 mSeconds = 0.0;
+    };
+
+    LLTextureFetchReplay(const std::string& asset_dir, F32 speed);
+    ~LLTextureFetchReplay();
+
+    static void onIdle(void* data);
+    // Returns false once every job is done
+    bool update();
+    bool startOp(Job& job, const Op& op);
+    bool finishOp(Job& job, const Op& op);
+    bool readAsset(Job& job, const Op& op);
+    void report() const;
+
+    static LLTextureFetchReplay* sInstance;
+
+    LLTextureCache* mCache;
+    LLImageDecodeThread* mDecodeThread;
+    std::string mAssetDir;
+    F32 mSpeed;
+    LLTimer mTimer;
+    std::vector<LLPointer<Job> > mJobs;
+    U32 mTextures;
+    U32 mMissingAssets;
+    Stats mStats[OP_COUNT];
+};
+
+#endif // LL_LLTEXTUREFETCHREPLAY_H
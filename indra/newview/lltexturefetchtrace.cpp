@@ -0,0 +1,144 @@
+/**
+ * @file lltexturefetchtrace.cpp
+ * @brief Binary trace of texture fetch worker state changes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturefetchtrace.h"
+
+#include "llfile.h"
+#include "llmutex.h"
+#include "lltimer.h"
+
+static_assert(sizeof(LLTextureFetchTrace::Record) == 48, "trace records are written as is");
+
+namespace
+{
+    const char TRACE_MAGIC[8] = { 'L', 'L', 'T', 'F', 'T', 'R', 'C', 0 };
+
+    // Records are buffered and written in blocks of this many
+    const size_t FLUSH_RECORDS = 1024;
+
+    LLMutex sTraceMutex;
+    LLFILE* sTraceFile = NULL;
+    U64 sTraceStart = 0;
+    std::vector<LLTextureFetchTrace::Record> sTraceBuffer;
+}
+
+std::atomic<bool> LLTextureFetchTrace::sRecording(false);
+
+//static
+bool LLTextureFetchTrace::start(const std::string& filename)
+{
+    stop();
+
+    LLMutexLock lock(&sTraceMutex);
+    sTraceFile = LLFile::fopen(filename, "wb");
+    if (!sTraceFile)
+    {
+        LL_WARNS("Texture") << "Could not open texture fetch trace " << filename << LL_ENDL;
+        return false;
+    }
+
+    Header header;
+    memcpy(header.mMagic, TRACE_MAGIC, sizeof(header.mMagic)); /* Flawfinder: ignore */
+    header.mVersion = VERSION;
+    header.mRecordSize = sizeof(Record);
+    fwrite(&header, sizeof(header), 1, sTraceFile);
+
+    sTraceStart = LLTimer::getTotalTime();
+    sTraceBuffer.reserve(FLUSH_RECORDS);
+    sRecording = true;
+    LL_INFOS("Texture") << "Recording texture fetch trace to " << filename << LL_ENDL;
+    return true;
+}
+
+//static
+void LLTextureFetchTrace::stop()
+{
+    LLMutexLock lock(&sTraceMutex);
+    sRecording = false;
+    if (sTraceFile)
+    {
+        flush();
+        LLFile::close(sTraceFile);
+        sTraceFile = NULL;
+    }
+}
+
+//static
+void LLTextureFetchTrace::record(Record& record)
+{
+    LLMutexLock lock(&sTraceMutex);
+    if (!sTraceFile)
+    {
+        return;
+    }
+    record.mTime = LLTimer::getTotalTime() - sTraceStart;
+    record.mReserved = 0;
+    sTraceBuffer.push_back(record);
+    if (sTraceBuffer.size() >= FLUSH_RECORDS)
+    {
+        flush();
+    }
+}
+
+//static
+void LLTextureFetchTrace::flush()
+{
+    if (!sTraceBuffer.empty())
+    {
+        fwrite(sTraceBuffer.data(), sizeof(Record), sTraceBuffer.size(), sTraceFile);
+        sTraceBuffer.clear();
+    }
+}
+
+//static
+bool LLTextureFetchTrace::read(const std::string& filename, std::vector<Record>& records)
+{
+    records.clear();
+    LLUniqueFile file(LLFile::fopen(filename, "rb"));
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.mMagic, TRACE_MAGIC, sizeof(header.mMagic))
+        || header.mVersion != VERSION
+        || header.mRecordSize != sizeof(Record))
+    {
+        LL_WARNS("Texture") << filename << " is not a texture fetch trace" << LL_ENDL;
+        return false;
+    }
+
+    Record record;
+    while (fread(&record, sizeof(record), 1, file) == 1)
+    {
+        records.push_back(record);
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file lltexturefetchtrace.h
+ * @brief Binary trace of texture fetch worker state changes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREFETCHTRACE_H
+#define LL_LLTEXTUREFETCHTRACE_H
+
+#include "lluuid.h"
+
+#include <atomic>
+
+// Records every LLTextureFetchWorker state change, with its time, sizes and
+// priority, for LLTextureFetchReplay to play back offline.  Turned on with
+// the TextureFetchTraceFile setting (--texturefetchtrace).
+//
+// The file is a Header followed by Records, in native byte order.  Thread
+// safe: workers record from the fetch, cache and decode threads.
+class LLTextureFetchTrace
+{
+public:
+    // Mirrors LLTextureFetchWorker::e_state, which lltexturefetch.cpp checks
+    enum EState
+    {
+        INVALID = 0,
+        INIT,
+        LOAD_FROM_TEXTURE_CACHE,
+        CACHE_POST,
+        LOAD_FROM_NETWORK,
+        LOAD_FROM_SIMULATOR,
+        WAIT_HTTP_RESOURCE,
+        WAIT_HTTP_RESOURCE2,
+        SEND_HTTP_REQ,
+        WAIT_HTTP_REQ,
+        DECODE_IMAGE,
+        DECODE_IMAGE_UPDATE,
+        WRITE_TO_CACHE,
+        WAIT_ON_WRITE,
+        DONE
+    };
+
+    struct Header
+    {
+        char mMagic[8];
+        U32 mVersion;
+        U32 mRecordSize;
+    };
+
+    struct Record
+    {
+        U64 mTime;          // microseconds since recording started
+        LLUUID mID;
+        S32 mDesiredSize;   // bytes wanted for mDiscard
+        S32 mDataSize;      // bytes of the formatted image held
+        S32 mFileSize;      // size of the whole asset, 0 if not known yet
+        F32 mPriority;
+        U8 mState;          // EState entered
+        U8 mPrevState;      // EState left
+        S8 mDiscard;        // desired discard level
+        U8 mType;           // FTType
+        U32 mReserved;
+    };
+
+    static const U32 VERSION = 1;
+
+    static bool start(const std::string& filename);
+    static void stop();
+    static bool isRecording() { return sRecording; }
+
+    // Stamps record with the current time and appends it
+    static void record(Record& record);
+
+    // Reads a whole trace; returns false if filename is not one
+    static bool read(const std::string& filename, std::vector<Record>& records);
+
+private:
+    static void flush();
+
+    static std::atomic<bool> sRecording;
+};
+
+#endif // LL_LLTEXTUREFETCHTRACE_H
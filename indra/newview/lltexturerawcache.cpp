@@ -0,0 +1,492 @@
+/**
+ * @file lltexturerawcache.cpp
+ * @brief Disk cache of decoded texture mips, kept next to the J2C texture cache.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturerawcache.h"
+
+#include "cpubudget.h"
+#include "lldir.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llimage.h"
+#include "workqueue.h"
+
+#include <boost/filesystem.hpp>
+
+#ifdef LL_USESYSTEMLIBS
+#include <zlib.h>
+#else
+#include "zlib-ng/zlib.h"
+#endif
+
+static const char* RAW_CACHE_EXTENSION = ".raw";
+static const U32 RAW_CACHE_MAGIC = 0x4d52534c; // "LSRM"
+static const U32 RAW_CACHE_VERSION = 1;
+
+// Below this the J2C decode is cheap and the fast cache covers the texture
+static const S32 RAW_CACHE_MIN_DATA_SIZE = 64 * 64 * 3;
+
+// Fraction of the maximum size to shrink to once it is exceeded, so that
+// eviction does not run on every write
+static const S64 RAW_CACHE_EVICT_PERCENT = 90;
+
+// Eviction order is rebuilt from the files' modification times at startup,
+// so hits touch the file, but no more often than this to spare the disk
+static const U32 RAW_CACHE_TOUCH_SECONDS = 60 * 60;
+
+struct LLTextureRawCacheHeader
+{
+    U32 mMagic;
+    U32 mVersion;
+    U16 mWidth;
+    U16 mHeight;
+    S8  mComponents;
+    S8  mDiscard;
+    U8  mCompressed;
+    U8  mPad;
+    S32 mDataSize;      // LLImageRaw bytes
+    S32 mStoredSize;    // bytes following the header
+    F32 mDecodeTime;    // seconds the J2C decode took
+};
+
+LLTextureRawCache::LLTextureRawCache()
+:   mMutex(),
+    mReadOnly(true),
+    mCompress(true),
+    mMaxSize(0),
+    mTotalSize(0),
+    mLookups(0),
+    mHits(0),
+    mDecodeUsecSaved(0)
+{
+}
+
+LLTextureRawCache::~LLTextureRawCache()
+{
+    if (mLookups)
+    {
+        LL_INFOS("TextureCache") << "Decoded mip cache: " << mHits << " hits in " << mLookups << " lookups, "
+                                 << getDecodeTimeSaved() << " seconds of decoding saved" << LL_ENDL;
+    }
+}
+
+void LLTextureRawCache::init(const std::string& dirname, S64 max_size, bool compress, bool read_only)
+{
+    LLMutexLock lock(&mMutex);
+
+    mDirName = dirname;
+    mMaxSize = max_size;
+    mCompress = compress;
+    mReadOnly = read_only;
+    mEntries.clear();
+    mTotalSize = 0;
+
+    if (!isEnabled())
+    {
+        return;
+    }
+    if (!mReadOnly && !LLFile::isdir(mDirName))
+    {
+        LLFile::mkdir(mDirName);
+    }
+
+    LLDirIterator iter(mDirName, std::string("*") + RAW_CACHE_EXTENSION);
+    std::string filename;
+    while (iter.next(filename))
+    {
+        std::string id_string = filename.substr(0, filename.length() - strlen(RAW_CACHE_EXTENSION));
+        llstat file_status;
+        if (!LLUUID::validate(id_string) || LLFile::stat(mDirName + gDirUtilp->getDirDelimiter() + filename, &file_status))
+        {
+            continue;
+        }
+        Entry& entry = mEntries[LLUUID(id_string)];
+        entry.mDiscard = -1;
+        entry.mFileSize = (S32)file_status.st_size;
+        entry.mTime = (U32)file_status.st_mtime;
+        entry.mFileTime = entry.mTime;
+        mTotalSize += entry.mFileSize;
+    }
+
+    if (!mReadOnly && mTotalSize > mMaxSize)
+    {
+        evict(mMaxSize * RAW_CACHE_EVICT_PERCENT / 100);
+    }
+
+    LL_INFOS("TextureCache") << "Decoded mips: " << mEntries.size() << " files, "
+                             << mTotalSize / (1024 * 1024) << " of " << mMaxSize / (1024 * 1024) << " MB" << LL_ENDL;
+}
+
+void LLTextureRawCache::purge(const std::string& dirname, bool remove_dir)
+{
+    LLMutexLock lock(&mMutex);
+
+    if (LLFile::isdir(dirname))
+    {
+        LL_INFOS() << "Deleting files in directory: " << dirname << LL_ENDL;
+        gDirUtilp->deleteFilesInDir(dirname, "*");
+        if (remove_dir)
+        {
+            LLFile::rmdir(dirname);
+        }
+    }
+    mEntries.clear();
+    mTotalSize = 0;
+}
+
+std::string LLTextureRawCache::getFileName(const LLUUID& id) const
+{
+    return mDirName + gDirUtilp->getDirDelimiter() + id.asString() + RAW_CACHE_EXTENSION;
+}
+
+bool LLTextureRawCache::readAsync(const LLUUID& id, S32 max_discard, const read_callback_t& callback)
+{
+    if (!isEnabled())
+    {
+        return false;
+    }
+    ++mLookups;
+
+    {
+        LLMutexLock lock(&mMutex);
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter == mEntries.end() || iter->second.mDiscard > max_discard)
+        {
+            return false;
+        }
+    }
+
+    // Reading and inflating a mip takes a while, so keep it off the fetch
+    // thread, the same way writes go.
+    LL::WorkQueue::ptr_t queue = LL::WorkQueue::getInstance("General");
+    std::weak_ptr<LLTextureRawCache> cache = weak_from_this();
+    return queue && queue->tryPost([cache, id, max_discard, callback]()
+        {
+            if (std::shared_ptr<LLTextureRawCache> self = cache.lock())
+            {
+                LL::CpuBudget::Blocking blocking;
+                S32 discard = -1;
+                F32 decode_time = 0.f;
+                LLPointer<LLImageRaw> raw = self->read(id, max_discard, discard, decode_time);
+                callback(raw, discard, decode_time);
+            }
+        });
+}
+
+LLPointer<LLImageRaw> LLTextureRawCache::read(const LLUUID& id, S32 max_discard, S32& discard, F32& decode_time)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    {
+        LLMutexLock lock(&mMutex);
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter == mEntries.end() || iter->second.mDiscard > max_discard)
+        {
+            return NULL;
+        }
+    }
+
+    std::string filename = getFileName(id);
+    LLFILE* fp = LLFile::fopen(filename, "rb");
+    if (!fp)
+    {
+        LLMutexLock lock(&mMutex);
+        if (!mPendingWrites.count(id))
+        {
+            removeEntry(id);
+        }
+        return NULL;
+    }
+
+    LLTextureRawCacheHeader header;
+    bool valid = fread(&header, sizeof(header), 1, fp) == 1
+        && header.mMagic == RAW_CACHE_MAGIC
+        && header.mVersion == RAW_CACHE_VERSION
+        && header.mComponents >= 1 && header.mComponents <= 4
+        && header.mDiscard >= 0
+        && header.mDataSize == (S32)header.mWidth * header.mHeight * header.mComponents
+        && header.mStoredSize > 0
+        && (header.mCompressed ? (uLong)header.mStoredSize <= compressBound(header.mDataSize) : header.mStoredSize == header.mDataSize);
+
+    if (valid && header.mDiscard > max_discard)
+    {
+        // Only the header was unknown; the file is fine
+        fclose(fp);
+        LLMutexLock lock(&mMutex);
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter != mEntries.end())
+        {
+            iter->second.mDiscard = header.mDiscard;
+        }
+        return NULL;
+    }
+
+    LLPointer<LLImageRaw> raw;
+    if (valid)
+    {
+        raw = new LLImageRaw(header.mWidth, header.mHeight, header.mComponents);
+        if (!raw->getData())
+        {
+            // Out of memory rather than a bad file
+            fclose(fp);
+            return NULL;
+        }
+        if (header.mCompressed)
+        {
+            std::vector<U8> stored(header.mStoredSize);
+            uLongf size = header.mDataSize;
+            valid = fread(stored.data(), header.mStoredSize, 1, fp) == 1
+                && uncompress(raw->getData(), &size, stored.data(), header.mStoredSize) == Z_OK
+                && size == (uLongf)header.mDataSize;
+        }
+        else
+        {
+            valid = fread(raw->getData(), header.mDataSize, 1, fp) == 1;
+        }
+    }
+    fclose(fp);
+
+    LLMutexLock lock(&mMutex);
+    if (!valid)
+    {
+        LL_WARNS("TextureCache") << "Removing corrupted decoded mip " << id << LL_ENDL;
+        if (!mPendingWrites.count(id))
+        {
+            removeEntry(id);
+        }
+        return NULL;
+    }
+
+    bool touch = false;
+    entry_map_t::iterator iter = mEntries.find(id);
+    if (iter != mEntries.end())
+    {
+        Entry& entry = iter->second;
+        entry.mDiscard = header.mDiscard;
+        entry.mTime = (U32)time(NULL);
+        if (!mReadOnly && entry.mTime - entry.mFileTime >= RAW_CACHE_TOUCH_SECONDS)
+        {
+            entry.mFileTime = entry.mTime;
+            touch = true;
+        }
+    }
+    ++mHits;
+    mDecodeUsecSaved += (U64)(header.mDecodeTime * 1000000.f);
+
+    discard = header.mDiscard;
+    decode_time = header.mDecodeTime;
+
+    if (touch)
+    {
+        boost::system::error_code ec;
+#if LL_WINDOWS
+        boost::filesystem::last_write_time(boost::filesystem::path(utf8str_to_utf16str(filename)), (std::time_t)time(NULL), ec);
+#else
+        boost::filesystem::last_write_time(boost::filesystem::path(filename), (std::time_t)time(NULL), ec);
+#endif
+        if (ec.failed())
+        {
+            LL_DEBUGS("TextureCache") << "Failed to touch decoded mip " << filename << ": " << ec.message() << LL_ENDL;
+        }
+    }
+    return raw;
+}
+
+void LLTextureRawCache::write(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time)
+{
+    if (!isEnabled() || mReadOnly || raw.isNull() || discard < 0)
+    {
+        return;
+    }
+
+    // Large mips would crowd out everything else in the tier
+    S32 data_size = raw->getDataSize();
+    if (data_size < RAW_CACHE_MIN_DATA_SIZE || data_size > mMaxSize / 16)
+    {
+        return;
+    }
+
+    {
+        LLMutexLock lock(&mMutex);
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter != mEntries.end() && iter->second.mDiscard >= 0 && iter->second.mDiscard <= discard)
+        {
+            return;
+        }
+        if (!mPendingWrites.insert(id).second)
+        {
+            return;
+        }
+    }
+
+    // Compressing and writing a large mip takes a while, so keep it off the
+    // fetch thread. Skipping a write only costs a decode next session.
+    LL::WorkQueue::ptr_t queue = LL::WorkQueue::getInstance("General");
+    std::weak_ptr<LLTextureRawCache> cache = weak_from_this();
+    if (!queue || !queue->tryPost([cache, id, raw, discard, decode_time]()
+        {
+            if (std::shared_ptr<LLTextureRawCache> self = cache.lock())
+            {
+                LL::CpuBudget::Blocking blocking;
+                self->doWrite(id, raw, discard, decode_time);
+            }
+        }))
+    {
+        LLMutexLock lock(&mMutex);
+        mPendingWrites.erase(id);
+    }
+}
+
+void LLTextureRawCache::doWrite(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::string filename = getFileName(id);
+    std::string temp_filename = filename + ".tmp";
+    bool written = false;
+    S32 file_size = 0;
+    {
+        LLImageDataSharedLock lock(raw);
+
+        LLTextureRawCacheHeader header;
+        header.mMagic = RAW_CACHE_MAGIC;
+        header.mVersion = RAW_CACHE_VERSION;
+        header.mWidth = raw->getWidth();
+        header.mHeight = raw->getHeight();
+        header.mComponents = raw->getComponents();
+        header.mDiscard = (S8)discard;
+        header.mCompressed = 0;
+        header.mPad = 0;
+        header.mDataSize = raw->getDataSize();
+        header.mStoredSize = header.mDataSize;
+        header.mDecodeTime = decode_time;
+
+        const U8* data = raw->getData();
+        std::vector<U8> compressed;
+        if (mCompress && data)
+        {
+            uLongf size = compressBound(header.mDataSize);
+            compressed.resize(size);
+            if (compress2(compressed.data(), &size, data, header.mDataSize, Z_BEST_SPEED) == Z_OK
+                && size < (uLongf)header.mDataSize)
+            {
+                header.mCompressed = 1;
+                header.mStoredSize = (S32)size;
+                data = compressed.data();
+            }
+        }
+
+        LLFILE* fp = data ? LLFile::fopen(temp_filename, "wb") : NULL;
+        if (fp)
+        {
+            written = fwrite(&header, sizeof(header), 1, fp) == 1
+                && fwrite(data, header.mStoredSize, 1, fp) == 1;
+            written = (fclose(fp) == 0) && written;
+            file_size = sizeof(header) + header.mStoredSize;
+        }
+    }
+
+    LLMutexLock lock(&mMutex);
+    mPendingWrites.erase(id);
+    if (written)
+    {
+#if LL_WINDOWS
+        // rename() does not replace an existing file on Windows
+        LLFile::remove(filename, ENOENT);
+#endif
+        written = LLFile::rename(temp_filename, filename) == 0;
+    }
+    if (!written)
+    {
+        LLFile::remove(temp_filename, ENOENT);
+        return;
+    }
+
+    Entry& entry = mEntries[id];
+    mTotalSize += file_size - entry.mFileSize;
+    entry.mDiscard = discard;
+    entry.mFileSize = file_size;
+    entry.mTime = (U32)time(NULL);
+    entry.mFileTime = entry.mTime;
+
+    if (mTotalSize > mMaxSize)
+    {
+        evict(mMaxSize * RAW_CACHE_EVICT_PERCENT / 100);
+    }
+}
+
+void LLTextureRawCache::remove(const LLUUID& id)
+{
+    if (!isEnabled() || mReadOnly)
+    {
+        return;
+    }
+    LLMutexLock lock(&mMutex);
+    removeEntry(id);
+}
+
+void LLTextureRawCache::removeEntry(const LLUUID& id)
+{
+    entry_map_t::iterator iter = mEntries.find(id);
+    if (iter == mEntries.end())
+    {
+        return;
+    }
+    mTotalSize -= iter->second.mFileSize;
+    mEntries.erase(iter);
+    if (!mReadOnly)
+    {
+        LLFile::remove(getFileName(id), ENOENT);
+    }
+}
+
+void LLTextureRawCache::evict(S64 target_size)
+{
+    typedef std::pair<U32, LLUUID> time_id_t;
+    std::vector<time_id_t> by_time;
+    by_time.reserve(mEntries.size());
+    for (const entry_map_t::value_type& entry : mEntries)
+    {
+        by_time.emplace_back(entry.second.mTime, entry.first);
+    }
+    std::sort(by_time.begin(), by_time.end());
+
+    S32 evicted = 0;
+    for (const time_id_t& oldest : by_time)
+    {
+        if (mTotalSize <= target_size)
+        {
+            break;
+        }
+        if (!mPendingWrites.count(oldest.second))
+        {
+            removeEntry(oldest.second);
+            ++evicted;
+        }
+    }
+    LL_DEBUGS("TextureCache") << "Evicted " << evicted << " decoded mips, " << mTotalSize << " bytes left" << LL_ENDL;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file lltexturerawcache.h
+ * @brief Disk cache of decoded texture mips, kept next to the J2C texture cache.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTURERAWCACHE_H
+#define LL_LLTEXTURERAWCACHE_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+
+#include "llmutex.h"
+#include "llpointer.h"
+#include "lluuid.h"
+
+class LLImageRaw;
+
+// Second texture cache tier holding LLImageRaw mips exactly as the decoder
+// produced them, so textures seen in earlier sessions skip the J2C decode.
+// One file per texture in <texturecache>/rawmips, keeping the best (lowest)
+// discard level decoded so far, optionally zlib compressed. The total size
+// is bounded and the least recently used files are evicted first; a hit
+// refreshes the file's modification time (at most hourly) so that the order
+// survives a restart.
+//
+// Only the index lookup runs on the calling thread (the texture fetch
+// thread); file reads and writes are handed to the "General" work queue.
+class LLTextureRawCache : public std::enable_shared_from_this<LLTextureRawCache>
+{
+public:
+    LLTextureRawCache();
+    ~LLTextureRawCache();
+
+    // Indexes the files already in dirname. max_size is in bytes; zero
+    // disables the tier.
+    void init(const std::string& dirname, S64 max_size, bool compress, bool read_only);
+    // Removes every cached mip in dirname, and the directory itself if
+    // remove_dir. The caller checks the cache is writable.
+    void purge(const std::string& dirname, bool remove_dir);
+
+    // raw is null when the file turned out to be missing, stale or corrupt.
+    typedef std::function<void(LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time)> read_callback_t;
+
+    // Queues a read of the cached mip for id if its discard level may be
+    // max_discard or better. callback runs on the work queue with the mip
+    // and the time the original decode took. Returns false, and never calls
+    // callback, when nothing usable is cached or the queue is busy.
+    bool readAsync(const LLUUID& id, S32 max_discard, const read_callback_t& callback);
+    // Queues raw for writing unless an equal or better mip is already cached.
+    void write(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time);
+    void remove(const LLUUID& id);
+
+    bool isEnabled() const { return mMaxSize > 0; }
+    S64 getUsage() const { return mTotalSize; }
+    S64 getMaxUsage() const { return mMaxSize; }
+    U64 getLookups() const { return mLookups; }
+    U64 getHits() const { return mHits; }
+    F64 getDecodeTimeSaved() const { return (F64)mDecodeUsecSaved / 1000000.0; }
+
+private:
+    struct Entry
+    {
+        S32 mDiscard;   // -1 until the file header has been read
+        S32 mFileSize;
+        U32 mTime;      // last use, seconds since 1/1/1970
+        U32 mFileTime;  // last modification time of the file
+    };
+
+    std::string getFileName(const LLUUID& id) const;
+    // Runs on the work queue
+    LLPointer<LLImageRaw> read(const LLUUID& id, S32 max_discard, S32& discard, F32& decode_time);
+    // Runs on the work queue
+    void doWrite(const LLUUID& id, LLPointer<LLImageRaw> raw, S32 discard, F32 decode_time);
+    // mMutex must be locked
+    void evict(S64 target_size);
+    void removeEntry(const LLUUID& id);
+
+    LLMutex mMutex;
+    std::string mDirName;
+    bool mReadOnly;
+    bool mCompress;
+    S64 mMaxSize;
+    std::atomic<S64> mTotalSize;
+
+    typedef std::map<LLUUID, Entry> entry_map_t;
+    entry_map_t mEntries;
+    std::set<LLUUID> mPendingWrites;
+
+    std::atomic<U64> mLookups;
+    std::atomic<U64> mHits;
+    std::atomic<U64> mDecodeUsecSaved;
+};
+
+#endif // LL_LLTEXTURERAWCACHE_H
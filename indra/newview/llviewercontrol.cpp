@@ -1189,6 +1189,23 @@ void handleBandwidthChanged(const LLSD& newValue)
 }
 // </FS:Ansariel>
 
+static void handleNetworkReceiveThreadChanged(const LLSD& newValue)
+{
+    if (!gMessageSystem)
+    {
+        return;
+    }
+
+    if (newValue.asBoolean())
+    {
+        gMessageSystem->startReceiveThread();
+    }
+    else
+    {
+        gMessageSystem->stopReceiveThread();
+    }
+}
+
 // <FS:Zi> Handle IME text input getting enabled or disabled
 #if LL_SDL2
 static bool handleSDL2IMEEnabledChanged(const LLSD& newvalue)
@@ -1467,6 +1484,7 @@ void settings_setup_listeners()
 
     //<FS:HG> FIRE-6340, FIRE-6567, FIRE-6809 - Setting Bandwidth issues
     setting_setup_signal_listener(gSavedSettings, "ThrottleBandwidthKBPS", handleBandwidthChanged);
+    setting_setup_signal_listener(gSavedSettings, "FSNetworkReceiveThread", handleNetworkReceiveThreadChanged);
     setting_setup_signal_listener(gSavedSettings, "FSContactListShowSearch", handleContactListShowSearchChanged);
 
     // <FS:Ansariel> Debug setting to disable log throttle
@@ -205,7 +205,8 @@ void display_update_camera()
     F32 final_far = gAgentCamera.mDrawDistance;
     if (gCubeSnapshot)
     {
-        final_far = gSavedSettings.getF32("RenderReflectionProbeDrawDistance");
+        static LLControlHandle<F32> probe_draw_distance(gSavedSettings, "RenderReflectionProbeDrawDistance");
+        final_far = probe_draw_distance;
     }
     else if (CAMERA_MODE_CUSTOMIZE_AVATAR == gAgentCamera.getCameraMode())
 
@@ -654,6 +655,7 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
     // <FS::Ansariel> Draw Distance stepping; originally based on SpeedRez by Henri Beauchamp, licensed under LGPL
     // Progressively increase draw distance after TP when required.
     static LLCachedControl<F32> renderFarClip(gSavedSettings, "RenderFarClip");
+    static LLControlHandle<U32> farClipSteppingInterval(gSavedSettings, "FSRenderFarClipSteppingInterval");
     if (gSavedDrawDistance > 0.0f && gAgent.getTeleportState() == LLAgent::TELEPORT_NONE)
     {
         if (gLastDrawDistanceStep != renderFarClip())
@@ -665,7 +667,7 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
         }
 
         if (gTeleportArrivalTimer.getElapsedTimeF32() >=
-            (F32)gSavedSettings.getU32("FSRenderFarClipSteppingInterval"))
+            (F32)farClipSteppingInterval())
         {
             gTeleportArrivalTimer.reset();
             F32 current = gSavedSettings.getF32("RenderFarClip");
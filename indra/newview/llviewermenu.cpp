@@ -34,6 +34,7 @@
 #include "llviewermenu.h"
 
 // linden library includes
+#include "cpubudget.h"
 #include "llavatarnamecache.h"  // IDEVO (I Are Not Men!)
 #include "llcombobox.h"
 #include "llcoros.h"
@@ -99,6 +100,7 @@
 #include "llpanelmaininventory.h"
 #include "llmarketplacefunctions.h"
 #include "llmaterialeditor.h"
+#include "llmemtag.h"
 #include "llmenuoptionpathfindingrebakenavmesh.h"
 #include "llmoveview.h"
 #include "llnavigationbar.h"
@@ -2596,6 +2598,7 @@ class LLAdvancedPurgeDiskCache : public view_listener_t
             general_queue,
             []() // Work done on general queue
             {
+                LL::CpuBudget::Blocking blocking;
                 LLDiskCache::getInstance()->purge();
                 // Nothing needed to return
             },
@@ -11013,6 +11016,15 @@ void handle_dump_timers()
     LLTrace::BlockTimer::dumpCurTimes();
 }
 
+void handle_dump_memory_tags()
+{
+    std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "memory_tags.txt");
+    if (LLMemTag::dump(filename))
+    {
+        LL_INFOS("MemTag") << "Wrote memory by subsystem to " << filename << LL_ENDL;
+    }
+}
+
 void handle_debug_avatar_textures(void*)
 {
     LLViewerObject* objectp = LLSelectMgr::getInstance()->getSelection()->getPrimaryObject();
@@ -12792,6 +12804,7 @@ void initialize_menus()
     view_listener_t::addMenu(new LLAdvancedDumpSelectMgr(), "Advanced.DumpSelectMgr");
     view_listener_t::addMenu(new LLAdvancedDumpInventory(), "Advanced.DumpInventory");
     commit.add("Advanced.DumpTimers", boost::bind(&handle_dump_timers) );
+    commit.add("Advanced.DumpMemoryTags", boost::bind(&handle_dump_memory_tags));
     commit.add("Advanced.DumpFocusHolder", boost::bind(&handle_dump_focus) );
     view_listener_t::addMenu(new LLAdvancedPrintSelectedObjectInfo(), "Advanced.PrintSelectedObjectInfo");
     view_listener_t::addMenu(new LLAdvancedPrintAgentInfo(), "Advanced.PrintAgentInfo");
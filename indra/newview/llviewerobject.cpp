@@ -143,6 +143,7 @@ F64Seconds  LLViewerObject::sPhaseOutUpdateInterpolationTime(2.0);  // For motio
 F64Seconds  LLViewerObject::sMaxRegionCrossingInterpolationTime(1.0);// For motion interpolation: don't interpolate over this time on region crossing
 
 std::map<std::string, U32> LLViewerObject::sObjectDataMap;
+LLViewerObject::UpdateHandles LLViewerObject::sUpdateHandles;
 
 // The maximum size of an object extra parameters binary (packed) block
 #define MAX_OBJECT_PARAMS_SIZE 1024
@@ -1189,6 +1190,57 @@ U32 LLViewerObject::checkMediaURL(const std::string &media_url)
     return retval;
 }
 
+//static
+void LLViewerObject::bindUpdateHandles(LLMessageSystem* msg)
+{
+    // Start over, the message system may have reloaded its templates
+    sUpdateHandles = UpdateHandles();
+
+    const char* messages[] = { _PREHASH_ObjectUpdate,
+                               _PREHASH_ObjectUpdateCompressed,
+                               _PREHASH_ObjectUpdateCached,
+                               _PREHASH_ImprovedTerseObjectUpdate };
+    struct
+    {
+        LLMessageVariableHandle& handle;
+        const char* block;
+        const char* var;
+    } vars[] = {
+        { sUpdateHandles.mRegionHandle, _PREHASH_RegionData, _PREHASH_RegionHandle },
+        { sUpdateHandles.mTimeDilation, _PREHASH_RegionData, _PREHASH_TimeDilation },
+        { sUpdateHandles.mID,           _PREHASH_ObjectData, _PREHASH_ID },
+        { sUpdateHandles.mFullID,       _PREHASH_ObjectData, _PREHASH_FullID },
+        { sUpdateHandles.mState,        _PREHASH_ObjectData, _PREHASH_State },
+        { sUpdateHandles.mCRC,          _PREHASH_ObjectData, _PREHASH_CRC },
+        { sUpdateHandles.mPCode,        _PREHASH_ObjectData, _PREHASH_PCode },
+        { sUpdateHandles.mMaterial,     _PREHASH_ObjectData, _PREHASH_Material },
+        { sUpdateHandles.mClickAction,  _PREHASH_ObjectData, _PREHASH_ClickAction },
+        { sUpdateHandles.mScale,        _PREHASH_ObjectData, _PREHASH_Scale },
+        { sUpdateHandles.mObjectData,   _PREHASH_ObjectData, _PREHASH_ObjectData },
+        { sUpdateHandles.mParentID,     _PREHASH_ObjectData, _PREHASH_ParentID },
+        { sUpdateHandles.mUpdateFlags,  _PREHASH_ObjectData, _PREHASH_UpdateFlags },
+        { sUpdateHandles.mNameValue,    _PREHASH_ObjectData, _PREHASH_NameValue },
+        { sUpdateHandles.mData,         _PREHASH_ObjectData, _PREHASH_Data },
+        { sUpdateHandles.mText,         _PREHASH_ObjectData, _PREHASH_Text },
+        { sUpdateHandles.mTextColor,    _PREHASH_ObjectData, _PREHASH_TextColor },
+        { sUpdateHandles.mMediaURL,     _PREHASH_ObjectData, _PREHASH_MediaURL },
+        { sUpdateHandles.mExtraParams,  _PREHASH_ObjectData, _PREHASH_ExtraParams },
+        { sUpdateHandles.mSound,        _PREHASH_ObjectData, _PREHASH_Sound },
+        { sUpdateHandles.mOwnerID,      _PREHASH_ObjectData, _PREHASH_OwnerID },
+        { sUpdateHandles.mGain,         _PREHASH_ObjectData, _PREHASH_Gain },
+        { sUpdateHandles.mFlags,        _PREHASH_ObjectData, _PREHASH_Flags },
+        { sUpdateHandles.mRadius,       _PREHASH_ObjectData, _PREHASH_Radius } };
+
+    for (const char* message : messages)
+    {
+        for (auto& var : vars)
+        {
+            // Not every message carries every variable; those stay unbound
+            msg->bindVariableHandleFast(var.handle, message, var.block, var.var);
+        }
+    }
+}
+
 //extract spatial information from object update message
 //return parent_id
 //static
@@ -1246,7 +1298,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 
     if(mesgsys != NULL)
     {
-        mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+        mesgsys->getU64Fast(sUpdateHandles.mRegionHandle, region_handle);
         LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
         if(regionp != mRegionp && regionp && mRegionp)//region cross
         {
@@ -1287,7 +1339,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
     if(mesgsys != NULL)
     {
         U16 time_dilation16;
-        mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+        mesgsys->getU16Fast(sUpdateHandles.mTimeDilation, time_dilation16);
         time_dilation = ((F32) time_dilation16) / 65535.f;
         mRegionp->setTimeDilation(time_dilation);
     }
@@ -1358,19 +1410,19 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 F32    cutoff;
                 U8     sound_flags;
 
-                mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_CRC, crc, block_num);
-                mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_ParentID, parent_id, block_num);
-                mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_Sound, audio_uuid, block_num );
+                mesgsys->getU32Fast(sUpdateHandles.mCRC, crc, block_num);
+                mesgsys->getU32Fast(sUpdateHandles.mParentID, parent_id, block_num);
+                mesgsys->getUUIDFast(sUpdateHandles.mSound, audio_uuid, block_num);
                 // HACK: Owner id only valid if non-null sound id or particle system
-                mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_OwnerID, owner_id, block_num );
-                mesgsys->getF32Fast( _PREHASH_ObjectData, _PREHASH_Gain, gain, block_num );
-                mesgsys->getF32Fast(  _PREHASH_ObjectData, _PREHASH_Radius, cutoff, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Flags, sound_flags, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Material, material, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_ClickAction, click_action, block_num);
-                mesgsys->getVector3Fast(_PREHASH_ObjectData, _PREHASH_Scale, new_scale, block_num );
-                length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ObjectData);
-                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ObjectData, data, length, block_num, MAX_OBJECT_BINARY_DATA_SIZE);
+                mesgsys->getUUIDFast(sUpdateHandles.mOwnerID, owner_id, block_num);
+                mesgsys->getF32Fast(sUpdateHandles.mGain, gain, block_num);
+                mesgsys->getF32Fast(sUpdateHandles.mRadius, cutoff, block_num);
+                mesgsys->getU8Fast(sUpdateHandles.mFlags, sound_flags, block_num);
+                mesgsys->getU8Fast(sUpdateHandles.mMaterial, material, block_num);
+                mesgsys->getU8Fast(sUpdateHandles.mClickAction, click_action, block_num);
+                mesgsys->getVector3Fast(sUpdateHandles.mScale, new_scale, block_num);
+                length = mesgsys->getSizeFast(sUpdateHandles.mObjectData, block_num);
+                mesgsys->getBinaryDataFast(sUpdateHandles.mObjectData, data, length, block_num, MAX_OBJECT_BINARY_DATA_SIZE);
                 length = llmin(length, MAX_OBJECT_BINARY_DATA_SIZE);  // getBinaryDataFast() safely fills the buffer to max_size
 
                 mTotalCRC = crc;
@@ -1454,24 +1506,24 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 //
 
                 U32 flags;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
+                mesgsys->getU32Fast(sUpdateHandles.mUpdateFlags, flags, block_num);
                 // clear all but local flags
                 mFlags &= FLAGS_LOCAL;
                 mFlags |= flags;
 
                 U8 state;
-                mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_State, state, block_num );
+                mesgsys->getU8Fast(sUpdateHandles.mState, state, block_num);
                 mAttachmentState = state;
 
                 // ...new objects that should come in selected need to be added to the selected list
                 mCreateSelected = ((flags & FLAGS_CREATE_SELECTED) != 0);
 
                 // Set all name value pairs
-                S32 nv_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_NameValue);
+                S32 nv_size = mesgsys->getSizeFast(sUpdateHandles.mNameValue, block_num);
                 if (nv_size > 0)
                 {
                     std::string name_value_list;
-                    mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_NameValue, name_value_list, block_num);
+                    mesgsys->getStringFast(sUpdateHandles.mNameValue, name_value_list, block_num);
                     setNameValueList(name_value_list);
                 }
 
@@ -1493,20 +1545,20 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 
                 // Check for appended generic data
                 const S32 GENERIC_DATA_BUFFER_SIZE = 16;
-                S32 data_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Data);
+                S32 data_size = mesgsys->getSizeFast(sUpdateHandles.mData, block_num);
                 if (data_size > 0)
                 {    // has generic data
                     if (getPCode() == LL_PCODE_LEGACY_TREE || getPCode() == LL_PCODE_TREE_NEW)
                     {
                         mData = new U8[data_size];
-                        mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, mData, data_size, block_num);
+                        mesgsys->getBinaryDataFast(sUpdateHandles.mData, mData, data_size, block_num);
                         LL_DEBUGS("NewObjectData") << "Read " << data_size << " bytes tree genome data for " << getID() << ", pcode "
                                              << getPCodeString() << ", value " << (S32) mData[0] << LL_ENDL;
                     }
                     else
                     {   // Extract number of prims
                         U8 generic_data[GENERIC_DATA_BUFFER_SIZE];
-                        mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data,
+                        mesgsys->getBinaryDataFast(sUpdateHandles.mData,
                             &generic_data[0], llmin(data_size, GENERIC_DATA_BUFFER_SIZE), block_num);
                         // This is sample code to extract the number of prims
                         //    Future viewers should use it for their own purposes
@@ -1519,7 +1571,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     }
                 }
 
-                S32 text_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Text);
+                S32 text_size = mesgsys->getSizeFast(sUpdateHandles.mText, block_num);
                 if (text_size > 1)
                 {
                     // Setup object text
@@ -1529,10 +1581,10 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     }
 
                     std::string temp_string;
-                    mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_Text, temp_string, block_num );
+                    mesgsys->getStringFast(sUpdateHandles.mText, temp_string, block_num);
 
                     LLColor4U coloru;
-                    mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextColor, coloru.mV, 4, block_num);
+                    mesgsys->getBinaryDataFast(sUpdateHandles.mTextColor, coloru.mV, 4, block_num);
 
                     // alpha was flipped so that it zero encoded better
                     coloru.mV[3] = 255 - coloru.mV[3];
@@ -1562,7 +1614,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 }
 
                 std::string media_url;
-                mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_MediaURL, media_url, block_num);
+                mesgsys->getStringFast(sUpdateHandles.mMediaURL, media_url, block_num);
                 retval |= checkMediaURL(media_url);
 
                 //
@@ -1578,7 +1630,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 }
 
                 // Unpack extra parameters
-                S32 size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ExtraParams);
+                S32 size = mesgsys->getSizeFast(sUpdateHandles.mExtraParams, block_num);
                 if (size > 0)
                 {
                     U8 *buffer = new(std::nothrow) U8[size];
@@ -1587,7 +1639,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                         LLError::LLUserWarningMsg::showOutOfMemory();
                         LL_ERRS() << "Bad memory allocation for buffer, size: " << size << LL_ENDL;
                     }
-                    mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ExtraParams, buffer, size, block_num);
+                    mesgsys->getBinaryDataFast(sUpdateHandles.mExtraParams, buffer, size, block_num);
                     LLDataPackerBinaryBuffer dp(buffer, size);
 
                     U8 num_parameters;
@@ -1623,8 +1675,8 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
                 LL_INFOS() << "TI:" << getID() << LL_ENDL;
 #endif
-                length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ObjectData);
-                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ObjectData, data, length, block_num, MAX_OBJECT_BINARY_DATA_SIZE);
+                length = mesgsys->getSizeFast(sUpdateHandles.mObjectData, block_num);
+                mesgsys->getBinaryDataFast(sUpdateHandles.mObjectData, data, length, block_num, MAX_OBJECT_BINARY_DATA_SIZE);
                 length = llmin(length, MAX_OBJECT_BINARY_DATA_SIZE);    // getBinaryDataFast() safely fills the buffer to max_size
                 count  = 0;
                 LLVector4 collision_plane;
@@ -1711,7 +1763,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 }
 
                 U8 state;
-                mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_State, state, block_num );
+                mesgsys->getU8Fast(sUpdateHandles.mState, state, block_num);
                 mAttachmentState = state;
                 break;
             }
@@ -1977,7 +2029,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 if(mesgsys != NULL)
                 {
                 U32 flags;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
+                mesgsys->getU32Fast(sUpdateHandles.mUpdateFlags, flags, block_num);
                 loadFlags(flags);
                 }
             }
@@ -5265,7 +5317,12 @@ void LLViewerObject::updateTEMaterialTextures(U8 te)
     if (getTEref(te).getMaterialParams().notNull())
     {
         const LLUUID& norm_id = getTEref(te).getMaterialParams()->getNormalID();
-        mTENormalMaps[te] = LLViewerTextureManager::getFetchedTexture(norm_id, FTT_DEFAULT, true, LLGLTexture::BOOST_NONE, LLViewerTexture::LOD_TEXTURE);
+        LLViewerFetchedTexture* normal_map = LLViewerTextureManager::getFetchedTexture(norm_id, FTT_DEFAULT, true, LLGLTexture::BOOST_NONE, LLViewerTexture::LOD_TEXTURE);
+        if (normal_map)
+        {
+            normal_map->setIsNormalMap();
+        }
+        mTENormalMaps[te] = normal_map;
 
         const LLUUID& spec_id = getTEref(te).getMaterialParams()->getSpecularID();
         mTESpecularMaps[te] = LLViewerTextureManager::getFetchedTexture(spec_id, FTT_DEFAULT, true, LLGLTexture::BOOST_NONE, LLViewerTexture::LOD_TEXTURE);
@@ -5322,6 +5379,10 @@ void LLViewerObject::updateTEMaterialTextures(U8 te)
     {
         mat->mBaseColorTexture = fetch_texture(mat->mTextureId[LLGLTFMaterial::GLTF_TEXTURE_INFO_BASE_COLOR]);
         mat->mNormalTexture = fetch_texture(mat->mTextureId[LLGLTFMaterial::GLTF_TEXTURE_INFO_NORMAL]);
+        if (mat->mNormalTexture)
+        {
+            mat->mNormalTexture->setIsNormalMap();
+        }
         mat->mMetallicRoughnessTexture = fetch_texture(mat->mTextureId[LLGLTFMaterial::GLTF_TEXTURE_INFO_METALLIC_ROUGHNESS]);
         mat->mEmissiveTexture= fetch_texture(mat->mTextureId[LLGLTFMaterial::GLTF_TEXTURE_INFO_EMISSIVE]);
     }
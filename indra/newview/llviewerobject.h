@@ -175,6 +175,39 @@ public:
         INVALID_UPDATE = 0x80000000
     };
 
+    // Variables read for every object in ObjectUpdate, ObjectUpdateCompressed,
+    // ObjectUpdateCached and ImprovedTerseObjectUpdate. Bound to those
+    // templates by bindUpdateHandles() when their handlers are registered.
+    struct UpdateHandles
+    {
+        LLMessageVariableHandle mRegionHandle;
+        LLMessageVariableHandle mTimeDilation;
+        LLMessageVariableHandle mID;
+        LLMessageVariableHandle mFullID;
+        LLMessageVariableHandle mState;
+        LLMessageVariableHandle mCRC;
+        LLMessageVariableHandle mPCode;
+        LLMessageVariableHandle mMaterial;
+        LLMessageVariableHandle mClickAction;
+        LLMessageVariableHandle mScale;
+        LLMessageVariableHandle mObjectData;
+        LLMessageVariableHandle mParentID;
+        LLMessageVariableHandle mUpdateFlags;
+        LLMessageVariableHandle mNameValue;
+        LLMessageVariableHandle mData;
+        LLMessageVariableHandle mText;
+        LLMessageVariableHandle mTextColor;
+        LLMessageVariableHandle mMediaURL;
+        LLMessageVariableHandle mExtraParams;
+        LLMessageVariableHandle mSound;
+        LLMessageVariableHandle mOwnerID;
+        LLMessageVariableHandle mGain;
+        LLMessageVariableHandle mFlags;
+        LLMessageVariableHandle mRadius;
+    };
+    static UpdateHandles sUpdateHandles;
+    static void     bindUpdateHandles(LLMessageSystem* msg);
+
     static  U32     extractSpatialExtents(LLDataPackerBinaryBuffer *dp, LLVector3& pos, LLVector3& scale, LLQuaternion& rot);
     virtual U32     processUpdateMessage(LLMessageSystem *mesgsys,
                                         void **user_data,
@@ -448,6 +448,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 {
     LL_RECORD_BLOCK_TIME(FTM_PROCESS_OBJECTS);
 
+    const LLViewerObject::UpdateHandles& handles = LLViewerObject::sUpdateHandles;
     LLViewerObject *objectp;
     S32         num_objects;
     U32         local_id;
@@ -498,7 +499,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
     }
 
     U64 region_handle;
-    mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+    mesgsys->getU64Fast(handles.mRegionHandle, region_handle);
 
     LLViewerRegion *regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
 
@@ -521,15 +522,15 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         {
             compressed_dp.reset();
 
-            S32 uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+            S32 uncompressed_length = mesgsys->getSizeFast(handles.mData, i);
             LL_DEBUGS("ObjectUpdate") << "got binary data from message to compressed_dpbuffer" << LL_ENDL;
-            mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i, 2048);
+            mesgsys->getBinaryDataFast(handles.mData, compressed_dpbuffer, 0, i, 2048);
             compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
 
             if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
             {
                 U32 flags = 0;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+                mesgsys->getU32Fast(handles.mUpdateFlags, flags, i);
 
                 compressed_dp.unpackUUID(fullid, "ID");
                 compressed_dp.unpackU32(local_id, "LocalID");
@@ -570,7 +571,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         }
         else if (update_type != OUT_FULL) // !compressed, !OUT_FULL ==> OUT_FULL_CACHED only?
         {
-            mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+            mesgsys->getU32Fast(handles.mID, local_id, i);
 
             getUUIDFromLocal(fullid,
                             local_id,
@@ -589,8 +590,8 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
         else // OUT_FULL only?
         {
             update_cache = true;
-            mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
-            mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
+            mesgsys->getUUIDFast(handles.mFullID, fullid, i);
+            mesgsys->getU32Fast(handles.mID, local_id, i);
             LL_DEBUGS("ObjectUpdate") << "Full Update, obj " << local_id << ", global ID " << fullid << " from " << mesgsys->getSender() << LL_ENDL;
         }
         objectp = findObject(fullid);
@@ -663,7 +664,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
                     continue;
                 }
 
-                mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
+                mesgsys->getU8Fast(handles.mPCode, pcode, i);
 
             }
 #ifdef IGNORE_DEAD
@@ -727,7 +728,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
             if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
             {
                 U32 flags = 0;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+                mesgsys->getU32Fast(handles.mUpdateFlags, flags, i);
 
                 if(!(flags & FLAGS_TEMPORARY_ON_REZ))
                 {
@@ -766,11 +767,12 @@ void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
 {
     //processObjectUpdate(mesgsys, user_data, update_type, true, false);
 
+    const LLViewerObject::UpdateHandles& handles = LLViewerObject::sUpdateHandles;
     S32 num_objects = mesgsys->getNumberOfBlocksFast(_PREHASH_ObjectData);
     gFullObjectUpdates += num_objects;
 
     U64 region_handle;
-    mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+    mesgsys->getU64Fast(handles.mRegionHandle, region_handle);
     LLViewerRegion *regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
     if (!regionp)
     {
@@ -785,9 +787,9 @@ void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
         U32 id;
         U32 crc;
         U32 flags;
-        mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
-        mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
-        mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+        mesgsys->getU32Fast(handles.mID, id, i);
+        mesgsys->getU32Fast(handles.mCRC, crc, i);
+        mesgsys->getU32Fast(handles.mUpdateFlags, flags, i);
 
         LL_DEBUGS("ObjectUpdate") << "got probe for id " << id << " crc " << crc << LL_ENDL;
 
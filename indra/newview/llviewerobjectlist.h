@@ -33,6 +33,7 @@
 // common includes
 #include "llstring.h"
 #include "lltrace.h"
+#include "lluuidhashmap.h"
 
 // project includes
 #include "llviewerobject.h"
@@ -218,7 +219,8 @@ protected:
     uuid_multiset_t   mDeadObjects;
     // </FS:Beq>
 
-    std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+    // looked up for every object update: flat hash map rather than std::map
+    LLUUIDHashMap<LLPointer<LLViewerObject> > mUUIDObjectMap;
 
     //set of objects that need to update their cost
     uuid_set_t   mStaleObjectCost;
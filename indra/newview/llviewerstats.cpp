@@ -32,6 +32,7 @@
 #include "message.h"
 #include "llfloaterreg.h"
 #include "llmemory.h"
+#include "llmemtag.h"
 #include "lltimer.h"
 
 #include "llappviewer.h"
@@ -202,7 +203,8 @@ LLTrace::SampleStatHandle<> FPS_SAMPLE("fpssample"),
                             SHADER_OBJECTS("shaderobjects", "Object Shaders"),
                             DRAW_DISTANCE("drawdistance", "Draw Distance"),
                             WINDOW_WIDTH("windowwidth", "Window width"),
-                            WINDOW_HEIGHT("windowheight", "Window height");
+                            WINDOW_HEIGHT("windowheight", "Window height"),
+                            MESSAGE_RECEIVE_QUEUE_DEPTH("messagereceivequeuedepth", "Most UDP packets waiting for the main thread");
 
 LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> >
                             PACKETS_LOST_PERCENT("packetslostpercentstat");
@@ -236,7 +238,9 @@ SimMeasurement<F64Megabytes >   SIM_PHYSICS_MEM("physicsmemoryallocated", "", LL
 LLTrace::SampleStatHandle<F64Milliseconds > FRAMETIME_JITTER("frametimejitter", "Average delta between successive frame times"),
                                             FRAMETIME_SLEW("frametimeslew", "Average delta between frame time and mean"),
                                             FRAMETIME("frametime", "Measured frame time"),
-                                            SIM_PING("simpingstat");
+                                            SIM_PING("simpingstat"),
+                                            MESSAGE_ACK_LATENCY("messageacklatency", "Average time from receiving a reliable packet to acking it"),
+                                            MESSAGE_ACK_LATENCY_MAX("messageacklatencymax", "Longest time from receiving a reliable packet to acking it");
 
 LLTrace::EventStatHandle<LLUnit<F64, LLUnits::Meters> > AGENT_POSITION_SNAP("agentpositionsnap", "agent position corrections");
 
@@ -442,6 +446,7 @@ void update_statistics()
     gTransferManager.resetTransferBitsIn(LLTCT_ASSET);
 
     sample(LLStatViewer::VISIBLE_AVATARS, LLVOAvatar::sNumVisibleAvatars);
+    LLMemTag::updateStats();
     LLWorld *world = LLWorld::getInstance(); // not LLSingleton
     if (world)
     {
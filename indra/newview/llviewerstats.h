@@ -193,7 +193,8 @@ extern LLTrace::SampleStatHandle<>      FPS_SAMPLE,
                                         SHADER_OBJECTS,
                                         DRAW_DISTANCE,
                                         WINDOW_WIDTH,
-                                        WINDOW_HEIGHT;
+                                        WINDOW_HEIGHT,
+                                        MESSAGE_RECEIVE_QUEUE_DEPTH;
 
 extern LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> > PACKETS_LOST_PERCENT;
 
@@ -222,7 +223,9 @@ extern SimMeasurement<F64Megabytes >    SIM_PHYSICS_MEM;
 
 extern LLTrace::SampleStatHandle<F64Milliseconds >  FRAMETIME_JITTER,
                                                     FRAMETIME_SLEW,
-                                                    SIM_PING;
+                                                    SIM_PING,
+                                                    MESSAGE_ACK_LATENCY,
+                                                    MESSAGE_ACK_LATENCY_MAX;
 
 extern LLTrace::EventStatHandle<LLUnit<F64, LLUnits::Meters> > AGENT_POSITION_SNAP;
 
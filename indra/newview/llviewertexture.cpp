@@ -37,6 +37,7 @@
 #include "llhost.h"
 #include "llimage.h"
 #include "llimagebmp.h"
+#include "llimagedxt.h"
 #include "llimagej2c.h"
 #include "llimagetga.h"
 #include "llstl.h"
@@ -80,6 +81,7 @@ LLPointer<LLViewerFetchedTexture> LLViewerFetchedTexture::sDefaultDiffuseImagep
 LLViewerMediaTexture::media_map_t LLViewerMediaTexture::sMediaMap;
 LLTexturePipelineTester* LLViewerTextureManager::sTesterp = nullptr;
 F32 LLViewerFetchedTexture::sMaxVirtualSize = 8192.f*8192.f;
+LLTrace::CountStatHandle<F64Megabytes> LLViewerFetchedTexture::sBlockCompressionSaved("texture_block_compression_saved", "Texture memory saved by block compressing fetched textures");
 
 const std::string sTesterName("TextureTester");
 
@@ -826,6 +828,7 @@ void LLViewerTexture::addTextureStats(F32 virtual_size, bool needs_gltexture) co
 
     if (virtual_size > mMaxVirtualSize)
     {
+        gTextureList.updatePriority(const_cast<LLViewerTexture*>(this), mMaxVirtualSize, virtual_size);
         mMaxVirtualSize = virtual_size;
     }
 }
@@ -1659,7 +1662,14 @@ void LLViewerFetchedTexture::scheduleCreateTexture()
 #endif
             mNeedsCreateTexture = true;
             auto mainq = LLImageGLThread::sEnabledTextures ? mMainQueue.lock() : nullptr;
-            if (mainq)
+            S32 bc_format = mainq ? getBlockCompressionFormat() : (S32)LLImageDXT::FORMAT_UNKNOWN;
+            if (bc_format != LLImageDXT::FORMAT_UNKNOWN && scheduleBlockCompression(bc_format))
+            {
+#if LL_IMAGEGL_THREAD_CHECK
+                delete[] data_copy;
+#endif
+            }
+            else if (mainq)
             {
                 ref();
                 mainq->postTo(
@@ -1717,6 +1727,118 @@ void LLViewerFetchedTexture::scheduleCreateTexture()
     }
 }
 
+S32 LLViewerFetchedTexture::getBlockCompressionFormat() const
+{
+    static LLCachedControl<bool> block_compression(gSavedSettings, "FSTextureBlockCompression", false);
+    static const S32 MIN_SIZE = 64; // smaller mips upload quickly and are soon replaced
+
+    // UI, HUD, preview and other boosted textures keep their exact texels
+    if (!block_compression || mBoostLevel >= BOOST_HIGH || mRawImage.isNull()
+        || mGLTexturep.isNull() || mGLTexturep->getHasExplicitFormat() || !mGLTexturep->getUseMipMaps()
+        || mRawImage->getWidth() < MIN_SIZE || mRawImage->getHeight() < MIN_SIZE)
+    {
+        return LLImageDXT::FORMAT_UNKNOWN;
+    }
+
+    const bool has_bptc = gGLManager.mHasTextureCompressionBPTC;
+    if (mIsNormalMap)
+    {
+        // BC1 and BC3 visibly band normals
+        return has_bptc ? LLImageDXT::FORMAT_DXR7 : LLImageDXT::FORMAT_UNKNOWN;
+    }
+
+    switch (mRawImage->getComponents())
+    {
+      case 3:
+        return LLImageDXT::FORMAT_DXR1;
+      case 4:
+        return has_bptc ? LLImageDXT::FORMAT_DXR7 : LLImageDXT::FORMAT_DXR5;
+      default:
+        return LLImageDXT::FORMAT_UNKNOWN;
+    }
+}
+
+bool LLViewerFetchedTexture::scheduleBlockCompression(S32 format)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    auto mainq = mMainQueue.lock();
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!mainq || !general_queue)
+    {
+        return false;
+    }
+
+    LLPointer<LLImageRaw> raw = mRawImage;
+    ref();
+    bool posted = mainq->postTo(
+        general_queue,
+        // work to be done on the General queue
+        [raw, format]()
+        {
+            LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("block compress texture");
+            LLPointer<LLImageDXT> compressed = new LLImageDXT();
+            if (!compressed->encodeBlockCompressed(raw, (LLImageDXT::EFileFormat)format))
+            {
+                compressed = nullptr;
+            }
+            return compressed;
+        },
+        // callback to be run on main thread
+        [this, raw](LLPointer<LLImageDXT> compressed)
+        {
+            if (compressed.notNull())
+            {
+                // Against the uncompressed upload with its full mip chain
+                F64 saved = (F64)raw->getDataSize() * 4.0 / 3.0 - (F64)compressed->getDataSize();
+                add(sBlockCompressionSaved, F64Megabytes(F64Bytes(llmax(saved, 0.0))));
+            }
+
+            auto mainq = mMainQueue.lock();
+            bool queued = mainq && mainq->postTo(
+                mImageQueue,
+                // work to be done on LLImageGL worker thread
+                [this, compressed]()
+                {
+                    createCompressedTexture(compressed);
+                },
+                // callback to be run on main thread
+                [this]()
+                {
+                    postCreateTexture();
+                    unref();
+                });
+            if (!queued && !mCreatePending)
+            {
+                mCreatePending = true;
+                gTextureList.mCreateTextureList.push(this);
+            }
+            if (!queued)
+            {
+                unref();
+            }
+        });
+    if (!posted)
+    {
+        unref();
+    }
+    return posted;
+}
+
+bool LLViewerFetchedTexture::createCompressedTexture(LLImageDXT* compressed)
+{
+    if (!mNeedsCreateTexture)
+    {
+        return false;
+    }
+    if (!compressed)
+    {
+        return createTexture();
+    }
+
+    return mGLTexturep->createCompressedGLTexture(mRawDiscardLevel, mRawImage, compressed, mBoostLevel);
+}
+
 // Call with 0,0 to turn this feature off.
 //virtual
 void LLViewerFetchedTexture::setKnownDrawSize(S32 width, S32 height)
@@ -36,6 +36,7 @@
 #include "llrender.h"
 #include "llmetricperformancetester.h"
 #include "httpcommon.h"
+#include "lltrace.h"
 #include "workqueue.h"
 #include "gltf/common.h"
 
@@ -46,6 +47,7 @@
 extern U32 DESIRED_NORMAL_TEXTURE_SIZE;
 
 class LLFace;
+class LLImageDXT;
 class LLImageGL ;
 class LLImageRaw;
 class LLViewerObject;
@@ -350,6 +352,9 @@ public:
     void postCreateTexture();
     void scheduleCreateTexture();
 
+    // Sampled as a normal map somewhere; block compression then needs BC7.
+    void setIsNormalMap() { mIsNormalMap = true; }
+
     void destroyTexture() ;
 
     virtual void processTextureStats() ;
@@ -456,6 +461,14 @@ private:
 
     void saveRawImage() ;
 
+    // Block compression of mRawImage before upload (FSTextureBlockCompression).
+    // Returns an LLImageDXT::EFileFormat, FORMAT_UNKNOWN when not worth it.
+    S32 getBlockCompressionFormat() const;
+    // Compresses on the General queue, then creates on the LLImageGL thread.
+    // Returns false if the work could not be queued.
+    bool scheduleBlockCompression(S32 format);
+    bool createCompressedTexture(LLImageDXT* compressed);
+
 private:
     bool  mFullyLoaded;
     bool  mInFastCacheList;
@@ -531,9 +544,11 @@ protected:
     LLAtomicBool  mNeedsCreateTexture;
 
     bool   mForSculpt ; //a flag if the texture is used as sculpt data.
+    bool   mIsNormalMap = false;
     bool   mIsFetched ; //is loaded from remote or from cache, not generated locally.
 
 public:
+    static LLTrace::CountStatHandle<F64Megabytes> sBlockCompressionSaved;
     static F32 sMaxVirtualSize; //maximum possible value of mMaxVirtualSize
     static LLPointer<LLViewerFetchedTexture> sMissingAssetImagep;   // Texture to show for an image asset that is not in the database
     static LLPointer<LLViewerFetchedTexture> sWhiteImagep;  // Texture to show NOTHING (whiteness)
@@ -73,6 +73,9 @@ U32 LLViewerTextureList::sNumFastCacheReads = 0;
 
 LLViewerTextureList gTextureList;
 
+LLTrace::CountStatHandle<> LLViewerTextureList::sPriorityUpdates("texture_priority_updates", "Textures updated because their virtual size changed");
+LLTrace::EventStatHandle<F64> LLViewerTextureList::sPriorityStaleness("texture_priority_staleness", "Frames between a texture's virtual size changing and its update");
+
 extern LLGLSLShader gCopyProgram;
 
 ETexListType get_element_type(S32 priority)
@@ -362,6 +365,7 @@ void LLViewerTextureList::shutdown()
     }
     mFastCacheList.clear();
 
+    mPriorityQueue.clear();
     mUUIDMap.clear();
 
     mImageList.clear();
@@ -728,6 +732,8 @@ void LLViewerTextureList::removeImageFromList(LLViewerFetchedTexture *image)
     llassert_always(mInitialized) ;
     llassert(image);
 
+    mPriorityQueue.remove(image);
+
     size_t count = 0;
     if (image->isInImageList())
     {
@@ -1038,6 +1044,32 @@ void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imag
     imagep->processTextureStats();
 }
 
+void LLViewerTextureList::updatePriority(LLViewerTexture* imagep, F32 old_vsize, F32 new_vsize)
+{
+    // only moves to another power of two are worth an early update
+    if (!imagep || std::ilogb(old_vsize + 1.f) == std::ilogb(new_vsize + 1.f))
+    {
+        return;
+    }
+
+    LLViewerFetchedTexture* fetched = LLViewerTextureManager::staticCastToFetchedTexture(imagep);
+    if (fetched && fetched->isInImageList())
+    {
+        mPriorityQueue.push(fetched, getPriorityBucket(old_vsize, new_vsize), LLFrameTimer::getFrameCount());
+    }
+}
+
+//static
+U32 LLViewerTextureList::getPriorityBucket(F32 old_vsize, F32 new_vsize)
+{
+    // log2 of the new size, 0 to 22 for up to 2048x2048 on screen, plus up
+    // to 8 for how many times larger or smaller than before it is
+    S32 size_level = llclamp(std::ilogb(llmax(new_vsize, 1.f)), 0, 23);
+    F32 ratio = (llmax(old_vsize, new_vsize) + 1.f) / (llmin(old_vsize, new_vsize) + 1.f);
+    S32 change_level = llclamp(std::ilogb(ratio), 0, 8);
+    return (U32)(size_level + change_level);
+}
+
 F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
@@ -1172,11 +1204,35 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
     update_count = llmax((U32) MIN_UPDATE_COUNT, (U32) mUUIDMap.size()/20);
     update_count = llmin(update_count, (U32) mUUIDMap.size());
 
+    U32 frame = LLFrameTimer::getFrameCount();
+    std::vector<std::pair<U32, U64> > queued; // bucket and frame queued, in step with the front of entries
+
+    { // textures whose virtual size changed the most go first
+        LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - priority");
+
+        entries.reserve(update_count + MIN_UPDATE_COUNT);
+        LLViewerFetchedTexture* imagep;
+        U32 bucket;
+        U64 queued_frame;
+        while (entries.size() < update_count && mPriorityQueue.pop(imagep, &bucket, &queued_frame))
+        {
+            if (imagep->getGLTexture())
+            {
+                entries.push_back(imagep);
+                queued.emplace_back(bucket, queued_frame);
+            }
+        }
+    }
+
+    // the round robin still visits every texture, for those whose priority
+    // changes without a reported size change (boosts, bias, lazy flushing)
+    update_count = llmax((U32) MIN_UPDATE_COUNT, update_count - (U32) queued.size());
+    update_count = llmin(update_count, (U32) mUUIDMap.size());
+
     { // copy entries out of UUID map to avoid iterator invalidation from deletion inside updateImageDecodeProiroty or updateFetch below
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - copy");
 
         // copy entries out of UUID map for updating
-        entries.reserve(update_count);
         uuid_map_t::iterator iter = mUUIDMap.upper_bound(mLastUpdateKey);
         while (update_count-- > 0)
         {
@@ -1195,18 +1251,37 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 
     LLTimer timer;
 
-    for (auto& imagep : entries)
+    for (size_t i = 0; i < entries.size(); ++i)
     {
-        mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+        LLViewerFetchedTexture* imagep = entries[i];
+        if (i < queued.size())
+        {
+            add(sPriorityUpdates, 1);
+            record(sPriorityStaleness, (F64)(frame - (U32)queued[i].second));
+        }
+        else
+        {
+            mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+        }
 
         if (imagep->getNumRefs() > 1) // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
         {
             updateImageDecodePriority(imagep);
             imagep->updateFetch();
+            // changes reported while updating are already accounted for
+            mPriorityQueue.remove(imagep);
         }
 
         if (timer.getElapsedTimeF32() > max_time)
         {
+            // put back the changed textures there was no time for
+            for (++i; i < queued.size(); ++i)
+            {
+                if (entries[i]->isInImageList())
+                {
+                    mPriorityQueue.push(entries[i].get(), queued[i].first, queued[i].second);
+                }
+            }
             break;
         }
     }
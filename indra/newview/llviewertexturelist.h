@@ -29,6 +29,7 @@
 
 #include "lluuid.h"
 //#include "message.h"
+#include "llbucketqueue.h"
 #include "llgl.h"
 #include "llviewertexture.h"
 #include "llui.h"
@@ -151,7 +152,15 @@ public:
     // - cleans up textures that haven't been referenced in awhile
     void updateImageDecodePriority(LLViewerFetchedTexture* imagep, bool flush_images = true);
 
+    // Queues imagep for updateImageDecodePriority ahead of the round robin
+    // when its virtual size moves to another power of two
+    void updatePriority(LLViewerTexture* imagep, F32 old_vsize, F32 new_vsize);
+
 private:
+    // Bucket for a virtual size change: larger textures and larger relative
+    // changes go first
+    static U32 getPriorityBucket(F32 old_vsize, F32 new_vsize);
+
     F32  updateImagesCreateTextures(F32 max_time);
     F32  updateImagesFetchTextures(F32 max_time);
     void updateImagesUpdateStats();
@@ -235,11 +244,19 @@ public:
     // <FS:Ansariel> Fast cache stats
     static U32 sNumFastCacheReads;
 
+    static LLTrace::CountStatHandle<> sPriorityUpdates;
+    static LLTrace::EventStatHandle<F64> sPriorityStaleness;
+
 private:
     typedef std::map< LLTextureKey, LLPointer<LLViewerFetchedTexture> > uuid_map_t;
     uuid_map_t mUUIDMap;
     LLTextureKey mLastUpdateKey;
 
+    // Textures whose virtual size changed since they were last updated,
+    // stamped with the frame they were queued in.  Holds no references:
+    // textures are taken out in removeImageFromList before they can die.
+    LLBucketQueue<LLViewerFetchedTexture*> mPriorityQueue;
+
     image_list_t mImageList;
 
     // simply holds on to LLViewerFetchedTexture references to stop them from being purged too soon
@@ -857,6 +857,19 @@ bool LLVOVolume::isVisible() const
     return false ;
 }
 
+// Lets the texture list update a face's textures early when the face's
+// virtual size changes a lot
+static void update_face_texture_priority(LLFace* face, F32 old_size, F32 new_size)
+{
+    if (old_size != new_size)
+    {
+        for (U32 ch = 0; ch < LLRender::NUM_TEXTURE_CHANNELS; ++ch)
+        {
+            gTextureList.updatePriority(face->getTexture(ch), old_size, new_size);
+        }
+    }
+}
+
 void LLVOVolume::updateTextureVirtualSize(bool forced)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
@@ -877,8 +890,10 @@ void LLVOVolume::updateTextureVirtualSize(bool forced)
                 LLFace* face = mDrawable->getFace(i);
                 if (face)
                 {
+                    F32 old_size = face->getVirtualSize();
                     face->setPixelArea(0.f);
                     face->setVirtualSize(0.f);
+                    update_face_texture_priority(face, old_size, 0.f);
                 }
             }
 
@@ -936,6 +951,7 @@ void LLVOVolume::updateTextureVirtualSize(bool forced)
         }
 
         mPixelArea = llmax(mPixelArea, face->getPixelArea());
+        update_face_texture_priority(face, old_size, vsize);
 
         // if the face has gotten small enough to turn off texture animation and texture
         // animation is running, rebuild the render batch for this face to turn off
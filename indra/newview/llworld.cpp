@@ -1244,6 +1244,16 @@ void LLWorld::updateNetStats()
     add(LLStatViewer::PACKETS_OUT, packets_out);
     add(LLStatViewer::PACKETS_LOST, packets_lost);
 
+    F32 ack_latency_mean = 0.f;
+    F32 ack_latency_max = 0.f;
+    gMessageSystem->getAckLatencyStats().getAndReset(ack_latency_mean, ack_latency_max);
+    if (ack_latency_max > 0.f)
+    {
+        sample(LLStatViewer::MESSAGE_ACK_LATENCY, F64Milliseconds(ack_latency_mean));
+        sample(LLStatViewer::MESSAGE_ACK_LATENCY_MAX, F64Milliseconds(ack_latency_max));
+    }
+    sample(LLStatViewer::MESSAGE_RECEIVE_QUEUE_DEPTH, gMessageSystem->getAndResetMaxReceiveQueueDepth());
+
     F32 total_packets_in = (F32)LLViewerStats::instance().getRecording().getSum(LLStatViewer::PACKETS_IN);
     if (total_packets_in > 0.f)
     {
@@ -4409,7 +4409,16 @@ void LLPipeline::renderDebug()
 
                 if ( pathfindingConsole->getVisible() || gAgentCamera.cameraMouselook() )
                 {
-                    F32 ambiance = gSavedSettings.getF32("PathfindingAmbiance");
+                    // read per shape per frame while the console is open
+                    static LLControlHandle<F32> pathfinding_ambiance(gSavedSettings, "PathfindingAmbiance");
+                    static LLControlHandle<F32> pathfinding_line_offset(gSavedSettings, "PathfindingLineOffset");
+                    static LLControlHandle<F32> pathfinding_line_width(gSavedSettings, "PathfindingLineWidth");
+                    static LLControlHandle<F32> pathfinding_xray_tint(gSavedSettings, "PathfindingXRayTint");
+                    static LLControlHandle<F32> pathfinding_xray_opacity(gSavedSettings, "PathfindingXRayOpacity");
+                    static LLControlHandle<bool> pathfinding_xray_wireframe(gSavedSettings, "PathfindingXRayWireframe");
+                    static LLControlHandle<LLColor4> pathfinding_navmesh_clear(gSavedSettings, "PathfindingNavMeshClear");
+
+                    F32 ambiance = pathfinding_ambiance;
 
                     gPathfindingProgram.bind();
 
@@ -4419,7 +4428,7 @@ void LLPipeline::renderDebug()
 
                     if ( !pathfindingConsole->isRenderWorld() )
                     {
-                        const LLColor4 clearColor = gSavedSettings.getColor4("PathfindingNavMeshClear");
+                        const LLColor4 clearColor = pathfinding_navmesh_clear();
                         gGL.setColorMask(true, true);
                         glClearColor(clearColor.mV[0],clearColor.mV[1],clearColor.mV[2],0);
                         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT); // no stencil -- deprecated | GL_STENCIL_BUFFER_BIT);
@@ -4539,18 +4548,18 @@ void LLPipeline::renderDebug()
                                 LLGLEnable lineOffset(GL_POLYGON_OFFSET_LINE);
                                 glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
-                                F32 offset = gSavedSettings.getF32("PathfindingLineOffset");
+                                F32 offset = pathfinding_line_offset;
 
                                 if (pathfindingConsole->isRenderXRay())
                                 {
-                                    gPathfindingProgram.uniform1f(sTint, gSavedSettings.getF32("PathfindingXRayTint"));
-                                    gPathfindingProgram.uniform1f(sAlphaScale, gSavedSettings.getF32("PathfindingXRayOpacity"));
+                                    gPathfindingProgram.uniform1f(sTint, pathfinding_xray_tint);
+                                    gPathfindingProgram.uniform1f(sAlphaScale, pathfinding_xray_opacity);
                                     LLGLEnable blend(GL_BLEND);
                                     LLGLDepthTest depth(GL_TRUE, GL_FALSE, GL_GREATER);
 
                                     glPolygonOffset(offset, -offset);
 
-                                    if (gSavedSettings.getBOOL("PathfindingXRayWireframe"))
+                                    if (pathfinding_xray_wireframe)
                                     { //draw hidden wireframe as darker and less opaque
                                         gPathfindingProgram.uniform1f(sAmbiance, 1.f);
                                         llPathingLibInstance->renderNavMeshShapesVBO( render_order[i] );
@@ -4570,7 +4579,7 @@ void LLPipeline::renderDebug()
                                     gPathfindingProgram.uniform1f(sTint, 1.f);
                                     gPathfindingProgram.uniform1f(sAlphaScale, 1.f);
 
-                                    gGL.setLineWidth(gSavedSettings.getF32("PathfindingLineWidth")); // <FS> Line width OGL core profile fix by Rye Mutt
+                                    gGL.setLineWidth(pathfinding_line_width); // <FS> Line width OGL core profile fix by Rye Mutt
                                     LLGLDisable blendOut(GL_BLEND);
                                     llPathingLibInstance->renderNavMeshShapesVBO( render_order[i] );
                                     gGL.flush();
@@ -4586,12 +4595,12 @@ void LLPipeline::renderDebug()
 
                     if ( pathfindingConsole->isRenderNavMesh() && pathfindingConsole->isRenderXRay() )
                     {   //render navmesh xray
-                        F32 ambiance = gSavedSettings.getF32("PathfindingAmbiance");
+                        F32 ambiance = pathfinding_ambiance;
 
                         LLGLEnable lineOffset(GL_POLYGON_OFFSET_LINE);
                         LLGLEnable polyOffset(GL_POLYGON_OFFSET_FILL);
 
-                        F32 offset = gSavedSettings.getF32("PathfindingLineOffset");
+                        F32 offset = pathfinding_line_offset;
                         glPolygonOffset(offset, -offset);
 
                         LLGLEnable blend(GL_BLEND);
@@ -4600,10 +4609,10 @@ void LLPipeline::renderDebug()
                         gGL.setLineWidth(2.0f); // <FS> Line width OGL core profile fix by Rye Mutt
                         LLGLEnable cull(GL_CULL_FACE);
 
-                        gPathfindingProgram.uniform1f(sTint, gSavedSettings.getF32("PathfindingXRayTint"));
-                        gPathfindingProgram.uniform1f(sAlphaScale, gSavedSettings.getF32("PathfindingXRayOpacity"));
+                        gPathfindingProgram.uniform1f(sTint, pathfinding_xray_tint);
+                        gPathfindingProgram.uniform1f(sAlphaScale, pathfinding_xray_opacity);
 
-                        if (gSavedSettings.getBOOL("PathfindingXRayWireframe"))
+                        if (pathfinding_xray_wireframe)
                         { //draw hidden wireframe as darker and less opaque
                             glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
                             gPathfindingProgram.uniform1f(sAmbiance, 1.f);
@@ -4618,8 +4627,8 @@ void LLPipeline::renderDebug()
 
                         //render edges
                         gPathfindingNoNormalsProgram.bind();
-                        gPathfindingNoNormalsProgram.uniform1f(sTint, gSavedSettings.getF32("PathfindingXRayTint"));
-                        gPathfindingNoNormalsProgram.uniform1f(sAlphaScale, gSavedSettings.getF32("PathfindingXRayOpacity"));
+                        gPathfindingNoNormalsProgram.uniform1f(sTint, pathfinding_xray_tint);
+                        gPathfindingNoNormalsProgram.uniform1f(sAlphaScale, pathfinding_xray_opacity);
                         llPathingLibInstance->renderNavMeshEdges();
                         gPathfindingProgram.bind();
 
@@ -31,6 +31,8 @@
 
 #include "llapr.h"
 #include "llmessagetemplate.h"
+#include "llrand.h"
+#include "lltimer.h"
 #include "llmath.h"
 #include "llquaternion.h"
 #include "lltemplatemessagebuilder.h"
@@ -116,6 +118,10 @@ namespace tut
             return reader;
         }
 
+        static void ignoreMessage(LLMessageSystem*, void**)
+        {
+        }
+
     };
 
     typedef test_group<LLTemplateMessageBuilderTestData>    LLTemplateMessageBuilderTestGroup;
@@ -967,5 +973,248 @@ namespace tut
         ensure_equals("Ensure unchanged buffer ", strlen(outBuffer), 0);
         delete reader;
     }
-}
 
+    template<> template<>
+    void LLTemplateMessageBuilderTestObject::test<46>()
+        // read through bound variable handles
+    {
+        LLMessageTemplate messageTemplate = defaultTemplate();
+        messageTemplate.addBlock(defaultBlock(MVT_U32, 4, MBT_SINGLE));
+        LLMessageBlock* repeated = new LLMessageBlock(_PREHASH_Test1, MBT_VARIABLE);
+        repeated->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+        repeated->addVariable(const_cast<char*>(_PREHASH_Test1), MVT_VARIABLE, 1);
+        messageTemplate.addBlock(repeated);
+
+        // same variables in a different block order
+        LLMessageTemplate otherTemplate(_PREHASH_TestMessage, 2, MFT_HIGH);
+        LLMessageBlock* other_repeated = new LLMessageBlock(_PREHASH_Test1, MBT_VARIABLE);
+        other_repeated->addVariable(const_cast<char*>(_PREHASH_Test1), MVT_VARIABLE, 1);
+        other_repeated->addVariable(const_cast<char*>(_PREHASH_Test0), MVT_U32, 4);
+        otherTemplate.addBlock(other_repeated);
+        otherTemplate.addBlock(defaultBlock(MVT_U32, 4, MBT_SINGLE));
+
+        LLTemplateMessageBuilder* builder = defaultBuilder(messageTemplate);
+        builder->addU32(_PREHASH_Test0, 0xdeadbeef);
+        const char* strings[] = { "a", "", "longer string" };
+        for (U32 i = 0; i < 3; ++i)
+        {
+            builder->nextBlock(_PREHASH_Test1);
+            builder->addU32(_PREHASH_Test0, i * 7);
+            builder->addString(_PREHASH_Test1, strings[i]);
+        }
+        LLTemplateMessageReader* reader = setReader(messageTemplate, builder);
+
+        LLMessageVariableHandle single, value, text, unbound, missing;
+        ensure("bind single", single.bind(&messageTemplate, _PREHASH_Test0, _PREHASH_Test0));
+        ensure("bind value", value.bind(&otherTemplate, _PREHASH_Test1, _PREHASH_Test0));
+        ensure("bind value again", value.bind(&messageTemplate, _PREHASH_Test1, _PREHASH_Test0));
+        ensure("bind text", text.bind(&messageTemplate, _PREHASH_Test1, _PREHASH_Test1));
+        ensure("bind other only", unbound.bind(&otherTemplate, _PREHASH_Test1, _PREHASH_Test0));
+        ensure("not in message", !missing.bind(&messageTemplate, _PREHASH_Test0, _PREHASH_Test1));
+        ensure("renamed", !value.bind(&messageTemplate, _PREHASH_Test0, _PREHASH_Test0));
+
+        U32 outValue = 0;
+        reader->getData(single, &outValue, sizeof(U32));
+        ensure_equals("single", outValue, 0xdeadbeef);
+        ensure_equals("block count", reader->getNumberOfBlocks(value), 3);
+        ensure_equals("unbound block count", reader->getNumberOfBlocks(unbound), 3);
+        for (S32 i = 0; i < 3; ++i)
+        {
+            U32 byName = 0, byHandle = 1, byFallback = 2;
+            reader->getU32(_PREHASH_Test1, _PREHASH_Test0, byName, i);
+            reader->getU32(value, byHandle, i);
+            reader->getData(unbound, &byFallback, sizeof(U32), i);
+            ensure_equals("value", byHandle, byName);
+            ensure_equals("fallback value", byFallback, byName);
+
+            S32 size = reader->getSize(text, i);
+            ensure_equals("text size", size, reader->getSize(_PREHASH_Test1, i, _PREHASH_Test1));
+            char buffer[32];
+            memset(buffer, 0xcc, sizeof(buffer));
+            reader->getData(text, buffer, 0, i, sizeof(buffer));
+            ensure_equals("text", std::string(buffer), std::string(strings[i]));
+            std::string byNameText, byHandleText;
+            reader->getString(_PREHASH_Test1, _PREHASH_Test1, byNameText, i);
+            reader->getString(text, byHandleText, i);
+            ensure_equals("string", byHandleText, byNameText);
+        }
+        delete reader;
+    }
+
+    template<> template<>
+    void LLTemplateMessageBuilderTestObject::test<47>()
+        // replay benchmark: ObjectUpdate reads by name vs. through handles
+    {
+        // Not a pass/fail test: replays a capture of ObjectUpdate packets
+        // and reports what the handler-side reads cost per variable.
+        defaultTemplate();
+        LLMessageStringTable* table = LLMessageStringTable::getInstance();
+
+        LLMessageTemplate* objectUpdate = new LLMessageTemplate(_PREHASH_ObjectUpdate, 12, MFT_HIGH);
+        objectUpdate->setHandlerFunc(ignoreMessage, NULL);
+        LLMessageBlock* region = new LLMessageBlock(_PREHASH_RegionData, MBT_SINGLE);
+        region->addVariable(const_cast<char*>(_PREHASH_RegionHandle), MVT_U64, 8);
+        region->addVariable(const_cast<char*>(_PREHASH_TimeDilation), MVT_U16, 2);
+        objectUpdate->addBlock(region);
+
+        // ObjectData layout from message_template.msg
+        struct { const char* name; EMsgVariableType type; S32 size; } layout[] = {
+            { "ID", MVT_U32, 4 }, { "State", MVT_U8, 1 }, { "FullID", MVT_LLUUID, 16 },
+            { "CRC", MVT_U32, 4 }, { "PCode", MVT_U8, 1 }, { "Material", MVT_U8, 1 },
+            { "ClickAction", MVT_U8, 1 }, { "Scale", MVT_LLVector3, 12 },
+            { "ObjectData", MVT_VARIABLE, 1 }, { "ParentID", MVT_U32, 4 },
+            { "UpdateFlags", MVT_U32, 4 }, { "PathCurve", MVT_U8, 1 },
+            { "ProfileCurve", MVT_U8, 1 }, { "PathBegin", MVT_U16, 2 },
+            { "PathEnd", MVT_U16, 2 }, { "PathScaleX", MVT_U8, 1 },
+            { "PathScaleY", MVT_U8, 1 }, { "PathShearX", MVT_U8, 1 },
+            { "PathShearY", MVT_U8, 1 }, { "PathTwist", MVT_S8, 1 },
+            { "PathTwistBegin", MVT_S8, 1 }, { "PathRadiusOffset", MVT_S8, 1 },
+            { "PathTaperX", MVT_S8, 1 }, { "PathTaperY", MVT_S8, 1 },
+            { "PathRevolutions", MVT_U8, 1 }, { "PathSkew", MVT_S8, 1 },
+            { "ProfileBegin", MVT_U16, 2 }, { "ProfileEnd", MVT_U16, 2 },
+            { "ProfileHollow", MVT_U16, 2 }, { "TextureEntry", MVT_VARIABLE, 2 },
+            { "TextureAnim", MVT_VARIABLE, 1 }, { "NameValue", MVT_VARIABLE, 2 },
+            { "Data", MVT_VARIABLE, 2 }, { "Text", MVT_VARIABLE, 1 },
+            { "TextColor", MVT_FIXED, 4 }, { "MediaURL", MVT_VARIABLE, 1 },
+            { "PSBlock", MVT_VARIABLE, 1 }, { "ExtraParams", MVT_VARIABLE, 1 },
+            { "Sound", MVT_LLUUID, 16 }, { "OwnerID", MVT_LLUUID, 16 },
+            { "Gain", MVT_F32, 4 }, { "Flags", MVT_U8, 1 }, { "Radius", MVT_F32, 4 },
+            { "JointType", MVT_U8, 1 }, { "JointPivot", MVT_LLVector3, 12 },
+            { "JointAxisOrAnchor", MVT_LLVector3, 12 } };
+        const S32 LAYOUT_SIZE = LL_ARRAY_SIZE(layout);
+        LLMessageBlock* objects = new LLMessageBlock(_PREHASH_ObjectData, MBT_VARIABLE);
+        for (S32 v = 0; v < LAYOUT_SIZE; ++v)
+        {
+            objects->addVariable(table->getString(layout[v].name), layout[v].type, layout[v].size);
+        }
+        objectUpdate->addBlock(objects);
+        nameMap[_PREHASH_ObjectUpdate] = objectUpdate;
+        numberMap[12] = objectUpdate;
+
+        // Capture: packets of 1 to 8 objects, as a busy sim sends them.
+        const S32 PACKETS = 500;
+        std::vector<std::vector<U8> > capture(PACKETS);
+        U8 payload[256];
+        for (S32 p = 0; p < PACKETS; ++p)
+        {
+            LLTemplateMessageBuilder builder(nameMap);
+            builder.newMessage(_PREHASH_ObjectUpdate);
+            builder.nextBlock(_PREHASH_RegionData);
+            builder.addU64(_PREHASH_RegionHandle, (U64(256000) << 32) | U64(256000));
+            builder.addU16(_PREHASH_TimeDilation, 65535);
+            S32 count = 1 + ll_rand(8);
+            for (S32 o = 0; o < count; ++o)
+            {
+                builder.nextBlock(_PREHASH_ObjectData);
+                for (S32 v = 0; v < LAYOUT_SIZE; ++v)
+                {
+                    S32 size = (layout[v].type == MVT_VARIABLE) ? ll_rand(48) : layout[v].size;
+                    for (S32 b = 0; b < size; ++b)
+                    {
+                        payload[b] = (U8)ll_rand(256);
+                    }
+                    builder.addBinaryData(table->getString(layout[v].name), payload, size);
+                }
+            }
+            U8 buffer[MAX_BUFFER_SIZE];
+            memset(buffer, 0, LL_PACKET_ID_SIZE);
+            U32 size = builder.buildMessage(buffer, MAX_BUFFER_SIZE, 0);
+            capture[p].assign(buffer, buffer + size);
+        }
+
+        // What LLViewerObjectList::processObjectUpdate() and
+        // LLViewerObject::processUpdateMessage() read for a full update.
+        const char* hot[] = { "ID", "FullID", "PCode", "CRC", "ParentID", "Sound",
+                              "OwnerID", "Gain", "Radius", "Flags", "Material",
+                              "ClickAction", "Scale", "UpdateFlags", "State",
+                              "TextColor" };
+        const S32 HOT_SIZE = LL_ARRAY_SIZE(hot);
+        std::vector<LLMessageVariableHandle> handles(HOT_SIZE);
+        std::vector<S32> sizes(HOT_SIZE);
+        for (S32 h = 0; h < HOT_SIZE; ++h)
+        {
+            const char* name = table->getString(hot[h]);
+            ensure("bind", handles[h].bind(objectUpdate, _PREHASH_ObjectData, name));
+            sizes[h] = objectUpdate->getBlock(const_cast<char*>(_PREHASH_ObjectData))->getVariable(const_cast<char*>(name))->getSize();
+        }
+        LLMessageVariableHandle regionHandle, objectData;
+        ensure("bind region", regionHandle.bind(objectUpdate, _PREHASH_RegionData, _PREHASH_RegionHandle));
+        ensure("bind object data", objectData.bind(objectUpdate, _PREHASH_ObjectData, _PREHASH_ObjectData));
+
+        // Decode every packet up front so that the timed loops below only
+        // contain the reads a handler would make.
+        std::vector<LLTemplateMessageReader*> readers(PACKETS);
+        LLTimer timer;
+        for (S32 p = 0; p < PACKETS; ++p)
+        {
+            readers[p] = new LLTemplateMessageReader(numberMap);
+            readers[p]->validateMessage(&capture[p][0], (S32)capture[p].size(), LLHost());
+            readers[p]->readMessage(&capture[p][0], LLHost());
+        }
+        F64 decode_secs = timer.getElapsedTimeF64();
+
+        const S32 PASSES = 50;
+        U32 name_sum = 0, handle_sum = 0;
+        S32 reads = 0;
+        U8 out[16];
+        timer.reset();
+        for (S32 pass = 0; pass < PASSES; ++pass)
+        {
+            for (S32 p = 0; p < PACKETS; ++p)
+            {
+                LLTemplateMessageReader* reader = readers[p];
+                S32 count = reader->getNumberOfBlocks(_PREHASH_ObjectData);
+                for (S32 o = 0; o < count; ++o)
+                {
+                    U64 handle;
+                    reader->getU64(_PREHASH_RegionData, _PREHASH_RegionHandle, handle);
+                    for (S32 h = 0; h < HOT_SIZE; ++h)
+                    {
+                        reader->getBinaryData(_PREHASH_ObjectData, handles[h].getVariableName(), out, sizes[h], o);
+                        name_sum += out[0] + out[sizes[h] - 1];
+                    }
+                    name_sum += reader->getSize(_PREHASH_ObjectData, o, _PREHASH_ObjectData);
+                    reads += HOT_SIZE + 2;
+                }
+            }
+        }
+        F64 name_secs = timer.getElapsedTimeF64();
+
+        timer.reset();
+        for (S32 pass = 0; pass < PASSES; ++pass)
+        {
+            for (S32 p = 0; p < PACKETS; ++p)
+            {
+                LLTemplateMessageReader* reader = readers[p];
+                S32 count = reader->getNumberOfBlocks(handles[0]);
+                for (S32 o = 0; o < count; ++o)
+                {
+                    U64 handle;
+                    reader->getData(regionHandle, &handle, sizeof(U64));
+                    for (S32 h = 0; h < HOT_SIZE; ++h)
+                    {
+                        reader->getData(handles[h], out, sizes[h], o);
+                        handle_sum += out[0] + out[sizes[h] - 1];
+                    }
+                    handle_sum += reader->getSize(objectData, o);
+                }
+            }
+        }
+        F64 handle_secs = timer.getElapsedTimeF64();
+        ensure_equals("same data", handle_sum, name_sum);
+
+        for (S32 p = 0; p < PACKETS; ++p)
+        {
+            delete readers[p];
+        }
+
+        std::cout << "\nObjectUpdate replay: " << PACKETS << " packets, decode "
+                  << (decode_secs * 1.0e9 / F64(PACKETS)) << " ns/packet, read by name "
+                  << (name_secs * 1.0e9 / F64(reads)) << " ns/variable, by handle "
+                  << (handle_secs * 1.0e9 / F64(reads)) << " ns/variable" << std::endl;
+
+        nameMap.erase(_PREHASH_ObjectUpdate);
+        numberMap.erase(12);
+        delete objectUpdate;
+    }
+}